@@ -0,0 +1,289 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "DepthMapEstimatorCpu.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/mvsUtils/mapIO.hpp>
+#include <aliceVision/mvsUtils/ImagesCache.hpp>
+#include <aliceVision/depthMap/SgmDepthList.hpp>
+#include <aliceVision/depthMap/cpu/CpuCache.hpp>
+#include <aliceVision/depthMap/cpu/SgmCpu.hpp>
+#include <aliceVision/depthMap/cpu/RefineCpu.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace aliceVision {
+namespace depthMap {
+
+namespace {
+
+/**
+ * @brief Copy the given tile depth/sim map in host memory into two separate images.
+ */
+void copyCpuFloat2Map(image::Image<float>& out_mapX, image::Image<float>& out_mapY, const CpuMap<CpuFloat2>& in_map)
+{
+    const int width = int(in_map.width());
+    const int height = int(in_map.height());
+
+    out_mapX.resize(width, height);
+    out_mapY.resize(width, height);
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const CpuFloat2& value = in_map(x, y);
+            out_mapX(y, x) = value.x;
+            out_mapY(y, x) = value.y;
+        }
+    }
+}
+
+}  // namespace
+
+DepthMapEstimatorCpu::DepthMapEstimatorCpu(const mvsUtils::MultiViewParams& mp,
+                                           const mvsUtils::TileParams& tileParams,
+                                           const DepthMapParams& depthMapParams,
+                                           const SgmParams& sgmParams,
+                                           const RefineParams& refineParams)
+  : _mp(mp),
+    _tileParams(tileParams),
+    _depthMapParams(depthMapParams),
+    _sgmParams(sgmParams),
+    _refineParams(refineParams)
+{
+    // compute maximum downscale (scaleStep)
+    const int maxDownscale = std::max(_sgmParams.scale * _sgmParams.stepXY, _refineParams.scale * _refineParams.stepXY);
+
+    // compute tile ROI list
+    getTileRoiList(_tileParams, _mp.getMaxImageWidth(), _mp.getMaxImageHeight(), maxDownscale, _tileRoiList);
+
+    // log tiling information and ROI list
+    logTileRoiList(_tileParams, _mp.getMaxImageWidth(), _mp.getMaxImageHeight(), maxDownscale, _tileRoiList);
+
+    if (_refineParams.useColorOptimization)
+        ALICEVISION_LOG_WARNING("Depth map color optimization is not available with the CPU backend, it will be skipped.");
+
+    if (_sgmParams.useCustomPatchPattern || _refineParams.useCustomPatchPattern)
+        ALICEVISION_LOG_WARNING("Custom patch pattern is not available with the CPU backend, full patches will be used.");
+
+    if (_refineParams.useSgmNormalMap || _sgmParams.exportIntermediateNormalMaps || _refineParams.exportIntermediateNormalMaps)
+        ALICEVISION_LOG_WARNING("Normal maps are not available with the CPU backend, they will be ignored.");
+}
+
+double DepthMapEstimatorCpu::getMemoryConsumptionPerJob() const
+{
+    // mipmap image cost
+    // mipmap image should not exceed (1.5 * max_width) * max_height at the first level downscale
+    const int minMipmapDownscale = std::min(_refineParams.scale, _sgmParams.scale);
+    const double mipmapCostMB = ((_mp.getMaxImageWidth() * 1.5) * _mp.getMaxImageHeight() * sizeof(CpuRGBA)) /
+                                (minMipmapDownscale * minMipmapDownscale * 1024.0 * 1024.0);
+
+    // full-size input image cost (single image kept in the images cache)
+    const double imageCostMB = (double(_mp.getMaxImageWidth()) * _mp.getMaxImageHeight() * sizeof(image::RGBAfColor)) / (1024.0 * 1024.0);
+
+    // cameras cost per R camera computation
+    // Rc mipmap + Tcs mipmaps
+    const double rcCamsCostMB = mipmapCostMB + _depthMapParams.maxTCams * mipmapCostMB;
+
+    // single tile Sgm / Refine cost
+    const CpuCache cpuCache;
+    const SgmCpu sgm(_mp, _tileParams, _sgmParams, !_depthMapParams.useRefine, cpuCache);
+    const double sgmTileCostMB = sgm.getMemoryConsumption();
+    const double refineTileCostMB = (_depthMapParams.useRefine) ? RefineCpu(_mp, _tileParams, _refineParams, cpuCache).getMemoryConsumption() : 0.0;
+
+    // full-size depth/sim maps cost
+    const int minScaleStep = (_depthMapParams.useRefine) ? (_refineParams.scale * _refineParams.stepXY) : (_sgmParams.scale * _sgmParams.stepXY);
+    const double mapsCostMB = (2.0 * _mp.getMaxImageWidth() * _mp.getMaxImageHeight() * sizeof(float)) /
+                              (minScaleStep * minScaleStep * 1024.0 * 1024.0);
+
+    return imageCostMB + rcCamsCostMB + sgmTileCostMB + refineTileCostMB + mapsCostMB;
+}
+
+void DepthMapEstimatorCpu::getTilesList(int rc, std::vector<Tile>& tiles) const
+{
+    const int nbTilesPerCamera = _tileRoiList.size();
+
+    tiles.clear();
+    tiles.reserve(nbTilesPerCamera);
+
+    // get R camera Tcs list
+    const std::vector<int> tCams = _mp.findNearestCamsFromLandmarks(rc, _depthMapParams.maxTCams).getDataWritable();
+
+    // get R camera ROI
+    const ROI rcImageRoi(Range(0, _mp.getWidth(rc)), Range(0, _mp.getHeight(rc)));
+
+    for (int i = 0; i < nbTilesPerCamera; ++i)
+    {
+        Tile t;
+
+        t.id = i;
+        t.nbTiles = nbTilesPerCamera;
+        t.rc = rc;
+        t.roi = intersect(_tileRoiList.at(i), rcImageRoi);
+
+        if (t.roi.isEmpty())
+        {
+            // do nothing, this ROI cannot intersect the R camera ROI.
+        }
+        else if (_depthMapParams.chooseTCamsPerTile)
+        {
+            // find nearest T cameras per tile
+            t.sgmTCams = _mp.findTileNearestCams(rc, _sgmParams.maxTCamsPerTile, tCams, t.roi);
+
+            if (_depthMapParams.useRefine)
+                t.refineTCams = _mp.findTileNearestCams(rc, _refineParams.maxTCamsPerTile, tCams, t.roi);
+        }
+        else
+        {
+            // use previously selected T cameras from the entire image
+            t.sgmTCams = tCams;
+            t.refineTCams = tCams;
+        }
+
+        tiles.push_back(t);
+    }
+}
+
+void DepthMapEstimatorCpu::compute(int nbThreads, const std::vector<int>& cams)
+{
+    // set the number of threads of this job
+    omp_set_num_threads(nbThreads);
+
+    // initialize RAM image cache
+    // note: full-size images are only needed to build the mipmap images, keep a single one
+    mvsUtils::ImagesCache<image::Image<image::RGBAfColor>> ic(_mp, image::EImageColorSpace::LINEAR);
+    ic.setCacheSize(1);
+
+    // host mipmap images of the current R camera and its T cameras
+    CpuCache cpuCache;
+
+    // allocate Sgm and Refine buffers in host memory
+    SgmCpu sgm(_mp, _tileParams, _sgmParams, !_depthMapParams.useRefine, cpuCache);
+    RefineCpu refine(_mp, _tileParams, _refineParams, cpuCache);
+
+    const int minMipmapDownscale = std::min(_refineParams.scale, _sgmParams.scale);
+    const int maxMipmapDownscale = std::max(_refineParams.scale, _sgmParams.scale) * std::pow(2, 6);  // we add 6 downscale levels
+
+    // output downscale and step
+    const int scale = (_depthMapParams.useRefine) ? _refineParams.scale : _sgmParams.scale;
+    const int step = (_depthMapParams.useRefine) ? _refineParams.stepXY : _sgmParams.stepXY;
+    const int scaleStep = scale * step;
+
+    std::vector<Tile> tiles;
+
+    for (const int rc : cams)
+    {
+        ALICEVISION_LOG_INFO("Compute depth map (rc: " << rc << ", view id: " << _mp.getViewId(rc) << ") (CPU).");
+
+        // build R camera tile list
+        getTilesList(rc, tiles);
+
+        // load R camera and all tiles T cameras in host cache
+        {
+            std::vector<int> rcCams = {rc};
+
+            for (const Tile& tile : tiles)
+            {
+                rcCams.insert(rcCams.end(), tile.sgmTCams.begin(), tile.sgmTCams.end());
+
+                if (_depthMapParams.useRefine)
+                    rcCams.insert(rcCams.end(), tile.refineTCams.begin(), tile.refineTCams.end());
+            }
+
+            // release mipmap images of the previous R camera that are no longer needed
+            cpuCache.keepOnly(rcCams);
+
+            for (const int camId : rcCams)
+                cpuCache.addMipmapImage(camId, minMipmapDownscale, maxMipmapDownscale, ic, _mp);
+        }
+
+        // full-size depth/sim maps, should be initialized (additive process)
+        const int width = divideRoundUp(_mp.getWidth(rc), scaleStep);
+        const int height = divideRoundUp(_mp.getHeight(rc), scaleStep);
+
+        image::Image<float> depthMap(width, height, true, 0.0f);
+        image::Image<float> simMap(width, height, true, 0.0f);
+
+        for (Tile& tile : tiles)
+        {
+            // do not compute empty ROI
+            // some images in the dataset may be smaller than others
+            if (tile.roi.isEmpty())
+                continue;
+
+            image::Image<float> tileDepthMap;
+            image::Image<float> tileSimMap;
+
+            bool isValidTile = !(tile.sgmTCams.empty() || (_depthMapParams.useRefine && tile.refineTCams.empty()));
+
+            if (isValidTile)
+            {
+                // build tile SGM depth list
+                SgmDepthList sgmDepthList(_mp, _sgmParams, tile);
+
+                // compute the R camera depth list
+                sgmDepthList.computeListRc();
+
+                // check number of depths
+                isValidTile = !sgmDepthList.getDepths().empty();
+
+                if (isValidTile)
+                {
+                    // remove T cameras with no depth found.
+                    sgmDepthList.removeTcWithNoDepth(tile);
+
+                    // log debug camera / depth information
+                    sgmDepthList.logRcTcDepthInformation();
+
+                    // check if starting and stopping depth are valid
+                    sgmDepthList.checkStartingAndStoppingDepth();
+
+                    // compute Semi-Global Matching
+                    sgm.sgmRc(tile, sgmDepthList);
+
+                    if (_depthMapParams.useRefine)
+                    {
+                        // smooth SGM thickness map
+                        // in order to be a proper Refine input parameter
+                        sgm.smoothThicknessMap(tile, _refineParams);
+
+                        // compute Refine
+                        refine.refineRc(tile, sgm.getDepthThicknessMap());
+
+                        copyCpuFloat2Map(tileDepthMap, tileSimMap, refine.getDepthSimMap());
+                    }
+                    else
+                    {
+                        copyCpuFloat2Map(tileDepthMap, tileSimMap, sgm.getDepthSimMap());
+                    }
+                }
+            }
+
+            if (!isValidTile)
+            {
+                // no T camera or no depth found, reset tile depth/sim map
+                const ROI downscaledRoi = downscaleROI(tile.roi, scaleStep);
+                tileDepthMap.resize(downscaledRoi.width(), downscaledRoi.height(), true, -1.0f);
+                tileSimMap.resize(downscaledRoi.width(), downscaledRoi.height(), true, 1.0f);
+            }
+
+            // add tile maps to the full-size maps with weighting
+            mvsUtils::addTileMapWeighted(rc, _mp, _tileParams, tile.roi, scaleStep, tileDepthMap, depthMap);
+            mvsUtils::addTileMapWeighted(rc, _mp, _tileParams, tile.roi, scaleStep, tileSimMap, simMap);
+        }
+
+        // write fullsize maps on disk
+        mvsUtils::writeMap(rc, _mp, mvsUtils::EFileType::depthMap, depthMap, scale, step);
+        mvsUtils::writeMap(rc, _mp, mvsUtils::EFileType::simMap, simMap, scale, step);
+    }
+}
+
+}  // namespace depthMap
+}  // namespace aliceVision
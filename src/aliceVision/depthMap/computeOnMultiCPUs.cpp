@@ -0,0 +1,94 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "computeOnMultiCPUs.hpp"
+
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/MemoryInfo.hpp>
+
+#include <algorithm>
+
+namespace aliceVision {
+namespace depthMap {
+
+void computeOnMultiCPUs(const std::vector<int>& cams, ICPUJob& cpujob, int nbCoresToUse, int nbThreadsPerJob)
+{
+    if (cams.empty())
+        return;
+
+    const int nbCPUThreads = omp_get_max_threads();
+    const int nbCores = (nbCoresToUse > 0) ? std::min(nbCoresToUse, nbCPUThreads) : nbCPUThreads;
+    const int nbThreadsPerJob_ = std::max(1, std::min(nbThreadsPerJob, nbCores));
+
+    // number of simultaneous jobs from the number of cores
+    int nbJobs = std::max(1, nbCores / nbThreadsPerJob_);
+
+    // limit the number of simultaneous jobs from the available host memory
+    {
+        const double availableMB = double(system::getMemoryInfo().availableRam) / (1024.0 * 1024.0) * 0.8;  // available memory margin
+        const double jobCostMB = cpujob.getMemoryConsumptionPerJob();
+
+        if (jobCostMB > 0.0)
+        {
+            const int nbJobsMemory = std::max(1, static_cast<int>(availableMB / jobCostMB));
+
+            if (nbJobsMemory < nbJobs)
+            {
+                ALICEVISION_LOG_INFO("Limit the number of simultaneous jobs due to the available host memory from " << nbJobs << " to "
+                                                                                                                   << nbJobsMemory << ".");
+                nbJobs = nbJobsMemory;
+            }
+        }
+
+        ALICEVISION_LOG_INFO("Host memory:" << std::endl
+                                            << "\t- available: " << availableMB << " MB" << std::endl
+                                            << "\t- requirement per job: " << jobCostMB << " MB");
+    }
+
+    nbJobs = std::min(nbJobs, static_cast<int>(cams.size()));
+
+    // give the remaining cores to the jobs
+    const int nbThreads = std::max(1, nbCores / nbJobs);
+
+    ALICEVISION_LOG_INFO("Number of CPU threads: " << nbCPUThreads << ", number of simultaneous jobs: " << nbJobs
+                                                   << ", number of threads per job: " << nbThreads);
+
+    // backup max threads to keep potentially previously set value
+    const int previousCountThreads = omp_get_max_threads();
+
+    if (nbJobs == 1)
+    {
+        cpujob.compute(nbThreads, cams);
+        omp_set_num_threads(previousCountThreads);
+        return;
+    }
+
+    // each job uses its own OpenMP thread team
+    omp_set_nested(1);
+
+#pragma omp parallel num_threads(nbJobs)
+    {
+        const int jobId = omp_get_thread_num();
+
+        // interleaved distribution, neighbor cameras often have similar costs
+        std::vector<int> subcams;
+        subcams.reserve(cams.size() / nbJobs + 1);
+
+        for (std::size_t i = jobId; i < cams.size(); i += nbJobs)
+            subcams.push_back(cams[i]);
+
+        ALICEVISION_LOG_INFO("CPU job " << jobId << " (of " << nbJobs << ") computes " << subcams.size() << " cameras.");
+
+        cpujob.compute(nbThreads, subcams);
+    }
+
+    omp_set_nested(0);
+    omp_set_num_threads(previousCountThreads);
+}
+
+}  // namespace depthMap
+}  // namespace aliceVision
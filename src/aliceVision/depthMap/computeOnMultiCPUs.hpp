@@ -0,0 +1,48 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @class ICPUJob
+ * @brief Interface for multi-CPUs computation.
+ * @note CPU counterpart of IGPUJob.
+ */
+class ICPUJob
+{
+  public:
+    /**
+     * @brief Perform computation from the given cameras.
+     * @param[in] nbThreads the number of CPU threads available for this computation
+     * @param[in] cams the list of cameras
+     */
+    virtual void compute(int nbThreads, const std::vector<int>& cams) = 0;
+
+    /**
+     * @brief Get the host memory needed by a single compute() call.
+     * @return memory consumption (in MB)
+     */
+    virtual double getMemoryConsumptionPerJob() const = 0;
+};
+
+/**
+ * @brief Perform computation from the given cameras on multiple CPU cores.
+ * @note Cameras are distributed in interleaved order across simultaneous jobs,
+ *       the number of simultaneous jobs is limited by the available host memory.
+ * @param[in] cams the given list of cameras
+ * @param[in,out] cpujob the object that wrap computation (should use ICPUJob interface)
+ * @param[in] nbCoresToUse the number of CPU cores to use (0 for all cores)
+ * @param[in] nbThreadsPerJob the number of CPU threads per simultaneous job
+ */
+void computeOnMultiCPUs(const std::vector<int>& cams, ICPUJob& cpujob, int nbCoresToUse, int nbThreadsPerJob);
+
+}  // namespace depthMap
+}  // namespace aliceVision
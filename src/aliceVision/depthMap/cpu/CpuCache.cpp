@@ -0,0 +1,74 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "CpuCache.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+
+namespace aliceVision {
+namespace depthMap {
+
+void CpuCache::addMipmapImage(int camId,
+                              int minDownscale,
+                              int maxDownscale,
+                              mvsUtils::ImagesCache<image::Image<image::RGBAfColor>>& imageCache,
+                              const mvsUtils::MultiViewParams& mp)
+{
+    // get view id for logs
+    const IndexT viewId = mp.getViewId(camId);
+
+    if (_mipmapImages.count(camId))
+    {
+        ALICEVISION_LOG_TRACE("Add mipmap image on host cache: already on cache (id: " << camId << ", view id: " << viewId << ").");
+        return;  // nothing to do
+    }
+
+    ALICEVISION_LOG_TRACE("Add mipmap image on host cache (id: " << camId << ", view id: " << viewId << ").");
+
+    // get image buffer
+    mvsUtils::ImagesCache<image::Image<image::RGBAfColor>>::ImgSharedPtr img = imageCache.getImg_sync(camId);
+
+    std::unique_ptr<CpuMipmapImage> mipmapImage(new CpuMipmapImage());
+    mipmapImage->fill(*img, minDownscale, maxDownscale);
+
+    _mipmapImages.emplace(camId, std::move(mipmapImage));
+}
+
+const CpuMipmapImage& CpuCache::requestMipmapImage(int camId) const
+{
+    const auto it = _mipmapImages.find(camId);
+
+    if (it == _mipmapImages.end())
+        ALICEVISION_THROW_ERROR("Cannot find mipmap image on host cache (id: " << camId << ").");
+
+    return *(it->second);
+}
+
+void CpuCache::keepOnly(const std::vector<int>& camIds)
+{
+    for (auto it = _mipmapImages.begin(); it != _mipmapImages.end();)
+    {
+        if (std::find(camIds.begin(), camIds.end(), it->first) == camIds.end())
+            it = _mipmapImages.erase(it);
+        else
+            ++it;
+    }
+}
+
+double CpuCache::getMemoryConsumption() const
+{
+    std::size_t bytes = 0;
+
+    for (const auto& mipmapImagePair : _mipmapImages)
+        bytes += mipmapImagePair.second->getBytes();
+
+    return (double(bytes) / (1024.0 * 1024.0));
+}
+
+}  // namespace depthMap
+}  // namespace aliceVision
@@ -0,0 +1,83 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/image/pixelTypes.hpp>
+#include <aliceVision/mvsUtils/ImagesCache.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/depthMap/cpu/CpuMipmapImage.hpp>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @class CpuCache
+ * @brief Support class to maintain the mipmap images of a CPU depth map job in host memory.
+ * @note CPU counterpart of DeviceCache, one instance per job (no singleton, no LRU):
+ *       the job explicitly releases the cameras that are no longer needed.
+ */
+class CpuCache
+{
+  public:
+    CpuCache() = default;
+
+    // no copy constructor
+    CpuCache(CpuCache const&) = delete;
+
+    // no copy operator
+    void operator=(CpuCache const&) = delete;
+
+    /**
+     * @brief Add a mipmap image in host memory cache.
+     * @param[in] camId the camera index in the ImagesCache / MultiViewParams
+     * @param[in] minDownscale the min downscale factor
+     * @param[in] maxDownscale the max downscale factor
+     * @param[in,out] imageCache the image cache to get host-side data
+     * @param[in] mp the multi-view parameters
+     */
+    void addMipmapImage(int camId,
+                        int minDownscale,
+                        int maxDownscale,
+                        mvsUtils::ImagesCache<image::Image<image::RGBAfColor>>& imageCache,
+                        const mvsUtils::MultiViewParams& mp);
+
+    /**
+     * @brief Get the mipmap image of the given camera.
+     * @note throw if the mipmap image is not in the cache
+     * @param[in] camId the camera index in the ImagesCache / MultiViewParams
+     * @return the mipmap image in host memory
+     */
+    const CpuMipmapImage& requestMipmapImage(int camId) const;
+
+    /**
+     * @brief Remove all mipmap images that are not in the given camera list.
+     * @param[in] camIds the camera indexes to keep
+     */
+    void keepOnly(const std::vector<int>& camIds);
+
+    /**
+     * @brief Clear the cache.
+     */
+    inline void clear() { _mipmapImages.clear(); }
+
+    /**
+     * @brief Get memory consumption in host memory.
+     * @return host memory consumption (in MB)
+     */
+    double getMemoryConsumption() const;
+
+  private:
+    std::map<int, std::unique_ptr<CpuMipmapImage>> _mipmapImages;  //< mipmap images per camera index
+};
+
+}  // namespace depthMap
+}  // namespace aliceVision
@@ -0,0 +1,58 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "CpuCameraParams.hpp"
+
+namespace aliceVision {
+namespace depthMap {
+
+namespace {
+
+Mat3 toMat3(const Matrix3x3& m)
+{
+    Mat3 out;
+    out << m.m11, m.m12, m.m13, m.m21, m.m22, m.m23, m.m31, m.m32, m.m33;
+    return out;
+}
+
+}  // namespace
+
+void fillCpuCameraParams(CpuCameraParams& out_cameraParams, const Mat3& K, const Mat3& R, const Vec3& C, int downscale)
+{
+    Mat3 scaleM = Mat3::Identity();
+    scaleM(0, 0) = 1.0 / double(downscale);
+    scaleM(1, 1) = 1.0 / double(downscale);
+
+    const Mat3 scaledK = scaleM * K;
+    const Mat3 iK = scaledK.inverse();
+    const Mat3 iR = R.transpose();
+
+    Mat34 P;
+    P.block<3, 3>(0, 0) = R;
+    P.col(3) = -R * C;
+    P = scaledK * P;
+
+    out_cameraParams.P = P.cast<float>();
+    out_cameraParams.iP = (iR * iK).cast<float>();
+    out_cameraParams.R = R.cast<float>();
+    out_cameraParams.iR = iR.cast<float>();
+    out_cameraParams.K = scaledK.cast<float>();
+    out_cameraParams.iK = iK.cast<float>();
+    out_cameraParams.C = C.cast<float>();
+
+    out_cameraParams.XVect = out_cameraParams.iR.col(0).normalized();
+    out_cameraParams.YVect = out_cameraParams.iR.col(1).normalized();
+    out_cameraParams.ZVect = out_cameraParams.iR.col(2).normalized();
+}
+
+void fillCpuCameraParams(CpuCameraParams& out_cameraParams, int camId, int downscale, const mvsUtils::MultiViewParams& mp)
+{
+    const Point3d& C = mp.CArr[camId];
+    fillCpuCameraParams(out_cameraParams, toMat3(mp.KArr[camId]), toMat3(mp.RArr[camId]), Vec3(C.x, C.y, C.z), downscale);
+}
+
+}  // namespace depthMap
+}  // namespace aliceVision
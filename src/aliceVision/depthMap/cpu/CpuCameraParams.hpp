@@ -0,0 +1,54 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @struct CpuCameraParams
+ * @brief Support class to maintain useful camera parameters in host memory.
+ * @note CPU counterpart of DeviceCameraParams.
+ */
+struct CpuCameraParams
+{
+    Eigen::Matrix<float, 3, 4> P;
+    Eigen::Matrix3f iP;
+    Eigen::Matrix3f R;
+    Eigen::Matrix3f iR;
+    Eigen::Matrix3f K;
+    Eigen::Matrix3f iK;
+    Vec3f C;
+    Vec3f XVect;
+    Vec3f YVect;
+    Vec3f ZVect;
+};
+
+/**
+ * @brief Fill the camera parameters from the given intrinsics and pose.
+ * @param[out] out_cameraParams the camera parameters
+ * @param[in] K the camera intrinsics matrix at full resolution
+ * @param[in] R the camera rotation matrix
+ * @param[in] C the camera center
+ * @param[in] downscale the downscale to apply on parameters
+ */
+void fillCpuCameraParams(CpuCameraParams& out_cameraParams, const Mat3& K, const Mat3& R, const Vec3& C, int downscale);
+
+/**
+ * @brief Fill the camera parameters from multi-view parameters.
+ * @param[out] out_cameraParams the camera parameters
+ * @param[in] camId the camera index in the ImagesCache / MultiViewParams
+ * @param[in] downscale the downscale to apply on parameters
+ * @param[in] mp the multi-view parameters
+ */
+void fillCpuCameraParams(CpuCameraParams& out_cameraParams, int camId, int downscale, const mvsUtils::MultiViewParams& mp);
+
+}  // namespace depthMap
+}  // namespace aliceVision
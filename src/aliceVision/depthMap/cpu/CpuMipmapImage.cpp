@@ -0,0 +1,176 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "CpuMipmapImage.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+namespace aliceVision {
+namespace depthMap {
+
+namespace {
+
+/**
+ * @brief Linear RGB (0..1) to CIELAB (0..255)
+ * @note Same conversion as the CUDA rgb2lab kernel (rgb2xyz + xyz2lab).
+ */
+inline CpuRGBA rgb2lab(const image::RGBAfColor& c)
+{
+    const float x = 0.4124564f * c.r() + 0.3575761f * c.g() + 0.1804375f * c.b();
+    const float y = 0.2126729f * c.r() + 0.7151522f * c.g() + 0.0721750f * c.b();
+    const float z = 0.0193339f * c.r() + 0.1191920f * c.g() + 0.9503041f * c.b();
+
+    // assuming whitepoint D65, XYZ=(0.95047, 1.00000, 1.08883)
+    const float rx = x / 0.95047f;
+    const float ry = y;
+    const float rz = z / 1.08883f;
+
+    const auto f = [](float r) { return (r > 216.0f / 24389.0f) ? std::cbrt(r) : (24389.0f / 27.0f * r + 16.0f) / 116.0f; };
+
+    const float fx = f(rx);
+    const float fy = f(ry);
+    const float fz = f(rz);
+
+    // convert values to fit into 0..255 (could be out-of-range)
+    return {(116.0f * fy - 16.0f) * 2.55f, 500.0f * (fx - fy) * 2.55f, 200.0f * (fy - fz) * 2.55f, c.a() * 255.0f};
+}
+
+/**
+ * @brief Downscale the given level by 2 with a 3x3 Gaussian kernel.
+ */
+void downscaleLevel(CpuMap<CpuRGBA>& out_level, const CpuMap<CpuRGBA>& in_level)
+{
+    const int inWidth = int(in_level.width());
+    const int inHeight = int(in_level.height());
+    const int outWidth = divideRoundUp(inWidth, 2);
+    const int outHeight = divideRoundUp(inHeight, 2);
+
+    out_level.allocate(outWidth, outHeight);
+
+    constexpr float kernel[3] = {0.25f, 0.5f, 0.25f};
+
+#pragma omp parallel for
+    for (int y = 0; y < outHeight; ++y)
+    {
+        for (int x = 0; x < outWidth; ++x)
+        {
+            CpuRGBA sum;
+
+            for (int j = -1; j <= 1; ++j)
+            {
+                const int iy = std::min(std::max(2 * y + j, 0), inHeight - 1);
+
+                for (int i = -1; i <= 1; ++i)
+                {
+                    const int ix = std::min(std::max(2 * x + i, 0), inWidth - 1);
+                    const float w = kernel[i + 1] * kernel[j + 1];
+                    const CpuRGBA& c = in_level(ix, iy);
+
+                    sum.x += c.x * w;
+                    sum.y += c.y * w;
+                    sum.z += c.z * w;
+                    sum.w += c.w * w;
+                }
+            }
+
+            out_level(x, y) = sum;
+        }
+    }
+}
+
+}  // namespace
+
+void CpuMipmapImage::fill(const image::Image<image::RGBAfColor>& in_img, int minDownscale, int maxDownscale)
+{
+    _minDownscale = minDownscale;
+    _maxDownscale = maxDownscale;
+    _width = in_img.Width();
+    _height = in_img.Height();
+
+    const int nbLevels = int(std::log2(maxDownscale / minDownscale)) + 1;
+
+    _levels.clear();
+    _levels.resize(nbLevels);
+
+    // first level: downscale to min downscale with a box filter and convert into CIELAB
+    {
+        CpuMap<CpuRGBA>& firstLevel = _levels.front();
+
+        const int width = divideRoundUp(_width, minDownscale);
+        const int height = divideRoundUp(_height, minDownscale);
+
+        firstLevel.allocate(width, height);
+
+#pragma omp parallel for
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                CpuRGBA sum;
+                int count = 0;
+
+                for (int j = 0; j < minDownscale; ++j)
+                {
+                    const int iy = y * minDownscale + j;
+                    if (iy >= _height)
+                        break;
+
+                    for (int i = 0; i < minDownscale; ++i)
+                    {
+                        const int ix = x * minDownscale + i;
+                        if (ix >= _width)
+                            break;
+
+                        const CpuRGBA lab = rgb2lab(in_img(iy, ix));
+                        sum.x += lab.x;
+                        sum.y += lab.y;
+                        sum.z += lab.z;
+                        sum.w += lab.w;
+                        ++count;
+                    }
+                }
+
+                const float invCount = 1.f / float(count);
+                firstLevel(x, y) = {sum.x * invCount, sum.y * invCount, sum.z * invCount, sum.w * invCount};
+            }
+        }
+    }
+
+    // next levels
+    for (int l = 1; l < nbLevels; ++l)
+        downscaleLevel(_levels.at(l), _levels.at(l - 1));
+}
+
+float CpuMipmapImage::getLevel(unsigned int downscale) const
+{
+    // check given downscale
+    if (int(downscale) < _minDownscale || int(downscale) > _maxDownscale)
+        ALICEVISION_THROW_ERROR("Cannot get host mipmap image level (downscale: " << downscale << ")");
+
+    return std::log2(float(downscale) / float(_minDownscale));
+}
+
+std::pair<int, int> CpuMipmapImage::getDimensions(unsigned int downscale) const
+{
+    // check given downscale
+    if (int(downscale) < _minDownscale || int(downscale) > _maxDownscale)
+        ALICEVISION_THROW_ERROR("Cannot get host mipmap image level dimensions (downscale: " << downscale << ")");
+
+    return {divideRoundUp(_width, int(downscale)), divideRoundUp(_height, int(downscale))};
+}
+
+std::size_t CpuMipmapImage::getBytes() const
+{
+    std::size_t bytes = 0;
+    for (const auto& level : _levels)
+        bytes += level.getBytes();
+    return bytes;
+}
+
+}  // namespace depthMap
+}  // namespace aliceVision
@@ -0,0 +1,128 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/image/Image.hpp>
+#include <aliceVision/image/pixelTypes.hpp>
+#include <aliceVision/depthMap/cpu/memory.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @class CpuMipmapImage
+ * @brief Support class to maintain a CIELAB mipmap image in host memory.
+ * @note CPU counterpart of DeviceMipmapImage, sampling uses normalized coordinates
+ *       with trilinear interpolation like the CUDA mipmapped texture.
+ */
+class CpuMipmapImage
+{
+  public:
+    CpuMipmapImage() = default;
+
+    /**
+     * @brief Fill the mipmap image from the given linear RGBA image (range 0, 1).
+     * @param[in] in_img the input full-size image
+     * @param[in] minDownscale the first level downscale factor (must be power of two)
+     * @param[in] maxDownscale the last level downscale factor (must be power of two)
+     */
+    void fill(const image::Image<image::RGBAfColor>& in_img, int minDownscale, int maxDownscale);
+
+    /**
+     * @brief Get the corresponding mipmap image level of the given downscale
+     * @note throw if the given downscale is not contained in the mipmap image
+     * @return corresponding mipmap image level
+     */
+    float getLevel(unsigned int downscale) const;
+
+    /**
+     * @brief Get the corresponding mipmap image level dimensions (width, height) of the given downscale
+     * @note throw if the given downscale is not contained in the mipmap image
+     * @return corresponding mipmap image level dimensions
+     */
+    std::pair<int, int> getDimensions(unsigned int downscale) const;
+
+    /**
+     * @brief Sample the mipmap image with normalized coordinates and trilinear interpolation.
+     * @param[in] u the normalized x coordinate
+     * @param[in] v the normalized y coordinate
+     * @param[in] level the mipmap level
+     * @return interpolated CIELAB / alpha value in range (0, 255)
+     */
+    inline CpuRGBA sample(float u, float v, float level) const
+    {
+        level = std::min(std::max(level, 0.f), float(_levels.size() - 1));
+        const int l0 = int(level);
+        const float t = level - float(l0);
+
+        if (t <= 0.f || l0 + 1 >= int(_levels.size()))
+            return sampleLevel(_levels[l0], u, v);
+
+        const CpuRGBA c0 = sampleLevel(_levels[l0], u, v);
+        const CpuRGBA c1 = sampleLevel(_levels[l0 + 1], u, v);
+        return {c0.x + (c1.x - c0.x) * t, c0.y + (c1.y - c0.y) * t, c0.z + (c1.z - c0.z) * t, c0.w + (c1.w - c0.w) * t};
+    }
+
+    /**
+     * @return memory size in bytes
+     */
+    std::size_t getBytes() const;
+
+    inline int getMinDownscale() const { return _minDownscale; }
+    inline int getMaxDownscale() const { return _maxDownscale; }
+    inline int getNbLevels() const { return int(_levels.size()); }
+
+  private:
+    /**
+     * @brief Bilinear interpolation with clamp-to-edge addressing.
+     */
+    static inline CpuRGBA sampleLevel(const CpuMap<CpuRGBA>& level, float u, float v)
+    {
+        const int w = int(level.width());
+        const int h = int(level.height());
+
+        const float px = u * float(w) - 0.5f;
+        const float py = v * float(h) - 0.5f;
+
+        const float fx = std::floor(px);
+        const float fy = std::floor(py);
+        const float ax = px - fx;
+        const float ay = py - fy;
+
+        const int x0 = std::min(std::max(int(fx), 0), w - 1);
+        const int y0 = std::min(std::max(int(fy), 0), h - 1);
+        const int x1 = std::min(std::max(int(fx) + 1, 0), w - 1);
+        const int y1 = std::min(std::max(int(fy) + 1, 0), h - 1);
+
+        const CpuRGBA& c00 = level(x0, y0);
+        const CpuRGBA& c10 = level(x1, y0);
+        const CpuRGBA& c01 = level(x0, y1);
+        const CpuRGBA& c11 = level(x1, y1);
+
+        const float w00 = (1.f - ax) * (1.f - ay);
+        const float w10 = ax * (1.f - ay);
+        const float w01 = (1.f - ax) * ay;
+        const float w11 = ax * ay;
+
+        return {c00.x * w00 + c10.x * w10 + c01.x * w01 + c11.x * w11,
+                c00.y * w00 + c10.y * w10 + c01.y * w01 + c11.y * w11,
+                c00.z * w00 + c10.z * w10 + c01.z * w01 + c11.z * w11,
+                c00.w * w00 + c10.w * w10 + c01.w * w01 + c11.w * w11};
+    }
+
+    std::vector<CpuMap<CpuRGBA>> _levels;  //< mipmap levels (CIELAB + alpha)
+    int _minDownscale = 0;                 //< the min downscale factor
+    int _maxDownscale = 0;                 //< the max downscale factor
+    int _width = 0;                        //< original image width
+    int _height = 0;                       //< original image height
+};
+
+}  // namespace depthMap
+}  // namespace aliceVision
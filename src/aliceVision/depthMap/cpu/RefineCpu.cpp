@@ -0,0 +1,147 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "RefineCpu.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/depthMap/cpu/CpuCameraParams.hpp>
+#include <aliceVision/depthMap/cpu/similarityVolume.hpp>
+
+namespace aliceVision {
+namespace depthMap {
+
+RefineCpu::RefineCpu(const mvsUtils::MultiViewParams& mp,
+                     const mvsUtils::TileParams& tileParams,
+                     const RefineParams& refineParams,
+                     const CpuCache& cache)
+  : _mp(mp),
+    _tileParams(tileParams),
+    _refineParams(refineParams),
+    _cache(cache)
+{
+    if (_refineParams.useColorOptimization && _refineParams.optimizationNbIterations > 0)
+        ALICEVISION_LOG_WARNING("Refine color optimization is not available on CPU, the refined and fused depth/sim map is used as is.");
+}
+
+double RefineCpu::getMemoryConsumption() const
+{
+    // get tile maximum dimensions
+    const int downscale = _refineParams.scale * _refineParams.stepXY;
+    const std::size_t maxTileWidth = divideRoundUp(_tileParams.bufferWidth, downscale);
+    const std::size_t maxTileHeight = divideRoundUp(_tileParams.bufferHeight, downscale);
+    const std::size_t nbDepthsToRefine = _refineParams.halfNbDepths * 2 + 1;
+
+    std::size_t bytes = 0;
+
+    // upscaled SGM depth/pixSize map + refined depth/sim map
+    bytes += 2 * maxTileWidth * maxTileHeight * sizeof(CpuFloat2);
+
+    // refine similarity volume
+    bytes += maxTileWidth * maxTileHeight * nbDepthsToRefine * sizeof(TSimRefineCpu);
+
+    return (double(bytes) / (1024.0 * 1024.0));
+}
+
+void RefineCpu::refineRc(const Tile& tile, const CpuMap<CpuFloat2>& in_sgmDepthThicknessMap)
+{
+    const IndexT viewId = _mp.getViewId(tile.rc);
+
+    ALICEVISION_LOG_INFO(tile << "Refine (CPU) depth/sim map of view id: " << viewId << ", rc: " << tile.rc << " (" << (tile.rc + 1) << " / "
+                              << _mp.ncams << ").");
+
+    // downscale the region of interest
+    const ROI downscaledRoi = downscaleROI(tile.roi, _refineParams.scale * _refineParams.stepXY);
+
+    // allocate tile buffers in host memory
+    _sgmDepthPixSizeMap.allocate(downscaledRoi.width(), downscaledRoi.height());
+    _refinedDepthSimMap.allocate(downscaledRoi.width(), downscaledRoi.height());
+
+    // compute upscaled SGM depth/pixSize map
+    // - upscale SGM depth/thickness map
+    // - filter masked pixels (alpha)
+    // - compute pixSize from SGM thickness
+    {
+        const CpuMipmapImage& rcMipmapImage = _cache.requestMipmapImage(tile.rc);
+        cpu_computeSgmUpscaledDepthPixSizeMap(_sgmDepthPixSizeMap, in_sgmDepthThicknessMap, rcMipmapImage, _refineParams, downscaledRoi);
+    }
+
+    // refine and fuse depth/sim map
+    if (_refineParams.useRefineFuse)
+    {
+        // refine and fuse with volume strategy
+        refineAndFuseDepthSimMap(tile);
+    }
+    else
+    {
+        ALICEVISION_LOG_INFO(tile << "Refine and fuse depth/sim map volume disabled.");
+
+        // copy depth only, similarity is set to 1
+        for (std::size_t y = 0; y < _refinedDepthSimMap.height(); ++y)
+            for (std::size_t x = 0; x < _refinedDepthSimMap.width(); ++x)
+                _refinedDepthSimMap(x, y) = {_sgmDepthPixSizeMap(x, y).x, 1.0f};
+    }
+
+    ALICEVISION_LOG_INFO(tile << "Refine (CPU) depth/sim map done.");
+}
+
+void RefineCpu::refineAndFuseDepthSimMap(const Tile& tile)
+{
+    ALICEVISION_LOG_INFO(tile << "Refine (CPU) and fuse depth/sim map volume.");
+
+    // downscale the region of interest
+    const ROI downscaledRoi = downscaleROI(tile.roi, _refineParams.scale * _refineParams.stepXY);
+
+    // allocate and initialize the similarity volume at 0
+    // each tc filtered and inverted similarity value will be summed in this volume
+    const int nbDepthsToRefine = _refineParams.halfNbDepths * 2 + 1;
+    _volumeRefineSim.allocate(downscaledRoi.width(), downscaledRoi.height(), nbDepthsToRefine);
+    _volumeRefineSim.fill(TSimRefineCpu(0.f));
+
+    // get the depth range
+    const Range depthRange(0, nbDepthsToRefine);
+
+    // get R camera parameters and mipmap image
+    CpuCameraParams rcCameraParams;
+    fillCpuCameraParams(rcCameraParams, tile.rc, _refineParams.scale, _mp);
+    const CpuMipmapImage& rcMipmapImage = _cache.requestMipmapImage(tile.rc);
+
+    // compute for each RcTc each similarity value for each depth to refine
+    // sum the inverted / filtered similarity value, best value is the HIGHEST
+    for (std::size_t tci = 0; tci < tile.refineTCams.size(); ++tci)
+    {
+        const int tc = tile.refineTCams.at(tci);
+
+        // get T camera parameters and mipmap image
+        CpuCameraParams tcCameraParams;
+        fillCpuCameraParams(tcCameraParams, tc, _refineParams.scale, _mp);
+        const CpuMipmapImage& tcMipmapImage = _cache.requestMipmapImage(tc);
+
+        ALICEVISION_LOG_DEBUG(tile << "Refine similarity volume (CPU):" << std::endl
+                                   << "\t- rc: " << tile.rc << std::endl
+                                   << "\t- tc: " << tc << " (" << (tci + 1) << "/" << tile.refineTCams.size() << ")" << std::endl
+                                   << "\t- tile range x: [" << downscaledRoi.x.begin << " - " << downscaledRoi.x.end << "]" << std::endl
+                                   << "\t- tile range y: [" << downscaledRoi.y.begin << " - " << downscaledRoi.y.end << "]" << std::endl);
+
+        cpu_volumeRefineSimilarity(_volumeRefineSim,
+                                   _sgmDepthPixSizeMap,
+                                   rcCameraParams,
+                                   tcCameraParams,
+                                   rcMipmapImage,
+                                   tcMipmapImage,
+                                   _refineParams,
+                                   depthRange,
+                                   downscaledRoi);
+    }
+
+    // retrieve the best depth/sim in the volume
+    // compute sub-pixel sample using a sliding gaussian
+    cpu_volumeRefineBestDepth(_refinedDepthSimMap, _sgmDepthPixSizeMap, _volumeRefineSim, _refineParams, downscaledRoi);
+
+    ALICEVISION_LOG_INFO(tile << "Refine (CPU) and fuse depth/sim map volume done.");
+}
+
+}  // namespace depthMap
+}  // namespace aliceVision
@@ -0,0 +1,83 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/ROI.hpp>
+#include <aliceVision/mvsUtils/MultiViewParams.hpp>
+#include <aliceVision/mvsUtils/TileParams.hpp>
+#include <aliceVision/depthMap/Tile.hpp>
+#include <aliceVision/depthMap/RefineParams.hpp>
+#include <aliceVision/depthMap/cpu/memory.hpp>
+#include <aliceVision/depthMap/cpu/CpuCache.hpp>
+
+namespace aliceVision {
+namespace depthMap {
+
+/**
+ * @class Depth map estimation Refine on CPU
+ * @brief Manages the calculation of the Refine step in host memory.
+ * @note CPU counterpart of Refine, the color optimization step is not available.
+ */
+class RefineCpu
+{
+  public:
+    /**
+     * @brief RefineCpu constructor.
+     * @param[in] mp the multi-view parameters
+     * @param[in] tileParams tile workflow parameters
+     * @param[in] refineParams the Refine parameters
+     * @param[in] cache the host mipmap image cache
+     */
+    RefineCpu(const mvsUtils::MultiViewParams& mp, const mvsUtils::TileParams& tileParams, const RefineParams& refineParams, const CpuCache& cache);
+
+    // no default constructor
+    RefineCpu() = delete;
+
+    // default destructor
+    ~RefineCpu() = default;
+
+    // final depth/similarity map getter
+    inline const CpuMap<CpuFloat2>& getDepthSimMap() const { return _refinedDepthSimMap; }
+
+    /**
+     * @brief Get the maximum memory consumption in host memory (maximum tile size).
+     * @return host memory consumption (in MB)
+     */
+    double getMemoryConsumption() const;
+
+    /**
+     * @brief Refine for a single R camera the Semi-Global Matching depth/sim map.
+     * @param[in] tile The given tile for Refine computation
+     * @param[in] in_sgmDepthThicknessMap the SGM result depth/thickness map in host memory
+     */
+    void refineRc(const Tile& tile, const CpuMap<CpuFloat2>& in_sgmDepthThicknessMap);
+
+  private:
+    // private methods
+
+    /**
+     * @brief Refine and fuse the given depth/sim map using volume strategy.
+     * @param[in] tile The given tile for Refine computation
+     */
+    void refineAndFuseDepthSimMap(const Tile& tile);
+
+    // private members
+
+    const mvsUtils::MultiViewParams& _mp;     //< multi-view parameters
+    const mvsUtils::TileParams& _tileParams;  //< tile workflow parameters
+    const RefineParams& _refineParams;        //< Refine parameters
+    const CpuCache& _cache;                   //< host mipmap image cache
+
+    // private members in host memory
+
+    CpuMap<CpuFloat2> _sgmDepthPixSizeMap;       //< rc upscaled SGM depth/pixSize map
+    CpuMap<CpuFloat2> _refinedDepthSimMap;       //< rc refined and fused depth/sim map
+    CpuVolume<TSimRefineCpu> _volumeRefineSim;  //< rc refine similarity volume
+};
+
+}  // namespace depthMap
+}  // namespace aliceVision
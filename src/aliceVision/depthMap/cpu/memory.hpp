@@ -0,0 +1,162 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/*
+ * @note TSimCpu is the similarity type for volume in host memory.
+ * @note TSimAccCpu is the similarity accumulation type for volume in host memory.
+ * @note TSimRefineCpu is the similarity type for volume refinement in host memory.
+ * @note Same value ranges as the CUDA TSim / TSimAcc / TSimRefine types.
+ */
+using TSimCpu = unsigned char;
+using TSimAccCpu = unsigned int;
+using TSimRefineCpu = float;
+
+/**
+ * @struct CpuFloat2
+ * @brief Support class to store a pair of float values (depth/sim, depth/thickness, ...) in host memory.
+ */
+struct CpuFloat2
+{
+    float x = 0.f;
+    float y = 0.f;
+};
+
+/**
+ * @struct CpuRGBA
+ * @brief Support class to store a CIELAB / RGBA pixel in range (0, 255) in host memory.
+ */
+struct CpuRGBA
+{
+    float x = 0.f;
+    float y = 0.f;
+    float z = 0.f;
+    float w = 0.f;
+};
+
+/**
+ * @class CpuMap
+ * @brief Support class to maintain a 2d buffer in host memory.
+ * @note Row-major layout (x is the fastest dimension).
+ */
+template<typename T>
+class CpuMap
+{
+  public:
+    CpuMap() = default;
+
+    CpuMap(std::size_t width, std::size_t height) { allocate(width, height); }
+
+    inline void allocate(std::size_t width, std::size_t height)
+    {
+        _width = width;
+        _height = height;
+        _data.resize(width * height);
+    }
+
+    inline void fill(const T& value) { std::fill(_data.begin(), _data.end(), value); }
+
+    inline std::size_t width() const { return _width; }
+    inline std::size_t height() const { return _height; }
+    inline std::size_t getBytes() const { return _data.size() * sizeof(T); }
+
+    inline T& operator()(std::size_t x, std::size_t y)
+    {
+        assert(x < _width && y < _height);
+        return _data[y * _width + x];
+    }
+
+    inline const T& operator()(std::size_t x, std::size_t y) const
+    {
+        assert(x < _width && y < _height);
+        return _data[y * _width + x];
+    }
+
+    inline T* data() { return _data.data(); }
+    inline const T* data() const { return _data.data(); }
+
+  private:
+    std::size_t _width = 0;
+    std::size_t _height = 0;
+    std::vector<T> _data;
+};
+
+/**
+ * @class CpuVolume
+ * @brief Support class to maintain a 3d similarity volume in host memory.
+ * @note Depth-major layout (z is the fastest dimension): each pixel depth column is contiguous,
+ *       which allows vectorized SGM aggregation and best depth retrieval.
+ */
+template<typename T>
+class CpuVolume
+{
+  public:
+    CpuVolume() = default;
+
+    CpuVolume(std::size_t dimX, std::size_t dimY, std::size_t dimZ) { allocate(dimX, dimY, dimZ); }
+
+    inline void allocate(std::size_t dimX, std::size_t dimY, std::size_t dimZ)
+    {
+        _dimX = dimX;
+        _dimY = dimY;
+        _dimZ = dimZ;
+        _data.resize(dimX * dimY * dimZ);
+    }
+
+    inline void fill(const T& value) { std::fill(_data.begin(), _data.end(), value); }
+
+    inline std::size_t dimX() const { return _dimX; }
+    inline std::size_t dimY() const { return _dimY; }
+    inline std::size_t dimZ() const { return _dimZ; }
+    inline std::size_t getBytes() const { return _data.size() * sizeof(T); }
+
+    /// @return pointer to the depth column of the given pixel
+    inline T* column(std::size_t x, std::size_t y)
+    {
+        assert(x < _dimX && y < _dimY);
+        return _data.data() + (y * _dimX + x) * _dimZ;
+    }
+
+    /// @return pointer to the depth column of the given pixel
+    inline const T* column(std::size_t x, std::size_t y) const
+    {
+        assert(x < _dimX && y < _dimY);
+        return _data.data() + (y * _dimX + x) * _dimZ;
+    }
+
+    inline T& operator()(std::size_t x, std::size_t y, std::size_t z)
+    {
+        assert(z < _dimZ);
+        return column(x, y)[z];
+    }
+
+    inline const T& operator()(std::size_t x, std::size_t y, std::size_t z) const
+    {
+        assert(z < _dimZ);
+        return column(x, y)[z];
+    }
+
+    inline T* data() { return _data.data(); }
+    inline const T* data() const { return _data.data(); }
+
+  private:
+    std::size_t _dimX = 0;
+    std::size_t _dimY = 0;
+    std::size_t _dimZ = 0;
+    std::vector<T> _data;
+};
+
+}  // namespace depthMap
+}  // namespace aliceVision
@@ -0,0 +1,258 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/depthMap/cpu/memory.hpp>
+#include <aliceVision/depthMap/cpu/CpuCameraParams.hpp>
+#include <aliceVision/depthMap/cpu/CpuMipmapImage.hpp>
+
+#include <cmath>
+#include <limits>
+
+// for the R camera, image alpha should be at least 0.9f (computation area)
+#define ALICEVISION_DEPTHMAP_CPU_RC_MIN_ALPHA (255.f * 0.9f)  // range (0, 255)
+
+// for the T camera, image alpha should be at least 0.4f (masking)
+#define ALICEVISION_DEPTHMAP_CPU_TC_MIN_ALPHA (255.f * 0.4f)  // range (0, 255)
+
+namespace aliceVision {
+namespace depthMap {
+
+/*
+ * @note CPU counterparts of the device functions in cuda/device/Patch.cuh, color.cuh, matrix.cuh and SimStat.cuh.
+ *       Computations are kept identical in order to give the same results as the CUDA backend
+ *       (up to texture interpolation precision).
+ */
+
+struct CpuPatch
+{
+    Vec3f p;  //< 3d point
+    Vec3f n;  //< normal
+    Vec3f x;  //< x axis
+    Vec3f y;  //< y axis
+    float d;  //< pixel size
+};
+
+inline Vec2f cpu_project3DPoint(const CpuCameraParams& camParams, const Vec3f& X)
+{
+    const Vec3f p = camParams.P.block<3, 3>(0, 0) * X + camParams.P.col(3);
+    const float pzInv = 1.0f / p.z();
+    return Vec2f(p.x() * pzInv, p.y() * pzInv);
+}
+
+inline Vec3f cpu_pixelRay(const CpuCameraParams& camParams, const Vec2f& pix)
+{
+    return (camParams.iP * Vec3f(pix.x(), pix.y(), 1.f)).normalized();
+}
+
+inline Vec3f cpu_linePlaneIntersect(const Vec3f& linePoint, const Vec3f& lineVect, const Vec3f& planePoint, const Vec3f& planeNormal)
+{
+    const float k = (planePoint.dot(planeNormal) - planeNormal.dot(linePoint)) / planeNormal.dot(lineVect);
+    return linePoint + lineVect * k;
+}
+
+inline float cpu_computePixSize(const CpuCameraParams& camParams, const Vec3f& p)
+{
+    const Vec2f rp1 = cpu_project3DPoint(camParams, p) + Vec2f(1.f, 0.f);
+    const Vec3f refvect = cpu_pixelRay(camParams, rp1);
+    return refvect.cross(camParams.C - p).norm();
+}
+
+inline Vec3f cpu_get3DPointForPixelAndFrontoParellePlaneRC(const CpuCameraParams& camParams, const Vec2f& pix, float fpPlaneDepth)
+{
+    const Vec3f planep = camParams.C + camParams.ZVect * fpPlaneDepth;
+    return cpu_linePlaneIntersect(camParams.C, cpu_pixelRay(camParams, pix), planep, camParams.ZVect);
+}
+
+inline Vec3f cpu_get3DPointForPixelAndDepthFromRC(const CpuCameraParams& camParams, const Vec2f& pix, float depth)
+{
+    return camParams.C + cpu_pixelRay(camParams, pix) * depth;
+}
+
+inline float cpu_depthPlaneToDepth(const CpuCameraParams& camParams, float fpPlaneDepth, const Vec2f& pix)
+{
+    return (camParams.C - cpu_get3DPointForPixelAndFrontoParellePlaneRC(camParams, pix, fpPlaneDepth)).norm();
+}
+
+inline void cpu_computeRotCSEpip(CpuPatch& patch, const CpuCameraParams& rcCamParams, const CpuCameraParams& tcCamParams)
+{
+    // vector from the reference camera to the 3d point
+    const Vec3f v1 = (rcCamParams.C - patch.p).normalized();
+    // vector from the target camera to the 3d point
+    const Vec3f v2 = (tcCamParams.C - patch.p).normalized();
+
+    // y has to be ortogonal to the epipolar plane
+    // n has to be on the epipolar plane
+    // x has to be on the epipolar plane
+    patch.y = v1.cross(v2).normalized();
+    patch.n = ((v1 + v2) / 2.0f).normalized();
+    patch.x = patch.y.cross(patch.n).normalized();
+}
+
+inline float cpu_sigmoid(float zeroVal, float endVal, float sigwidth, float sigMid, float xval)
+{
+    return zeroVal + (endVal - zeroVal) * (1.0f / (1.0f + std::exp(10.0f * ((xval - sigMid) / sigwidth))));
+}
+
+/**
+ * @brief CIELAB color distance (first three channels).
+ */
+inline float cpu_colorDistanceLab(const CpuRGBA& c1, const CpuRGBA& c2)
+{
+    return std::sqrt((c1.x - c2.x) * (c1.x - c2.x) + (c1.y - c2.y) * (c1.y - c2.y) + (c1.z - c2.z) * (c1.z - c2.z));
+}
+
+/**
+ * @brief Weighted Normalized Cross-Correlation statistics.
+ */
+struct CpuSimStat
+{
+    float xsum = 0.f;
+    float ysum = 0.f;
+    float xxsum = 0.f;
+    float yysum = 0.f;
+    float xysum = 0.f;
+    float wsum = 0.f;
+
+    inline void update(float gx, float gy, float w)
+    {
+        wsum += w;
+        xsum += w * gx;
+        ysum += w * gy;
+        xxsum += w * gx * gx;
+        yysum += w * gy * gy;
+        xysum += w * gx * gy;
+    }
+
+    /**
+     * @brief Compute Normalized Cross-Correlation.
+     * @return similarity value in range (-1, 0) or 1 if infinity
+     */
+    inline float computeWSim() const
+    {
+        const float varXW = (xxsum - xsum * xsum / wsum) / wsum;
+        const float varYW = (yysum - ysum * ysum / wsum) / wsum;
+        const float varXYW = (xysum - xsum * ysum / wsum) / wsum;
+        const float rawSim = varXYW / std::sqrt(varXW * varYW);
+        return std::isfinite(rawSim) ? -rawSim : 1.0f;
+    }
+};
+
+/**
+ * @brief Compute Normalized Cross-Correlation of a full square patch at given half-width.
+ *
+ * @tparam TInvertAndFilter invert and filter output similarity value
+ *
+ * @return similarity value in range (-1.f, 0.f) or (0.f, 1.f) if TInvertAndFilter enabled
+ *         special cases:
+ *          -> infinite similarity value: 1
+ *          -> invalid/uninitialized/masked similarity: std::numeric_limits<float>::infinity()
+ */
+template<bool TInvertAndFilter>
+inline float cpu_compNCCby3DptsYK(const CpuCameraParams& rcCamParams,
+                                  const CpuCameraParams& tcCamParams,
+                                  const CpuMipmapImage& rcMipmapImage,
+                                  const CpuMipmapImage& tcMipmapImage,
+                                  int rcLevelWidth,
+                                  int rcLevelHeight,
+                                  int tcLevelWidth,
+                                  int tcLevelHeight,
+                                  float mipmapLevel,
+                                  int wsh,
+                                  float invGammaC,
+                                  float invGammaP,
+                                  const CpuPatch& patch)
+{
+    constexpr float invalid = std::numeric_limits<float>::infinity();
+
+    // get R and T image 2d coordinates from patch center 3d point
+    const Vec2f rp = cpu_project3DPoint(rcCamParams, patch.p);
+    const Vec2f tp = cpu_project3DPoint(tcCamParams, patch.p);
+
+    // image 2d coordinates margin
+    const float dd = float(wsh) + 2.0f;
+
+    // check R and T image 2d coordinates
+    if ((rp.x() < dd) || (rp.x() > float(rcLevelWidth - 1) - dd) || (tp.x() < dd) || (tp.x() > float(tcLevelWidth - 1) - dd) || (rp.y() < dd) ||
+        (rp.y() > float(rcLevelHeight - 1) - dd) || (tp.y() < dd) || (tp.y() > float(tcLevelHeight - 1) - dd))
+    {
+        return invalid;  // uninitialized
+    }
+
+    // compute inverse width / height
+    // note: useful to compute normalized coordinates
+    const float rcInvLevelWidth = 1.f / float(rcLevelWidth);
+    const float rcInvLevelHeight = 1.f / float(rcLevelHeight);
+    const float tcInvLevelWidth = 1.f / float(tcLevelWidth);
+    const float tcInvLevelHeight = 1.f / float(tcLevelHeight);
+
+    // compute patch center color (CIELAB) at R and T mipmap image level
+    const CpuRGBA rcCenterColor = rcMipmapImage.sample((rp.x() + 0.5f) * rcInvLevelWidth, (rp.y() + 0.5f) * rcInvLevelHeight, mipmapLevel);
+    const CpuRGBA tcCenterColor = tcMipmapImage.sample((tp.x() + 0.5f) * tcInvLevelWidth, (tp.y() + 0.5f) * tcInvLevelHeight, mipmapLevel);
+
+    // check the alpha values of the patch pixel center of the R and T cameras
+    if (rcCenterColor.w < ALICEVISION_DEPTHMAP_CPU_RC_MIN_ALPHA || tcCenterColor.w < ALICEVISION_DEPTHMAP_CPU_TC_MIN_ALPHA)
+        return invalid;  // masked
+
+    CpuSimStat sst;
+
+    // the patch 3d points are an affine function of (xp, yp):
+    // precompute the projection of the patch center and axes to avoid a full 3x4 product per sample
+    const Eigen::Matrix3f rcM = rcCamParams.P.block<3, 3>(0, 0);
+    const Eigen::Matrix3f tcM = tcCamParams.P.block<3, 3>(0, 0);
+
+    const Vec3f rcP0 = rcM * patch.p + rcCamParams.P.col(3);
+    const Vec3f tcP0 = tcM * patch.p + tcCamParams.P.col(3);
+    const Vec3f rcDx = rcM * (patch.x * patch.d);
+    const Vec3f rcDy = rcM * (patch.y * patch.d);
+    const Vec3f tcDx = tcM * (patch.x * patch.d);
+    const Vec3f tcDy = tcM * (patch.y * patch.d);
+
+    // compute patch (wsh*2+1)x(wsh*2+1)
+    for (int yp = -wsh; yp <= wsh; ++yp)
+    {
+        for (int xp = -wsh; xp <= wsh; ++xp)
+        {
+            // get R and T image 2d coordinates from 3d point
+            const Vec3f rph = rcP0 + rcDx * float(xp) + rcDy * float(yp);
+            const Vec3f tph = tcP0 + tcDx * float(xp) + tcDy * float(yp);
+
+            const float rpcx = rph.x() / rph.z();
+            const float rpcy = rph.y() / rph.z();
+            const float tpcx = tph.x() / tph.z();
+            const float tpcy = tph.y() / tph.z();
+
+            // get R and T image color (CIELAB) from 2d coordinates
+            const CpuRGBA rcPatchCoordColor = rcMipmapImage.sample((rpcx + 0.5f) * rcInvLevelWidth, (rpcy + 0.5f) * rcInvLevelHeight, mipmapLevel);
+            const CpuRGBA tcPatchCoordColor = tcMipmapImage.sample((tpcx + 0.5f) * tcInvLevelWidth, (tpcy + 0.5f) * tcInvLevelHeight, mipmapLevel);
+
+            // compute weighting based on color difference and distance to the center pixel of the patch
+            // note: product of the R and T Yoon & Kweon weights, computed with a single exponential
+            const float deltaC = (cpu_colorDistanceLab(rcCenterColor, rcPatchCoordColor) + cpu_colorDistanceLab(tcCenterColor, tcPatchCoordColor)) * invGammaC;
+            const float deltaP = 2.f * std::sqrt(float(xp * xp + yp * yp)) * invGammaP;
+            const float w = std::exp(-(deltaC + deltaP));
+
+            // update simStat
+            sst.update(rcPatchCoordColor.x, tcPatchCoordColor.x, w);
+        }
+    }
+
+    if (TInvertAndFilter)
+    {
+        // invert and filter similarity
+        // best similarity value was -1, worst was 0
+        // best similarity value is 1, worst is still 0
+        return cpu_sigmoid(0.0f, 1.0f, 0.7f, -0.7f, sst.computeWSim());
+    }
+
+    // compute output patch similarity
+    return sst.computeWSim();
+}
+
+}  // namespace depthMap
+}  // namespace aliceVision
@@ -0,0 +1,666 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "similarityVolume.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/depthMap/cpu/patch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+
+namespace aliceVision {
+namespace depthMap {
+
+namespace {
+
+/**
+ * @brief Aggregate the similarity volume along one SGM path (one axis, one direction).
+ * @note CPU counterpart of cuda_volumeAggregatePath.
+ *       Each line perpendicular to the path is independent: lines are processed in parallel,
+ *       the sequential recurrence along the path is computed on full depth columns with SIMD.
+ */
+void volumeAggregatePath(CpuVolume<TSimCpu>& out_volAgr,
+                         const CpuVolume<TSimCpu>& in_volSim,
+                         const CpuMipmapImage& rcMipmapImage,
+                         int rcLevelWidth,
+                         int rcLevelHeight,
+                         float rcMipmapLevel,
+                         bool alongX,
+                         const SgmParams& sgmParams,
+                         int volDimZ,
+                         int filteringIndex,
+                         bool invY,
+                         const ROI& roi)
+{
+    const int volDimX = int(in_volSim.dimX());
+    const int volDimY = int(in_volSim.dimY());
+
+    const int nbLines = alongX ? volDimY : volDimX;
+    const int lineLength = alongX ? volDimX : volDimY;
+
+    if (lineLength <= 0 || volDimZ <= 0)
+        return;
+
+    const int stepXY = sgmParams.stepXY;
+    const float P1 = float(sgmParams.p1);
+    const float P2Weighting = float(sgmParams.p2Weighting);
+    const float invRcLevelWidth = 1.f / float(rcLevelWidth);
+    const float invRcLevelHeight = 1.f / float(rcLevelHeight);
+    const float fIndex = float(filteringIndex);
+    const float invFIndexP1 = 1.f / float(filteringIndex + 1);
+
+#pragma omp parallel
+    {
+        // per-thread accumulation columns (previous and current position along the path)
+        std::vector<TSimAccCpu> colM1(volDimZ);
+        std::vector<TSimAccCpu> col(volDimZ);
+
+#pragma omp for schedule(dynamic)
+        for (int line = 0; line < nbLines; ++line)
+        {
+            const auto getVolumeCoords = [&](int i, int& vx, int& vy) {
+                const int l = invY ? (lineLength - 1 - i) : i;
+                vx = alongX ? l : line;
+                vy = alongX ? line : l;
+            };
+
+            int vx, vy;
+            getVolumeCoords(0, vx, vy);
+
+            // first slice: initialize the accumulation and the output volume
+            {
+                const TSimCpu* inCol = in_volSim.column(vx, vy);
+                TSimCpu* outCol = out_volAgr.column(vx, vy);
+
+                for (int z = 0; z < volDimZ; ++z)
+                {
+                    colM1[z] = TSimAccCpu(inCol[z]);
+                    outCol[z] = TSimCpu(255);
+                }
+            }
+
+            for (int i = 1; i < lineLength; ++i)
+            {
+                int vxM1, vyM1;
+                getVolumeCoords(i - 1, vxM1, vyM1);
+                getVolumeCoords(i, vx, vy);
+
+                // best similarity of the previous column
+                TSimAccCpu bestCostInColM1 = colM1[0];
+                for (int z = 1; z < volDimZ; ++z)
+                    bestCostInColM1 = std::min(bestCostInColM1, colM1[z]);
+
+                float P2 = 0;
+
+                if (P2Weighting < 0)
+                {
+                    // P2 convention: use negative value to skip the use of deltaC.
+                    P2 = std::abs(P2Weighting);
+                }
+                else
+                {
+                    const int imX0 = (roi.x.begin + vx) * stepXY;  // current
+                    const int imY0 = (roi.y.begin + vy) * stepXY;
+                    const int imX1 = (roi.x.begin + vxM1) * stepXY;  // M1
+                    const int imY1 = (roi.y.begin + vyM1) * stepXY;
+
+                    const CpuRGBA gcr0 =
+                      rcMipmapImage.sample((float(imX0) + 0.5f) * invRcLevelWidth, (float(imY0) + 0.5f) * invRcLevelHeight, rcMipmapLevel);
+                    const CpuRGBA gcr1 =
+                      rcMipmapImage.sample((float(imX1) + 0.5f) * invRcLevelWidth, (float(imY1) + 0.5f) * invRcLevelHeight, rcMipmapLevel);
+                    const float deltaC =
+                      std::sqrt((gcr0.x - gcr1.x) * (gcr0.x - gcr1.x) + (gcr0.y - gcr1.y) * (gcr0.y - gcr1.y) + (gcr0.z - gcr1.z) * (gcr0.z - gcr1.z));
+
+                    // see cuda volume_agregateCostVolumeAtXinSlices_kernel for sigmoid parameters
+                    P2 = cpu_sigmoid(80.f, 255.f, 80.f, P2Weighting, deltaC);
+                }
+
+                const TSimCpu* inCol = in_volSim.column(vx, vy);
+                TSimCpu* outCol = out_volAgr.column(vx, vy);
+                const TSimAccCpu* prev = colM1.data();
+                TSimAccCpu* cur = col.data();
+                const float bestCost = float(bestCostInColM1);
+                const float bestCostP2 = bestCost + P2;
+
+                // first and last depths are not aggregated
+                const auto writeBorder = [&](int z) {
+                    cur[z] = TSimAccCpu(255);
+                    outCol[z] = TSimCpu((float(outCol[z]) * fIndex + 255.f) * invFIndexP1);
+                };
+
+                writeBorder(0);
+
+#pragma omp simd
+                for (int z = 1; z < volDimZ - 1; ++z)
+                {
+                    const float minCost = std::min(std::min(float(prev[z]), float(prev[z - 1]) + P1), std::min(float(prev[z + 1]) + P1, bestCostP2));
+                    const float pathCost = float(inCol[z]) + minCost - bestCost;
+
+                    cur[z] = TSimAccCpu(pathCost);
+
+                    // clamp (TSimCpu = uchar)
+                    const float pathCostClamped = std::min(255.0f, std::max(0.0f, pathCost));
+                    outCol[z] = TSimCpu((float(outCol[z]) * fIndex + pathCostClamped) * invFIndexP1);
+                }
+
+                if (volDimZ > 1)
+                    writeBorder(volDimZ - 1);
+
+                std::swap(colM1, col);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+void cpu_volumeUpdateUninitializedSimilarity(const CpuVolume<TSimCpu>& in_volBestSim, CpuVolume<TSimCpu>& inout_volSecBestSim)
+{
+    assert(in_volBestSim.getBytes() == inout_volSecBestSim.getBytes());
+
+    const std::ptrdiff_t size = std::ptrdiff_t(in_volBestSim.dimX() * in_volBestSim.dimY() * in_volBestSim.dimZ());
+    const TSimCpu* best = in_volBestSim.data();
+    TSimCpu* secBest = inout_volSecBestSim.data();
+
+#pragma omp parallel for simd
+    for (std::ptrdiff_t i = 0; i < size; ++i)
+    {
+        if (secBest[i] >= TSimCpu(255))
+            secBest[i] = best[i];
+    }
+}
+
+void cpu_volumeComputeSimilarity(CpuVolume<TSimCpu>& out_volBestSim,
+                                 CpuVolume<TSimCpu>& out_volSecBestSim,
+                                 const std::vector<float>& in_depths,
+                                 const CpuCameraParams& rcCameraParams,
+                                 const CpuCameraParams& tcCameraParams,
+                                 const CpuMipmapImage& rcMipmapImage,
+                                 const CpuMipmapImage& tcMipmapImage,
+                                 const SgmParams& sgmParams,
+                                 const Range& depthRange,
+                                 const ROI& roi)
+{
+    const float rcMipmapLevel = rcMipmapImage.getLevel(sgmParams.scale);
+    const std::pair<int, int> rcLevelDim = rcMipmapImage.getDimensions(sgmParams.scale);
+    const std::pair<int, int> tcLevelDim = tcMipmapImage.getDimensions(sgmParams.scale);
+
+    const float invGammaC = 1.f / float(sgmParams.gammaC);
+    const float invGammaP = 1.f / float(sgmParams.gammaP);
+
+    // we do not need positive and filtered similarity values
+    constexpr bool invertAndFilter = false;
+
+    const int roiWidth = int(roi.width());
+    const int roiHeight = int(roi.height());
+
+#pragma omp parallel for schedule(dynamic)
+    for (int vy = 0; vy < roiHeight; ++vy)
+    {
+        for (int vx = 0; vx < roiWidth; ++vx)
+        {
+            // corresponding image coordinates
+            const Vec2f pix(float(roi.x.begin + vx) * float(sgmParams.stepXY), float(roi.y.begin + vy) * float(sgmParams.stepXY));
+
+            TSimCpu* bestCol = out_volBestSim.column(vx, vy);
+            TSimCpu* secBestCol = out_volSecBestSim.column(vx, vy);
+
+            for (unsigned int vz = depthRange.begin; vz < depthRange.end; ++vz)
+            {
+                // compute patch
+                CpuPatch patch;
+                patch.p = cpu_get3DPointForPixelAndFrontoParellePlaneRC(rcCameraParams, pix, in_depths[vz]);
+                patch.d = cpu_computePixSize(rcCameraParams, patch.p);
+                cpu_computeRotCSEpip(patch, rcCameraParams, tcCameraParams);
+
+                // compute patch similarity
+                float fsim = cpu_compNCCby3DptsYK<invertAndFilter>(rcCameraParams,
+                                                                   tcCameraParams,
+                                                                   rcMipmapImage,
+                                                                   tcMipmapImage,
+                                                                   rcLevelDim.first,
+                                                                   rcLevelDim.second,
+                                                                   tcLevelDim.first,
+                                                                   tcLevelDim.second,
+                                                                   rcMipmapLevel,
+                                                                   sgmParams.wsh,
+                                                                   invGammaC,
+                                                                   invGammaP,
+                                                                   patch);
+
+                if (fsim == std::numeric_limits<float>::infinity())  // invalid similarity
+                {
+                    fsim = 255.0f;  // 255 is the invalid similarity value
+                }
+                else  // valid similarity
+                {
+                    // remap similarity value from (-1, +1) to (0, 254)
+                    // 255 is reserved for the similarity initialization, i.e. undefined values
+                    fsim = std::min(1.0f, std::max(0.0f, (fsim + 1.0f) * 0.5f)) * 254.0f;
+                }
+
+                TSimCpu& fsim_1st = bestCol[vz];
+                TSimCpu& fsim_2nd = secBestCol[vz];
+
+                if (fsim < fsim_1st)
+                {
+                    fsim_2nd = fsim_1st;
+                    fsim_1st = TSimCpu(fsim);
+                }
+                else if (fsim < fsim_2nd)
+                {
+                    fsim_2nd = TSimCpu(fsim);
+                }
+            }
+        }
+    }
+}
+
+void cpu_volumeOptimize(CpuVolume<TSimCpu>& out_volSimFiltered,
+                        const CpuVolume<TSimCpu>& in_volSim,
+                        const CpuMipmapImage& rcMipmapImage,
+                        const SgmParams& sgmParams,
+                        int lastDepthIndex,
+                        const ROI& roi)
+{
+    const float rcMipmapLevel = rcMipmapImage.getLevel(sgmParams.scale);
+    const std::pair<int, int> rcLevelDim = rcMipmapImage.getDimensions(sgmParams.scale);
+
+    // override volume depth, use rc depth list last index
+    const int volDimZ = std::min(lastDepthIndex, int(in_volSim.dimZ()));
+
+    int npaths = 0;
+    const auto updateAggrVolume = [&](bool alongX, bool invY) {
+        volumeAggregatePath(out_volSimFiltered,
+                            in_volSim,
+                            rcMipmapImage,
+                            rcLevelDim.first,
+                            rcLevelDim.second,
+                            rcMipmapLevel,
+                            alongX,
+                            sgmParams,
+                            volDimZ,
+                            npaths,
+                            invY,
+                            roi);
+        npaths++;
+    };
+
+    const std::map<char, bool> mapAxes = {
+      {'X', true},   // aggregate along the X axis
+      {'Y', false},  // aggregate along the Y axis
+    };
+
+    for (char axis : sgmParams.filteringAxes)
+    {
+        const bool alongX = mapAxes.at(axis);
+        updateAggrVolume(alongX, false);  // forward
+        updateAggrVolume(alongX, true);   // backward
+    }
+}
+
+void cpu_volumeRetrieveBestDepth(CpuMap<CpuFloat2>& out_sgmDepthThicknessMap,
+                                 CpuMap<CpuFloat2>* out_sgmDepthSimMap,
+                                 const std::vector<float>& in_depths,
+                                 const CpuVolume<TSimCpu>& in_volSim,
+                                 const CpuCameraParams& rcCameraParams,
+                                 const SgmParams& sgmParams,
+                                 const Range& depthRange,
+                                 const ROI& roi)
+{
+    const int scaleStep = sgmParams.scale * sgmParams.stepXY;
+    const float thicknessMultFactor = 1.f + float(sgmParams.depthThicknessInflate);
+    const float maxSimilarity = float(sgmParams.maxSimilarity) * 254.f;  // convert from (0, 1) to (0, 254)
+    const int lastDepthIndex = int(in_depths.size()) - 1;
+
+    const int roiWidth = int(roi.width());
+    const int roiHeight = int(roi.height());
+
+#pragma omp parallel for
+    for (int vy = 0; vy < roiHeight; ++vy)
+    {
+        for (int vx = 0; vx < roiWidth; ++vx)
+        {
+            // corresponding image coordinates
+            const Vec2f pix(float((roi.x.begin + vx) * scaleStep), float((roi.y.begin + vy) * scaleStep));
+
+            CpuFloat2& out_bestDepthThickness = out_sgmDepthThicknessMap(vx, vy);
+            CpuFloat2* out_bestDepthSimPtr = (out_sgmDepthSimMap == nullptr) ? nullptr : &(*out_sgmDepthSimMap)(vx, vy);
+
+            // find the best depth plane index for the current pixel
+            // - best possible similarity value is 0
+            // - worst possible similarity value is 254
+            // - invalid similarity value is 255
+            const TSimCpu* simCol = in_volSim.column(vx, vy);
+            float bestSim = 255.f;
+            int bestZIdx = -1;
+
+            for (int vz = int(depthRange.begin); vz < int(depthRange.end); ++vz)
+            {
+                const float simAtZ = float(simCol[vz]);
+
+                if (simAtZ < bestSim)
+                {
+                    bestSim = simAtZ;
+                    bestZIdx = vz;
+                }
+            }
+
+            // filtering out invalid values and values with a too bad score (above the user maximum similarity threshold)
+            if ((bestZIdx == -1) || (bestSim > maxSimilarity))
+            {
+                out_bestDepthThickness = {-1.f, -1.f};  // invalid depth / thickness
+
+                if (out_bestDepthSimPtr != nullptr)
+                    *out_bestDepthSimPtr = {-1.f, 1.f};  // invalid depth, worst similarity value
+
+                continue;
+            }
+
+            // find best depth plane previous and next indexes
+            const int bestZIdx_m1 = std::max(0, bestZIdx - 1);
+            const int bestZIdx_p1 = std::min(lastDepthIndex, bestZIdx + 1);
+
+            const float bestDepth = cpu_depthPlaneToDepth(rcCameraParams, in_depths[bestZIdx], pix);
+            const float bestDepth_m1 = cpu_depthPlaneToDepth(rcCameraParams, in_depths[bestZIdx_m1], pix);
+            const float bestDepth_p1 = cpu_depthPlaneToDepth(rcCameraParams, in_depths[bestZIdx_p1], pix);
+
+            const float out_bestSim = (bestSim / 255.0f) * 2.0f - 1.0f;  // convert from (0, 255) to (-1, +1)
+
+            // thickness is the maximum distance between output best depth and previous or next depth
+            const float out_bestDepthThickness_ = std::max(bestDepth_p1 - bestDepth, bestDepth - bestDepth_m1) * thicknessMultFactor;
+
+            out_bestDepthThickness = {bestDepth, out_bestDepthThickness_};
+
+            if (out_bestDepthSimPtr != nullptr)
+                *out_bestDepthSimPtr = {bestDepth, out_bestSim};
+        }
+    }
+}
+
+void cpu_volumeRefineSimilarity(CpuVolume<TSimRefineCpu>& inout_volSim,
+                                const CpuMap<CpuFloat2>& in_sgmDepthPixSizeMap,
+                                const CpuCameraParams& rcCameraParams,
+                                const CpuCameraParams& tcCameraParams,
+                                const CpuMipmapImage& rcMipmapImage,
+                                const CpuMipmapImage& tcMipmapImage,
+                                const RefineParams& refineParams,
+                                const Range& depthRange,
+                                const ROI& roi)
+{
+    const float rcMipmapLevel = rcMipmapImage.getLevel(refineParams.scale);
+    const std::pair<int, int> rcLevelDim = rcMipmapImage.getDimensions(refineParams.scale);
+    const std::pair<int, int> tcLevelDim = tcMipmapImage.getDimensions(refineParams.scale);
+
+    const int volDimZ = int(inout_volSim.dimZ());
+    const float invGammaC = 1.f / float(refineParams.gammaC);
+    const float invGammaP = 1.f / float(refineParams.gammaP);
+
+    // we need positive and filtered similarity values
+    constexpr bool invertAndFilter = true;
+
+    const int roiWidth = int(roi.width());
+    const int roiHeight = int(roi.height());
+
+#pragma omp parallel for schedule(dynamic)
+    for (int vy = 0; vy < roiHeight; ++vy)
+    {
+        for (int vx = 0; vx < roiWidth; ++vx)
+        {
+            // corresponding input sgm depth/pixSize (middle depth)
+            const CpuFloat2& in_sgmDepthPixSize = in_sgmDepthPixSizeMap(vx, vy);
+
+            // sgm depth (middle depth) invalid or masked
+            if (in_sgmDepthPixSize.x <= 0.0f)
+                continue;
+
+            // corresponding image coordinates
+            const Vec2f pix(float(roi.x.begin + vx) * float(refineParams.stepXY), float(roi.y.begin + vy) * float(refineParams.stepXY));
+
+            // rc 3d point at sgm depth (middle depth) and its viewing ray
+            const Vec3f pMiddle = cpu_get3DPointForPixelAndDepthFromRC(rcCameraParams, pix, in_sgmDepthPixSize.x);
+            const Vec3f rpv = (pMiddle - rcCameraParams.C).normalized();
+
+            TSimRefineCpu* simCol = inout_volSim.column(vx, vy);
+
+            for (unsigned int vz = depthRange.begin; vz < depthRange.end; ++vz)
+            {
+                // move rc 3d point by relative depth index offset * sgm pixSize
+                const int relativeDepthIndexOffset = int(vz) - ((volDimZ - 1) / 2);
+
+                CpuPatch patch;
+                patch.p = pMiddle + rpv * (float(relativeDepthIndexOffset) * in_sgmDepthPixSize.y);
+                patch.d = cpu_computePixSize(rcCameraParams, patch.p);
+                cpu_computeRotCSEpip(patch, rcCameraParams, tcCameraParams);
+
+                const float fsimInvertedFiltered = cpu_compNCCby3DptsYK<invertAndFilter>(rcCameraParams,
+                                                                                         tcCameraParams,
+                                                                                         rcMipmapImage,
+                                                                                         tcMipmapImage,
+                                                                                         rcLevelDim.first,
+                                                                                         rcLevelDim.second,
+                                                                                         tcLevelDim.first,
+                                                                                         tcLevelDim.second,
+                                                                                         rcMipmapLevel,
+                                                                                         refineParams.wsh,
+                                                                                         invGammaC,
+                                                                                         invGammaP,
+                                                                                         patch);
+
+                if (fsimInvertedFiltered == std::numeric_limits<float>::infinity())  // invalid similarity
+                    continue;
+
+                // add the output similarity value
+                simCol[vz] += TSimRefineCpu(fsimInvertedFiltered);
+            }
+        }
+    }
+}
+
+void cpu_volumeRefineBestDepth(CpuMap<CpuFloat2>& out_refineDepthSimMap,
+                               const CpuMap<CpuFloat2>& in_sgmDepthPixSizeMap,
+                               const CpuVolume<TSimRefineCpu>& in_volSim,
+                               const RefineParams& refineParams,
+                               const ROI& roi)
+{
+    const int volDimZ = int(in_volSim.dimZ());
+    const int samplesPerPixSize = refineParams.nbSubsamples;
+    const int halfNbDepths = refineParams.halfNbDepths;
+    const int halfNbSamples = samplesPerPixSize * halfNbDepths;
+    const int nbSamples = 2 * halfNbSamples + 1;
+    const float twoTimesSigmaPowerTwo = float(2.0 * refineParams.sigma * refineParams.sigma);
+
+    // precompute the sliding gaussian window weights, identical for all pixels
+    // see: https://www.desmos.com/calculator/ribalnoawq
+    std::vector<float> gaussianWeights(std::size_t(nbSamples) * volDimZ);
+    for (int si = 0; si < nbSamples; ++si)
+    {
+        const int sample = si - halfNbSamples;
+        for (int vz = 0; vz < volDimZ; ++vz)
+        {
+            const int zs = (vz - halfNbDepths) * samplesPerPixSize;  // relative sample offset
+            gaussianWeights[std::size_t(si) * volDimZ + vz] = std::exp(-float((zs - sample) * (zs - sample)) / twoTimesSigmaPowerTwo);
+        }
+    }
+
+    const int roiWidth = int(roi.width());
+    const int roiHeight = int(roi.height());
+
+#pragma omp parallel for
+    for (int vy = 0; vy < roiHeight; ++vy)
+    {
+        for (int vx = 0; vx < roiWidth; ++vx)
+        {
+            const CpuFloat2& in_sgmDepthPixSize = in_sgmDepthPixSizeMap(vx, vy);
+            CpuFloat2& out_bestDepthSim = out_refineDepthSimMap(vx, vy);
+
+            // sgm depth (middle depth) invalid or masked
+            if (in_sgmDepthPixSize.x <= 0.0f)
+            {
+                out_bestDepthSim = {in_sgmDepthPixSize.x, 1.0f};  // -1 (invalid) or -2 (masked)
+                continue;
+            }
+
+            const TSimRefineCpu* invSimSumCol = in_volSim.column(vx, vy);
+
+            // find best z sample per pixel
+            float bestSampleSim = 0.f;      // all sample sim <= 0.f
+            int bestSampleOffsetIndex = 0;  // default is middle depth (SGM)
+
+            for (int si = 0; si < nbSamples; ++si)
+            {
+                const float* weights = gaussianWeights.data() + std::size_t(si) * volDimZ;
+                float sampleSim = 0.f;
+
+                // the inverted similarity sum best value is the HIGHEST, reverse it
+#pragma omp simd reduction(+ : sampleSim)
+                for (int vz = 0; vz < volDimZ; ++vz)
+                    sampleSim -= float(invSimSumCol[vz]) * weights[vz];
+
+                if (sampleSim < bestSampleSim)
+                {
+                    bestSampleOffsetIndex = si - halfNbSamples;
+                    bestSampleSim = sampleSim;
+                }
+            }
+
+            // input sgm depth (middle depth) + sample size offset from z center
+            const float sampleSize = in_sgmDepthPixSize.y / float(samplesPerPixSize);
+            const float bestDepth = in_sgmDepthPixSize.x + float(bestSampleOffsetIndex) * sampleSize;
+
+            out_bestDepthSim = {bestDepth, bestSampleSim};
+        }
+    }
+}
+
+void cpu_depthThicknessSmoothThickness(CpuMap<CpuFloat2>& inout_depthThicknessMap,
+                                       const SgmParams& sgmParams,
+                                       const RefineParams& refineParams,
+                                       const ROI& roi)
+{
+    const int sgmScaleStep = sgmParams.scale * sgmParams.stepXY;
+    const int refineScaleStep = refineParams.scale * refineParams.stepXY;
+
+    // min/max number of Refine samples in SGM thickness area
+    const float minNbRefineSamples = 2.f;
+    const float maxNbRefineSamples = std::max(sgmScaleStep / float(refineScaleStep), minNbRefineSamples);
+
+    // min/max SGM thickness inflate factor
+    const float minThicknessInflate = refineParams.halfNbDepths / maxNbRefineSamples;
+    const float maxThicknessInflate = refineParams.halfNbDepths / minNbRefineSamples;
+
+    const int roiWidth = int(roi.width());
+    const int roiHeight = int(roi.height());
+
+    // read neighbors from an unmodified copy to be independent from the processing order
+    const CpuMap<CpuFloat2> in_depthThicknessMap = inout_depthThicknessMap;
+
+#pragma omp parallel for
+    for (int roiY = 0; roiY < roiHeight; ++roiY)
+    {
+        for (int roiX = 0; roiX < roiWidth; ++roiX)
+        {
+            const CpuFloat2& in_depthThickness = in_depthThicknessMap(roiX, roiY);
+
+            // depth invalid or masked
+            if (in_depthThickness.x <= 0.0f)
+                continue;
+
+            const float minThickness = minThicknessInflate * in_depthThickness.y;
+            const float maxThickness = maxThicknessInflate * in_depthThickness.y;
+
+            // compute average depth distance to the center pixel
+            float sumCenterDepthDist = 0.f;
+            int nbValidPatchPixels = 0;
+
+            // patch 3x3
+            for (int yp = -1; yp <= 1; ++yp)
+            {
+                for (int xp = -1; xp <= 1; ++xp)
+                {
+                    const int roiXp = roiX + xp;
+                    const int roiYp = roiY + yp;
+
+                    if ((xp == 0 && yp == 0) || roiXp < 0 || roiXp >= roiWidth || roiYp < 0 || roiYp >= roiHeight)
+                        continue;
+
+                    const CpuFloat2& in_depthThicknessPatch = in_depthThicknessMap(roiXp, roiYp);
+
+                    if (in_depthThicknessPatch.x > 0.0f)
+                    {
+                        const float depthDistance = std::abs(in_depthThickness.x - in_depthThicknessPatch.x);
+                        sumCenterDepthDist += std::max(minThickness, std::min(maxThickness, depthDistance));
+                        ++nbValidPatchPixels;
+                    }
+                }
+            }
+
+            // we require at least 3 valid patch pixels (over 8)
+            if (nbValidPatchPixels < 3)
+                continue;
+
+            inout_depthThicknessMap(roiX, roiY).y = sumCenterDepthDist / nbValidPatchPixels;
+        }
+    }
+}
+
+void cpu_computeSgmUpscaledDepthPixSizeMap(CpuMap<CpuFloat2>& out_upscaledDepthPixSizeMap,
+                                           const CpuMap<CpuFloat2>& in_sgmDepthThicknessMap,
+                                           const CpuMipmapImage& rcMipmapImage,
+                                           const RefineParams& refineParams,
+                                           const ROI& roi)
+{
+    const float ratio = float(in_sgmDepthThicknessMap.width()) / float(out_upscaledDepthPixSizeMap.width());
+
+    const float rcMipmapLevel = rcMipmapImage.getLevel(refineParams.scale);
+    const std::pair<int, int> rcLevelDim = rcMipmapImage.getDimensions(refineParams.scale);
+
+    const int roiWidth = int(roi.width());
+    const int roiHeight = int(roi.height());
+    const int inWidth = int(in_sgmDepthThicknessMap.width());
+    const int inHeight = int(in_sgmDepthThicknessMap.height());
+
+#pragma omp parallel for
+    for (int roiY = 0; roiY < roiHeight; ++roiY)
+    {
+        for (int roiX = 0; roiX < roiWidth; ++roiX)
+        {
+            // corresponding image coordinates
+            const int x = (roi.x.begin + roiX) * refineParams.stepXY;
+            const int y = (roi.y.begin + roiY) * refineParams.stepXY;
+
+            CpuFloat2& out_depthPixSize = out_upscaledDepthPixSizeMap(roiX, roiY);
+
+            // filter masked pixels (same threshold as the CUDA kernel)
+            const CpuRGBA rc = rcMipmapImage.sample((float(x) + 0.5f) / float(rcLevelDim.first), (float(y) + 0.5f) / float(rcLevelDim.second), rcMipmapLevel);
+            if (rc.w < 0.9f)
+            {
+                out_depthPixSize = {-2.f, 0.f};
+                continue;
+            }
+
+            // find corresponding depth/thickness
+            // nearest neighbor, no interpolation
+            const float oy = (float(roiY) - 0.5f) * ratio;
+            const float ox = (float(roiX) - 0.5f) * ratio;
+
+            const int xp = std::max(0, std::min(int(std::floor(ox + 0.5f)), std::min(int(roiWidth * ratio), inWidth) - 1));
+            const int yp = std::max(0, std::min(int(std::floor(oy + 0.5f)), std::min(int(roiHeight * ratio), inHeight) - 1));
+
+            const CpuFloat2& in_depthThickness = in_sgmDepthThicknessMap(xp, yp);
+
+            // compute pixSize from depth thickness
+            out_depthPixSize = {in_depthThickness.x, in_depthThickness.y / float(refineParams.halfNbDepths)};
+        }
+    }
+}
+
+}  // namespace depthMap
+}  // namespace aliceVision
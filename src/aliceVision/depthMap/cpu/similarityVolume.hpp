@@ -0,0 +1,158 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/mvsData/ROI.hpp>
+#include <aliceVision/depthMap/SgmParams.hpp>
+#include <aliceVision/depthMap/RefineParams.hpp>
+#include <aliceVision/depthMap/cpu/memory.hpp>
+#include <aliceVision/depthMap/cpu/CpuCameraParams.hpp>
+#include <aliceVision/depthMap/cpu/CpuMipmapImage.hpp>
+
+#include <vector>
+
+namespace aliceVision {
+namespace depthMap {
+
+/*
+ * @note CPU counterparts of the cuda_volume* functions (see cuda/planeSweeping/deviceSimilarityVolume.hpp).
+ *       All volumes are indexed in the given ROI coordinates, i.e. volume (0, 0) is the ROI first pixel.
+ *       Functions are multithreaded with OpenMP, depth columns are processed with SIMD when possible.
+ */
+
+/**
+ * @brief Update second best similarity volume uninitialized values with first best volume values.
+ * @param[in] in_volBestSim the best similarity volume in host memory
+ * @param[out] inout_volSecBestSim the second best similarity volume in host memory
+ */
+void cpu_volumeUpdateUninitializedSimilarity(const CpuVolume<TSimCpu>& in_volBestSim, CpuVolume<TSimCpu>& inout_volSecBestSim);
+
+/**
+ * @brief Compute the best / second best similarity volume for the given RC / TC.
+ * @param[out] out_volBestSim the best similarity volume in host memory
+ * @param[out] out_volSecBestSim the second best similarity volume in host memory
+ * @param[in] in_depths the R camera depth list
+ * @param[in] rcCameraParams the R camera parameters at SGM scale
+ * @param[in] tcCameraParams the T camera parameters at SGM scale
+ * @param[in] rcMipmapImage the R mipmap image in host memory
+ * @param[in] tcMipmapImage the T mipmap image in host memory
+ * @param[in] sgmParams the Semi Global Matching parameters
+ * @param[in] depthRange the volume depth range to compute
+ * @param[in] roi the 2d region of interest
+ */
+void cpu_volumeComputeSimilarity(CpuVolume<TSimCpu>& out_volBestSim,
+                                 CpuVolume<TSimCpu>& out_volSecBestSim,
+                                 const std::vector<float>& in_depths,
+                                 const CpuCameraParams& rcCameraParams,
+                                 const CpuCameraParams& tcCameraParams,
+                                 const CpuMipmapImage& rcMipmapImage,
+                                 const CpuMipmapImage& tcMipmapImage,
+                                 const SgmParams& sgmParams,
+                                 const Range& depthRange,
+                                 const ROI& roi);
+
+/**
+ * @brief Filter / Optimize the given similarity volume
+ * @note Each aggregation path is processed line by line in parallel, depth columns with SIMD.
+ * @param[out] out_volSimFiltered the output similarity volume in host memory
+ * @param[in] in_volSim the input similarity volume in host memory
+ * @param[in] rcMipmapImage the R mipmap image in host memory
+ * @param[in] sgmParams the Semi Global Matching parameters
+ * @param[in] lastDepthIndex the R camera last depth index
+ * @param[in] roi the 2d region of interest
+ */
+void cpu_volumeOptimize(CpuVolume<TSimCpu>& out_volSimFiltered,
+                        const CpuVolume<TSimCpu>& in_volSim,
+                        const CpuMipmapImage& rcMipmapImage,
+                        const SgmParams& sgmParams,
+                        int lastDepthIndex,
+                        const ROI& roi);
+
+/**
+ * @brief Retrieve the best depth/sim in the given similarity volume.
+ * @param[out] out_sgmDepthThicknessMap the output depth/thickness map in host memory
+ * @param[out] out_sgmDepthSimMap the output best depth/sim map in host memory (or nullptr)
+ * @param[in] in_depths the R camera depth list
+ * @param[in] in_volSim the input similarity volume in host memory
+ * @param[in] rcCameraParams the R camera parameters at full resolution
+ * @param[in] sgmParams the Semi Global Matching parameters
+ * @param[in] depthRange the volume depth range to compute
+ * @param[in] roi the 2d region of interest
+ */
+void cpu_volumeRetrieveBestDepth(CpuMap<CpuFloat2>& out_sgmDepthThicknessMap,
+                                 CpuMap<CpuFloat2>* out_sgmDepthSimMap,
+                                 const std::vector<float>& in_depths,
+                                 const CpuVolume<TSimCpu>& in_volSim,
+                                 const CpuCameraParams& rcCameraParams,
+                                 const SgmParams& sgmParams,
+                                 const Range& depthRange,
+                                 const ROI& roi);
+
+/**
+ * @brief Refine the best similarity volume for the given RC / TC.
+ * @param[in,out] inout_volSim the similarity volume in host memory
+ * @param[in] in_sgmDepthPixSizeMap the SGM upscaled depth/pixSize map (useful to get middle depth) in host memory
+ * @param[in] rcCameraParams the R camera parameters at Refine scale
+ * @param[in] tcCameraParams the T camera parameters at Refine scale
+ * @param[in] rcMipmapImage the R mipmap image in host memory
+ * @param[in] tcMipmapImage the T mipmap image in host memory
+ * @param[in] refineParams the Refine parameters
+ * @param[in] depthRange the volume depth range to compute
+ * @param[in] roi the 2d region of interest
+ */
+void cpu_volumeRefineSimilarity(CpuVolume<TSimRefineCpu>& inout_volSim,
+                                const CpuMap<CpuFloat2>& in_sgmDepthPixSizeMap,
+                                const CpuCameraParams& rcCameraParams,
+                                const CpuCameraParams& tcCameraParams,
+                                const CpuMipmapImage& rcMipmapImage,
+                                const CpuMipmapImage& tcMipmapImage,
+                                const RefineParams& refineParams,
+                                const Range& depthRange,
+                                const ROI& roi);
+
+/**
+ * @brief Retrieve the best depth/sim in the given refined similarity volume.
+ * @param[out] out_refineDepthSimMap the output refined and fused depth/sim map in host memory
+ * @param[in] in_sgmDepthPixSizeMap the SGM upscaled depth/pixSize map (useful to get middle depth) in host memory
+ * @param[in] in_volSim the similarity volume in host memory
+ * @param[in] refineParams the Refine parameters
+ * @param[in] roi the 2d region of interest
+ */
+void cpu_volumeRefineBestDepth(CpuMap<CpuFloat2>& out_refineDepthSimMap,
+                               const CpuMap<CpuFloat2>& in_sgmDepthPixSizeMap,
+                               const CpuVolume<TSimRefineCpu>& in_volSim,
+                               const RefineParams& refineParams,
+                               const ROI& roi);
+
+/**
+ * @brief Smooth the given depth/thickness map thickness with adjacent pixels.
+ * @param[in,out] inout_depthThicknessMap the depth/thickness map in host memory
+ * @param[in] sgmParams the Semi Global Matching parameters
+ * @param[in] refineParams the Refine parameters
+ * @param[in] roi the 2d region of interest
+ */
+void cpu_depthThicknessSmoothThickness(CpuMap<CpuFloat2>& inout_depthThicknessMap,
+                                       const SgmParams& sgmParams,
+                                       const RefineParams& refineParams,
+                                       const ROI& roi);
+
+/**
+ * @brief Upscale the given SGM depth/thickness map, filter masked pixels and compute pixSize from thickness.
+ * @param[out] out_upscaledDepthPixSizeMap the output upscaled depth/pixSize map in host memory
+ * @param[in] in_sgmDepthThicknessMap the input SGM depth/thickness map in host memory
+ * @param[in] rcMipmapImage the R mipmap image in host memory
+ * @param[in] refineParams the Refine parameters
+ * @param[in] roi the 2d region of interest (at Refine scale)
+ */
+void cpu_computeSgmUpscaledDepthPixSizeMap(CpuMap<CpuFloat2>& out_upscaledDepthPixSizeMap,
+                                           const CpuMap<CpuFloat2>& in_sgmDepthThicknessMap,
+                                           const CpuMipmapImage& rcMipmapImage,
+                                           const RefineParams& refineParams,
+                                           const ROI& roi);
+
+}  // namespace depthMap
+}  // namespace aliceVision
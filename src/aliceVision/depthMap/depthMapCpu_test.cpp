@@ -0,0 +1,284 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/depthMap/SgmParams.hpp>
+#include <aliceVision/depthMap/RefineParams.hpp>
+#include <aliceVision/depthMap/cpu/memory.hpp>
+#include <aliceVision/depthMap/cpu/CpuCameraParams.hpp>
+#include <aliceVision/depthMap/cpu/CpuMipmapImage.hpp>
+#include <aliceVision/depthMap/cpu/similarityVolume.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#define BOOST_TEST_MODULE depthMapCpu
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::depthMap;
+
+// Synthetic scene:
+// - a textured fronto-parallel plane at Z = planeDepth
+// - a reference camera at the origin and a target camera translated along X
+// The CUDA backend cannot be exercised without a device, the CPU backend is compared to the ground truth instead.
+
+namespace {
+
+constexpr int imageWidth = 320;
+constexpr int imageHeight = 240;
+constexpr double focal = 250.0;
+constexpr double planeDepth = 10.0;
+constexpr double baseline = 2.0;
+
+struct SyntheticCamera
+{
+    Mat3 K;
+    Mat3 R;
+    Vec3 C;
+};
+
+SyntheticCamera makeCamera(double cx)
+{
+    SyntheticCamera cam;
+    cam.K << focal, 0.0, imageWidth * 0.5, 0.0, focal, imageHeight * 0.5, 0.0, 0.0, 1.0;
+    cam.R = Mat3::Identity();
+    cam.C = Vec3(cx, 0.0, 0.0);
+    return cam;
+}
+
+// smooth and non-periodic plane texture (range 0, 1)
+double planeTexture(double X, double Y)
+{
+    return 0.5 + 0.2 * std::sin(5.0 * X) * std::cos(4.0 * Y) + 0.15 * std::sin(9.0 * X + 7.0 * Y) + 0.1 * std::cos(12.0 * X - 10.0 * Y);
+}
+
+void renderPlane(image::Image<image::RGBAfColor>& out_img, const SyntheticCamera& cam)
+{
+    out_img.resize(imageWidth, imageHeight);
+
+    const Mat3 iK = cam.K.inverse();
+
+    for (int y = 0; y < imageHeight; ++y)
+    {
+        for (int x = 0; x < imageWidth; ++x)
+        {
+            // camera rotation is identity, intersect the pixel ray with the plane Z = planeDepth
+            const Vec3 ray = iK * Vec3(x, y, 1.0);
+            const Vec3 X = cam.C + ray * (planeDepth / ray.z());
+            const float v = float(planeTexture(X.x(), X.y()));
+            out_img(y, x) = image::RGBAfColor(v, v, v, 1.f);
+        }
+    }
+}
+
+double groundTruthDepth(const SyntheticCamera& cam, double x, double y)
+{
+    const Vec3 ray = cam.K.inverse() * Vec3(x, y, 1.0);
+    return (ray * (planeDepth / ray.z())).norm();
+}
+
+struct SyntheticScene
+{
+    SyntheticCamera rc = makeCamera(0.0);
+    SyntheticCamera tc = makeCamera(baseline);
+    CpuMipmapImage rcMipmap;
+    CpuMipmapImage tcMipmap;
+    std::vector<float> depths;
+
+    SyntheticScene(int minDownscale, int maxDownscale, int nbDepths)
+    {
+        image::Image<image::RGBAfColor> img;
+
+        renderPlane(img, rc);
+        rcMipmap.fill(img, minDownscale, maxDownscale);
+
+        renderPlane(img, tc);
+        tcMipmap.fill(img, minDownscale, maxDownscale);
+
+        // fronto-parallel planes depth list around the plane depth
+        depths.resize(nbDepths);
+        for (int i = 0; i < nbDepths; ++i)
+            depths[i] = float(planeDepth * 0.8 + (planeDepth * 0.4) * i / (nbDepths - 1));
+    }
+};
+
+void computeSgm(CpuMap<CpuFloat2>& out_depthThicknessMap, const SyntheticScene& scene, const SgmParams& sgmParams, const ROI& roi)
+{
+    const int nbDepths = int(scene.depths.size());
+    const Range depthRange(0, nbDepths);
+
+    CpuCameraParams rcParams, tcParams, rcParamsFullRes;
+    fillCpuCameraParams(rcParams, scene.rc.K, scene.rc.R, scene.rc.C, sgmParams.scale);
+    fillCpuCameraParams(tcParams, scene.tc.K, scene.tc.R, scene.tc.C, sgmParams.scale);
+    fillCpuCameraParams(rcParamsFullRes, scene.rc.K, scene.rc.R, scene.rc.C, 1);
+
+    CpuVolume<TSimCpu> volBestSim, volSecBestSim;
+    volBestSim.allocate(roi.width(), roi.height(), nbDepths);
+    volSecBestSim.allocate(roi.width(), roi.height(), nbDepths);
+    volBestSim.fill(TSimCpu(255));
+    volSecBestSim.fill(TSimCpu(255));
+
+    cpu_volumeComputeSimilarity(
+      volBestSim, volSecBestSim, scene.depths, rcParams, tcParams, scene.rcMipmap, scene.tcMipmap, sgmParams, depthRange, roi);
+    cpu_volumeUpdateUninitializedSimilarity(volBestSim, volSecBestSim);
+    cpu_volumeOptimize(volBestSim, volSecBestSim, scene.rcMipmap, sgmParams, nbDepths, roi);
+
+    out_depthThicknessMap.allocate(roi.width(), roi.height());
+    cpu_volumeRetrieveBestDepth(out_depthThicknessMap, nullptr, scene.depths, volBestSim, rcParamsFullRes, sgmParams, depthRange, roi);
+}
+
+/**
+ * @brief Count valid and accurate pixels of the given depth map.
+ */
+void checkDepthMap(const CpuMap<CpuFloat2>& depthMap,
+                   const SyntheticCamera& rc,
+                   int scaleStep,
+                   double tolerance,
+                   int& out_nbValid,
+                   int& out_nbAccurate)
+{
+    out_nbValid = 0;
+    out_nbAccurate = 0;
+
+    for (std::size_t y = 0; y < depthMap.height(); ++y)
+    {
+        for (std::size_t x = 0; x < depthMap.width(); ++x)
+        {
+            const float depth = depthMap(x, y).x;
+
+            if (depth <= 0.f)
+                continue;
+
+            ++out_nbValid;
+
+            const double gt = groundTruthDepth(rc, double(x * scaleStep), double(y * scaleStep));
+
+            if (std::abs(depth - gt) < tolerance * gt)
+                ++out_nbAccurate;
+        }
+    }
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(depthMapCpu_sgm_syntheticPlane)
+{
+    SgmParams sgmParams;
+    sgmParams.scale = 2;
+    sgmParams.stepXY = 2;
+
+    const SyntheticScene scene(1, 16, 64);
+
+    const int scaleStep = sgmParams.scale * sgmParams.stepXY;
+    const ROI roi = downscaleROI(ROI(0, imageWidth, 0, imageHeight), scaleStep);
+
+    CpuMap<CpuFloat2> depthThicknessMap;
+    computeSgm(depthThicknessMap, scene, sgmParams, roi);
+
+    int nbValid = 0;
+    int nbAccurate = 0;
+    checkDepthMap(depthThicknessMap, scene.rc, scaleStep, 0.02, nbValid, nbAccurate);
+
+    const int nbPixels = int(roi.width() * roi.height());
+
+    BOOST_TEST_MESSAGE("SGM (CPU): " << nbValid << " valid / " << nbPixels << " pixels, " << nbAccurate << " accurate.");
+
+    // the T camera does not see the left part of the plane
+    BOOST_CHECK_GT(nbValid, nbPixels / 2);
+    BOOST_CHECK_GT(nbAccurate, int(nbValid * 0.95));
+}
+
+BOOST_AUTO_TEST_CASE(depthMapCpu_refine_syntheticPlane)
+{
+    SgmParams sgmParams;
+    sgmParams.scale = 2;
+    sgmParams.stepXY = 2;
+
+    RefineParams refineParams;
+    refineParams.scale = 1;
+    refineParams.stepXY = 1;
+
+    const SyntheticScene scene(1, 16, 64);
+
+    const int sgmScaleStep = sgmParams.scale * sgmParams.stepXY;
+    const int refineScaleStep = refineParams.scale * refineParams.stepXY;
+    const ROI sgmRoi = downscaleROI(ROI(0, imageWidth, 0, imageHeight), sgmScaleStep);
+    const ROI refineRoi = downscaleROI(ROI(0, imageWidth, 0, imageHeight), refineScaleStep);
+
+    CpuMap<CpuFloat2> sgmDepthThicknessMap;
+    computeSgm(sgmDepthThicknessMap, scene, sgmParams, sgmRoi);
+    cpu_depthThicknessSmoothThickness(sgmDepthThicknessMap, sgmParams, refineParams, sgmRoi);
+
+    CpuMap<CpuFloat2> sgmDepthPixSizeMap;
+    sgmDepthPixSizeMap.allocate(refineRoi.width(), refineRoi.height());
+    cpu_computeSgmUpscaledDepthPixSizeMap(sgmDepthPixSizeMap, sgmDepthThicknessMap, scene.rcMipmap, refineParams, refineRoi);
+
+    CpuCameraParams rcParams, tcParams;
+    fillCpuCameraParams(rcParams, scene.rc.K, scene.rc.R, scene.rc.C, refineParams.scale);
+    fillCpuCameraParams(tcParams, scene.tc.K, scene.tc.R, scene.tc.C, refineParams.scale);
+
+    const int nbDepthsToRefine = refineParams.halfNbDepths * 2 + 1;
+
+    CpuVolume<TSimRefineCpu> volRefineSim;
+    volRefineSim.allocate(refineRoi.width(), refineRoi.height(), nbDepthsToRefine);
+    volRefineSim.fill(TSimRefineCpu(0.f));
+
+    cpu_volumeRefineSimilarity(
+      volRefineSim, sgmDepthPixSizeMap, rcParams, tcParams, scene.rcMipmap, scene.tcMipmap, refineParams, Range(0, nbDepthsToRefine), refineRoi);
+
+    CpuMap<CpuFloat2> refinedDepthSimMap;
+    refinedDepthSimMap.allocate(refineRoi.width(), refineRoi.height());
+    cpu_volumeRefineBestDepth(refinedDepthSimMap, sgmDepthPixSizeMap, volRefineSim, refineParams, refineRoi);
+
+    int sgmNbValid = 0;
+    int sgmNbAccurate = 0;
+    checkDepthMap(sgmDepthPixSizeMap, scene.rc, refineScaleStep, 0.005, sgmNbValid, sgmNbAccurate);
+
+    int nbValid = 0;
+    int nbAccurate = 0;
+    checkDepthMap(refinedDepthSimMap, scene.rc, refineScaleStep, 0.005, nbValid, nbAccurate);
+
+    BOOST_TEST_MESSAGE("Refine (CPU): " << nbValid << " valid pixels, " << nbAccurate << " accurate (SGM upscaled: " << sgmNbAccurate << ").");
+
+    BOOST_CHECK_EQUAL(nbValid, sgmNbValid);
+    BOOST_CHECK_GT(nbAccurate, int(nbValid * 0.9));
+    BOOST_CHECK_GE(nbAccurate, sgmNbAccurate);
+}
+
+BOOST_AUTO_TEST_CASE(depthMapCpu_sgm_throughput)
+{
+    SgmParams sgmParams;
+    sgmParams.scale = 2;
+    sgmParams.stepXY = 1;
+
+    const int nbDepths = 128;
+    const SyntheticScene scene(1, 16, nbDepths);
+    const int scaleStep = sgmParams.scale * sgmParams.stepXY;
+    const ROI roi = downscaleROI(ROI(0, imageWidth, 0, imageHeight), scaleStep);
+
+    system::Timer timer;
+
+    CpuMap<CpuFloat2> depthThicknessMap;
+    computeSgm(depthThicknessMap, scene, sgmParams, roi);
+
+    const double elapsed = timer.elapsed();
+    const double nbSamples = double(roi.width()) * double(roi.height()) * nbDepths;
+
+    BOOST_TEST_MESSAGE("SGM (CPU) throughput: " << (nbSamples / elapsed) * 1e-6 << " Mpixel.depth/s (" << elapsed << " s).");
+
+    // the full resolution and the finer depth sampling give the same quality as the SGM test
+    int nbValid = 0;
+    int nbAccurate = 0;
+    checkDepthMap(depthThicknessMap, scene.rc, scaleStep, 0.02, nbValid, nbAccurate);
+
+    const int nbPixels = int(roi.width() * roi.height());
+
+    BOOST_CHECK_GT(nbValid, nbPixels / 2);
+    BOOST_CHECK_GT(nbAccurate, int(nbValid * 0.95));
+}
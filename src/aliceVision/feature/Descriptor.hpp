@@ -306,5 +306,27 @@ inline void saveDescsToBinFile(const std::string& sfileNameDescs, DescriptorsT&
     file.close();
 }
 
+/// Save descriptors stored in a flat array (e.g. an external memory block) in the same binary format.
+template<typename DescriptorT>
+inline void saveDescsToBinFile(const std::string& sfileNameDescs, const DescriptorT* descs, std::size_t cardDesc)
+{
+    std::ofstream file(sfileNameDescs, std::ios::out | std::ios::binary);
+
+    if (!file.is_open())
+        throw std::runtime_error("Can't save descriptor binary file, can't open '" + sfileNameDescs + "' !");
+
+    // Write the number of descriptor
+    file.write((const char*)&cardDesc, sizeof(std::size_t));
+    for (std::size_t i = 0; i < cardDesc; ++i)
+    {
+        file.write((const char*)descs[i].getData(), DescriptorT::static_size * sizeof(typename DescriptorT::bin_type));
+    }
+
+    if (!file.good())
+        throw std::runtime_error("Can't save descriptor binary file, '" + sfileNameDescs + "' is incorrect !");
+
+    file.close();
+}
+
 }  // namespace feature
 }  // namespace aliceVision
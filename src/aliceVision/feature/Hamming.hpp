@@ -8,6 +8,7 @@
 #pragma once
 
 #include "metric.hpp"
+#include <aliceVision/feature/distanceKernels.hpp>
 
 #include <bitset>
 
@@ -110,64 +111,13 @@ struct Hamming
     }
 
     // Size must be equal to number of ElementType
+    // Uses the SIMD popcount kernels (best instruction set selected at runtime)
     template<typename Iterator1, typename Iterator2>
     inline ResultType operator()(Iterator1 a, Iterator2 b, size_t size) const
     {
-        ResultType result = 0;
-        // Windows & generic platforms:
-
-#ifdef PLATFORM_64_BIT
-        if (size % sizeof(uint64_t) == 0)
-        {
-            const uint64_t* pa = reinterpret_cast<const uint64_t*>(a);
-            const uint64_t* pb = reinterpret_cast<const uint64_t*>(b);
-            size /= (sizeof(uint64_t) / sizeof(unsigned char));
-            for (size_t i = 0; i < size; ++i, ++pa, ++pb)
-            {
-                result += popcnt64(*pa ^ *pb);
-            }
-        }
-        else if (size % sizeof(uint32_t) == 0)
-        {
-            const uint32_t* pa = reinterpret_cast<const uint32_t*>(a);
-            const uint32_t* pb = reinterpret_cast<const uint32_t*>(b);
-            size /= (sizeof(uint32_t) / sizeof(unsigned char));
-            for (size_t i = 0; i < size; ++i, ++pa, ++pb)
-            {
-                result += popcnt32(*pa ^ *pb);
-            }
-        }
-        else
-        {
-            const ElementType* a2 = reinterpret_cast<const ElementType*>(a);
-            const ElementType* b2 = reinterpret_cast<const ElementType*>(b);
-            for (size_t i = 0; i < size / (sizeof(unsigned char)); ++i)
-            {
-                result += pop_count_LUT[a2[i] ^ b2[i]];
-            }
-        }
-#else   // PLATFORM_64_BIT
-        if (size % sizeof(uint32_t) == 0)
-        {
-            const uint32_t* pa = reinterpret_cast<const uint32_t*>(a);
-            const uint32_t* pb = reinterpret_cast<const uint32_t*>(b);
-            size /= (sizeof(uint32_t) / sizeof(unsigned char));
-            for (size_t i = 0; i < size; ++i, ++pa, ++pb)
-            {
-                result += popcnt32(*pa ^ *pb);
-            }
-        }
-        else
-        {
-            const ElementType* a2 = reinterpret_cast<const ElementType*>(a);
-            const ElementType* b2 = reinterpret_cast<const ElementType*>(b);
-            for (size_t i = 0; i < size / (sizeof(unsigned char)); ++i)
-            {
-                result += pop_count_LUT[a2[i] ^ b2[i]];
-            }
-        }
-#endif  // PLATFORM_64_BIT
-        return result;
+        const std::uint8_t* pa = reinterpret_cast<const std::uint8_t*>(&(*a));
+        const std::uint8_t* pb = reinterpret_cast<const std::uint8_t*>(&(*b));
+        return hammingDistance(pa, pb, size * sizeof(ElementType));
     }
 };
 
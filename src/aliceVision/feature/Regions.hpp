@@ -12,11 +12,13 @@
 #include <aliceVision/feature/PointFeature.hpp>
 #include <aliceVision/feature/Descriptor.hpp>
 #include <aliceVision/feature/metric.hpp>
+#include <aliceVision/system/Logger.hpp>
 
 #include <string>
 #include <cstddef>
 #include <typeinfo>
 #include <memory>
+#include <mutex>
 
 namespace aliceVision {
 namespace feature {
@@ -85,6 +87,12 @@ class Regions
     virtual std::string Type_id() const = 0;
     virtual std::size_t DescriptorLength() const = 0;
 
+    /// size in bytes of a descriptor basis element
+    virtual std::size_t DescriptorElementSize() const = 0;
+
+    /// Return the number of descriptors (0 if only the features are loaded)
+    virtual std::size_t DescriptorCount() const = 0;
+
     /**
      * @brief Return a blind pointer to the container of the descriptors array.
      *
@@ -101,6 +109,22 @@ class Regions
 
     virtual void clearDescriptors() = 0;
 
+    /**
+     * @brief Use descriptors stored in an external memory block without copy (e.g. a memory-mapped regions container).
+     *
+     * @note: DescriptorRawData() points directly to the external memory.
+     *        Descriptors are only copied on the first std::vector access (Descriptors(), blindDescriptors()),
+     *        this copy is reported in the log, prefer DescriptorRawData() for read-only access.
+     *
+     * @param[in] descriptors pointer to the first descriptor, same layout as DescriptorRawData()
+     * @param[in] nbDescriptors the number of descriptors
+     * @param[in] memoryOwner keep the external memory alive as long as the regions use it
+     */
+    virtual void wrapDescriptors(const void* descriptors, std::size_t nbDescriptors, std::shared_ptr<const void> memoryOwner) = 0;
+
+    /// Return true if the descriptors are stored in an external memory block
+    virtual bool hasWrappedDescriptors() const = 0;
+
     /// Return the squared distance between two descriptors
     // A default metric is used according the descriptor type:
     // - Scalar: L2,
@@ -153,9 +177,51 @@ class FeatDescRegions : public Regions
   protected:
     std::vector<DescriptorT> _vec_descs;  // region descriptions
 
+    /// descriptors stored in an external memory block (see wrapDescriptors)
+    struct WrappedDescriptors
+    {
+        std::shared_ptr<const void> memoryOwner;
+        const DescriptorT* data = nullptr;
+        std::size_t size = 0;
+
+        /// lazy std::vector copy for the const Descriptors() accessor
+        std::vector<DescriptorT> copy;
+        std::once_flag copied;
+
+        const std::vector<DescriptorT>& getCopy()
+        {
+            std::call_once(copied, [this]() {
+                // reported once per descriptor type, this copy should stay out of the hot paths
+                static std::once_flag reported;
+                std::call_once(reported, [this]() {
+                    ALICEVISION_LOG_WARNING("Copy of " << size << " wrapped " << typeid(T).name()
+                                                       << " descriptors for a read-only std::vector access.");
+                });
+                copy.assign(data, data + size);
+            });
+            return copy;
+        }
+    };
+
+    std::shared_ptr<WrappedDescriptors> _wrappedDescs;
+
+    /// Release the external memory block, descriptors are copied in the regions own storage
+    inline void releaseWrappedDescriptors()
+    {
+        if (!_wrappedDescs)
+            return;
+        _vec_descs.assign(_wrappedDescs->data, _wrappedDescs->data + _wrappedDescs->size);
+        _wrappedDescs.reset();
+    }
+
+    /// Return the i-th descriptor from the external memory block or the regions own storage
+    inline const DescriptorT& descriptor(std::size_t i) const { return (_wrappedDescs) ? _wrappedDescs->data[i] : _vec_descs[i]; }
+
   public:
     std::string Type_id() const override { return typeid(T).name(); }
     std::size_t DescriptorLength() const override { return static_cast<std::size_t>(L); }
+    std::size_t DescriptorElementSize() const override { return sizeof(T); }
+    std::size_t DescriptorCount() const override { return (_wrappedDescs) ? _wrappedDescs->size : _vec_descs.size(); }
 
     bool IsScalar() const override { return regionType == ERegionType::Scalar; }
     bool IsBinary() const override { return regionType == ERegionType::Binary; }
@@ -165,6 +231,7 @@ class FeatDescRegions : public Regions
     /// Read from files the regions and their corresponding descriptors.
     void Load(const std::string& sfileNameFeats, const std::string& sfileNameDescs) override
     {
+        _wrappedDescs.reset();
         loadFeatsFromFile(sfileNameFeats, this->_vec_feats);
         loadDescsFromBinFile(sfileNameDescs, _vec_descs);
     }
@@ -173,37 +240,63 @@ class FeatDescRegions : public Regions
     void Save(const std::string& sfileNameFeats, const std::string& sfileNameDescs) const override
     {
         saveFeatsToFile(sfileNameFeats, this->_vec_feats);
-        saveDescsToBinFile(sfileNameDescs, _vec_descs);
+        SaveDesc(sfileNameDescs);
     }
 
-    void SaveDesc(const std::string& sfileNameDescs) const override { saveDescsToBinFile(sfileNameDescs, _vec_descs); }
+    void SaveDesc(const std::string& sfileNameDescs) const override
+    {
+        saveDescsToBinFile(sfileNameDescs, static_cast<const DescriptorT*>(DescriptorRawData()), DescriptorCount());
+    }
 
     /// Mutable and non-mutable DescriptorT getters.
-    inline std::vector<DescriptorT>& Descriptors() { return _vec_descs; }
-    inline const std::vector<DescriptorT>& Descriptors() const { return _vec_descs; }
+    inline std::vector<DescriptorT>& Descriptors()
+    {
+        releaseWrappedDescriptors();
+        return _vec_descs;
+    }
+
+    inline const std::vector<DescriptorT>& Descriptors() const { return (_wrappedDescs) ? _wrappedDescs->getCopy() : _vec_descs; }
 
-    inline const void* blindDescriptors() const override { return &_vec_descs; }
+    inline const void* blindDescriptors() const override { return &Descriptors(); }
 
-    inline const void* DescriptorRawData() const override { return &_vec_descs[0]; }
+    inline const void* DescriptorRawData() const override { return (_wrappedDescs) ? _wrappedDescs->data : _vec_descs.data(); }
+
+    inline void clearDescriptors() override
+    {
+        _wrappedDescs.reset();
+        // release the memory
+        std::vector<DescriptorT>().swap(_vec_descs);
+    }
+
+    void wrapDescriptors(const void* descriptors, std::size_t nbDescriptors, std::shared_ptr<const void> memoryOwner) override
+    {
+        static_assert(sizeof(DescriptorT) == L * sizeof(T), "Descriptor should be a flat array of L elements.");
+
+        _vec_descs.clear();
+        _wrappedDescs = std::make_shared<WrappedDescriptors>();
+        _wrappedDescs->memoryOwner = std::move(memoryOwner);
+        _wrappedDescs->data = static_cast<const DescriptorT*>(descriptors);
+        _wrappedDescs->size = nbDescriptors;
+    }
 
-    inline void clearDescriptors() override { _vec_descs.clear(); }
+    bool hasWrappedDescriptors() const override { return static_cast<bool>(_wrappedDescs); }
 
     inline void swap(This& other)
     {
         this->_vec_feats.swap(other._vec_feats);
         _vec_descs.swap(other._vec_descs);
+        _wrappedDescs.swap(other._wrappedDescs);
     }
 
     // Return the distance between two descriptors
     double SquaredDescriptorDistance(std::size_t i, const Regions* genericRegions, std::size_t j) const override
     {
-        assert(i < this->_vec_descs.size());
         assert(genericRegions);
         assert(j < genericRegions->RegionCount());
 
         const This* regionsT = dynamic_cast<const This*>(genericRegions);
         static typename SquaredMetric<T, regionType>::Metric metric;
-        return metric(this->_vec_descs[i].getData(), regionsT->_vec_descs[j].getData(), DescriptorT::static_size);
+        return metric(descriptor(i).getData(), regionsT->descriptor(j).getData(), DescriptorT::static_size);
     }
 
     /**
@@ -213,9 +306,10 @@ class FeatDescRegions : public Regions
      */
     void CopyRegion(std::size_t i, Regions* outRegionContainer) const override
     {
-        assert(i < this->_vec_feats.size() && i < this->_vec_descs.size());
-        static_cast<This*>(outRegionContainer)->_vec_feats.push_back(this->_vec_feats[i]);
-        static_cast<This*>(outRegionContainer)->_vec_descs.push_back(this->_vec_descs[i]);
+        assert(i < this->_vec_feats.size());
+        This* outRegions = static_cast<This*>(outRegionContainer);
+        outRegions->_vec_feats.push_back(this->_vec_feats[i]);
+        outRegions->Descriptors().push_back(descriptor(i));
     }
 
     /**
@@ -240,7 +334,7 @@ class FeatDescRegions : public Regions
         {
             const FeatureInImage& feat = featuresInImage[i];
             regionsPtr->Features().push_back(this->_vec_feats[feat._featureIndex]);
-            regionsPtr->Descriptors().push_back(this->_vec_descs[feat._featureIndex]);
+            regionsPtr->Descriptors().push_back(descriptor(feat._featureIndex));
 
             // This assert should be valid in theory, but in the context of CameraLocalization
             // we can have the same 2D feature associated to different 3D points (2 in practice).
@@ -0,0 +1,301 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "RegionsContainer.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace fs = boost::filesystem;
+
+namespace aliceVision {
+namespace feature {
+
+namespace {
+
+constexpr char regionsContainerMagic[8] = {'A', 'V', 'R', 'E', 'G', 'N', 'S', '\0'};
+constexpr std::uint64_t regionsContainerAlignment = 64;
+
+static_assert(sizeof(RegionsContainerHeader) == 64, "Invalid regions container header size.");
+static_assert(sizeof(RegionsContainerIndexEntry) == 40, "Invalid regions container index entry size.");
+
+inline std::uint64_t alignOffset(std::uint64_t offset)
+{
+    return (offset + regionsContainerAlignment - 1) / regionsContainerAlignment * regionsContainerAlignment;
+}
+
+/**
+ * @brief Check that nbElements of elementSize bytes from the given offset are aligned and in the file.
+ */
+inline bool isValidRange(std::uint64_t offset, std::uint64_t nbElements, std::uint64_t elementSize, std::uint64_t fileSize)
+{
+    if (offset % regionsContainerAlignment != 0 || offset > fileSize)
+        return false;
+    if (nbElements == 0 || elementSize == 0)
+        return true;
+    return nbElements <= (fileSize - offset) / elementSize;
+}
+
+}  // namespace
+
+std::string getRegionsContainerFilename(const std::string& folder, EImageDescriberType describerType)
+{
+    return (fs::path(folder) / (EImageDescriberType_enumToString(describerType) + ".regions")).string();
+}
+
+RegionsContainerWriter::RegionsContainerWriter(const std::string& filename, EImageDescriberType describerType)
+  : _filename(filename),
+    _file(filename, std::ios::out | std::ios::binary | std::ios::trunc)
+{
+    if (!_file.is_open())
+        throw std::runtime_error("Can't create regions container, can't open '" + filename + "' !");
+
+    std::memset(&_header, 0, sizeof(_header));
+    std::memcpy(_header.magic, regionsContainerMagic, sizeof(_header.magic));
+    _header.version = version;
+    _header.describerType = static_cast<std::uint32_t>(describerType);
+
+    // header is written again on close, with the index offset
+    _file.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+    _offset = sizeof(_header);
+}
+
+RegionsContainerWriter::~RegionsContainerWriter()
+{
+    if (_file.is_open())
+    {
+        try
+        {
+            close();
+        }
+        catch (const std::exception& e)
+        {
+            ALICEVISION_LOG_ERROR(e.what());
+        }
+    }
+}
+
+void RegionsContainerWriter::writePadding()
+{
+    static const char zeros[regionsContainerAlignment] = {0};
+    const std::uint64_t alignedOffset = alignOffset(_offset);
+    _file.write(zeros, alignedOffset - _offset);
+    _offset = alignedOffset;
+}
+
+void RegionsContainerWriter::addRegions(IndexT viewId, const Regions& regions)
+{
+    if (!_file.is_open())
+        throw std::runtime_error("Can't add regions to the closed regions container '" + _filename + "' !");
+
+    if (std::any_of(_index.begin(), _index.end(), [viewId](const RegionsContainerIndexEntry& e) { return e.viewId == viewId; }))
+        throw std::runtime_error("View " + std::to_string(viewId) + " is already in the regions container '" + _filename + "' !");
+
+    const std::uint32_t elementSize = static_cast<std::uint32_t>(regions.DescriptorElementSize());
+    const std::uint32_t length = static_cast<std::uint32_t>(regions.DescriptorLength());
+
+    // all the views share the same descriptor layout
+    if (_index.empty())
+    {
+        _header.descriptorElementSize = elementSize;
+        _header.descriptorLength = length;
+    }
+    else if (_header.descriptorElementSize != elementSize || _header.descriptorLength != length)
+    {
+        throw std::runtime_error("Can't add view " + std::to_string(viewId) + " to the regions container '" + _filename +
+                                 "', incompatible descriptor type !");
+    }
+
+    const std::vector<PointFeature>& features = regions.Features();
+    const std::size_t nbDescriptors = regions.DescriptorCount();
+
+    RegionsContainerIndexEntry entry;
+    std::memset(&entry, 0, sizeof(entry));
+    entry.viewId = static_cast<std::uint32_t>(viewId);
+    entry.nbFeatures = features.size();
+
+    // features
+    writePadding();
+    entry.featuresOffset = _offset;
+    for (const PointFeature& f : features)
+    {
+        const float values[4] = {f.x(), f.y(), f.scale(), f.orientation()};
+        _file.write(reinterpret_cast<const char*>(values), sizeof(values));
+    }
+    _offset += features.size() * 4 * sizeof(float);
+
+    // descriptors
+    // note: regions loaded without descriptors have no descriptor data
+    writePadding();
+    entry.descriptorsOffset = _offset;
+    entry.nbDescriptors = 0;
+
+    if (nbDescriptors > 0)
+    {
+        const std::uint64_t descriptorsBytes = std::uint64_t(nbDescriptors) * length * elementSize;
+        entry.nbDescriptors = nbDescriptors;
+        _file.write(reinterpret_cast<const char*>(regions.DescriptorRawData()), descriptorsBytes);
+        _offset += descriptorsBytes;
+    }
+
+    if (!_file.good())
+        throw std::runtime_error("Can't write view " + std::to_string(viewId) + " in the regions container '" + _filename + "' !");
+
+    _index.push_back(entry);
+}
+
+void RegionsContainerWriter::close()
+{
+    if (!_file.is_open())
+        return;
+
+    // index sorted by view id for binary search
+    std::sort(_index.begin(), _index.end(), [](const RegionsContainerIndexEntry& a, const RegionsContainerIndexEntry& b) { return a.viewId < b.viewId; });
+
+    writePadding();
+    _header.indexOffset = _offset;
+    _header.nbViews = _index.size();
+    _file.write(reinterpret_cast<const char*>(_index.data()), _index.size() * sizeof(RegionsContainerIndexEntry));
+
+    // rewrite header
+    _file.seekp(0);
+    _file.write(reinterpret_cast<const char*>(&_header), sizeof(_header));
+
+    const bool good = _file.good();
+    _file.close();
+
+    if (!good)
+        throw std::runtime_error("Can't write regions container '" + _filename + "' !");
+}
+
+struct RegionsContainer::MappedFile
+{
+    boost::interprocess::file_mapping mapping;
+    boost::interprocess::mapped_region region;
+
+    explicit MappedFile(const std::string& filename)
+      : mapping(filename.c_str(), boost::interprocess::read_only),
+        region(mapping, boost::interprocess::read_only)
+    {}
+};
+
+RegionsContainer::RegionsContainer(const std::string& filename)
+  : _filename(filename)
+{
+    try
+    {
+        _mappedFile = std::make_shared<const MappedFile>(filename);
+    }
+    catch (const boost::interprocess::interprocess_exception& e)
+    {
+        throw std::runtime_error("Can't load regions container, can't map '" + filename + "' : " + e.what());
+    }
+
+    _data = static_cast<const char*>(_mappedFile->region.get_address());
+    const std::size_t size = _mappedFile->region.get_size();
+
+    if (size < sizeof(RegionsContainerHeader))
+        throw std::runtime_error("Can't load regions container, '" + filename + "' is incorrect !");
+
+    _header = reinterpret_cast<const RegionsContainerHeader*>(_data);
+
+    if (std::memcmp(_header->magic, regionsContainerMagic, sizeof(regionsContainerMagic)) != 0)
+        throw std::runtime_error("Can't load regions container, '" + filename + "' is not a regions container !");
+
+    if (_header->version != RegionsContainerWriter::version)
+        throw std::runtime_error("Can't load regions container '" + filename + "', unsupported version " + std::to_string(_header->version) + " !");
+
+    // the index is read in place, it must be aligned and fit in the file
+    if (_header->indexOffset % regionsContainerAlignment != 0 || _header->indexOffset > size ||
+        _header->nbViews > (size - _header->indexOffset) / sizeof(RegionsContainerIndexEntry))
+        throw std::runtime_error("Can't load regions container, '" + filename + "' is truncated !");
+
+    _index = reinterpret_cast<const RegionsContainerIndexEntry*>(_data + _header->indexOffset);
+
+    // the features and the descriptors of each view are read in place as well
+    const std::uint64_t descriptorSize = std::uint64_t(_header->descriptorElementSize) * _header->descriptorLength;
+    for (std::size_t i = 0; i < _header->nbViews; ++i)
+    {
+        const RegionsContainerIndexEntry& entry = _index[i];
+
+        if (i > 0 && _index[i - 1].viewId >= entry.viewId)
+            throw std::runtime_error("Can't load regions container, the index of '" + filename + "' is not sorted !");
+
+        if (!isValidRange(entry.featuresOffset, entry.nbFeatures, 4 * sizeof(float), size) ||
+            !isValidRange(entry.descriptorsOffset, entry.nbDescriptors, descriptorSize, size))
+            throw std::runtime_error("Can't load regions container, invalid view " + std::to_string(entry.viewId) + " in '" + filename + "' !");
+    }
+
+    ALICEVISION_LOG_TRACE("Regions container '" << filename << "': " << _header->nbViews << " views.");
+}
+
+std::vector<IndexT> RegionsContainer::getViewIds() const
+{
+    std::vector<IndexT> viewIds;
+    viewIds.reserve(_header->nbViews);
+    for (std::size_t i = 0; i < _header->nbViews; ++i)
+        viewIds.push_back(_index[i].viewId);
+    return viewIds;
+}
+
+const RegionsContainerIndexEntry* RegionsContainer::findEntry(IndexT viewId) const
+{
+    const RegionsContainerIndexEntry* end = _index + _header->nbViews;
+    const RegionsContainerIndexEntry* it =
+      std::lower_bound(_index, end, viewId, [](const RegionsContainerIndexEntry& e, IndexT id) { return e.viewId < id; });
+
+    if (it == end || it->viewId != viewId)
+        return nullptr;
+    return it;
+}
+
+const RegionsContainerIndexEntry& RegionsContainer::getEntry(IndexT viewId) const
+{
+    const RegionsContainerIndexEntry* entry = findEntry(viewId);
+    if (entry == nullptr)
+        throw std::runtime_error("Can't find view " + std::to_string(viewId) + " in the regions container '" + _filename + "' !");
+    return *entry;
+}
+
+std::size_t RegionsContainer::getNbFeatures(IndexT viewId) const { return getEntry(viewId).nbFeatures; }
+
+void RegionsContainer::loadFeatures(IndexT viewId, Regions& regions) const
+{
+    const RegionsContainerIndexEntry& entry = getEntry(viewId);
+    const float* values = reinterpret_cast<const float*>(_data + entry.featuresOffset);
+
+    std::vector<PointFeature>& features = regions.Features();
+    features.clear();
+    features.reserve(entry.nbFeatures);
+
+    for (std::size_t i = 0; i < entry.nbFeatures; ++i, values += 4)
+        features.emplace_back(values[0], values[1], values[2], values[3]);
+}
+
+void RegionsContainer::loadRegions(IndexT viewId, Regions& regions) const
+{
+    const RegionsContainerIndexEntry& entry = getEntry(viewId);
+
+    if (regions.DescriptorElementSize() != _header->descriptorElementSize || regions.DescriptorLength() != _header->descriptorLength)
+        throw std::runtime_error("Can't load view " + std::to_string(viewId) + " from the regions container '" + _filename +
+                                 "', incompatible descriptor type !");
+
+    if (entry.nbDescriptors != entry.nbFeatures)
+        throw std::runtime_error("Can't load view " + std::to_string(viewId) + " from the regions container '" + _filename +
+                                 "', the container has no descriptors for this view !");
+
+    loadFeatures(viewId, regions);
+    regions.wrapDescriptors(_data + entry.descriptorsOffset, entry.nbDescriptors, _mappedFile);
+}
+
+}  // namespace feature
+}  // namespace aliceVision
@@ -0,0 +1,162 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/feature/Regions.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace feature {
+
+/**
+ * @brief Regions container binary file layout (version 1, native little-endian).
+ *
+ * - header (64 bytes): magic, version, describer type, descriptor element size and length, number of views, index offset
+ * - per view chunk: features (4 x float32 per feature) and descriptors (raw data), each aligned on 64 bytes
+ * - index: one entry per view, sorted by view id
+ *
+ * The index is read in place from the memory-mapped file, loading a view does not need any parsing
+ * and the descriptors can be used without copy (see Regions::wrapDescriptors).
+ */
+struct RegionsContainerHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t describerType;
+    std::uint32_t descriptorElementSize;
+    std::uint32_t descriptorLength;
+    std::uint64_t nbViews;
+    std::uint64_t indexOffset;
+    std::uint8_t reserved[24];
+};
+
+struct RegionsContainerIndexEntry
+{
+    std::uint32_t viewId;
+    std::uint32_t reserved;
+    std::uint64_t nbFeatures;
+    std::uint64_t nbDescriptors;
+    std::uint64_t featuresOffset;
+    std::uint64_t descriptorsOffset;
+};
+
+/**
+ * @brief Get the regions container filename of the given describer type in the given folder.
+ * @param[in] folder the features folder
+ * @param[in] describerType the image describer type
+ * @return the container filename (<folder>/<describerType>.regions)
+ */
+std::string getRegionsContainerFilename(const std::string& folder, EImageDescriberType describerType);
+
+/**
+ * @brief Write the regions of multiple views of the same describer type in a single binary file.
+ * @note Not thread-safe, views are written in the order of the addRegions calls.
+ */
+class RegionsContainerWriter
+{
+  public:
+    static constexpr std::uint32_t version = 1;
+
+    /**
+     * @brief Create a new regions container file.
+     * @param[in] filename the container filename
+     * @param[in] describerType the image describer type of all the regions
+     */
+    RegionsContainerWriter(const std::string& filename, EImageDescriberType describerType);
+
+    /// finalize the container if needed
+    ~RegionsContainerWriter();
+
+    /**
+     * @brief Append the regions of a view.
+     * @param[in] viewId the view id (each view can be added once)
+     * @param[in] regions the view regions, features and descriptors (if any)
+     */
+    void addRegions(IndexT viewId, const Regions& regions);
+
+    /**
+     * @brief Write the view index and close the file.
+     */
+    void close();
+
+  private:
+    void writePadding();
+
+    std::string _filename;
+    std::ofstream _file;
+    RegionsContainerHeader _header;
+    std::vector<RegionsContainerIndexEntry> _index;
+    std::uint64_t _offset = 0;
+};
+
+/**
+ * @brief Read-only access to a memory-mapped regions container.
+ * @note Thread-safe, a single instance can be shared by all the loading threads.
+ */
+class RegionsContainer
+{
+  public:
+    /**
+     * @brief Map the given regions container file in memory.
+     * @note throw if the file cannot be opened or is invalid
+     * @param[in] filename the container filename
+     */
+    explicit RegionsContainer(const std::string& filename);
+
+    EImageDescriberType getDescriberType() const { return static_cast<EImageDescriberType>(_header->describerType); }
+
+    std::size_t getNbViews() const { return _header->nbViews; }
+
+    std::vector<IndexT> getViewIds() const;
+
+    bool hasView(IndexT viewId) const { return findEntry(viewId) != nullptr; }
+
+    /**
+     * @brief Get the number of features of the given view.
+     * @note throw if the view is not in the container
+     */
+    std::size_t getNbFeatures(IndexT viewId) const;
+
+    /**
+     * @brief Fill the given regions with the features and the descriptors of the given view.
+     * @note Features are copied, descriptors are wrapped without copy and keep the file mapped.
+     *       throw if the view is not in the container or if the regions type does not match.
+     * @param[in] viewId the view id
+     * @param[out] regions the output regions
+     */
+    void loadRegions(IndexT viewId, Regions& regions) const;
+
+    /**
+     * @brief Fill the given regions with the features of the given view.
+     * @note throw if the view is not in the container
+     * @param[in] viewId the view id
+     * @param[out] regions the output regions (without descriptors)
+     */
+    void loadFeatures(IndexT viewId, Regions& regions) const;
+
+  private:
+    struct MappedFile;
+
+    const RegionsContainerIndexEntry& getEntry(IndexT viewId) const;
+    const RegionsContainerIndexEntry* findEntry(IndexT viewId) const;
+
+    std::string _filename;
+    std::shared_ptr<const MappedFile> _mappedFile;
+    const char* _data = nullptr;
+    const RegionsContainerHeader* _header = nullptr;
+    const RegionsContainerIndexEntry* _index = nullptr;
+};
+
+}  // namespace feature
+}  // namespace aliceVision
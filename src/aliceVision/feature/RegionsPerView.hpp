@@ -12,13 +12,15 @@
 #include <aliceVision/feature/ImageDescriber.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 
+#include <map>
 #include <memory>
 
 namespace aliceVision {
 namespace feature {
 
-/// Regions per ViewId of the considered SfMData container
-class MapRegionsPerDesc : public std::map<feature::EImageDescriberType, std::unique_ptr<feature::Regions>>
+/// Regions per describer type of a view.
+/// The regions are shared, so a view can be referenced by several containers (see RegionsCache).
+class MapRegionsPerDesc : public std::map<feature::EImageDescriberType, std::shared_ptr<feature::Regions>>
 {
   public:
     std::size_t getNbAllRegions() const
@@ -97,6 +99,16 @@ class RegionsPerView
         _data[viewId][descType].reset(regionsPtr);
     }
 
+    /**
+     * @brief Add the regions of all the describer types of a view, shared with the given container.
+     */
+    void addRegions(IndexT viewId, const MapRegionsPerDesc& regionsPerDesc) { _data[viewId] = regionsPerDesc; }
+
+    /**
+     * @brief Remove the regions of a view, the regions are released if they are not shared.
+     */
+    void removeRegions(IndexT viewId) { _data.erase(viewId); }
+
     std::vector<feature::EImageDescriberType> getCommonDescTypes(const Pair& pair) const
     {
         const auto& regionsA = getAllRegions(pair.first);
@@ -0,0 +1,316 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "RegionsProvider.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <algorithm>
+#include <exception>
+
+namespace aliceVision {
+namespace feature {
+
+namespace {
+
+/**
+ * @brief Get the amount of data (in bytes) of the features and of the descriptors of regions.
+ */
+std::size_t getRegionsDataSize(const Regions& regions)
+{
+    return regions.RegionCount() * sizeof(PointFeature) + regions.DescriptorCount() * regions.DescriptorLength() * regions.DescriptorElementSize();
+}
+
+/**
+ * @return true if some regions are referenced outside of the given container
+ */
+bool isInUse(const MapRegionsPerDesc& regionsPerDesc)
+{
+    for (const auto& regions : regionsPerDesc)
+    {
+        if (regions.second.use_count() > 1)
+            return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+std::size_t getRegionsMemorySize(const Regions& regions)
+{
+    if (regions.hasWrappedDescriptors())
+        return regions.RegionCount() * sizeof(PointFeature);
+    return getRegionsDataSize(regions);
+}
+
+RegionsCache::RegionsCache(const Loader& loader, std::size_t memoryBudget)
+  : _loader(loader),
+    _memoryBudget(memoryBudget)
+{
+    _prefetchThread = std::thread(&RegionsCache::prefetchWorker, this);
+}
+
+RegionsCache::~RegionsCache()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _condition.notify_all();
+    _prefetchThread.join();
+}
+
+MapRegionsPerDesc RegionsCache::getRegions(IndexT viewId)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (true)
+    {
+        auto it = _entries.find(viewId);
+        if (it != _entries.end())
+        {
+            ++_stats.nbHits;
+            Entry& entry = it->second;
+            if (entry.prefetched)
+            {
+                entry.prefetched = false;
+                _prefetchedBytes -= entry.size;
+            }
+            _lru.splice(_lru.begin(), _lru, entry.lruIt);
+            return entry.regionsPerDesc;
+        }
+        // already requested by another thread or by the prefetch
+        if (_loading.count(viewId) == 0)
+            break;
+        _condition.wait(lock);
+    }
+
+    ++_stats.nbMisses;
+    return load(viewId, lock, false);
+}
+
+void RegionsCache::prefetch(const std::vector<IndexT>& viewIds)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _prefetchQueue.assign(viewIds.begin(), viewIds.end());
+    }
+    _condition.notify_all();
+}
+
+void RegionsCache::insert(IndexT viewId, const MapRegionsPerDesc& regionsPerDesc)
+{
+    std::size_t bytesRead = 0;
+    for (const auto& regions : regionsPerDesc)
+        bytesRead += getRegionsDataSize(*regions.second);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_entries.count(viewId))
+        return;
+    add(viewId, regionsPerDesc, bytesRead, false);
+}
+
+bool RegionsCache::contains(IndexT viewId) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.count(viewId) > 0;
+}
+
+void RegionsCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto it = _entries.begin(); it != _entries.end();)
+    {
+        if (isInUse(it->second.regionsPerDesc))
+        {
+            ++it;
+            continue;
+        }
+        remove(it++);
+    }
+}
+
+RegionsCacheStats RegionsCache::getStats() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+MapRegionsPerDesc RegionsCache::load(IndexT viewId, std::unique_lock<std::mutex>& lock, bool prefetched)
+{
+    _loading.insert(viewId);
+    lock.unlock();
+
+    MapRegionsPerDesc regionsPerDesc;
+    std::size_t bytesRead = 0;
+    try
+    {
+        regionsPerDesc = _loader(viewId);
+        for (const auto& regions : regionsPerDesc)
+            bytesRead += getRegionsDataSize(*regions.second);
+    }
+    catch (...)
+    {
+        lock.lock();
+        _loading.erase(viewId);
+        _condition.notify_all();
+        throw;
+    }
+
+    lock.lock();
+    _loading.erase(viewId);
+    // the returned regions are in use, they cannot be released by the eviction
+    add(viewId, regionsPerDesc, bytesRead, prefetched);
+    _condition.notify_all();
+    return regionsPerDesc;
+}
+
+void RegionsCache::add(IndexT viewId, const MapRegionsPerDesc& regionsPerDesc, std::size_t bytesRead, bool prefetched)
+{
+    Entry& entry = _entries[viewId];
+    entry.regionsPerDesc = regionsPerDesc;
+    for (const auto& regions : regionsPerDesc)
+        entry.size += getRegionsMemorySize(*regions.second);
+    entry.prefetched = prefetched;
+    entry.lruIt = _lru.insert(_lru.begin(), viewId);
+
+    if (prefetched)
+        _prefetchedBytes += entry.size;
+
+    _stats.bytesRead += bytesRead;
+    _stats.residentBytes += entry.size;
+    _stats.peakResidentBytes = std::max(_stats.peakResidentBytes, _stats.residentBytes);
+
+    evict();
+}
+
+void RegionsCache::remove(std::map<IndexT, Entry>::iterator it)
+{
+    const Entry& entry = it->second;
+    if (entry.prefetched)
+        _prefetchedBytes -= entry.size;
+    _stats.residentBytes -= entry.size;
+    ++_stats.nbEvictions;
+    _lru.erase(entry.lruIt);
+    _entries.erase(it);
+}
+
+void RegionsCache::evict()
+{
+    if (_memoryBudget == 0)
+        return;
+
+    for (auto lruIt = _lru.end(); lruIt != _lru.begin() && _stats.residentBytes > _memoryBudget;)
+    {
+        --lruIt;
+        auto it = _entries.find(*lruIt);
+        if (isInUse(it->second.regionsPerDesc))
+            continue;
+        // the list iterator is invalidated by the removal, continue from the next most recently used view
+        lruIt = std::next(lruIt);
+        remove(it);
+    }
+}
+
+void RegionsCache::prefetchWorker()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _condition.wait(lock, [this] { return _stop || !_prefetchQueue.empty(); });
+        if (_stop)
+            return;
+
+        const IndexT viewId = _prefetchQueue.front();
+        _prefetchQueue.pop_front();
+
+        if (_entries.count(viewId) || _loading.count(viewId))
+            continue;
+
+        // the prefetched views not requested yet use at most half of the memory budget,
+        // so they do not evict each other before being used
+        if (_memoryBudget > 0 && _prefetchedBytes >= _memoryBudget / 2)
+        {
+            _prefetchQueue.clear();
+            continue;
+        }
+
+        ++_stats.nbPrefetched;
+        try
+        {
+            load(viewId, lock, true);
+        }
+        catch (const std::exception& e)
+        {
+            // the error is reported when the view is requested
+            ALICEVISION_LOG_WARNING("Cannot prefetch the regions of the view " << viewId << ": " << e.what());
+        }
+    }
+}
+
+std::vector<std::pair<std::size_t, std::size_t>> computePairsWindows(const PairVec& pairs, std::size_t maxViewsPerWindow)
+{
+    std::vector<std::pair<std::size_t, std::size_t>> windows;
+    std::set<IndexT> views;
+    std::size_t begin = 0;
+
+    for (std::size_t i = 0; i < pairs.size(); ++i)
+    {
+        const Pair& pair = pairs[i];
+        const std::size_t nbNewViews = (views.count(pair.first) ? 0 : 1) + (views.count(pair.second) ? 0 : 1);
+        if (i > begin && views.size() + nbNewViews > maxViewsPerWindow)
+        {
+            windows.emplace_back(begin, i);
+            begin = i;
+            views.clear();
+        }
+        views.insert(pair.first);
+        views.insert(pair.second);
+    }
+    if (begin < pairs.size())
+        windows.emplace_back(begin, pairs.size());
+
+    return windows;
+}
+
+void forEachPairsWindow(RegionsProvider& regionsProvider,
+                        const PairVec& pairs,
+                        std::size_t maxViewsPerWindow,
+                        const std::function<void(const RegionsPerView& regionsPerView, std::size_t begin, std::size_t end)>& function)
+{
+    const std::vector<std::pair<std::size_t, std::size_t>> windows = computePairsWindows(pairs, maxViewsPerWindow);
+
+    // views of a window, in the order of the first use
+    const auto getWindowViews = [&](const std::pair<std::size_t, std::size_t>& window) {
+        std::vector<IndexT> viewIds;
+        std::set<IndexT> uniqueViewIds;
+        for (std::size_t i = window.first; i < window.second; ++i)
+        {
+            for (IndexT viewId : {pairs[i].first, pairs[i].second})
+            {
+                if (uniqueViewIds.insert(viewId).second)
+                    viewIds.push_back(viewId);
+            }
+        }
+        return viewIds;
+    };
+
+    for (std::size_t w = 0; w < windows.size(); ++w)
+    {
+        // the regions of the window are in use until the end of the window processing
+        RegionsPerView regionsPerView;
+        for (IndexT viewId : getWindowViews(windows[w]))
+            regionsPerView.addRegions(viewId, regionsProvider.getRegions(viewId));
+
+        if (w + 1 < windows.size())
+            regionsProvider.prefetch(getWindowViews(windows[w + 1]));
+
+        function(regionsPerView, windows[w].first, windows[w].second);
+    }
+}
+
+}  // namespace feature
+}  // namespace aliceVision
@@ -0,0 +1,207 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/feature/RegionsPerView.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace feature {
+
+/**
+ * @brief Interface to request the regions of the views on demand,
+ *        instead of loading the regions of all the views up front.
+ */
+class RegionsProvider
+{
+  public:
+    virtual ~RegionsProvider() = default;
+
+    /**
+     * @brief Get the regions of all the describer types of a view.
+     * @note The regions are kept in memory at least as long as the returned container (or a copy of it) is alive.
+     * @param[in] viewId The view id
+     * @return the regions per describer type
+     */
+    virtual MapRegionsPerDesc getRegions(IndexT viewId) = 0;
+
+    /**
+     * @brief Hint the provider that the regions of the given views will be requested soon.
+     * @param[in] viewIds The view ids, in the order of the future requests
+     */
+    virtual void prefetch(const std::vector<IndexT>& /*viewIds*/) {}
+};
+
+/**
+ * @brief Statistics of a RegionsCache.
+ */
+struct RegionsCacheStats
+{
+    /// number of requests of views already in memory
+    std::size_t nbHits = 0;
+    /// number of requests of views loaded on demand
+    std::size_t nbMisses = 0;
+    /// number of views loaded in background (prefetch)
+    std::size_t nbPrefetched = 0;
+    /// number of views removed from the cache
+    std::size_t nbEvictions = 0;
+    /// amount of regions data loaded (in bytes)
+    std::size_t bytesRead = 0;
+    /// amount of regions data currently in memory (in bytes)
+    std::size_t residentBytes = 0;
+    /// maximum amount of regions data in memory (in bytes)
+    std::size_t peakResidentBytes = 0;
+};
+
+/**
+ * @brief Get the amount of memory (in bytes) used by regions.
+ *        Memory-mapped descriptors (see RegionsContainer) are not counted, their pages belong to the system cache.
+ */
+std::size_t getRegionsMemorySize(const Regions& regions);
+
+/**
+ * @brief Regions provider with a bounded memory: the least recently used views are released
+ *        when the regions in memory exceed the memory budget.
+ *
+ * The views are loaded with the given loader function, on demand or in background with prefetch().
+ * Memory-mapped descriptors are not counted in the memory budget.
+ * The regions in use (referenced outside of the cache) are never released, so the memory budget
+ * may be exceeded if the regions in use do not fit in it.
+ * @note Thread-safe, a view requested by several threads is loaded only once.
+ */
+class RegionsCache : public RegionsProvider
+{
+  public:
+    using Loader = std::function<MapRegionsPerDesc(IndexT viewId)>;
+
+    /**
+     * @param[in] loader The function to load the regions of a view, may throw if the regions cannot be loaded
+     * @param[in] memoryBudget The maximum amount of regions data in memory (in bytes), 0 for no limit
+     */
+    RegionsCache(const Loader& loader, std::size_t memoryBudget);
+
+    /// stop the background loading
+    ~RegionsCache() override;
+
+    RegionsCache(const RegionsCache&) = delete;
+    RegionsCache& operator=(const RegionsCache&) = delete;
+
+    MapRegionsPerDesc getRegions(IndexT viewId) override;
+
+    /**
+     * @brief Load the regions of the given views in background.
+     *        The views of a previous prefetch that are not loaded yet are discarded.
+     */
+    void prefetch(const std::vector<IndexT>& viewIds) override;
+
+    /**
+     * @brief Add already loaded regions to the cache.
+     * @param[in] viewId The view id
+     * @param[in] regionsPerDesc The regions of the view
+     */
+    void insert(IndexT viewId, const MapRegionsPerDesc& regionsPerDesc);
+
+    /**
+     * @return true if the regions of the view are in memory
+     */
+    bool contains(IndexT viewId) const;
+
+    /// release all the regions not in use
+    void clear();
+
+    RegionsCacheStats getStats() const;
+
+    std::size_t getMemoryBudget() const { return _memoryBudget; }
+
+  private:
+    struct Entry
+    {
+        MapRegionsPerDesc regionsPerDesc;
+        std::size_t size = 0;
+        /// loaded by the prefetch and not requested yet
+        bool prefetched = false;
+        /// position in the least recently used list
+        std::list<IndexT>::iterator lruIt;
+    };
+
+    /**
+     * @brief Load a view outside of the lock and add it to the cache.
+     * @param[in,out] lock The locked cache mutex, unlocked during the loading
+     * @param[in] prefetched True if the view is loaded by the prefetch
+     */
+    MapRegionsPerDesc load(IndexT viewId, std::unique_lock<std::mutex>& lock, bool prefetched);
+
+    /// add a view to the cache, the mutex must be locked
+    void add(IndexT viewId, const MapRegionsPerDesc& regionsPerDesc, std::size_t bytesRead, bool prefetched);
+
+    /// remove a view from the cache, the mutex must be locked
+    void remove(std::map<IndexT, Entry>::iterator it);
+
+    /// release the least recently used views not in use until the memory budget is respected, the mutex must be locked
+    void evict();
+
+    /// background loading of the prefetched views
+    void prefetchWorker();
+
+    const Loader _loader;
+    const std::size_t _memoryBudget;
+
+    mutable std::mutex _mutex;
+    /// notified when a view is loaded and when a prefetch is requested
+    std::condition_variable _condition;
+
+    std::map<IndexT, Entry> _entries;
+    /// views from the most to the least recently used
+    std::list<IndexT> _lru;
+    /// views being loaded
+    std::set<IndexT> _loading;
+
+    std::deque<IndexT> _prefetchQueue;
+    /// amount of memory used by the prefetched views not requested yet
+    std::size_t _prefetchedBytes = 0;
+    std::thread _prefetchThread;
+    bool _stop = false;
+
+    RegionsCacheStats _stats;
+};
+
+/**
+ * @brief Split a list of image pairs into windows of consecutive pairs involving at most maxViewsPerWindow views.
+ *        A window contains at least one pair, even if it exceeds the number of views.
+ * @param[in] pairs The image pairs
+ * @param[in] maxViewsPerWindow The maximum number of views per window
+ * @return the [begin, end[ ranges of the pairs of each window
+ */
+std::vector<std::pair<std::size_t, std::size_t>> computePairsWindows(const PairVec& pairs, std::size_t maxViewsPerWindow);
+
+/**
+ * @brief Process a list of image pairs window by window, with the regions of the views of each window
+ *        requested from the provider, while the regions of the next window are prefetched.
+ * @param[in] regionsProvider The regions provider
+ * @param[in] pairs The image pairs, sorted to maximize the views shared by consecutive pairs
+ * @param[in] maxViewsPerWindow The maximum number of views per window
+ * @param[in] function The processing of the pairs [begin, end[ with the regions of their views
+ */
+void forEachPairsWindow(RegionsProvider& regionsProvider,
+                        const PairVec& pairs,
+                        std::size_t maxViewsPerWindow,
+                        const std::function<void(const RegionsPerView& regionsPerView, std::size_t begin, std::size_t end)>& function);
+
+}  // namespace feature
+}  // namespace aliceVision
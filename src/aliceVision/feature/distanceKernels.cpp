@@ -0,0 +1,498 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "distanceKernels.hpp"
+
+#include <aliceVision/system/Logger.hpp>
+
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define ALICEVISION_DISTANCE_KERNELS_X86
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+// GCC and Clang compile each kernel for its own instruction set,
+// the rest of the library does not need any architecture flag.
+#if defined(__GNUC__) || defined(__clang__)
+    #define ALICEVISION_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define ALICEVISION_TARGET(isa)
+#endif
+
+namespace aliceVision {
+namespace feature {
+
+std::string EDistanceKernel_enumToString(EDistanceKernel kernel)
+{
+    switch (kernel)
+    {
+        case EDistanceKernel::SCALAR:
+            return "scalar";
+        case EDistanceKernel::SSE42:
+            return "sse4.2";
+        case EDistanceKernel::AVX2:
+            return "avx2";
+        case EDistanceKernel::AVX512:
+            return "avx512";
+    }
+    throw std::out_of_range("Invalid distance kernel enum: " + std::to_string(int(kernel)));
+}
+
+namespace {
+
+inline std::uint64_t load64(const std::uint8_t* p)
+{
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline std::uint32_t popcount64(std::uint64_t n)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(n);
+#else
+    n -= ((n >> 1) & 0x5555555555555555ULL);
+    n = (n & 0x3333333333333333ULL) + ((n >> 2) & 0x3333333333333333ULL);
+    return (((n + (n >> 4)) & 0x0f0f0f0f0f0f0f0fULL) * 0x0101010101010101ULL) >> 56;
+#endif
+}
+
+// ------------------------------------------------------------------------------------------------
+// Scalar
+
+float l2Float_scalar(const float* a, const float* b, std::size_t size)
+{
+    float r0 = 0.f, r1 = 0.f, r2 = 0.f, r3 = 0.f;
+    std::size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+    {
+        const float d0 = a[i] - b[i];
+        const float d1 = a[i + 1] - b[i + 1];
+        const float d2 = a[i + 2] - b[i + 2];
+        const float d3 = a[i + 3] - b[i + 3];
+        r0 += d0 * d0;
+        r1 += d1 * d1;
+        r2 += d2 * d2;
+        r3 += d3 * d3;
+    }
+    for (; i < size; ++i)
+    {
+        const float d = a[i] - b[i];
+        r0 += d * d;
+    }
+    return (r0 + r1) + (r2 + r3);
+}
+
+std::uint32_t l2UChar_scalar(const std::uint8_t* a, const std::uint8_t* b, std::size_t size)
+{
+    std::uint32_t result = 0;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        const int d = int(a[i]) - int(b[i]);
+        result += d * d;
+    }
+    return result;
+}
+
+std::uint32_t hamming_scalar(const std::uint8_t* a, const std::uint8_t* b, std::size_t nbBytes)
+{
+    std::uint32_t result = 0;
+    std::size_t i = 0;
+    for (; i + 8 <= nbBytes; i += 8)
+        result += popcount64(load64(a + i) ^ load64(b + i));
+    for (; i < nbBytes; ++i)
+        result += popcount64(a[i] ^ b[i]);
+    return result;
+}
+
+#ifdef ALICEVISION_DISTANCE_KERNELS_X86
+
+// ------------------------------------------------------------------------------------------------
+// CPU features
+
+struct CpuFeatures
+{
+    bool sse42 = false;
+    bool popcnt = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool avx512f = false;
+    bool avx512bw = false;
+    bool avx512vpopcntdq = false;
+};
+
+void cpuid(int leaf, int subleaf, unsigned int regs[4])
+{
+    #ifdef _MSC_VER
+    int r[4];
+    __cpuidex(r, leaf, subleaf);
+    for (int i = 0; i < 4; ++i)
+        regs[i] = static_cast<unsigned int>(r[i]);
+    #else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+    #endif
+}
+
+std::uint64_t xgetbv0()
+{
+    #ifdef _MSC_VER
+    return _xgetbv(0);
+    #else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (std::uint64_t(edx) << 32) | eax;
+    #endif
+}
+
+CpuFeatures detectCpuFeatures()
+{
+    CpuFeatures f;
+    unsigned int regs[4];  // eax, ebx, ecx, edx
+
+    cpuid(0, 0, regs);
+    const unsigned int maxLeaf = regs[0];
+    if (maxLeaf < 1)
+        return f;
+
+    cpuid(1, 0, regs);
+    f.sse42 = regs[2] & (1u << 20);
+    f.popcnt = regs[2] & (1u << 23);
+    f.fma = regs[2] & (1u << 12);
+    const bool osxsave = regs[2] & (1u << 27);
+    const bool avx = regs[2] & (1u << 28);
+
+    // the OS must save the AVX (and AVX-512) registers on context switch
+    const std::uint64_t xcr0 = osxsave ? xgetbv0() : 0;
+    const bool osAvx = avx && (xcr0 & 0x6) == 0x6;
+    const bool osAvx512 = osAvx && (xcr0 & 0xE0) == 0xE0;
+
+    f.fma = f.fma && osAvx;
+
+    if (maxLeaf >= 7)
+    {
+        cpuid(7, 0, regs);
+        f.avx2 = osAvx && (regs[1] & (1u << 5));
+        f.avx512f = osAvx512 && (regs[1] & (1u << 16));
+        f.avx512bw = osAvx512 && (regs[1] & (1u << 30));
+        f.avx512vpopcntdq = osAvx512 && (regs[2] & (1u << 14));
+    }
+    return f;
+}
+
+const CpuFeatures& getCpuFeatures()
+{
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
+
+// ------------------------------------------------------------------------------------------------
+// SSE4.2
+
+ALICEVISION_TARGET("sse4.2")
+inline float hsum_ps_sse(__m128 v)
+{
+    __m128 shuf = _mm_movehdup_ps(v);
+    __m128 sums = _mm_add_ps(v, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    sums = _mm_add_ss(sums, shuf);
+    return _mm_cvtss_f32(sums);
+}
+
+ALICEVISION_TARGET("sse4.2")
+inline std::uint32_t hsum_epi32_sse(__m128i v)
+{
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return static_cast<std::uint32_t>(_mm_cvtsi128_si32(v));
+}
+
+ALICEVISION_TARGET("sse4.2")
+float l2Float_sse42(const float* a, const float* b, std::size_t size)
+{
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        const __m128 d0 = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        const __m128 d1 = _mm_sub_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4));
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(d0, d0));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(d1, d1));
+    }
+    for (; i + 4 <= size; i += 4)
+    {
+        const __m128 d = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(d, d));
+    }
+    float result = hsum_ps_sse(_mm_add_ps(acc0, acc1));
+    for (; i < size; ++i)
+    {
+        const float d = a[i] - b[i];
+        result += d * d;
+    }
+    return result;
+}
+
+ALICEVISION_TARGET("sse4.2")
+std::uint32_t l2UChar_sse42(const std::uint8_t* a, const std::uint8_t* b, std::size_t size)
+{
+    __m128i acc = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i dLo = _mm_sub_epi16(_mm_unpacklo_epi8(va, zero), _mm_unpacklo_epi8(vb, zero));
+        const __m128i dHi = _mm_sub_epi16(_mm_unpackhi_epi8(va, zero), _mm_unpackhi_epi8(vb, zero));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(dLo, dLo));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(dHi, dHi));
+    }
+    return hsum_epi32_sse(acc) + l2UChar_scalar(a + i, b + i, size - i);
+}
+
+ALICEVISION_TARGET("sse4.2,popcnt")
+std::uint32_t hamming_sse42(const std::uint8_t* a, const std::uint8_t* b, std::size_t nbBytes)
+{
+    std::uint64_t result = 0;
+    std::size_t i = 0;
+    for (; i + 8 <= nbBytes; i += 8)
+        result += _mm_popcnt_u64(load64(a + i) ^ load64(b + i));
+    for (; i < nbBytes; ++i)
+        result += _mm_popcnt_u32(a[i] ^ b[i]);
+    return static_cast<std::uint32_t>(result);
+}
+
+// ------------------------------------------------------------------------------------------------
+// AVX2
+
+ALICEVISION_TARGET("avx2,fma")
+inline float hsum_ps_avx(__m256 v) { return hsum_ps_sse(_mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1))); }
+
+ALICEVISION_TARGET("avx2,fma")
+float l2Float_avx2(const float* a, const float* b, std::size_t size)
+{
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        const __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+        acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+    }
+    for (; i + 8 <= size; i += 8)
+    {
+        const __m256 d = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        acc0 = _mm256_fmadd_ps(d, d, acc0);
+    }
+    float result = hsum_ps_avx(_mm256_add_ps(acc0, acc1));
+    for (; i < size; ++i)
+    {
+        const float d = a[i] - b[i];
+        result += d * d;
+    }
+    return result;
+}
+
+ALICEVISION_TARGET("avx2,fma")
+std::uint32_t l2UChar_avx2(const std::uint8_t* a, const std::uint8_t* b, std::size_t size)
+{
+    __m256i acc = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m256i va = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+        const __m256i vb = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        const __m256i d = _mm256_sub_epi16(va, vb);
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(d, d));
+    }
+    // reduce before the tail call: no 256-bit register alive across the call
+    const std::uint32_t result = hsum_epi32_sse(_mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1)));
+    return result + l2UChar_scalar(a + i, b + i, size - i);
+}
+
+/// nibble lookup table popcount (Mula et al.)
+ALICEVISION_TARGET("avx2,popcnt")
+std::uint32_t hamming_avx2(const std::uint8_t* a, const std::uint8_t* b, std::size_t nbBytes)
+{
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowMask = _mm256_set1_epi8(0x0f);
+
+    __m256i acc = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 32 <= nbBytes; i += 32)
+    {
+        const __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+                                           _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+        const __m256i lo = _mm256_and_si256(v, lowMask);
+        const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+        const __m256i count = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+        // sum the byte counts in 64-bit lanes
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(count, _mm256_setzero_si256()));
+    }
+    const std::uint64_t result = std::uint64_t(_mm256_extract_epi64(acc, 0)) + std::uint64_t(_mm256_extract_epi64(acc, 1)) +
+                                 std::uint64_t(_mm256_extract_epi64(acc, 2)) + std::uint64_t(_mm256_extract_epi64(acc, 3));
+    // not always inserted by the compiler, avoid the AVX to SSE transition penalty in the caller
+    _mm256_zeroupper();
+    return static_cast<std::uint32_t>(result) + hamming_sse42(a + i, b + i, nbBytes - i);
+}
+
+// ------------------------------------------------------------------------------------------------
+// AVX-512
+
+ALICEVISION_TARGET("avx512f,avx512bw,avx2,fma")
+float l2Float_avx512(const float* a, const float* b, std::size_t size)
+{
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        const __m512 d0 = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+        const __m512 d1 = _mm512_sub_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16));
+        acc0 = _mm512_fmadd_ps(d0, d0, acc0);
+        acc1 = _mm512_fmadd_ps(d1, d1, acc1);
+    }
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m512 d = _mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+        acc0 = _mm512_fmadd_ps(d, d, acc0);
+    }
+    if (i < size)
+    {
+        // masked loads for the last 1-15 values
+        const __mmask16 mask = static_cast<__mmask16>((1u << (size - i)) - 1);
+        const __m512 d = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i));
+        acc1 = _mm512_fmadd_ps(d, d, acc1);
+    }
+    return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+ALICEVISION_TARGET("avx512f,avx512bw,avx2,fma")
+std::uint32_t l2UChar_avx512(const std::uint8_t* a, const std::uint8_t* b, std::size_t size)
+{
+    __m512i acc = _mm512_setzero_si512();
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32)
+    {
+        const __m512i va = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+        const __m512i vb = _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+        const __m512i d = _mm512_sub_epi16(va, vb);
+        acc = _mm512_add_epi32(acc, _mm512_madd_epi16(d, d));
+    }
+    const std::uint32_t result = static_cast<std::uint32_t>(_mm512_reduce_add_epi32(acc));
+    return result + l2UChar_avx2(a + i, b + i, size - i);
+}
+
+ALICEVISION_TARGET("avx512f,avx512bw,avx512vpopcntdq,avx2,popcnt")
+std::uint32_t hamming_avx512(const std::uint8_t* a, const std::uint8_t* b, std::size_t nbBytes)
+{
+    __m512i acc = _mm512_setzero_si512();
+    std::size_t i = 0;
+    for (; i + 64 <= nbBytes; i += 64)
+    {
+        const __m512i v = _mm512_xor_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+        acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(v));
+    }
+    const std::uint64_t result = _mm512_reduce_add_epi64(acc);
+    _mm256_zeroupper();
+    return static_cast<std::uint32_t>(result) + hamming_sse42(a + i, b + i, nbBytes - i);
+}
+
+#endif  // ALICEVISION_DISTANCE_KERNELS_X86
+
+}  // namespace
+
+bool isDistanceKernelSupported(EDistanceKernel kernel)
+{
+    if (kernel == EDistanceKernel::SCALAR)
+        return true;
+
+#ifdef ALICEVISION_DISTANCE_KERNELS_X86
+    const CpuFeatures& f = getCpuFeatures();
+    switch (kernel)
+    {
+        case EDistanceKernel::SCALAR:
+            return true;
+        case EDistanceKernel::SSE42:
+            return f.sse42 && f.popcnt;
+        case EDistanceKernel::AVX2:
+            return f.sse42 && f.popcnt && f.avx2 && f.fma;
+        case EDistanceKernel::AVX512:
+            return f.sse42 && f.popcnt && f.avx2 && f.fma && f.avx512f && f.avx512bw;
+    }
+#endif
+    return false;
+}
+
+std::vector<EDistanceKernel> getSupportedDistanceKernels()
+{
+    std::vector<EDistanceKernel> kernels;
+    for (EDistanceKernel kernel : {EDistanceKernel::SCALAR, EDistanceKernel::SSE42, EDistanceKernel::AVX2, EDistanceKernel::AVX512})
+    {
+        if (isDistanceKernelSupported(kernel))
+            kernels.push_back(kernel);
+    }
+    return kernels;
+}
+
+EDistanceKernel getBestDistanceKernel()
+{
+    static const EDistanceKernel best = getSupportedDistanceKernels().back();
+    return best;
+}
+
+const DistanceKernels& getDistanceKernels(EDistanceKernel kernel)
+{
+    if (!isDistanceKernelSupported(kernel))
+        throw std::runtime_error("Distance kernel '" + EDistanceKernel_enumToString(kernel) + "' is not supported by the CPU.");
+
+    static const DistanceKernels scalar = {l2Float_scalar, l2UChar_scalar, hamming_scalar};
+
+#ifdef ALICEVISION_DISTANCE_KERNELS_X86
+    static const DistanceKernels sse42 = {l2Float_sse42, l2UChar_sse42, hamming_sse42};
+    static const DistanceKernels avx2 = {l2Float_avx2, l2UChar_avx2, hamming_avx2};
+    // VPOPCNTDQ is not part of AVX-512 F/BW (e.g. Skylake-X)
+    static const DistanceKernels avx512 = {
+      l2Float_avx512, l2UChar_avx512, getCpuFeatures().avx512vpopcntdq ? hamming_avx512 : hamming_avx2};
+
+    switch (kernel)
+    {
+        case EDistanceKernel::SCALAR:
+            return scalar;
+        case EDistanceKernel::SSE42:
+            return sse42;
+        case EDistanceKernel::AVX2:
+            return avx2;
+        case EDistanceKernel::AVX512:
+            return avx512;
+    }
+#endif
+    return scalar;
+}
+
+const DistanceKernels& getDistanceKernels()
+{
+    static const DistanceKernels& kernels = []() -> const DistanceKernels& {
+        const EDistanceKernel best = getBestDistanceKernel();
+        ALICEVISION_LOG_DEBUG("Descriptor distance kernels: " << EDistanceKernel_enumToString(best));
+        return getDistanceKernels(best);
+    }();
+    return kernels;
+}
+
+}  // namespace feature
+}  // namespace aliceVision
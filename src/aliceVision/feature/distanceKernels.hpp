@@ -0,0 +1,83 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace feature {
+
+/**
+ * @brief Instruction sets of the descriptor distance kernels.
+ */
+enum class EDistanceKernel
+{
+    SCALAR = 0,  //< portable C++
+    SSE42,       //< SSE4.2 + POPCNT
+    AVX2,        //< AVX2 + FMA + POPCNT
+    AVX512       //< AVX-512 F/BW, Hamming with VPOPCNTDQ if available
+};
+
+std::string EDistanceKernel_enumToString(EDistanceKernel kernel);
+
+/**
+ * @brief Set of descriptor distance functions of a given instruction set.
+ * @note Descriptors do not need any alignment and can have any size.
+ */
+struct DistanceKernels
+{
+    /// squared L2 distance between float descriptors
+    float (*l2Float)(const float* a, const float* b, std::size_t size);
+    /// squared L2 distance between uint8 descriptors (SIFT)
+    std::uint32_t (*l2UChar)(const std::uint8_t* a, const std::uint8_t* b, std::size_t size);
+    /// Hamming distance between binary descriptors of the given number of bytes
+    std::uint32_t (*hamming)(const std::uint8_t* a, const std::uint8_t* b, std::size_t nbBytes);
+};
+
+/**
+ * @brief Check if the current CPU (and OS) supports the given distance kernels.
+ */
+bool isDistanceKernelSupported(EDistanceKernel kernel);
+
+/**
+ * @brief Get the distance kernels supported by the current CPU.
+ */
+std::vector<EDistanceKernel> getSupportedDistanceKernels();
+
+/**
+ * @brief Get the best distance kernels supported by the current CPU (selected once with CPUID).
+ */
+EDistanceKernel getBestDistanceKernel();
+
+/**
+ * @brief Get the distance functions of the given instruction set.
+ * @note throw if the kernel is not supported by the current CPU
+ */
+const DistanceKernels& getDistanceKernels(EDistanceKernel kernel);
+
+/**
+ * @brief Get the distance functions of the best instruction set supported by the current CPU.
+ */
+const DistanceKernels& getDistanceKernels();
+
+inline float l2SquaredDistance(const float* a, const float* b, std::size_t size) { return getDistanceKernels().l2Float(a, b, size); }
+
+inline std::uint32_t l2SquaredDistance(const std::uint8_t* a, const std::uint8_t* b, std::size_t size)
+{
+    return getDistanceKernels().l2UChar(a, b, size);
+}
+
+inline std::uint32_t hammingDistance(const std::uint8_t* a, const std::uint8_t* b, std::size_t nbBytes)
+{
+    return getDistanceKernels().hamming(a, b, nbBytes);
+}
+
+}  // namespace feature
+}  // namespace aliceVision
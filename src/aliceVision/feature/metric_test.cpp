@@ -6,9 +6,12 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include <aliceVision/feature/metric.hpp>
+#include <aliceVision/feature/distanceKernels.hpp>
 
 #include <iostream>
+#include <random>
 #include <string>
+#include <vector>
 
 #define BOOST_TEST_MODULE matchingMetric
 
@@ -152,3 +155,73 @@ BOOST_AUTO_TEST_CASE(Metric_HAMMING_BITSET_RAW_MEMORY_32BITS)
         }
     }
 }
+
+BOOST_AUTO_TEST_CASE(Metric_DistanceKernels)
+{
+    std::mt19937 randomNumberGenerator(42);
+    std::uniform_real_distribution<float> floatDistribution(0.f, 1.f);
+    std::uniform_int_distribution<int> byteDistribution(0, 255);
+
+    // one extra value to test unaligned data
+    const std::size_t maxSize = 300;
+    std::vector<float> floatA(maxSize + 1), floatB(maxSize + 1);
+    std::vector<std::uint8_t> byteA(maxSize + 1), byteB(maxSize + 1);
+
+    for (std::size_t i = 0; i <= maxSize; ++i)
+    {
+        floatA[i] = floatDistribution(randomNumberGenerator);
+        floatB[i] = floatDistribution(randomNumberGenerator);
+        byteA[i] = static_cast<std::uint8_t>(byteDistribution(randomNumberGenerator));
+        byteB[i] = static_cast<std::uint8_t>(byteDistribution(randomNumberGenerator));
+    }
+
+    const std::vector<EDistanceKernel> kernels = getSupportedDistanceKernels();
+    BOOST_CHECK(!kernels.empty());
+    BOOST_CHECK(kernels.front() == EDistanceKernel::SCALAR);
+    BOOST_CHECK(kernels.back() == getBestDistanceKernel());
+
+    for (const EDistanceKernel kernel : kernels)
+    {
+        BOOST_TEST_MESSAGE("Distance kernels: " << EDistanceKernel_enumToString(kernel));
+        const DistanceKernels& k = getDistanceKernels(kernel);
+
+        // all sizes (vector tails), aligned or not
+        for (std::size_t offset = 0; offset < 2; ++offset)
+        {
+            for (std::size_t size = 0; size <= maxSize - offset; ++size)
+            {
+                const float* fa = floatA.data() + offset;
+                const float* fb = floatB.data() + offset;
+                const std::uint8_t* ba = byteA.data() + offset;
+                const std::uint8_t* bb = byteB.data() + offset;
+
+                double l2FloatGt = 0.0;
+                std::uint32_t l2UCharGt = 0;
+                std::uint32_t hammingGt = 0;
+                for (std::size_t i = 0; i < size; ++i)
+                {
+                    l2FloatGt += (double(fa[i]) - fb[i]) * (double(fa[i]) - fb[i]);
+                    l2UCharGt += (int(ba[i]) - int(bb[i])) * (int(ba[i]) - int(bb[i]));
+                    hammingGt += std::bitset<8>(ba[i] ^ bb[i]).count();
+                }
+
+                BOOST_CHECK_SMALL(k.l2Float(fa, fb, size) - l2FloatGt, 1e-4 * (1.0 + l2FloatGt));
+                BOOST_CHECK_EQUAL(k.l2UChar(ba, bb, size), l2UCharGt);
+                BOOST_CHECK_EQUAL(k.hamming(ba, bb, size), hammingGt);
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(Metric_L2_Vectorized_anySize)
+{
+    // sizes that are not a multiple of 4
+    const float a[] = {0, 1, 2, 3, 4, 5, 6};
+    const float b[] = {6, 5, 4, 3, 2, 1, 0};
+    const unsigned char ua[] = {0, 1, 2, 3, 4, 5, 6};
+    const unsigned char ub[] = {6, 5, 4, 3, 2, 1, 0};
+
+    BOOST_CHECK_EQUAL(112, L2_Vectorized<float>()(a, b, 7));
+    BOOST_CHECK_EQUAL(112, L2_Vectorized<unsigned char>()(ua, ub, 7));
+    BOOST_CHECK_EQUAL(L2_Simple<float>()(a, b, 5), L2_Vectorized<float>()(a, b, 5));
+}
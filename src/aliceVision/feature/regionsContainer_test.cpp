@@ -0,0 +1,203 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/RegionsContainer.hpp>
+#include <aliceVision/feature/regionsFactory.hpp>
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#define BOOST_TEST_MODULE RegionsContainer
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::feature;
+
+namespace {
+
+SIFT_Regions makeRegions(IndexT viewId, int nbRegions)
+{
+    SIFT_Regions regions;
+    for (int i = 0; i < nbRegions; ++i)
+    {
+        regions.Features().emplace_back(float(viewId + i), float(i * 2), float(i * 3), float(i) * 0.1f);
+
+        SIFT_Regions::DescriptorT desc;
+        for (std::size_t j = 0; j < desc.size(); ++j)
+            desc[j] = static_cast<unsigned char>((viewId * 31 + i * 7 + j) % 256);
+        regions.Descriptors().push_back(desc);
+    }
+    return regions;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(RegionsContainer_writeRead)
+{
+    const std::string filename = "tempRegions.regions";
+    const std::vector<IndexT> viewIds = {42, 7, 1000, 3};
+
+    {
+        RegionsContainerWriter writer(filename, EImageDescriberType::SIFT);
+        for (IndexT viewId : viewIds)
+            writer.addRegions(viewId, makeRegions(viewId, int(viewId % 50) + 1));
+
+        // each view can only be added once
+        BOOST_CHECK_THROW(writer.addRegions(7, makeRegions(7, 3)), std::exception);
+    }
+
+    const RegionsContainer container(filename);
+
+    BOOST_CHECK(container.getDescriberType() == EImageDescriberType::SIFT);
+    BOOST_CHECK_EQUAL(container.getNbViews(), viewIds.size());
+    BOOST_CHECK(!container.hasView(8));
+
+    const std::vector<IndexT> sortedViewIds = {3, 7, 42, 1000};
+    const std::vector<IndexT> containerViewIds = container.getViewIds();
+    BOOST_CHECK_EQUAL_COLLECTIONS(containerViewIds.begin(), containerViewIds.end(), sortedViewIds.begin(), sortedViewIds.end());
+
+    for (IndexT viewId : viewIds)
+    {
+        const SIFT_Regions expected = makeRegions(viewId, int(viewId % 50) + 1);
+
+        SIFT_Regions regions;
+        container.loadRegions(viewId, regions);
+
+        BOOST_CHECK_EQUAL(container.getNbFeatures(viewId), expected.RegionCount());
+        BOOST_CHECK_EQUAL(regions.RegionCount(), expected.RegionCount());
+        BOOST_CHECK_EQUAL(regions.DescriptorCount(), expected.RegionCount());
+
+        // descriptors are used in place, without copy
+        BOOST_CHECK(regions.hasWrappedDescriptors());
+
+        for (std::size_t i = 0; i < expected.RegionCount(); ++i)
+        {
+            BOOST_CHECK_EQUAL(regions.Features()[i], expected.Features()[i]);
+            BOOST_CHECK_EQUAL(regions.SquaredDescriptorDistance(i, &expected, i), 0.0);
+        }
+
+        // saving writes the wrapped descriptors without copy
+        const std::string descFilename = "tempWrapped.desc";
+        regions.SaveDesc(descFilename);
+        BOOST_CHECK(regions.hasWrappedDescriptors());
+        {
+            std::vector<SIFT_Regions::DescriptorT> savedDescs;
+            loadDescsFromBinFile(descFilename, savedDescs);
+            BOOST_CHECK(savedDescs == expected.Descriptors());
+        }
+        std::remove(descFilename.c_str());
+
+        // std::vector access copies the descriptors
+        const SIFT_Regions& constRegions = regions;
+        BOOST_CHECK(constRegions.Descriptors() == expected.Descriptors());
+        BOOST_CHECK(regions.hasWrappedDescriptors());
+
+        regions.Descriptors().push_back(expected.Descriptors().front());
+        BOOST_CHECK(!regions.hasWrappedDescriptors());
+        BOOST_CHECK_EQUAL(regions.DescriptorCount(), expected.RegionCount() + 1);
+    }
+
+    // features only
+    {
+        SIFT_Regions regions;
+        container.loadFeatures(42, regions);
+        BOOST_CHECK_EQUAL(regions.RegionCount(), makeRegions(42, 43).RegionCount());
+        BOOST_CHECK_EQUAL(regions.DescriptorCount(), 0);
+    }
+
+    // invalid requests
+    {
+        SIFT_Regions regions;
+        BOOST_CHECK_THROW(container.loadRegions(8, regions), std::exception);
+
+        SIFT_Float_Regions floatRegions;
+        BOOST_CHECK_THROW(container.loadRegions(42, floatRegions), std::exception);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(RegionsContainer_wrappedLifetime)
+{
+    const std::string filename = "tempRegionsLifetime.regions";
+
+    {
+        RegionsContainerWriter writer(filename, EImageDescriberType::SIFT);
+        writer.addRegions(0, makeRegions(0, 10));
+    }
+
+    SIFT_Regions regions;
+    {
+        const RegionsContainer container(filename);
+        container.loadRegions(0, regions);
+    }
+
+    // regions keep the file mapped after the container destruction
+    const SIFT_Regions expected = makeRegions(0, 10);
+    for (std::size_t i = 0; i < expected.RegionCount(); ++i)
+        BOOST_CHECK_EQUAL(regions.SquaredDescriptorDistance(i, &expected, i), 0.0);
+}
+
+BOOST_AUTO_TEST_CASE(RegionsContainer_invalidFile)
+{
+    BOOST_CHECK_THROW(RegionsContainer("nonExisting.regions"), std::exception);
+
+    {
+        std::ofstream file("tempInvalid.regions", std::ios::binary);
+        file << "not a regions container, only some text to fill the header";
+    }
+    BOOST_CHECK_THROW(RegionsContainer("tempInvalid.regions"), std::exception);
+}
+
+BOOST_AUTO_TEST_CASE(RegionsContainer_invalidEntry)
+{
+    const std::string filename = "tempInvalidEntry.regions";
+
+    {
+        RegionsContainerWriter writer(filename, EImageDescriberType::SIFT);
+        writer.addRegions(0, makeRegions(0, 10));
+        writer.addRegions(1, makeRegions(1, 10));
+    }
+    BOOST_CHECK_NO_THROW(RegionsContainer{filename});
+
+    RegionsContainerHeader header;
+    {
+        std::ifstream file(filename, std::ios::binary);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    }
+
+    // overwrite one field of the second index entry
+    const auto corruptEntry = [&](std::size_t fieldOffset, std::uint64_t value) {
+        std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(header.indexOffset + sizeof(RegionsContainerIndexEntry) + fieldOffset);
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+
+    RegionsContainerIndexEntry entry;
+    {
+        std::ifstream file(filename, std::ios::binary);
+        file.seekg(header.indexOffset + sizeof(RegionsContainerIndexEntry));
+        file.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+    }
+
+    // descriptors out of the file
+    corruptEntry(offsetof(RegionsContainerIndexEntry, nbDescriptors), 1000000);
+    BOOST_CHECK_THROW(RegionsContainer{filename}, std::exception);
+    corruptEntry(offsetof(RegionsContainerIndexEntry, nbDescriptors), entry.nbDescriptors);
+
+    // features offset out of the file
+    corruptEntry(offsetof(RegionsContainerIndexEntry, featuresOffset), header.indexOffset * 64);
+    BOOST_CHECK_THROW(RegionsContainer{filename}, std::exception);
+    corruptEntry(offsetof(RegionsContainerIndexEntry, featuresOffset), entry.featuresOffset);
+
+    // huge number of features, the range size would overflow
+    corruptEntry(offsetof(RegionsContainerIndexEntry, nbFeatures), std::uint64_t(-1) / 8);
+    BOOST_CHECK_THROW(RegionsContainer{filename}, std::exception);
+    corruptEntry(offsetof(RegionsContainerIndexEntry, nbFeatures), entry.nbFeatures);
+
+    BOOST_CHECK_NO_THROW(RegionsContainer{filename});
+}
@@ -0,0 +1,210 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/RegionsProvider.hpp>
+#include <aliceVision/feature/regionsFactory.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#define BOOST_TEST_MODULE RegionsProvider
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::feature;
+
+namespace {
+
+constexpr std::size_t nbRegionsPerView = 100;
+
+/**
+ * @brief Loader of synthetic regions, counting the number of loadings per view.
+ */
+struct CountingLoader
+{
+    std::shared_ptr<std::map<IndexT, std::atomic<int>>> nbLoadings = std::make_shared<std::map<IndexT, std::atomic<int>>>();
+
+    explicit CountingLoader(IndexT nbViews)
+    {
+        for (IndexT viewId = 0; viewId < nbViews; ++viewId)
+            (*nbLoadings)[viewId] = 0;
+    }
+
+    MapRegionsPerDesc operator()(IndexT viewId) const
+    {
+        if (nbLoadings->count(viewId) == 0)
+            throw std::runtime_error("Unknown view " + std::to_string(viewId));
+        ++nbLoadings->at(viewId);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+        auto regions = std::make_shared<SIFT_Regions>();
+        for (std::size_t i = 0; i < nbRegionsPerView; ++i)
+        {
+            regions->Features().emplace_back(float(viewId), float(i), 1.0f, 0.0f);
+            SIFT_Regions::DescriptorT descriptor;
+            for (std::size_t j = 0; j < descriptor.size(); ++j)
+                descriptor[j] = static_cast<unsigned char>(viewId);
+            regions->Descriptors().push_back(descriptor);
+        }
+        MapRegionsPerDesc regionsPerDesc;
+        regionsPerDesc[EImageDescriberType::SIFT] = regions;
+        return regionsPerDesc;
+    }
+
+    int getNbLoadings(IndexT viewId) const { return nbLoadings->at(viewId); }
+};
+
+std::size_t getViewSize() { return nbRegionsPerView * (sizeof(PointFeature) + 128); }
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(RegionsCache_lru)
+{
+    const CountingLoader loader(10);
+    RegionsCache cache(loader, 3 * getViewSize());
+
+    for (IndexT viewId = 0; viewId < 5; ++viewId)
+    {
+        const MapRegionsPerDesc regionsPerDesc = cache.getRegions(viewId);
+        BOOST_CHECK_EQUAL(regionsPerDesc.getNbAllRegions(), nbRegionsPerView);
+        BOOST_CHECK_EQUAL(regionsPerDesc.at(EImageDescriberType::SIFT)->Features().front().x(), float(viewId));
+    }
+
+    // only the 3 most recently used views are kept
+    BOOST_CHECK(!cache.contains(0));
+    BOOST_CHECK(!cache.contains(1));
+    for (IndexT viewId = 2; viewId < 5; ++viewId)
+        BOOST_CHECK(cache.contains(viewId));
+
+    // the request of a view moves it at the front of the list
+    cache.getRegions(2);
+    cache.getRegions(5);
+    BOOST_CHECK(cache.contains(2));
+    BOOST_CHECK(!cache.contains(3));
+
+    const RegionsCacheStats stats = cache.getStats();
+    BOOST_CHECK_EQUAL(stats.nbMisses, 6);
+    BOOST_CHECK_EQUAL(stats.nbHits, 1);
+    BOOST_CHECK_EQUAL(stats.nbEvictions, 3);
+    BOOST_CHECK_EQUAL(stats.bytesRead, 6 * getViewSize());
+    BOOST_CHECK_EQUAL(stats.residentBytes, 3 * getViewSize());
+    BOOST_CHECK(stats.peakResidentBytes <= 4 * getViewSize());
+    for (IndexT viewId = 0; viewId < 6; ++viewId)
+        BOOST_CHECK_EQUAL(loader.getNbLoadings(viewId), 1);
+}
+
+BOOST_AUTO_TEST_CASE(RegionsCache_inUse)
+{
+    const CountingLoader loader(10);
+    RegionsCache cache(loader, 2 * getViewSize());
+
+    // regions in use are never released
+    const MapRegionsPerDesc regions0 = cache.getRegions(0);
+    for (IndexT viewId = 1; viewId < 6; ++viewId)
+        cache.getRegions(viewId);
+
+    BOOST_CHECK(cache.contains(0));
+    BOOST_CHECK(cache.contains(5));
+    BOOST_CHECK_EQUAL(cache.getStats().residentBytes, 2 * getViewSize());
+
+    // the shared regions are the same
+    BOOST_CHECK(cache.getRegions(0).at(EImageDescriberType::SIFT) == regions0.at(EImageDescriberType::SIFT));
+    BOOST_CHECK_EQUAL(loader.getNbLoadings(0), 1);
+
+    cache.clear();
+    BOOST_CHECK(cache.contains(0));
+    BOOST_CHECK(!cache.contains(5));
+}
+
+BOOST_AUTO_TEST_CASE(RegionsCache_concurrentRequests)
+{
+    const CountingLoader loader(10);
+    RegionsCache cache(loader, 0);
+
+    // the test macros are not thread-safe, the results are checked after the join
+    std::atomic<std::size_t> nbAllRegions(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&cache, &nbAllRegions, t]() {
+            for (IndexT viewId = 0; viewId < 10; ++viewId)
+                nbAllRegions += cache.getRegions((viewId + t) % 10).getNbAllRegions();
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    BOOST_CHECK_EQUAL(nbAllRegions, 80 * nbRegionsPerView);
+
+    // each view is loaded once
+    for (IndexT viewId = 0; viewId < 10; ++viewId)
+        BOOST_CHECK_EQUAL(loader.getNbLoadings(viewId), 1);
+
+    const RegionsCacheStats stats = cache.getStats();
+    BOOST_CHECK_EQUAL(stats.nbMisses, 10);
+    BOOST_CHECK_EQUAL(stats.nbHits, 70);
+    BOOST_CHECK_EQUAL(stats.nbEvictions, 0);
+}
+
+BOOST_AUTO_TEST_CASE(RegionsCache_prefetch)
+{
+    const CountingLoader loader(10);
+    RegionsCache cache(loader, 0);
+
+    cache.prefetch({3, 4, 99});
+
+    // the prefetched views are available without loading
+    BOOST_CHECK_EQUAL(cache.getRegions(4).getNbAllRegions(), nbRegionsPerView);
+    BOOST_CHECK_EQUAL(cache.getRegions(3).getNbAllRegions(), nbRegionsPerView);
+    BOOST_CHECK_EQUAL(loader.getNbLoadings(3), 1);
+    BOOST_CHECK_EQUAL(loader.getNbLoadings(4), 1);
+
+    // prefetch errors are reported on request
+    BOOST_CHECK_THROW(cache.getRegions(99), std::runtime_error);
+    BOOST_CHECK(!cache.contains(99));
+    BOOST_CHECK_EQUAL(cache.getRegions(5).getNbAllRegions(), nbRegionsPerView);
+}
+
+BOOST_AUTO_TEST_CASE(RegionsCache_pairsWindows)
+{
+    PairVec pairs;
+    for (IndexT i = 0; i < 20; ++i)
+    {
+        for (IndexT j = i + 1; j < 20; j += 3)
+            pairs.emplace_back(i, j);
+    }
+
+    const std::size_t maxViewsPerWindow = 8;
+    const std::vector<std::pair<std::size_t, std::size_t>> windows = computePairsWindows(pairs, maxViewsPerWindow);
+    BOOST_REQUIRE(!windows.empty());
+    BOOST_CHECK_EQUAL(windows.front().first, 0);
+    BOOST_CHECK_EQUAL(windows.back().second, pairs.size());
+    for (std::size_t w = 1; w < windows.size(); ++w)
+        BOOST_CHECK_EQUAL(windows[w].first, windows[w - 1].second);
+
+    const CountingLoader loader(20);
+    RegionsCache cache(loader, 2 * maxViewsPerWindow * getViewSize());
+
+    std::vector<int> nbProcessings(pairs.size(), 0);
+    forEachPairsWindow(cache, pairs, maxViewsPerWindow, [&](const RegionsPerView& regionsPerView, std::size_t begin, std::size_t end) {
+        BOOST_CHECK(regionsPerView.getData().size() <= maxViewsPerWindow);
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            BOOST_CHECK(regionsPerView.viewExist(pairs[i].first));
+            BOOST_CHECK(regionsPerView.viewExist(pairs[i].second));
+            ++nbProcessings[i];
+        }
+    });
+
+    for (int nbProcessing : nbProcessings)
+        BOOST_CHECK_EQUAL(nbProcessing, 1);
+    BOOST_CHECK(cache.getStats().peakResidentBytes <= 3 * maxViewsPerWindow * getViewSize());
+}
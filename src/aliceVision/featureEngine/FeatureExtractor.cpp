@@ -7,15 +7,206 @@
 #include "FeatureExtractor.hpp"
 #include <aliceVision/image/io.hpp>
 #include <aliceVision/system/MemoryInfo.hpp>
-#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/system/Timer.hpp>
 #include <boost/filesystem.hpp>
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 namespace fs = boost::filesystem;
 
 namespace aliceVision {
 namespace featureEngine {
 
+namespace {
+
+/**
+ * @brief Memory shared by the jobs in flight.
+ * A job is admitted only when its memory consumption fits in the remaining budget,
+ * a job bigger than the whole budget is admitted alone.
+ */
+class MemoryBudget
+{
+  public:
+    explicit MemoryBudget(std::size_t capacity)
+      : _capacity(capacity)
+    {}
+
+    /**
+     * @brief Wait until the given memory is available and reserve it.
+     * @return false if the pipeline has been canceled
+     */
+    bool acquire(std::size_t memory)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait(lock, [&] { return _canceled || _used == 0 || _used + memory <= _capacity; });
+        if (_canceled)
+            return false;
+        _used += memory;
+        _peak = std::max(_peak, _used);
+        return true;
+    }
+
+    void release(std::size_t memory)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _used -= memory;
+        }
+        _condition.notify_all();
+    }
+
+    void cancel()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _canceled = true;
+        }
+        _condition.notify_all();
+    }
+
+    std::size_t capacity() const { return _capacity; }
+
+    std::size_t peak() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _peak;
+    }
+
+  private:
+    const std::size_t _capacity;
+    std::size_t _used = 0;
+    std::size_t _peak = 0;
+    bool _canceled = false;
+    mutable std::mutex _mutex;
+    std::condition_variable _condition;
+};
+
+/**
+ * @brief Blocking FIFO queue between two stages of the pipeline.
+ */
+template<typename T>
+class WorkQueue
+{
+  public:
+    void push(T item)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _items.push_back(std::move(item));
+        }
+        _condition.notify_one();
+    }
+
+    /**
+     * @brief Wait for an item.
+     * @return false if the queue is closed and empty
+     */
+    bool pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait(lock, [&] { return !_items.empty() || _closed; });
+        if (_items.empty())
+            return false;
+        item = std::move(_items.front());
+        _items.pop_front();
+        return true;
+    }
+
+    /// no more items will be pushed
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _closed = true;
+        }
+        _condition.notify_all();
+    }
+
+  private:
+    std::deque<T> _items;
+    bool _closed = false;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+};
+
+/**
+ * @brief Accumulated time of each stage of the pipeline.
+ */
+class StageTimings
+{
+  public:
+    enum EStage
+    {
+        DECODE = 0,
+        DESCRIBE_CPU,
+        DESCRIBE_GPU,
+        WRITE,
+        NB_STAGES
+    };
+
+    void add(EStage stage, double seconds)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _seconds[stage] += seconds;
+        ++_counts[stage];
+    }
+
+    void log(double wallTime) const
+    {
+        static const std::array<const char*, NB_STAGES> names = {"decode", "describe [cpu]", "describe [gpu]", "write"};
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::stringstream ss;
+        ss << "Feature extraction pipeline timing (" << std::fixed << std::setprecision(2) << wallTime << " s):";
+        for (int stage = 0; stage < NB_STAGES; ++stage)
+        {
+            if (_counts[stage] == 0)
+                continue;
+            ss << std::endl
+               << "\t- " << std::left << std::setw(16) << names[stage] << std::right << std::setw(10) << _seconds[stage] << " s for "
+               << _counts[stage] << " tasks (" << _seconds[stage] / double(_counts[stage]) << " s per task)";
+        }
+        ALICEVISION_LOG_INFO(ss.str());
+    }
+
+  private:
+    std::array<double, NB_STAGES> _seconds{};
+    std::array<std::size_t, NB_STAGES> _counts{};
+    mutable std::mutex _mutex;
+};
+
+}  // namespace
+
+/**
+ * The memory reserved for the view job is released when the images are no longer used.
+ */
+struct FeatureExtractor::ViewImages
+{
+    ViewImages(MemoryBudget& budget, std::size_t memory)
+      : _budget(budget),
+        _memory(memory)
+    {}
+
+    ~ViewImages() { _budget.release(_memory); }
+
+    image::Image<float> imageGrayFloat;
+    image::Image<unsigned char> imageGrayUChar;
+    image::Image<unsigned char> mask;
+    double pixelRatio = 1.0;
+
+  private:
+    MemoryBudget& _budget;
+    const std::size_t _memory;
+};
+
 FeatureExtractorViewJob::FeatureExtractorViewJob(const sfmData::View& view, const std::string& outputFolder)
   : _view(view),
     _outputBasename(fs::path(fs::path(outputFolder) / fs::path(std::to_string(view.getViewId()))).string())
@@ -68,9 +259,10 @@ void FeatureExtractor::process(const HardwareContext& hContext, const image::EIm
     }
 
     std::size_t jobMaxMemoryConsuption = 0;
+    std::size_t nbCpuJobs = 0;
+    std::size_t nbGpuJobs = 0;
 
-    std::vector<FeatureExtractorViewJob> cpuJobs;
-    std::vector<FeatureExtractorViewJob> gpuJobs;
+    std::vector<FeatureExtractorViewJob> jobs;
 
     for (auto it = itViewBegin; it != itViewEnd; ++it)
     {
@@ -81,93 +273,231 @@ void FeatureExtractor::process(const HardwareContext& hContext, const image::EIm
         jobMaxMemoryConsuption = std::max(jobMaxMemoryConsuption, viewJob.memoryConsuption());
 
         if (viewJob.useCPU())
-            cpuJobs.push_back(viewJob);
+            ++nbCpuJobs;
 
         if (viewJob.useGPU())
-            gpuJobs.push_back(viewJob);
+            ++nbGpuJobs;
+
+        if (viewJob.useCPU() || viewJob.useGPU())
+            jobs.push_back(viewJob);
+    }
+
+    if (jobs.empty())
+        return;
+
+    system::MemoryInfo memoryInformation = system::getMemoryInfo();
+
+    // Put an upper bound with user specified memory
+    size_t maxMemory = std::min(memoryInformation.availableRam, maxAvailableMemory);
+    size_t maxTotalMemory = std::min(memoryInformation.totalRam, maxAvailableMemory);
+
+    ALICEVISION_LOG_INFO("Job max memory consumption for one image: " << jobMaxMemoryConsuption / (1024 * 1024) << " MB");
+    ALICEVISION_LOG_INFO("Memory information: " << std::endl << memoryInformation);
+
+    if (nbCpuJobs > 0 && jobMaxMemoryConsuption == 0)
+        throw std::runtime_error("Cannot compute feature extraction job max memory consumption.");
+
+    const double oneGB = 1024.0 * 1024.0 * 1024.0;
+    if (jobMaxMemoryConsuption > maxMemory)
+    {
+        ALICEVISION_LOG_WARNING("The amount of RAM available is critical to extract features.");
+        if (jobMaxMemoryConsuption <= maxTotalMemory)
+        {
+            ALICEVISION_LOG_WARNING("But the total amount of RAM is enough to extract features, "
+                                    << "so you should close other running applications.");
+            ALICEVISION_LOG_WARNING(" => " << std::size_t(std::round((double(maxTotalMemory - maxMemory) / oneGB)))
+                                           << " GB are used by other applications for a total RAM capacity of "
+                                           << std::size_t(std::round(double(maxTotalMemory) / oneGB)) << " GB.");
+        }
+    }
+    else
+    {
+        if (maxMemory < 0.5 * maxTotalMemory)
+        {
+            ALICEVISION_LOG_WARNING("More than half of the RAM is used by other applications. It would be more efficient to close them.");
+            ALICEVISION_LOG_WARNING(" => " << std::size_t(std::round(double(maxTotalMemory - maxMemory) / oneGB))
+                                           << " GB are used by other applications for a total RAM capacity of "
+                                           << std::size_t(std::round(double(maxTotalMemory) / oneGB)) << " GB.");
+        }
     }
 
-    if (!cpuJobs.empty())
+    if (maxMemory == 0)
     {
-        system::MemoryInfo memoryInformation = system::getMemoryInfo();
+        ALICEVISION_LOG_WARNING("Cannot find available system memory, this can be due to OS limitation.\n"
+                                "Extract the features of only one image at a time.");
+    }
 
-        // Put an upper bound with user specified memory
-        size_t maxMemory = std::min(memoryInformation.availableRam, maxAvailableMemory);
-        size_t maxTotalMemory = std::min(memoryInformation.totalRam, maxAvailableMemory);
+    // Jobs are admitted while their memory consumption fits in 90% of the available RAM.
+    // This is used to run as many jobs as possible in parallel without SWAP.
+    MemoryBudget memoryBudget(std::size_t(0.9 * maxMemory));
 
-        ALICEVISION_LOG_INFO("Job max memory consumption for one image: " << jobMaxMemoryConsuption / (1024 * 1024) << " MB");
-        ALICEVISION_LOG_INFO("Memory information: " << std::endl << memoryInformation);
+    // CPU workers should not be more than the available cores nor the number of jobs,
+    // the GPU jobs are computed by one dedicated worker
+    const std::size_t nbCpuThreads = std::min(static_cast<std::size_t>(std::max(1u, maxAvailableCores)), nbCpuJobs);
+    const std::size_t nbGpuThreads = (nbGpuJobs > 0) ? 1 : 0;
+    // decoding is mostly sequential, a few loaders are enough to feed the workers
+    const std::size_t nbDecodeThreads = std::min(jobs.size(), std::max(std::size_t(1), std::min(std::size_t(4), nbCpuThreads / 4)));
 
-        if (jobMaxMemoryConsuption == 0)
-            throw std::runtime_error("Cannot compute feature extraction job max memory consumption.");
+    ALICEVISION_LOG_INFO("Memory budget for extraction: " << memoryBudget.capacity() / (1024 * 1024) << " MB");
+    ALICEVISION_LOG_INFO("# threads for extraction: " << nbCpuThreads << " [cpu], " << nbGpuThreads << " [gpu], " << nbDecodeThreads
+                                                      << " [decode], 1 [write]");
 
-        // How many buffers can fit in 90% of the available RAM?
-        // This is used to estimate how many jobs can be computed in parallel without SWAP.
-        const std::size_t memoryImageCapacity = std::size_t((0.9 * maxMemory) / jobMaxMemoryConsuption);
+    struct DescribeTask
+    {
+        const FeatureExtractorViewJob* job = nullptr;
+        std::shared_ptr<const ViewImages> images;
+    };
 
-        std::size_t nbThreads = std::max(std::size_t(1), memoryImageCapacity);
-        ALICEVISION_LOG_INFO("Max number of threads regarding memory usage: " << nbThreads);
-        const double oneGB = 1024.0 * 1024.0 * 1024.0;
-        if (jobMaxMemoryConsuption > maxMemory)
+    struct WriteTask
+    {
+        const FeatureExtractorViewJob* job = nullptr;
+        std::size_t imageDescriberIndex = 0;
+        std::unique_ptr<feature::Regions> regions;
+    };
+
+    WorkQueue<DescribeTask> cpuQueue;
+    WorkQueue<DescribeTask> gpuQueue;
+    WorkQueue<WriteTask> writeQueue;
+    StageTimings timings;
+
+    // the first error cancels the pipeline and is rethrown at the end
+    std::atomic<bool> canceled(false);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    const auto cancel = [&](std::exception_ptr e) {
         {
-            ALICEVISION_LOG_WARNING("The amount of RAM available is critical to extract features.");
-            if (jobMaxMemoryConsuption <= maxTotalMemory)
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error)
+                error = e;
+        }
+        canceled = true;
+        memoryBudget.cancel();
+    };
+
+    std::atomic<std::size_t> nextJob(0);
+    std::atomic<std::size_t> nbRunningDecoders(nbDecodeThreads);
+    std::atomic<std::size_t> nbRunningWorkers(nbCpuThreads + nbGpuThreads);
+
+    const auto decode = [&]() {
+        for (std::size_t i = nextJob++; i < jobs.size() && !canceled; i = nextJob++)
+        {
+            const FeatureExtractorViewJob& job = jobs.at(i);
+
+            if (!memoryBudget.acquire(job.memoryConsuption()))
+                break;
+
+            try
+            {
+                // memory is released when the last worker drops the images
+                auto images = std::make_shared<ViewImages>(memoryBudget, job.memoryConsuption());
+
+                system::Timer timer;
+                loadViewImages(job, workingColorSpace, *images);
+                timings.add(StageTimings::DECODE, timer.elapsed());
+
+                if (job.useCPU())
+                    cpuQueue.push({&job, images});
+                if (job.useGPU())
+                    gpuQueue.push({&job, images});
+            }
+            catch (...)
             {
-                ALICEVISION_LOG_WARNING("But the total amount of RAM is enough to extract features, "
-                                        << "so you should close other running applications.");
-                ALICEVISION_LOG_WARNING(" => " << std::size_t(std::round((double(maxTotalMemory - maxMemory) / oneGB)))
-                                               << " GB are used by other applications for a total RAM capacity of "
-                                               << std::size_t(std::round(double(maxTotalMemory) / oneGB)) << " GB.");
+                cancel(std::current_exception());
             }
         }
-        else
+
+        if (--nbRunningDecoders == 0)
+        {
+            cpuQueue.close();
+            gpuQueue.close();
+        }
+    };
+
+    const auto describe = [&](WorkQueue<DescribeTask>& queue, bool useGPU) {
+        DescribeTask task;
+        while (queue.pop(task))
         {
-            if (maxMemory < 0.5 * maxTotalMemory)
+            for (const std::size_t imageDescriberIndex : task.job->imageDescriberIndexes(useGPU))
             {
-                ALICEVISION_LOG_WARNING("More than half of the RAM is used by other applications. It would be more efficient to close them.");
-                ALICEVISION_LOG_WARNING(" => " << std::size_t(std::round(double(maxTotalMemory - maxMemory) / oneGB))
-                                               << " GB are used by other applications for a total RAM capacity of "
-                                               << std::size_t(std::round(double(maxTotalMemory) / oneGB)) << " GB.");
+                if (canceled)
+                    break;
+
+                try
+                {
+                    system::Timer timer;
+                    std::unique_ptr<feature::Regions> regions = computeViewJob(*task.job, *task.images, imageDescriberIndex, useGPU);
+                    timings.add(useGPU ? StageTimings::DESCRIBE_GPU : StageTimings::DESCRIBE_CPU, timer.elapsed());
+
+                    writeQueue.push({task.job, imageDescriberIndex, std::move(regions)});
+                }
+                catch (...)
+                {
+                    cancel(std::current_exception());
+                }
             }
+            task.images.reset();
         }
 
-        if (maxMemory == 0)
+        if (--nbRunningWorkers == 0)
+            writeQueue.close();
+    };
+
+    const auto write = [&]() {
+        WriteTask task;
+        while (writeQueue.pop(task))
         {
-            ALICEVISION_LOG_WARNING("Cannot find available system memory, this can be due to OS limitation.\n"
-                                    "Use only one thread for CPU feature extraction.");
-            nbThreads = 1;
+            if (canceled)
+                continue;
+
+            try
+            {
+                const auto& imageDescriber = _imageDescribers.at(task.imageDescriberIndex);
+                const feature::EImageDescriberType imageDescriberType = imageDescriber->getDescriberType();
+
+                system::Timer timer;
+                imageDescriber->Save(
+                  task.regions.get(), task.job->getFeaturesPath(imageDescriberType), task.job->getDescriptorPath(imageDescriberType));
+                timings.add(StageTimings::WRITE, timer.elapsed());
+
+                ALICEVISION_LOG_INFO(std::left << std::setw(6) << " " << task.regions->RegionCount() << " "
+                                               << feature::EImageDescriberType_enumToString(imageDescriberType) << " features extracted from view '"
+                                               << task.job->view().getImage().getImagePath() << "'");
+            }
+            catch (...)
+            {
+                cancel(std::current_exception());
+            }
         }
+    };
 
-        // nbThreads should not be higher than the available cores
-        nbThreads = std::min(static_cast<std::size_t>(maxAvailableCores), nbThreads);
+    system::Timer pipelineTimer;
 
-        // nbThreads should not be higher than the number of jobs
-        nbThreads = std::min(cpuJobs.size(), nbThreads);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < nbDecodeThreads; ++i)
+        threads.emplace_back(decode);
+    for (std::size_t i = 0; i < nbCpuThreads; ++i)
+        threads.emplace_back(describe, std::ref(cpuQueue), false);
+    for (std::size_t i = 0; i < nbGpuThreads; ++i)
+        threads.emplace_back(describe, std::ref(gpuQueue), true);
+    threads.emplace_back(write);
 
-        ALICEVISION_LOG_INFO("# threads for extraction: " << nbThreads);
-        omp_set_nested(1);
+    for (auto& thread : threads)
+        thread.join();
 
-#pragma omp parallel for num_threads(nbThreads)
-        for (int i = 0; i < cpuJobs.size(); ++i)
-            computeViewJob(cpuJobs.at(i), false, workingColorSpace);
-    }
+    if (error)
+        std::rethrow_exception(error);
 
-    if (!gpuJobs.empty())
-    {
-        for (const auto& job : gpuJobs)
-            computeViewJob(job, true, workingColorSpace);
-    }
+    timings.log(pipelineTimer.elapsed());
+    ALICEVISION_LOG_INFO("Peak memory reserved by the extraction jobs: " << memoryBudget.peak() / (1024 * 1024) << " MB");
 }
 
-void FeatureExtractor::computeViewJob(const FeatureExtractorViewJob& job, bool useGPU, const image::EImageColorSpace workingColorSpace)
+void FeatureExtractor::loadViewImages(const FeatureExtractorViewJob& job, const image::EImageColorSpace workingColorSpace, ViewImages& images) const
 {
-    image::Image<float> imageGrayFloat;
-    image::Image<unsigned char> imageGrayUChar;
-    image::Image<unsigned char> mask;
+    image::Image<float>& imageGrayFloat = images.imageGrayFloat;
 
     image::readImage(job.view().getImage().getImagePath(), imageGrayFloat, workingColorSpace);
 
-    double pixelRatio = 1.0;
+    double& pixelRatio = images.pixelRatio;
     job.view().getImage().getDoubleMetadata({"PixelAspectRatio"}, pixelRatio);
 
     if (pixelRatio != 1.0)
@@ -192,80 +522,93 @@ void FeatureExtractor::computeViewJob(const FeatureExtractorViewJob& job, bool u
 
         if (fs::exists(idMaskPath))
         {
-            image::readImage(idMaskPath.string(), mask, image::EImageColorSpace::LINEAR);
+            image::readImage(idMaskPath.string(), images.mask, image::EImageColorSpace::LINEAR);
         }
         else if (fs::exists(nameMaskPath))
         {
-            image::readImage(nameMaskPath.string(), mask, image::EImageColorSpace::LINEAR);
+            image::readImage(nameMaskPath.string(), images.mask, image::EImageColorSpace::LINEAR);
         }
     }
 
-    for (const auto& imageDescriberIndex : job.imageDescriberIndexes(useGPU))
+    // the CPU and GPU workers may use the images concurrently:
+    // convert the float buffer to uchar now if an image describer can't use the float image
+    for (const bool useGPU : {false, true})
     {
-        const auto& imageDescriber = _imageDescribers.at(imageDescriberIndex);
-        const feature::EImageDescriberType imageDescriberType = imageDescriber->getDescriberType();
-        const std::string imageDescriberTypeName = feature::EImageDescriberType_enumToString(imageDescriberType);
-
-        // Compute features and descriptors and export them to files
-        ALICEVISION_LOG_INFO("Extracting " << imageDescriberTypeName << " features from view '" << job.view().getImage().getImagePath() << "' "
-                                           << (useGPU ? "[gpu]" : "[cpu]"));
-
-        std::unique_ptr<feature::Regions> regions;
-        if (imageDescriber->useFloatImage())
-        {
-            // image buffer use float image, use the read buffer
-            imageDescriber->describe(imageGrayFloat, regions);
-        }
-        else
+        for (const auto& imageDescriberIndex : job.imageDescriberIndexes(useGPU))
         {
-            // image buffer can't use float image
-            if (imageGrayUChar.Width() == 0)  // the first time, convert the float buffer to uchar
-                imageGrayUChar = (imageGrayFloat.GetMat() * 255.f).cast<unsigned char>();
-            imageDescriber->describe(imageGrayUChar, regions);
+            if (!_imageDescribers.at(imageDescriberIndex)->useFloatImage() && images.imageGrayUChar.Width() == 0)
+                images.imageGrayUChar = (imageGrayFloat.GetMat() * 255.f).cast<unsigned char>();
         }
+    }
+}
+
+std::unique_ptr<feature::Regions> FeatureExtractor::computeViewJob(const FeatureExtractorViewJob& job,
+                                                                   const ViewImages& images,
+                                                                   std::size_t imageDescriberIndex,
+                                                                   bool useGPU) const
+{
+    const double pixelRatio = images.pixelRatio;
+    const image::Image<unsigned char>& mask = images.mask;
 
-        if (pixelRatio != 1.0)
+    const auto& imageDescriber = _imageDescribers.at(imageDescriberIndex);
+    const feature::EImageDescriberType imageDescriberType = imageDescriber->getDescriberType();
+    const std::string imageDescriberTypeName = feature::EImageDescriberType_enumToString(imageDescriberType);
+
+    // Compute features and descriptors
+    ALICEVISION_LOG_INFO("Extracting " << imageDescriberTypeName << " features from view '" << job.view().getImage().getImagePath() << "' "
+                                       << (useGPU ? "[gpu]" : "[cpu]"));
+
+    std::unique_ptr<feature::Regions> regions;
+    if (imageDescriber->useFloatImage())
+    {
+        // image buffer use float image, use the read buffer
+        imageDescriber->describe(images.imageGrayFloat, regions);
+    }
+    else
+    {
+        // image buffer can't use float image, use the converted buffer
+        imageDescriber->describe(images.imageGrayUChar, regions);
+    }
+
+    if (pixelRatio != 1.0)
+    {
+        // Re-position point features on input image
+        for (auto& feat : regions->Features())
         {
-            // Re-position point features on input image
-            for (auto& feat : regions->Features())
-            {
-                feat.x() /= pixelRatio;
-            }
+            feat.x() /= pixelRatio;
         }
+    }
 
-        if (mask.Height() > 0)
+    if (mask.Height() > 0)
+    {
+        std::vector<feature::FeatureInImage> selectedIndices;
+        for (size_t i = 0, n = regions->RegionCount(); i != n; ++i)
         {
-            std::vector<feature::FeatureInImage> selectedIndices;
-            for (size_t i = 0, n = regions->RegionCount(); i != n; ++i)
-            {
-                const Vec2 position = regions->GetRegionPosition(i);
-                const int x = int(position.x());
-                const int y = int(position.y());
-
-                bool masked = false;
-                if (x < mask.Width() && y < mask.Height())
-                {
-                    if ((mask(y, x) == 0 && !_maskInvert) || (mask(y, x) != 0 && _maskInvert))
-                    {
-                        masked = true;
-                    }
-                }
+            const Vec2 position = regions->GetRegionPosition(i);
+            const int x = int(position.x());
+            const int y = int(position.y());
 
-                if (!masked)
+            bool masked = false;
+            if (x < mask.Width() && y < mask.Height())
+            {
+                if ((mask(y, x) == 0 && !_maskInvert) || (mask(y, x) != 0 && _maskInvert))
                 {
-                    selectedIndices.push_back({IndexT(i), 0});
+                    masked = true;
                 }
             }
 
-            std::vector<IndexT> out_associated3dPoint;
-            std::map<IndexT, IndexT> out_mapFullToLocal;
-            regions = regions->createFilteredRegions(selectedIndices, out_associated3dPoint, out_mapFullToLocal);
+            if (!masked)
+            {
+                selectedIndices.push_back({IndexT(i), 0});
+            }
         }
 
-        imageDescriber->Save(regions.get(), job.getFeaturesPath(imageDescriberType), job.getDescriptorPath(imageDescriberType));
-        ALICEVISION_LOG_INFO(std::left << std::setw(6) << " " << regions->RegionCount() << " " << imageDescriberTypeName
-                                       << " features extracted from view '" << job.view().getImage().getImagePath() << "'");
+        std::vector<IndexT> out_associated3dPoint;
+        std::map<IndexT, IndexT> out_mapFullToLocal;
+        regions = regions->createFilteredRegions(selectedIndices, out_associated3dPoint, out_mapFullToLocal);
     }
+
+    return regions;
 }
 
 }  // namespace featureEngine
@@ -8,6 +8,11 @@
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmData/View.hpp>
 #include <aliceVision/system/hardwareContext.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace aliceVision {
 namespace featureEngine {
 
@@ -74,12 +79,31 @@ class FeatureExtractor
 
     void addImageDescriber(std::shared_ptr<feature::ImageDescriber>& imageDescriber) { _imageDescribers.push_back(imageDescriber); }
 
+    /**
+     * @brief Extract the features of all the views of the range.
+     *
+     * The extraction is pipelined: images are decoded ahead by loader threads, described by the CPU
+     * and GPU workers concurrently, and the results are written asynchronously.
+     * A view is only decoded when its memory consumption fits in the remaining memory budget.
+     */
     void process(const HardwareContext& hcontext, const image::EImageColorSpace workingColorSpace = image::EImageColorSpace::SRGB);
 
   private:
-    void computeViewJob(const FeatureExtractorViewJob& job,
-                        bool useGPU,
-                        const image::EImageColorSpace workingColorSpace = image::EImageColorSpace::SRGB);
+    /// decoded images of a view, shared by the CPU and GPU workers
+    struct ViewImages;
+
+    /**
+     * @brief Read the image (and the mask) of a view job.
+     */
+    void loadViewImages(const FeatureExtractorViewJob& job, const image::EImageColorSpace workingColorSpace, ViewImages& images) const;
+
+    /**
+     * @brief Compute the regions of a view with one image describer.
+     */
+    std::unique_ptr<feature::Regions> computeViewJob(const FeatureExtractorViewJob& job,
+                                                     const ViewImages& images,
+                                                     std::size_t imageDescriberIndex,
+                                                     bool useGPU) const;
 
     const sfmData::SfMData& _sfmData;
     std::vector<std::shared_ptr<feature::ImageDescriber>> _imageDescribers;
@@ -7,9 +7,13 @@
 #include "ImageMatching.hpp"
 #include <aliceVision/voctree/databaseIO.hpp>
 
+#include <boost/filesystem.hpp>
+
 namespace aliceVision {
 namespace imageMatching {
 
+namespace fs = boost::filesystem;
+
 std::ostream& operator<<(std::ostream& os, const PairList& pl)
 {
     for (PairList::const_iterator plIter = pl.begin(); plIter != pl.end(); ++plIter)
@@ -255,41 +259,52 @@ void generateFromVoctree(PairList& allMatches,
             allMatches[descriptorPair.first] = {};
     }
 
-    // query each document
-#pragma omp parallel for
-    for (ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(descriptorsFiles.size()); ++i)
+    // query the documents by batches, to bound the memory used by the histograms of mode A_B
+    const std::size_t batchSize = 1024;
+    std::vector<IndexT> viewIds;
+    std::vector<std::string> featuresPaths;
+    for (const auto& descriptorPair : descriptorsFiles)
     {
-        auto itA = descriptorsFiles.cbegin();
-        std::advance(itA, i);
-        const IndexT viewIdA = itA->first;
-        const std::string featuresPathA = itA->second;
+        viewIds.push_back(descriptorPair.first);
+        featuresPaths.push_back(descriptorPair.second);
+    }
 
-        aliceVision::voctree::SparseHistogram imageSH;
+    std::vector<aliceVision::voctree::DocMatches> batchMatches;
+    for (std::size_t firstView = 0; firstView < viewIds.size(); firstView += batchSize)
+    {
+        const std::size_t lastView = std::min(firstView + batchSize, viewIds.size());
 
         if (modeMultiSfM != EImageMatchingMode::A_B)
         {
-            // sparse histogram of A is already computed in the DB
-            imageSH = db.getSparseHistogramPerImage().at(viewIdA);
+            // sparse histograms of A are already in the DB
+            const std::vector<IndexT> batchViewIds(viewIds.begin() + firstView, viewIds.begin() + lastView);
+            db.findBatch(batchViewIds, numImageQuery, batchMatches);
         }
         else  // mode AB
         {
             // compute the sparse histogram of each image A
-            std::vector<DescriptorUChar> descriptors;
-            // read the descriptors
-            loadDescsFromBinFile(featuresPathA, descriptors, false, nbMaxDescriptors);
-            imageSH = tree.quantizeToSparse(descriptors);
+            std::vector<aliceVision::voctree::SparseHistogram> imagesSH(lastView - firstView);
+#pragma omp parallel for
+            for (ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(imagesSH.size()); ++i)
+            {
+                std::vector<DescriptorUChar> descriptors;
+                // read the descriptors
+                loadDescsFromBinFile(featuresPaths[firstView + i], descriptors, false, nbMaxDescriptors);
+                imagesSH[i] = tree.quantizeToSparse(descriptors);
+            }
+            db.findBatch(imagesSH, numImageQuery, batchMatches);
         }
 
-        std::vector<aliceVision::voctree::DocMatch> matches;
-
-        db.find(imageSH, numImageQuery, matches);
-
-        ListOfImageID& imgMatches = allMatches.at(viewIdA);
-        imgMatches.reserve(imgMatches.size() + matches.size());
-
-        for (const aliceVision::voctree::DocMatch& m : matches)
+        for (std::size_t i = firstView; i < lastView; ++i)
         {
-            imgMatches.push_back(m.id);
+            ListOfImageID& imgMatches = allMatches.at(viewIds[i]);
+            const aliceVision::voctree::DocMatches& matches = batchMatches[i - firstView];
+            imgMatches.reserve(imgMatches.size() + matches.size());
+
+            for (const aliceVision::voctree::DocMatch& m : matches)
+            {
+                imgMatches.push_back(m.id);
+            }
         }
     }
 }
@@ -307,7 +322,8 @@ void conditionVocTree(const std::string& treeName,
                       bool useMultiSfM,
                       const std::map<IndexT, std::string>& descriptorsFilesA,
                       std::size_t numImageQuery,
-                      OrderedPairList& selectedPairs)
+                      OrderedPairList& selectedPairs,
+                      const std::string& databaseFilepath)
 {
     if (treeName.empty())
     {
@@ -348,6 +364,37 @@ void conditionVocTree(const std::string& treeName,
     if (matchingMode == EImageMatchingMode::A_A_AND_A_B)
         db2 = db;  // initialize database2 with database1 initialization
 
+    // load the documents of a previous run, only the new images are quantized
+    const bool useDatabaseFile = !databaseFilepath.empty();
+    std::size_t nbLoadedDocuments = 0;
+    if (useDatabaseFile && fs::exists(databaseFilepath))
+    {
+        ALICEVISION_LOG_INFO("Loading the database: " << databaseFilepath);
+        db.load(databaseFilepath);
+        if (db.words() != tree.words())
+            throw std::runtime_error("The database '" + databaseFilepath + "' does not match the vocabulary tree.");
+        if (withWeights)
+            db.loadWeights(weightsName);
+
+        std::set<IndexT> viewIds = sfmDataA.getViewsKeys();
+        if (matchingMode == EImageMatchingMode::A_AB || matchingMode == EImageMatchingMode::A_B)
+        {
+            const std::set<IndexT> viewIdsB = sfmDataB.getViewsKeys();
+            viewIds.insert(viewIdsB.begin(), viewIdsB.end());
+        }
+        for (const auto& document : descriptorsFilesA)
+            viewIds.insert(document.first);
+
+        nbLoadedDocuments = db.size();
+        std::size_t nbUnknownDocuments = 0;
+        for (const auto& document : db.getDocumentIds())
+            nbUnknownDocuments += viewIds.count(document) == 0;
+        if (nbUnknownDocuments > 0)
+            throw std::runtime_error("The database '" + databaseFilepath + "' contains " + std::to_string(nbUnknownDocuments) +
+                                     " images which are not in the input SfMData.");
+        ALICEVISION_LOG_INFO(nbLoadedDocuments << " images loaded from the database");
+    }
+
     // read the descriptors and populate the databases
     {
         std::stringstream ss;
@@ -367,9 +414,9 @@ void conditionVocTree(const std::string& treeName,
                 (matchingMode == EImageMatchingMode::A_A))
             {
                 nbFeaturesLoadedInputA = voctree::populateDatabase<DescriptorUChar>(sfmDataA, featuresFolders, tree, db, nbMaxDescriptors);
-                nbSetDescriptors = db.getSparseHistogramPerImage().size();
+                nbSetDescriptors = db.size();
 
-                if (nbFeaturesLoadedInputA == 0)
+                if (nbFeaturesLoadedInputA == 0 && nbLoadedDocuments == 0)
                 {
                     throw std::runtime_error("No descriptors loaded in '" + sfmDataFilenameA + "'");
                 }
@@ -378,16 +425,16 @@ void conditionVocTree(const std::string& treeName,
             if ((matchingMode == EImageMatchingMode::A_AB) || (matchingMode == EImageMatchingMode::A_B))
             {
                 nbFeaturesLoadedInputB = voctree::populateDatabase<DescriptorUChar>(sfmDataB, featuresFolders, tree, db, nbMaxDescriptors);
-                nbSetDescriptors = db.getSparseHistogramPerImage().size();
+                nbSetDescriptors = db.size();
             }
 
             if (matchingMode == EImageMatchingMode::A_A_AND_A_B)
             {
                 nbFeaturesLoadedInputB = voctree::populateDatabase<DescriptorUChar>(sfmDataB, featuresFolders, tree, db2, nbMaxDescriptors);
-                nbSetDescriptors += db2.getSparseHistogramPerImage().size();
+                nbSetDescriptors += db2.size();
             }
 
-            if (useMultiSfM && (nbFeaturesLoadedInputB == 0))
+            if (useMultiSfM && (nbFeaturesLoadedInputB == 0) && (nbLoadedDocuments == 0))
             {
                 throw std::runtime_error("No descriptors loaded in '" + sfmDataFilenameB + "'");
             }
@@ -399,6 +446,12 @@ void conditionVocTree(const std::string& treeName,
         ALICEVISION_LOG_INFO("Reading took " << detect_elapsed.count() << " sec.");
     }
 
+    if (useDatabaseFile && db.size() != nbLoadedDocuments)
+    {
+        ALICEVISION_LOG_INFO("Saving the database: " << databaseFilepath);
+        db.save(databaseFilepath);
+    }
+
     if (!withWeights)
     {
         // compute and save the word weights
@@ -110,7 +110,9 @@ bool CCTagLocalizer::loadReconstructionDescriptors(const sfmData::SfMData& sfm_d
             if (observations.count(descType) == 0)
             {
                 // no descriptor of this type reconstructed in this View
-                _imageDescriber.allocate(_regionsPerView.getData()[id_view][descType]);
+                std::unique_ptr<feature::Regions> emptyRegions;
+                _imageDescriber.allocate(emptyRegions);
+                _regionsPerView.getData()[id_view][descType] = std::move(emptyRegions);
                 continue;
             }
 
@@ -214,7 +216,9 @@ bool CCTagLocalizer::localize(const image::Image<float>& imageGrey,
 
     _imageDescriber.setCudaPipe(_cudaPipe);
     _imageDescriber.setConfigurationPreset(param->_featurePreset);
-    _imageDescriber.describe(imageGrayUChar, tmpQueryRegions[_cctagDescType]);
+    std::unique_ptr<feature::Regions> queryRegions;
+    _imageDescriber.describe(imageGrayUChar, queryRegions);
+    tmpQueryRegions[_cctagDescType] = std::move(queryRegions);
     ALICEVISION_LOG_DEBUG("[features]\tExtract CCTAG done: found " << tmpQueryRegions.at(_cctagDescType)->RegionCount() << " features");
 
     std::pair<std::size_t, std::size_t> imageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
@@ -397,7 +401,9 @@ bool CCTagLocalizer::localizeRig(const std::vector<image::Image<float>>& vec_ima
         // extract descriptors and features from each image
         ALICEVISION_LOG_DEBUG("[features]\tExtract CCTag from query image...");
         _imageDescriber.setConfigurationPreset(param->_featurePreset);
-        _imageDescriber.describe(imageGrayUChar, vec_queryRegions[i][_imageDescriber.getDescriberType()]);
+        std::unique_ptr<feature::Regions> queryRegions;
+        _imageDescriber.describe(imageGrayUChar, queryRegions);
+        vec_queryRegions[i][_imageDescriber.getDescriberType()] = std::move(queryRegions);
         ALICEVISION_LOG_DEBUG("[features]\tExtract CCTAG done: found " << vec_queryRegions[i].at(_imageDescriber.getDescriberType())->RegionCount()
                                                                        << " features");
         // add the image size for this image
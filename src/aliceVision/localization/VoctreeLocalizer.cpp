@@ -117,7 +117,8 @@ VoctreeLocalizer::VoctreeLocalizer(const sfmData::SfMData& sfmData,
                                    const std::string& descriptorsFolder,
                                    const std::string& vocTreeFilepath,
                                    const std::string& weightsFilepath,
-                                   const std::vector<feature::EImageDescriberType>& matchingDescTypes)
+                                   const std::vector<feature::EImageDescriberType>& matchingDescTypes,
+                                   std::size_t regionsCacheSize)
   : ILocalizer(),
     _frameBuffer(5)
 {
@@ -137,7 +138,7 @@ VoctreeLocalizer::VoctreeLocalizer(const sfmData::SfMData& sfmData,
     // then we can store only those associated to 3D points
     //? can we use Feature_Provider to load the features and filter them later?
 
-    _isInit = initDatabase(vocTreeFilepath, weightsFilepath, descriptorsFolder);
+    _isInit = initDatabase(vocTreeFilepath, weightsFilepath, descriptorsFolder, regionsCacheSize);
 }
 
 bool VoctreeLocalizer::localize(const feature::MapRegionsPerDesc& queryRegions,
@@ -190,8 +191,7 @@ bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
     for (const auto& imageDescriber : _imageDescribers)
     {
         const auto descType = imageDescriber->getDescriberType();
-        auto& queryRegions = queryRegionsPerDesc[descType];
-
+        std::unique_ptr<feature::Regions> queryRegions;
         imageDescriber->allocate(queryRegions);
 
         system::Timer timer;
@@ -212,6 +212,8 @@ bool VoctreeLocalizer::localize(const image::Image<float>& imageGrey,
 
         ALICEVISION_LOG_DEBUG("[features]\tExtract " << feature::EImageDescriberType_enumToString(descType) << " done: found "
                                                      << queryRegions->RegionCount() << " features in " << timer.elapsedMs() << " [ms]");
+
+        queryRegionsPerDesc[descType] = std::move(queryRegions);
     }
 
     const std::pair<std::size_t, std::size_t> queryImageSize = std::make_pair(imageGrey.Width(), imageGrey.Height());
@@ -247,7 +249,10 @@ bool VoctreeLocalizer::loadReconstructionDescriptors(const sfmData::SfMData& sfm
  * @brief Initialize the database: load features & descriptors for reconstructed landmarks,
  *        and create voctree image desc.
  */
-bool VoctreeLocalizer::initDatabase(const std::string& vocTreeFilepath, const std::string& weightsFilepath, const std::string& featFolder)
+bool VoctreeLocalizer::initDatabase(const std::string& vocTreeFilepath,
+                                    const std::string& weightsFilepath,
+                                    const std::string& featFolder,
+                                    std::size_t regionsCacheSize)
 {
     bool withWeights = !weightsFilepath.empty();
 
@@ -280,7 +285,8 @@ bool VoctreeLocalizer::initDatabase(const std::string& vocTreeFilepath, const st
       system::createConsoleProgressDisplay(_sfm_data.getViews().size(), std::cout, "\n- Load Features and Descriptors per view -\n");
 
     // Build observations per view
-    std::map<IndexT, std::map<feature::EImageDescriberType, std::vector<feature::FeatureInImage>>> observationsPerView;
+    auto observationsPerViewPtr = std::make_shared<std::map<IndexT, std::map<feature::EImageDescriberType, std::vector<feature::FeatureInImage>>>>();
+    auto& observationsPerView = *observationsPerViewPtr;
     for (const auto& landmarkValue : _sfm_data.getLandmarks())
     {
         IndexT trackId = landmarkValue.first;
@@ -305,6 +311,31 @@ bool VoctreeLocalizer::initDatabase(const std::string& vocTreeFilepath, const st
     if (!featFolder.empty())
         featuresFolders.emplace_back(featFolder);
 
+    // the reconstructed regions released by the cache are loaded and filtered again on demand
+    // the containers stay mapped as long as the regions cache
+    auto containersCache = std::make_shared<sfm::RegionsContainersCache>();
+
+    const auto loadReconstructedRegions = [this, featuresFolders, observationsPerViewPtr, containersCache](IndexT viewId) {
+        feature::MapRegionsPerDesc regionsPerDesc;
+        const auto& observations = observationsPerViewPtr->at(viewId);
+        for (const auto& imageDescriber : _imageDescribers)
+        {
+            const feature::EImageDescriberType descType = imageDescriber->getDescriberType();
+            if (observations.count(descType) == 0)
+            {
+                std::unique_ptr<feature::Regions> emptyRegions;
+                imageDescriber->allocate(emptyRegions);
+                regionsPerDesc[descType] = std::move(emptyRegions);
+                continue;
+            }
+            std::unique_ptr<feature::Regions> currRegions = sfm::loadRegions(featuresFolders, viewId, *imageDescriber, containersCache.get());
+            ReconstructedRegionsMapping mapping;
+            regionsPerDesc[descType] = createFilteredRegions(*currRegions, observations.at(descType), mapping);
+        }
+        return regionsPerDesc;
+    };
+    _regionsCache = std::make_unique<feature::RegionsCache>(loadReconstructedRegions, regionsCacheSize);
+
         // Read for each view the corresponding Regions and store them
 #pragma omp parallel for num_threads(3)
     for (int i = 0; i < _sfm_data.getViews().size(); ++i)
@@ -315,6 +346,7 @@ bool VoctreeLocalizer::initDatabase(const std::string& vocTreeFilepath, const st
         if (observationsPerView.count(id_view) == 0)
             continue;
         const auto& observations = observationsPerView.at(id_view);
+        feature::MapRegionsPerDesc regionsPerDesc;
         for (const auto& imageDescriber : _imageDescribers)
         {
             const feature::EImageDescriberType descType = imageDescriber->getDescriberType();
@@ -331,8 +363,10 @@ bool VoctreeLocalizer::initDatabase(const std::string& vocTreeFilepath, const st
                     // so you have a data structure with 0 element and you don't need to add
                     // special cases everywhere for empty elements.
                     _reconstructedRegionsMappingPerView[id_view][descType] = std::move(mapping);
-                    imageDescriber->allocate(_regionsPerView.getData()[id_view][descType]);
                 }
+                std::unique_ptr<feature::Regions> emptyRegions;
+                imageDescriber->allocate(emptyRegions);
+                regionsPerDesc[descType] = std::move(emptyRegions);
                 continue;
             }
 
@@ -349,13 +383,13 @@ bool VoctreeLocalizer::initDatabase(const std::string& vocTreeFilepath, const st
             }
 
             // Filter descriptors to keep only the 3D reconstructed points
-            std::unique_ptr<feature::Regions> filteredRegions = createFilteredRegions(*currRegions, observations.at(descType), mapping);
+            regionsPerDesc[descType] = createFilteredRegions(*currRegions, observations.at(descType), mapping);
 #pragma omp critical
             {
                 _reconstructedRegionsMappingPerView[id_view][descType] = std::move(mapping);
-                _regionsPerView.getData()[id_view][descType] = std::move(filteredRegions);
             }
         }
+        _regionsCache->insert(id_view, regionsPerDesc);
         ++progressDisplay;
     }
     return true;
@@ -414,14 +448,17 @@ bool VoctreeLocalizer::localizeFirstBestResult(const feature::MapRegionsPerDesc&
         // the handler to the current view
         const std::shared_ptr<sfmData::View> matchedView = _sfm_data.getViews().at(matchedViewId);
 
+        // its associated reconstructed regions
+        const feature::MapRegionsPerDesc matchedRegions = _regionsCache->getRegions(matchedViewId);
+
         // safeguard: we should match the query image with an image that has at least
         // some 3D points visible --> if it has 0 3d points it is likely that it is an
         // image of the dataset that was not reconstructed
-        if (_regionsPerView.getRegionsPerDesc(matchedViewId).getNbAllRegions() < minNum3DPoints)
+        if (matchedRegions.getNbAllRegions() < minNum3DPoints)
         {
             ALICEVISION_LOG_DEBUG("[matching]\tSkipping matching with " << matchedView->getImage().getImagePath()
                                                                         << " as it has too few visible 3D points ("
-                                                                        << _regionsPerView.getRegionsPerDesc(matchedViewId).getNbAllRegions() << ")");
+                                                                        << matchedRegions.getNbAllRegions() << ")");
             continue;
         }
         ALICEVISION_LOG_DEBUG("[matching]\tTrying to match the query image with " << matchedView->getImage().getImagePath());
@@ -438,7 +475,7 @@ bool VoctreeLocalizer::localizeFirstBestResult(const feature::MapRegionsPerDesc&
         bool matchWorked = robustMatching(matchers,
                                           // pass the input intrinsic if they are valid, null otherwise
                                           (useInputIntrinsics) ? &queryIntrinsics : nullptr,
-                                          _regionsPerView.getRegionsPerDesc(matchedViewId),
+                                          matchedRegions,
                                           matchedIntrinsics,
                                           param._fDistRatio,
                                           param._matchingError,
@@ -472,7 +509,7 @@ bool VoctreeLocalizer::localizeFirstBestResult(const feature::MapRegionsPerDesc&
                                       queryRegions,
                                       matchedPath,
                                       std::make_pair(mview->getImage().getWidth(), mview->getImage().getHeight()),
-                                      _regionsPerView.getRegionsPerDesc(matchedViewId),
+                                      matchedRegions,
                                       featureMatches,
                                       param._visualDebug + "/" + queryimage + "_" + matchedImage + ".svg");
         }
@@ -492,12 +529,12 @@ bool VoctreeLocalizer::localizeFirstBestResult(const feature::MapRegionsPerDesc&
         for (const auto& featureMatchesIt : featureMatches)
         {
             const feature::EImageDescriberType descType = featureMatchesIt.first;
-            const auto& matchedRegions = _reconstructedRegionsMappingPerView.at(matchedViewId).at(descType);
+            const auto& matchedRegionsMapping = _reconstructedRegionsMappingPerView.at(matchedViewId).at(descType);
 
             for (const matching::IndMatch& featureMatch : featureMatchesIt.second)
             {
                 // the ID of the 3D point
-                const IndexT trackId3D = matchedRegions._associated3dPoint[featureMatch._j];
+                const IndexT trackId3D = matchedRegionsMapping._associated3dPoint[featureMatch._j];
 
                 // prepare data for resectioning
                 resectionData.pt3D.col(index) = _sfm_data.getLandmarks().at(trackId3D).X;
@@ -777,7 +814,7 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc& quer
         // the handler to the current view
         const std::shared_ptr<sfmData::View> matchedView = _sfm_data.getViews().at(matchedViewId);
         // its associated reconstructed regions
-        const feature::MapRegionsPerDesc& matchedRegions = _regionsPerView.getRegionsPerDesc(matchedViewId);
+        const feature::MapRegionsPerDesc matchedRegions = _regionsCache->getRegions(matchedViewId);
 
         // safeguard: we should match the query image with an image that has at least
         // some 3D points visible --> if this is not true it is likely that it is an
@@ -863,7 +900,7 @@ void VoctreeLocalizer::getAllAssociations(const feature::MapRegionsPerDesc& quer
                                       queryRegions,
                                       matchedPath,
                                       std::make_pair(mview->getImage().getWidth(), mview->getImage().getHeight()),
-                                      _regionsPerView.getRegionsPerDesc(matchedViewId),
+                                      matchedRegions,
                                       featureMatches,
                                       outputName.string());
         }
@@ -1158,19 +1195,21 @@ bool VoctreeLocalizer::localizeRig(const std::vector<image::Image<float>>& vec_i
         {
             ALICEVISION_LOG_DEBUG("[features]\tExtract " << feature::EImageDescriberType_enumToString(imageDescriber->getDescriberType())
                                                          << " from query image...");
-            imageDescriber->describe(vec_imageGrey[i], vec_queryRegions[i][imageDescriber->getDescriberType()]);
+            std::unique_ptr<feature::Regions> queryRegions;
+            imageDescriber->describe(vec_imageGrey[i], queryRegions);
 
             if (imageDescriber->useFloatImage())
             {
-                imageDescriber->describe(vec_imageGrey[i], vec_queryRegions[i][imageDescriber->getDescriberType()]);
+                imageDescriber->describe(vec_imageGrey[i], queryRegions);
             }
             else
             {
                 // image descriptor can't use float image
                 if (imageGrayUChar.Width() == 0)  // the first time, convert the float buffer to uchar
                     imageGrayUChar = (vec_imageGrey.at(i).GetMat() * 255.f).cast<unsigned char>();
-                imageDescriber->describe(imageGrayUChar, vec_queryRegions[i][imageDescriber->getDescriberType()]);
+                imageDescriber->describe(imageGrayUChar, queryRegions);
             }
+            vec_queryRegions[i][imageDescriber->getDescriberType()] = std::move(queryRegions);
             ALICEVISION_LOG_DEBUG("[features]\tExtract done: found " << vec_queryRegions[i][imageDescriber->getDescriberType()]->RegionCount()
                                                                      << " features");
         }
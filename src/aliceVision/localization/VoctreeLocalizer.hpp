@@ -8,6 +8,7 @@
 
 #include <aliceVision/config.hpp>
 #include <aliceVision/feature/ImageDescriber.hpp>
+#include <aliceVision/feature/RegionsProvider.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfm/pipeline/localization/SfMLocalizer.hpp>
 #include <aliceVision/stl/mapUtils.hpp>
@@ -93,6 +94,8 @@ class VoctreeLocalizer : public ILocalizer
      * when all the documents are added.
      * @param[in] matchingDescTypes List of descriptor types to use for feature matching.
      * @param[in] voctreeDescType Descriptor type used for image matching with voctree.
+     * @param[in] regionsCacheSize Maximum amount of reconstructed regions kept in memory (in bytes),
+     * the other ones are loaded on demand. 0 to keep all the regions in memory.
      *
      * It enable the use of combined SIFT and CCTAG features.
      */
@@ -100,7 +103,8 @@ class VoctreeLocalizer : public ILocalizer
                      const std::string& descriptorsFolder,
                      const std::string& vocTreeFilepath,
                      const std::string& weightsFilepath,
-                     const std::vector<feature::EImageDescriberType>& matchingDescTypes);
+                     const std::vector<feature::EImageDescriberType>& matchingDescTypes,
+                     std::size_t regionsCacheSize = 0);
 
     void setCudaPipe(int i) override { _cudaPipe = i; }
 
@@ -281,9 +285,13 @@ class VoctreeLocalizer : public ILocalizer
      * when all the documents are added.
      * @param[in] feat_directory The path to the directory containing the features
      * of the scene (.desc and .feat files).
+     * @param[in] regionsCacheSize Maximum amount of reconstructed regions kept in memory (in bytes), 0 for no limit
      * @return true if everything went ok
      */
-    bool initDatabase(const std::string& vocTreeFilepath, const std::string& weightsFilepath, const std::string& featFolder);
+    bool initDatabase(const std::string& vocTreeFilepath,
+                      const std::string& weightsFilepath,
+                      const std::string& featFolder,
+                      std::size_t regionsCacheSize);
 
     /**
      * @brief robustMatching
@@ -332,9 +340,9 @@ class VoctreeLocalizer : public ILocalizer
     bool loadReconstructionDescriptors(const sfmData::SfMData& sfm_data, const std::string& feat_directory);
 
   public:
-    /// for each view index, it contains the features and descriptors that have an
-    /// associated 3D point
-    feature::RegionsPerView _regionsPerView;
+    /// for each view index, it provides the features and descriptors that have an
+    /// associated 3D point, reloaded on demand when they have been released
+    std::unique_ptr<feature::RegionsCache> _regionsCache;
     ReconstructedRegionsMappingPerView _reconstructedRegionsMappingPerView;
 
     /// the feature extractor
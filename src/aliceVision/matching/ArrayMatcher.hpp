@@ -63,6 +63,41 @@ class ArrayMatcher
      * \return True if success.
      */
     virtual bool SearchNeighbours(const Scalar* query, int nbQuery, IndMatches* indices, std::vector<DistanceType>* distances, size_t NN) = 0;
+
+    /**
+     * Search the N nearest Neighbor of several sets of query arrays.
+     * By default, each query set is searched independently.
+     *
+     * \param[in]   queries    The query arrays of each set
+     * \param[in]   nbQueries  The number of query rows of each set
+     * \param[out]  indices    The corresponding (query, neighbor) indices of each set
+     * \param[out]  distances  The distances between the matched arrays of each set
+     * \param[in]   NN         The number of maximal neighbor that will be searched.
+     *
+     * \return True if success (query sets that cannot be searched have empty results).
+     */
+    virtual bool SearchNeighboursBatch(const std::vector<const Scalar*>& queries,
+                                       const std::vector<int>& nbQueries,
+                                       std::vector<IndMatches>* indices,
+                                       std::vector<std::vector<DistanceType>>* distances,
+                                       size_t NN)
+    {
+        indices->assign(queries.size(), IndMatches());
+        distances->assign(queries.size(), std::vector<DistanceType>());
+
+        bool success = false;
+        for (std::size_t i = 0; i < queries.size(); ++i)
+        {
+            if (SearchNeighbours(queries[i], nbQueries[i], &(*indices)[i], &(*distances)[i], NN))
+            {
+                success = true;
+                continue;
+            }
+            (*indices)[i].clear();
+            (*distances)[i].clear();
+        }
+        return success;
+    }
 };
 
 }  // namespace matching
@@ -0,0 +1,219 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/matching/ArrayMatcher.hpp>
+#include <aliceVision/feature/metric.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace matching {
+
+/**
+ * @brief Brute force matcher computing the distance matrix in cache-sized tiles.
+ *
+ * Each tile of query rows is compared to each tile of database rows, so a database tile stays in
+ * cache while all the rows of the query tile are processed. Only the N best neighbours of each
+ * query row are kept while the tiles are processed: the distance matrix is never stored nor sorted.
+ * The tiles of several query sets (SearchNeighboursBatch) are processed together in parallel,
+ * so the same database can be matched against all its candidate images at once.
+ */
+template<typename Scalar = float, typename Metric = feature::L2_Vectorized<Scalar>>
+class ArrayMatcher_bruteForceBatched : public ArrayMatcher<Scalar, Metric>
+{
+  public:
+    typedef typename Metric::ResultType DistanceType;
+
+    /**
+     * @param[in] queryBlockSize    Number of query rows per tile.
+     * @param[in] databaseBlockSize Number of database rows per tile, 0 to fit the database tile
+     *                              in the L2 cache (about 128 KB of descriptors).
+     */
+    explicit ArrayMatcher_bruteForceBatched(int queryBlockSize = 32, int databaseBlockSize = 0)
+      : _queryBlockSize(std::max(1, queryBlockSize)),
+        _databaseBlockSize(std::max(0, databaseBlockSize))
+    {}
+
+    virtual ~ArrayMatcher_bruteForceBatched() { memMapping.reset(); }
+
+    /**
+     * Build the matching structure
+     *
+     * \param[in] dataset   Input data.
+     * \param[in] nbRows    The number of component.
+     * \param[in] dimension Length of the data contained in the dataset.
+     *
+     * \return True if success.
+     */
+    bool Build(std::mt19937& randomNumberGenerator, const Scalar* dataset, int nbRows, int dimension)
+    {
+        if (nbRows < 1)
+        {
+            memMapping.reset(nullptr);
+            return false;
+        }
+        memMapping.reset(new Eigen::Map<const BaseMat>(dataset, nbRows, dimension));
+        return true;
+    }
+
+    /**
+     * Search the nearest Neighbor of the scalar array query.
+     *
+     * \param[in]   query     The query array
+     * \param[out]  indice    The indice of array in the dataset that
+     *  have been computed as the nearest array.
+     * \param[out]  distance  The distance between the two arrays.
+     *
+     * \return True if success.
+     */
+    bool SearchNeighbour(const Scalar* query, int* indice, DistanceType* distance)
+    {
+        IndMatches indices;
+        std::vector<DistanceType> distances;
+        if (!SearchNeighbours(query, 1, &indices, &distances, 1))
+            return false;
+
+        *indice = indices.front()._j;
+        *distance = distances.front();
+        return true;
+    }
+
+    /**
+     * Search the N nearest Neighbor of the scalar array query.
+     *
+     * \param[in]   query     The query array
+     * \param[in]   nbQuery   The number of query rows
+     * \param[out]  indices   The corresponding (query, neighbor) indices
+     * \param[out]  distances The distances between the matched arrays.
+     * \param[out]  NN        The number of maximal neighbor that will be searched.
+     *
+     * \return True if success.
+     */
+    bool SearchNeighbours(const Scalar* query, int nbQuery, IndMatches* pvec_indices, std::vector<DistanceType>* pvec_distances, size_t NN)
+    {
+        std::vector<IndMatches> indices;
+        std::vector<std::vector<DistanceType>> distances;
+        if (!SearchNeighboursBatch({query}, {nbQuery}, &indices, &distances, NN))
+            return false;
+
+        std::swap(*pvec_indices, indices.front());
+        std::swap(*pvec_distances, distances.front());
+        return true;
+    }
+
+    /**
+     * Search the N nearest Neighbor of several sets of query arrays.
+     * All the tiles of all the query sets are processed in parallel.
+     *
+     * \param[in]   queries    The query arrays of each set
+     * \param[in]   nbQueries  The number of query rows of each set
+     * \param[out]  indices    The corresponding (query, neighbor) indices of each set
+     * \param[out]  distances  The distances between the matched arrays of each set
+     * \param[in]   NN         The number of maximal neighbor that will be searched.
+     *
+     * \return True if success (query sets without rows have empty results).
+     */
+    bool SearchNeighboursBatch(const std::vector<const Scalar*>& queries,
+                               const std::vector<int>& nbQueries,
+                               std::vector<IndMatches>* pvec_indices,
+                               std::vector<std::vector<DistanceType>>* pvec_distances,
+                               size_t NN)
+    {
+        pvec_indices->assign(queries.size(), IndMatches());
+        pvec_distances->assign(queries.size(), std::vector<DistanceType>());
+
+        if (memMapping.get() == nullptr || NN < 1 || NN > std::size_t(memMapping->rows()))
+            return false;
+
+        // list the query tiles of all the query sets
+        std::vector<std::pair<int, int>> queryBlocks;  // (query set, first row)
+        for (std::size_t s = 0; s < queries.size(); ++s)
+        {
+            (*pvec_indices)[s].resize(std::size_t(std::max(nbQueries[s], 0)) * NN);
+            (*pvec_distances)[s].resize(std::size_t(std::max(nbQueries[s], 0)) * NN);
+
+            for (int row = 0; row < nbQueries[s]; row += _queryBlockSize)
+                queryBlocks.emplace_back(int(s), row);
+        }
+
+        const int dimension = int(memMapping->cols());
+        const int nbDatabaseRows = int(memMapping->rows());
+        const std::size_t descriptorBytes = std::max(std::size_t(1), std::size_t(dimension) * sizeof(Scalar));
+        const int databaseBlockSize = (_databaseBlockSize > 0) ? _databaseBlockSize : std::max(1, int((128 * 1024) / descriptorBytes));
+
+#pragma omp parallel
+        {
+            Metric metric;
+            // sorted N best neighbours of each query row of the tile
+            std::vector<std::pair<DistanceType, int>> best;
+
+#pragma omp for schedule(dynamic)
+            for (int b = 0; b < (int)queryBlocks.size(); ++b)
+            {
+                const int s = queryBlocks[b].first;
+                const int firstRow = queryBlocks[b].second;
+                const int nbRows = std::min(_queryBlockSize, nbQueries[s] - firstRow);
+                const Scalar* queryBlock = queries[s] + std::size_t(firstRow) * dimension;
+
+                best.assign(std::size_t(nbRows) * NN, std::make_pair(std::numeric_limits<DistanceType>::max(), -1));
+
+                for (int firstDatabaseRow = 0; firstDatabaseRow < nbDatabaseRows; firstDatabaseRow += databaseBlockSize)
+                {
+                    const int lastDatabaseRow = std::min(firstDatabaseRow + databaseBlockSize, nbDatabaseRows);
+
+                    for (int r = 0; r < nbRows; ++r)
+                    {
+                        const Scalar* queryPtr = queryBlock + std::size_t(r) * dimension;
+                        std::pair<DistanceType, int>* rowBest = &best[std::size_t(r) * NN];
+
+                        for (int i = firstDatabaseRow; i < lastDatabaseRow; ++i)
+                        {
+                            const DistanceType distance = metric(queryPtr, memMapping->data() + std::size_t(i) * dimension, dimension);
+                            if (distance >= rowBest[NN - 1].first)
+                                continue;
+
+                            // insertion in the sorted list of neighbours
+                            std::size_t k = NN - 1;
+                            for (; k > 0 && distance < rowBest[k - 1].first; --k)
+                                rowBest[k] = rowBest[k - 1];
+                            rowBest[k] = std::make_pair(distance, i);
+                        }
+                    }
+                }
+
+                for (int r = 0; r < nbRows; ++r)
+                {
+                    const int queryIndex = firstRow + r;
+                    for (std::size_t k = 0; k < NN; ++k)
+                    {
+                        const std::pair<DistanceType, int>& neighbour = best[std::size_t(r) * NN + k];
+                        (*pvec_distances)[s][std::size_t(queryIndex) * NN + k] = neighbour.first;
+                        (*pvec_indices)[s][std::size_t(queryIndex) * NN + k] = IndMatch(queryIndex, neighbour.second);
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+  private:
+    typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> BaseMat;
+
+    int _queryBlockSize;
+    int _databaseBlockSize;
+    /// Use a memory mapping in order to avoid memory re-allocation
+    std::unique_ptr<Eigen::Map<const BaseMat>> memMapping;
+};
+
+}  // namespace matching
+}  // namespace aliceVision
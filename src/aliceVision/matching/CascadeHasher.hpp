@@ -10,8 +10,9 @@
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/feature/metric.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
-#include <aliceVision/stl/DynamicBitset.hpp>
+#include <aliceVision/feature/Hamming.hpp>
 
+#include <cstdint>
 #include <iostream>
 #include <random>
 #include <cmath>
@@ -19,24 +20,30 @@
 namespace aliceVision {
 namespace matching {
 
-struct HashedDescription
+struct HashedDescriptions
 {
-    // Hash code generated by the primary hashing function.
-    stl::dynamic_bitset hash_code;
+    // Number of 64 bits words of each hash code.
+    int nb_hash_words = 0;
+    // Number of bucket groups.
+    int nb_bucket_groups = 0;
 
-    // Each bucket_ids[x] = y means the descriptor belongs to bucket y in bucket
-    // group x.
-    std::vector<uint16_t> bucket_ids;
-};
+    // Hash codes generated by the primary hashing function, nb_hash_words packed words per description.
+    std::vector<uint64_t> hash_codes;
 
-struct HashedDescriptions
-{
-    // The hash information.
-    std::vector<HashedDescription> hashed_desc;
+    // Each bucket_ids[i * nb_bucket_groups + x] = y means the descriptor i belongs to bucket y in
+    // bucket group x.
+    std::vector<uint16_t> bucket_ids;
 
     typedef std::vector<int> Bucket;
     // buckets[bucket_group][bucket_id] = bucket (container of description ids).
     std::vector<std::vector<Bucket>> buckets;
+
+    // Number of hashed descriptions.
+    std::size_t size() const { return nb_bucket_groups == 0 ? 0 : bucket_ids.size() / nb_bucket_groups; }
+
+    const uint64_t* hashCode(std::size_t i) const { return &hash_codes[i * nb_hash_words]; }
+
+    uint16_t bucketId(std::size_t i, int group) const { return bucket_ids[i * nb_bucket_groups + group]; }
 };
 
 /**
@@ -60,6 +67,7 @@ struct HashedDescriptions
  * - replace the BoxMuller random number generation by C++ 11 random number generation
  * - this implementation can support various descriptor length and internal type
  *   SIFT, SURF, ... all scalar based descriptor
+ * - the hash codes are packed in 64 bits words and compared with popcount
  */
 class CascadeHasher
 {
@@ -113,6 +121,34 @@ class CascadeHasher
         return true;
     }
 
+    int GetNbHashCode() const { return nb_hash_code_; }
+    int GetNbBucketGroups() const { return nb_bucket_groups_; }
+    int GetNbBitsPerBucket() const { return nb_bits_per_bucket_; }
+
+    /**
+     * @brief Get a key identifying the hashed descriptions created by this hasher with a zero mean descriptor:
+     *        a 64 bits FNV-1a hash of the parameters, of the projections (given by the random seed) and of the zero mean descriptor.
+     */
+    uint64_t GetFingerprint(const Eigen::VectorXf& zero_mean_descriptor) const
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        auto addBytes = [&hash](const void* data, std::size_t size) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                hash ^= bytes[i];
+                hash *= 1099511628211ULL;
+            }
+        };
+        const int32_t parameters[3] = {nb_hash_code_, nb_bucket_groups_, nb_bits_per_bucket_};
+        addBytes(parameters, sizeof(parameters));
+        addBytes(primary_hash_projection_.data(), primary_hash_projection_.size() * sizeof(float));
+        for (const Eigen::MatrixXf& projection : secondary_hash_projection_)
+            addBytes(projection.data(), projection.size() * sizeof(float));
+        addBytes(zero_mean_descriptor.data(), zero_mean_descriptor.size() * sizeof(float));
+        return hash;
+    }
+
     template<typename MatrixT>
     static Eigen::VectorXf GetZeroMeanDescriptor(const MatrixT& descriptions)
     {
@@ -140,6 +176,8 @@ class CascadeHasher
         //   2) Construct buckets.
 
         HashedDescriptions hashed_descriptions;
+        hashed_descriptions.nb_hash_words = (nb_hash_code_ + 63) / 64;
+        hashed_descriptions.nb_bucket_groups = nb_bucket_groups_;
         if (descriptions.rows() == 0)
         {
             return hashed_descriptions;
@@ -147,29 +185,27 @@ class CascadeHasher
 
         // Create hash codes for each description.
         {
-            // Allocate space for hash codes.
+            // Allocate space for hash codes and bucket ids.
             const typename MatrixT::Index nbDescriptions = descriptions.rows();
-            hashed_descriptions.hashed_desc.resize(nbDescriptions);
+            hashed_descriptions.hash_codes.assign(nbDescriptions * hashed_descriptions.nb_hash_words, 0);
+            hashed_descriptions.bucket_ids.resize(nbDescriptions * nb_bucket_groups_);
             Eigen::VectorXf descriptor(descriptions.cols());
             for (int i = 0; i < nbDescriptions; ++i)
             {
-                // Allocate space for each bucket id.
-                hashed_descriptions.hashed_desc[i].bucket_ids.resize(nb_bucket_groups_);
-
                 for (int k = 0; k < descriptions.cols(); ++k)
                 {
                     descriptor(k) = descriptions(i, k);
                 }
                 descriptor -= zero_mean_descriptor;
 
-                auto& hash_code = hashed_descriptions.hashed_desc[i].hash_code;
-                hash_code = stl::dynamic_bitset(descriptions.cols());
+                uint64_t* hash_code = &hashed_descriptions.hash_codes[i * hashed_descriptions.nb_hash_words];
 
                 // Compute hash code.
                 const Eigen::VectorXf primary_projection = primary_hash_projection_ * descriptor;
                 for (int j = 0; j < nb_hash_code_; ++j)
                 {
-                    hash_code[j] = primary_projection(j) > 0;
+                    if (primary_projection(j) > 0)
+                        hash_code[j / 64] |= uint64_t(1) << (j % 64);
                 }
 
                 // Determine the bucket index for each group.
@@ -183,26 +219,45 @@ class CascadeHasher
                     {
                         bucket_id = (bucket_id << 1) + (secondary_projection(k) > 0 ? 1 : 0);
                     }
-                    hashed_descriptions.hashed_desc[i].bucket_ids[j] = bucket_id;
+                    hashed_descriptions.bucket_ids[i * nb_bucket_groups_ + j] = bucket_id;
                 }
             }
         }
-        // Build the Buckets
+        BuildBuckets(hashed_descriptions);
+        return hashed_descriptions;
+    }
+
+    // Check that hashed descriptions (e.g. loaded from a file) have the layout of this hasher
+    // and that their bucket ids are valid bucket indexes.
+    bool IsCompatible(const HashedDescriptions& hashed_descriptions) const
+    {
+        if (hashed_descriptions.nb_hash_words != (nb_hash_code_ + 63) / 64 || hashed_descriptions.nb_bucket_groups != nb_bucket_groups_ ||
+            hashed_descriptions.hash_codes.size() != hashed_descriptions.size() * hashed_descriptions.nb_hash_words)
+        {
+            return false;
+        }
+        for (const uint16_t bucket_id : hashed_descriptions.bucket_ids)
         {
-            hashed_descriptions.buckets.resize(nb_bucket_groups_);
-            for (int i = 0; i < nb_bucket_groups_; ++i)
-            {
-                hashed_descriptions.buckets[i].resize(nb_buckets_per_group_);
+            if (bucket_id >= nb_buckets_per_group_)
+                return false;
+        }
+        return true;
+    }
 
-                // Add the descriptor ID to the proper bucket group and id.
-                for (int j = 0; j < hashed_descriptions.hashed_desc.size(); ++j)
-                {
-                    const uint16_t bucket_id = hashed_descriptions.hashed_desc[j].bucket_ids[i];
-                    hashed_descriptions.buckets[i][bucket_id].push_back(j);
-                }
+    // Build the buckets of hashed descriptions from their bucket ids (e.g. loaded from a file).
+    // The hashed descriptions must be compatible with this hasher, see IsCompatible.
+    void BuildBuckets(HashedDescriptions& hashed_descriptions) const
+    {
+        hashed_descriptions.buckets.assign(nb_bucket_groups_, std::vector<HashedDescriptions::Bucket>(nb_buckets_per_group_));
+        for (int i = 0; i < nb_bucket_groups_; ++i)
+        {
+            // Add the descriptor ID to the proper bucket group and id.
+            for (std::size_t j = 0; j < hashed_descriptions.size(); ++j)
+            {
+                const uint16_t bucket_id = hashed_descriptions.bucketId(j, i);
+                hashed_descriptions.buckets[i][bucket_id].push_back(static_cast<int>(j));
             }
         }
-        return hashed_descriptions;
     }
 
     // Matches two collection of hashed descriptions with a fast matching scheme
@@ -223,42 +278,43 @@ class CascadeHasher
 
         // Preallocate the candidate descriptors container.
         std::vector<int> candidate_descriptors;
-        candidate_descriptors.reserve(hashed_descriptions2.hashed_desc.size());
+        candidate_descriptors.reserve(hashed_descriptions2.size());
 
         // Preallocated hamming distances. Each column indicates the hamming distance
         // and the rows collect the descriptor ids with that
         // distance. num_descriptors_with_hamming_distance keeps track of how many
         // descriptors have that distance.
-        Eigen::MatrixXi candidate_hamming_distances(hashed_descriptions2.hashed_desc.size(), nb_hash_code_ + 1);
+        Eigen::MatrixXi candidate_hamming_distances(hashed_descriptions2.size(), nb_hash_code_ + 1);
         Eigen::VectorXi num_descriptors_with_hamming_distance(nb_hash_code_ + 1);
 
         // Preallocate the container for keeping euclidean distances.
         std::vector<std::pair<DistanceType, int>> candidate_euclidean_distances;
         candidate_euclidean_distances.reserve(kNumTopCandidates);
 
-        // A preallocated vector to determine if we have already used a particular
+        // A preallocated packed bitset to determine if we have already used a particular
         // feature for matching (i.e., prevents duplicates).
-        std::vector<bool> used_descriptor(hashed_descriptions2.hashed_desc.size());
+        std::vector<uint64_t> used_descriptor((hashed_descriptions2.size() + 63) / 64, 0);
 
-        typedef feature::Hamming<stl::dynamic_bitset::BlockType> HammingMetricType;
-        static const HammingMetricType metricH = {};
-        for (int i = 0; i < hashed_descriptions1.hashed_desc.size(); ++i)
+        const int nb_hash_words = hashed_descriptions1.nb_hash_words;
+        assert(nb_hash_words == hashed_descriptions2.nb_hash_words);
+
+        for (int i = 0; i < static_cast<int>(hashed_descriptions1.size()); ++i)
         {
             candidate_descriptors.clear();
             num_descriptors_with_hamming_distance.setZero();
             candidate_euclidean_distances.clear();
 
-            const auto& hashed_desc = hashed_descriptions1.hashed_desc[i];
+            const uint64_t* hash_code = hashed_descriptions1.hashCode(i);
 
             // Accumulate all descriptors in each bucket group that are in the same
             // bucket id as the query descriptor.
             for (int j = 0; j < nb_bucket_groups_; ++j)
             {
-                const uint16_t bucket_id = hashed_desc.bucket_ids[j];
+                const uint16_t bucket_id = hashed_descriptions1.bucketId(i, j);
                 for (const auto& feature_id : hashed_descriptions2.buckets[j][bucket_id])
                 {
                     candidate_descriptors.emplace_back(feature_id);
-                    used_descriptor[feature_id] = false;
+                    used_descriptor[feature_id / 64] &= ~(uint64_t(1) << (feature_id % 64));
                 }
             }
 
@@ -273,13 +329,17 @@ class CascadeHasher
             // distance.
             for (const int candidate_id : candidate_descriptors)
             {
-                if (!used_descriptor[candidate_id])  // avoid selecting the same candidate multiple times
+                uint64_t& used_word = used_descriptor[candidate_id / 64];
+                const uint64_t used_mask = uint64_t(1) << (candidate_id % 64);
+                if (!(used_word & used_mask))  // avoid selecting the same candidate multiple times
                 {
-                    used_descriptor[candidate_id] = true;
+                    used_word |= used_mask;
+
+                    const uint64_t* candidate_hash_code = hashed_descriptions2.hashCode(candidate_id);
+                    int hamming_distance = 0;
+                    for (int w = 0; w < nb_hash_words; ++w)
+                        hamming_distance += feature::Hamming<uint64_t>::popcnt64(hash_code[w] ^ candidate_hash_code[w]);
 
-                    const HammingMetricType::ResultType hamming_distance = metricH(hashed_desc.hash_code.data(),
-                                                                                   hashed_descriptions2.hashed_desc[candidate_id].hash_code.data(),
-                                                                                   hashed_desc.hash_code.num_blocks());
                     candidate_hamming_distances(num_descriptors_with_hamming_distance(hamming_distance)++, hamming_distance) = candidate_id;
                 }
             }
@@ -8,6 +8,7 @@
 #include "aliceVision/matching/matcherType.hpp"
 #include "aliceVision/matching/RegionsMatcher.hpp"
 #include "aliceVision/matching/ArrayMatcher_bruteForce.hpp"
+#include "aliceVision/matching/ArrayMatcher_bruteForceBatched.hpp"
 #include "aliceVision/matching/ArrayMatcher_kdtreeFlann.hpp"
 #include "aliceVision/matching/ArrayMatcher_cascadeHashing.hpp"
 
@@ -38,6 +39,38 @@ bool RegionsDatabaseMatcher::Match(float distRatio, const feature::Regions& quer
     return _regionsMatcher->Match(distRatio, queryRegions, matches);
 }
 
+bool RegionsDatabaseMatcher::Match(float distRatio,
+                                   const std::vector<const feature::Regions*>& queryRegions,
+                                   std::vector<matching::IndMatches>& matches) const
+{
+    matches.assign(queryRegions.size(), matching::IndMatches());
+
+    if (!_regionsMatcher)
+        return false;
+
+    // empty query Regions are not searched
+    std::vector<const feature::Regions*> validQueryRegions;
+    std::vector<std::size_t> validIndexes;
+    for (std::size_t i = 0; i < queryRegions.size(); ++i)
+    {
+        if (queryRegions[i]->RegionCount() == 0)
+            continue;
+        validQueryRegions.push_back(queryRegions[i]);
+        validIndexes.push_back(i);
+    }
+
+    if (validQueryRegions.empty())
+        return false;
+
+    std::vector<matching::IndMatches> validMatches;
+    const bool res = _regionsMatcher->Match(distRatio, validQueryRegions, validMatches);
+
+    for (std::size_t i = 0; i < validIndexes.size(); ++i)
+        std::swap(matches[validIndexes[i]], validMatches[i]);
+
+    return res;
+}
+
 RegionsDatabaseMatcher::RegionsDatabaseMatcher()
   : _matcherType(BRUTE_FORCE_L2),
     _regionsMatcher(nullptr)
@@ -78,6 +111,12 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(std::mt19937& randomNumber
                     out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
                 }
                 break;
+                case BRUTE_FORCE_L2_BATCHED:
+                {
+                    typedef ArrayMatcher_bruteForceBatched<unsigned char> MatcherT;
+                    out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
+                }
+                break;
                 case ANN_L2:
                 {
                     typedef ArrayMatcher_kdtreeFlann<unsigned char> MatcherT;
@@ -107,6 +146,12 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(std::mt19937& randomNumber
                     out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
                 }
                 break;
+                case BRUTE_FORCE_L2_BATCHED:
+                {
+                    typedef ArrayMatcher_bruteForceBatched<float> MatcherT;
+                    out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
+                }
+                break;
                 case ANN_L2:
                 {
                     typedef ArrayMatcher_kdtreeFlann<float> MatcherT;
@@ -136,6 +181,12 @@ std::unique_ptr<IRegionsMatcher> createRegionsMatcher(std::mt19937& randomNumber
                     out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
                 }
                 break;
+                case BRUTE_FORCE_L2_BATCHED:
+                {
+                    typedef ArrayMatcher_bruteForceBatched<double> MatcherT;
+                    out.reset(new matching::RegionsMatcher<MatcherT>(randomNumberGenerator, regions, true));
+                }
+                break;
                 case ANN_L2:
                 {
                     typedef ArrayMatcher_kdtreeFlann<double> MatcherT;
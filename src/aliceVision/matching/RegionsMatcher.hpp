@@ -72,6 +72,19 @@ class IRegionsMatcher
      */
     virtual bool Match(const float f_dist_ratio, const feature::Regions& query_regions, matching::IndMatches& vec_putative_matches) = 0;
 
+    /**
+     * @brief Match several Regions to the internal database using the test ratio to improve
+     * the robustness of the match.
+     *
+     * @param[in] f_dist_ratio The threshold for the ratio test.
+     * @param[in] query_regions The Regions to match.
+     * @param[out] vec_putative_matches The matches of each query Regions, in the same order.
+     * @return True if everything went well.
+     */
+    virtual bool Match(const float f_dist_ratio,
+                       const std::vector<const feature::Regions*>& query_regions,
+                       std::vector<matching::IndMatches>& vec_putative_matches) = 0;
+
     const feature::Regions& getDatabaseRegions() const { return regions_; }
 };
 
@@ -135,6 +148,60 @@ class RegionsMatcher : public IRegionsMatcher
         if (!matcher_.SearchNeighbours(queries, queryregions_.RegionCount(), &vec_nIndice, &vec_fDistance, NNN__))
             return false;
 
+        filterMatches(f_dist_ratio, queryregions_, vec_nIndice, vec_fDistance, NNN__, vec_putative_matches);
+        return (!vec_putative_matches.empty());
+    }
+
+    /**
+     * @brief Match several Regions to the internal database using the test ratio to improve
+     * the robustness of the match.
+     * All the query Regions are searched at once, so the matcher can share the database work.
+     *
+     * @param[in] f_dist_ratio The threshold for the ratio test.
+     * @param[in] queryRegions The Regions to match.
+     * @param[out] vec_putative_matches The matches of each query Regions, in the same order.
+     * @return True if everything went well.
+     */
+    bool Match(const float f_dist_ratio, const std::vector<const feature::Regions*>& queryRegions, std::vector<matching::IndMatches>& vec_putative_matches)
+    {
+        std::vector<const Scalar*> queries;
+        std::vector<int> nbQueries;
+        for (const feature::Regions* regions : queryRegions)
+        {
+            queries.push_back(reinterpret_cast<const Scalar*>(regions->DescriptorRawData()));
+            nbQueries.push_back(int(regions->RegionCount()));
+        }
+
+        const size_t NNN__ = 2;
+        std::vector<matching::IndMatches> vec_nIndice;
+        std::vector<std::vector<DistanceType>> vec_fDistance;
+
+        vec_putative_matches.assign(queryRegions.size(), matching::IndMatches());
+
+        // Search the 2 closest features neighbours for each query descriptor of each query Regions
+        if (!matcher_.SearchNeighboursBatch(queries, nbQueries, &vec_nIndice, &vec_fDistance, NNN__))
+            return false;
+
+        bool hasMatches = false;
+        for (size_t i = 0; i < queryRegions.size(); ++i)
+        {
+            filterMatches(f_dist_ratio, *queryRegions[i], vec_nIndice[i], vec_fDistance[i], NNN__, vec_putative_matches[i]);
+            hasMatches |= !vec_putative_matches[i].empty();
+        }
+        return hasMatches;
+    }
+
+  private:
+    /**
+     * @brief Keep the nearest neighbours that pass the ratio test, without duplicates.
+     */
+    void filterMatches(const float f_dist_ratio,
+                       const feature::Regions& queryregions_,
+                       const matching::IndMatches& vec_nIndice,
+                       const std::vector<DistanceType>& vec_fDistance,
+                       const size_t NNN__,
+                       matching::IndMatches& vec_putative_matches) const
+    {
         assert(vec_nIndice.size() == vec_fDistance.size());
 
         std::vector<int> vec_nn_ratio_idx;
@@ -171,8 +238,6 @@ class RegionsMatcher : public IRegionsMatcher
         matching::IndMatchDecorator<float> matchDeduplicator(
           vec_putative_matches, regions_.GetRegionsPositions(), queryregions_.GetRegionsPositions());
         matchDeduplicator.getDeduplicated(vec_putative_matches);
-
-        return (!vec_putative_matches.empty());
     }
 };
 
@@ -209,6 +274,16 @@ class RegionsDatabaseMatcher
      */
     bool Match(float distRatio, const feature::Regions& queryRegions, matching::IndMatches& matches) const;
 
+    /**
+     * @brief Find corresponding points between several query Regions and the database one
+     *
+     * @param[in] distRatio The threshold for the ratio test used to discard spurious correspondence.
+     * @param[in] queryRegions The Regions to match.
+     * @param[out] matches The matches of each query Regions, in the same order.
+     * @return True if everything went well.
+     */
+    bool Match(float distRatio, const std::vector<const feature::Regions*>& queryRegions, std::vector<matching::IndMatches>& matches) const;
+
     const feature::Regions& getDatabaseRegions() const { return _regionsMatcher->getDatabaseRegions(); }
 
   private:
@@ -0,0 +1,252 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "hashedDescriptionsIO.hpp"
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+namespace aliceVision {
+namespace matching {
+
+namespace {
+
+constexpr char hashedDescriptionsMagic[8] = {'A', 'V', 'C', 'H', 'A', 'S', 'H', '\0'};
+constexpr char zeroMeanDescriptorMagic[8] = {'A', 'V', 'C', 'H', 'M', 'E', 'A', 'N'};
+constexpr std::uint32_t hashedDescriptionsVersion = 1;
+constexpr std::uint32_t zeroMeanDescriptorVersion = 2;
+
+struct HashedDescriptionsHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t nbHashWords;
+    std::uint32_t nbBucketGroups;
+    std::uint32_t reserved;
+    std::uint64_t key;
+    std::uint64_t nbDescriptions;
+};
+
+struct ZeroMeanDescriptorHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t dimension;
+    std::uint64_t nbInputs;
+};
+
+/**
+ * @brief Write a file through a temporary file in the same folder renamed at the end.
+ */
+template<typename WriteFunction>
+bool writeFile(const std::string& filepath, WriteFunction write)
+{
+    const fs::path bPath = fs::path(filepath);
+    const std::string tmpPath = (bPath.parent_path() / bPath.stem()).string() + "." + fs::unique_path().string() + bPath.extension().string();
+    {
+        std::ofstream stream(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!stream.is_open())
+        {
+            ALICEVISION_LOG_WARNING("Can't write file: " << tmpPath);
+            return false;
+        }
+        write(stream);
+        if (!stream.good())
+        {
+            ALICEVISION_LOG_WARNING("Can't write file: " << tmpPath);
+            stream.close();
+            fs::remove(tmpPath);
+            return false;
+        }
+    }
+    boost::system::error_code ec;
+    fs::rename(tmpPath, filepath, ec);
+    if (ec)
+    {
+        ALICEVISION_LOG_WARNING("Can't rename file: " << tmpPath << " to " << filepath << " (" << ec.message() << ")");
+        fs::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+bool saveHashedDescriptions(const std::string& filepath, std::uint64_t key, const HashedDescriptions& hashedDescriptions)
+{
+    HashedDescriptionsHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, hashedDescriptionsMagic, sizeof(header.magic));
+    header.version = hashedDescriptionsVersion;
+    header.nbHashWords = static_cast<std::uint32_t>(hashedDescriptions.nb_hash_words);
+    header.nbBucketGroups = static_cast<std::uint32_t>(hashedDescriptions.nb_bucket_groups);
+    header.key = key;
+    header.nbDescriptions = hashedDescriptions.size();
+
+    return writeFile(filepath, [&](std::ofstream& stream) {
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char*>(hashedDescriptions.hash_codes.data()), hashedDescriptions.hash_codes.size() * sizeof(std::uint64_t));
+        stream.write(reinterpret_cast<const char*>(hashedDescriptions.bucket_ids.data()), hashedDescriptions.bucket_ids.size() * sizeof(std::uint16_t));
+    });
+}
+
+bool loadHashedDescriptions(const std::string& filepath, std::uint64_t key, std::size_t nbDescriptions, HashedDescriptions& hashedDescriptions)
+{
+    std::ifstream stream(filepath, std::ios::in | std::ios::binary);
+    if (!stream.is_open())
+        return false;
+
+    HashedDescriptionsHeader header;
+    if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, hashedDescriptionsMagic, sizeof(hashedDescriptionsMagic)) != 0 || header.version != hashedDescriptionsVersion)
+    {
+        ALICEVISION_LOG_WARNING("Invalid hashed descriptions file: " << filepath);
+        return false;
+    }
+
+    // computed by another hasher (seed or parameters) or from other descriptors
+    if (header.key != key || header.nbDescriptions != nbDescriptions)
+        return false;
+
+    // the data size given by the header must be the remaining size of the file
+    const std::streamoff dataOffset = stream.tellg();
+    stream.seekg(0, std::ios::end);
+    const std::streamoff fileSize = stream.tellg();
+    stream.seekg(dataOffset);
+    const std::uint64_t dataSize = static_cast<std::uint64_t>(nbDescriptions) *
+                                   (static_cast<std::uint64_t>(header.nbHashWords) * sizeof(std::uint64_t) +
+                                    static_cast<std::uint64_t>(header.nbBucketGroups) * sizeof(std::uint16_t));
+    if (dataOffset < 0 || fileSize < dataOffset || static_cast<std::uint64_t>(fileSize - dataOffset) != dataSize)
+    {
+        ALICEVISION_LOG_WARNING("Truncated hashed descriptions file: " << filepath);
+        return false;
+    }
+
+    hashedDescriptions.nb_hash_words = static_cast<int>(header.nbHashWords);
+    hashedDescriptions.nb_bucket_groups = static_cast<int>(header.nbBucketGroups);
+    hashedDescriptions.hash_codes.resize(nbDescriptions * header.nbHashWords);
+    hashedDescriptions.bucket_ids.resize(nbDescriptions * header.nbBucketGroups);
+    hashedDescriptions.buckets.clear();
+
+    if (!stream.read(reinterpret_cast<char*>(hashedDescriptions.hash_codes.data()), hashedDescriptions.hash_codes.size() * sizeof(std::uint64_t)) ||
+        !stream.read(reinterpret_cast<char*>(hashedDescriptions.bucket_ids.data()), hashedDescriptions.bucket_ids.size() * sizeof(std::uint16_t)))
+    {
+        ALICEVISION_LOG_WARNING("Truncated hashed descriptions file: " << filepath);
+        hashedDescriptions = HashedDescriptions();
+        return false;
+    }
+    return true;
+}
+
+std::uint64_t computeDescriptionsKey(const void* data, std::size_t size, std::uint64_t seed)
+{
+    // FNV-1a on 64 bits words, then on the remaining bytes
+    std::uint64_t hash = seed;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    const std::size_t nbWords = size / sizeof(std::uint64_t);
+    for (std::size_t i = 0; i < nbWords; ++i)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, bytes + i * sizeof(std::uint64_t), sizeof(std::uint64_t));
+        hash ^= word;
+        hash *= 1099511628211ULL;
+    }
+    for (std::size_t i = nbWords * sizeof(std::uint64_t); i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    // the size is part of the key, so that trailing zeros change it
+    const std::uint64_t size64 = size;
+    hash ^= size64;
+    hash *= 1099511628211ULL;
+    return hash;
+}
+
+bool saveZeroMeanDescriptor(const std::string& filepath, const Eigen::VectorXf& zeroMeanDescriptor, const std::map<IndexT, std::uint64_t>& inputsKeys)
+{
+    ZeroMeanDescriptorHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, zeroMeanDescriptorMagic, sizeof(header.magic));
+    header.version = zeroMeanDescriptorVersion;
+    header.dimension = static_cast<std::uint32_t>(zeroMeanDescriptor.size());
+    header.nbInputs = inputsKeys.size();
+
+    std::vector<std::uint32_t> viewIds;
+    std::vector<std::uint64_t> keys;
+    viewIds.reserve(inputsKeys.size());
+    keys.reserve(inputsKeys.size());
+    for (const auto& input : inputsKeys)
+    {
+        viewIds.push_back(input.first);
+        keys.push_back(input.second);
+    }
+
+    return writeFile(filepath, [&](std::ofstream& stream) {
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char*>(zeroMeanDescriptor.data()), zeroMeanDescriptor.size() * sizeof(float));
+        stream.write(reinterpret_cast<const char*>(viewIds.data()), viewIds.size() * sizeof(std::uint32_t));
+        stream.write(reinterpret_cast<const char*>(keys.data()), keys.size() * sizeof(std::uint64_t));
+    });
+}
+
+bool loadZeroMeanDescriptor(const std::string& filepath,
+                            std::size_t dimension,
+                            Eigen::VectorXf& zeroMeanDescriptor,
+                            std::map<IndexT, std::uint64_t>& inputsKeys)
+{
+    std::ifstream stream(filepath, std::ios::in | std::ios::binary);
+    if (!stream.is_open())
+        return false;
+
+    ZeroMeanDescriptorHeader header;
+    if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, zeroMeanDescriptorMagic, sizeof(zeroMeanDescriptorMagic)) != 0 || header.version != zeroMeanDescriptorVersion ||
+        header.dimension != dimension)
+    {
+        ALICEVISION_LOG_WARNING("Invalid zero mean descriptor file: " << filepath);
+        return false;
+    }
+
+    // the number of inputs cannot exceed the remaining size of the file
+    const std::streamoff dataOffset = stream.tellg();
+    stream.seekg(0, std::ios::end);
+    const std::streamoff fileSize = stream.tellg();
+    stream.seekg(dataOffset);
+    const std::streamoff inputsOffset = dataOffset + static_cast<std::streamoff>(dimension * sizeof(float));
+    constexpr std::uint64_t inputSize = sizeof(std::uint32_t) + sizeof(std::uint64_t);
+    if (dataOffset < 0 || fileSize < inputsOffset || header.nbInputs > static_cast<std::uint64_t>(fileSize) ||
+        static_cast<std::uint64_t>(fileSize - inputsOffset) != header.nbInputs * inputSize)
+    {
+        ALICEVISION_LOG_WARNING("Truncated zero mean descriptor file: " << filepath);
+        return false;
+    }
+
+    zeroMeanDescriptor.resize(dimension);
+    std::vector<std::uint32_t> viewIds(header.nbInputs);
+    std::vector<std::uint64_t> keys(header.nbInputs);
+    if (!stream.read(reinterpret_cast<char*>(zeroMeanDescriptor.data()), dimension * sizeof(float)) ||
+        !stream.read(reinterpret_cast<char*>(viewIds.data()), viewIds.size() * sizeof(std::uint32_t)) ||
+        !stream.read(reinterpret_cast<char*>(keys.data()), keys.size() * sizeof(std::uint64_t)))
+    {
+        ALICEVISION_LOG_WARNING("Truncated zero mean descriptor file: " << filepath);
+        return false;
+    }
+
+    inputsKeys.clear();
+    for (std::size_t i = 0; i < viewIds.size(); ++i)
+        inputsKeys.emplace(viewIds[i], keys[i]);
+    return true;
+}
+
+}  // namespace matching
+}  // namespace aliceVision
@@ -0,0 +1,80 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/matching/CascadeHasher.hpp>
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace aliceVision {
+namespace matching {
+
+/**
+ * @brief Save the hash codes and bucket ids of hashed descriptions in a binary file,
+ *        so that they can be reused by the next matching runs with the same hasher.
+ *
+ * Layout (native little-endian):
+ * - header: magic, version, number of hash words, number of bucket groups, key, number of descriptions
+ * - hash codes (uint64), then bucket ids (uint16)
+ *
+ * The file is written in a temporary file renamed at the end, so concurrent runs never read a partial file.
+ *
+ * @param[in] filepath the file to write
+ * @param[in] key the key of the hasher, see CascadeHasher::GetFingerprint
+ * @param[in] hashedDescriptions the hashed descriptions to save (the buckets are not saved)
+ * @return false if the file cannot be written
+ */
+bool saveHashedDescriptions(const std::string& filepath, std::uint64_t key, const HashedDescriptions& hashedDescriptions);
+
+/**
+ * @brief Load the hash codes and bucket ids of hashed descriptions saved by saveHashedDescriptions.
+ *        The buckets have to be built with CascadeHasher::BuildBuckets.
+ *
+ * @param[in] filepath the file to read
+ * @param[in] key the expected key of the hasher
+ * @param[in] nbDescriptions the expected number of descriptions
+ * @param[out] hashedDescriptions the loaded hashed descriptions
+ * @return false if the file does not exist or does not match the key and the number of descriptions
+ */
+bool loadHashedDescriptions(const std::string& filepath, std::uint64_t key, std::size_t nbDescriptions, HashedDescriptions& hashedDescriptions);
+
+/**
+ * @brief Compute a key identifying raw descriptor data: a 64 bits FNV-1a hash of the data, combined with a seed.
+ * @param[in] data the descriptor data
+ * @param[in] size the size of the data in bytes
+ * @param[in] seed the key to combine with, e.g. the key of the hasher
+ * @return the key of the data
+ */
+std::uint64_t computeDescriptionsKey(const void* data, std::size_t size, std::uint64_t seed = 14695981039346656037ULL);
+
+/**
+ * @brief Save a zero mean descriptor, shared by all the matching runs of a same dataset.
+ * @param[in] filepath the file to write
+ * @param[in] zeroMeanDescriptor the zero mean descriptor
+ * @param[in] inputsKeys the key of the descriptions of each view used to compute the zero mean descriptor
+ * @return false if the file cannot be written
+ */
+bool saveZeroMeanDescriptor(const std::string& filepath, const Eigen::VectorXf& zeroMeanDescriptor, const std::map<IndexT, std::uint64_t>& inputsKeys);
+
+/**
+ * @brief Load a zero mean descriptor saved by saveZeroMeanDescriptor.
+ * @param[in] filepath the file to read
+ * @param[in] dimension the expected dimension of the descriptor
+ * @param[out] zeroMeanDescriptor the loaded descriptor
+ * @param[out] inputsKeys the key of the descriptions of each view used to compute the zero mean descriptor
+ * @return false if the file does not exist or does not match the dimension
+ */
+bool loadZeroMeanDescriptor(const std::string& filepath,
+                            std::size_t dimension,
+                            Eigen::VectorXf& zeroMeanDescriptor,
+                            std::map<IndexT, std::uint64_t>& inputsKeys);
+
+}  // namespace matching
+}  // namespace aliceVision
@@ -108,6 +108,78 @@ BOOST_AUTO_TEST_CASE(IndMatch_IO)
     boost::filesystem::remove_all(testFolder);
 }
 
+BOOST_AUTO_TEST_CASE(IndMatch_IO_binary)
+{
+    const std::string testFolder = "matchingBinaryTest";
+
+    PairwiseMatches matches;
+    matches[std::make_pair(0, 1)][EImageDescriberType::SIFT] = {{0, 0}, {1, 1}};
+    matches[std::make_pair(0, 1)][EImageDescriberType::AKAZE] = {{5, 2}};
+    matches[std::make_pair(1, 2)][EImageDescriberType::SIFT] = {{0, 0}, {1, 1}, {2, 2}};
+    matches[std::make_pair(2, 3)][EImageDescriberType::SIFT] = {};
+    // unsorted feature ids with large gaps
+    for (IndexT i = 0; i < 1000; ++i)
+        matches[std::make_pair(3, 7)][EImageDescriberType::SIFT].emplace_back((i * 7919) % 100000, 100000 - i * 3);
+
+    for (const bool compress : {false, true})
+    {
+        for (const bool matchFilePerImage : {false, true})
+        {
+            boost::filesystem::remove_all(testFolder);
+            boost::filesystem::create_directory(testFolder);
+
+            BOOST_CHECK(Save(matches, testFolder, "bin", matchFilePerImage, "", compress));
+
+            // full loading
+            {
+                PairwiseMatches loadedMatches;
+                BOOST_CHECK(Load(loadedMatches, {}, {testFolder}, {}));
+                BOOST_CHECK_EQUAL(matches.size(), loadedMatches.size());
+
+                for (const auto& pairMatches : matches)
+                {
+                    BOOST_REQUIRE_EQUAL(1, loadedMatches.count(pairMatches.first));
+                    const MatchesPerDescType& loadedPairMatches = loadedMatches.at(pairMatches.first);
+                    BOOST_CHECK_EQUAL(pairMatches.second.size(), loadedPairMatches.size());
+
+                    // same matches in the same order
+                    for (const auto& matchesPerDesc : pairMatches.second)
+                        BOOST_CHECK(matchesPerDesc.second == loadedPairMatches.at(matchesPerDesc.first));
+                }
+            }
+
+            // partial loading
+            {
+                PairwiseMatches loadedMatches;
+                BOOST_CHECK(Load(loadedMatches, {0, 1, 7}, {testFolder}, {EImageDescriberType::SIFT}));
+                BOOST_CHECK_EQUAL(1, loadedMatches.size());
+                BOOST_REQUIRE_EQUAL(1, loadedMatches.count(std::make_pair(0, 1)));
+                BOOST_CHECK_EQUAL(1, loadedMatches.at(std::make_pair(0, 1)).size());
+                BOOST_CHECK_EQUAL(2, loadedMatches.at(std::make_pair(0, 1)).at(EImageDescriberType::SIFT).size());
+            }
+        }
+    }
+
+    // compression reduces the file size of redundant matches
+    {
+        PairwiseMatches redundantMatches;
+        for (IndexT i = 0; i < 10000; ++i)
+            redundantMatches[std::make_pair(0, 1)][EImageDescriberType::SIFT].emplace_back(i * 2, i * 2 + 1);
+
+        const std::string filepath = testFolder + "/redundant.bin";
+        const std::string compressedFilepath = testFolder + "/redundantCompressed.bin";
+        saveBinaryMatchFile(filepath, redundantMatches.begin(), redundantMatches.end(), false);
+        saveBinaryMatchFile(compressedFilepath, redundantMatches.begin(), redundantMatches.end(), true);
+        BOOST_CHECK_LT(fs::file_size(compressedFilepath), fs::file_size(filepath));
+
+        PairwiseMatches loadedMatches;
+        BOOST_CHECK(LoadMatchFile(loadedMatches, compressedFilepath));
+        BOOST_CHECK(loadedMatches == redundantMatches);
+    }
+
+    boost::filesystem::remove_all(testFolder);
+}
+
 BOOST_AUTO_TEST_CASE(IndMatch_DuplicateRemoval_NoRemoval)
 {
     std::vector<IndMatch> vec_indMatch;
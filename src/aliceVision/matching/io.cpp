@@ -11,8 +11,15 @@
 #include <aliceVision/system/Logger.hpp>
 
 #include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include <boost/range/iterator_range.hpp>
 
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <map>
 #include <fstream>
 #include <iterator>
@@ -24,7 +31,388 @@ namespace fs = boost::filesystem;
 namespace aliceVision {
 namespace matching {
 
-bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath)
+namespace {
+
+constexpr char binaryMatchesMagic[8] = {'A', 'V', 'M', 'A', 'T', 'C', 'H', '\0'};
+constexpr std::uint32_t binaryMatchesVersion = 1;
+constexpr std::uint32_t binaryMatchesFlagCompressed = 1;
+
+struct BinaryMatchesHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t flags;
+    std::uint64_t nbPairs;
+    std::uint64_t indexOffset;
+};
+
+struct BinaryMatchesIndexEntry
+{
+    std::uint32_t I;
+    std::uint32_t J;
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+/// header of the matches of one descriptor type in a pair block
+/// storedSize == rawSize: the payload is not compressed
+struct BinaryMatchesDescHeader
+{
+    std::uint32_t descType;
+    std::uint32_t nbMatches;
+    std::uint32_t rawSize;
+    std::uint32_t storedSize;
+};
+
+static_assert(sizeof(BinaryMatchesHeader) == 32, "Invalid binary matches header size.");
+static_assert(sizeof(BinaryMatchesIndexEntry) == 24, "Invalid binary matches index entry size.");
+static_assert(sizeof(BinaryMatchesDescHeader) == 16, "Invalid binary matches descriptor header size.");
+
+inline void writeVarint(std::vector<std::uint8_t>& out, std::uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+inline bool readVarint(const std::uint8_t*& data, const std::uint8_t* end, std::uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && data != end; shift += 7)
+    {
+        const std::uint8_t byte = *data++;
+        value |= std::uint64_t(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+inline std::uint64_t zigzagEncode(std::int64_t value) { return (std::uint64_t(value) << 1) ^ std::uint64_t(value >> 63); }
+
+inline std::int64_t zigzagDecode(std::uint64_t value) { return std::int64_t(value >> 1) ^ -std::int64_t(value & 1); }
+
+/**
+ * @brief Encode the feature ids of the matches as deltas with the previous match.
+ * @note Matches are not reordered: the order is meaningful (see filterTopMatches).
+ */
+void encodeMatches(const IndMatches& matches, std::vector<std::uint8_t>& out)
+{
+    out.clear();
+    out.reserve(matches.size() * 4);
+
+    std::int64_t prevI = 0;
+    std::int64_t prevJ = 0;
+    for (const IndMatch& m : matches)
+    {
+        writeVarint(out, zigzagEncode(std::int64_t(m._i) - prevI));
+        writeVarint(out, zigzagEncode(std::int64_t(m._j) - prevJ));
+        prevI = m._i;
+        prevJ = m._j;
+    }
+}
+
+bool decodeMatches(const std::uint8_t* data, std::size_t size, std::size_t nbMatches, IndMatches& out)
+{
+    const std::uint8_t* end = data + size;
+    out.resize(nbMatches);
+
+    std::int64_t prevI = 0;
+    std::int64_t prevJ = 0;
+    for (IndMatch& m : out)
+    {
+        std::uint64_t deltaI, deltaJ;
+        if (!readVarint(data, end, deltaI) || !readVarint(data, end, deltaJ))
+            return false;
+        prevI += zigzagDecode(deltaI);
+        prevJ += zigzagDecode(deltaJ);
+        m = IndMatch(static_cast<IndexT>(prevI), static_cast<IndexT>(prevJ));
+    }
+    return data == end;
+}
+
+/**
+ * @brief Decode one pair block.
+ * @return false if the block is corrupted
+ */
+bool decodePairBlock(const std::uint8_t* data,
+                     std::size_t size,
+                     const std::vector<feature::EImageDescriberType>& descTypesFilter,
+                     MatchesPerDescType& out)
+{
+    const std::uint8_t* end = data + size;
+
+    std::uint32_t nbDescTypes = 0;
+    if (size < sizeof(nbDescTypes))
+        return false;
+    std::memcpy(&nbDescTypes, data, sizeof(nbDescTypes));
+    data += sizeof(nbDescTypes);
+
+    std::vector<std::uint8_t> buffer;
+
+    for (std::uint32_t d = 0; d < nbDescTypes; ++d)
+    {
+        BinaryMatchesDescHeader descHeader;
+        if (std::size_t(end - data) < sizeof(descHeader))
+            return false;
+        std::memcpy(&descHeader, data, sizeof(descHeader));
+        data += sizeof(descHeader);
+
+        if (std::size_t(end - data) < descHeader.storedSize)
+            return false;
+
+        const std::uint8_t* payload = data;
+        data += descHeader.storedSize;
+
+        const feature::EImageDescriberType descType = static_cast<feature::EImageDescriberType>(descHeader.descType);
+
+        // skip the filtered descriptor types without decompression
+        if (!descTypesFilter.empty() && std::find(descTypesFilter.begin(), descTypesFilter.end(), descType) == descTypesFilter.end())
+            continue;
+
+        if (descHeader.storedSize != descHeader.rawSize)
+        {
+            buffer.resize(descHeader.rawSize);
+            uLongf rawSize = descHeader.rawSize;
+            if (uncompress(buffer.data(), &rawSize, payload, descHeader.storedSize) != Z_OK || rawSize != descHeader.rawSize)
+                return false;
+            payload = buffer.data();
+        }
+
+        if (!decodeMatches(payload, descHeader.rawSize, descHeader.nbMatches, out[descType]))
+            return false;
+    }
+    return data == end;
+}
+
+bool loadBinaryMatchFile(PairwiseMatches& matches,
+                         const std::string& filepath,
+                         const std::set<IndexT>& viewsKeysFilter,
+                         const std::vector<feature::EImageDescriberType>& descTypesFilter)
+{
+    namespace bip = boost::interprocess;
+
+    if (fs::file_size(filepath) < sizeof(BinaryMatchesHeader))
+    {
+        ALICEVISION_LOG_WARNING("Invalid binary match file: " << filepath);
+        return false;
+    }
+
+    bip::file_mapping mapping(filepath.c_str(), bip::read_only);
+    bip::mapped_region region(mapping, bip::read_only);
+
+    const std::uint8_t* data = static_cast<const std::uint8_t*>(region.get_address());
+    const std::size_t size = region.get_size();
+
+    BinaryMatchesHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, binaryMatchesMagic, sizeof(binaryMatchesMagic)) != 0 || header.version != binaryMatchesVersion)
+    {
+        ALICEVISION_LOG_WARNING("Invalid binary match file: " << filepath);
+        return false;
+    }
+
+    if (header.indexOffset > size || header.nbPairs > (size - header.indexOffset) / sizeof(BinaryMatchesIndexEntry))
+    {
+        ALICEVISION_LOG_WARNING("Truncated binary match file: " << filepath);
+        return false;
+    }
+
+    // the index is aligned in the file and read in place
+    const BinaryMatchesIndexEntry* indexBegin = reinterpret_cast<const BinaryMatchesIndexEntry*>(data + header.indexOffset);
+    const BinaryMatchesIndexEntry* indexEnd = indexBegin + header.nbPairs;
+
+    // select the pairs to decode
+    std::vector<const BinaryMatchesIndexEntry*> selectedEntries;
+    if (viewsKeysFilter.empty())
+    {
+        selectedEntries.reserve(header.nbPairs);
+        for (const BinaryMatchesIndexEntry* entry = indexBegin; entry != indexEnd; ++entry)
+            selectedEntries.push_back(entry);
+    }
+    else
+    {
+        // index sorted by pair: only visit the pairs starting with a filtered view
+        for (const IndexT I : viewsKeysFilter)
+        {
+            const BinaryMatchesIndexEntry* entry =
+              std::lower_bound(indexBegin, indexEnd, I, [](const BinaryMatchesIndexEntry& e, IndexT id) { return e.I < id; });
+
+            for (; entry != indexEnd && entry->I == I; ++entry)
+            {
+                if (viewsKeysFilter.count(entry->J))
+                    selectedEntries.push_back(entry);
+            }
+        }
+    }
+
+    for (const BinaryMatchesIndexEntry* entry : selectedEntries)
+    {
+        MatchesPerDescType pairMatches;
+        if (entry->offset > size || entry->size > size - entry->offset ||
+            !decodePairBlock(data + entry->offset, entry->size, descTypesFilter, pairMatches))
+        {
+            ALICEVISION_LOG_WARNING("Corrupted binary match file: " << filepath << " (pair " << entry->I << "-" << entry->J << ")");
+            return false;
+        }
+
+        MatchesPerDescType& outPairMatches = matches[std::make_pair(entry->I, entry->J)];
+        for (auto& matchesPerDesc : pairMatches)
+            outPairMatches[matchesPerDesc.first] = std::move(matchesPerDesc.second);
+    }
+    return true;
+}
+
+}  // namespace
+
+void saveBinaryMatchFile(const std::string& filepath,
+                         const PairwiseMatches::const_iterator& matchBegin,
+                         const PairwiseMatches::const_iterator& matchEnd,
+                         bool compress)
+{
+    std::ofstream stream(filepath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!stream.is_open())
+        throw std::runtime_error("Can't write binary match file: " + filepath);
+
+    BinaryMatchesHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, binaryMatchesMagic, sizeof(header.magic));
+    header.version = binaryMatchesVersion;
+    header.flags = compress ? binaryMatchesFlagCompressed : 0;
+
+    // header is written again at the end, with the index offset
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::uint64_t offset = sizeof(header);
+
+    std::vector<BinaryMatchesIndexEntry> index;
+    std::vector<std::uint8_t> rawPayload;
+    std::vector<std::uint8_t> compressedPayload;
+
+    for (PairwiseMatches::const_iterator match = matchBegin; match != matchEnd; ++match)
+    {
+        const MatchesPerDescType& matchesPerDesc = match->second;
+
+        BinaryMatchesIndexEntry entry;
+        entry.I = static_cast<std::uint32_t>(match->first.first);
+        entry.J = static_cast<std::uint32_t>(match->first.second);
+        entry.offset = offset;
+
+        const std::uint32_t nbDescTypes = static_cast<std::uint32_t>(matchesPerDesc.size());
+        stream.write(reinterpret_cast<const char*>(&nbDescTypes), sizeof(nbDescTypes));
+        offset += sizeof(nbDescTypes);
+
+        for (const auto& m : matchesPerDesc)
+        {
+            encodeMatches(m.second, rawPayload);
+
+            BinaryMatchesDescHeader descHeader;
+            descHeader.descType = static_cast<std::uint32_t>(m.first);
+            descHeader.nbMatches = static_cast<std::uint32_t>(m.second.size());
+            descHeader.rawSize = static_cast<std::uint32_t>(rawPayload.size());
+            descHeader.storedSize = descHeader.rawSize;
+
+            const std::vector<std::uint8_t>* payload = &rawPayload;
+
+            if (compress && !rawPayload.empty())
+            {
+                uLongf compressedSize = compressBound(rawPayload.size());
+                compressedPayload.resize(compressedSize);
+                // keep the raw payload if compression does not reduce the size
+                if (compress2(compressedPayload.data(), &compressedSize, rawPayload.data(), rawPayload.size(), Z_DEFAULT_COMPRESSION) == Z_OK &&
+                    compressedSize < rawPayload.size())
+                {
+                    compressedPayload.resize(compressedSize);
+                    descHeader.storedSize = static_cast<std::uint32_t>(compressedSize);
+                    payload = &compressedPayload;
+                }
+            }
+
+            stream.write(reinterpret_cast<const char*>(&descHeader), sizeof(descHeader));
+            stream.write(reinterpret_cast<const char*>(payload->data()), payload->size());
+            offset += sizeof(descHeader) + payload->size();
+        }
+
+        entry.size = offset - entry.offset;
+        index.push_back(entry);
+    }
+
+    // index aligned for in place access
+    const std::uint64_t alignedOffset = (offset + 7) / 8 * 8;
+    const char zeros[8] = {0};
+    stream.write(zeros, alignedOffset - offset);
+
+    // PairwiseMatches is ordered by pair, the index is already sorted
+    header.nbPairs = index.size();
+    header.indexOffset = alignedOffset;
+    stream.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(BinaryMatchesIndexEntry));
+
+    stream.seekp(0);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (!stream.good())
+        throw std::runtime_error("Can't write binary match file: " + filepath);
+}
+
+void filterMatchesByViews(PairwiseMatches& matches, const std::set<IndexT>& viewsKeys)
+{
+    for (matching::PairwiseMatches::iterator iter = matches.begin(); iter != matches.end();)
+    {
+        if (viewsKeys.find(iter->first.first) != viewsKeys.end() && viewsKeys.find(iter->first.second) != viewsKeys.end())
+            ++iter;
+        else
+            iter = matches.erase(iter);
+    }
+}
+
+void filterTopMatches(PairwiseMatches& allMatches, int maxNum, int minNum)
+{
+    if (maxNum <= 0 && minNum <= 0)
+        return;
+    if (maxNum > 0 && minNum > maxNum)
+        throw std::runtime_error("The minimum number of matches is higher than the maximum.");
+
+    for (auto& matchesPerDesc : allMatches)
+    {
+        for (auto& matches : matchesPerDesc.second)
+        {
+            IndMatches& m = matches.second;
+            if (minNum > 0 && m.size() < minNum)
+                m.clear();
+            else if (maxNum > 0 && m.size() > maxNum)
+                m.erase(m.begin() + maxNum, m.end());
+        }
+    }
+}
+
+void filterMatchesByDesc(PairwiseMatches& allMatches, const std::vector<feature::EImageDescriberType>& descTypesFilter)
+{
+    for (matching::PairwiseMatches::iterator iter = allMatches.begin(); iter != allMatches.end();)
+    {
+        MatchesPerDescType& matchesPerDesc = iter->second;
+        for (MatchesPerDescType::iterator matches = matchesPerDesc.begin(); matches != matchesPerDesc.end();)
+        {
+            // if current descType not in descTypesFilter
+            if (std::find(descTypesFilter.begin(), descTypesFilter.end(), matches->first) == descTypesFilter.end())
+                matches = matchesPerDesc.erase(matches);
+            else
+                ++matches;
+        }
+
+        if (matchesPerDesc.empty())
+            iter = allMatches.erase(iter);
+        else
+            ++iter;
+    }
+}
+
+bool LoadMatchFile(PairwiseMatches& matches,
+                   const std::string& filepath,
+                   const std::set<IndexT>& viewsKeysFilter,
+                   const std::vector<feature::EImageDescriberType>& descTypesFilter)
 {
     const std::string ext = fs::extension(filepath);
 
@@ -46,6 +434,7 @@ bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath)
         // descType matchesCount
         // idx idx
         // ...
+        PairwiseMatches fileMatches;
         std::size_t I = 0;
         std::size_t J = 0;
         std::size_t nbDescType = 0;
@@ -65,66 +454,32 @@ bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath)
                 {
                     stream >> matchesPerDesc[i];
                 }
-                matches[std::make_pair(I, J)][descType] = std::move(matchesPerDesc);
+                fileMatches[std::make_pair(I, J)][descType] = std::move(matchesPerDesc);
             }
         }
         stream.close();
-        return true;
-    }
-    else
-    {
-        ALICEVISION_LOG_WARNING("Unknown matching file format: " << ext);
-    }
-    return false;
-}
 
-void filterMatchesByViews(PairwiseMatches& matches, const std::set<IndexT>& viewsKeys)
-{
-    matching::PairwiseMatches filteredMatches;
-    for (matching::PairwiseMatches::const_iterator iter = matches.begin(); iter != matches.end(); ++iter)
-    {
-        if (viewsKeys.find(iter->first.first) != viewsKeys.end() && viewsKeys.find(iter->first.second) != viewsKeys.end())
+        if (!viewsKeysFilter.empty())
+            filterMatchesByViews(fileMatches, viewsKeysFilter);
+        if (!descTypesFilter.empty())
+            filterMatchesByDesc(fileMatches, descTypesFilter);
+
+        for (auto& pairMatches : fileMatches)
         {
-            filteredMatches.insert(*iter);
+            for (auto& matchesPerDesc : pairMatches.second)
+                matches[pairMatches.first][matchesPerDesc.first] = std::move(matchesPerDesc.second);
         }
+        return true;
     }
-    matches.swap(filteredMatches);
-}
-
-void filterTopMatches(PairwiseMatches& allMatches, int maxNum, int minNum)
-{
-    if (maxNum <= 0 && minNum <= 0)
-        return;
-    if (maxNum > 0 && minNum > maxNum)
-        throw std::runtime_error("The minimum number of matches is higher than the maximum.");
-
-    for (auto& matchesPerDesc : allMatches)
+    else if (ext == ".bin")
     {
-        for (auto& matches : matchesPerDesc.second)
-        {
-            IndMatches& m = matches.second;
-            if (minNum > 0 && m.size() < minNum)
-                m.clear();
-            else if (maxNum > 0 && m.size() > maxNum)
-                m.erase(m.begin() + maxNum, m.end());
-        }
+        return loadBinaryMatchFile(matches, filepath, viewsKeysFilter, descTypesFilter);
     }
-}
-
-void filterMatchesByDesc(PairwiseMatches& allMatches, const std::vector<feature::EImageDescriberType>& descTypesFilter)
-{
-    matching::PairwiseMatches filteredMatches;
-    for (const auto& matchesPerDesc : allMatches)
+    else
     {
-        for (const auto& matches : matchesPerDesc.second)
-        {
-            const IndMatches& m = matches.second;
-            // if current descType in descTypesFilter
-            if (std::find(descTypesFilter.begin(), descTypesFilter.end(), matches.first) != descTypesFilter.end())
-                filteredMatches[matchesPerDesc.first][matches.first] = m;
-        }
+        ALICEVISION_LOG_WARNING("Unknown matching file format: " << ext);
     }
-    allMatches.swap(filteredMatches);
+    return false;
 }
 
 std::size_t LoadMatchFilePerImage(PairwiseMatches& matches,
@@ -164,21 +519,28 @@ std::size_t LoadMatchFilePerImage(PairwiseMatches& matches,
 }
 
 /**
- * Load and add pair-wise matches to \p matches from all files in \p folder matching \p pattern.
+ * Load and add pair-wise matches to \p matches from all files in \p folder matching one of the \p patterns.
  * @param[out] matches PairwiseMatches to add loaded matches to
  * @param[in] folder Folder to load matches files from
- * @param[in] pattern Pattern that files must respect to be loaded
+ * @param[in] patterns Patterns that files must respect to be loaded
+ * @param[in] viewsKeysFilter Restrict the matches to these views (empty takes all views)
+ * @param[in] descTypesFilter Restrict the matches to these types of descriptors (empty takes all types)
  */
-std::size_t loadMatchesFromFolder(PairwiseMatches& matches, const std::string& folder, const std::string& pattern)
+std::size_t loadMatchesFromFolder(PairwiseMatches& matches,
+                                  const std::string& folder,
+                                  const std::vector<std::string>& patterns,
+                                  const std::set<IndexT>& viewsKeysFilter,
+                                  const std::vector<feature::EImageDescriberType>& descTypesFilter)
 {
     std::size_t nbLoadedMatchFiles = 0;
     std::vector<std::string> matchFiles;
-    // list all matches files in 'folder' matching (i.e containing) 'pattern'
+    // list all matches files in 'folder' matching (i.e containing) one of the 'patterns'
     for (const auto& entry : boost::make_iterator_range(fs::directory_iterator(folder), {}))
     {
-        if (entry.path().string().find(pattern) != std::string::npos)
+        const std::string path = entry.path().string();
+        if (std::any_of(patterns.begin(), patterns.end(), [&path](const std::string& pattern) { return path.find(pattern) != std::string::npos; }))
         {
-            matchFiles.push_back(entry.path().string());
+            matchFiles.push_back(path);
         }
     }
 
@@ -188,7 +550,7 @@ std::size_t loadMatchesFromFolder(PairwiseMatches& matches, const std::string& f
         const std::string& matchFile = matchFiles[i];
         PairwiseMatches fileMatches;
         ALICEVISION_LOG_DEBUG("Loading match file: " << matchFile);
-        if (!LoadMatchFile(fileMatches, matchFile))
+        if (!LoadMatchFile(fileMatches, matchFile, viewsKeysFilter, descTypesFilter))
         {
             ALICEVISION_LOG_WARNING("Unable to load match file: " << matchFile);
             continue;
@@ -225,7 +587,7 @@ bool Load(PairwiseMatches& matches,
           int minNbMatches)
 {
     std::size_t nbLoadedMatchFiles = 0;
-    const std::string pattern = "matches.txt";
+    const std::vector<std::string> patterns = {"matches.txt", "matches.bin"};
 
     // build up a set with normalized paths to remove duplicates
     std::set<std::string> foldersSet;
@@ -239,7 +601,7 @@ bool Load(PairwiseMatches& matches,
 
     for (const auto& folder : foldersSet)
     {
-        nbLoadedMatchFiles += loadMatchesFromFolder(matches, folder, pattern);
+        nbLoadedMatchFiles += loadMatchesFromFolder(matches, folder, patterns, viewsKeysFilter, descTypesFilter);
     }
 
     if (!nbLoadedMatchFiles)
@@ -259,6 +621,7 @@ bool Load(PairwiseMatches& matches,
     ALICEVISION_LOG_TRACE("Matches per image pair (before filtering):");
     logMatches(matches);
 
+    // match files are already filtered while loading, this only applies to the input matches
     if (!viewsKeysFilter.empty())
         filterMatchesByViews(matches, viewsKeysFilter);
 
@@ -276,38 +639,48 @@ bool Load(PairwiseMatches& matches,
 class MatchExporter
 {
   private:
-    void saveTxt(const std::string& filepath, const PairwiseMatches::const_iterator& matchBegin, const PairwiseMatches::const_iterator& matchEnd)
+    void save(const std::string& filepath, const PairwiseMatches::const_iterator& matchBegin, const PairwiseMatches::const_iterator& matchEnd)
     {
+        if (m_ext != ".txt" && m_ext != ".bin")
+            throw std::runtime_error(std::string("Unknown matching file format: ") + m_ext);
+
         const fs::path bPath = fs::path(filepath);
         const std::string tmpPath = (bPath.parent_path() / bPath.stem()).string() + "." + fs::unique_path().string() + bPath.extension().string();
 
         // write temporary file
+        if (m_ext == ".txt")
+            saveTxt(tmpPath, matchBegin, matchEnd);
+        else
+            saveBinaryMatchFile(tmpPath, matchBegin, matchEnd, m_compress);
+
+        // rename temporary file
+        fs::rename(tmpPath, filepath);
+    }
+
+    void saveTxt(const std::string& filepath, const PairwiseMatches::const_iterator& matchBegin, const PairwiseMatches::const_iterator& matchEnd)
+    {
+        std::ofstream stream(filepath, std::ios::out);
+        for (PairwiseMatches::const_iterator match = matchBegin; match != matchEnd; ++match)
         {
-            std::ofstream stream(tmpPath, std::ios::out);
-            for (PairwiseMatches::const_iterator match = matchBegin; match != matchEnd; ++match)
+            const std::size_t I = match->first.first;
+            const std::size_t J = match->first.second;
+            const MatchesPerDescType& matchesPerDesc = match->second;
+            stream << I << " " << J << '\n' << matchesPerDesc.size() << '\n';
+            for (const auto& m : matchesPerDesc)
             {
-                const std::size_t I = match->first.first;
-                const std::size_t J = match->first.second;
-                const MatchesPerDescType& matchesPerDesc = match->second;
-                stream << I << " " << J << '\n' << matchesPerDesc.size() << '\n';
-                for (const auto& m : matchesPerDesc)
-                {
-                    stream << feature::EImageDescriberType_enumToString(m.first) << " " << m.second.size() << '\n';
-                    copy(m.second.begin(), m.second.end(), std::ostream_iterator<IndMatch>(stream, "\n"));
-                }
+                stream << feature::EImageDescriberType_enumToString(m.first) << " " << m.second.size() << '\n';
+                copy(m.second.begin(), m.second.end(), std::ostream_iterator<IndMatch>(stream, "\n"));
             }
         }
-
-        // rename temporary file
-        fs::rename(tmpPath, filepath);
     }
 
   public:
-    MatchExporter(const PairwiseMatches& matches, const std::string& folder, const std::string& filename)
+    MatchExporter(const PairwiseMatches& matches, const std::string& folder, const std::string& filename, bool compress)
       : m_matches(matches),
         m_directory(folder),
         m_filename(filename),
-        m_ext(fs::extension(filename))
+        m_ext(fs::extension(filename)),
+        m_compress(compress)
     {}
 
     ~MatchExporter() = default;
@@ -316,10 +689,7 @@ class MatchExporter
     {
         const std::string filepath = (fs::path(m_directory) / m_filename).string();
 
-        if (m_ext == ".txt")
-            saveTxt(filepath, m_matches.begin(), m_matches.end());
-        else
-            throw std::runtime_error(std::string("Unknown matching file format: ") + m_ext);
+        save(filepath, m_matches.begin(), m_matches.end());
     }
 
     /// Export matches into separate files, one for each image.
@@ -339,10 +709,7 @@ class MatchExporter
             const std::string filepath = (fs::path(m_directory) / (std::to_string(key) + "." + m_filename)).string();
             ALICEVISION_LOG_DEBUG("Export Matches in: " << filepath);
 
-            if (m_ext == ".txt")
-                saveTxt(filepath, matchBegin, match);
-            else
-                throw std::runtime_error(std::string("Unknown matching file format: ") + m_ext);
+            save(filepath, matchBegin, match);
 
             matchBegin = match;
         }
@@ -353,12 +720,18 @@ class MatchExporter
     const std::string m_ext;
     std::string m_directory;
     std::string m_filename;
+    bool m_compress;
 };
 
-bool Save(const PairwiseMatches& matches, const std::string& folder, const std::string& extension, bool matchFilePerImage, const std::string& prefix)
+bool Save(const PairwiseMatches& matches,
+          const std::string& folder,
+          const std::string& extension,
+          bool matchFilePerImage,
+          const std::string& prefix,
+          bool compress)
 {
     const std::string filename = prefix + "matches." + extension;
-    MatchExporter exporter(matches, folder, filename);
+    MatchExporter exporter(matches, folder, filename, compress);
 
     if (matchFilePerImage)
         exporter.saveOneFilePerImage();
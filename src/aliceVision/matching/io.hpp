@@ -9,7 +9,9 @@
 
 #include <aliceVision/matching/IndMatch.hpp>
 
+#include <set>
 #include <string>
+#include <vector>
 
 namespace aliceVision {
 namespace matching {
@@ -17,10 +19,38 @@ namespace matching {
 /**
  * @brief Load a match file.
  *
+ * Text files (.txt) are parsed entirely and filtered afterwards.
+ * Binary files (.bin) are memory-mapped and only the pairs and descriptor types
+ * that pass the filters are decoded, using the pair index of the file.
+ *
  * @param[out] matches container for the output matches
  * @param[in] filepath the match file to load
+ * @param[in] viewsKeysFilter restrict the matches to the pairs of these views (empty takes all pairs)
+ * @param[in] descTypesFilter restrict the matches to these types of descriptors (empty takes all types)
  */
-bool LoadMatchFile(PairwiseMatches& matches, const std::string& filepath);
+bool LoadMatchFile(PairwiseMatches& matches,
+                   const std::string& filepath,
+                   const std::set<IndexT>& viewsKeysFilter = {},
+                   const std::vector<feature::EImageDescriberType>& descTypesFilter = {});
+
+/**
+ * @brief Save matches in a binary match file.
+ *
+ * Layout (native little-endian):
+ * - header: magic, version, flags, number of pairs, index offset
+ * - per pair block: per descriptor type, the feature ids delta-encoded (zigzag varints),
+ *   optionally compressed with zlib
+ * - index: one entry per pair (I, J, block offset and size), sorted by pair
+ *
+ * @param[in] filepath the output file
+ * @param[in] matchBegin first pair to save
+ * @param[in] matchEnd end of the pairs to save
+ * @param[in] compress compress the matches blocks
+ */
+void saveBinaryMatchFile(const std::string& filepath,
+                         const PairwiseMatches::const_iterator& matchBegin,
+                         const PairwiseMatches::const_iterator& matchEnd,
+                         bool compress = false);
 
 /**
  * @brief Load the match file for each image.
@@ -56,6 +86,13 @@ bool Load(PairwiseMatches& matches,
           int maxNbMatches = 0,
           int minNbMatches = 0);
 
+/**
+ * @brief Filter to keep only specific types of descriptors.
+ * @param[in,out] allMatches the matches to filter.
+ * @param[in] descTypesFilter the list of descriptor types to keep.
+ */
+void filterMatchesByDesc(PairwiseMatches& allMatches, const std::vector<feature::EImageDescriberType>& descTypesFilter);
+
 /**
  * @brief Filter to keep only specific viewIds.
  * @param[in,out] matches the matches to filter.
@@ -80,12 +117,14 @@ void filterTopMatches(PairwiseMatches& allMatches, int maxNum, int minNum);
  * @param[in] matchFilePerImage: do we store a global match file
  *            or one match file per image
  * @param[in] prefix: optional prefix for the output file(s)
+ * @param[in] compress: compress the matches (bin file format only)
  */
 bool Save(const PairwiseMatches& matches,
           const std::string& folder,
           const std::string& extension,
           bool matchFilePerImage,
-          const std::string& prefix = "");
+          const std::string& prefix = "",
+          bool compress = false);
 
 }  // namespace matching
 }  // namespace aliceVision
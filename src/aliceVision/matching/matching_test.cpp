@@ -7,8 +7,12 @@
 
 #include "aliceVision/numeric/numeric.hpp"
 #include "aliceVision/matching/ArrayMatcher_bruteForce.hpp"
+#include "aliceVision/matching/ArrayMatcher_bruteForceBatched.hpp"
 #include "aliceVision/matching/ArrayMatcher_kdtreeFlann.hpp"
 #include "aliceVision/matching/ArrayMatcher_cascadeHashing.hpp"
+#include "aliceVision/matching/hashedDescriptionsIO.hpp"
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 
 #define BOOST_TEST_MODULE matching
@@ -88,6 +92,86 @@ BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_bruteForce_Simple_Dim4)
     BOOST_CHECK_SMALL(static_cast<double>(fDistance), 1e-8);  // distance
 }
 
+BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_bruteForceBatched_NN)
+{
+    std::mt19937 gen(0);
+
+    const float array[] = {0, 1, 2, 5, 6};
+    ArrayMatcher_bruteForceBatched<float> matcher(2, 2);
+    BOOST_CHECK(matcher.Build(gen, array, 5, 1));
+
+    const float query[] = {2};
+    IndMatches vec_nIndice;
+    std::vector<float> vec_fDistance;
+    BOOST_CHECK(matcher.SearchNeighbours(query, 1, &vec_nIndice, &vec_fDistance, 5));
+
+    BOOST_CHECK_EQUAL(5, vec_nIndice.size());
+    BOOST_CHECK_EQUAL(5, vec_fDistance.size());
+
+    const std::vector<int> expectedIndexes = {2, 1, 0, 3, 4};
+    for (int i = 0; i < 5; ++i)
+    {
+        BOOST_CHECK_EQUAL(IndMatch(0, expectedIndexes[i]), vec_nIndice[i]);
+        BOOST_CHECK_SMALL(static_cast<double>(vec_fDistance[i] - Square(array[expectedIndexes[i]] - 2.0f)), 1e-6);
+    }
+
+    // more neighbours than database rows
+    BOOST_CHECK(!matcher.SearchNeighbours(query, 1, &vec_nIndice, &vec_fDistance, 6));
+}
+
+BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_bruteForceBatched_vs_bruteForce)
+{
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> distribution(0, 255);
+
+    const int dimension = 128;
+    const int nbDatabase = 300;
+    const std::vector<int> nbQueries = {100, 0, 7, 65};
+
+    std::vector<unsigned char> database(nbDatabase * dimension);
+    for (unsigned char& v : database)
+        v = static_cast<unsigned char>(distribution(gen));
+
+    std::vector<std::vector<unsigned char>> queries(nbQueries.size());
+    std::vector<const unsigned char*> queryPtrs;
+    for (std::size_t s = 0; s < nbQueries.size(); ++s)
+    {
+        queries[s].resize(nbQueries[s] * dimension + 1);
+        for (unsigned char& v : queries[s])
+            v = static_cast<unsigned char>(distribution(gen));
+        queryPtrs.push_back(queries[s].data());
+    }
+
+    typedef feature::L2_Vectorized<unsigned char> MetricT;
+    ArrayMatcher_bruteForce<unsigned char, MetricT> reference;
+    BOOST_CHECK(reference.Build(gen, database.data(), nbDatabase, dimension));
+
+    // block sizes smaller than and not multiple of the data sizes
+    ArrayMatcher_bruteForceBatched<unsigned char, MetricT> matcher(16, 100);
+    BOOST_CHECK(matcher.Build(gen, database.data(), nbDatabase, dimension));
+
+    std::vector<IndMatches> indices;
+    std::vector<std::vector<float>> distances;
+    BOOST_CHECK(matcher.SearchNeighboursBatch(queryPtrs, nbQueries, &indices, &distances, 2));
+    BOOST_CHECK_EQUAL(indices.size(), nbQueries.size());
+
+    for (std::size_t s = 0; s < nbQueries.size(); ++s)
+    {
+        BOOST_CHECK_EQUAL(indices[s].size(), nbQueries[s] * 2);
+        if (nbQueries[s] == 0)
+            continue;
+
+        IndMatches refIndices;
+        std::vector<float> refDistances;
+        BOOST_CHECK(reference.SearchNeighbours(queryPtrs[s], nbQueries[s], &refIndices, &refDistances, 2));
+
+        // integer descriptors give the exact same distances
+        BOOST_CHECK_EQUAL_COLLECTIONS(distances[s].begin(), distances[s].end(), refDistances.begin(), refDistances.end());
+        for (std::size_t i = 0; i < refIndices.size(); i += 2)
+            BOOST_CHECK_EQUAL(indices[s][i], refIndices[i]);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(Matching_ArrayMatcher_kdtreeFlann_Simple__NN)
 {
     std::random_device rd;
@@ -166,3 +250,119 @@ BOOST_AUTO_TEST_CASE(Matching_Cascade_Hashing_Simple_EmptyArrays)
     float fDistance = -1.0f;
     BOOST_CHECK(!matcher.SearchNeighbour(&array[0], &nIndice, &fDistance));
 }
+
+BOOST_AUTO_TEST_CASE(Matching_Cascade_Hashing_NN)
+{
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> distribution(0, 255);
+    std::uniform_int_distribution<int> noise(-2, 2);
+
+    const int dimension = 128;
+    const int nbDatabase = 500;
+
+    std::vector<unsigned char> database(nbDatabase * dimension);
+    for (unsigned char& v : database)
+        v = static_cast<unsigned char>(distribution(gen));
+
+    // queries: noisy copies of the database descriptors
+    std::vector<unsigned char> queries(database.size());
+    for (std::size_t i = 0; i < database.size(); ++i)
+        queries[i] = static_cast<unsigned char>(std::clamp(database[i] + noise(gen), 0, 255));
+
+    ArrayMatcher_cascadeHashing<unsigned char> matcher;
+    BOOST_CHECK(matcher.Build(gen, database.data(), nbDatabase, dimension));
+
+    IndMatches indices;
+    std::vector<float> distances;
+    BOOST_CHECK(matcher.SearchNeighbours(queries.data(), nbDatabase, &indices, &distances, 2));
+
+    // queries without enough candidates in their buckets are not matched
+    int nbFound = 0;
+    for (std::size_t k = 0; k < indices.size(); k += 2)
+    {
+        BOOST_CHECK_EQUAL(indices[k]._i, indices[k + 1]._i);
+        BOOST_CHECK_LE(distances[k], distances[k + 1]);
+        if (indices[k]._j == indices[k]._i)
+            ++nbFound;
+    }
+    BOOST_CHECK_GE(nbFound, nbDatabase * 90 / 100);
+}
+
+BOOST_AUTO_TEST_CASE(Matching_Cascade_Hashing_SaveLoad)
+{
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<float> distribution(0.f, 1.f);
+
+    const int dimension = 128;
+    const int nbDescriptions = 300;
+
+    Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> descriptions(nbDescriptions, dimension);
+    for (int i = 0; i < descriptions.size(); ++i)
+        descriptions.data()[i] = distribution(gen);
+
+    CascadeHasher hasher;
+    BOOST_CHECK(hasher.Init(gen, dimension));
+    const Eigen::VectorXf zeroMean = CascadeHasher::GetZeroMeanDescriptor(descriptions);
+    const HashedDescriptions hashed = hasher.CreateHashedDescriptions(descriptions, zeroMean);
+    BOOST_CHECK_EQUAL(hashed.size(), nbDescriptions);
+    BOOST_CHECK_EQUAL(hashed.nb_hash_words, 2);
+
+    // the key depends on the projections and on the zero mean descriptor
+    const uint64_t key = hasher.GetFingerprint(zeroMean);
+    BOOST_CHECK_NE(key, hasher.GetFingerprint(Eigen::VectorXf::Zero(dimension)));
+    CascadeHasher otherHasher;
+    BOOST_CHECK(otherHasher.Init(gen, dimension));
+    BOOST_CHECK_NE(key, otherHasher.GetFingerprint(zeroMean));
+
+    const std::string filepath = "matching_test_hashedDescriptions.hashed";
+    BOOST_CHECK(saveHashedDescriptions(filepath, key, hashed));
+
+    HashedDescriptions loaded;
+    BOOST_CHECK(!loadHashedDescriptions(filepath, key + 1, nbDescriptions, loaded));
+    BOOST_CHECK(!loadHashedDescriptions(filepath, key, nbDescriptions + 1, loaded));
+    BOOST_CHECK(loadHashedDescriptions(filepath, key, nbDescriptions, loaded));
+    std::remove(filepath.c_str());
+
+    BOOST_CHECK(hasher.IsCompatible(loaded));
+    hasher.BuildBuckets(loaded);
+    BOOST_CHECK(loaded.hash_codes == hashed.hash_codes);
+    BOOST_CHECK(loaded.bucket_ids == hashed.bucket_ids);
+    BOOST_CHECK(loaded.buckets == hashed.buckets);
+
+    // same matches with the loaded hashed descriptions
+    IndMatches indices;
+    IndMatches loadedIndices;
+    std::vector<float> distances;
+    std::vector<float> loadedDistances;
+    hasher.Match_HashedDescriptions(hashed, descriptions, hashed, descriptions, &indices, &distances);
+    hasher.Match_HashedDescriptions(loaded, descriptions, loaded, descriptions, &loadedIndices, &loadedDistances);
+    BOOST_CHECK(indices == loadedIndices);
+    BOOST_CHECK_EQUAL_COLLECTIONS(distances.begin(), distances.end(), loadedDistances.begin(), loadedDistances.end());
+    for (std::size_t k = 0; k < indices.size(); k += 2)
+        BOOST_CHECK_EQUAL(indices[k]._j, indices[k]._i);
+
+    // invalid bucket ids (e.g. a corrupted file) are rejected before building the buckets
+    HashedDescriptions corrupted = loaded;
+    corrupted.bucket_ids[0] = uint16_t(1) << hasher.GetNbBitsPerBucket();
+    BOOST_CHECK(!hasher.IsCompatible(corrupted));
+
+    // the key of the descriptions changes with the descriptors, even with the same number of descriptions
+    const std::size_t descriptionsSize = descriptions.size() * sizeof(float);
+    const uint64_t descriptionsKey = computeDescriptionsKey(descriptions.data(), descriptionsSize);
+    BOOST_CHECK_EQUAL(descriptionsKey, computeDescriptionsKey(descriptions.data(), descriptionsSize));
+    Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> otherDescriptions = descriptions;
+    otherDescriptions(nbDescriptions - 1, dimension - 1) += 1.f;
+    BOOST_CHECK_NE(descriptionsKey, computeDescriptionsKey(otherDescriptions.data(), descriptionsSize));
+    BOOST_CHECK_NE(descriptionsKey, computeDescriptionsKey(descriptions.data(), descriptionsSize, key));
+
+    const std::string zeroMeanFilepath = "matching_test_zeroMean.bin";
+    const std::map<IndexT, uint64_t> inputsKeys = {{0, descriptionsKey}, {5, key}};
+    Eigen::VectorXf loadedZeroMean;
+    std::map<IndexT, uint64_t> loadedInputsKeys;
+    BOOST_CHECK(saveZeroMeanDescriptor(zeroMeanFilepath, zeroMean, inputsKeys));
+    BOOST_CHECK(!loadZeroMeanDescriptor(zeroMeanFilepath, dimension + 1, loadedZeroMean, loadedInputsKeys));
+    BOOST_CHECK(loadZeroMeanDescriptor(zeroMeanFilepath, dimension, loadedZeroMean, loadedInputsKeys));
+    std::remove(zeroMeanFilepath.c_str());
+    BOOST_CHECK(loadedZeroMean == zeroMean);
+    BOOST_CHECK(loadedInputsKeys == inputsKeys);
+}
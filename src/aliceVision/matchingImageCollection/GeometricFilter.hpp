@@ -8,14 +8,19 @@
 #pragma once
 
 #include <aliceVision/config.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/feature/PointFeature.hpp>
 #include <aliceVision/feature/RegionsPerView.hpp>
+#include <aliceVision/feature/RegionsProvider.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix.hpp>
 #include <aliceVision/system/ProgressDisplay.hpp>
 
 #include <map>
 #include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace aliceVision {
@@ -24,49 +29,83 @@ namespace matchingImageCollection {
 using namespace aliceVision::matching;
 
 /**
- * @brief Perform robust model estimation (with optional guided_matching)
- * or all the pairs and regions correspondences contained in the putativeMatches set.
- * Allow to keep only geometrically coherent matches.
- * It discards pairs that do not lead to a valid robust model estimation.
- * @param[out] geometricMatches
- * @param[in] sfmData
- * @param[in] regionsPerView
- * @param[in] functor
- * @param[in] putativeMatches
- * @param[in] guidedMatching
- * @param[in] distanceRatio
- * @param[in] randomNumberGenerator
+ * @brief Create the random number generator used for the robust estimation of an image pair.
+ * It only depends on the base seed and on the pair, so the estimation of a pair does not depend
+ * on the order in which the pairs are processed, nor on the number of threads or processes.
+ * @param[in] baseSeed The seed shared by all the pairs
+ * @param[in] pair The image pair
+ */
+inline std::mt19937 createPairRandomNumberGenerator(std::mt19937::result_type baseSeed, const Pair& pair)
+{
+    std::seed_seq seedSequence{baseSeed, std::mt19937::result_type(pair.first), std::mt19937::result_type(pair.second)};
+    return std::mt19937(seedSequence);
+}
+
+/**
+ * @brief Get the range of the pairs processed by a shard, when the pairs are split across several processes.
+ * @param[in] nbPairs The total number of pairs
+ * @param[in] shardIndex The shard index in [0, nbShards[
+ * @param[in] nbShards The number of shards
+ * @return The [begin, end[ range of the pair indices
+ */
+inline std::pair<std::size_t, std::size_t> getPairsShardRange(std::size_t nbPairs, int shardIndex, int nbShards)
+{
+    if (nbShards <= 1)
+        return {0, nbPairs};
+    if (shardIndex < 0 || shardIndex >= nbShards)
+        throw std::out_of_range("Invalid shard index " + std::to_string(shardIndex) + " for " + std::to_string(nbShards) + " shards.");
+    return {nbPairs * shardIndex / nbShards, nbPairs * (shardIndex + 1) / nbShards};
+}
+
+namespace impl {
+
+/**
+ * @brief Get the pairs of a shard, flattened for a constant time access.
+ */
+inline std::vector<const PairwiseMatches::value_type*> getShardPairs(const PairwiseMatches& putativeMatches, int shardIndex, int nbShards)
+{
+    const std::pair<std::size_t, std::size_t> shardRange = getPairsShardRange(putativeMatches.size(), shardIndex, nbShards);
+    std::vector<const PairwiseMatches::value_type*> pairs;
+    pairs.reserve(shardRange.second - shardRange.first);
+
+    PairwiseMatches::const_iterator iter = putativeMatches.begin();
+    std::advance(iter, shardRange.first);
+    for (std::size_t i = shardRange.first; i < shardRange.second; ++i, ++iter)
+        pairs.push_back(&(*iter));
+    return pairs;
+}
+
+/**
+ * @brief Perform the robust model estimation of the pairs [begin, end[ of the given list.
+ * @param[in,out] threadsGeometricMatches The results of each thread
  */
 template<typename GeometryFunctor>
-void robustModelEstimation(PairwiseMatches& out_geometricMatches,
+void robustModelEstimation(std::vector<std::vector<std::pair<Pair, MatchesPerDescType>>>& threadsGeometricMatches,
                            const sfmData::SfMData* sfmData,
                            const feature::RegionsPerView& regionsPerView,
                            const GeometryFunctor& functor,
-                           const PairwiseMatches& putativeMatches,
-                           std::mt19937& randomNumberGenerator,
-                           const bool guidedMatching = false,
-                           const double distanceRatio = 0.6)
+                           const std::vector<const PairwiseMatches::value_type*>& pairs,
+                           std::size_t begin,
+                           std::size_t end,
+                           std::mt19937::result_type baseSeed,
+                           const bool guidedMatching,
+                           const double distanceRatio,
+                           system::ProgressDisplay& progressDisplay)
 {
-    out_geometricMatches.clear();
-
-    auto progressDisplay = system::createConsoleProgressDisplay(putativeMatches.size(), std::cout, "Robust Model Estimation\n");
-
 #pragma omp parallel for schedule(dynamic)
-    for (int i = 0; i < (int)putativeMatches.size(); ++i)
+    for (int i = (int)begin; i < (int)end; ++i)
     {
-        PairwiseMatches::const_iterator iter = putativeMatches.begin();
-        std::advance(iter, i);
-
-        const Pair currentPair = iter->first;
-        const MatchesPerDescType& putativeMatchesPerType = iter->second;
-        const Pair& imagePair = iter->first;
+        const Pair& imagePair = pairs[i]->first;
+        const MatchesPerDescType& putativeMatchesPerType = pairs[i]->second;
 
         // apply the geometric filter (robust model estimation)
         {
+            std::mt19937 pairRandomNumberGenerator = createPairRandomNumberGenerator(baseSeed, imagePair);
+
             MatchesPerDescType inliers;
             GeometryFunctor geometricFilter = functor;  // use a copy since we are in a multi-thread context
             const EstimationStatus state =
-              geometricFilter.geometricEstimation(sfmData, regionsPerView, imagePair, putativeMatchesPerType, randomNumberGenerator, inliers);
+              geometricFilter.geometricEstimation(sfmData, regionsPerView, imagePair, putativeMatchesPerType, pairRandomNumberGenerator, inliers);
             if (state.hasStrongSupport)
             {
                 if (guidedMatching)
@@ -77,16 +116,133 @@ void robustModelEstimation(PairwiseMatches& out_geometricMatches,
                     std::swap(inliers, guidedGeometricInliers);
                 }
 
-#pragma omp critical
-                {
-                    out_geometricMatches.emplace(currentPair, std::move(inliers));
-                }
+                threadsGeometricMatches[omp_get_thread_num()].emplace_back(imagePair, std::move(inliers));
             }
         }
         ++progressDisplay;
     }
 }
 
+/**
+ * @brief Merge the results of each thread.
+ */
+inline void mergeGeometricMatches(PairwiseMatches& out_geometricMatches,
+                                  std::vector<std::vector<std::pair<Pair, MatchesPerDescType>>>& threadsGeometricMatches)
+{
+    for (auto& threadGeometricMatches : threadsGeometricMatches)
+    {
+        for (auto& geometricMatches : threadGeometricMatches)
+            out_geometricMatches.emplace(geometricMatches.first, std::move(geometricMatches.second));
+    }
+}
+
+}  // namespace impl
+
+/**
+ * @brief Perform robust model estimation (with optional guided_matching)
+ * or all the pairs and regions correspondences contained in the putativeMatches set.
+ * Allow to keep only geometrically coherent matches.
+ * It discards pairs that do not lead to a valid robust model estimation.
+ *
+ * Each pair uses its own random number generator, seeded from a single draw of randomNumberGenerator
+ * and from the pair (see createPairRandomNumberGenerator): the output is the same for any number of threads,
+ * and the union of the outputs of all the shards is the output without sharding.
+ *
+ * @param[out] geometricMatches
+ * @param[in] sfmData
+ * @param[in] regionsPerView
+ * @param[in] functor
+ * @param[in] putativeMatches
+ * @param[in] guidedMatching
+ * @param[in] distanceRatio
+ * @param[in] randomNumberGenerator
+ * @param[in] shardIndex Index of the shard of the pairs to process, in [0, nbShards[
+ * @param[in] nbShards Number of shards the pairs are split into, to distribute the pairs across processes
+ */
+template<typename GeometryFunctor>
+void robustModelEstimation(PairwiseMatches& out_geometricMatches,
+                           const sfmData::SfMData* sfmData,
+                           const feature::RegionsPerView& regionsPerView,
+                           const GeometryFunctor& functor,
+                           const PairwiseMatches& putativeMatches,
+                           std::mt19937& randomNumberGenerator,
+                           const bool guidedMatching = false,
+                           const double distanceRatio = 0.6,
+                           int shardIndex = 0,
+                           int nbShards = 1)
+{
+    out_geometricMatches.clear();
+
+    const std::mt19937::result_type baseSeed = randomNumberGenerator();
+    const std::vector<const PairwiseMatches::value_type*> pairs = impl::getShardPairs(putativeMatches, shardIndex, nbShards);
+
+    // results of each thread, merged at the end
+    std::vector<std::vector<std::pair<Pair, MatchesPerDescType>>> threadsGeometricMatches(omp_get_max_threads());
+
+    auto progressDisplay = system::createConsoleProgressDisplay(pairs.size(), std::cout, "Robust Model Estimation\n");
+
+    impl::robustModelEstimation(
+      threadsGeometricMatches, sfmData, regionsPerView, functor, pairs, 0, pairs.size(), baseSeed, guidedMatching, distanceRatio, progressDisplay);
+
+    impl::mergeGeometricMatches(out_geometricMatches, threadsGeometricMatches);
+}
+
+/**
+ * @brief Perform robust model estimation (with optional guided_matching), with the regions requested on demand
+ * to the regions provider: the pairs are processed by windows of consecutive pairs, only the regions of the views
+ * of the current window are in use, while the regions of the next window are prefetched.
+ *
+ * The output is the same as the robust model estimation with all the regions loaded.
+ *
+ * @param[out] geometricMatches
+ * @param[in] sfmData
+ * @param[in] regionsProvider
+ * @param[in] functor
+ * @param[in] putativeMatches
+ * @param[in] guidedMatching
+ * @param[in] distanceRatio
+ * @param[in] randomNumberGenerator
+ * @param[in] shardIndex Index of the shard of the pairs to process, in [0, nbShards[
+ * @param[in] nbShards Number of shards the pairs are split into, to distribute the pairs across processes
+ * @param[in] maxViewsPerWindow Maximum number of views of a window of pairs
+ */
+template<typename GeometryFunctor>
+void robustModelEstimation(PairwiseMatches& out_geometricMatches,
+                           const sfmData::SfMData* sfmData,
+                           feature::RegionsProvider& regionsProvider,
+                           const GeometryFunctor& functor,
+                           const PairwiseMatches& putativeMatches,
+                           std::mt19937& randomNumberGenerator,
+                           const bool guidedMatching = false,
+                           const double distanceRatio = 0.6,
+                           int shardIndex = 0,
+                           int nbShards = 1,
+                           std::size_t maxViewsPerWindow = 64)
+{
+    out_geometricMatches.clear();
+
+    const std::mt19937::result_type baseSeed = randomNumberGenerator();
+    const std::vector<const PairwiseMatches::value_type*> pairs = impl::getShardPairs(putativeMatches, shardIndex, nbShards);
+
+    PairVec imagePairs;
+    imagePairs.reserve(pairs.size());
+    for (const PairwiseMatches::value_type* pair : pairs)
+        imagePairs.push_back(pair->first);
+
+    // results of each thread, merged at the end
+    std::vector<std::vector<std::pair<Pair, MatchesPerDescType>>> threadsGeometricMatches(omp_get_max_threads());
+
+    auto progressDisplay = system::createConsoleProgressDisplay(pairs.size(), std::cout, "Robust Model Estimation\n");
+
+    feature::forEachPairsWindow(
+      regionsProvider, imagePairs, maxViewsPerWindow, [&](const feature::RegionsPerView& regionsPerView, std::size_t begin, std::size_t end) {
+          impl::robustModelEstimation(
+            threadsGeometricMatches, sfmData, regionsPerView, functor, pairs, begin, end, baseSeed, guidedMatching, distanceRatio, progressDisplay);
+      });
+
+    impl::mergeGeometricMatches(out_geometricMatches, threadsGeometricMatches);
+}
+
 /**
  * @brief removePoorlyOverlappingImagePairs Removes image pairs from the given list of geometric
  *  matches that have poor overlap according to the supplied criteria.
@@ -30,9 +30,12 @@ namespace matchingImageCollection {
  */
 struct GeometricFilterMatrix_E_AC : public GeometricFilterMatrix
 {
-    GeometricFilterMatrix_E_AC(double dPrecision = std::numeric_limits<double>::infinity(), std::size_t iteration = 1024)
+    GeometricFilterMatrix_E_AC(double dPrecision = std::numeric_limits<double>::infinity(),
+                               std::size_t iteration = 1024,
+                               robustEstimation::EACRansacScoring acRansacScoring = robustEstimation::EACRansacScoring::EXACT)
       : GeometricFilterMatrix(dPrecision, std::numeric_limits<double>::infinity(), iteration),
-        m_E(Mat3::Identity())
+        m_E(Mat3::Identity()),
+        m_acRansacScoring(acRansacScoring)
     {}
 
     /**
@@ -100,7 +103,7 @@ struct GeometricFilterMatrix_E_AC : public GeometricFilterMatrix
         std::vector<std::size_t> inliers;
         robustEstimation::Mat3Model model;
         const std::pair<double, double> ACRansacOut =
-          robustEstimation::ACRANSAC(kernel, randomNumberGenerator, inliers, m_stIteration, &model, upperBoundPrecision);
+          robustEstimation::ACRANSAC(kernel, randomNumberGenerator, inliers, m_stIteration, &model, upperBoundPrecision, m_acRansacScoring);
         m_E = model.getMatrix();
 
         if (inliers.empty())
@@ -176,6 +179,7 @@ struct GeometricFilterMatrix_E_AC : public GeometricFilterMatrix
 
     // stored data
     Mat3 m_E;
+    robustEstimation::EACRansacScoring m_acRansacScoring;
 };
 
 }  // namespace matchingImageCollection
@@ -37,11 +37,13 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
     GeometricFilterMatrix_F_AC(double dPrecision = std::numeric_limits<double>::infinity(),
                                std::size_t iteration = 1024,
                                robustEstimation::ERobustEstimator estimator = robustEstimation::ERobustEstimator::ACRANSAC,
-                               bool estimateDistortion = false)
+                               bool estimateDistortion = false,
+                               robustEstimation::EACRansacScoring acRansacScoring = robustEstimation::EACRansacScoring::EXACT)
       : GeometricFilterMatrix(dPrecision, std::numeric_limits<double>::infinity(), iteration),
         m_F(Mat3::Identity()),
         m_estimator(estimator),
-        m_estimateDistortion(estimateDistortion)
+        m_estimateDistortion(estimateDistortion),
+        m_acRansacScoring(acRansacScoring)
     {}
 
     /**
@@ -240,7 +242,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
 
         robustEstimation::Mat3Model model;
         const std::pair<double, double> ACRansacOut =
-          ACRANSAC(kernel, randomNumberGenerator, out_inliers, m_stIteration, &model, upper_bound_precision);
+          ACRANSAC(kernel, randomNumberGenerator, out_inliers, m_stIteration, &model, upper_bound_precision, m_acRansacScoring);
 
         m_F = model.getMatrix();
 
@@ -287,7 +289,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
 
         ModelT_ model;
         const std::pair<double, double> ACRansacOut =
-          robustEstimation::ACRANSAC(kernel, randomNumberGenerator, out_inliers, m_stIteration, &model, upperBoundPrecision);
+          robustEstimation::ACRANSAC(kernel, randomNumberGenerator, out_inliers, m_stIteration, &model, upperBoundPrecision, m_acRansacScoring);
         m_F = model.getMatrix();
 
         if (out_inliers.empty())
@@ -395,6 +397,7 @@ struct GeometricFilterMatrix_F_AC : public GeometricFilterMatrix
     Mat3 m_F;
     robustEstimation::ERobustEstimator m_estimator;
     bool m_estimateDistortion;
+    robustEstimation::EACRansacScoring m_acRansacScoring;
 };
 
 }  // namespace matchingImageCollection
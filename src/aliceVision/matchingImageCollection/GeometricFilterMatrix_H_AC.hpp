@@ -27,9 +27,12 @@ namespace matchingImageCollection {
  */
 struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
 {
-    GeometricFilterMatrix_H_AC(double dPrecision = std::numeric_limits<double>::infinity(), std::size_t iteration = 1024)
+    GeometricFilterMatrix_H_AC(double dPrecision = std::numeric_limits<double>::infinity(),
+                               std::size_t iteration = 1024,
+                               robustEstimation::EACRansacScoring acRansacScoring = robustEstimation::EACRansacScoring::EXACT)
       : GeometricFilterMatrix(dPrecision, std::numeric_limits<double>::infinity(), iteration),
-        m_H(Mat3::Identity())
+        m_H(Mat3::Identity()),
+        m_acRansacScoring(acRansacScoring)
     {}
 
     /**
@@ -82,7 +85,7 @@ struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
         std::vector<std::size_t> inliers;
         robustEstimation::Mat3Model model;
         const std::pair<double, double> ACRansacOut =
-          robustEstimation::ACRANSAC(kernel, randomNumberGenerator, inliers, m_stIteration, &model, upperBoundPrecision);
+          robustEstimation::ACRANSAC(kernel, randomNumberGenerator, inliers, m_stIteration, &model, upperBoundPrecision, m_acRansacScoring);
         m_H = model.getMatrix();
 
         if (inliers.empty())
@@ -231,6 +234,7 @@ struct GeometricFilterMatrix_H_AC : public GeometricFilterMatrix
 
     // stored data
     Mat3 m_H;
+    robustEstimation::EACRansacScoring m_acRansacScoring;
 };
 
 }  // namespace matchingImageCollection
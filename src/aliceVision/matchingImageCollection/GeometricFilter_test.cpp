@@ -0,0 +1,174 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/matchingImageCollection/GeometricFilter.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <random>
+
+#define BOOST_TEST_MODULE matchingImageCollectionGeometricFilter
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::matchingImageCollection;
+
+namespace {
+
+/**
+ * @brief Geometric filter keeping a random subset of the putative matches,
+ *        so its output only depends on the random number generator.
+ */
+struct RandomGeometricFilter
+{
+    EstimationStatus geometricEstimation(const sfmData::SfMData* sfmData,
+                                         const feature::RegionsPerView& regionsPerView,
+                                         const Pair& pairIndex,
+                                         const MatchesPerDescType& putativeMatchesPerType,
+                                         std::mt19937& randomNumberGenerator,
+                                         MatchesPerDescType& geometricInliersPerType)
+    {
+        std::bernoulli_distribution keepDistribution(0.5);
+        for (const auto& matchesPerType : putativeMatchesPerType)
+        {
+            for (const IndMatch& match : matchesPerType.second)
+            {
+                if (keepDistribution(randomNumberGenerator))
+                    geometricInliersPerType[matchesPerType.first].push_back(match);
+            }
+        }
+        const bool strongSupport = geometricInliersPerType.getNbAllMatches() > 5;
+        return EstimationStatus(true, strongSupport);
+    }
+
+    void Geometry_guided_matching(const sfmData::SfMData* sfmData,
+                                  const feature::RegionsPerView& regionsPerView,
+                                  const Pair& imageIdsPair,
+                                  const double dDistanceRatio,
+                                  MatchesPerDescType& matches)
+    {}
+};
+
+/**
+ * @brief Same as RandomGeometricFilter, but rejects the pairs without the regions of their views.
+ */
+struct RegionsCheckingGeometricFilter : public RandomGeometricFilter
+{
+    EstimationStatus geometricEstimation(const sfmData::SfMData* sfmData,
+                                         const feature::RegionsPerView& regionsPerView,
+                                         const Pair& pairIndex,
+                                         const MatchesPerDescType& putativeMatchesPerType,
+                                         std::mt19937& randomNumberGenerator,
+                                         MatchesPerDescType& geometricInliersPerType)
+    {
+        if (!regionsPerView.viewExist(pairIndex.first) || !regionsPerView.viewExist(pairIndex.second))
+            return EstimationStatus(false, false);
+        return RandomGeometricFilter::geometricEstimation(
+          sfmData, regionsPerView, pairIndex, putativeMatchesPerType, randomNumberGenerator, geometricInliersPerType);
+    }
+};
+
+PairwiseMatches createPutativeMatches(std::size_t nbViews, std::size_t nbMatches)
+{
+    PairwiseMatches putativeMatches;
+    for (IndexT I = 0; I < nbViews; ++I)
+    {
+        for (IndexT J = I + 1; J < nbViews; ++J)
+        {
+            IndMatches& matches = putativeMatches[Pair(I, J)][feature::EImageDescriberType::SIFT];
+            for (IndexT m = 0; m < nbMatches; ++m)
+                matches.emplace_back(m, (m * 7 + I + J) % nbMatches);
+        }
+    }
+    return putativeMatches;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(GeometricFilter_deterministic)
+{
+    const PairwiseMatches putativeMatches = createPutativeMatches(30, 20);
+    const feature::RegionsPerView regionsPerView;
+
+    const auto estimate = [&](int nbThreads, int shardIndex, int nbShards) {
+        omp_set_num_threads(nbThreads);
+        std::mt19937 randomNumberGenerator(42);
+        PairwiseMatches geometricMatches;
+        robustModelEstimation(geometricMatches,
+                              nullptr,
+                              regionsPerView,
+                              RandomGeometricFilter(),
+                              putativeMatches,
+                              randomNumberGenerator,
+                              false,
+                              0.6,
+                              shardIndex,
+                              nbShards);
+        return geometricMatches;
+    };
+
+    const PairwiseMatches reference = estimate(1, 0, 1);
+    BOOST_CHECK(!reference.empty());
+    BOOST_CHECK_LT(reference.size(), putativeMatches.size());
+
+    // same output for any number of threads
+    for (const int nbThreads : {2, 3, 8})
+    {
+        BOOST_CHECK(estimate(nbThreads, 0, 1) == reference);
+    }
+
+    // the shards partition the pairs
+    const int nbShards = 4;
+    PairwiseMatches shardsMatches;
+    std::size_t nbShardsMatches = 0;
+    for (int shardIndex = 0; shardIndex < nbShards; ++shardIndex)
+    {
+        const PairwiseMatches shardMatches = estimate(2, shardIndex, nbShards);
+        nbShardsMatches += shardMatches.size();
+        shardsMatches.insert(shardMatches.begin(), shardMatches.end());
+    }
+    BOOST_CHECK_EQUAL(nbShardsMatches, reference.size());
+    BOOST_CHECK(shardsMatches == reference);
+
+    BOOST_CHECK_THROW(estimate(1, nbShards, nbShards), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(GeometricFilter_regionsProvider)
+{
+    const PairwiseMatches putativeMatches = createPutativeMatches(30, 20);
+
+    // all the views are available
+    feature::RegionsPerView regionsPerView;
+    for (IndexT viewId = 0; viewId < 30; ++viewId)
+        regionsPerView.addRegions(viewId, feature::MapRegionsPerDesc());
+
+    omp_set_num_threads(2);
+
+    std::mt19937 randomNumberGenerator(42);
+    PairwiseMatches reference;
+    robustModelEstimation(reference, nullptr, regionsPerView, RegionsCheckingGeometricFilter(), putativeMatches, randomNumberGenerator);
+    BOOST_CHECK(!reference.empty());
+
+    // same output with the regions of the views of each window of pairs
+    feature::RegionsCache regionsCache([](IndexT) { return feature::MapRegionsPerDesc(); }, 0);
+    for (const std::size_t maxViewsPerWindow : {2, 5, 64})
+    {
+        randomNumberGenerator.seed(42);
+        PairwiseMatches geometricMatches;
+        robustModelEstimation(geometricMatches,
+                              nullptr,
+                              regionsCache,
+                              RegionsCheckingGeometricFilter(),
+                              putativeMatches,
+                              randomNumberGenerator,
+                              false,
+                              0.6,
+                              0,
+                              1,
+                              maxViewsPerWindow);
+        BOOST_CHECK(geometricMatches == reference);
+    }
+}
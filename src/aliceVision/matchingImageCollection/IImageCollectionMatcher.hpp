@@ -12,6 +12,7 @@
 #include "aliceVision/matching/IndMatch.hpp"
 #include "aliceVision/matchingImageCollection/pairBuilder.hpp"
 #include "aliceVision/feature/RegionsPerView.hpp"
+#include "aliceVision/feature/RegionsProvider.hpp"
 
 #include <string>
 #include <vector>
@@ -41,5 +42,36 @@ class IImageCollectionMatcher
     ) const = 0;
 };
 
+/**
+ * @brief Find corresponding points between some pair of view Ids, with the regions requested on demand to the regions provider.
+ *        The pairs are matched by windows of consecutive pairs, only the regions of the views of the current window are in use,
+ *        while the regions of the next window are prefetched.
+ * @note The matchers using statistics of all the given regions (e.g. the zero mean descriptor of the cascade hashing)
+ *       compute them per window.
+ * @param[in] imageCollectionMatcher The matcher
+ * @param[in] randomNumberGenerator The random number generator
+ * @param[in] regionsProvider The regions provider
+ * @param[in] pairs The list of pairs to consider for matching
+ * @param[in] descType The describer type
+ * @param[out] map_putatives_matches The output pairwise photometric corresponding points
+ * @param[in] maxViewsPerWindow Maximum number of views of a window of pairs
+ */
+inline void matchWithRegionsProvider(const IImageCollectionMatcher& imageCollectionMatcher,
+                                     std::mt19937& randomNumberGenerator,
+                                     feature::RegionsProvider& regionsProvider,
+                                     const PairSet& pairs,
+                                     feature::EImageDescriberType descType,
+                                     matching::PairwiseMatches& map_putatives_matches,
+                                     std::size_t maxViewsPerWindow = 64)
+{
+    const PairVec pairsVec(pairs.begin(), pairs.end());
+
+    feature::forEachPairsWindow(
+      regionsProvider, pairsVec, maxViewsPerWindow, [&](const feature::RegionsPerView& regionsPerView, std::size_t begin, std::size_t end) {
+          const PairSet windowPairs(pairsVec.begin() + begin, pairsVec.begin() + end);
+          imageCollectionMatcher.Match(randomNumberGenerator, regionsPerView, windowPairs, descType, map_putatives_matches);
+      });
+}
+
 }  // namespace matchingImageCollection
 }  // namespace aliceVision
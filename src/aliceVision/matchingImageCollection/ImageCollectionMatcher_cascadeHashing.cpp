@@ -7,11 +7,18 @@
 
 #include <aliceVision/matchingImageCollection/ImageCollectionMatcher_cascadeHashing.hpp>
 #include <aliceVision/matching/ArrayMatcher_cascadeHashing.hpp>
+#include <aliceVision/matching/hashedDescriptionsIO.hpp>
 #include <aliceVision/matching/IndMatchDecorator.hpp>
 #include <aliceVision/matching/filters.hpp>
 #include <aliceVision/system/ProgressDisplay.hpp>
 #include <aliceVision/config.hpp>
 
+#include <boost/filesystem.hpp>
+
+#include <atomic>
+
+namespace fs = boost::filesystem;
+
 namespace aliceVision {
 namespace matchingImageCollection {
 
@@ -30,6 +37,7 @@ void Match(std::mt19937& gen,
            const PairSet& pairs,
            EImageDescriberType descType,
            float fDistRatio,
+           const std::string& hashedDescriptionsFolder,
            PairwiseMatches& map_PutativesMatches  // the pairwise photometric corresponding points
 )
 {
@@ -61,15 +69,55 @@ void Match(std::mt19937& gen,
 
     std::map<IndexT, HashedDescriptions> hashed_base_;
 
-    // Compute the zero mean descriptor that will be used for hashing (one for all the image regions)
+    const std::string descTypeName = EImageDescriberType_enumToString(descType);
+    const bool useCache = !hashedDescriptionsFolder.empty() && !used_index.empty();
+    if (useCache && !fs::exists(hashedDescriptionsFolder))
+        fs::create_directories(hashedDescriptionsFolder);
+
+    // Key of the descriptions of each view, so that the cached data computed from other descriptors
+    // (e.g. features extracted again with the same number of regions) is never reused
+    std::vector<IndexT> viewIds(used_index.begin(), used_index.end());
+    std::vector<uint64_t> viewsDescriptionsKeys(viewIds.size(), 0);
+    if (useCache)
+    {
+#pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < viewIds.size(); ++i)
+        {
+            const feature::Regions& regionsI = regionsPerView.getRegions(viewIds[i], descType);
+            viewsDescriptionsKeys[i] =
+              computeDescriptionsKey(regionsI.DescriptorRawData(), regionsI.RegionCount() * regionsI.DescriptorLength() * sizeof(ScalarT));
+        }
+    }
+
+    // Compute the zero mean descriptor that will be used for hashing (one for all the image regions).
+    // With the cache, the zero mean descriptor of the first run is shared by all the runs (e.g. the chunks
+    // of a matching job), so the hashed descriptions of a view are the same whatever the chunk.
+    // It is computed again if the descriptions of one of the views it has been computed from have changed.
     Eigen::VectorXf zero_mean_descriptor;
+    const std::string zeroMeanFilepath = useCache ? (fs::path(hashedDescriptionsFolder) / ("zeroMean." + descTypeName + ".bin")).string() : "";
+    bool zeroMeanLoaded = false;
+    if (useCache)
+    {
+        std::map<IndexT, uint64_t> zeroMeanInputsKeys;
+        zeroMeanLoaded = loadZeroMeanDescriptor(
+          zeroMeanFilepath, regionsPerView.getRegions(*used_index.begin(), descType).DescriptorLength(), zero_mean_descriptor, zeroMeanInputsKeys);
+        for (std::size_t i = 0; zeroMeanLoaded && i < viewIds.size(); ++i)
+        {
+            const auto inputIt = zeroMeanInputsKeys.find(viewIds[i]);
+            if (inputIt != zeroMeanInputsKeys.end() && inputIt->second != viewsDescriptionsKeys[i])
+            {
+                ALICEVISION_LOG_INFO("Cascade hashing: the descriptions of the view " << viewIds[i]
+                                                                                      << " have changed, the zero mean descriptor is computed again.");
+                zeroMeanLoaded = false;
+            }
+        }
+    }
+    if (!zeroMeanLoaded)
     {
         Eigen::MatrixXf matForZeroMean;
         for (int i = 0; i < used_index.size(); ++i)
         {
-            std::set<IndexT>::const_iterator iter = used_index.begin();
-            std::advance(iter, i);
-            const IndexT I = *iter;
+            const IndexT I = viewIds[i];
             const feature::Regions& regionsI = regionsPerView.getRegions(I, descType);
             const ScalarT* tabI = reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
             const size_t dimension = regionsI.DescriptorLength();
@@ -85,27 +133,59 @@ void Match(std::mt19937& gen,
             }
         }
         zero_mean_descriptor = CascadeHasher::GetZeroMeanDescriptor(matForZeroMean);
+
+        if (useCache)
+        {
+            std::map<IndexT, uint64_t> zeroMeanInputsKeys;
+            for (std::size_t i = 0; i < viewIds.size(); ++i)
+                zeroMeanInputsKeys.emplace(viewIds[i], viewsDescriptionsKeys[i]);
+            saveZeroMeanDescriptor(zeroMeanFilepath, zero_mean_descriptor, zeroMeanInputsKeys);
+        }
     }
 
+    // Key of the hashed descriptions: depends on the hasher parameters, its random seed and the zero mean descriptor
+    const uint64_t hasherKey = cascade_hasher.GetFingerprint(zero_mean_descriptor);
+    std::atomic<int> nbLoaded(0);
+
 // Index the input regions
 #pragma omp parallel for schedule(dynamic)
     for (int i = 0; i < used_index.size(); ++i)
     {
-        std::set<IndexT>::const_iterator iter = used_index.begin();
-        std::advance(iter, i);
-        const IndexT I = *iter;
+        const IndexT I = viewIds[i];
         const feature::Regions& regionsI = regionsPerView.getRegions(I, descType);
-        const ScalarT* tabI = reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
-        const size_t dimension = regionsI.DescriptorLength();
 
-        Eigen::Map<BaseMat> mat_I((ScalarT*)tabI, regionsI.RegionCount(), dimension);
-        HashedDescriptions hashed_description = cascade_hasher.CreateHashedDescriptions(mat_I, zero_mean_descriptor);
+        HashedDescriptions hashed_description;
+        const std::string hashedFilepath =
+          useCache ? (fs::path(hashedDescriptionsFolder) / (std::to_string(I) + "." + descTypeName + ".hashed")).string() : "";
+        // key of the hashed descriptions of the view: the hasher key and the key of the view descriptions
+        const uint64_t viewKey = computeDescriptionsKey(&viewsDescriptionsKeys[i], sizeof(uint64_t), hasherKey);
+
+        if (useCache && loadHashedDescriptions(hashedFilepath, viewKey, regionsI.RegionCount(), hashed_description) &&
+            cascade_hasher.IsCompatible(hashed_description))
+        {
+            cascade_hasher.BuildBuckets(hashed_description);
+            ++nbLoaded;
+        }
+        else
+        {
+            const ScalarT* tabI = reinterpret_cast<const ScalarT*>(regionsI.DescriptorRawData());
+            const size_t dimension = regionsI.DescriptorLength();
+
+            Eigen::Map<BaseMat> mat_I((ScalarT*)tabI, regionsI.RegionCount(), dimension);
+            hashed_description = cascade_hasher.CreateHashedDescriptions(mat_I, zero_mean_descriptor);
+
+            if (useCache)
+                saveHashedDescriptions(hashedFilepath, viewKey, hashed_description);
+        }
 #pragma omp critical
         {
             hashed_base_[I] = std::move(hashed_description);
         }
     }
 
+    if (useCache)
+        ALICEVISION_LOG_INFO("Cascade hashing: " << nbLoaded << "/" << used_index.size() << " hashed descriptions loaded from the cache.");
+
     // Perform matching between all the pairs
     for (Map_vectorT::const_iterator iter = map_Pairs.begin(); iter != map_Pairs.end(); ++iter)
     {
@@ -127,9 +207,14 @@ void Match(std::mt19937& gen,
         for (int j = 0; j < (int)indexToCompare.size(); ++j)
         {
             size_t J = indexToCompare[j];
-            const feature::Regions& regionsJ = regionsPerView.getRegions(I, descType);
+            if (!regionsPerView.viewExist(J))
+            {
+                ++progressDisplay;
+                continue;
+            }
+            const feature::Regions& regionsJ = regionsPerView.getRegions(J, descType);
 
-            if (!regionsPerView.viewExist(J) || regionsI.Type_id() != regionsJ.Type_id())
+            if (regionsI.Type_id() != regionsJ.Type_id())
             {
                 ++progressDisplay;
                 continue;
@@ -147,7 +232,7 @@ void Match(std::mt19937& gen,
 
             // Match the query descriptors to the database
             cascade_hasher.Match_HashedDescriptions<BaseMat, ResultType>(
-              hashed_base_[J], mat_J, hashed_base_[I], mat_I, &pvec_indices, &pvec_distances);
+              hashed_base_.at(J), mat_J, hashed_base_.at(I), mat_I, &pvec_indices, &pvec_distances);
 
             std::vector<int> vec_nn_ratio_idx;
             // Filter the matches using a distance ratio test:
@@ -211,11 +296,11 @@ void ImageCollectionMatcher_cascadeHashing::Match(std::mt19937& gen,
 
     if (regions.Type_id() == typeid(unsigned char).name())
     {
-        impl::Match<unsigned char>(gen, regionsPerView, pairs, descType, f_dist_ratio_, map_PutativesMatches);
+        impl::Match<unsigned char>(gen, regionsPerView, pairs, descType, f_dist_ratio_, _hashedDescriptionsFolder, map_PutativesMatches);
     }
     else if (regions.Type_id() == typeid(float).name())
     {
-        impl::Match<float>(gen, regionsPerView, pairs, descType, f_dist_ratio_, map_PutativesMatches);
+        impl::Match<float>(gen, regionsPerView, pairs, descType, f_dist_ratio_, _hashedDescriptionsFolder, map_PutativesMatches);
     }
     else
     {
@@ -9,6 +9,8 @@
 
 #include "aliceVision/matchingImageCollection/IImageCollectionMatcher.hpp"
 
+#include <string>
+
 namespace aliceVision {
 namespace matchingImageCollection {
 
@@ -19,6 +21,9 @@ namespace matchingImageCollection {
  * a threshold over the distance ratio of the 2 nearest neighbours.
  *
  * @note: Cascade hashing tables are computed once and used for all the regions.
+ * @note: The hashed descriptions can be saved in a folder, one file per view and descriptor type,
+ *        and reused by the next runs with the same random seed (e.g. the other chunks of a matching job).
+ *        The files are keyed by the descriptors of the view, so they are computed again when the features change.
  * @warning: all descriptors are loaded in memory. You need to ensure that it can fit in RAM.
  */
 class ImageCollectionMatcher_cascadeHashing : public IImageCollectionMatcher
@@ -34,9 +39,17 @@ class ImageCollectionMatcher_cascadeHashing : public IImageCollectionMatcher
                matching::PairwiseMatches& map_PutativesMatches  // the pairwise photometric corresponding points
     ) const;
 
+    /**
+     * @brief Set the folder used to cache the hashed descriptions of the views between runs.
+     * @param[in] folder the cache folder, disabled if empty
+     */
+    void setHashedDescriptionsFolder(const std::string& folder) { _hashedDescriptionsFolder = folder; }
+
   private:
     // Distance ratio used to discard spurious correspondence
     float f_dist_ratio_;
+    // Folder of the hashed descriptions cache (empty: disabled)
+    std::string _hashedDescriptionsFolder;
 };
 
 }  // namespace matchingImageCollection
@@ -65,6 +65,70 @@ void ImageCollectionMatcher_generic::Match(std::mt19937& randomNumberGenerator,
         // Initialize the matching interface
         matching::RegionsDatabaseMatcher matcher(randomNumberGenerator, _matcherType, regionsI);
 
+        // Keep only the matches found in both directions
+        const auto crossCheck = [&](const feature::Regions& regionsJ, IndMatches& vec_putatives_matches) {
+            // Initialize the matching interface
+            matching::RegionsDatabaseMatcher matcherCross(randomNumberGenerator, _matcherType, regionsJ);
+
+            IndMatches vec_putatives_matches_cross;
+            matcherCross.Match(_f_dist_ratio, regionsI, vec_putatives_matches_cross);
+
+            // Create a dictionnary of matches indexed by their pair of indexes
+            std::map<std::pair<int, int>, IndMatch> check_matches;
+            for (IndMatch& m : vec_putatives_matches_cross)
+            {
+                std::pair<int, int> key = std::make_pair(m._i, m._j);
+                check_matches[key] = m;
+            }
+
+            IndMatches vec_putatives_matches_checked;
+            for (IndMatch& m : vec_putatives_matches)
+            {
+                // Check with reversed key (images are swapped)
+                std::pair<int, int> key = std::make_pair(m._j, m._i);
+                if (check_matches.find(key) != check_matches.end())
+                {
+                    vec_putatives_matches_checked.push_back(m);
+                }
+            }
+
+            std::swap(vec_putatives_matches, vec_putatives_matches_checked);
+        };
+
+        if (_matcherType == BRUTE_FORCE_L2_BATCHED)
+        {
+            // Match all the candidate views at once: the descriptors of I are only prepared once
+            // and the matcher parallelizes over the tiles of all the candidate views
+            std::vector<size_t> validJ;
+            std::vector<const feature::Regions*> regionsJ;
+            for (const size_t J : indexToCompare)
+            {
+                const feature::Regions& regions = regionsPerView.getRegions(J, descType);
+                if (regions.RegionCount() == 0 || regionsI.Type_id() != regions.Type_id())
+                    continue;
+                validJ.push_back(J);
+                regionsJ.push_back(&regions);
+            }
+
+            std::vector<IndMatches> putativesMatchesPerJ;
+            matcher.Match(_f_dist_ratio, regionsJ, putativesMatchesPerJ);
+
+            for (size_t j = 0; j < validJ.size(); ++j)
+            {
+                IndMatches& vec_putatives_matches = putativesMatchesPerJ[j];
+
+                if (_useCrossMatching)
+                    crossCheck(*regionsJ[j], vec_putatives_matches);
+
+                if (!vec_putatives_matches.empty())
+                {
+                    map_PutativesMatches[std::make_pair(I, validJ[j])].emplace(descType, std::move(vec_putatives_matches));
+                }
+            }
+            progressDisplay += indexToCompare.size();
+            continue;
+        }
+
 #pragma omp parallel for schedule(dynamic) if (b_multithreaded_pair_search)
         for (int j = 0; j < (int)indexToCompare.size(); ++j)
         {
@@ -81,34 +145,7 @@ void ImageCollectionMatcher_generic::Match(std::mt19937& randomNumberGenerator,
             matcher.Match(_f_dist_ratio, regionsJ, vec_putatives_matches);
 
             if (_useCrossMatching)
-            {
-                // Initialize the matching interface
-                matching::RegionsDatabaseMatcher matcherCross(randomNumberGenerator, _matcherType, regionsJ);
-
-                IndMatches vec_putatives_matches_cross;
-                matcherCross.Match(_f_dist_ratio, regionsI, vec_putatives_matches_cross);
-
-                // Create a dictionnary of matches indexed by their pair of indexes
-                std::map<std::pair<int, int>, IndMatch> check_matches;
-                for (IndMatch& m : vec_putatives_matches_cross)
-                {
-                    std::pair<int, int> key = std::make_pair(m._i, m._j);
-                    check_matches[key] = m;
-                }
-
-                IndMatches vec_putatives_matches_checked;
-                for (IndMatch& m : vec_putatives_matches)
-                {
-                    // Check with reversed key (images are swapped)
-                    std::pair<int, int> key = std::make_pair(m._j, m._i);
-                    if (check_matches.find(key) != check_matches.end())
-                    {
-                        vec_putatives_matches_checked.push_back(m);
-                    }
-                }
-
-                std::swap(vec_putatives_matches, vec_putatives_matches_checked);
-            }
+                crossCheck(regionsJ, vec_putatives_matches);
 
 #pragma omp critical
             {
@@ -17,7 +17,7 @@ namespace aliceVision {
 namespace matchingImageCollection {
 
 // TODO: remove PointFeature to avoid this hack
-inline Vec2 getFeaturePosition(const std::unique_ptr<feature::Regions>& regions, std::size_t i) { return regions->GetRegionPosition(i); }
+inline Vec2 getFeaturePosition(const std::shared_ptr<feature::Regions>& regions, std::size_t i) { return regions->GetRegionPosition(i); }
 
 inline Vec2 getFeaturePosition(const feature::PointFeatures& features, std::size_t i) { return features[i].coords().cast<double>(); }
 
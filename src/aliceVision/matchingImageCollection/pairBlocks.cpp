@@ -0,0 +1,282 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "pairBlocks.hpp"
+#include <aliceVision/system/Logger.hpp>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <utility>
+
+namespace bpt = boost::property_tree;
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+namespace {
+
+constexpr int pairBlocksManifestVersion = 1;
+
+std::size_t getRegionsSize(const std::map<IndexT, std::size_t>& regionsSizePerView, IndexT viewId)
+{
+    const auto it = regionsSizePerView.find(viewId);
+    return it == regionsSizePerView.end() ? 0 : it->second;
+}
+
+}  // namespace
+
+std::vector<IndexT> orderViewsByLocality(const PairSet& pairs)
+{
+    std::map<IndexT, std::vector<IndexT>> neighbors;
+    for (const Pair& pair : pairs)
+    {
+        neighbors[pair.first].push_back(pair.second);
+        neighbors[pair.second].push_back(pair.first);
+    }
+
+    const auto lessDegree = [&neighbors](IndexT a, IndexT b) {
+        const std::size_t degreeA = neighbors.at(a).size();
+        const std::size_t degreeB = neighbors.at(b).size();
+        return degreeA < degreeB || (degreeA == degreeB && a < b);
+    };
+
+    // start each connected component from a view of minimal degree
+    std::vector<IndexT> startViews;
+    startViews.reserve(neighbors.size());
+    for (const auto& viewNeighbors : neighbors)
+        startViews.push_back(viewNeighbors.first);
+    std::sort(startViews.begin(), startViews.end(), lessDegree);
+
+    std::vector<IndexT> order;
+    order.reserve(neighbors.size());
+    std::set<IndexT> visited;
+    std::vector<IndexT> nextViews;
+
+    for (const IndexT startView : startViews)
+    {
+        if (!visited.insert(startView).second)
+            continue;
+
+        // breadth first traversal, the neighbors in increasing degree order
+        std::deque<IndexT> queue(1, startView);
+        while (!queue.empty())
+        {
+            const IndexT viewId = queue.front();
+            queue.pop_front();
+            order.push_back(viewId);
+
+            nextViews.clear();
+            for (const IndexT neighbor : neighbors.at(viewId))
+            {
+                if (visited.insert(neighbor).second)
+                    nextViews.push_back(neighbor);
+            }
+            std::sort(nextViews.begin(), nextViews.end(), lessDegree);
+            queue.insert(queue.end(), nextViews.begin(), nextViews.end());
+        }
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+std::vector<PairBlock> computePairBlocks(const PairSet& pairs, const std::map<IndexT, std::size_t>& regionsSizePerView, std::size_t memoryBudget)
+{
+    std::vector<PairBlock> blocks;
+    if (pairs.empty())
+        return blocks;
+
+    // split the ordered views in groups of at most half of the memory budget
+    std::map<IndexT, std::size_t> groupPerView;
+    std::size_t nbGroups = 0;
+    {
+        const std::size_t groupBudget = memoryBudget / 2;
+        std::size_t groupSize = 0;
+        for (const IndexT viewId : orderViewsByLocality(pairs))
+        {
+            const std::size_t viewSize = getRegionsSize(regionsSizePerView, viewId);
+            if (nbGroups == 0 || (memoryBudget > 0 && groupSize > 0 && groupSize + viewSize > groupBudget))
+            {
+                ++nbGroups;
+                groupSize = 0;
+            }
+            groupSize += viewSize;
+            groupPerView[viewId] = nbGroups - 1;
+        }
+    }
+
+    // one block per couple of groups (a <= b)
+    std::map<std::pair<std::size_t, std::size_t>, PairBlock> blocksPerGroups;
+    for (const Pair& pair : pairs)
+    {
+        const std::size_t groupI = groupPerView.at(pair.first);
+        const std::size_t groupJ = groupPerView.at(pair.second);
+        PairBlock& block = blocksPerGroups[std::minmax(groupI, groupJ)];
+        block.pairs.insert(pair);
+        block.views.insert(pair.first);
+        block.views.insert(pair.second);
+    }
+
+    // schedule: (a, a), then (a, b) for b decreasing to a + 1, so the last block of a row shares
+    // the group a + 1 with the first block of the next row
+    blocks.reserve(blocksPerGroups.size());
+    for (std::size_t a = 0; a < nbGroups; ++a)
+    {
+        for (std::size_t i = 0; i < nbGroups - a; ++i)
+        {
+            const std::size_t b = (i == 0) ? a : nbGroups - i;
+            auto it = blocksPerGroups.find(std::make_pair(a, b));
+            if (it != blocksPerGroups.end())
+                blocks.push_back(std::move(it->second));
+        }
+    }
+    return blocks;
+}
+
+PairBlocksStats computePairBlocksStats(const std::vector<PairBlock>& blocks, const std::map<IndexT, std::size_t>& regionsSizePerView)
+{
+    PairBlocksStats stats;
+    std::set<IndexT> allViews;
+    const std::set<IndexT>* loadedViews = nullptr;
+
+    for (const PairBlock& block : blocks)
+    {
+        std::size_t blockSize = 0;
+        for (const IndexT viewId : block.views)
+        {
+            const std::size_t viewSize = getRegionsSize(regionsSizePerView, viewId);
+            blockSize += viewSize;
+            if (loadedViews == nullptr || loadedViews->count(viewId) == 0)
+            {
+                ++stats.nbViewsLoaded;
+                stats.bytesRead += viewSize;
+            }
+            if (allViews.insert(viewId).second)
+                stats.minBytesRead += viewSize;
+        }
+        stats.nbPairs += block.pairs.size();
+        stats.maxBytesLoaded = std::max(stats.maxBytesLoaded, blockSize);
+        // the regions of the views of the previous block that are not used anymore are released
+        loadedViews = &block.views;
+    }
+    return stats;
+}
+
+bool savePairBlocks(const std::string& filepath, const std::vector<PairBlock>& blocks)
+{
+    bpt::ptree fileTree;
+    fileTree.put("version", pairBlocksManifestVersion);
+
+    std::size_t nbPairs = 0;
+    bpt::ptree blocksTree;
+    for (const PairBlock& block : blocks)
+    {
+        bpt::ptree blockTree;
+
+        bpt::ptree viewsTree;
+        for (const IndexT viewId : block.views)
+        {
+            bpt::ptree viewTree;
+            viewTree.put("", viewId);
+            viewsTree.push_back(std::make_pair("", viewTree));
+        }
+        blockTree.add_child("views", viewsTree);
+
+        bpt::ptree pairsTree;
+        for (const Pair& pair : block.pairs)
+        {
+            bpt::ptree pairTree;
+            bpt::ptree firstTree;
+            bpt::ptree secondTree;
+            firstTree.put("", pair.first);
+            secondTree.put("", pair.second);
+            pairTree.push_back(std::make_pair("", firstTree));
+            pairTree.push_back(std::make_pair("", secondTree));
+            pairsTree.push_back(std::make_pair("", pairTree));
+        }
+        blockTree.add_child("pairs", pairsTree);
+
+        blocksTree.push_back(std::make_pair("", blockTree));
+        nbPairs += block.pairs.size();
+    }
+    fileTree.put("nbBlocks", blocks.size());
+    fileTree.put("nbPairs", nbPairs);
+    fileTree.add_child("blocks", blocksTree);
+
+    try
+    {
+        bpt::write_json(filepath, fileTree);
+    }
+    catch (const bpt::json_parser_error& e)
+    {
+        ALICEVISION_LOG_WARNING("Can't write the pair blocks manifest '" << filepath << "': " << e.what());
+        return false;
+    }
+    return true;
+}
+
+bool loadPairBlocks(const std::string& filepath, std::vector<PairBlock>& blocks, int rangeStart, int rangeSize)
+{
+    blocks.clear();
+
+    bpt::ptree fileTree;
+    try
+    {
+        bpt::read_json(filepath, fileTree);
+
+        if (fileTree.get<int>("version") != pairBlocksManifestVersion)
+        {
+            ALICEVISION_LOG_WARNING("Unsupported pair blocks manifest version: " << filepath);
+            return false;
+        }
+
+        int blockIndex = -1;
+        for (const bpt::ptree::value_type& blockNode : fileTree.get_child("blocks"))
+        {
+            ++blockIndex;
+            if (rangeStart != -1 && rangeSize != 0)
+            {
+                if (blockIndex < rangeStart)
+                    continue;
+                if (blockIndex >= rangeStart + rangeSize)
+                    break;
+            }
+
+            PairBlock block;
+            for (const bpt::ptree::value_type& viewNode : blockNode.second.get_child("views"))
+                block.views.insert(viewNode.second.get_value<IndexT>());
+
+            for (const bpt::ptree::value_type& pairNode : blockNode.second.get_child("pairs"))
+            {
+                std::vector<IndexT> pair;
+                for (const bpt::ptree::value_type& indexNode : pairNode.second)
+                    pair.push_back(indexNode.second.get_value<IndexT>());
+
+                if (pair.size() != 2 || block.views.count(pair[0]) == 0 || block.views.count(pair[1]) == 0)
+                {
+                    ALICEVISION_LOG_WARNING("Invalid pair in the pair blocks manifest: " << filepath);
+                    blocks.clear();
+                    return false;
+                }
+                block.pairs.emplace(pair[0], pair[1]);
+            }
+            blocks.push_back(std::move(block));
+        }
+    }
+    catch (const bpt::ptree_error& e)
+    {
+        ALICEVISION_LOG_WARNING("Invalid pair blocks manifest '" << filepath << "': " << e.what());
+        blocks.clear();
+        return false;
+    }
+    return true;
+}
+
+}  // namespace matchingImageCollection
+}  // namespace aliceVision
@@ -0,0 +1,102 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+namespace matchingImageCollection {
+
+/**
+ * @brief A block of image pairs, matched with the regions of its views loaded at the same time.
+ */
+struct PairBlock
+{
+    /// the views of the pairs of the block
+    std::set<IndexT> views;
+    /// the pairs of the block
+    PairSet pairs;
+};
+
+/**
+ * @brief Statistics on the regions read to match a sequence of pair blocks.
+ */
+struct PairBlocksStats
+{
+    /// number of pairs
+    std::size_t nbPairs = 0;
+    /// number of regions loadings (a view can be loaded several times)
+    std::size_t nbViewsLoaded = 0;
+    /// amount of regions data read (in bytes)
+    std::size_t bytesRead = 0;
+    /// amount of regions data of the distinct views (in bytes), the minimum amount of data to read
+    std::size_t minBytesRead = 0;
+    /// maximum amount of regions data loaded at the same time (in bytes)
+    std::size_t maxBytesLoaded = 0;
+
+    double getBytesReadPerPair() const { return nbPairs == 0 ? 0.0 : static_cast<double>(bytesRead) / nbPairs; }
+};
+
+/**
+ * @brief Order the views of the pairs so that the views of a pair are close in the order
+ *        (reverse Cuthill-McKee ordering of the pairs graph), the pair matrix is then close to a band matrix.
+ * @param[in] pairs the image pairs
+ * @return the ordered views
+ */
+std::vector<IndexT> orderViewsByLocality(const PairSet& pairs);
+
+/**
+ * @brief Tile the matrix of the image pairs in blocks that can be matched within a memory budget.
+ *
+ * The views are ordered by locality and split in groups of at most half of the memory budget.
+ * A block contains the pairs between two groups of views, so the regions of a block fit in the memory budget
+ * (unless a view is larger than half of the budget).
+ * The blocks are scheduled so that the consecutive blocks share a group of views:
+ * the diagonal block of a group, then the blocks of this group with the next groups in decreasing order.
+ *
+ * @param[in] pairs the image pairs
+ * @param[in] regionsSizePerView the amount of regions data of each view (in bytes)
+ * @param[in] memoryBudget the maximum amount of regions data loaded at the same time (in bytes), 0 for a single block
+ * @return the non empty pair blocks, in scheduling order
+ */
+std::vector<PairBlock> computePairBlocks(const PairSet& pairs, const std::map<IndexT, std::size_t>& regionsSizePerView, std::size_t memoryBudget);
+
+/**
+ * @brief Compute the amount of regions data read to match a sequence of pair blocks,
+ *        keeping the regions of the views shared by consecutive blocks loaded.
+ * @param[in] blocks the pair blocks, in execution order
+ * @param[in] regionsSizePerView the amount of regions data of each view (in bytes)
+ * @return the statistics
+ */
+PairBlocksStats computePairBlocksStats(const std::vector<PairBlock>& blocks, const std::map<IndexT, std::size_t>& regionsSizePerView);
+
+/**
+ * @brief Save the pair blocks in a JSON manifest, consumed by chunks of blocks (see loadPairBlocks).
+ * @param[in] filepath the manifest file
+ * @param[in] blocks the pair blocks, in scheduling order
+ * @return false if the file cannot be written
+ */
+bool savePairBlocks(const std::string& filepath, const std::vector<PairBlock>& blocks);
+
+/**
+ * @brief Load a range of the pair blocks of a JSON manifest.
+ * @param[in] filepath the manifest file
+ * @param[out] blocks the loaded pair blocks
+ * @param[in] rangeStart index of the first block to load (-1 for all the blocks)
+ * @param[in] rangeSize number of blocks to load (0 for all the blocks)
+ * @return false if the file cannot be read
+ */
+bool loadPairBlocks(const std::string& filepath, std::vector<PairBlock>& blocks, int rangeStart = -1, int rangeSize = 0);
+
+}  // namespace matchingImageCollection
+}  // namespace aliceVision
@@ -0,0 +1,169 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "aliceVision/matchingImageCollection/pairBlocks.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <numeric>
+#include <random>
+
+#define BOOST_TEST_MODULE matchingImageCollectionPairBlocks
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::matchingImageCollection;
+
+namespace {
+
+/// Sequence of images with shuffled view ids, each image is matched with the next ones
+PairSet sequencePairs(std::size_t nbViews, std::size_t overlap, std::vector<IndexT>& viewIds)
+{
+    viewIds.resize(nbViews);
+    std::iota(viewIds.begin(), viewIds.end(), 100);
+    std::mt19937 randomNumberGenerator(0);
+    std::shuffle(viewIds.begin(), viewIds.end(), randomNumberGenerator);
+
+    PairSet pairs;
+    for (std::size_t i = 0; i < nbViews; ++i)
+    {
+        for (std::size_t j = i + 1; j < std::min(nbViews, i + 1 + overlap); ++j)
+            pairs.insert(std::minmax(viewIds[i], viewIds[j]));
+    }
+    return pairs;
+}
+
+void checkBlocks(const std::vector<PairBlock>& blocks,
+                 const PairSet& pairs,
+                 const std::map<IndexT, std::size_t>& regionsSizePerView,
+                 std::size_t memoryBudget)
+{
+    PairSet blocksPairs;
+    std::size_t nbPairs = 0;
+    for (const PairBlock& block : blocks)
+    {
+        BOOST_CHECK(!block.pairs.empty());
+        std::set<IndexT> views;
+        for (const Pair& pair : block.pairs)
+        {
+            views.insert(pair.first);
+            views.insert(pair.second);
+        }
+        BOOST_CHECK(views == block.views);
+
+        std::size_t blockSize = 0;
+        for (const IndexT viewId : block.views)
+            blockSize += regionsSizePerView.at(viewId);
+        BOOST_CHECK_LE(blockSize, memoryBudget);
+
+        blocksPairs.insert(block.pairs.begin(), block.pairs.end());
+        nbPairs += block.pairs.size();
+    }
+    // each pair in exactly one block
+    BOOST_CHECK_EQUAL(nbPairs, pairs.size());
+    BOOST_CHECK(blocksPairs == pairs);
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(matchingImageCollection_pairBlocks_sequence)
+{
+    std::vector<IndexT> viewIds;
+    const PairSet pairs = sequencePairs(200, 5, viewIds);
+
+    std::map<IndexT, std::size_t> regionsSizePerView;
+    for (const IndexT viewId : viewIds)
+        regionsSizePerView[viewId] = 1000 + viewId;
+
+    // the views of a pair are close in the locality order
+    const std::vector<IndexT> order = orderViewsByLocality(pairs);
+    BOOST_CHECK_EQUAL(order.size(), viewIds.size());
+    std::map<IndexT, std::size_t> rank;
+    for (std::size_t i = 0; i < order.size(); ++i)
+        rank[order[i]] = i;
+    for (const Pair& pair : pairs)
+        BOOST_CHECK_LE(std::max(rank[pair.first], rank[pair.second]) - std::min(rank[pair.first], rank[pair.second]), 10);
+
+    const std::size_t memoryBudget = 40000;
+    const std::vector<PairBlock> blocks = computePairBlocks(pairs, regionsSizePerView, memoryBudget);
+    BOOST_CHECK_GT(blocks.size(), 1);
+    checkBlocks(blocks, pairs, regionsSizePerView, memoryBudget);
+
+    // each view is read once
+    const PairBlocksStats stats = computePairBlocksStats(blocks, regionsSizePerView);
+    BOOST_CHECK_EQUAL(stats.nbPairs, pairs.size());
+    BOOST_CHECK_EQUAL(stats.nbViewsLoaded, viewIds.size());
+    BOOST_CHECK_EQUAL(stats.bytesRead, stats.minBytesRead);
+    BOOST_CHECK_LE(stats.maxBytesLoaded, memoryBudget);
+
+    // no budget: a single block
+    const std::vector<PairBlock> singleBlock = computePairBlocks(pairs, regionsSizePerView, 0);
+    BOOST_CHECK_EQUAL(singleBlock.size(), 1);
+    checkBlocks(singleBlock, pairs, regionsSizePerView, std::numeric_limits<std::size_t>::max());
+}
+
+BOOST_AUTO_TEST_CASE(matchingImageCollection_pairBlocks_exhaustive)
+{
+    PairSet pairs;
+    std::map<IndexT, std::size_t> regionsSizePerView;
+    for (IndexT i = 0; i < 60; ++i)
+    {
+        regionsSizePerView[i] = 1000;
+        for (IndexT j = i + 1; j < 60; ++j)
+            pairs.emplace(i, j);
+    }
+
+    // 10 groups of 6 views
+    const std::size_t memoryBudget = 12000;
+    const std::vector<PairBlock> blocks = computePairBlocks(pairs, regionsSizePerView, memoryBudget);
+    BOOST_CHECK_EQUAL(blocks.size(), 10 * 11 / 2);
+    checkBlocks(blocks, pairs, regionsSizePerView, memoryBudget);
+
+    // consecutive blocks share a group of views: one group read per off-diagonal block,
+    // the diagonal blocks use the group loaded by the previous block
+    const PairBlocksStats stats = computePairBlocksStats(blocks, regionsSizePerView);
+    BOOST_CHECK_EQUAL(stats.bytesRead, 6000 * (10 * 9 / 2 + 1));
+    BOOST_CHECK_EQUAL(stats.minBytesRead, 60000);
+}
+
+BOOST_AUTO_TEST_CASE(matchingImageCollection_pairBlocks_manifest)
+{
+    std::vector<IndexT> viewIds;
+    const PairSet pairs = sequencePairs(50, 3, viewIds);
+    std::map<IndexT, std::size_t> regionsSizePerView;
+    for (const IndexT viewId : viewIds)
+        regionsSizePerView[viewId] = 100;
+
+    const std::vector<PairBlock> blocks = computePairBlocks(pairs, regionsSizePerView, 2000);
+    BOOST_CHECK_GT(blocks.size(), 3);
+
+    const std::string filepath = "pairBlocks_test_manifest.json";
+    BOOST_CHECK(savePairBlocks(filepath, blocks));
+
+    std::vector<PairBlock> loadedBlocks;
+    BOOST_CHECK(loadPairBlocks(filepath, loadedBlocks));
+    BOOST_CHECK_EQUAL(loadedBlocks.size(), blocks.size());
+    for (std::size_t i = 0; i < std::min(blocks.size(), loadedBlocks.size()); ++i)
+    {
+        BOOST_CHECK(loadedBlocks[i].views == blocks[i].views);
+        BOOST_CHECK(loadedBlocks[i].pairs == blocks[i].pairs);
+    }
+
+    // range of blocks
+    BOOST_CHECK(loadPairBlocks(filepath, loadedBlocks, 1, 2));
+    BOOST_CHECK_EQUAL(loadedBlocks.size(), 2);
+    if (loadedBlocks.size() == 2)
+    {
+        BOOST_CHECK(loadedBlocks[0].pairs == blocks[1].pairs);
+        BOOST_CHECK(loadedBlocks[1].pairs == blocks[2].pairs);
+    }
+    std::remove(filepath.c_str());
+
+    BOOST_CHECK(!loadPairBlocks(filepath, loadedBlocks));
+    BOOST_CHECK(loadedBlocks.empty());
+}
@@ -148,12 +148,27 @@ class RelativePoseKernel_K : public robustEstimation::PointFittingRansacKernel<S
 
     double error(std::size_t sample, const ModelT_& model) const override
     {
-        Mat3 F;
-        fundamentalFromEssential(model.getMatrix(), _K1, _K2, &F);
-        const ModelT_ modelF(F);
+        const ModelT_ modelF = fundamentalModel(model);
         return _errorEstimator.error(modelF, PFRansacKernel::PFKernel::_x1.col(sample), PFRansacKernel::PFKernel::_x2.col(sample));
     }
 
+    void errors(const ModelT_& model, std::vector<double>& errors) const override
+    {
+        // the fundamental matrix is computed once for all the samples
+        const ModelT_ modelF = fundamentalModel(model);
+        errors.resize(PFRansacKernel::nbSamples());
+        PFRansacKernel::PFKernel::blockErrors(&modelF, 1, &errors);
+    }
+
+    void modelsErrors(const std::vector<ModelT_>& models, std::vector<std::vector<double>>& errors) const override
+    {
+        std::vector<ModelT_> modelsF;
+        modelsF.reserve(models.size());
+        for (const ModelT_& model : models)
+            modelsF.push_back(fundamentalModel(model));
+        PFRansacKernel::PFKernel::modelsErrors(modelsF, errors);
+    }
+
     void unnormalize(ModelT_& model) const override
     {
         // do nothing, no normalization in this case
@@ -166,6 +181,16 @@ class RelativePoseKernel_K : public robustEstimation::PointFittingRansacKernel<S
     double unormalizeError(double val) const override { return sqrt(val); }
 
   private:
+    /**
+     * @brief Get the fundamental matrix model of an essential matrix model
+     */
+    ModelT_ fundamentalModel(const ModelT_& model) const
+    {
+        Mat3 F;
+        fundamentalFromEssential(model.getMatrix(), _K1, _K2, &F);
+        return ModelT_(F);
+    }
+
     Mat _x1k, _x2k;
     /// Matrix used to normalize data
     Mat3 _N1, _N2;
@@ -69,6 +69,29 @@ class EssentialKernel : public robustEstimation::PointFittingKernel<SolverT, Err
         return KernelBase::_errorEstimator.error(modelF, KernelBase::_x1.col(sample), KernelBase::_x2.col(sample));
     }
 
+    void errors(const ModelT& model, std::vector<double>& errors) const override
+    {
+        // the fundamental matrix is computed once for all the samples
+        Mat3 F;
+        fundamentalFromEssential(model.getMatrix(), _K1, _K2, &F);
+        const ModelT modelF(F);
+        errors.resize(KernelBase::nbSamples());
+        KernelBase::blockErrors(&modelF, 1, &errors);
+    }
+
+    void modelsErrors(const std::vector<ModelT>& models, std::vector<std::vector<double>>& errors) const override
+    {
+        std::vector<ModelT> modelsF;
+        modelsF.reserve(models.size());
+        for (const ModelT& model : models)
+        {
+            Mat3 F;
+            fundamentalFromEssential(model.getMatrix(), _K1, _K2, &F);
+            modelsF.emplace_back(F);
+        }
+        KernelBase::modelsErrors(modelsF, errors);
+    }
+
   protected:
     // The two camera calibrated camera matrix
     Mat3 _K1, _K2;
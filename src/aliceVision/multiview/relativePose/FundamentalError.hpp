@@ -9,6 +9,7 @@
 #pragma once
 
 #include <aliceVision/robustEstimation/ISolver.hpp>
+#include <aliceVision/robustEstimation/batchErrors.hpp>
 #include <aliceVision/multiview/relativePose/ISolverErrorRelativePose.hpp>
 
 namespace aliceVision {
@@ -31,6 +32,27 @@ struct FundamentalSampsonError : public ISolverErrorRelativePose<robustEstimatio
 
         return Square(y.dot(F_x)) / (F_x.head<2>().squaredNorm() + Ft_y.head<2>().squaredNorm());
     }
+
+    void errors(const robustEstimation::Mat3Model& model,
+                const robustEstimation::PointsBlock& x1,
+                const robustEstimation::PointsBlock& x2,
+                double* errors) const
+    {
+        const Mat3& F = model.getMatrix();
+        const auto x = x1.coordinate(0);
+        const auto y = x1.coordinate(1);
+        const auto u = x2.coordinate(0);
+        const auto v = x2.coordinate(1);
+
+        const robustEstimation::PointsBlockArray Fx0 = F(0, 0) * x + F(0, 1) * y + F(0, 2);
+        const robustEstimation::PointsBlockArray Fx1 = F(1, 0) * x + F(1, 1) * y + F(1, 2);
+        const robustEstimation::PointsBlockArray Fx2 = F(2, 0) * x + F(2, 1) * y + F(2, 2);
+        const robustEstimation::PointsBlockArray Fty0 = F(0, 0) * u + F(1, 0) * v + F(2, 0);
+        const robustEstimation::PointsBlockArray Fty1 = F(0, 1) * u + F(1, 1) * v + F(2, 1);
+
+        Eigen::Map<Eigen::ArrayXd>(errors, x1.size) =
+          (u * Fx0 + v * Fx1 + Fx2).square() / (Fx0.square() + Fx1.square() + Fty0.square() + Fty1.square());
+    }
 };
 
 struct FundamentalSymmetricEpipolarDistanceError : public ISolverErrorRelativePose<robustEstimation::Mat3Model>
@@ -47,6 +69,27 @@ struct FundamentalSymmetricEpipolarDistanceError : public ISolverErrorRelativePo
         // @note the divide by 4 is to make this match the Sampson distance.
         return Square(y.dot(F_x)) * (1.0 / F_x.head<2>().squaredNorm() + 1.0 / Ft_y.head<2>().squaredNorm()) / 4.0;
     }
+
+    void errors(const robustEstimation::Mat3Model& model,
+                const robustEstimation::PointsBlock& x1,
+                const robustEstimation::PointsBlock& x2,
+                double* errors) const
+    {
+        const Mat3& F = model.getMatrix();
+        const auto x = x1.coordinate(0);
+        const auto y = x1.coordinate(1);
+        const auto u = x2.coordinate(0);
+        const auto v = x2.coordinate(1);
+
+        const robustEstimation::PointsBlockArray Fx0 = F(0, 0) * x + F(0, 1) * y + F(0, 2);
+        const robustEstimation::PointsBlockArray Fx1 = F(1, 0) * x + F(1, 1) * y + F(1, 2);
+        const robustEstimation::PointsBlockArray Fx2 = F(2, 0) * x + F(2, 1) * y + F(2, 2);
+        const robustEstimation::PointsBlockArray Fty0 = F(0, 0) * u + F(1, 0) * v + F(2, 0);
+        const robustEstimation::PointsBlockArray Fty1 = F(0, 1) * u + F(1, 1) * v + F(2, 1);
+
+        Eigen::Map<Eigen::ArrayXd>(errors, x1.size) =
+          (u * Fx0 + v * Fx1 + Fx2).square() * ((Fx0.square() + Fx1.square()).inverse() + (Fty0.square() + Fty1.square()).inverse()) / 4.0;
+    }
 };
 
 struct FundamentalEpipolarDistanceError : public ISolverErrorRelativePose<robustEstimation::Mat3Model>
@@ -61,6 +104,23 @@ struct FundamentalEpipolarDistanceError : public ISolverErrorRelativePose<robust
 
         return Square(F_x.dot(y)) / F_x.head<2>().squaredNorm();
     }
+
+    void errors(const robustEstimation::Mat3Model& model,
+                const robustEstimation::PointsBlock& x1,
+                const robustEstimation::PointsBlock& x2,
+                double* errors) const
+    {
+        const Mat3& F = model.getMatrix();
+        const auto x = x1.coordinate(0);
+        const auto y = x1.coordinate(1);
+
+        const robustEstimation::PointsBlockArray Fx0 = F(0, 0) * x + F(0, 1) * y + F(0, 2);
+        const robustEstimation::PointsBlockArray Fx1 = F(1, 0) * x + F(1, 1) * y + F(1, 2);
+        const robustEstimation::PointsBlockArray Fx2 = F(2, 0) * x + F(2, 1) * y + F(2, 2);
+
+        Eigen::Map<Eigen::ArrayXd>(errors, x1.size) =
+          (x2.coordinate(0) * Fx0 + x2.coordinate(1) * Fx1 + Fx2).square() / (Fx0.square() + Fx1.square());
+    }
 };
 
 struct EpipolarSphericalDistanceError
@@ -10,6 +10,7 @@
 
 #include <aliceVision/numeric/projection.hpp>
 #include <aliceVision/robustEstimation/ISolver.hpp>
+#include <aliceVision/robustEstimation/batchErrors.hpp>
 #include <aliceVision/multiview/relativePose/ISolverErrorRelativePose.hpp>
 
 namespace aliceVision {
@@ -28,6 +29,22 @@ struct HomographyAsymmetricError : ISolverErrorRelativePose<robustEstimation::Ma
         const Vec2 x2_est = x2h_est.head<2>() / x2h_est[2];
         return (x2 - x2_est).squaredNorm();
     }
+
+    void errors(const robustEstimation::Mat3Model& model,
+                const robustEstimation::PointsBlock& x1,
+                const robustEstimation::PointsBlock& x2,
+                double* errors) const
+    {
+        const Mat3& H = model.getMatrix();
+        const auto x = x1.coordinate(0);
+        const auto y = x1.coordinate(1);
+
+        const robustEstimation::PointsBlockArray w = (H(2, 0) * x + H(2, 1) * y + H(2, 2)).inverse();
+        const robustEstimation::PointsBlockArray du = x2.coordinate(0) - (H(0, 0) * x + H(0, 1) * y + H(0, 2)) * w;
+        const robustEstimation::PointsBlockArray dv = x2.coordinate(1) - (H(1, 0) * x + H(1, 1) * y + H(1, 2)) * w;
+
+        Eigen::Map<Eigen::ArrayXd>(errors, x1.size) = du.square() + dv.square();
+    }
 };
 
 }  // namespace relativePose
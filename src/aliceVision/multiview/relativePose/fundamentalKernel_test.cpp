@@ -122,3 +122,45 @@ BOOST_AUTO_TEST_CASE(NormalizedFundamental8PKernel_EasyCase)
 
     BOOST_CHECK(expectKernelProperties<relativePose::NormalizedFundamental8PKernel>(x1, x2));
 }
+
+// check that the errors computed by blocks of points are the same as the errors computed point by point
+template<class ErrorT>
+void expectBlockErrors(const Mat& x1, const Mat& x2, const std::vector<robustEstimation::Mat3Model>& models)
+{
+    const robustEstimation::PointFittingKernel<relativePose::Fundamental7PSolver, ErrorT, robustEstimation::Mat3Model> kernel(x1, x2);
+    const ErrorT errorEstimator;
+
+    std::vector<std::vector<double>> modelsErrors;
+    kernel.modelsErrors(models, modelsErrors);
+    BOOST_CHECK_EQUAL(modelsErrors.size(), models.size());
+
+    for (std::size_t m = 0; m < models.size(); ++m)
+    {
+        std::vector<double> errors;
+        kernel.errors(models[m], errors);
+        BOOST_CHECK_EQUAL(errors.size(), x1.cols());
+        BOOST_CHECK(errors == modelsErrors[m]);
+
+        for (std::size_t i = 0; i < x1.cols(); ++i)
+        {
+            const double error = errorEstimator.error(models[m], x1.col(i), x2.col(i));
+            BOOST_CHECK_SMALL(errors[i] - error, 1e-9 * (1.0 + error));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(FundamentalErrors_BlockErrors)
+{
+    // not a multiple of the block size, to check the last partial block
+    const int nbPoints = 300;
+    const Mat x1 = Mat::Random(2, nbPoints) * 500.0;
+    const Mat x2 = Mat::Random(2, nbPoints) * 500.0;
+
+    std::vector<robustEstimation::Mat3Model> models;
+    for (int m = 0; m < 3; ++m)
+        models.emplace_back(Mat3::Random());
+
+    expectBlockErrors<relativePose::FundamentalSampsonError>(x1, x2, models);
+    expectBlockErrors<relativePose::FundamentalSymmetricEpipolarDistanceError>(x1, x2, models);
+    expectBlockErrors<relativePose::FundamentalEpipolarDistanceError>(x1, x2, models);
+}
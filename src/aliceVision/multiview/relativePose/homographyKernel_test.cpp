@@ -90,3 +90,28 @@ BOOST_AUTO_TEST_CASE(Homography4PKernel_Fitting)
         }
     }
 }
+
+BOOST_AUTO_TEST_CASE(HomographyAsymmetricError_BlockErrors)
+{
+    // not a multiple of the block size, to check the last partial block
+    const int nbPoints = 300;
+    const Mat x1 = Mat::Random(2, nbPoints) * 500.0;
+    const Mat x2 = Mat::Random(2, nbPoints) * 500.0;
+
+    Mat3 H;
+    H << 1.1, -0.2, 3.0, 0.1, 0.9, -6.0, 1e-4, -2e-4, 1.0;
+    const robustEstimation::Mat3Model model(H);
+
+    const relativePose::Homography4PKernel kernel(x1, x2);
+    const relativePose::HomographyAsymmetricError errorEstimator;
+
+    std::vector<double> errors;
+    kernel.errors(model, errors);
+    BOOST_CHECK_EQUAL(errors.size(), nbPoints);
+
+    for (std::size_t i = 0; i < nbPoints; ++i)
+    {
+        const double error = errorEstimator.error(model, x1.col(i), x2.col(i));
+        BOOST_CHECK_SMALL(errors[i] - error, 1e-9 * (1.0 + error));
+    }
+}
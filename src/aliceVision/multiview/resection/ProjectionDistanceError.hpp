@@ -9,12 +9,35 @@
 
 #include <aliceVision/numeric/projection.hpp>
 #include <aliceVision/robustEstimation/ISolver.hpp>
+#include <aliceVision/robustEstimation/batchErrors.hpp>
 #include <aliceVision/multiview/resection/ISolverErrorResection.hpp>
 
 namespace aliceVision {
 namespace multiview {
 namespace resection {
 
+/**
+ * @brief Compute the squared projection distances of a block of points
+ * @param[in] P The projection matrix
+ * @param[in] p2d The 2d points
+ * @param[in] p3d The 3d points
+ * @return the squared projection distances
+ */
+inline robustEstimation::PointsBlockArray projectionSquaredErrors(const Mat34& P,
+                                                                  const robustEstimation::PointsBlock& p2d,
+                                                                  const robustEstimation::PointsBlock& p3d)
+{
+    const auto X = p3d.coordinate(0);
+    const auto Y = p3d.coordinate(1);
+    const auto Z = p3d.coordinate(2);
+
+    const robustEstimation::PointsBlockArray w = (P(2, 0) * X + P(2, 1) * Y + P(2, 2) * Z + P(2, 3)).inverse();
+    const robustEstimation::PointsBlockArray du = (P(0, 0) * X + P(0, 1) * Y + P(0, 2) * Z + P(0, 3)) * w - p2d.coordinate(0);
+    const robustEstimation::PointsBlockArray dv = (P(1, 0) * X + P(1, 1) * Y + P(1, 2) * Z + P(1, 3)) * w - p2d.coordinate(1);
+
+    return du.square() + dv.square();
+}
+
 /**
  * @brief Compute the residual of the projection distance
  *        (pt2D, project(P,pt3D))
@@ -25,6 +48,11 @@ struct ProjectionDistanceError : public ISolverErrorResection<robustEstimation::
     {
         return (project(P.getMatrix(), p3d) - p2d).norm();
     }
+
+    void errors(const robustEstimation::Mat34Model& P, const robustEstimation::PointsBlock& p2d, const robustEstimation::PointsBlock& p3d, double* errors) const
+    {
+        Eigen::Map<Eigen::ArrayXd>(errors, p2d.size) = projectionSquaredErrors(P.getMatrix(), p2d, p3d).sqrt();
+    }
 };
 
 /**
@@ -37,6 +65,11 @@ struct ProjectionDistanceSquaredError : public ISolverErrorResection<robustEstim
     {
         return (project(P.getMatrix(), p3d) - p2d).squaredNorm();
     }
+
+    void errors(const robustEstimation::Mat34Model& P, const robustEstimation::PointsBlock& p2d, const robustEstimation::PointsBlock& p3d, double* errors) const
+    {
+        Eigen::Map<Eigen::ArrayXd>(errors, p2d.size) = projectionSquaredErrors(P.getMatrix(), p2d, p3d);
+    }
 };
 
 }  // namespace resection
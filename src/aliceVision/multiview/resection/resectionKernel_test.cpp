@@ -55,6 +55,30 @@ BOOST_AUTO_TEST_CASE(Resection_Kernel_Multiview)
     }
 }
 
+BOOST_AUTO_TEST_CASE(Resection_Kernel_BlockErrors)
+{
+    const int nViews = 1;
+    // not a multiple of the block size, to check the last partial block
+    const int nbPoints = 300;
+    const NViewDataSet d = NRealisticCamerasRing(nViews, nbPoints, NViewDatasetConfigurator(1, 1, 0, 0, 5, 0));
+
+    const Mat x = d._x[0] + Mat::Random(2, nbPoints) * 0.01;
+    const Mat X = d._X;
+    const robustEstimation::Mat34Model model(d.P(0));
+
+    const resection::Resection6PKernel kernel(x, X);
+
+    std::vector<double> errors;
+    kernel.errors(model, errors);
+    BOOST_CHECK_EQUAL(errors.size(), nbPoints);
+
+    for (std::size_t i = 0; i < nbPoints; ++i)
+    {
+        BOOST_CHECK_SMALL(errors[i] - kernel.error(i, model), 1e-12);
+        BOOST_CHECK_SMALL(errors[i], 0.1);
+    }
+}
+
 /*
 BOOST_AUTO_TEST_CASE(P3P_Kneip_CVPR11_Multiview)
 {
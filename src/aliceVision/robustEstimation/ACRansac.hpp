@@ -9,15 +9,20 @@
 
 #pragma once
 
+#include <aliceVision/robustEstimation/batchErrors.hpp>
 #include <aliceVision/robustEstimation/randSampling.hpp>
 #include <aliceVision/system/Logger.hpp>
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <iterator>
 #include <limits>
 #include <numeric>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 namespace aliceVision {
@@ -111,6 +116,215 @@ inline ErrorIndex bestNFA(int startIndex,  // number of point required for estim
     return bestIndex;
 }
 
+/**
+ * @brief Scoring of the models in ACRansac.
+ */
+enum class EACRansacScoring
+{
+    EXACT = 0,     //< Sort the residuals of each model to evaluate the NFA of every number of inliers.
+    HISTOGRAM = 1  //< Log-scale histogram of the residuals of each model, linear time.
+};
+
+inline std::string EACRansacScoring_enumToString(EACRansacScoring scoring)
+{
+    switch (scoring)
+    {
+        case EACRansacScoring::EXACT:
+            return "exact";
+        case EACRansacScoring::HISTOGRAM:
+            return "histogram";
+    }
+    throw std::out_of_range("Invalid ACRansac scoring enum");
+}
+
+inline EACRansacScoring EACRansacScoring_stringToEnum(const std::string& scoring)
+{
+    if (scoring == "exact")
+        return EACRansacScoring::EXACT;
+    if (scoring == "histogram")
+        return EACRansacScoring::HISTOGRAM;
+    throw std::out_of_range("Invalid ACRansac scoring string " + scoring);
+}
+
+inline std::ostream& operator<<(std::ostream& os, EACRansacScoring e) { return os << EACRansacScoring_enumToString(e); }
+
+inline std::istream& operator>>(std::istream& in, EACRansacScoring& scoring)
+{
+    std::string token;
+    in >> token;
+    scoring = EACRansacScoring_stringToEnum(token);
+    return in;
+}
+
+/**
+ * @brief Find the best NFA of bestNFA without sorting all the residuals.
+ *
+ * The residuals are bucket sorted in a log-scale histogram: the bins are given by the highest bits
+ * of the float representation of the squared residuals (8 bins per power of two), so binning does not
+ * need any logarithm. The NFA is exact at the end of each bin, where the number of inliers and the
+ * largest residual are known. Inside a bin, the NFA is bounded using the smallest residual of the bin,
+ * and only the bins whose bound is below the best NFA are sorted to evaluate their exact NFA.
+ * In practice, only a few small bins around the best NFA are sorted, so the cost is linear.
+ * The inliers are fully sorted only when they are requested, i.e. when a better model is found.
+ */
+class HistogramNFA
+{
+  public:
+    /**
+     * @brief Find the best NFA and its number of inliers.
+     * @see bestNFA for the parameters, the residuals do not need to be sorted
+     * @return (NFA, number of inliers)
+     */
+    ErrorIndex best(int startIndex,
+                    double logalpha0,
+                    const std::vector<double>& residuals,
+                    double loge0,
+                    double maxThreshold,
+                    const std::vector<float>& logc_n,
+                    const std::vector<float>& logc_k,
+                    double errorVectorDimension = 1.0)
+    {
+        const auto computeLogAlpha = [&](double squaredResidual) {
+            const double residual = sqrt(squaredResidual) + std::numeric_limits<float>::epsilon();
+            return logalpha0 + errorVectorDimension * log10(residual);
+        };
+        const auto computeNFA = [&](std::size_t k, double logalpha) { return loge0 + logalpha * (double)(k - startIndex) + logc_n[k] + logc_k[k]; };
+
+        ErrorIndex bestIndex(std::numeric_limits<double>::infinity(), startIndex);
+        _threshold = std::numeric_limits<double>::infinity();
+        _sorted.clear();
+
+        // bins of the residuals below the threshold
+        const std::size_t n = residuals.size();
+        _bins.resize(n);
+        std::uint32_t minBin = std::numeric_limits<std::uint32_t>::max();
+        std::uint32_t maxBin = 0;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const double squaredResidual = residuals[i];
+            if (!(squaredResidual <= maxThreshold) || !std::isfinite(squaredResidual))
+            {
+                _bins[i] = invalidBin;
+                continue;
+            }
+            _bins[i] = getBin(squaredResidual);
+            minBin = std::min(minBin, _bins[i]);
+            maxBin = std::max(maxBin, _bins[i]);
+        }
+        if (minBin > maxBin)
+            return bestIndex;
+
+        // bucket sort
+        const std::size_t nbBins = maxBin - minBin + 1;
+        _offsets.assign(nbBins + 1, 0);
+        _binMin.assign(nbBins, std::numeric_limits<double>::infinity());
+        _binMax.assign(nbBins, 0.0);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            if (_bins[i] == invalidBin)
+                continue;
+            const std::size_t b = _bins[i] - minBin;
+            ++_offsets[b + 1];
+            _binMin[b] = std::min(_binMin[b], residuals[i]);
+            _binMax[b] = std::max(_binMax[b], residuals[i]);
+        }
+        for (std::size_t b = 0; b < nbBins; ++b)
+            _offsets[b + 1] += _offsets[b];
+
+        _sorted.resize(_offsets[nbBins]);
+        _positions.assign(_offsets.begin(), _offsets.end() - 1);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            if (_bins[i] != invalidBin)
+                _sorted[_positions[_bins[i] - minBin]++] = ErrorIndex(residuals[i], i);
+        }
+
+        // exact NFA at the end of each bin and lower bound of the NFA inside each bin
+        _lowerBounds.assign(nbBins, std::numeric_limits<double>::infinity());
+        for (std::size_t b = 0; b < nbBins; ++b)
+        {
+            const std::size_t kBegin = _offsets[b];
+            const std::size_t kEnd = _offsets[b + 1];
+            if (kEnd == kBegin || kEnd <= std::size_t(startIndex))
+                continue;
+
+            const double nfa = computeNFA(kEnd, computeLogAlpha(_binMax[b]));
+            if (nfa < bestIndex.first)
+            {
+                bestIndex = ErrorIndex(nfa, kEnd);
+                _threshold = _binMax[b];
+            }
+
+            // the residual of the k-th inlier of the bin is at least the smallest residual of the bin
+            const double minLogAlpha = computeLogAlpha(_binMin[b]);
+            for (std::size_t k = std::max(kBegin + 1, std::size_t(startIndex) + 1); k < kEnd; ++k)
+                _lowerBounds[b] = std::min(_lowerBounds[b], computeNFA(k, minLogAlpha));
+        }
+
+        // exact NFA inside the bins that may contain a better NFA
+        for (std::size_t b = 0; b < nbBins; ++b)
+        {
+            if (_lowerBounds[b] >= bestIndex.first)
+                continue;
+
+            const std::size_t kBegin = _offsets[b];
+            const std::size_t kEnd = _offsets[b + 1];
+            std::sort(_sorted.begin() + kBegin, _sorted.begin() + kEnd);
+
+            for (std::size_t k = std::max(kBegin + 1, std::size_t(startIndex) + 1); k < kEnd; ++k)
+            {
+                const double nfa = computeNFA(k, computeLogAlpha(_sorted[k - 1].first));
+                if (nfa < bestIndex.first)
+                {
+                    bestIndex = ErrorIndex(nfa, k);
+                    _threshold = _sorted[k - 1].first;
+                }
+            }
+        }
+        return bestIndex;
+    }
+
+    /**
+     * @brief Squared residual of the last inlier of the last best NFA.
+     */
+    double threshold() const { return _threshold; }
+
+    /**
+     * @brief Get the indices of the inliers of the last best NFA, sorted by residual as with bestNFA.
+     * @param[in] nbInliers The number of inliers returned by best()
+     * @param[out] inliers The inlier indices
+     */
+    void getInliers(std::size_t nbInliers, std::vector<std::size_t>& inliers)
+    {
+        std::sort(_sorted.begin(), _sorted.begin() + nbInliers);
+        inliers.resize(nbInliers);
+        for (std::size_t i = 0; i < nbInliers; ++i)
+            inliers[i] = _sorted[i].second;
+    }
+
+  private:
+    static constexpr std::uint32_t invalidBin = std::numeric_limits<std::uint32_t>::max();
+
+    /// the float bits of a positive value are ordered as the values: exponent and 3 bits of mantissa
+    static std::uint32_t getBin(double squaredResidual)
+    {
+        const float value = static_cast<float>(squaredResidual);
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits >> 20;
+    }
+
+    std::vector<std::uint32_t> _bins;
+    std::vector<std::size_t> _offsets;
+    std::vector<std::size_t> _positions;
+    std::vector<double> _binMin;
+    std::vector<double> _binMax;
+    std::vector<double> _lowerBounds;
+    /// residuals sorted by bin, the bins containing the best NFA are sorted
+    std::vector<ErrorIndex> _sorted;
+    double _threshold = std::numeric_limits<double>::infinity();
+};
+
 /**
  * @brief An implementation of the "Random Sample Consensus" algorithm based on a-contrario estimator
  * to automatically estimate the error threshold.
@@ -139,6 +353,7 @@ inline ErrorIndex bestNFA(int startIndex,  // number of point required for estim
  * @param[in] nIter maximum number of consecutive iterations
  * @param[out] model returned model if found
  * @param[in] precision upper bound of the precision
+ * @param[in] scoring scoring of the models, HISTOGRAM avoids sorting the residuals of each model
  *
  * @return (errorMax, minNFA)
  */
@@ -148,7 +363,8 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
                                    std::vector<size_t>& vec_inliers,
                                    std::size_t nIter = 1024,
                                    typename Kernel::ModelT* model = nullptr,
-                                   double precision = std::numeric_limits<double>::infinity())
+                                   double precision = std::numeric_limits<double>::infinity(),
+                                   EACRansacScoring scoring = EACRansacScoring::EXACT)
 {
     vec_inliers.clear();
 
@@ -162,7 +378,8 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
                                   : precision * precision * kernel.thresholdNormalizer() * kernel.thresholdNormalizer();
 
     std::vector<ErrorIndex> vec_residuals(nData);  // [residual,index]
-    std::vector<double> vec_residuals_(nData);
+    std::vector<std::vector<double>> vec_modelsResiduals;  // Residuals of the models of a sample
+    HistogramNFA histogramNFA;
 
     // Possible sampling indices [0,..,nData] (will change in the optimization phase)
     std::vector<size_t> vec_index(nData);
@@ -195,12 +412,14 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
         std::vector<typename Kernel::ModelT> vec_models;  // Up to max_models solutions
         kernel.fit(vec_sample, vec_models);
 
+        // Residuals computation of all the models, in one pass over the data
+        modelsErrors(kernel, vec_models, vec_modelsResiduals);
+
         // Evaluate models
         bool better = false;
         for (std::size_t k = 0; k < vec_models.size(); ++k)
         {
-            // Residuals computation and ordering
-            kernel.errors(vec_models[k], vec_residuals_);
+            const std::vector<double>& vec_residuals_ = vec_modelsResiduals[k];
 
             if (!bACRansacMode)
             {
@@ -213,7 +432,28 @@ std::pair<double, double> ACRANSAC(const Kernel& kernel,
                 if (nInlier > 2.5 * sizeSample)  // does the model is meaningful
                     bACRansacMode = true;
             }
-            if (bACRansacMode)
+            if (bACRansacMode && scoring == EACRansacScoring::HISTOGRAM)
+            {
+                // Most meaningful discrimination inliers/outliers, without sorting the residuals
+                const ErrorIndex best = histogramNFA.best(
+                  sizeSample, kernel.logalpha0(), vec_residuals_, loge0, maxThreshold, vec_logc_n, vec_logc_k, kernel.errorVectorDimension());
+
+                if (best.first < minNFA)
+                {
+                    // A better model was found
+                    better = true;
+                    minNFA = best.first;
+                    histogramNFA.getInliers(best.second, vec_inliers);
+                    errorMax = histogramNFA.threshold();  // Error threshold
+                    if (model)
+                        *model = vec_models[k];
+
+                    ALICEVISION_LOG_TRACE("  nfa=" << minNFA << " inliers=" << best.second << "/" << nData << " precisionNormalized=" << errorMax
+                                                   << " precision=" << kernel.unormalizeError(errorMax) << " (iter=" << iter
+                                                   << ",sample=" << vec_sample << ")");
+                }
+            }
+            else if (bACRansacMode)
             {
                 for (size_t i = 0; i < nData; ++i)
                 {
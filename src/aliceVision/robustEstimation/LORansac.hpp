@@ -9,6 +9,7 @@
 #include <aliceVision/robustEstimation/randSampling.hpp>
 #include <aliceVision/robustEstimation/ACRansac.hpp>
 #include <aliceVision/robustEstimation/ransacTools.hpp>
+#include <aliceVision/robustEstimation/SPRT.hpp>
 #include <aliceVision/robustEstimation/IRansacKernel.hpp>
 #include <limits>
 #include <numeric>
@@ -51,18 +52,14 @@ double iterativeReweightedLeastSquares(const Kernel& kernel,
                                        std::size_t numIter = 4,
                                        bool verbose = false)
 {
-    const std::size_t total_samples = kernel.nbSamples();
     const std::size_t min_samples = kernel.getMinimumNbRequiredSamplesLS();
     double theta = scorer.getThreshold();
     // used in the iterations to update (reduce) the threshold value
     const double deltaTetha = (mtheta * theta - theta) / (numIter - 1);
 
-    std::vector<std::size_t> all_samples(total_samples);
-    std::iota(all_samples.begin(), all_samples.end(), 0);
-
     // find inliers from best model with threshold theta
     inliers.clear();
-    scorer.score(kernel, best_model, all_samples, inliers, theta);
+    scorer.scoreAllSamples(kernel, best_model, inliers, theta);
 
     if (inliers.size() < min_samples)
     {
@@ -96,7 +93,7 @@ double iterativeReweightedLeastSquares(const Kernel& kernel,
         // find inliers on the best-so-far model
         // @todo maybe inliers instead of all samples to save some computation
         inliers.clear();
-        scorer.score(kernel, models[0], all_samples, inliers, theta);
+        scorer.scoreAllSamples(kernel, models[0], inliers, theta);
 
         if (inliers.size() < min_samples)
         {
@@ -134,7 +131,7 @@ double iterativeReweightedLeastSquares(const Kernel& kernel,
     assert(models.size() == 1);
     best_model = models[0];
     inliers.clear();
-    const double score = scorer.score(kernel, best_model, all_samples, inliers, theta);
+    const double score = scorer.scoreAllSamples(kernel, best_model, inliers, theta);
     if (verbose)
     {
         ALICEVISION_LOG_DEBUG("[IRLS] returning with num inliers: " << inliers.size() << " and score " << score);
@@ -188,16 +185,13 @@ double localOptimization(const Kernel& kernel,
 
     const double theta = scorer.getThreshold();
 
-    std::vector<std::size_t> all_samples(total_samples);
-    std::iota(all_samples.begin(), all_samples.end(), 0);
-
     std::size_t debugInit = 0;
     if (!bestInliers.empty())
     {
         debugInit = bestInliers.size();
         bestInliers.clear();
     }
-    double bestScore = scorer.score(kernel, bestModel, all_samples, bestInliers, theta);
+    double bestScore = scorer.scoreAllSamples(kernel, bestModel, bestInliers, theta);
     if (debugInit != 0)
         assert(debugInit == bestInliers.size());
 
@@ -212,7 +206,7 @@ double localOptimization(const Kernel& kernel,
 
     // find inliers from best model with larger threshold t*m over all the samples
     std::vector<std::size_t> inliersBase;
-    scorer.score(kernel, bestModel, all_samples, inliersBase, theta * mtheta);
+    scorer.scoreAllSamples(kernel, bestModel, inliersBase, theta * mtheta);
     assert((inliersBase.size() > min_samples) && "[localOptimization] not enough data in inliersBase to estimate the model!");
 
     // LS model from the above inliers
@@ -226,7 +220,7 @@ double localOptimization(const Kernel& kernel,
 
     // find inliers with t again over all the samples
     inliersBase.clear();
-    scorer.score(kernel, models[0], all_samples, inliersBase, theta);
+    scorer.scoreAllSamples(kernel, models[0], inliersBase, theta);
 
     // sample of size sampleSize from the last best inliers
     const std::size_t sampleSize = std::min(minSampleSize, inliersBase.size() / 2);
@@ -297,6 +291,8 @@ double localOptimization(const Kernel& kernel,
  * @param[in] bVerbose Enable/Disable log messages
  * @param[in] max_iterations Maximum number of iterations for the ransac part.
  * @param[in] outliers_probability The wanted probability of picking outliers.
+ * @param[in] sprt If not null, the models of the minimal solver are verified with the Sequential
+ * Probability Ratio Test, so most of the bad models are rejected without evaluating all the samples.
  * @return The best model found.
  */
 template<typename Kernel, typename Scorer>
@@ -307,7 +303,8 @@ typename Kernel::ModelT LO_RANSAC(const Kernel& kernel,
                                   double* best_score = NULL,
                                   bool bVerbose = false,
                                   std::size_t max_iterations = 100,
-                                  double outliers_probability = 1e-2)
+                                  double outliers_probability = 1e-2,
+                                  SPRT* sprt = nullptr)
 {
     assert(outliers_probability < 1.0);
     assert(outliers_probability > 0.0);
@@ -331,11 +328,6 @@ typename Kernel::ModelT LO_RANSAC(const Kernel& kernel,
         return bestModel;
     }
 
-    // In this robust estimator, the scorer always works on all the data points
-    // at once. So precompute the list ahead of time [0,..,total_samples].
-    std::vector<std::size_t> all_samples(total_samples);
-    std::iota(all_samples.begin(), all_samples.end(), 0);
-
     for (iteration = 0; iteration < max_iterations; ++iteration)
     {
         std::vector<std::size_t> sample;
@@ -348,7 +340,16 @@ typename Kernel::ModelT LO_RANSAC(const Kernel& kernel,
         for (std::size_t i = 0; i < models.size(); ++i)
         {
             std::vector<std::size_t> inliers;
-            double score = scorer.score(kernel, models.at(i), all_samples, inliers);
+            double score;
+            if (sprt)
+            {
+                if (!sprt->evaluate(kernel, models.at(i), scorer.getThreshold(), inliers, score))
+                    continue;
+            }
+            else
+            {
+                score = scorer.scoreAllSamples(kernel, models.at(i), inliers);
+            }
             if (bVerbose)
             {
                 ALICEVISION_LOG_DEBUG("sample=" << sample);
@@ -381,6 +382,8 @@ typename Kernel::ModelT LO_RANSAC(const Kernel& kernel,
 
                 bestNumInliers = inliers.size();
                 bestInlierRatio = inliers.size() / double(total_samples);
+                if (sprt)
+                    sprt->setInlierRatio(bestInlierRatio);
 
                 if (best_inliers)
                 {
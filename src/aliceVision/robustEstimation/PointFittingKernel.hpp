@@ -9,6 +9,7 @@
 #pragma once
 
 #include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/robustEstimation/batchErrors.hpp>
 #include <aliceVision/robustEstimation/conditioning.hpp>
 #include <aliceVision/robustEstimation/ISolver.hpp>
 
@@ -100,8 +101,21 @@ class PointFittingKernel
     inline virtual void errors(const ModelT& model, std::vector<double>& errors) const
     {
         errors.resize(_x1.cols());
-        for (std::size_t sample = 0; sample < _x1.cols(); ++sample)
-            errors.at(sample) = error(sample, model);
+        blockErrors(&model, 1, &errors);
+    }
+
+    /**
+     * @brief Return the errors associated to several models and each sample point,
+     *        in one pass over the data
+     * @param[in] models
+     * @param[out] errors one vector of errors per model
+     */
+    inline virtual void modelsErrors(const std::vector<ModelT>& models, std::vector<std::vector<double>>& errors) const
+    {
+        errors.resize(models.size());
+        for (std::vector<double>& modelErrors : errors)
+            modelErrors.resize(_x1.cols());
+        blockErrors(models.data(), models.size(), errors.data());
     }
 
     /**
@@ -111,6 +125,42 @@ class PointFittingKernel
     inline std::size_t nbSamples() const { return _x1.cols(); }
 
   protected:
+    /**
+     * @brief Compute the errors of the models with the error estimator.
+     *        If the error estimator supports it, the data is processed by blocks of points stored
+     *        as structures of arrays, each block being loaded once for all the models.
+     * @param[in] models The models
+     * @param[in] nbModels The number of models
+     * @param[out] errors The errors of each model, already sized to the number of samples
+     */
+    void blockErrors(const ModelT* models, std::size_t nbModels, std::vector<double>* errors) const
+    {
+        const std::size_t nbSamples = _x1.cols();
+
+        if constexpr (HasBlockErrors<ErrorT, ModelT>::value)
+        {
+            PointsBlock x1Block;
+            PointsBlock x2Block;
+
+            for (std::size_t begin = 0; begin < nbSamples; begin += pointsBlockSize)
+            {
+                x1Block.load(_x1, begin);
+                x2Block.load(_x2, begin);
+
+                for (std::size_t i = 0; i < nbModels; ++i)
+                    _errorEstimator.errors(models[i], x1Block, x2Block, errors[i].data() + begin);
+            }
+        }
+        else
+        {
+            for (std::size_t i = 0; i < nbModels; ++i)
+            {
+                for (std::size_t sample = 0; sample < nbSamples; ++sample)
+                    errors[i][sample] = _errorEstimator.error(models[i], _x1.col(sample), _x2.col(sample));
+            }
+        }
+    }
+
     /// left corresponding data
     const Mat& _x1;
     /// right corresponding data
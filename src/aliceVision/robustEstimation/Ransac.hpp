@@ -10,6 +10,7 @@
 #include <aliceVision/system/Logger.hpp>
 #include "aliceVision/robustEstimation/randSampling.hpp"
 #include "aliceVision/robustEstimation/ransacTools.hpp"
+#include "aliceVision/robustEstimation/SPRT.hpp"
 #include <limits>
 #include <numeric>
 #include <vector>
@@ -33,6 +34,9 @@ namespace robustEstimation {
  * 2. Kernel::getMinimumNbRequiredSamples()
  * 3. Kernel::fit(vector<int>, vector<Kernel::Model> *)
  * 4. Kernel::error(Model, int) -> error
+ *
+ * @param[in] sprt If not null, the models are verified with the Sequential Probability Ratio Test,
+ *            so most of the bad models are rejected without evaluating all the samples.
  */
 template<typename Kernel, typename Scorer>
 typename Kernel::ModelT RANSAC(const Kernel& kernel,
@@ -41,7 +45,8 @@ typename Kernel::ModelT RANSAC(const Kernel& kernel,
                                std::vector<std::size_t>* best_inliers = nullptr,
                                double* best_score = nullptr,
                                bool bVerbose = true,
-                               double outliers_probability = 1e-2)
+                               double outliers_probability = 1e-2,
+                               SPRT* sprt = nullptr)
 {
     assert(outliers_probability < 1.0);
     assert(outliers_probability > 0.0);
@@ -66,11 +71,6 @@ typename Kernel::ModelT RANSAC(const Kernel& kernel,
         return best_model;
     }
 
-    // In this robust estimator, the scorer always works on all the data points
-    // at once. So precompute the list ahead of time [0,..,total_samples].
-    std::vector<size_t> all_samples(total_samples);
-    std::iota(all_samples.begin(), all_samples.end(), 0);
-
     for (iteration = 0; iteration < max_iterations && iteration < really_max_iterations; ++iteration)
     {
         std::vector<size_t> sample;
@@ -83,13 +83,24 @@ typename Kernel::ModelT RANSAC(const Kernel& kernel,
         for (size_t i = 0; i < models.size(); ++i)
         {
             std::vector<size_t> inliers;
-            scorer.score(kernel, models[i], all_samples, inliers);
+            if (sprt)
+            {
+                double cost;
+                if (!sprt->evaluate(kernel, models[i], scorer.getThreshold(), inliers, cost))
+                    continue;
+            }
+            else
+            {
+                scorer.scoreAllSamples(kernel, models[i], inliers);
+            }
 
             if (best_num_inliers < inliers.size())
             {
                 best_num_inliers = inliers.size();
                 best_inlier_ratio = inliers.size() / double(total_samples);
                 best_model = models[i];
+                if (sprt)
+                    sprt->setInlierRatio(best_inlier_ratio);
                 if (best_inliers)
                 {
                     best_inliers->swap(inliers);
@@ -0,0 +1,188 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace aliceVision {
+namespace robustEstimation {
+
+/**
+ * @brief Sequential Probability Ratio Test for the verification of the models in a RANSAC loop.
+ *
+ * The samples are evaluated one after the other and the likelihood ratio between
+ * the "bad model" and the "good model" hypotheses is updated after each sample.
+ * A model is rejected as soon as the ratio exceeds the decision threshold,
+ * so most of the bad models are rejected after a partial scan of the data.
+ *
+ * @ref Chum, O. and Matas, J. "Optimal Randomized RANSAC", PAMI 2008
+ *
+ * @note delta (the probability of a sample to be consistent with a bad model) is estimated
+ *       from the rejected models, epsilon (the inlier ratio) is the inlier ratio of the best model.
+ * @note The samples are evaluated in a fixed random order, as the test assumes that the
+ *       inliers are not grouped in the data.
+ */
+class SPRT
+{
+  public:
+    /**
+     * @param[in] modelEstimationTime The time to estimate a model from a minimal sample,
+     *            in number of sample evaluations
+     * @param[in] nbModelsPerSample The average number of models estimated from a minimal sample
+     * @param[in] delta The initial probability of a sample to be consistent with a bad model
+     * @param[in] epsilon The initial probability of a sample to be consistent with a good model
+     */
+    explicit SPRT(double modelEstimationTime = 200.0, double nbModelsPerSample = 1.0, double delta = 0.05, double epsilon = 0.2)
+      : _modelEstimationTime(modelEstimationTime),
+        _nbModelsPerSample(nbModelsPerSample),
+        _delta(delta),
+        _epsilon(epsilon)
+    {
+        updateDecisionThreshold();
+    }
+
+    /**
+     * @brief Evaluate a model on all the samples of a kernel, with an early rejection.
+     * @param[in] kernel The kernel
+     * @param[in] model The model to evaluate
+     * @param[in] threshold The inlier threshold
+     * @param[out] inliers The inliers of the model, complete only if the model is accepted
+     * @param[out] cost The sum of the errors, as computed by the ScoreEvaluator, if the model is accepted
+     * @return false if the model has been rejected before the end of the data
+     */
+    template<typename Kernel>
+    bool evaluate(const Kernel& kernel, const typename Kernel::ModelT& model, double threshold, std::vector<std::size_t>& inliers, double& cost)
+    {
+        const std::size_t nbSamples = kernel.nbSamples();
+        // the test is meaningless if a good model is not more likely to explain a sample than a bad one
+        const bool test = (_epsilon > _delta);
+        const double consistentRatio = _delta / _epsilon;
+        const double inconsistentRatio = (1.0 - _delta) / (1.0 - _epsilon);
+
+        if (_order.size() != nbSamples)
+        {
+            _order.resize(nbSamples);
+            std::iota(_order.begin(), _order.end(), 0);
+            std::mt19937 randomNumberGenerator(nbSamples);
+            std::shuffle(_order.begin(), _order.end(), randomNumberGenerator);
+        }
+
+        double likelihoodRatio = 1.0;
+        cost = 0.0;
+        inliers.clear();
+
+        for (std::size_t i = 0; i < nbSamples; ++i)
+        {
+            const std::size_t sample = _order[i];
+            const double error = kernel.error(sample, model);
+            cost += error;
+
+            if (error < threshold)
+            {
+                inliers.push_back(sample);
+                likelihoodRatio *= consistentRatio;
+            }
+            else
+            {
+                likelihoodRatio *= inconsistentRatio;
+            }
+
+            if (test && likelihoodRatio > _decisionThreshold)
+            {
+                // bad model: update the estimation of delta with the rejected model
+                ++_nbRejectedModels;
+                _nbRejectedSamples += i + 1;
+                _nbRejectedInliers += inliers.size();
+                if (_nbRejectedSamples >= minNbRejectedSamples)
+                {
+                    setDelta(static_cast<double>(_nbRejectedInliers) / _nbRejectedSamples);
+                }
+                return false;
+            }
+        }
+        // same inliers order as the ScoreEvaluator
+        std::sort(inliers.begin(), inliers.end());
+        return true;
+    }
+
+    /**
+     * @brief Set the inlier ratio of the best model found so far.
+     */
+    void setInlierRatio(double epsilon)
+    {
+        _epsilon = std::clamp(epsilon, minProbability, maxProbability);
+        updateDecisionThreshold();
+    }
+
+    double getDelta() const { return _delta; }
+    double getEpsilon() const { return _epsilon; }
+    double getDecisionThreshold() const { return _decisionThreshold; }
+    std::size_t getNbRejectedModels() const { return _nbRejectedModels; }
+
+  private:
+    void setDelta(double delta)
+    {
+        delta = std::clamp(delta, minProbability, maxProbability);
+        // avoid the computation of the threshold for a non significant change
+        if (std::abs(delta - _delta) > 0.05 * _delta)
+        {
+            _delta = delta;
+            updateDecisionThreshold();
+        }
+    }
+
+    /**
+     * @brief Compute the optimal decision threshold A, solution of A = tM * C / mS + 1 + log(A)
+     *        (equation 17 of the reference) by fixed point iterations.
+     */
+    void updateDecisionThreshold()
+    {
+        if (_epsilon <= _delta)
+        {
+            _decisionThreshold = std::numeric_limits<double>::infinity();
+            return;
+        }
+        // Kullback-Leibler divergence of the two hypotheses
+        const double C = (1.0 - _delta) * std::log((1.0 - _delta) / (1.0 - _epsilon)) + _delta * std::log(_delta / _epsilon);
+        const double K = _modelEstimationTime * C / _nbModelsPerSample + 1.0;
+
+        double A = K;
+        for (int i = 0; i < 10; ++i)
+        {
+            const double nextA = K + std::log(A);
+            if (std::abs(nextA - A) < 1e-6)
+                break;
+            A = nextA;
+        }
+        _decisionThreshold = A;
+    }
+
+    /// minimum number of samples tested with rejected models to estimate delta
+    static constexpr std::size_t minNbRejectedSamples = 100;
+    static constexpr double minProbability = 1e-4;
+    static constexpr double maxProbability = 1.0 - 1e-4;
+
+    double _modelEstimationTime;
+    double _nbModelsPerSample;
+    double _delta;
+    double _epsilon;
+    double _decisionThreshold = 0.0;
+
+    /// evaluation order of the samples
+    std::vector<std::size_t> _order;
+    std::size_t _nbRejectedModels = 0;
+    std::size_t _nbRejectedSamples = 0;
+    std::size_t _nbRejectedInliers = 0;
+};
+
+}  // namespace robustEstimation
+}  // namespace aliceVision
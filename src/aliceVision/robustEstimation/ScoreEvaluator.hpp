@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include <vector>
+
 namespace aliceVision {
 namespace robustEstimation {
 
@@ -49,6 +51,30 @@ class ScoreEvaluator
         return score(kernel, model, samples, inliers, _threshold);
     }
 
+    /**
+     * @brief Evaluate a model over all the samples of the kernel, with the batch errors computation of the kernel.
+     * @return the same cost and inliers as score() called with all the sample indices
+     */
+    double scoreAllSamples(const Kernel& kernel, const typename Kernel::ModelT& model, std::vector<std::size_t>& inliers, double threshold) const
+    {
+        std::vector<double> errors;
+        kernel.errors(model, errors);
+
+        double cost = 0.0;
+        for (std::size_t j = 0; j < errors.size(); ++j)
+        {
+            cost += errors[j];
+            if (errors[j] < threshold)
+                inliers.push_back(j);
+        }
+        return cost;
+    }
+
+    double scoreAllSamples(const Kernel& kernel, const typename Kernel::ModelT& model, std::vector<std::size_t>& inliers) const
+    {
+        return scoreAllSamples(kernel, model, inliers, _threshold);
+    }
+
     double getThreshold() const { return _threshold; }
 
   private:
@@ -267,3 +267,92 @@ BOOST_AUTO_TEST_CASE(RansacLineFitter_ACRANSACSimu)
         BOOST_CHECK(vec_inliers.size() <= expectedInliers);
     }
 }
+
+// the histogram scoring finds the same NFA as the exact scoring
+BOOST_AUTO_TEST_CASE(ACRansac_HistogramNFA)
+{
+    std::mt19937 gen;
+    const std::size_t sizeSample = 7;
+    const std::size_t nData = 2000;
+    // point to line distance in a 1000x1000 image
+    const double logalpha0 = log10(2.0 * 1414.0 / (1000.0 * 1000.0));
+
+    std::vector<float> vec_logc_n, vec_logc_k;
+    makelogcombi(sizeSample, nData, vec_logc_k, vec_logc_n);
+    const double loge0 = log10(3.0 * (nData - sizeSample));
+
+    HistogramNFA histogramNFA;
+    const int nbTrials = 100;
+
+    for (int trial = 0; trial < nbTrials; ++trial)
+    {
+        // inliers with a small noise and uniform outliers
+        const double inliersRatio = 0.1 + 0.8 * trial / nbTrials;
+        std::normal_distribution<> noise(0.0, 0.5 + trial * 0.05);
+        std::uniform_real_distribution<> outlier(0.0, 1000.0);
+        std::bernoulli_distribution isInlier(inliersRatio);
+
+        std::vector<double> residuals(nData);
+        std::vector<ErrorIndex> sortedResiduals(nData);
+        for (std::size_t i = 0; i < nData; ++i)
+        {
+            const double residual = isInlier(gen) ? noise(gen) : outlier(gen);
+            residuals[i] = residual * residual;
+            sortedResiduals[i] = ErrorIndex(residuals[i], i);
+        }
+        std::sort(sortedResiduals.begin(), sortedResiduals.end());
+
+        const double maxThreshold = std::numeric_limits<double>::infinity();
+        const ErrorIndex exact = bestNFA(sizeSample, logalpha0, sortedResiduals, loge0, maxThreshold, vec_logc_n, vec_logc_k);
+        const ErrorIndex histogram = histogramNFA.best(sizeSample, logalpha0, residuals, loge0, maxThreshold, vec_logc_n, vec_logc_k);
+
+        BOOST_CHECK_SMALL(histogram.first - exact.first, 1e-9 * std::abs(exact.first));
+        BOOST_CHECK_EQUAL(histogram.second, exact.second);
+
+        std::vector<std::size_t> inliers;
+        histogramNFA.getInliers(histogram.second, inliers);
+        BOOST_CHECK_EQUAL(inliers.size(), histogram.second);
+        std::sort(inliers.begin(), inliers.end());
+        std::vector<std::size_t> exactInliers;
+        for (std::size_t i = 0; i < exact.second; ++i)
+            exactInliers.push_back(sortedResiduals[i].second);
+        std::sort(exactInliers.begin(), exactInliers.end());
+        BOOST_CHECK(inliers == exactInliers);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(RansacLineFitter_RealisticCase_Histogram)
+{
+    std::mt19937 randomNumberGenerator;
+    const int NbPoints = 100;
+    const float outlierRatio = .3;
+    Mat2X xy(2, NbPoints);
+
+    Vec2 GTModel;  // y = 6.3 x + (-2.0)
+    GTModel << -2.0, 6.3;
+
+    for (Mat::Index i = 0; i < NbPoints; ++i)
+    {
+        xy.col(i) << i, (double)i * GTModel[1] + GTModel[0];
+    }
+
+    std::mt19937 gen;
+    std::normal_distribution<> d(0, 5);
+
+    const int nbPtToNoise = (int)NbPoints * outlierRatio;
+    for (int i = 0; i < nbPtToNoise; ++i)
+    {
+        xy.col(i) << d(gen), d(gen);
+    }
+
+    LineKernel lineKernel(xy, 12, 12);
+
+    std::vector<std::size_t> inliers;
+    robustEstimation::MatrixModel<Vec2> model;
+
+    ACRANSAC(lineKernel, randomNumberGenerator, inliers, 300, &model, std::numeric_limits<double>::infinity(), EACRansacScoring::HISTOGRAM);
+
+    BOOST_CHECK_EQUAL(NbPoints - nbPtToNoise, inliers.size());
+    BOOST_CHECK_SMALL(GTModel(0) - model.getMatrix()[0], 1e-9);
+    BOOST_CHECK_SMALL(GTModel(1) - model.getMatrix()[1], 1e-9);
+}
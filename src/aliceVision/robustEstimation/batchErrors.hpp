@@ -0,0 +1,118 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/numeric/numeric.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace aliceVision {
+namespace robustEstimation {
+
+/// Number of points of a block in the batch errors evaluation
+constexpr std::size_t pointsBlockSize = 128;
+
+/// Array of at most pointsBlockSize values, allocated on the stack
+using PointsBlockArray = Eigen::Array<double, Eigen::Dynamic, 1, Eigen::ColMajor, pointsBlockSize, 1>;
+
+/**
+ * @brief A block of consecutive points stored coordinate by coordinate (structure of arrays),
+ *        so the errors of a model over the block are computed with vectorized array expressions.
+ */
+struct PointsBlock
+{
+    using ConstCoordinates = Eigen::Map<const Eigen::Array<double, Eigen::Dynamic, 1>>;
+
+    /**
+     * @brief Copy the points [begin, begin + pointsBlockSize[ of a matrix of column points.
+     * @param[in] x The points, one per column, with at most 3 coordinates
+     * @param[in] begin The index of the first point of the block
+     */
+    void load(const Mat& x, std::size_t begin)
+    {
+        assert(x.rows() <= 3);
+        size = std::min(pointsBlockSize, static_cast<std::size_t>(x.cols()) - begin);
+        dim = static_cast<std::size_t>(x.rows());
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            for (std::size_t d = 0; d < dim; ++d)
+                coordinates[d][i] = x(d, begin + i);
+        }
+    }
+
+    /**
+     * @brief Get the values of a coordinate for all the points of the block.
+     */
+    ConstCoordinates coordinate(std::size_t d) const { return ConstCoordinates(coordinates[d], size); }
+
+    /// number of points in the block
+    std::size_t size = 0;
+    /// number of coordinates of the points
+    std::size_t dim = 0;
+    /// the coordinates of the points
+    double coordinates[3][pointsBlockSize];
+};
+
+/**
+ * @brief Check if an error functor is able to compute the errors of a model over a PointsBlock:
+ *        void errors(const ModelT& model, const PointsBlock& x1, const PointsBlock& x2, double* errors) const
+ */
+template<typename ErrorT, typename ModelT, typename = void>
+struct HasBlockErrors : std::false_type
+{};
+
+template<typename ErrorT, typename ModelT>
+struct HasBlockErrors<ErrorT,
+                      ModelT,
+                      std::void_t<decltype(std::declval<const ErrorT&>().errors(
+                        std::declval<const ModelT&>(), std::declval<const PointsBlock&>(), std::declval<const PointsBlock&>(), std::declval<double*>()))>>
+  : std::true_type
+{};
+
+/**
+ * @brief Check if a kernel is able to compute the errors of several models in one pass over the data:
+ *        void modelsErrors(const std::vector<ModelT>& models, std::vector<std::vector<double>>& errors) const
+ */
+template<typename Kernel, typename = void>
+struct HasModelsErrors : std::false_type
+{};
+
+template<typename Kernel>
+struct HasModelsErrors<Kernel,
+                       std::void_t<decltype(std::declval<const Kernel&>().modelsErrors(
+                         std::declval<const std::vector<typename Kernel::ModelT>&>(), std::declval<std::vector<std::vector<double>>&>()))>>
+  : std::true_type
+{};
+
+/**
+ * @brief Compute the errors of several models for all the elements of a kernel.
+ *        Use the one pass evaluation of the kernel if available, one kernel.errors() call per model otherwise.
+ * @param[in] kernel The kernel
+ * @param[in] models The models to evaluate
+ * @param[out] errors The errors of each model for each element
+ */
+template<typename Kernel>
+void modelsErrors(const Kernel& kernel, const std::vector<typename Kernel::ModelT>& models, std::vector<std::vector<double>>& errors)
+{
+    if constexpr (HasModelsErrors<Kernel>::value)
+    {
+        kernel.modelsErrors(models, errors);
+    }
+    else
+    {
+        errors.resize(models.size());
+        for (std::size_t i = 0; i < models.size(); ++i)
+            kernel.errors(models[i], errors[i]);
+    }
+}
+
+}  // namespace robustEstimation
+}  // namespace aliceVision
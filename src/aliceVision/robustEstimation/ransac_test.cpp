@@ -101,3 +101,31 @@ BOOST_AUTO_TEST_CASE(MaxConsensusLineFitter_RealisticCase)
     BOOST_CHECK_SMALL((-2.0) - model.getMatrix()[0], 1e-9);
     BOOST_CHECK_SMALL(6.3 - model.getMatrix()[1], 1e-9);
 }
+
+// Test the early rejection of the bad models with the SPRT
+BOOST_AUTO_TEST_CASE(MaxConsensusLineFitter_RealisticCase_SPRT)
+{
+    std::mt19937 randomNumberGenerator;
+
+    const int NbPoints = 1000;
+    const double outlierRatio = .5;
+    Mat2X xy(2, NbPoints);
+    std::mt19937 gen;
+
+    Vec2 GTModel;
+    GTModel << -2.0, 6.3;
+
+    const std::size_t nbPtToNoise = (std::size_t)NbPoints * outlierRatio;
+    std::vector<std::size_t> vec_inliersGT;
+    generateLine(NbPoints, outlierRatio, 0.0, GTModel, gen, xy, vec_inliersGT);
+
+    LineKernel kernel(xy);
+    std::vector<size_t> inliers;
+    SPRT sprt;
+    LineKernel::ModelT model = RANSAC(kernel, ScoreEvaluator<LineKernel>(0.3), randomNumberGenerator, &inliers, nullptr, false, 1e-2, &sprt);
+    BOOST_CHECK_EQUAL(NbPoints - nbPtToNoise, inliers.size());
+    BOOST_CHECK_SMALL((-2.0) - model.getMatrix()[0], 1e-9);
+    BOOST_CHECK_SMALL(6.3 - model.getMatrix()[1], 1e-9);
+    BOOST_CHECK_GT(sprt.getNbRejectedModels(), 0);
+    BOOST_CHECK_CLOSE(sprt.getEpsilon(), 1.0 - outlierRatio, 1e-6);
+}
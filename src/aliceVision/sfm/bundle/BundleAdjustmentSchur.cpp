@@ -0,0 +1,1049 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/bundle/BundleAdjustmentSchur.hpp>
+#include <aliceVision/sfm/LocalBundleAdjustmentGraph.hpp>
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/camera/IntrinsicScaleOffset.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <Eigen/Cholesky>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+namespace aliceVision {
+namespace sfm {
+
+using namespace aliceVision::camera;
+using namespace aliceVision::geometry;
+
+namespace {
+
+/// bounds of the diagonal used to damp the normal equations (same as Ceres)
+constexpr double minDiagonal = 1e-6;
+constexpr double maxDiagonal = 1e32;
+/// damping above which the iterations are stopped
+constexpr double maxDamping = 1e16;
+
+/// Huber loss rho(s) of a squared residual norm s, same as ceres::HuberLoss(a)
+inline double huberLoss(double s, double a) { return (s <= a * a) ? s : 2.0 * a * std::sqrt(s) - a * a; }
+
+/// first derivative of the Huber loss, used to weight the residuals and the Jacobians
+inline double huberLossDerivative(double s, double a) { return (s <= a * a) ? 1.0 : a / std::sqrt(s); }
+
+inline double clampDiagonal(double value) { return std::min(std::max(value, minDiagonal), maxDiagonal); }
+
+/// Eigen map of a column major (rows x cols) block stored in a vector
+inline Eigen::Map<Eigen::MatrixXd> mapBlock(std::vector<double>& values, std::size_t offset, std::size_t rows, std::size_t cols)
+{
+    return Eigen::Map<Eigen::MatrixXd>(values.data() + offset, rows, cols);
+}
+
+inline Eigen::Map<const Eigen::MatrixXd> mapBlock(const std::vector<double>& values, std::size_t offset, std::size_t rows, std::size_t cols)
+{
+    return Eigen::Map<const Eigen::MatrixXd>(values.data() + offset, rows, cols);
+}
+
+}  // namespace
+
+void BundleAdjustmentSchur::Statistics::show() const
+{
+    std::map<EParameter, std::map<EParameterState, std::size_t>> states = parametersStates;
+
+    ALICEVISION_LOG_INFO("Bundle Adjustment Statistics:\n"
+                         << "\t- local strategy enabled: " << (nbCamerasPerDistance.empty() ? "no" : "yes") << "\n"
+                         << "\t- adjustment duration: " << time << " s\n"
+                         << "\t    - reduced system assembly: " << assemblyTime << " s\n"
+                         << "\t    - linear solver: " << linearSolverTime << " s\n"
+                         << "\t- poses:\n"
+                         << "\t    - # refined:  " << states[EParameter::POSE][EParameterState::REFINED] << "\n"
+                         << "\t    - # constant: " << states[EParameter::POSE][EParameterState::CONSTANT] << "\n"
+                         << "\t    - # ignored:  " << states[EParameter::POSE][EParameterState::IGNORED] << "\n"
+                         << "\t- landmarks:\n"
+                         << "\t    - # refined:  " << states[EParameter::LANDMARK][EParameterState::REFINED] << "\n"
+                         << "\t    - # constant: " << states[EParameter::LANDMARK][EParameterState::CONSTANT] << "\n"
+                         << "\t    - # ignored:  " << states[EParameter::LANDMARK][EParameterState::IGNORED] << "\n"
+                         << "\t- intrinsics:\n"
+                         << "\t    - # refined:  " << states[EParameter::INTRINSIC][EParameterState::REFINED] << "\n"
+                         << "\t    - # constant: " << states[EParameter::INTRINSIC][EParameterState::CONSTANT] << "\n"
+                         << "\t    - # ignored:  " << states[EParameter::INTRINSIC][EParameterState::IGNORED] << "\n"
+                         << "\t- # residual blocks: " << nbResidualBlocks << "\n"
+                         << "\t- # successful iterations: " << nbSuccessfullIterations << "\n"
+                         << "\t- # unsuccessful iterations: " << nbUnsuccessfullIterations << "\n"
+                         << "\t- # linear solver iterations: " << nbLinearIterations << "\n"
+                         << "\t- initial RMSE: " << RMSEinitial << "\n"
+                         << "\t- final   RMSE: " << RMSEfinal);
+}
+
+BundleAdjustment::EParameterState BundleAdjustmentSchur::getPoseState(IndexT poseId) const
+{
+    return (_localGraph != nullptr ? _localGraph->getPoseState(poseId) : BundleAdjustment::EParameterState::REFINED);
+}
+
+BundleAdjustment::EParameterState BundleAdjustmentSchur::getIntrinsicState(IndexT intrinsicId) const
+{
+    return (_localGraph != nullptr ? _localGraph->getIntrinsicState(intrinsicId) : BundleAdjustment::EParameterState::REFINED);
+}
+
+BundleAdjustment::EParameterState BundleAdjustmentSchur::getLandmarkState(IndexT landmarkId) const
+{
+    return (_localGraph != nullptr ? _localGraph->getLandmarkState(landmarkId) : BundleAdjustment::EParameterState::REFINED);
+}
+
+void BundleAdjustmentSchur::resetProblem()
+{
+    _statistics = Statistics();
+
+    _poses.clear();
+    _poseTransforms.clear();
+    _intrinsics.clear();
+    _landmarkIds.clear();
+    _landmarks.clear();
+    _landmarkRefined.clear();
+    _observations = ObservationsData();
+
+    _groupOffsets.clear();
+    _groupSizes.clear();
+    _nbPoseGroups = 0;
+    _poseObservationsOffsets.clear();
+    _poseObservations.clear();
+}
+
+void BundleAdjustmentSchur::addIntrinsicsToProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions)
+{
+    const bool refineIntrinsicsOpticalCenter =
+      (refineOptions & REFINE_INTRINSICS_OPTICALOFFSET_ALWAYS) || (refineOptions & REFINE_INTRINSICS_OPTICALOFFSET_IF_ENOUGH_DATA);
+    const bool refineIntrinsicsFocalLength = refineOptions & REFINE_INTRINSICS_FOCAL;
+    const bool refineIntrinsicsDistortion = refineOptions & REFINE_INTRINSICS_DISTORTION;
+    const bool refineIntrinsics = refineIntrinsicsDistortion || refineIntrinsicsFocalLength || refineIntrinsicsOpticalCenter;
+
+    // count the number of reconstructed views per intrinsic
+    std::map<IndexT, std::size_t> intrinsicsUsage;
+    for (const auto& viewPair : sfmData.getViews())
+    {
+        const sfmData::View& view = *(viewPair.second);
+        std::size_t& usage = intrinsicsUsage[view.getIntrinsicId()];
+        if (sfmData.isPoseAndIntrinsicDefined(&view))
+            ++usage;
+    }
+
+    for (const auto& intrinsicPair : sfmData.getIntrinsics())
+    {
+        const IndexT intrinsicId = intrinsicPair.first;
+        const auto& intrinsicPtr = intrinsicPair.second;
+        const auto usageIt = intrinsicsUsage.find(intrinsicId);
+        if (usageIt == intrinsicsUsage.end())
+            // if the intrinsic is never referenced by any view, skip it
+            continue;
+        const std::size_t usageCount = usageIt->second;
+
+        // do not refine an intrinsic does not used by any reconstructed view
+        if (usageCount <= 0 || getIntrinsicState(intrinsicId) == EParameterState::IGNORED)
+        {
+            _statistics.addState(EParameter::INTRINSIC, EParameterState::IGNORED);
+            continue;
+        }
+
+        IntrinsicBlock block;
+        block.intrinsicId = intrinsicId;
+        block.intrinsic.reset(intrinsicPtr->clone());
+        block.params = intrinsicPtr->getParams();
+        block.lowerBounds.assign(block.params.size(), -std::numeric_limits<double>::infinity());
+        block.upperBounds.assign(block.params.size(), std::numeric_limits<double>::infinity());
+
+        // keep the camera intrinsic constant
+        if (intrinsicPtr->isLocked() || !refineIntrinsics || getIntrinsicState(intrinsicId) == EParameterState::CONSTANT ||
+            block.params.size() < 4)
+        {
+            _statistics.addState(EParameter::INTRINSIC, EParameterState::CONSTANT);
+            _intrinsics.push_back(std::move(block));
+            continue;
+        }
+
+        // constant parameters
+        bool lockCenter = false;
+        bool lockFocal = false;
+        bool lockRatio = true;
+        double focalRatio = 1.0;
+
+        // refine the focal length
+        if (refineIntrinsicsFocalLength)
+        {
+            const std::shared_ptr<IntrinsicScaleOffset> intrinsicScaleOffset = std::dynamic_pointer_cast<IntrinsicScaleOffset>(intrinsicPtr);
+            if (intrinsicScaleOffset && intrinsicScaleOffset->getInitialScale().x() > 0 && intrinsicScaleOffset->getInitialScale().y() > 0 &&
+                _options.useFocalPrior)
+            {
+                // if we have an initial guess, we only authorize a margin around this value.
+                const unsigned int maxFocalError = 0.2 * std::max(intrinsicPtr->w(), intrinsicPtr->h());
+                block.lowerBounds[0] = intrinsicScaleOffset->getInitialScale().x() - maxFocalError;
+                block.upperBounds[0] = intrinsicScaleOffset->getInitialScale().x() + maxFocalError;
+                block.lowerBounds[1] = intrinsicScaleOffset->getInitialScale().y() - maxFocalError;
+                block.upperBounds[1] = intrinsicScaleOffset->getInitialScale().y() + maxFocalError;
+            }
+            else  // no initial guess
+            {
+                // we don't have an initial guess, but we assume that we use
+                // a converging lens, so the focal length should be positive.
+                block.lowerBounds[0] = 0.0;
+                block.lowerBounds[1] = 0.0;
+            }
+
+            focalRatio = block.params[1] / block.params[0];
+            if (intrinsicScaleOffset)
+                lockRatio = intrinsicScaleOffset->isRatioLocked();
+        }
+        else
+        {
+            // set focal length as constant
+            lockFocal = true;
+        }
+
+        // optical center
+        if ((refineOptions & REFINE_INTRINSICS_OPTICALOFFSET_ALWAYS) ||
+            ((refineOptions & REFINE_INTRINSICS_OPTICALOFFSET_IF_ENOUGH_DATA) && _minNbImagesToRefineOpticalCenter > 0 &&
+             usageCount >= _minNbImagesToRefineOpticalCenter))
+        {
+            // refine optical center within 10% of the image size.
+            const double opticalCenterMinPercent = -0.05;
+            const double opticalCenterMaxPercent = 0.05;
+
+            // add bounds to the principal point
+            block.lowerBounds[2] = opticalCenterMinPercent * intrinsicPtr->w();
+            block.upperBounds[2] = opticalCenterMaxPercent * intrinsicPtr->w();
+            block.lowerBounds[3] = opticalCenterMinPercent * intrinsicPtr->h();
+            block.upperBounds[3] = opticalCenterMaxPercent * intrinsicPtr->h();
+        }
+        else
+        {
+            // don't refine the optical center
+            lockCenter = true;
+        }
+
+        // lens distortion
+        const bool lockDistortion = !refineIntrinsicsDistortion || intrinsicPtr->getDistortionInitializationMode() == camera::EInitMode::CALIBRATED;
+
+        // tangent parameters, same as IntrinsicsManifoldSymbolic
+        const std::size_t distortionSize = block.params.size() - 4;
+        const std::size_t tangentSize = (lockFocal ? 0 : (lockRatio ? 1 : 2)) + (lockCenter ? 0 : 2) + (lockDistortion ? 0 : distortionSize);
+
+        block.tangentMapping.setZero(block.params.size(), tangentSize);
+        std::size_t posDelta = 0;
+        if (!lockFocal)
+        {
+            block.tangentMapping(0, posDelta) = 1.0;
+            if (lockRatio)
+            {
+                block.tangentMapping(1, posDelta++) = focalRatio;
+            }
+            else
+            {
+                block.tangentMapping(1, ++posDelta) = 1.0;
+                ++posDelta;
+            }
+        }
+        if (!lockCenter)
+        {
+            block.tangentMapping(2, posDelta++) = 1.0;
+            block.tangentMapping(3, posDelta++) = 1.0;
+        }
+        if (!lockDistortion)
+        {
+            for (std::size_t i = 0; i < distortionSize; ++i)
+                block.tangentMapping(4 + i, posDelta++) = 1.0;
+        }
+
+        _statistics.addState(EParameter::INTRINSIC, (tangentSize > 0) ? EParameterState::REFINED : EParameterState::CONSTANT);
+        _intrinsics.push_back(std::move(block));
+    }
+}
+
+bool BundleAdjustmentSchur::createProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions)
+{
+    resetProblem();
+
+    if (refineOptions & REFINE_STRUCTURE_AS_NORMALS)
+    {
+        ALICEVISION_LOG_WARNING("BundleAdjustmentSchur: the refinement of the structure as normals is not supported.");
+        return false;
+    }
+    if (!sfmData.getConstraints2D().empty() || !sfmData.getRotationPriors().empty())
+    {
+        ALICEVISION_LOG_WARNING("BundleAdjustmentSchur: the 2D constraints and the rotation priors are not supported.");
+        return false;
+    }
+
+    const bool refineTranslation = refineOptions & REFINE_TRANSLATION;
+    const bool refineRotation = refineOptions & REFINE_ROTATION;
+    const bool refineStructure = refineOptions & REFINE_STRUCTURE;
+
+    // left update of the pose, same as SE3ManifoldLeft
+    _poseTangentMapping.setZero();
+    if (refineRotation)
+    {
+        _poseTangentMapping(1, 2) = 1;
+        _poseTangentMapping(2, 1) = -1;
+        _poseTangentMapping(4, 2) = -1;
+        _poseTangentMapping(6, 0) = 1;
+        _poseTangentMapping(8, 1) = 1;
+        _poseTangentMapping(9, 0) = -1;
+    }
+    if (refineTranslation)
+    {
+        _poseTangentMapping(12, 3) = 1;
+        _poseTangentMapping(13, 4) = 1;
+        _poseTangentMapping(14, 5) = 1;
+    }
+
+    // poses
+    std::map<IndexT, int> posesIndexes;
+    for (const auto& posePair : sfmData.getPoses())
+    {
+        const IndexT poseId = posePair.first;
+        const sfmData::CameraPose& pose = posePair.second;
+        const EParameterState state = getPoseState(poseId);
+
+        // skip camera pose set as Ignored in the Local strategy
+        if (state == EParameterState::IGNORED)
+        {
+            _statistics.addState(EParameter::POSE, EParameterState::IGNORED);
+            continue;
+        }
+
+        PoseBlock block;
+        block.poseId = poseId;
+
+        // keep the camera extrinsics constants
+        if (pose.isLocked() || state == EParameterState::CONSTANT || (!refineTranslation && !refineRotation))
+        {
+            _statistics.addState(EParameter::POSE, EParameterState::CONSTANT);
+        }
+        else
+        {
+            _statistics.addState(EParameter::POSE, EParameterState::REFINED);
+            block.group = _nbPoseGroups++;
+        }
+
+        posesIndexes[poseId] = _poses.size();
+        _poses.push_back(block);
+        _poseTransforms.push_back(pose.getTransform().getHomogeneous());
+    }
+
+    // intrinsics
+    addIntrinsicsToProblem(sfmData, refineOptions);
+    std::map<IndexT, int> intrinsicsIndexes;
+    for (std::size_t i = 0; i < _intrinsics.size(); ++i)
+        intrinsicsIndexes[_intrinsics[i].intrinsicId] = i;
+
+    // landmarks and observations, sorted by landmark
+    _observations.landmarkOffsets.push_back(0);
+    for (const auto& landmarkPair : sfmData.getLandmarks())
+    {
+        const IndexT landmarkId = landmarkPair.first;
+        const sfmData::Landmark& landmark = landmarkPair.second;
+        const EParameterState state = getLandmarkState(landmarkId);
+
+        // do not create residuals if the landmark have been set as Ignored by the Local BA strategy
+        if (state == EParameterState::IGNORED)
+        {
+            _statistics.addState(EParameter::LANDMARK, EParameterState::IGNORED);
+            continue;
+        }
+
+        const bool refined = refineStructure && state != EParameterState::CONSTANT;
+        _statistics.addState(EParameter::LANDMARK, refined ? EParameterState::REFINED : EParameterState::CONSTANT);
+
+        const std::size_t landmarkIndex = _landmarks.size();
+        _landmarkIds.push_back(landmarkId);
+        _landmarks.push_back(landmark.X);
+        _landmarkRefined.push_back(refined);
+
+        for (const auto& observationPair : landmark.observations)
+        {
+            const sfmData::View& view = sfmData.getView(observationPair.first);
+            const sfmData::Observation& observation = observationPair.second;
+
+            if (!view.isPoseIndependant())
+            {
+                ALICEVISION_LOG_WARNING("BundleAdjustmentSchur: the rigs are not supported.");
+                return false;
+            }
+
+            const auto poseIt = posesIndexes.find(view.getPoseId());
+            const auto intrinsicIt = intrinsicsIndexes.find(view.getIntrinsicId());
+            if (poseIt == posesIndexes.end() || intrinsicIt == intrinsicsIndexes.end())
+                continue;
+
+            _observations.landmarks.push_back(landmarkIndex);
+            _observations.poses.push_back(poseIt->second);
+            _observations.intrinsics.push_back(intrinsicIt->second);
+            _observations.x.push_back(observation.x(0));
+            _observations.y.push_back(observation.x(1));
+            _observations.invScales.push_back((observation.scale > 1e-12) ? 1.0 / observation.scale : 1.0);
+        }
+        _observations.landmarkOffsets.push_back(_observations.size());
+    }
+
+    // camera groups of the reduced system: the refined poses, then the refined intrinsics
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < _nbPoseGroups; ++i)
+    {
+        _groupOffsets.push_back(offset);
+        _groupSizes.push_back(6);
+        offset += 6;
+    }
+    for (IntrinsicBlock& block : _intrinsics)
+    {
+        if (block.tangentMapping.cols() == 0)
+            continue;
+        block.group = _groupSizes.size();
+        _groupOffsets.push_back(offset);
+        _groupSizes.push_back(block.tangentMapping.cols());
+        offset += block.tangentMapping.cols();
+    }
+
+    // offsets of the intrinsic Jacobians and observations of each refined pose
+    _observations.intrinsicOffsets.resize(_observations.size());
+    _poseObservationsOffsets.assign(_nbPoseGroups + 1, 0);
+    std::size_t intrinsicOffset = 0;
+    for (std::size_t i = 0; i < _observations.size(); ++i)
+    {
+        _observations.intrinsicOffsets[i] = intrinsicOffset;
+        intrinsicOffset += _intrinsics[_observations.intrinsics[i]].tangentMapping.cols();
+
+        const int poseGroup = _poses[_observations.poses[i]].group;
+        if (poseGroup >= 0)
+            ++_poseObservationsOffsets[poseGroup + 1];
+    }
+    for (std::size_t g = 0; g < _nbPoseGroups; ++g)
+        _poseObservationsOffsets[g + 1] += _poseObservationsOffsets[g];
+
+    _poseObservations.resize(_poseObservationsOffsets.back());
+    std::vector<std::size_t> poseObservationsPositions(_poseObservationsOffsets.begin(), _poseObservationsOffsets.end() - 1);
+    for (std::size_t i = 0; i < _observations.size(); ++i)
+    {
+        const int poseGroup = _poses[_observations.poses[i]].group;
+        if (poseGroup >= 0)
+            _poseObservations[poseObservationsPositions[poseGroup]++] = i;
+    }
+
+    // linearization buffers
+    const std::size_t nbObservations = _observations.size();
+    _residuals.resize(nbObservations);
+    _poseJacobians.resize(nbObservations);
+    _landmarkJacobians.resize(nbObservations);
+    _intrinsicJacobians.resize(2 * intrinsicOffset);
+    _poseLandmarkBlocks.resize(nbObservations);
+    _intrinsicLandmarkBlocks.resize(3 * intrinsicOffset);
+    _landmarkHessians.resize(_landmarks.size());
+    _landmarkInverseHessians.resize(_landmarks.size());
+    _landmarkGradients.resize(_landmarks.size());
+    _landmarkDiagonals.resize(_landmarks.size());
+
+    _statistics.nbResidualBlocks = nbObservations;
+    return true;
+}
+
+double BundleAdjustmentSchur::computeCost(const std::vector<SE3::Matrix>& poseTransforms, const std::vector<Vec3>& landmarks) const
+{
+    // the costs are summed in the order of the landmarks, so the result does not depend on the number of threads
+    std::vector<double> landmarksCosts(landmarks.size(), 0.0);
+
+#pragma omp parallel for schedule(dynamic, 64) num_threads(_options.nbThreads)
+    for (int l = 0; l < landmarks.size(); ++l)
+    {
+        const Vec4 pth = landmarks[l].homogeneous();
+        double cost = 0.0;
+        for (std::size_t i = _observations.landmarkOffsets[l]; i < _observations.landmarkOffsets[l + 1]; ++i)
+        {
+            const Eigen::Matrix4d T = poseTransforms[_observations.poses[i]];
+            const Vec2 projection = _intrinsics[_observations.intrinsics[i]].intrinsic->project(T, pth);
+            const Vec2 residual = (projection - Vec2(_observations.x[i], _observations.y[i])) * _observations.invScales[i];
+            cost += huberLoss(residual.squaredNorm(), _options.lossFunctionThreshold);
+        }
+        landmarksCosts[l] = cost;
+    }
+
+    double cost = 0.0;
+    for (const double landmarkCost : landmarksCosts)
+        cost += landmarkCost;
+    return 0.5 * cost;
+}
+
+void BundleAdjustmentSchur::linearize()
+{
+#pragma omp parallel for schedule(dynamic, 64) num_threads(_options.nbThreads)
+    for (int l = 0; l < _landmarks.size(); ++l)
+    {
+        const Vec4 pth = _landmarks[l].homogeneous();
+        const bool landmarkRefined = _landmarkRefined[l];
+
+        Mat3 hessian = Mat3::Zero();
+        Vec3 gradient = Vec3::Zero();
+
+        for (std::size_t i = _observations.landmarkOffsets[l]; i < _observations.landmarkOffsets[l + 1]; ++i)
+        {
+            const Eigen::Matrix4d T = _poseTransforms[_observations.poses[i]];
+            const IntrinsicBlock& intrinsicBlock = _intrinsics[_observations.intrinsics[i]];
+            const IntrinsicBase& intrinsic = *intrinsicBlock.intrinsic;
+
+            const Vec2 residual = (intrinsic.project(T, pth) - Vec2(_observations.x[i], _observations.y[i])) * _observations.invScales[i];
+
+            // robust loss: the residual and the Jacobians are weighted by sqrt(rho')
+            const double sqrtWeight = std::sqrt(huberLossDerivative(residual.squaredNorm(), _options.lossFunctionThreshold));
+            const double jacobianScale = sqrtWeight * _observations.invScales[i];
+            _residuals[i] = sqrtWeight * residual;
+
+            if (_poses[_observations.poses[i]].group >= 0)
+                _poseJacobians[i] = jacobianScale * intrinsic.getDerivativeProjectWrtPoseLeft(T, pth) * _poseTangentMapping;
+            else
+                _poseJacobians[i].setZero();
+
+            const std::size_t tangentSize = intrinsicBlock.tangentMapping.cols();
+            Eigen::Map<Eigen::MatrixXd> intrinsicJacobian(_intrinsicJacobians.data() + 2 * _observations.intrinsicOffsets[i], 2, tangentSize);
+            if (tangentSize > 0)
+                intrinsicJacobian = jacobianScale * intrinsic.getDerivativeProjectWrtParams(T, pth) * intrinsicBlock.tangentMapping;
+
+            if (!landmarkRefined)
+                continue;
+
+            const Eigen::Matrix<double, 2, 3> landmarkJacobian = jacobianScale * intrinsic.getDerivativeProjectWrtPoint3(T, pth);
+            _landmarkJacobians[i] = landmarkJacobian;
+            hessian += landmarkJacobian.transpose() * landmarkJacobian;
+            gradient += landmarkJacobian.transpose() * _residuals[i];
+
+            _poseLandmarkBlocks[i] = _poseJacobians[i].transpose() * landmarkJacobian;
+            if (tangentSize > 0)
+            {
+                Eigen::Map<Eigen::MatrixXd> intrinsicLandmarkBlock(
+                  _intrinsicLandmarkBlocks.data() + 3 * _observations.intrinsicOffsets[i], tangentSize, 3);
+                intrinsicLandmarkBlock = intrinsicJacobian.transpose() * landmarkJacobian;
+            }
+        }
+
+        _landmarkHessians[l] = hessian;
+        _landmarkGradients[l] = gradient;
+        _landmarkDiagonals[l] = hessian.diagonal();
+    }
+}
+
+void BundleAdjustmentSchur::assembleReducedSystem(double damping)
+{
+    const std::size_t nbGroups = _groupSizes.size();
+    const std::size_t nbCameraParameters = nbGroups > 0 ? _groupOffsets.back() + _groupSizes.back() : 0;
+
+    _reducedSystem.resize(nbGroups);
+    _cameraGradient.setZero(nbCameraParameters);
+    _reducedGradient.setZero(nbCameraParameters);
+    _cameraDiagonal.setZero(nbCameraParameters);
+    _preconditioner.resize(nbGroups);
+
+    // damped landmarks hessians
+#pragma omp parallel for num_threads(_options.nbThreads)
+    for (int l = 0; l < _landmarks.size(); ++l)
+    {
+        if (!_landmarkRefined[l])
+            continue;
+        Mat3 hessian = _landmarkHessians[l];
+        for (int d = 0; d < 3; ++d)
+            hessian(d, d) += damping * clampDiagonal(_landmarkDiagonals[l](d));
+        _landmarkInverseHessians[l] = hessian.ldlt().solve(Mat3::Identity());
+    }
+
+    // block rows of the refined poses, each row is assembled by a single thread
+#pragma omp parallel num_threads(_options.nbThreads)
+    {
+        std::vector<int> blockIndexes(nbGroups, -1);
+
+#pragma omp for schedule(dynamic)
+        for (int a = 0; a < _nbPoseGroups; ++a)
+        {
+            BlockRow& row = _reducedSystem[a];
+            row.clear();
+
+            // index of the block (a, b) in the row, created if needed
+            const auto getBlock = [&](int b) -> std::size_t {
+                if (blockIndexes[b] < 0)
+                {
+                    blockIndexes[b] = row.columns.size();
+                    row.columns.push_back(b);
+                    row.offsets.push_back(row.values.size());
+                    row.values.resize(row.values.size() + 6 * _groupSizes[b], 0.0);
+                }
+                return row.offsets[blockIndexes[b]];
+            };
+
+            // the diagonal block is the first block of the row
+            getBlock(a);
+
+            Eigen::Matrix<double, 6, 1> gradient = Eigen::Matrix<double, 6, 1>::Zero();
+            Eigen::Matrix<double, 6, 1> reducedGradient = Eigen::Matrix<double, 6, 1>::Zero();
+            Eigen::Matrix<double, 6, 1> diagonal = Eigen::Matrix<double, 6, 1>::Zero();
+
+            for (std::size_t k = _poseObservationsOffsets[a]; k < _poseObservationsOffsets[a + 1]; ++k)
+            {
+                const std::size_t i = _poseObservations[k];
+                const Eigen::Matrix<double, 2, 6>& poseJacobian = _poseJacobians[i];
+
+                gradient += poseJacobian.transpose() * _residuals[i];
+                diagonal += poseJacobian.colwise().squaredNorm().transpose();
+                mapBlock(row.values, getBlock(a), 6, 6) += poseJacobian.transpose() * poseJacobian;
+
+                const IntrinsicBlock& intrinsicBlock = _intrinsics[_observations.intrinsics[i]];
+                const std::size_t tangentSize = intrinsicBlock.tangentMapping.cols();
+                if (intrinsicBlock.group >= 0)
+                {
+                    const std::size_t offset = getBlock(intrinsicBlock.group);
+                    mapBlock(row.values, offset, 6, tangentSize) +=
+                      poseJacobian.transpose() * mapBlock(_intrinsicJacobians, 2 * _observations.intrinsicOffsets[i], 2, tangentSize);
+                }
+
+                // Schur complement of the landmark: - W_i * V^-1 * W_j^T for all the observations j of the landmark
+                const std::size_t l = _observations.landmarks[i];
+                if (!_landmarkRefined[l])
+                    continue;
+
+                const Eigen::Matrix<double, 6, 3> Y = _poseLandmarkBlocks[i] * _landmarkInverseHessians[l];
+                reducedGradient -= Y * _landmarkGradients[l];
+
+                for (std::size_t j = _observations.landmarkOffsets[l]; j < _observations.landmarkOffsets[l + 1]; ++j)
+                {
+                    const int poseGroup = _poses[_observations.poses[j]].group;
+                    if (poseGroup >= 0)
+                        mapBlock(row.values, getBlock(poseGroup), 6, 6) -= Y * _poseLandmarkBlocks[j].transpose();
+
+                    const IntrinsicBlock& intrinsicBlockJ = _intrinsics[_observations.intrinsics[j]];
+                    if (intrinsicBlockJ.group >= 0)
+                    {
+                        const std::size_t tangentSizeJ = intrinsicBlockJ.tangentMapping.cols();
+                        const std::size_t offset = getBlock(intrinsicBlockJ.group);
+                        mapBlock(row.values, offset, 6, tangentSizeJ) -=
+                          Y * mapBlock(_intrinsicLandmarkBlocks, 3 * _observations.intrinsicOffsets[j], tangentSizeJ, 3).transpose();
+                    }
+                }
+            }
+
+            const std::size_t offset = _groupOffsets[a];
+            _cameraGradient.segment<6>(offset) = gradient;
+            _reducedGradient.segment<6>(offset) = gradient + reducedGradient;
+            _cameraDiagonal.segment<6>(offset) = diagonal;
+
+            for (const int b : row.columns)
+                blockIndexes[b] = -1;
+        }
+    }
+
+    // intrinsics: dense system of all the refined intrinsics, accumulated per thread then summed in the order of the threads
+    const std::size_t intrinsicsOffset = 6 * _nbPoseGroups;
+    const std::size_t nbIntrinsicsParameters = nbCameraParameters - intrinsicsOffset;
+    if (nbIntrinsicsParameters > 0)
+    {
+        const int nbThreads = std::max(1u, _options.nbThreads);
+        std::vector<Eigen::MatrixXd> hessiansPerThread(nbThreads, Eigen::MatrixXd::Zero(nbIntrinsicsParameters, nbIntrinsicsParameters));
+        std::vector<Eigen::VectorXd> gradientsPerThread(nbThreads, Eigen::VectorXd::Zero(nbIntrinsicsParameters));
+        std::vector<Eigen::VectorXd> reducedGradientsPerThread(nbThreads, Eigen::VectorXd::Zero(nbIntrinsicsParameters));
+        std::vector<Eigen::VectorXd> diagonalsPerThread(nbThreads, Eigen::VectorXd::Zero(nbIntrinsicsParameters));
+
+#pragma omp parallel num_threads(nbThreads)
+        {
+            const int thread = omp_get_thread_num();
+            Eigen::MatrixXd& hessian = hessiansPerThread[thread];
+            Eigen::VectorXd& gradient = gradientsPerThread[thread];
+            Eigen::VectorXd& reducedGradient = reducedGradientsPerThread[thread];
+            Eigen::VectorXd& diagonal = diagonalsPerThread[thread];
+
+            // sum of the W blocks of the observations of the landmark, per intrinsic
+            Eigen::MatrixXd landmarkBlocks(nbIntrinsicsParameters, 3);
+
+#pragma omp for schedule(static)
+            for (int l = 0; l < _landmarks.size(); ++l)
+            {
+                landmarkBlocks.setZero();
+                bool hasRefinedIntrinsic = false;
+
+                for (std::size_t i = _observations.landmarkOffsets[l]; i < _observations.landmarkOffsets[l + 1]; ++i)
+                {
+                    const IntrinsicBlock& intrinsicBlock = _intrinsics[_observations.intrinsics[i]];
+                    if (intrinsicBlock.group < 0)
+                        continue;
+                    hasRefinedIntrinsic = true;
+
+                    const std::size_t tangentSize = intrinsicBlock.tangentMapping.cols();
+                    const std::size_t offset = _groupOffsets[intrinsicBlock.group] - intrinsicsOffset;
+                    const auto intrinsicJacobian = mapBlock(_intrinsicJacobians, 2 * _observations.intrinsicOffsets[i], 2, tangentSize);
+
+                    hessian.block(offset, offset, tangentSize, tangentSize) += intrinsicJacobian.transpose() * intrinsicJacobian;
+                    gradient.segment(offset, tangentSize) += intrinsicJacobian.transpose() * _residuals[i];
+                    diagonal.segment(offset, tangentSize) += intrinsicJacobian.colwise().squaredNorm().transpose();
+
+                    if (_landmarkRefined[l])
+                        landmarkBlocks.block(offset, 0, tangentSize, 3) +=
+                          mapBlock(_intrinsicLandmarkBlocks, 3 * _observations.intrinsicOffsets[i], tangentSize, 3);
+                }
+
+                if (!hasRefinedIntrinsic || !_landmarkRefined[l])
+                    continue;
+
+                const Eigen::MatrixXd Y = landmarkBlocks * _landmarkInverseHessians[l];
+                hessian.noalias() -= Y * landmarkBlocks.transpose();
+                reducedGradient.noalias() -= Y * _landmarkGradients[l];
+            }
+        }
+
+        Eigen::MatrixXd hessian = Eigen::MatrixXd::Zero(nbIntrinsicsParameters, nbIntrinsicsParameters);
+        Eigen::VectorXd gradient = Eigen::VectorXd::Zero(nbIntrinsicsParameters);
+        Eigen::VectorXd reducedGradient = Eigen::VectorXd::Zero(nbIntrinsicsParameters);
+        Eigen::VectorXd diagonal = Eigen::VectorXd::Zero(nbIntrinsicsParameters);
+        for (int thread = 0; thread < nbThreads; ++thread)
+        {
+            hessian += hessiansPerThread[thread];
+            gradient += gradientsPerThread[thread];
+            reducedGradient += reducedGradientsPerThread[thread];
+            diagonal += diagonalsPerThread[thread];
+        }
+
+        _cameraGradient.tail(nbIntrinsicsParameters) = gradient;
+        _reducedGradient.tail(nbIntrinsicsParameters) = gradient + reducedGradient;
+        _cameraDiagonal.tail(nbIntrinsicsParameters) = diagonal;
+
+        // block rows of the intrinsics: the diagonal block first, the other intrinsics, then the poses
+        for (std::size_t a = _nbPoseGroups; a < nbGroups; ++a)
+        {
+            BlockRow& row = _reducedSystem[a];
+            row.clear();
+            for (std::size_t k = 0; k <= nbGroups - _nbPoseGroups - 1; ++k)
+            {
+                const std::size_t b = (a + k - _nbPoseGroups) % (nbGroups - _nbPoseGroups) + _nbPoseGroups;
+                row.columns.push_back(b);
+                row.offsets.push_back(row.values.size());
+                row.values.resize(row.values.size() + _groupSizes[a] * _groupSizes[b]);
+                mapBlock(row.values, row.offsets.back(), _groupSizes[a], _groupSizes[b]) =
+                  hessian.block(_groupOffsets[a] - intrinsicsOffset, _groupOffsets[b] - intrinsicsOffset, _groupSizes[a], _groupSizes[b]);
+            }
+        }
+        for (std::size_t b = 0; b < _nbPoseGroups; ++b)
+        {
+            const BlockRow& poseRow = _reducedSystem[b];
+            for (std::size_t k = 0; k < poseRow.columns.size(); ++k)
+            {
+                const int a = poseRow.columns[k];
+                if (a < _nbPoseGroups)
+                    continue;
+                BlockRow& row = _reducedSystem[a];
+                row.columns.push_back(b);
+                row.offsets.push_back(row.values.size());
+                row.values.resize(row.values.size() + _groupSizes[a] * 6);
+                mapBlock(row.values, row.offsets.back(), _groupSizes[a], 6) = mapBlock(poseRow.values, poseRow.offsets[k], 6, _groupSizes[a]).transpose();
+            }
+        }
+    }
+
+    // damping of the diagonal blocks and block Jacobi preconditioner
+#pragma omp parallel for num_threads(_options.nbThreads)
+    for (int a = 0; a < nbGroups; ++a)
+    {
+        BlockRow& row = _reducedSystem[a];
+        const std::size_t size = _groupSizes[a];
+        Eigen::Map<Eigen::MatrixXd> diagonalBlock = mapBlock(row.values, row.offsets.front(), size, size);
+        for (std::size_t d = 0; d < size; ++d)
+            diagonalBlock(d, d) += damping * clampDiagonal(_cameraDiagonal(_groupOffsets[a] + d));
+        _preconditioner[a] = diagonalBlock.ldlt().solve(Eigen::MatrixXd::Identity(size, size));
+    }
+}
+
+void BundleAdjustmentSchur::multiplyReducedSystem(const Eigen::VectorXd& x, Eigen::VectorXd& y) const
+{
+    y.resize(x.size());
+
+#pragma omp parallel for schedule(dynamic, 16) num_threads(_options.nbThreads)
+    for (int a = 0; a < _reducedSystem.size(); ++a)
+    {
+        const BlockRow& row = _reducedSystem[a];
+        const std::size_t size = _groupSizes[a];
+        Eigen::VectorXd ya = Eigen::VectorXd::Zero(size);
+        for (std::size_t k = 0; k < row.columns.size(); ++k)
+        {
+            const int b = row.columns[k];
+            ya.noalias() += mapBlock(row.values, row.offsets[k], size, _groupSizes[b]) * x.segment(_groupOffsets[b], _groupSizes[b]);
+        }
+        y.segment(_groupOffsets[a], size) = ya;
+    }
+}
+
+std::size_t BundleAdjustmentSchur::solveReducedSystem(Eigen::VectorXd& cameraStep) const
+{
+    const Eigen::VectorXd b = -_reducedGradient;
+    cameraStep.setZero(b.size());
+
+    const double bNorm = b.norm();
+    if (b.size() == 0 || bNorm == 0.0)
+        return 0;
+
+    const auto precondition = [this](const Eigen::VectorXd& r, Eigen::VectorXd& z) {
+        z.resize(r.size());
+        for (std::size_t a = 0; a < _groupSizes.size(); ++a)
+            z.segment(_groupOffsets[a], _groupSizes[a]).noalias() = _preconditioner[a] * r.segment(_groupOffsets[a], _groupSizes[a]);
+    };
+
+    Eigen::VectorXd r = b;
+    Eigen::VectorXd z;
+    Eigen::VectorXd q;
+    precondition(r, z);
+    Eigen::VectorXd p = z;
+    double rz = r.dot(z);
+
+    std::size_t iteration = 0;
+    while (iteration < _options.maxNumLinearIterations)
+    {
+        ++iteration;
+        multiplyReducedSystem(p, q);
+        const double pq = p.dot(q);
+        if (pq <= 0.0)
+            break;
+
+        const double alpha = rz / pq;
+        cameraStep += alpha * p;
+        r -= alpha * q;
+        if (r.norm() <= _options.linearSolverTolerance * bNorm)
+            break;
+
+        precondition(r, z);
+        const double rzNew = r.dot(z);
+        p = z + (rzNew / rz) * p;
+        rz = rzNew;
+    }
+    return iteration;
+}
+
+void BundleAdjustmentSchur::backSubstitute(const Eigen::VectorXd& cameraStep, std::vector<Vec3>& landmarkSteps) const
+{
+    landmarkSteps.resize(_landmarks.size());
+
+#pragma omp parallel for schedule(dynamic, 64) num_threads(_options.nbThreads)
+    for (int l = 0; l < _landmarks.size(); ++l)
+    {
+        if (!_landmarkRefined[l])
+        {
+            landmarkSteps[l].setZero();
+            continue;
+        }
+
+        // V * dX = -g - sum(W_i^T * dC_i)
+        Vec3 rhs = -_landmarkGradients[l];
+        for (std::size_t i = _observations.landmarkOffsets[l]; i < _observations.landmarkOffsets[l + 1]; ++i)
+        {
+            const int poseGroup = _poses[_observations.poses[i]].group;
+            if (poseGroup >= 0)
+                rhs -= _poseLandmarkBlocks[i].transpose() * cameraStep.segment<6>(_groupOffsets[poseGroup]);
+
+            const IntrinsicBlock& intrinsicBlock = _intrinsics[_observations.intrinsics[i]];
+            if (intrinsicBlock.group >= 0)
+            {
+                const std::size_t tangentSize = intrinsicBlock.tangentMapping.cols();
+                rhs -= mapBlock(_intrinsicLandmarkBlocks, 3 * _observations.intrinsicOffsets[i], tangentSize, 3).transpose() *
+                       cameraStep.segment(_groupOffsets[intrinsicBlock.group], tangentSize);
+            }
+        }
+        landmarkSteps[l] = _landmarkInverseHessians[l] * rhs;
+    }
+}
+
+void BundleAdjustmentSchur::updateFromSolution(sfmData::SfMData& sfmData, ERefineOptions refineOptions) const
+{
+    // update camera poses with refined data
+    for (std::size_t p = 0; p < _poses.size(); ++p)
+    {
+        if (_poses[p].group < 0)
+            continue;
+        const SE3::Matrix& T = _poseTransforms[p];
+        sfmData.getPoses().at(_poses[p].poseId).setTransform(poseFromRT(T.block<3, 3>(0, 0), T.block<3, 1>(0, 3)));
+    }
+
+    // update camera intrinsics with refined data
+    for (const IntrinsicBlock& block : _intrinsics)
+    {
+        if (block.group < 0)
+            continue;
+        sfmData.getIntrinsics().at(block.intrinsicId)->updateFromParams(block.params);
+    }
+
+    // update landmarks
+    for (std::size_t l = 0; l < _landmarks.size(); ++l)
+    {
+        if (!_landmarkRefined[l])
+            continue;
+        sfmData.getLandmarks().at(_landmarkIds[l]).X = _landmarks[l];
+    }
+}
+
+bool BundleAdjustmentSchur::adjust(sfmData::SfMData& sfmData, ERefineOptions refineOptions)
+{
+    system::Timer timer;
+
+    if (!createProblem(sfmData, refineOptions))
+    {
+        ALICEVISION_LOG_WARNING("Bundle Adjustment failed, the problem is not supported by the Schur bundle adjustment.");
+        return false;
+    }
+
+    const std::size_t nbResiduals = 2 * _observations.size();
+    if (nbResiduals == 0)
+    {
+        ALICEVISION_LOG_WARNING("Bundle Adjustment failed, no observation.");
+        return false;
+    }
+
+    double cost = computeCost(_poseTransforms, _landmarks);
+    if (!std::isfinite(cost))
+    {
+        ALICEVISION_LOG_WARNING("Bundle Adjustment failed, the initial cost is not finite.");
+        return false;
+    }
+    _statistics.RMSEinitial = std::sqrt(cost / nbResiduals);
+
+    double damping = _options.initialDamping;
+    double dampingFactor = 2.0;
+    bool linearized = false;
+
+    Eigen::VectorXd cameraStep;
+    std::vector<Vec3> landmarkSteps;
+    std::vector<SE3::Matrix> candidatePoseTransforms;
+    std::vector<Vec3> candidateLandmarks;
+    std::vector<std::vector<double>> candidateIntrinsicsParams(_intrinsics.size());
+
+    for (std::size_t iteration = 0; iteration < _options.maxNumIterations; ++iteration)
+    {
+        if (!linearized)
+        {
+            linearize();
+            linearized = true;
+        }
+
+        system::Timer stepTimer;
+        assembleReducedSystem(damping);
+        _statistics.assemblyTime += stepTimer.elapsed();
+
+        stepTimer.reset();
+        _statistics.nbLinearIterations += solveReducedSystem(cameraStep);
+        backSubstitute(cameraStep, landmarkSteps);
+        _statistics.linearSolverTime += stepTimer.elapsed();
+
+        // predicted decrease of the linearized cost: 0.5 * (damping * dx^T * D * dx - g^T * dx)
+        double modelDecrease = 0.0;
+        double stepSquaredNorm = cameraStep.squaredNorm();
+        double parametersSquaredNorm = 0.0;
+        for (Eigen::Index k = 0; k < cameraStep.size(); ++k)
+            modelDecrease += damping * clampDiagonal(_cameraDiagonal(k)) * Square(cameraStep(k)) - _cameraGradient(k) * cameraStep(k);
+        for (std::size_t l = 0; l < _landmarks.size(); ++l)
+        {
+            if (!_landmarkRefined[l])
+                continue;
+            for (int d = 0; d < 3; ++d)
+                modelDecrease += damping * clampDiagonal(_landmarkDiagonals[l](d)) * Square(landmarkSteps[l](d)) -
+                                 _landmarkGradients[l](d) * landmarkSteps[l](d);
+            stepSquaredNorm += landmarkSteps[l].squaredNorm();
+            parametersSquaredNorm += _landmarks[l].squaredNorm();
+        }
+        modelDecrease *= 0.5;
+
+        // candidate parameters
+        candidatePoseTransforms = _poseTransforms;
+        for (std::size_t p = 0; p < _poses.size(); ++p)
+        {
+            parametersSquaredNorm += _poseTransforms[p].squaredNorm();
+            if (_poses[p].group < 0)
+                continue;
+            const Eigen::Matrix<double, 6, 1> delta = cameraStep.segment<6>(_groupOffsets[_poses[p].group]);
+            candidatePoseTransforms[p] = SE3::expm(delta) * _poseTransforms[p];
+        }
+        for (std::size_t k = 0; k < _intrinsics.size(); ++k)
+        {
+            const IntrinsicBlock& block = _intrinsics[k];
+            candidateIntrinsicsParams[k] = block.params;
+            if (block.group < 0)
+                continue;
+            const Eigen::VectorXd delta = block.tangentMapping * cameraStep.segment(_groupOffsets[block.group], _groupSizes[block.group]);
+            for (std::size_t i = 0; i < block.params.size(); ++i)
+            {
+                parametersSquaredNorm += Square(block.params[i]);
+                candidateIntrinsicsParams[k][i] = std::min(std::max(block.params[i] + delta(i), block.lowerBounds[i]), block.upperBounds[i]);
+            }
+            block.intrinsic->updateFromParams(candidateIntrinsicsParams[k]);
+        }
+        candidateLandmarks = _landmarks;
+        for (std::size_t l = 0; l < _landmarks.size(); ++l)
+            candidateLandmarks[l] += landmarkSteps[l];
+
+        const double candidateCost = computeCost(candidatePoseTransforms, candidateLandmarks);
+
+        if (_options.verbose)
+        {
+            ALICEVISION_LOG_INFO("BundleAdjustmentSchur: iteration " << iteration << ", cost: " << cost << ", candidate cost: " << candidateCost
+                                                                     << ", damping: " << damping << ", step norm: " << std::sqrt(stepSquaredNorm));
+        }
+
+        if (std::isfinite(candidateCost) && candidateCost < cost && modelDecrease > 0.0)
+        {
+            // accept the step
+            const double gainRatio = (cost - candidateCost) / modelDecrease;
+            const double relativeDecrease = (cost - candidateCost) / cost;
+
+            _poseTransforms.swap(candidatePoseTransforms);
+            _landmarks.swap(candidateLandmarks);
+            for (std::size_t k = 0; k < _intrinsics.size(); ++k)
+                _intrinsics[k].params = candidateIntrinsicsParams[k];
+
+            cost = candidateCost;
+            damping *= std::max(1.0 / 3.0, 1.0 - std::pow(2.0 * gainRatio - 1.0, 3));
+            dampingFactor = 2.0;
+            linearized = false;
+            ++_statistics.nbSuccessfullIterations;
+
+            if (relativeDecrease < _options.functionTolerance ||
+                std::sqrt(stepSquaredNorm) <= _options.parameterTolerance * (std::sqrt(parametersSquaredNorm) + _options.parameterTolerance))
+                break;
+        }
+        else
+        {
+            // reject the step
+            for (const IntrinsicBlock& block : _intrinsics)
+                block.intrinsic->updateFromParams(block.params);
+
+            damping *= dampingFactor;
+            dampingFactor *= 2.0;
+            ++_statistics.nbUnsuccessfullIterations;
+
+            if (damping > maxDamping)
+                break;
+        }
+    }
+
+    // update input sfmData with the solution
+    updateFromSolution(sfmData, refineOptions);
+
+    _statistics.RMSEfinal = std::sqrt(cost / nbResiduals);
+    _statistics.time = timer.elapsed();
+
+    // store distance histogram for local strategy
+    if (useLocalStrategy())
+    {
+        _statistics.nbCamerasPerDistance = _localGraph->getDistancesHistogram();
+    }
+
+    if (_options.summary)
+    {
+        _statistics.show();
+    }
+
+    return true;
+}
+
+}  // namespace sfm
+}  // namespace aliceVision
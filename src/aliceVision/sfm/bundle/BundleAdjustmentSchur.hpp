@@ -0,0 +1,327 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/geometry/lie.hpp>
+
+#include <aliceVision/sfm/bundle/BundleAdjustment.hpp>
+
+#include <aliceVision/camera/IntrinsicBase.hpp>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace aliceVision {
+
+namespace sfmData {
+class SfMData;
+}  // namespace sfmData
+
+namespace sfm {
+
+class LocalBundleAdjustmentGraph;
+
+/**
+ * @brief Bundle adjustment engine dedicated to the reprojection error of the AliceVision camera models.
+ *
+ * The problem is solved with Levenberg-Marquardt iterations:
+ *  - the observations are stored as a structure of arrays, sorted by landmark,
+ *  - the Jacobians are the analytic derivatives of the camera models,
+ *  - the landmarks are eliminated with an explicit Schur complement, assembled in parallel
+ *    by block rows of the reduced camera system (poses and intrinsics),
+ *  - the reduced camera system is solved with a block Jacobi preconditioned conjugate gradient.
+ *
+ * @note The rigs, the 2D constraints, the rotation priors and the structure as normals are not supported,
+ *       BundleAdjustmentCeres must be used for these scenes.
+ */
+class BundleAdjustmentSchur : public BundleAdjustment
+{
+  public:
+    /**
+     * @brief Contains all the solver parameters.
+     */
+    struct SchurOptions
+    {
+        SchurOptions(bool verbose = true, bool multithreaded = true, unsigned int maxIterations = 50)
+          : verbose(verbose),
+            nbThreads(multithreaded ? omp_get_max_threads() : 1),  // set number of threads, 1 if OpenMP is not enabled
+            maxNumIterations(maxIterations)
+        {}
+
+        bool verbose = true;
+        unsigned int nbThreads;
+        /// maximum number of Levenberg-Marquardt iterations
+        unsigned int maxNumIterations;
+        /// maximum number of conjugate gradient iterations per Levenberg-Marquardt iteration
+        unsigned int maxNumLinearIterations = 500;
+        /// relative residual of the reduced camera system to stop the conjugate gradient
+        double linearSolverTolerance = 1e-6;
+        /// Huber loss parameter, same as the ceres::HuberLoss of the Ceres bundle adjustment
+        double lossFunctionThreshold = Square(4.0);
+        /// initial Levenberg-Marquardt damping
+        double initialDamping = 1e-4;
+        /// relative decrease of the cost to stop the iterations
+        double functionTolerance = 1e-6;
+        /// relative norm of the update to stop the iterations
+        double parameterTolerance = 1e-8;
+        bool useFocalPrior = true;
+        bool summary = false;
+    };
+
+    /**
+     * @brief Contains all informations related to the performed bundle adjustment.
+     */
+    struct Statistics
+    {
+        Statistics() {}
+
+        /**
+         * @brief Add a parameter state
+         * @param[in] parameter A bundle adjustment parameter
+         * @param[in] state A bundle adjustment state
+         */
+        inline void addState(EParameter parameter, EParameterState state) { ++parametersStates[parameter][state]; }
+
+        /**
+         * @brief  Display statistics about bundle adjustment in the terminal
+         *  Logger need to accept <info> log level
+         */
+        void show() const;
+
+        /// number of successful iterations
+        std::size_t nbSuccessfullIterations = 0;
+        /// number of unsuccessful iterations
+        std::size_t nbUnsuccessfullIterations = 0;
+        /// number of conjugate gradient iterations
+        std::size_t nbLinearIterations = 0;
+        /// number of resiudal blocks (observations)
+        std::size_t nbResidualBlocks = 0;
+        /// RMSEinitial: sqrt(initial_cost / num_residuals)
+        double RMSEinitial = 0.0;
+        /// RMSEfinal: sqrt(final_cost / num_residuals)
+        double RMSEfinal = 0.0;
+        /// time spent to solve the BA (s)
+        double time = 0.0;
+        /// time spent to assemble the reduced camera system (s)
+        double assemblyTime = 0.0;
+        /// time spent in the conjugate gradient (s)
+        double linearSolverTime = 0.0;
+        /// number of states per parameter
+        std::map<EParameter, std::map<EParameterState, std::size_t>> parametersStates;
+        /// The distribution of the cameras for each graph distance <distance, numOfCam>
+        std::map<int, std::size_t> nbCamerasPerDistance;
+    };
+
+    /**
+     * @brief Bundle adjustment constructor
+     * @param[in] options The solver options
+     * @param[in] minNbImagesToRefineOpticalCenter The minimum number of images of an intrinsic to refine its optical center
+     * @see BundleAdjustmentSchur::SchurOptions
+     */
+    BundleAdjustmentSchur(const SchurOptions& options = SchurOptions(), int minNbImagesToRefineOpticalCenter = 3)
+      : _options(options),
+        _minNbImagesToRefineOpticalCenter(minNbImagesToRefineOpticalCenter)
+    {}
+
+    /**
+     * @brief Perform a Bundle Adjustment on the SfM scene with refinement of the requested parameters
+     * @param[in,out] sfmData The input SfMData contains all the information about the reconstruction
+     * @param[in] refineOptions The chosen refine flag
+     * @return false if the bundle adjustment failed else true
+     * @see BundleAdjustment::Adjust
+     */
+    bool adjust(sfmData::SfMData& sfmData, ERefineOptions refineOptions = REFINE_ALL) override;
+
+    /**
+     * @brief Ajust parameters according to the local reconstruction graph in order do perfomr an optimezed bundle adjustmentor
+     * @param[in] localGraph The Local bundle adjustment graph pointer or nullptr (will refine everything)
+     */
+    inline void useLocalStrategyGraph(const std::shared_ptr<const LocalBundleAdjustmentGraph>& localGraph) { _localGraph = localGraph; }
+
+    /**
+     * @brief Get bundle adjustment statistics structure
+     * @return statistics structure const ptr
+     */
+    inline const Statistics& getStatistics() const { return _statistics; }
+
+    /**
+     * @brief Return true if the bundle adjustment use an external local graph
+     * @return true if use an external local graph
+     */
+    inline bool useLocalStrategy() const { return (_localGraph != nullptr); }
+
+  private:
+    /// pose: 6 tangent parameters, left update of the pose matrix with SE3::expm
+    struct PoseBlock
+    {
+        IndexT poseId = UndefinedIndexT;
+        /// index of the block in the reduced camera system, -1 if constant
+        int group = -1;
+    };
+
+    /// intrinsic: the refined parameters are a linear mapping of the tangent parameters
+    struct IntrinsicBlock
+    {
+        IndexT intrinsicId = UndefinedIndexT;
+        std::shared_ptr<camera::IntrinsicBase> intrinsic;
+        std::vector<double> params;
+        std::vector<double> lowerBounds;
+        std::vector<double> upperBounds;
+        /// d(params) / d(tangent), params = params + tangentMapping * delta
+        Eigen::MatrixXd tangentMapping;
+        /// index of the block in the reduced camera system, -1 if constant
+        int group = -1;
+    };
+
+    /// observations sorted by landmark, the observations of the landmark l are [landmarkOffsets[l], landmarkOffsets[l + 1])
+    struct ObservationsData
+    {
+        std::vector<std::size_t> landmarkOffsets;
+        std::vector<std::size_t> landmarks;
+        std::vector<int> poses;
+        std::vector<int> intrinsics;
+        std::vector<double> x;
+        std::vector<double> y;
+        std::vector<double> invScales;
+        /// offset of the intrinsic Jacobian of each observation (in number of tangent parameters)
+        std::vector<std::size_t> intrinsicOffsets;
+        std::size_t size() const { return poses.size(); }
+    };
+
+    /// block row of the reduced camera system, each block is stored as a column major (rows x cols) matrix
+    struct BlockRow
+    {
+        std::vector<int> columns;
+        std::vector<std::size_t> offsets;
+        std::vector<double> values;
+        void clear()
+        {
+            columns.clear();
+            offsets.clear();
+            values.clear();
+        }
+    };
+
+    /**
+     * @brief Clear structures for a new problem
+     */
+    void resetProblem();
+
+    /**
+     * @brief Create the pose blocks, the intrinsic blocks, the landmarks and the observations
+     * @return false if the scene contains data not supported by this engine
+     */
+    bool createProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions);
+
+    /**
+     * @brief Create an intrinsic block for each intrinsic used by a reconstructed view,
+     *        with the same locks and bounds as the Ceres bundle adjustment
+     */
+    void addIntrinsicsToProblem(const sfmData::SfMData& sfmData, ERefineOptions refineOptions);
+
+    /**
+     * @brief Compute the cost (half the sum of the robustified squared residuals) of the current parameters
+     */
+    double computeCost(const std::vector<SE3::Matrix>& poseTransforms, const std::vector<Vec3>& landmarks) const;
+
+    /**
+     * @brief Compute the weighted residuals and the Jacobians of all the observations
+     */
+    void linearize();
+
+    /**
+     * @brief Eliminate the landmarks and assemble the damped reduced camera system
+     * @param[in] damping The Levenberg-Marquardt damping
+     */
+    void assembleReducedSystem(double damping);
+
+    /**
+     * @brief Solve the reduced camera system with a block Jacobi preconditioned conjugate gradient
+     * @param[out] cameraStep The step of the pose and intrinsic parameters
+     * @return the number of iterations
+     */
+    std::size_t solveReducedSystem(Eigen::VectorXd& cameraStep) const;
+
+    /**
+     * @brief Compute the step of the landmarks from the step of the camera parameters
+     */
+    void backSubstitute(const Eigen::VectorXd& cameraStep, std::vector<Vec3>& landmarkSteps) const;
+
+    /// y = S * x with S the reduced camera system
+    void multiplyReducedSystem(const Eigen::VectorXd& x, Eigen::VectorXd& y) const;
+
+    /**
+     * @brief Update The given SfMData with the solver solution
+     */
+    void updateFromSolution(sfmData::SfMData& sfmData, ERefineOptions refineOptions) const;
+
+    BundleAdjustment::EParameterState getPoseState(IndexT poseId) const;
+    BundleAdjustment::EParameterState getIntrinsicState(IndexT intrinsicId) const;
+    BundleAdjustment::EParameterState getLandmarkState(IndexT landmarkId) const;
+
+    /// use or not the local budle adjustment strategy
+    std::shared_ptr<const LocalBundleAdjustmentGraph> _localGraph = nullptr;
+
+    SchurOptions _options;
+    int _minNbImagesToRefineOpticalCenter = 3;
+
+    /// last adjustment iteration statisics
+    Statistics _statistics;
+
+    // problem data
+
+    std::vector<PoseBlock> _poses;
+    std::vector<SE3::Matrix> _poseTransforms;
+    /// d(left update of the pose matrix) / d(tangent), same as SE3ManifoldLeft
+    Eigen::Matrix<double, 16, 6> _poseTangentMapping;
+    std::vector<IntrinsicBlock> _intrinsics;
+    std::vector<IndexT> _landmarkIds;
+    std::vector<Vec3> _landmarks;
+    std::vector<char> _landmarkRefined;
+    ObservationsData _observations;
+
+    /// camera groups of the reduced system: the refined poses, then the refined intrinsics
+    std::vector<std::size_t> _groupOffsets;
+    std::vector<std::size_t> _groupSizes;
+    std::size_t _nbPoseGroups = 0;
+    /// observations of each refined pose (CSR)
+    std::vector<std::size_t> _poseObservationsOffsets;
+    std::vector<std::size_t> _poseObservations;
+
+    // linearization (structure of arrays, one entry per observation)
+
+    std::vector<Vec2> _residuals;
+    std::vector<Eigen::Matrix<double, 2, 6>> _poseJacobians;
+    std::vector<Eigen::Matrix<double, 2, 3>> _landmarkJacobians;
+    std::vector<double> _intrinsicJacobians;
+    /// W = J_camera^T * J_landmark, per observation
+    std::vector<Eigen::Matrix<double, 6, 3>> _poseLandmarkBlocks;
+    std::vector<double> _intrinsicLandmarkBlocks;
+
+    // per landmark
+
+    std::vector<Mat3> _landmarkHessians;
+    std::vector<Mat3> _landmarkInverseHessians;
+    std::vector<Vec3> _landmarkGradients;
+    std::vector<Vec3> _landmarkDiagonals;
+
+    // reduced camera system
+
+    std::vector<BlockRow> _reducedSystem;
+    Eigen::VectorXd _cameraGradient;
+    Eigen::VectorXd _reducedGradient;
+    Eigen::VectorXd _cameraDiagonal;
+    std::vector<Eigen::MatrixXd> _preconditioner;
+};
+
+}  // namespace sfm
+}  // namespace aliceVision
@@ -28,6 +28,8 @@ double RMSE(const SfMData& sfmData);
 
 SfMData getInputScene(const NViewDataSet& d, const NViewDatasetConfigurator& config, EINTRINSIC eintrinsic);
 
+void reprojectObservations(SfMData& sfmData, double noise);
+
 // Test summary:
 // - Create a SfMData scene from a synthetic dataset
 //   - since random noise have been added on 2d data point (initial residual is not small)
@@ -134,6 +136,113 @@ BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_EffectiveMinimization_PinholeFisheye)
     BOOST_CHECK_LT(dResidual_after, dResidual_before);
 }
 
+// Test summary:
+// - Same as the previous tests with the Schur bundle adjustment engine
+// - Check that the Schur engine converges to the same residual as the Ceres engine on a larger scene
+
+BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_Schur_EffectiveMinimization)
+{
+    const int nviews = 3;
+    const int npoints = 6;
+    const NViewDatasetConfigurator config;
+    const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+    for (const EINTRINSIC eintrinsic : {EINTRINSIC::PINHOLE_CAMERA, EINTRINSIC::PINHOLE_CAMERA_RADIAL1, EINTRINSIC::PINHOLE_CAMERA_RADIAL3,
+                                        EINTRINSIC::PINHOLE_CAMERA_BROWN, EINTRINSIC::PINHOLE_CAMERA_FISHEYE})
+    {
+        // Translate the input dataset to a SfMData scene
+        SfMData sfmData = getInputScene(d, config, eintrinsic);
+
+        const double dResidual_before = RMSE(sfmData);
+
+        // Call the BA interface and let it refine (Structure and Camera parameters [Intrinsics|Motion])
+        std::shared_ptr<BundleAdjustment> ba_object = std::make_shared<BundleAdjustmentSchur>();
+        BOOST_CHECK(ba_object->adjust(sfmData));
+
+        const double dResidual_after = RMSE(sfmData);
+        BOOST_CHECK_LT(dResidual_after, dResidual_before);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_Schur_EffectiveMinimization_Equidistant)
+{
+    const int nviews = 3;
+    const int npoints = 6;
+    const NViewDatasetConfigurator config;
+    const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+    for (const EINTRINSIC eintrinsic : {EINTRINSIC::EQUIDISTANT_CAMERA, EINTRINSIC::EQUIDISTANT_CAMERA_RADIAL3})
+    {
+        // the synthetic observations are pinhole projections, project the landmarks with the equidistant camera instead
+        SfMData sfmData = getInputScene(d, config, eintrinsic);
+        reprojectObservations(sfmData, 0.5);
+
+        const double dResidual_before = RMSE(sfmData);
+
+        std::shared_ptr<BundleAdjustment> ba_object = std::make_shared<BundleAdjustmentSchur>();
+        BOOST_CHECK(ba_object->adjust(sfmData));
+
+        const double dResidual_after = RMSE(sfmData);
+        BOOST_CHECK_LT(dResidual_after, dResidual_before);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_Schur_CalibratedDistortion)
+{
+    const int nviews = 6;
+    const int npoints = 30;
+    const NViewDatasetConfigurator config;
+    const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+    SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA_RADIAL3);
+    std::shared_ptr<IntrinsicScaleOffsetDisto> intrinsic =
+      std::dynamic_pointer_cast<IntrinsicScaleOffsetDisto>(sfmData.getIntrinsics().begin()->second);
+    BOOST_REQUIRE(intrinsic != nullptr);
+
+    const std::vector<double> distortionParams = {0.01, -0.005, 0.001};
+    intrinsic->setDistortionParams(distortionParams);
+    intrinsic->setDistortionInitializationMode(EInitMode::CALIBRATED);
+    reprojectObservations(sfmData, 0.5);
+
+    const double dResidual_before = RMSE(sfmData);
+
+    BundleAdjustmentSchur::SchurOptions options(false);
+    BundleAdjustmentSchur ba(options);
+    BOOST_CHECK(ba.adjust(sfmData));
+
+    // the calibrated distortion is kept constant, the other parameters are refined
+    const std::vector<double> distortionParamsAfter = intrinsic->getDistortionParams();
+    BOOST_CHECK_EQUAL_COLLECTIONS(distortionParamsAfter.begin(), distortionParamsAfter.end(), distortionParams.begin(), distortionParams.end());
+    BOOST_CHECK_LT(RMSE(sfmData), dResidual_before);
+}
+
+BOOST_AUTO_TEST_CASE(BUNDLE_ADJUSTMENT_Schur_SameAsCeres)
+{
+    const int nviews = 12;
+    const int npoints = 200;
+    const NViewDatasetConfigurator config;
+    const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+    const SfMData sfmDataInput = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA_RADIAL3);
+    SfMData sfmDataCeres = sfmDataInput;
+    SfMData sfmDataSchur = sfmDataInput;
+
+    BundleAdjustmentCeres::CeresOptions ceresOptions(false);
+    BundleAdjustmentCeres baCeres(ceresOptions);
+    BOOST_CHECK(baCeres.adjust(sfmDataCeres));
+
+    BundleAdjustmentSchur::SchurOptions schurOptions(false);
+    BundleAdjustmentSchur baSchur(schurOptions);
+    BOOST_CHECK(baSchur.adjust(sfmDataSchur));
+
+    const double residualInput = RMSE(sfmDataInput);
+    const double residualCeres = RMSE(sfmDataCeres);
+    const double residualSchur = RMSE(sfmDataSchur);
+    BOOST_CHECK_LT(residualSchur, residualInput);
+    BOOST_CHECK_LT(residualSchur, residualCeres + 1e-3);
+    BOOST_CHECK_EQUAL(baSchur.getStatistics().nbResidualBlocks, nviews * npoints);
+}
+
 BOOST_AUTO_TEST_CASE(LOCAL_BUNDLE_ADJUSTMENT_EffectiveMinimization_Pinhole_CamerasRing)
 {
     const int nviews = 4;
@@ -324,3 +433,24 @@ SfMData getInputScene(const NViewDataSet& d, const NViewDatasetConfigurator& con
 
     return sfm_data;
 }
+
+// Replace the observations by the projections of the landmarks with the scene intrinsic,
+// with a random noise between [-noise, noise]
+void reprojectObservations(SfMData& sfmData, double noise)
+{
+    for (auto& landmarkPair : sfmData.getLandmarks())
+    {
+        Landmark& landmark = landmarkPair.second;
+        for (auto& observationPair : landmark.observations)
+        {
+            const View& view = sfmData.getView(observationPair.first);
+            const Pose3 pose = sfmData.getPose(view).getTransform();
+            const IntrinsicBase& intrinsic = *sfmData.getIntrinsics().at(view.getIntrinsicId());
+
+            Vec2 pt = intrinsic.project(pose, landmark.X.homogeneous());
+            pt(0) += noise * (2.0 * rand() / RAND_MAX - 1.0);
+            pt(1) += noise * (2.0 * rand() / RAND_MAX - 1.0);
+            observationPair.second.x = pt;
+        }
+    }
+}
@@ -8,10 +8,13 @@
 #include "regionsIO.hpp"
 
 #include <aliceVision/system/ProgressDisplay.hpp>
+#include <aliceVision/feature/RegionsContainer.hpp>
 #include <boost/filesystem.hpp>
 
 #include <atomic>
 #include <cassert>
+#include <map>
+#include <mutex>
 
 namespace fs = boost::filesystem;
 
@@ -20,13 +23,81 @@ namespace sfm {
 
 using namespace sfmData;
 
-std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& folders, IndexT viewId, const feature::ImageDescriber& imageDescriber)
+namespace {
+
+/**
+ * @brief Find the regions container of the given describer type that contains the given view.
+ * @param[in] containersCache The containers mapped by the caller, nullptr to map the containers for this view only
+ * @return the regions container or nullptr if the view is not in a container
+ */
+std::shared_ptr<const feature::RegionsContainer> findRegionsContainer(const std::vector<std::string>& folders,
+                                                                      IndexT viewId,
+                                                                      feature::EImageDescriberType describerType,
+                                                                      RegionsContainersCache* containersCache)
+{
+    std::shared_ptr<const feature::RegionsContainer> out;
+
+    // same priority as the per-view files, the last folder wins
+    for (const std::string& folder : folders)
+    {
+        std::shared_ptr<const feature::RegionsContainer> container;
+        if (containersCache)
+        {
+            container = containersCache->get(folder, describerType);
+        }
+        else
+        {
+            const std::string filename = feature::getRegionsContainerFilename(folder, describerType);
+            if (fs::exists(filename))
+                container = std::make_shared<const feature::RegionsContainer>(filename);
+        }
+        if (container && container->hasView(viewId))
+            out = container;
+    }
+    return out;
+}
+
+}  // namespace
+
+std::shared_ptr<const feature::RegionsContainer> RegionsContainersCache::get(const std::string& folder, feature::EImageDescriberType describerType)
+{
+    const std::string filename = feature::getRegionsContainerFilename(folder, describerType);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto it = _containers.find(filename);
+    if (it != _containers.end())
+        return it->second;
+
+    std::shared_ptr<const feature::RegionsContainer> container;
+    if (fs::exists(filename))
+        container = std::make_shared<const feature::RegionsContainer>(filename);
+
+    _containers.emplace(filename, container);
+    return container;
+}
+
+std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& folders,
+                                              IndexT viewId,
+                                              const feature::ImageDescriber& imageDescriber,
+                                              RegionsContainersCache* containersCache)
 {
     assert(!folders.empty());
 
     const std::string imageDescriberTypeName = feature::EImageDescriberType_enumToString(imageDescriber.getDescriberType());
     const std::string basename = std::to_string(viewId);
 
+    // regions container (memory-mapped, descriptors without copy)
+    if (std::shared_ptr<const feature::RegionsContainer> container = findRegionsContainer(folders, viewId, imageDescriber.getDescriberType(), containersCache))
+    {
+        std::unique_ptr<feature::Regions> regionsPtr;
+        imageDescriber.allocate(regionsPtr);
+        container->loadRegions(viewId, *regionsPtr);
+
+        ALICEVISION_LOG_TRACE("Region count: " << regionsPtr->RegionCount() << " (regions container)");
+        return regionsPtr;
+    }
+
     std::string featFilename;
     std::string descFilename;
 
@@ -71,7 +142,10 @@ std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& fo
     return regionsPtr;
 }
 
-std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& folders, IndexT viewId, const feature::ImageDescriber& imageDescriber)
+std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& folders,
+                                               IndexT viewId,
+                                               const feature::ImageDescriber& imageDescriber,
+                                               RegionsContainersCache* containersCache)
 {
     assert(!folders.empty());
 
@@ -90,6 +164,21 @@ std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& f
         }
     }
 
+    // regions container (memory-mapped)
+    {
+        const std::vector<std::string> containerFolders(foldersSet.begin(), foldersSet.end());
+        if (std::shared_ptr<const feature::RegionsContainer> container =
+              findRegionsContainer(containerFolders, viewId, imageDescriber.getDescriberType(), containersCache))
+        {
+            std::unique_ptr<feature::Regions> regionsPtr;
+            imageDescriber.allocate(regionsPtr);
+            container->loadFeatures(viewId, *regionsPtr);
+
+            ALICEVISION_LOG_TRACE("Feature count: " << regionsPtr->RegionCount() << " (regions container)");
+            return regionsPtr;
+        }
+    }
+
     for (const auto& folder : foldersSet)
     {
         const fs::path featPath = fs::path(folder) / std::string(basename + "." + imageDescriberTypeName + ".feat");
@@ -154,6 +243,7 @@ bool loadFeaturesPerDescPerView(std::vector<std::vector<std::unique_ptr<feature:
     featuresPerDescPerView.resize(imageDescribers.size());
 
     std::atomic_bool loadingSuccess(true);
+    RegionsContainersCache containersCache;
 
     for (int descIdx = 0; descIdx < imageDescribers.size(); ++descIdx)
     {
@@ -165,7 +255,7 @@ bool loadFeaturesPerDescPerView(std::vector<std::vector<std::unique_ptr<feature:
         {
             try
             {
-                featuresPerView.at(viewIdx) = loadFeatures(folders, viewIds.at(viewIdx), *imageDescribers.at(descIdx));
+                featuresPerView.at(viewIdx) = loadFeatures(folders, viewIds.at(viewIdx), *imageDescribers.at(descIdx), &containersCache);
             }
             catch (const std::exception& e)
             {
@@ -192,6 +282,7 @@ bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
       system::createConsoleProgressDisplay(sfmData.getViews().size() * imageDescriberTypes.size(), std::cout, "Loading regions\n");
 
     std::atomic_bool invalid(false);
+    RegionsContainersCache containersCache;
 
     std::vector<std::unique_ptr<feature::ImageDescriber>> imageDescribers;
     imageDescribers.resize(imageDescriberTypes.size());
@@ -211,7 +302,7 @@ bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
                     std::unique_ptr<feature::Regions> regionsPtr;
                     try
                     {
-                        regionsPtr = loadRegions(featuresFolders, iter->second.get()->getViewId(), *(imageDescribers.at(i)));
+                        regionsPtr = loadRegions(featuresFolders, iter->second.get()->getViewId(), *(imageDescribers.at(i)), &containersCache);
                     }
                     catch (const std::exception&)
                     {
@@ -250,6 +341,7 @@ bool loadFeaturesPerView(feature::FeaturesPerView& featuresPerView,
 
     // read for each view the corresponding features and store them as PointFeatures
     std::atomic_bool invalid(false);
+    RegionsContainersCache containersCache;
 
     std::vector<std::unique_ptr<feature::ImageDescriber>> imageDescribers;
     imageDescribers.resize(imageDescriberTypes.size());
@@ -267,7 +359,7 @@ bool loadFeaturesPerView(feature::FeaturesPerView& featuresPerView,
                 std::unique_ptr<feature::Regions> regionsPtr;
                 try
                 {
-                    regionsPtr = loadFeatures(featuresFolders, iter->second.get()->getViewId(), *imageDescribers.at(i));
+                    regionsPtr = loadFeatures(featuresFolders, iter->second.get()->getViewId(), *imageDescribers.at(i), &containersCache);
                 }
                 catch (const std::exception&)
                 {
@@ -286,5 +378,69 @@ bool loadFeaturesPerView(feature::FeaturesPerView& featuresPerView,
     return !invalid;
 }
 
+std::size_t getRegionsSize(const feature::Regions& regions)
+{
+    return regions.RegionCount() * (sizeof(feature::PointFeature) + regions.DescriptorLength() * regions.DescriptorElementSize());
+}
+
+bool getRegionsSizePerView(std::map<IndexT, std::size_t>& regionsSizePerView,
+                           const SfMData& sfmData,
+                           const std::vector<std::string>& folders,
+                           const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
+                           const std::set<IndexT>& viewIdFilter)
+{
+    std::vector<std::string> featuresFolders = sfmData.getFeaturesFolders();        // add sfm features folders
+    featuresFolders.insert(featuresFolders.end(), folders.begin(), folders.end());  // add user features folders
+    auto last = std::unique(featuresFolders.begin(), featuresFolders.end());
+    featuresFolders.erase(last, featuresFolders.end());
+
+    std::vector<IndexT> viewIds;
+    for (const auto& viewPair : sfmData.getViews())
+    {
+        if (viewIdFilter.empty() || viewIdFilter.count(viewPair.first))
+            viewIds.push_back(viewPair.first);
+    }
+
+    std::vector<std::vector<std::unique_ptr<feature::Regions>>> featuresPerDescPerView;
+    if (!loadFeaturesPerDescPerView(featuresPerDescPerView, viewIds, featuresFolders, imageDescriberTypes))
+        return false;
+
+    regionsSizePerView.clear();
+    for (const auto& featuresPerView : featuresPerDescPerView)
+    {
+        for (std::size_t i = 0; i < viewIds.size(); ++i)
+            regionsSizePerView[viewIds[i]] += getRegionsSize(*featuresPerView[i]);
+    }
+    return true;
+}
+
+std::unique_ptr<feature::RegionsCache> createRegionsCache(const SfMData& sfmData,
+                                                          const std::vector<std::string>& folders,
+                                                          const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
+                                                          std::size_t memoryBudget)
+{
+    std::vector<std::string> featuresFolders = sfmData.getFeaturesFolders();        // add sfm features folders
+    featuresFolders.insert(featuresFolders.end(), folders.begin(), folders.end());  // add user features folders
+    auto last = std::unique(featuresFolders.begin(), featuresFolders.end());
+    featuresFolders.erase(last, featuresFolders.end());
+
+    // shared by the loader copies
+    auto imageDescribers = std::make_shared<std::vector<std::unique_ptr<feature::ImageDescriber>>>();
+    for (const feature::EImageDescriberType imageDescriberType : imageDescriberTypes)
+        imageDescribers->push_back(createImageDescriber(imageDescriberType));
+
+    // the containers stay mapped as long as the regions cache
+    auto containersCache = std::make_shared<RegionsContainersCache>();
+
+    const auto loader = [featuresFolders, imageDescribers, containersCache](IndexT viewId) {
+        feature::MapRegionsPerDesc regionsPerDesc;
+        for (const auto& imageDescriber : *imageDescribers)
+            regionsPerDesc[imageDescriber->getDescriberType()] = loadRegions(featuresFolders, viewId, *imageDescriber, containersCache.get());
+        return regionsPerDesc;
+    };
+
+    return std::make_unique<feature::RegionsCache>(loader, memoryBudget);
+}
+
 }  // namespace sfm
 }  // namespace aliceVision
@@ -12,30 +12,62 @@
 #include <aliceVision/feature/ImageDescriber.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 #include <aliceVision/feature/RegionsPerView.hpp>
+#include <aliceVision/feature/RegionsProvider.hpp>
 #include <aliceVision/feature/FeaturesPerView.hpp>
+#include <aliceVision/feature/RegionsContainer.hpp>
 
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 
 namespace aliceVision {
 namespace sfm {
 
+/**
+ * @brief Regions containers mapped by a caller loading many views, shared by all its loading threads.
+ *        The folders without container are remembered as well, the mappings are released with the cache.
+ * @note Thread-safe
+ */
+class RegionsContainersCache
+{
+  public:
+    /**
+     * @brief Get the regions container of the given describer type in the given folder, mapped on the first request.
+     * @return the regions container or nullptr if the folder has no container
+     */
+    std::shared_ptr<const feature::RegionsContainer> get(const std::string& folder, feature::EImageDescriberType describerType);
+
+  private:
+    std::mutex _mutex;
+    std::map<std::string, std::shared_ptr<const feature::RegionsContainer>> _containers;
+};
+
 /**
  * @brief Load Regions (Features & Descriptors) for one view.
  * @param[in] folders The list of featureFolders
  * @param[in] viewId The view id
  * @param[in] imageDescriber The imageDescriber type
+ * @param[in] containersCache The regions containers mapped by the caller, nullptr to map the containers for this view only
  * @return loaded Regions
  */
-std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& folders, IndexT viewId, const feature::ImageDescriber& imageDescriber);
+std::unique_ptr<feature::Regions> loadRegions(const std::vector<std::string>& folders,
+                                              IndexT viewId,
+                                              const feature::ImageDescriber& imageDescriber,
+                                              RegionsContainersCache* containersCache = nullptr);
 
 /**
  * @brief Load Features for one view.
  * @param[in] folders The list of featureFolders
  * @param[in] viewId The view id
  * @param[in] imageDescriber The imageDescriber type
+ * @param[in] containersCache The regions containers mapped by the caller, nullptr to map the containers for this view only
  * @return loaded Regions (with only features)
  */
-std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& folders, IndexT viewId, const feature::ImageDescriber& imageDescriber);
+std::unique_ptr<feature::Regions> loadFeatures(const std::vector<std::string>& folders,
+                                               IndexT viewId,
+                                               const feature::ImageDescriber& imageDescriber,
+                                               RegionsContainersCache* containersCache = nullptr);
 
 /**
  * @brief Load Features for each given view.
@@ -67,6 +99,8 @@ bool loadRegionsPerView(feature::RegionsPerView& regionsPerView,
 
 /**
  * @brief Load Features for each view of the provided SfMData container.
+ * @note The features are loaded up front, not through a RegionsProvider: only the positions are kept
+ *       and the SfM engines access the features of any view during the whole reconstruction.
  * @param[in,out] featuresPerView
  * @param[in] sfmData The provided SfMData container
  * @param[in] folders The feature Folders
@@ -78,5 +112,42 @@ bool loadFeaturesPerView(feature::FeaturesPerView& featuresPerView,
                          const std::vector<std::string>& folders,
                          const std::vector<feature::EImageDescriberType>& imageDescriberTypes);
 
+/**
+ * @brief Get the amount of data (in bytes) of regions, with one descriptor per feature.
+ * @param[in] regions The regions (the descriptors are not needed)
+ * @return the amount of data of the features and of the descriptors
+ */
+std::size_t getRegionsSize(const feature::Regions& regions);
+
+/**
+ * @brief Get the amount of regions data (features & descriptors) of each view of the provided SfMData container,
+ *        for all the given describer types. Only the features are loaded.
+ * @param[out] regionsSizePerView The amount of regions data (in bytes) per view
+ * @param[in] sfmData The provided SfMData container
+ * @param[in] folders The feature Folders
+ * @param[in] imageDescriberTypes The imageDescriber types
+ * @param[in] filter To get the size only for a sub-set of the views contained in the sfmData
+ * @return true if the features are correctly loaded
+ */
+bool getRegionsSizePerView(std::map<IndexT, std::size_t>& regionsSizePerView,
+                           const sfmData::SfMData& sfmData,
+                           const std::vector<std::string>& folders,
+                           const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
+                           const std::set<IndexT>& filter = std::set<IndexT>());
+
+/**
+ * @brief Create a regions cache loading on demand the regions (features & descriptors) of the views of the provided SfMData container.
+ *        The regions are loaded without copy from the regions containers when available (memory-mapped).
+ * @param[in] sfmData The provided SfMData container
+ * @param[in] folders The feature Folders
+ * @param[in] imageDescriberTypes The imageDescriber types
+ * @param[in] memoryBudget The maximum amount of regions data in memory (in bytes), 0 for no limit
+ * @return the regions cache
+ */
+std::unique_ptr<feature::RegionsCache> createRegionsCache(const sfmData::SfMData& sfmData,
+                                                          const std::vector<std::string>& folders,
+                                                          const std::vector<feature::EImageDescriberType>& imageDescriberTypes,
+                                                          std::size_t memoryBudget);
+
 }  // namespace sfm
 }  // namespace aliceVision
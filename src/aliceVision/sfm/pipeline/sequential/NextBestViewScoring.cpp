@@ -0,0 +1,128 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "NextBestViewScoring.hpp"
+
+#include <stdexcept>
+
+namespace aliceVision {
+namespace sfm {
+
+NextBestViewScoring::NextBestViewScoring(std::size_t pyramidBase, std::size_t pyramidDepth, const std::vector<int>& pyramidWeights)
+  : _pyramidDepth(pyramidDepth),
+    _pyramidWeights(pyramidWeights)
+{
+    if (_pyramidWeights.size() != _pyramidDepth)
+        throw std::runtime_error("NextBestViewScoring: the number of pyramid weights must be the pyramid depth.");
+
+    std::size_t width = 1;
+    for (std::size_t level = 0; level < _pyramidDepth; ++level)
+    {
+        width *= pyramidBase;
+        _nbCells += width * width;
+    }
+}
+
+void NextBestViewScoring::update(const sfmData::Landmarks& landmarks,
+                                 const track::FlatTracks& tracks,
+                                 const std::vector<std::uint32_t>& tracksPyramid)
+{
+    ++_updateIndex;
+    _trackUpdates.resize(tracks.nbTracks(), 0);
+
+    // new reconstructed tracks
+    for (const auto& landmark : landmarks)
+    {
+        const std::size_t trackId = landmark.first;
+        if (trackId >= tracks.nbTracks())
+            continue;
+
+        // the tracks not reconstructed have no update index
+        const bool reconstructed = (_trackUpdates[trackId] != 0);
+        _trackUpdates[trackId] = _updateIndex;
+        if (reconstructed)
+            continue;
+        _reconstructedTracks.push_back(trackId);
+        updateTrack(trackId, tracks, tracksPyramid, true);
+    }
+
+    // removed tracks, not seen by this update
+    std::size_t nbReconstructedTracks = 0;
+    for (const std::size_t trackId : _reconstructedTracks)
+    {
+        if (_trackUpdates[trackId] == _updateIndex)
+        {
+            _reconstructedTracks[nbReconstructedTracks++] = trackId;
+            continue;
+        }
+        _trackUpdates[trackId] = 0;
+        updateTrack(trackId, tracks, tracksPyramid, false);
+    }
+    _reconstructedTracks.resize(nbReconstructedTracks);
+}
+
+std::size_t NextBestViewScoring::getNbReconstructedTracks(IndexT viewId) const
+{
+    const auto it = _countersPerView.find(viewId);
+    return (it == _countersPerView.end()) ? 0 : it->second.nbTracks;
+}
+
+std::size_t NextBestViewScoring::getScore(IndexT viewId) const
+{
+    const auto it = _countersPerView.find(viewId);
+    if (it == _countersPerView.end())
+        return 0;
+
+    std::size_t score = 0;
+    for (std::size_t level = 0; level < _pyramidDepth; ++level)
+        score += it->second.nbOccupiedCellsPerLevel[level] * _pyramidWeights[level];
+    return score;
+}
+
+void NextBestViewScoring::updateTrack(std::size_t trackId, const track::FlatTracks& tracks, const std::vector<std::uint32_t>& tracksPyramid, bool added)
+{
+    for (std::size_t k = tracks.offsets[trackId]; k < tracks.offsets[trackId + 1]; ++k)
+    {
+        if (!tracks.isFirstInView(trackId, k))
+            continue;
+
+        const IndexT viewId = tracks.viewIds[k];
+        ViewCounters& counters = _countersPerView[viewId];
+
+        if (counters.nbTracksPerCell.empty())
+        {
+            counters.nbOccupiedCellsPerLevel.assign(_pyramidDepth, 0);
+            counters.nbTracksPerCell.assign(_nbCells, 0);
+        }
+
+        for (std::size_t level = 0; level < _pyramidDepth; ++level)
+        {
+            const std::size_t cell = tracksPyramid[k * _pyramidDepth + level];
+            if (added)
+            {
+                if (counters.nbTracksPerCell[cell]++ == 0)
+                    ++counters.nbOccupiedCellsPerLevel[level];
+            }
+            else if (--counters.nbTracksPerCell[cell] == 0)
+            {
+                --counters.nbOccupiedCellsPerLevel[level];
+            }
+        }
+
+        if (added)
+        {
+            ++counters.nbTracks;
+        }
+        else if (--counters.nbTracks == 0)
+        {
+            // release the cells of the views without reconstructed track
+            _countersPerView.erase(viewId);
+        }
+    }
+}
+
+}  // namespace sfm
+}  // namespace aliceVision
@@ -0,0 +1,94 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/types.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/track/Track.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace aliceVision {
+namespace sfm {
+
+/**
+ * @brief Next best view scores of the views, incrementally maintained from the reconstructed tracks.
+ *
+ * For each view, the number of reconstructed tracks and the number of reconstructed tracks in each cell
+ * of the pyramid are only updated for the views of the tracks added to
+ * or removed from the reconstruction since the last update.
+ * The score of a view is the number of occupied cells of each pyramid level, weighted per level,
+ * which is the same as scoring the reconstructed tracks of the view from scratch.
+ */
+class NextBestViewScoring
+{
+  public:
+    NextBestViewScoring() = default;
+
+    /**
+     * @param[in] pyramidBase The number of cells of the first pyramid level along each image dimension
+     * @param[in] pyramidDepth The number of pyramid levels
+     * @param[in] pyramidWeights The weight of each pyramid level
+     */
+    NextBestViewScoring(std::size_t pyramidBase, std::size_t pyramidDepth, const std::vector<int>& pyramidWeights);
+
+    /**
+     * @brief Update the counters with the tracks added to or removed from the landmarks since the last update.
+     * @note Each landmark corresponds to the track with the same id, the landmarks without track are ignored.
+     * @param[in] landmarks The reconstructed landmarks
+     * @param[in] tracks All the putative tracks
+     * @param[in] tracksPyramid The pyramid cell of each observation of the tracks, for each level: [observation * pyramidDepth + level]
+     */
+    void update(const sfmData::Landmarks& landmarks, const track::FlatTracks& tracks, const std::vector<std::uint32_t>& tracksPyramid);
+
+    /**
+     * @return the number of reconstructed tracks observed by the view
+     */
+    std::size_t getNbReconstructedTracks(IndexT viewId) const;
+
+    /**
+     * @return the score of the view based on the repartition of its reconstructed tracks in the pyramid cells
+     */
+    std::size_t getScore(IndexT viewId) const;
+
+    /**
+     * @return the number of reconstructed tracks
+     */
+    std::size_t getNbReconstructedTracks() const { return _reconstructedTracks.size(); }
+
+  private:
+    struct ViewCounters
+    {
+        std::size_t nbTracks = 0;
+        /// number of cells with at least one reconstructed track, per level
+        std::vector<std::size_t> nbOccupiedCellsPerLevel;
+        /// number of reconstructed tracks per cell of all the levels
+        std::vector<std::uint32_t> nbTracksPerCell;
+    };
+
+    /**
+     * @brief Add (or remove) a track to the counters of its views.
+     * @param[in] added True to add the track, false to remove it
+     */
+    void updateTrack(std::size_t trackId, const track::FlatTracks& tracks, const std::vector<std::uint32_t>& tracksPyramid, bool added);
+
+    std::size_t _pyramidDepth = 0;
+    std::size_t _nbCells = 0;
+    std::vector<int> _pyramidWeights;
+
+    HashMap<IndexT, ViewCounters> _countersPerView;
+    /// ids of the reconstructed tracks
+    std::vector<std::size_t> _reconstructedTracks;
+    /// index of the last update of each track that saw it reconstructed, 0 if never reconstructed
+    std::vector<std::size_t> _trackUpdates;
+    std::size_t _updateIndex = 0;
+};
+
+}  // namespace sfm
+}  // namespace aliceVision
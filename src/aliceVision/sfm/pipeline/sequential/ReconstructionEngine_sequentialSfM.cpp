@@ -30,6 +30,7 @@
 #include <aliceVision/system/MemoryInfo.hpp>
 #include <aliceVision/track/TracksBuilder.hpp>
 #include <aliceVision/track/tracksUtils.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
 #include <dependencies/htmlDoc/htmlDoc.hpp>
 
@@ -40,6 +41,7 @@
 #include <tuple>
 #include <iostream>
 #include <algorithm>
+#include <random>
 
 #ifdef _MSC_VER
     #pragma warning(once : 4267)  // warning C4267: 'argument' : conversion from 'size_t' to 'const int', possible loss of data
@@ -58,21 +60,19 @@ using namespace aliceVision::sfmData;
  * @brief Compute indexes of all features in a fixed size pyramid grid.
  * These precomputed values are useful to the next best view selection for incremental SfM.
  *
- * @param[in] tracksPerView: The list of TrackID per view
- * @param[in] map_tracks: All putative tracks
+ * @param[in] tracks: All putative tracks
  * @param[in] views: All views
  * @param[in] featuresProvider: Input features and descriptors
  * @param[in] pyramidDepth: Depth of the pyramid.
- * @param[out] tracksPyramidPerView:
- *             Precomputed list of pyramid cells ID for each track in each view.
+ * @param[out] tracksPyramid:
+ *             Precomputed pyramid cell ID of each observation of the tracks, for each level.
  */
-void computeTracksPyramidPerView(const track::TracksPerView& tracksPerView,
-                                 const track::TracksMap& map_tracks,
-                                 const Views& views,
-                                 const feature::FeaturesPerView& featuresProvider,
-                                 const std::size_t pyramidBase,
-                                 const std::size_t pyramidDepth,
-                                 track::TracksPyramidPerView& tracksPyramidPerView)
+void computeTracksPyramid(const track::FlatTracks& tracks,
+                          const Views& views,
+                          const feature::FeaturesPerView& featuresProvider,
+                          const std::size_t pyramidBase,
+                          const std::size_t pyramidDepth,
+                          std::vector<std::uint32_t>& tracksPyramid)
 {
     std::vector<std::size_t> widthPerLevel(pyramidDepth);
     std::vector<std::size_t> startPerLevel(pyramidDepth);
@@ -84,42 +84,28 @@ void computeTracksPyramidPerView(const track::TracksPerView& tracksPerView,
         start += Square(widthPerLevel[level]);
     }
 
-    tracksPyramidPerView.reserve(tracksPerView.size());
-    for (const auto& viewTracks : tracksPerView)
-    {
-        auto& trackPyramid = tracksPyramidPerView[viewTracks.first];
-        // reserve 500 tracks in each view
-        trackPyramid.reserve(500 * pyramidDepth);
-    }
+    tracksPyramid.resize(tracks.nbObservations() * pyramidDepth);
 
-    for (const auto& viewTracks : tracksPerView)
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (std::ptrdiff_t t = 0; t < static_cast<std::ptrdiff_t>(tracks.nbTracks()); ++t)
     {
-        const auto viewId = viewTracks.first;
-        auto& tracksPyramidIndex = tracksPyramidPerView[viewId];
-        const View& view = *views.at(viewId).get();
-        std::vector<double> cellWidthPerLevel(pyramidDepth);
-        std::vector<double> cellHeightPerLevel(pyramidDepth);
-        for (std::size_t level = 0; level < pyramidDepth; ++level)
-        {
-            cellWidthPerLevel[level] = (double)view.getImage().getWidth() / (double)widthPerLevel[level];
-            cellHeightPerLevel[level] = (double)view.getImage().getHeight() / (double)widthPerLevel[level];
-        }
-        for (std::size_t i = 0; i < viewTracks.second.size(); ++i)
+        for (std::size_t k = tracks.offsets[t]; k < tracks.offsets[t + 1]; ++k)
         {
-            const std::size_t trackId = viewTracks.second[i];
-            const track::Track& track = map_tracks.at(trackId);
-            const std::size_t featIndex = track.featPerView.at(viewId).featureId;
-            const auto& feature = featuresProvider.getFeatures(viewId, track.descType)[featIndex];
+            const IndexT viewId = tracks.viewIds[k];
+            const View& view = *views.at(viewId).get();
+            const auto& feature = featuresProvider.getFeatures(viewId, tracks.descTypes[t])[tracks.featureIds[k]];
 
             for (std::size_t level = 0; level < pyramidDepth; ++level)
             {
-                std::size_t xCell = std::floor(std::max(feature.x(), 0.0f) / cellWidthPerLevel[level]);
-                std::size_t yCell = std::floor(std::max(feature.y(), 0.0f) / cellHeightPerLevel[level]);
+                const double cellWidth = (double)view.getImage().getWidth() / (double)widthPerLevel[level];
+                const double cellHeight = (double)view.getImage().getHeight() / (double)widthPerLevel[level];
+                std::size_t xCell = std::floor(std::max(feature.x(), 0.0f) / cellWidth);
+                std::size_t yCell = std::floor(std::max(feature.y(), 0.0f) / cellHeight);
                 xCell = std::min(xCell, widthPerLevel[level] - 1);
                 yCell = std::min(yCell, widthPerLevel[level] - 1);
                 const std::size_t levelIndex = xCell + yCell * widthPerLevel[level];
                 assert(levelIndex < Square(widthPerLevel[level]));
-                tracksPyramidIndex[trackId * pyramidDepth + level] = startPerLevel[level] + levelIndex;
+                tracksPyramid[k * pyramidDepth + level] = static_cast<std::uint32_t>(startPerLevel[level] + levelIndex);
             }
         }
     }
@@ -247,6 +233,9 @@ void ReconstructionEngine_sequentialSfM::initializePyramidScoring()
         }
         _pyramidThreshold = maxWeight * 0.2;
     }
+
+    // the scores are computed from the reconstructed tracks at the next search of connected views
+    _nextBestViewScoring = NextBestViewScoring(_params.pyramidBase, _params.pyramidDepth, _pyramidWeights);
 }
 
 std::size_t ReconstructionEngine_sequentialSfM::fuseMatchesIntoTracks()
@@ -265,37 +254,35 @@ std::size_t ReconstructionEngine_sequentialSfM::fuseMatchesIntoTracks()
         tracksBuilder.filter(_params.filterTrackForks, _params.minInputTrackLength);
 
         ALICEVISION_LOG_DEBUG("Track export to internal structure");
-        // build tracks with STL compliant type
-        tracksBuilder.exportToSTL(_map_tracks);
+        tracksBuilder.exportToFlat(_flatTracks);
         ALICEVISION_LOG_DEBUG("Build tracks per view");
+        track::computeFlatTracksPerView(_flatTracks, _flatTracksPerView);
 
         // Init tracksPerView to have an entry in the map for each view (even if there is no track at all)
+        track::convertToTracksPerView(_flatTracksPerView, _map_tracksPerView);
         for (const auto& viewIt : _sfmData.getViews())
         {
             // create an entry in the map
             _map_tracksPerView[viewIt.first];
         }
-        track::computeTracksPerView(_map_tracks, _map_tracksPerView);
         ALICEVISION_LOG_DEBUG("Build tracks pyramid per view");
-        computeTracksPyramidPerView(_map_tracksPerView,
-                                    _map_tracks,
-                                    _sfmData.getViews(),
-                                    *_featuresPerView,
-                                    _params.pyramidBase,
-                                    _params.pyramidDepth,
-                                    _map_featsPyramidPerView);
+        computeTracksPyramid(_flatTracks, _sfmData.getViews(), *_featuresPerView, _params.pyramidBase, _params.pyramidDepth, _tracksPyramid);
 
         // display stats
         {
-            std::set<size_t> imagesId;
-            track::imageIdInTracks(_map_tracksPerView, imagesId);
-
             ALICEVISION_LOG_INFO("Fuse matches into tracks: " << std::endl
-                                                              << "\t- # tracks: " << tracksBuilder.nbTracks() << std::endl
-                                                              << "\t- # images in tracks: " << imagesId.size());
+                                                              << "\t- # tracks: " << _flatTracks.nbTracks() << std::endl
+                                                              << "\t- # images in tracks: " << _flatTracksPerView.nbViews());
 
             std::map<size_t, size_t> map_Occurence_TrackLength;
-            track::tracksLength(_map_tracks, map_Occurence_TrackLength);
+            for (std::size_t trackId = 0; trackId < _flatTracks.nbTracks(); ++trackId)
+            {
+                // number of views of the track
+                std::size_t trackLength = 0;
+                for (std::size_t k = _flatTracks.offsets[trackId]; k < _flatTracks.offsets[trackId + 1]; ++k)
+                    trackLength += _flatTracks.isFirstInView(trackId, k);
+                ++map_Occurence_TrackLength[trackLength];
+            }
             ALICEVISION_LOG_INFO("TrackLength, Occurrence");
             for (const auto& iter : map_Occurence_TrackLength)
             {
@@ -305,7 +292,7 @@ std::size_t ReconstructionEngine_sequentialSfM::fuseMatchesIntoTracks()
             }
         }
     }
-    return _map_tracks.size();
+    return _flatTracks.nbTracks();
 }
 
 std::vector<Pair> ReconstructionEngine_sequentialSfM::getInitialImagePairsCandidates()
@@ -364,10 +351,12 @@ void ReconstructionEngine_sequentialSfM::registerChanges(std::set<IndexT>& linke
     const sfmData::Landmarks& landmarks = _sfmData.getLandmarks();
     for (IndexT id : newReconstructedViews)
     {
-        const track::TrackIdSet& setTracks = _map_tracksPerView[id];
+        const std::pair<std::size_t, std::size_t> observations = _flatTracksPerView.getObservations(id);
 
-        for (auto idTrack : setTracks)
+        for (std::size_t i = observations.first; i < observations.second; ++i)
         {
+            const std::size_t idTrack = _flatTracksPerView.trackIds[i];
+
             // Check that this track is indeed a landmark
             if (landmarks.find(idTrack) == landmarks.end())
             {
@@ -381,10 +370,9 @@ void ReconstructionEngine_sequentialSfM::registerChanges(std::set<IndexT>& linke
                 continue;
             }
 
-            const track::Track& track = _map_tracks[idTrack];
-            for (const auto& pairFeat : track.featPerView)
+            for (std::size_t k = _flatTracks.offsets[idTrack]; k < _flatTracks.offsets[idTrack + 1]; ++k)
             {
-                IndexT oview = pairFeat.first;
+                IndexT oview = _flatTracks.viewIds[k];
                 if (oview == id)
                 {
                     continue;
@@ -434,14 +422,14 @@ void ReconstructionEngine_sequentialSfM::remapLandmarkIdsToTrackIds()
     ALICEVISION_LOG_DEBUG("Find corresponding landmark id per track id");
 
     // find corresponding landmark id per track id
-    for (const auto& trackPair : _map_tracks)
+    for (std::size_t trackId = 0; trackId < _flatTracks.nbTracks(); ++trackId)
     {
-        const IndexT trackId = trackPair.first;
-        const Track& track = trackPair.second;
-
-        for (const auto& featView : track.featPerView)
+        for (std::size_t k = _flatTracks.offsets[trackId]; k < _flatTracks.offsets[trackId + 1]; ++k)
         {
-            const ObsToLandmark::const_iterator it = obsToLandmark.find(ObsKey(featView.first, featView.second.featureId, track.descType));
+            if (!_flatTracks.isFirstInView(trackId, k))
+                continue;
+
+            const ObsToLandmark::const_iterator it = obsToLandmark.find(ObsKey(_flatTracks.viewIds[k], _flatTracks.featureIds[k], _flatTracks.descTypes[trackId]));
 
             if (it != obsToLandmark.end())
             {
@@ -453,7 +441,7 @@ void ReconstructionEngine_sequentialSfM::remapLandmarkIdsToTrackIds()
     }
 
     ALICEVISION_LOG_INFO("Landmark ids to track ids remapping: " << std::endl
-                                                                 << "\t- # tracks: " << _map_tracks.size() << std::endl
+                                                                 << "\t- # tracks: " << _flatTracks.nbTracks() << std::endl
                                                                  << "\t- # input landmarks: " << landmarks.size() << std::endl
                                                                  << "\t- # output landmarks: " << _sfmData.getLandmarks().size());
 }
@@ -529,8 +517,12 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
         std::set<IndexT> prevReconstructedViews = _sfmData.getValidViews();
 
         // compute robust resection of remaining images
-        while (findNextBestViews(bestViewCandidates, viewsToVisit))
+        while (true)
         {
+            updateNextBestViewScoring();
+            if (!findNextBestViews(bestViewCandidates, viewsToVisit))
+                break;
+
             ALICEVISION_LOG_INFO("Update Reconstruction:" << std::endl
                                                           << "\t- resection id: " << _resectionId << std::endl
                                                           << "\t- # images in the resection group: " << bestViewCandidates.size() << std::endl
@@ -549,7 +541,7 @@ double ReconstructionEngine_sequentialSfM::incrementalReconstruction()
                 continue;
             }
 
-            int minimalResectionedViewsForBundle = 10;
+            std::size_t minimalResectionedViewsForBundle = _params.minNbResectionedViewsForBundle;
 
             // The beginning of the incremental SfM is a well known risky and
             // unstable step which has a big impact on the final result.
@@ -638,62 +630,102 @@ std::set<IndexT> ReconstructionEngine_sequentialSfM::resection(IndexT resectionI
 {
     auto chrono_start = std::chrono::steady_clock::now();
 
-    // add images to the 3D reconstruction
-#pragma omp parallel for
-    for (int i = 0; i < bestViewIds.size(); ++i)
+    // add images to the 3D reconstruction, batch by batch
+    std::vector<IndexT> remainingViewIds = bestViewIds;
+    std::vector<IndexT> batchViewIds;
+    while (!remainingViewIds.empty())
     {
-        const IndexT viewId = bestViewIds.at(i);
-        const View& view = *_sfmData.getViews().at(viewId);
+        selectResectionBatch(remainingViewIds, batchViewIds);
 
-        if (view.isPartOfRig())
+        ResectionBatchStats batchStats;
+        batchStats.resectionId = resectionId;
+        batchStats.nbViews = batchViewIds.size();
+        system::Timer timer;
+
+        // The random generator of each view is seeded from the engine generator and the view id,
+        // so the resection does not depend on the number of threads and on their scheduling.
+        const std::mt19937::result_type seed = _randomNumberGenerator();
+
+        // -- Compute: the views of the batch are resected on the same state of the reconstruction, which is only read
+        std::vector<ResectionData> resectionDataPerView(batchViewIds.size());
+        std::vector<char> hasResectedPerView(batchViewIds.size(), false);
+
+#pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < batchViewIds.size(); ++i)
         {
-            // some views can become indirectly localized when the sub-pose becomes defined
-            if (_sfmData.isPoseAndIntrinsicDefined(view.getViewId()))
+            const IndexT viewId = batchViewIds.at(i);
+            const View& view = *_sfmData.getViews().at(viewId);
+
+            if (view.isPartOfRig())
             {
-                ALICEVISION_LOG_DEBUG("Resection of image " << i << " was skipped." << std::endl
-                                                            << "View indirectly localized, sub-pose and pose already defined." << std::endl
-                                                            << "\t- view id: " << viewId << std::endl
-                                                            << "\t- rig id: " << view.getRigId() << std::endl
-                                                            << "\t- sub-pose id: " << view.getSubPoseId());
+                // some views can become indirectly localized when the sub-pose becomes defined
+                if (_sfmData.isPoseAndIntrinsicDefined(view.getViewId()))
+                {
+                    ALICEVISION_LOG_DEBUG("Resection of image " << i << " was skipped." << std::endl
+                                                                << "View indirectly localized, sub-pose and pose already defined." << std::endl
+                                                                << "\t- view id: " << viewId << std::endl
+                                                                << "\t- rig id: " << view.getRigId() << std::endl
+                                                                << "\t- sub-pose id: " << view.getSubPoseId());
 
-                continue;
-            }
+                    continue;
+                }
 
-            // we cannot localize a view if it is part of an initialized rig with unknown rig pose and unknown sub-pose
-            const bool knownPose = _sfmData.existsPose(view);
-            const Rig& rig = _sfmData.getRig(view);
-            const RigSubPose& subpose = rig.getSubPose(view.getSubPoseId());
+                // we cannot localize a view if it is part of an initialized rig with unknown rig pose and unknown sub-pose
+                const bool knownPose = _sfmData.existsPose(view);
+                const Rig& rig = _sfmData.getRig(view);
+                const RigSubPose& subpose = rig.getSubPose(view.getSubPoseId());
 
-            if (rig.isInitialized() && !knownPose && (subpose.status == ERigSubPoseStatus::UNINITIALIZED))
-            {
-                ALICEVISION_LOG_DEBUG("Resection of image " << i << " was skipped." << std::endl
-                                                            << "Rig initialized but unkown pose and sub-pose." << std::endl
-                                                            << "\t- view id: " << viewId << std::endl
-                                                            << "\t- rig id: " << view.getRigId() << std::endl
-                                                            << "\t- sub-pose id: " << view.getSubPoseId());
+                if (rig.isInitialized() && !knownPose && (subpose.status == ERigSubPoseStatus::UNINITIALIZED))
+                {
+                    ALICEVISION_LOG_DEBUG("Resection of image " << i << " was skipped." << std::endl
+                                                                << "Rig initialized but unkown pose and sub-pose." << std::endl
+                                                                << "\t- view id: " << viewId << std::endl
+                                                                << "\t- rig id: " << view.getRigId() << std::endl
+                                                                << "\t- sub-pose id: " << view.getSubPoseId());
 
-                continue;
+                    continue;
+                }
             }
-        }
 
-        ResectionData newResectionData;
-        newResectionData.error_max = _params.localizerEstimatorError;
-        newResectionData.max_iteration = _params.localizerEstimatorMaxIterations;
-        const bool hasResected = computeResection(viewId, newResectionData);
+            ResectionData& newResectionData = resectionDataPerView[i];
+            newResectionData.error_max = _params.localizerEstimatorError;
+            newResectionData.max_iteration = _params.localizerEstimatorMaxIterations;
 
-#pragma omp critical
+            std::seed_seq seedSequence{seed, static_cast<std::mt19937::result_type>(viewId)};
+            std::mt19937 randomNumberGenerator(seedSequence);
+            hasResectedPerView[i] = computeResection(viewId, randomNumberGenerator, newResectionData);
+        }
+        batchStats.computeTime = timer.elapsed();
+        timer.reset();
+
+        // -- Merge: in the order of the views priority
+        for (std::size_t i = 0; i < batchViewIds.size(); ++i)
         {
-            if (hasResected)
+            const IndexT viewId = batchViewIds[i];
+            if (!hasResectedPerView[i])
             {
-                updateScene(viewId, newResectionData);
-                ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) succeed.");
-                _sfmData.getViews().at(viewId)->setResectionId(resectionId);
+                ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) was not possible.");
+                continue;
             }
-            else
+
+            // the pose may have been defined by a previous view of the batch
+            if (_sfmData.isPoseAndIntrinsicDefined(viewId))
             {
-                ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) was not possible.");
+                ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) was discarded, pose already defined.");
+                continue;
             }
+
+            updateScene(viewId, resectionDataPerView[i]);
+            ALICEVISION_LOG_DEBUG("Resection of image " << i << " ( view id: " << viewId << " ) succeed.");
+            _sfmData.getViews().at(viewId)->setResectionId(resectionId);
+            ++batchStats.nbResectedViews;
         }
+        batchStats.mergeTime = timer.elapsed();
+
+        ALICEVISION_LOG_INFO("Resection batch " << _resectionBatchesStats.size() << ": " << batchStats.nbResectedViews << " / " << batchStats.nbViews
+                                                << " views resected (compute: " << batchStats.computeTime
+                                                << " s, merge: " << batchStats.mergeTime << " s).");
+        _resectionBatchesStats.push_back(batchStats);
     }
 
     ALICEVISION_LOG_DEBUG(
@@ -716,6 +748,45 @@ std::set<IndexT> ReconstructionEngine_sequentialSfM::resection(IndexT resectionI
     return newReconstructedViews;
 }
 
+void ReconstructionEngine_sequentialSfM::selectResectionBatch(std::vector<IndexT>& remainingViewIds, std::vector<IndexT>& batchViewIds) const
+{
+    batchViewIds.clear();
+
+    // the intrinsics used for the first time are estimated by the resection
+    const std::set<IndexT> reconstructedIntrinsics = _sfmData.getReconstructedIntrinsics();
+
+    std::set<IndexT> batchPoses;
+    std::set<IndexT> batchRigs;
+    std::set<IndexT> batchNewIntrinsics;
+    std::vector<IndexT> nextViewIds;
+
+    for (const IndexT viewId : remainingViewIds)
+    {
+        const View& view = *_sfmData.getViews().at(viewId);
+        const IndexT intrinsicId = view.getIntrinsicId();
+        const bool newIntrinsic = (reconstructedIntrinsics.count(intrinsicId) == 0);
+
+        const bool isFull = (_params.maxResectionBatchSize > 0 && batchViewIds.size() >= _params.maxResectionBatchSize);
+        const bool conflict = batchPoses.count(view.getPoseId()) || (view.isPartOfRig() && batchRigs.count(view.getRigId())) ||
+                              (newIntrinsic && batchNewIntrinsics.count(intrinsicId));
+
+        if (isFull || conflict)
+        {
+            nextViewIds.push_back(viewId);
+            continue;
+        }
+
+        batchViewIds.push_back(viewId);
+        batchPoses.insert(view.getPoseId());
+        if (view.isPartOfRig())
+            batchRigs.insert(view.getRigId());
+        if (newIntrinsic)
+            batchNewIntrinsics.insert(intrinsicId);
+    }
+
+    remainingViewIds.swap(nextViewIds);
+}
+
 void ReconstructionEngine_sequentialSfM::triangulate(const std::set<IndexT>& prevReconstructedViews, const std::set<IndexT>& newReconstructedViews)
 {
     auto chrono_start = std::chrono::steady_clock::now();
@@ -961,6 +1032,18 @@ void ReconstructionEngine_sequentialSfM::exportStatistics(double reconstructionT
         for (std::size_t i = 2; i < obsHistogram.size(); ++i)
             _jsonLogTree.add("sfm.observationsHistogram." + std::to_string(i), obsHistogram[i]);
 
+        // resection batches
+        double resectionComputeTime = 0.0;
+        double resectionMergeTime = 0.0;
+        for (const ResectionBatchStats& batchStats : _resectionBatchesStats)
+        {
+            resectionComputeTime += batchStats.computeTime;
+            resectionMergeTime += batchStats.mergeTime;
+        }
+        _jsonLogTree.put("sfm.resectionBatches.count", _resectionBatchesStats.size());
+        _jsonLogTree.put("sfm.resectionBatches.computeTime", resectionComputeTime);
+        _jsonLogTree.put("sfm.resectionBatches.mergeTime", resectionMergeTime);
+
         _jsonLogTree.put("sfm.time", reconstructionTime);                         // process time
         _jsonLogTree.put("hardware.cpu.freq", system::cpu_clock_by_os());         // cpu frequency
         _jsonLogTree.put("hardware.cpu.cores", system::get_total_cpus());         // cpu cores
@@ -985,6 +1068,12 @@ void ReconstructionEngine_sequentialSfM::calibrateRigs(std::set<IndexT>& updated
     }
 }
 
+void ReconstructionEngine_sequentialSfM::updateNextBestViewScoring()
+{
+    // Only the views of the tracks added to or removed from the reconstruction since the last update are updated
+    _nextBestViewScoring.update(_sfmData.getLandmarks(), _flatTracks, _tracksPyramid);
+}
+
 bool ReconstructionEngine_sequentialSfM::findConnectedViews(std::vector<ViewConnectionScore>& out_connectedViews,
                                                             const std::set<IndexT>& remainingViewIds) const
 {
@@ -993,27 +1082,18 @@ bool ReconstructionEngine_sequentialSfM::findConnectedViews(std::vector<ViewConn
     if (remainingViewIds.empty() || _sfmData.getLandmarks().empty())
         return false;
 
-    // Collect tracksIds
-    std::set<size_t> reconstructed_trackId;
-    std::transform(_sfmData.getLandmarks().begin(),
-                   _sfmData.getLandmarks().end(),
-                   std::inserter(reconstructed_trackId, reconstructed_trackId.begin()),
-                   stl::RetrieveKey());
-
     const std::set<IndexT> reconstructedIntrinsics = _sfmData.getReconstructedIntrinsics();
+    const std::vector<IndexT> remainingViews(remainingViewIds.begin(), remainingViewIds.end());
 
 #pragma omp parallel for
-    for (int i = 0; i < remainingViewIds.size(); ++i)
+    for (int i = 0; i < remainingViews.size(); ++i)
     {
-        std::set<IndexT>::const_iterator iter = remainingViewIds.cbegin();
-        std::advance(iter, i);
-        const IndexT viewId = *iter;
+        const IndexT viewId = remainingViews[i];
         const IndexT intrinsicId = _sfmData.getViews().at(viewId)->getIntrinsicId();
         const bool isIntrinsicsReconstructed = reconstructedIntrinsics.count(intrinsicId);
 
         // Compute 2D - 3D possible content
-        const aliceVision::track::TrackIdSet& set_tracksIds = _map_tracksPerView.at(viewId);
-        if (set_tracksIds.empty())
+        if (_flatTracksPerView.nbTracks(viewId) == 0)
             continue;
 
         // Check if the view is part of a rig
@@ -1042,19 +1122,17 @@ bool ReconstructionEngine_sequentialSfM::findConnectedViews(std::vector<ViewConn
 
         // Count the common possible putative point
         //  with the already 3D reconstructed trackId
-        std::vector<std::size_t> vec_trackIdForResection;
-        vec_trackIdForResection.reserve(set_tracksIds.size());
-        std::set_intersection(set_tracksIds.begin(),
-                              set_tracksIds.end(),
-                              reconstructed_trackId.begin(),
-                              reconstructed_trackId.end(),
-                              std::back_inserter(vec_trackIdForResection));
+        const std::size_t nbTracksForResection = _nextBestViewScoring.getNbReconstructedTracks(viewId);
         // Compute an image score based on the number of matches to the 3D scene
         // and the repartition of these features in the image.
-        std::size_t score = computeCandidateImageScore(viewId, vec_trackIdForResection);
+#ifdef ALICEVISION_NEXTBESTVIEW_WITHOUT_SCORE
+        const std::size_t score = nbTracksForResection;
+#else
+        const std::size_t score = _nextBestViewScoring.getScore(viewId);
+#endif
 #pragma omp critical
         {
-            out_connectedViews.emplace_back(viewId, vec_trackIdForResection.size(), score, isIntrinsicsReconstructed);
+            out_connectedViews.emplace_back(viewId, nbTracksForResection, score, isIntrinsicsReconstructed);
         }
     }
 
@@ -1206,23 +1284,20 @@ bool ReconstructionEngine_sequentialSfM::makeInitialPair3D(const Pair& currentPa
 
     // b. get common features between the two views
     // use the track to have a more dense match correspondence set
-    aliceVision::track::TracksMap commonTracks;
-    track::getCommonTracksInImagesFast({I, J}, _map_tracks, _map_tracksPerView, commonTracks);
+    std::vector<track::CommonTrack> commonTracks;
+    track::getCommonTracksInViews(_flatTracksPerView, I, J, commonTracks);
 
     // copy point to arrays
     const std::size_t n = commonTracks.size();
     Mat xI(2, n), xJ(2, n);
-    std::size_t cptIndex = 0;
-    for (aliceVision::track::TracksMap::const_iterator iterT = commonTracks.begin(); iterT != commonTracks.end(); ++iterT, ++cptIndex)
+    for (std::size_t cptIndex = 0; cptIndex < n; ++cptIndex)
     {
-        assert(iterT->second.featPerView.size() == 2);
-        auto iter = iterT->second.featPerView.begin();
-        const std::size_t i = iter->second.featureId;
-        const std::size_t j = (++iter)->second.featureId;
+        const track::CommonTrack& commonTrack = commonTracks[cptIndex];
+        const feature::EImageDescriberType descType = _flatTracks.descTypes[commonTrack.trackId];
 
-        Vec2 feat = _featuresPerView->getFeatures(I, iterT->second.descType)[i].coords().cast<double>();
+        Vec2 feat = _featuresPerView->getFeatures(I, descType)[commonTrack.featureIdI].coords().cast<double>();
         xI.col(cptIndex) = camI->get_ud_pixel(feat);
-        feat = _featuresPerView->getFeatures(J, iterT->second.descType)[j].coords().cast<double>();
+        feat = _featuresPerView->getFeatures(J, descType)[commonTrack.featureIdJ].coords().cast<double>();
         xJ.col(cptIndex) = camJ->get_ud_pixel(feat);
     }
     ALICEVISION_LOG_INFO(n << " matches in the image pair for the initial pose estimation.");
@@ -1393,29 +1468,24 @@ bool ReconstructionEngine_sequentialSfM::getBestInitialImagePairs(std::vector<Pa
         if (camI == nullptr || camJ == nullptr)
             continue;
 
-        aliceVision::track::TracksMap map_tracksCommon;
-        const std::set<size_t> set_imageIndex = {I, J};
-        track::getCommonTracksInImagesFast(set_imageIndex, _map_tracks, _map_tracksPerView, map_tracksCommon);
+        std::vector<track::CommonTrack> commonTracks;
+        track::getCommonTracksInViews(_flatTracksPerView, I, J, commonTracks);
 
         // Copy points correspondences to arrays for relative pose estimation
-        const size_t n = map_tracksCommon.size();
+        const size_t n = commonTracks.size();
         ALICEVISION_LOG_DEBUG("Automatic initial pair choice test - I: " << I << ", J: " << J << ", common tracks: " << n);
         Mat xI(2, n), xJ(2, n);
-        size_t cptIndex = 0;
-        std::vector<std::size_t> commonTracksIds(n);
-        for (aliceVision::track::TracksMap::const_iterator iterT = map_tracksCommon.begin(); iterT != map_tracksCommon.end(); ++iterT, ++cptIndex)
+        for (size_t cptIndex = 0; cptIndex < n; ++cptIndex)
         {
-            auto iter = iterT->second.featPerView.begin();
-            const size_t i = iter->second.featureId;
-            const size_t j = (++iter)->second.featureId;
-            commonTracksIds[cptIndex] = iterT->first;
+            const track::CommonTrack& commonTrack = commonTracks[cptIndex];
+            const feature::EImageDescriberType descType = _flatTracks.descTypes[commonTrack.trackId];
 
-            const auto& viewI = _featuresPerView->getFeatures(I, iterT->second.descType);
-            const auto& viewJ = _featuresPerView->getFeatures(J, iterT->second.descType);
+            const auto& viewI = _featuresPerView->getFeatures(I, descType);
+            const auto& viewJ = _featuresPerView->getFeatures(J, descType);
 
-            Vec2 feat = viewI[i].coords().cast<double>();
+            Vec2 feat = viewI[commonTrack.featureIdI].coords().cast<double>();
             xI.col(cptIndex) = camI->get_ud_pixel(feat);
-            feat = viewJ[j].coords().cast<double>();
+            feat = viewJ[commonTrack.featureIdJ].coords().cast<double>();
             xJ.col(cptIndex) = camJ->get_ud_pixel(feat);
         }
 
@@ -1448,10 +1518,11 @@ bool ReconstructionEngine_sequentialSfM::getBestInitialImagePairs(std::vector<Pa
             {
                 Vec3 X;
                 multiview::TriangulateDLT(PI, xI.col(inlier_idx), PJ, xJ.col(inlier_idx), X);
-                IndexT trackId = commonTracksIds[inlier_idx];
-                auto iter = map_tracksCommon[trackId].featPerView.begin();
-                const Vec2 featI = _featuresPerView->getFeatures(I, map_tracksCommon[trackId].descType)[iter->second.featureId].coords().cast<double>();
-                const Vec2 featJ = _featuresPerView->getFeatures(J, map_tracksCommon[trackId].descType)[(++iter)->second.featureId].coords().cast<double>();
+                const track::CommonTrack& commonTrack = commonTracks[inlier_idx];
+                const IndexT trackId = commonTrack.trackId;
+                const feature::EImageDescriberType descType = _flatTracks.descTypes[trackId];
+                const Vec2 featI = _featuresPerView->getFeatures(I, descType)[commonTrack.featureIdI].coords().cast<double>();
+                const Vec2 featJ = _featuresPerView->getFeatures(J, descType)[commonTrack.featureIdJ].coords().cast<double>();
                 vec_angles[i] = angleBetweenRays(pose_I, camI, pose_J, camJ, featI, featJ);
                 validCommonTracksIds[i] = trackId;
                 ++i;
@@ -1508,13 +1579,17 @@ std::size_t ReconstructionEngine_sequentialSfM::computeCandidateImageScore(Index
     std::size_t score = 0;
     // The number of cells of the pyramid grid represent the score
     // and ensure a proper repartition of features in images.
-    const auto& featsPyramid = _map_featsPyramidPerView.at(viewId);
+    std::vector<std::size_t> observations;
+    observations.reserve(trackIds.size());
+    for (std::size_t trackId : trackIds)
+        observations.push_back(_flatTracks.findObservation(trackId, viewId));
+
     for (std::size_t level = 0; level < _params.pyramidDepth; ++level)
     {
         std::set<std::size_t> featIndexes;  // Set of grid cell indexes in the pyramid
-        for (IndexT trackId : trackIds)
+        for (std::size_t observation : observations)
         {
-            std::size_t pyramidIndex = featsPyramid.at(trackId * _params.pyramidDepth + level);
+            std::size_t pyramidIndex = _tracksPyramid.at(observation * _params.pyramidDepth + level);
             featIndexes.insert(pyramidIndex);
         }
         score += featIndexes.size() * _pyramidWeights[level];
@@ -1534,25 +1609,24 @@ std::size_t ReconstructionEngine_sequentialSfM::computeCandidateImageScore(Index
  * C. Do the resectioning: compute the camera pose.
  * D. Refine the pose of the found camera
  */
-bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, ResectionData& resectionData)
+bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, std::mt19937& randomNumberGenerator, ResectionData& resectionData)
 {
     // A. Compute 2D/3D matches
     // A1. list tracks ids used by the view
-    const aliceVision::track::TrackIdSet& set_tracksIds = _map_tracksPerView.at(viewId);
-
-    // A2. intersects the track list with the reconstructed
-    std::set<std::size_t> reconstructed_trackId;
-    std::transform(_sfmData.getLandmarks().begin(),
-                   _sfmData.getLandmarks().end(),
-                   std::inserter(reconstructed_trackId, reconstructed_trackId.begin()),
-                   stl::RetrieveKey());
-
-    // Get the ids of the already reconstructed tracks
-    std::set_intersection(set_tracksIds.begin(),
-                          set_tracksIds.end(),
-                          reconstructed_trackId.begin(),
-                          reconstructed_trackId.end(),
-                          std::inserter(resectionData.tracksId, resectionData.tracksId.begin()));
+    const std::pair<std::size_t, std::size_t> observations = _flatTracksPerView.getObservations(viewId);
+
+    // A2. Get the ids of the already reconstructed tracks
+    // and the featId associated to these tracks, sorted by track id.
+    // These 2D/3D associations will be used for the resection.
+    const Landmarks& landmarks = _sfmData.getLandmarks();
+    for (std::size_t i = observations.first; i < observations.second; ++i)
+    {
+        const std::size_t trackId = _flatTracksPerView.trackIds[i];
+        if (!landmarks.count(trackId))
+            continue;
+        resectionData.tracksId.insert(resectionData.tracksId.end(), trackId);
+        resectionData.featuresId.emplace_back(_flatTracks.descTypes[trackId], _flatTracksPerView.featureIds[i]);
+    }
 
     if (resectionData.tracksId.empty())
     {
@@ -1561,10 +1635,6 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
         return false;
     }
 
-    // Get back featId associated to a tracksID already reconstructed.
-    // These 2D/3D associations will be used for the resection.
-    getFeatureIdInViewPerTrack(_map_tracks, resectionData.tracksId, viewId, &resectionData.featuresId);
-
     // Localize the image inside the SfM reconstruction
     resectionData.pt2D.resize(2, resectionData.tracksId.size());
     resectionData.pt3D.resize(3, resectionData.tracksId.size());
@@ -1595,7 +1665,7 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
 
     const bool bResection = sfm::SfMLocalizer::Localize(Pair(view_I->getImage().getWidth(), view_I->getImage().getHeight()),
                                                         intrinsics.get(),
-                                                        _randomNumberGenerator,
+                                                        randomNumberGenerator,
                                                         resectionData,
                                                         resectionData.pose,
                                                         _params.localizerEstimator);
@@ -1604,10 +1674,6 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
     {
         using namespace htmlDocument;
         std::ostringstream os;
-        os << "Robust resection of view " << viewId << ": <br>";
-        _htmlDocStream->pushInfo(htmlMarkup("h4", os.str()));
-
-        os.str("");
         os << std::endl
            << "- Image path: " << view_I->getImage().getImagePath() << "<br>"
            << "- Threshold (error max): " << resectionData.error_max << "<br>"
@@ -1616,7 +1682,12 @@ bool ReconstructionEngine_sequentialSfM::computeResection(const IndexT viewId, R
            << "- # points validated by robust estimation: " << resectionData.vec_inliers.size() << "<br>"
            << "- % points validated: " << resectionData.vec_inliers.size() / static_cast<float>(resectionData.featuresId.size()) << "<br>";
 
-        _htmlDocStream->pushInfo(os.str());
+        // the views of a resection batch are resected concurrently
+#pragma omp critical(htmlLog)
+        {
+            _htmlDocStream->pushInfo(htmlMarkup("h4", "Robust resection of view " + std::to_string(viewId) + ": <br>"));
+            _htmlDocStream->pushInfo(os.str());
+        }
     }
 
     if (!bResection)
@@ -1714,39 +1785,34 @@ void ReconstructionEngine_sequentialSfM::getTracksToTriangulate(const std::set<I
     allReconstructedViews.insert(previousReconstructedViews.begin(), previousReconstructedViews.end());
     allReconstructedViews.insert(newReconstructedViews.begin(), newReconstructedViews.end());
 
-    std::set<IndexT> allTracksInNewViews;
-    track::getTracksInImagesFast(newReconstructedViews, _map_tracksPerView, allTracksInNewViews);
-
-    std::set<IndexT>::iterator it;
-#pragma omp parallel private(it)
+    std::vector<std::uint32_t> allTracksInNewViews;
+    for (const IndexT viewId : newReconstructedViews)
     {
-        for (it = allTracksInNewViews.begin(); it != allTracksInNewViews.end(); ++it)
-        {
-#pragma omp single nowait
-            {
-                const std::size_t trackId = *it;
-
-                const track::Track& track = _map_tracks.at(trackId);
+        const std::pair<std::size_t, std::size_t> observations = _flatTracksPerView.getObservations(viewId);
+        allTracksInNewViews.insert(
+          allTracksInNewViews.end(), _flatTracksPerView.trackIds.begin() + observations.first, _flatTracksPerView.trackIds.begin() + observations.second);
+    }
+    std::sort(allTracksInNewViews.begin(), allTracksInNewViews.end());
+    allTracksInNewViews.erase(std::unique(allTracksInNewViews.begin(), allTracksInNewViews.end()), allTracksInNewViews.end());
 
-                std::set<IndexT> allViewsSharingTheTrack;
-                std::transform(track.featPerView.begin(),
-                               track.featPerView.end(),
-                               std::inserter(allViewsSharingTheTrack, allViewsSharingTheTrack.begin()),
-                               stl::RetrieveKey());
+#pragma omp parallel for schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(allTracksInNewViews.size()); ++i)
+    {
+        const std::size_t trackId = allTracksInNewViews[i];
 
-                std::set<IndexT> allReconstructedViewsSharingTheTrack;
-                std::set_intersection(allViewsSharingTheTrack.begin(),
-                                      allViewsSharingTheTrack.end(),
-                                      allReconstructedViews.begin(),
-                                      allReconstructedViews.end(),
-                                      std::inserter(allReconstructedViewsSharingTheTrack, allReconstructedViewsSharingTheTrack.begin()));
+        // the observations of the track are sorted by view id
+        std::set<IndexT> allReconstructedViewsSharingTheTrack;
+        for (std::size_t k = _flatTracks.offsets[trackId]; k < _flatTracks.offsets[trackId + 1]; ++k)
+        {
+            const IndexT viewId = _flatTracks.viewIds[k];
+            if (_flatTracks.isFirstInView(trackId, k) && allReconstructedViews.count(viewId))
+                allReconstructedViewsSharingTheTrack.insert(allReconstructedViewsSharingTheTrack.end(), viewId);
+        }
 
-                if (allReconstructedViewsSharingTheTrack.size() >= _params.minNbObservationsForTriangulation)
-                {
+        if (allReconstructedViewsSharingTheTrack.size() >= _params.minNbObservationsForTriangulation)
+        {
 #pragma omp critical
-                    mapTracksToTriangulate[trackId] = allReconstructedViewsSharingTheTrack;
-                }
-            }
+            mapTracksToTriangulate[trackId] = std::move(allReconstructedViewsSharingTheTrack);
         }
     }
 }
@@ -1764,7 +1830,11 @@ struct ObservationData
     bool isEmpty() const { return cam == nullptr; }
 };
 
-ObservationData getObservationData(const SfMData& scene, feature::FeaturesPerView* featuresPerView, IndexT viewId, const track::Track& track)
+ObservationData getObservationData(const SfMData& scene,
+                                   feature::FeaturesPerView* featuresPerView,
+                                   IndexT viewId,
+                                   feature::EImageDescriberType descType,
+                                   IndexT featureId)
 {
     const View* view = scene.getViews().at(viewId).get();
 
@@ -1780,7 +1850,7 @@ ObservationData getObservationData(const SfMData& scene, feature::FeaturesPerVie
     Pose3 pose = scene.getPose(*view).getTransform();
     Mat34 P = camPinHole->getProjectiveEquivalent(pose);
 
-    const auto& feature = featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId).featureId];
+    const auto& feature = featuresPerView->getFeatures(viewId, descType)[featureId];
     Vec2 x = feature.coords().cast<double>();
     Vec2 xUd = cam->get_ud_pixel(x);  // undistorted 2D point
 
@@ -1804,12 +1874,22 @@ void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData&
     std::vector<IndexT> setTracksId;  // <trackId>
     std::transform(mapTracksToTriangulate.begin(), mapTracksToTriangulate.end(), std::inserter(setTracksId, setTracksId.begin()), stl::RetrieveKey());
 
-#pragma omp parallel for
+    // The random generator of each track is seeded from the engine generator and the track id,
+    // so the triangulation does not depend on the number of threads and on their scheduling.
+    const std::mt19937::result_type seed = _randomNumberGenerator();
+
+    // -- Compute: the scene is only read, the results are stored in the buffers of each thread
+    std::vector<std::vector<std::pair<IndexT, Landmark>>> validLandmarksPerThread(omp_get_max_threads());
+    std::vector<std::vector<IndexT>> invalidTracksPerThread(omp_get_max_threads());
+
+#pragma omp parallel for schedule(dynamic)
     for (int i = 0; i < setTracksId.size(); i++)  // each track (already reconstructed or not)
     {
         const IndexT trackId = setTracksId.at(i);
         bool isValidTrack = true;
-        const track::Track& track = _map_tracks.at(trackId);
+        const feature::EImageDescriberType descType = _flatTracks.descTypes[trackId];
+        // feature of the track in one of its views
+        const auto getFeatureId = [this, trackId](IndexT viewId) { return _flatTracks.featureIds[_flatTracks.findObservation(trackId, viewId)]; };
         std::set<IndexT>& observations = mapTracksToTriangulate.at(trackId);  // all the posed views possessing the track
 
         // The track needs to be seen by a min. number of views to be triangulated
@@ -1831,8 +1911,8 @@ void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData&
             IndexT I = *(observations.begin());
             IndexT J = *(observations.rbegin());
 
-            const auto oi = getObservationData(scene, _featuresPerView, I, track);
-            const auto oj = getObservationData(scene, _featuresPerView, J, track);
+            const auto oi = getObservationData(scene, _featuresPerView, I, descType, getFeatureId(I));
+            const auto oj = getObservationData(scene, _featuresPerView, J, descType, getFeatureId(J));
 
             if (oi.isEmpty() || oj.isEmpty())
             {
@@ -1865,38 +1945,36 @@ void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData&
              * ------------------------------------------------------- */
 
             // -- Prepare:
-            std::vector<Vec2> features;  // undistorted 2D features (one per pose)
-            std::vector<Mat34> Ps;       // projective matrices (one per pose)
+            std::vector<Vec2> features;        // undistorted 2D features (one per pose)
+            std::vector<Mat34> Ps;             // projective matrices (one per pose)
+            std::vector<IndexT> featuresViews;  // view of each feature
+            for (const IndexT& viewId : observations)
             {
-                const track::Track& track = _map_tracks.at(trackId);
+                const auto o = getObservationData(scene, _featuresPerView, viewId, descType, getFeatureId(viewId));
 
-                int i = 0;
-                for (const IndexT& viewId : observations)
+                if (o.isEmpty())
                 {
-                    const auto o = getObservationData(scene, _featuresPerView, viewId, track);
-
-                    if (o.isEmpty())
-                    {
-                        continue;
-                    }
-
-                    features.push_back(o.xUd);
-                    Ps.push_back(o.P);
-                    i++;
+                    continue;
                 }
+
+                features.push_back(o.xUd);
+                Ps.push_back(o.P);
+                featuresViews.push_back(viewId);
             }
 
             // -- Triangulate:
             Vec4 X_homogeneous = Vec4::Zero();
             std::vector<std::size_t> inliersIndex;
 
-            multiview::TriangulateNViewLORANSAC(features, Ps, _randomNumberGenerator, X_homogeneous, &inliersIndex, 8.0);
+            std::seed_seq seedSequence{seed, static_cast<std::mt19937::result_type>(trackId)};
+            std::mt19937 randomNumberGenerator(seedSequence);
+            multiview::TriangulateNViewLORANSAC(features, Ps, randomNumberGenerator, X_homogeneous, &inliersIndex, 8.0);
 
             homogeneousToEuclidean(X_homogeneous, X_euclidean);
 
             // observations = {350, 380, 442} | inliersIndex = [0, 1] | inliers = {350, 380}
             for (const auto& id : inliersIndex)
-                inliers.insert(*std::next(observations.begin(), id));
+                inliers.insert(featuresViews[id]);
 
             // -- Check:
             //  - nb of cameras validing the track
@@ -1907,33 +1985,46 @@ void ReconstructionEngine_sequentialSfM::triangulate_multiViewsLORANSAC(SfMData&
                 isValidTrack = false;
         }
 
-        // -- Add the tringulated point to the scene
+        // -- Keep the tringulated point for the merge
         if (isValidTrack)
         {
             Landmark landmark;
             landmark.X = X_euclidean;
-            landmark.descType = track.descType;
+            landmark.descType = descType;
             for (const IndexT& viewId : inliers)  // add inliers as observations
             {
-                const Vec2 x = _featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId).featureId].coords().cast<double>();
-                const feature::PointFeature& p = _featuresPerView->getFeatures(viewId, track.descType)[track.featPerView.at(viewId).featureId];
+                const IndexT featureId = getFeatureId(viewId);
+                const feature::PointFeature& p = _featuresPerView->getFeatures(viewId, descType)[featureId];
+                const Vec2 x = p.coords().cast<double>();
                 const double scale = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : p.scale();
-                landmark.observations[viewId] = Observation(x, track.featPerView.at(viewId).featureId, scale);
-            }
-#pragma omp critical
-            {
-                scene.getLandmarks()[trackId] = landmark;
+                landmark.observations[viewId] = Observation(x, featureId, scale);
             }
+            validLandmarksPerThread[omp_get_thread_num()].emplace_back(trackId, std::move(landmark));
         }
         else
         {
-#pragma omp critical
-            {
-                if (scene.getLandmarks().find(trackId) != scene.getLandmarks().end())
-                    scene.getLandmarks().erase(trackId);
-            }
+            invalidTracksPerThread[omp_get_thread_num()].push_back(trackId);
         }
     }  // for all shared tracks
+
+    // -- Merge: the landmarks are updated in the order of the track ids, whatever the thread which triangulated them
+    std::vector<std::pair<IndexT, Landmark>> validLandmarks;
+    std::vector<IndexT> invalidTracks;
+    for (std::size_t t = 0; t < validLandmarksPerThread.size(); ++t)
+    {
+        std::move(validLandmarksPerThread[t].begin(), validLandmarksPerThread[t].end(), std::back_inserter(validLandmarks));
+        invalidTracks.insert(invalidTracks.end(), invalidTracksPerThread[t].begin(), invalidTracksPerThread[t].end());
+    }
+    std::sort(validLandmarks.begin(), validLandmarks.end(), [](const std::pair<IndexT, Landmark>& a, const std::pair<IndexT, Landmark>& b) {
+        return a.first < b.first;
+    });
+    std::sort(invalidTracks.begin(), invalidTracks.end());
+
+    Landmarks& landmarks = scene.getLandmarks();
+    for (std::pair<IndexT, Landmark>& validLandmark : validLandmarks)
+        landmarks[validLandmark.first] = std::move(validLandmark.second);
+    for (const IndexT trackId : invalidTracks)
+        landmarks.erase(trackId);
 }
 
 void ReconstructionEngine_sequentialSfM::triangulate_2Views(SfMData& scene,
@@ -1971,9 +2062,8 @@ void ReconstructionEngine_sequentialSfM::triangulate_2Views(SfMData& scene,
             const std::size_t J = std::max((IndexT)indexNew, indexAll);
 
             // Find track correspondences between I and J
-            const std::set<std::size_t> set_viewIndex = {I, J};
-            track::TracksMap map_tracksCommonIJ;
-            track::getCommonTracksInImagesFast(set_viewIndex, _map_tracks, _map_tracksPerView, map_tracksCommonIJ);
+            std::vector<track::CommonTrack> commonTracksIJ;
+            track::getCommonTracksInViews(_flatTracksPerView, I, J, commonTracksIJ);
 
             const View* viewI = scene.getViews().at(I).get();
             const View* viewJ = scene.getViews().at(J).get();
@@ -1998,16 +2088,16 @@ void ReconstructionEngine_sequentialSfM::triangulate_2Views(SfMData& scene,
             const Pose3 poseJ = scene.getPose(*viewJ).getTransform();
 
             std::size_t new_putative_track = 0, new_added_track = 0, extented_track = 0;
-            for (const std::pair<std::size_t, track::Track>& trackIt : map_tracksCommonIJ)
+            for (const track::CommonTrack& commonTrack : commonTracksIJ)
             {
-                const std::size_t trackId = trackIt.first;
-                const track::Track& track = trackIt.second;
+                const std::size_t trackId = commonTrack.trackId;
+                const feature::EImageDescriberType descType = _flatTracks.descTypes[trackId];
 
-                const Vec2 xI = _featuresPerView->getFeatures(I, track.descType)[track.featPerView.at(I).featureId].coords().cast<double>();
-                const Vec2 xJ = _featuresPerView->getFeatures(J, track.descType)[track.featPerView.at(J).featureId].coords().cast<double>();
+                const feature::PointFeature& featI = _featuresPerView->getFeatures(I, descType)[commonTrack.featureIdI];
+                const feature::PointFeature& featJ = _featuresPerView->getFeatures(J, descType)[commonTrack.featureIdJ];
 
-                const feature::PointFeature& featI = _featuresPerView->getFeatures(I, track.descType)[track.featPerView.at(I).featureId];
-                const feature::PointFeature& featJ = _featuresPerView->getFeatures(J, track.descType)[track.featPerView.at(J).featureId];
+                const Vec2 xI = featI.coords().cast<double>();
+                const Vec2 xJ = featJ.coords().cast<double>();
                 // test if the track already exists in 3D
                 bool trackIdExists;
 #pragma omp critical
@@ -2030,7 +2120,7 @@ void ReconstructionEngine_sequentialSfM::triangulate_2Views(SfMData& scene,
                             if (poseI.depth(landmark.X) > 0 && residual.norm() < std::max(4.0, acThreshold))
                             {
                                 const double scale = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : featI.scale();
-                                landmark.observations[I] = Observation(xI, track.featPerView.at(I).featureId, scale);
+                                landmark.observations[I] = Observation(xI, commonTrack.featureIdI, scale);
                                 ++extented_track;
                             }
                         }
@@ -2043,7 +2133,7 @@ void ReconstructionEngine_sequentialSfM::triangulate_2Views(SfMData& scene,
                             if (poseJ.depth(landmark.X) > 0 && residual.norm() < std::max(4.0, acThreshold))
                             {
                                 const double scale = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : featJ.scale();
-                                landmark.observations[J] = Observation(xJ, track.featPerView.at(J).featureId, scale);
+                                landmark.observations[J] = Observation(xJ, commonTrack.featureIdJ, scale);
                                 ++extented_track;
                             }
                         }
@@ -2089,12 +2179,12 @@ void ReconstructionEngine_sequentialSfM::triangulate_2Views(SfMData& scene,
                             // Add a new track
                             Landmark& landmark = scene.getLandmarks()[trackId];
                             landmark.X = X_euclidean;
-                            landmark.descType = track.descType;
+                            landmark.descType = descType;
 
                             const double scaleI = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : featI.scale();
                             const double scaleJ = (_params.featureConstraint == EFeatureConstraint::BASIC) ? 0.0 : featJ.scale();
-                            landmark.observations[I] = Observation(xI, track.featPerView.at(I).featureId, scaleI);
-                            landmark.observations[J] = Observation(xJ, track.featPerView.at(J).featureId, scaleJ);
+                            landmark.observations[I] = Observation(xI, commonTrack.featureIdI, scaleI);
+                            landmark.observations[J] = Observation(xJ, commonTrack.featureIdJ, scaleJ);
 
                             ++new_added_track;
                         }  // critical
@@ -12,6 +12,7 @@
 #include <aliceVision/sfm/pipeline/localization/SfMLocalizer.hpp>
 #include <aliceVision/sfm/pipeline/pairwiseMatchesIO.hpp>
 #include <aliceVision/sfm/pipeline/RigSequence.hpp>
+#include <aliceVision/sfm/pipeline/sequential/NextBestViewScoring.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/feature/FeaturesPerView.hpp>
 #include <aliceVision/track/TracksBuilder.hpp>
@@ -84,10 +85,19 @@ class ReconstructionEngine_sequentialSfM : public ReconstructionEngine
         /// more stable and it's quite cheap because we have few data.
         std::size_t nbFirstUnstableCameras = 30;
 
+        /// Past the first 'nbFirstUnstableCameras' cameras, the Bundle Adjustment
+        /// is only performed once this number of cameras has been added.
+        std::size_t minNbResectionedViewsForBundle = 10;
+
         /// Limit to a maximum number of cameras added to ensure that
         /// we don't add too much data in one step without bundle adjustment.
         std::size_t maxImagesPerGroup = 30;
 
+        /// Maximum number of cameras resected concurrently on the same state of the reconstruction (0 for no limit).
+        /// The cameras of a resection group are resected by batches, each batch is merged in the reconstruction
+        /// before the resection of the next one.
+        std::size_t maxResectionBatchSize = 0;
+
         /// Threshold for the maximum number of outliers allowed at the end of a BA iteration.
         /// If the limit is not met, another BA iteration is performed.
         /// Using a negative value for this threshold will disable BA iterations.
@@ -106,6 +116,20 @@ class ReconstructionEngine_sequentialSfM : public ReconstructionEngine
           sfmDataIO::ESfMData(sfmDataIO::VIEWS | sfmDataIO::EXTRINSICS | sfmDataIO::INTRINSICS | sfmDataIO::STRUCTURE | sfmDataIO::OBSERVATIONS);
     };
 
+    /**
+     * @brief Statistics of a batch of views resected concurrently
+     */
+    struct ResectionBatchStats
+    {
+        IndexT resectionId = UndefinedIndexT;
+        std::size_t nbViews = 0;
+        std::size_t nbResectedViews = 0;
+        /// duration of the concurrent resections (in seconds)
+        double computeTime = 0.0;
+        /// duration of the merge in the reconstruction (in seconds)
+        double mergeTime = 0.0;
+    };
+
   public:
     ReconstructionEngine_sequentialSfM(const sfmData::SfMData& sfmData,
                                        const Params& params,
@@ -116,6 +140,11 @@ class ReconstructionEngine_sequentialSfM : public ReconstructionEngine
 
     void setMatches(matching::PairwiseMatches* pairwiseMatches) { _pairwiseMatches = pairwiseMatches; }
 
+    /**
+     * @return the statistics of all the resection batches, in the order of the resections
+     */
+    const std::vector<ResectionBatchStats>& getResectionBatchesStats() const { return _resectionBatchesStats; }
+
     /**
      * @brief Process the entire incremental reconstruction
      * @return true if done
@@ -194,6 +223,12 @@ class ReconstructionEngine_sequentialSfM : public ReconstructionEngine
      */
     void calibrateRigs(std::set<IndexT>& updatedViews);
 
+    /**
+     * @brief Update the next best view scores with the landmarks added or removed since the last update.
+     * Must be called before findConnectedViews or findNextBestViews when the landmarks have changed.
+     */
+    void updateNextBestViewScoring();
+
     /**
      * @brief Return all the images containing matches with already reconstructed 3D points.
      * The images are sorted by a score based on the number of features id shared with
@@ -264,11 +299,22 @@ class ReconstructionEngine_sequentialSfM : public ReconstructionEngine
 
     /**
      * @brief Apply the resection on a single view.
+     * @note The reconstruction is only read, so several views can be resected concurrently.
      * @param[in] viewIndex: image index to add to the reconstruction.
+     * @param[in,out] randomNumberGenerator: random generator of the robust estimation.
      * @param[out] resectionData: contains the result (P) and all the data used during the resection.
      * @return false if resection failed
      */
-    bool computeResection(const IndexT viewIndex, ResectionData& resectionData);
+    bool computeResection(const IndexT viewIndex, std::mt19937& randomNumberGenerator, ResectionData& resectionData);
+
+    /**
+     * @brief Select the next batch of views that can be resected concurrently.
+     * The views of a batch do not share a pose, a rig or an intrinsic estimated for the first time,
+     * the other views are kept for the next batches.
+     * @param[in,out] remainingViewIds: the views to resect, sorted by priority, without the selected views at the end.
+     * @param[out] batchViewIds: the selected views, sorted by priority.
+     */
+    void selectResectionBatch(std::vector<IndexT>& remainingViewIds, std::vector<IndexT>& batchViewIds) const;
 
     /**
      * @brief Update the global scene with the new found camera pose, intrinsic (if not defined) and
@@ -291,6 +337,8 @@ class ReconstructionEngine_sequentialSfM : public ReconstructionEngine
     /**
      * @brief Triangulate new possible 2D tracks
      * List tracks that share content with this view and run a multiview triangulation on them, using the Lo-RANSAC algorithm.
+     * The tracks are triangulated in parallel and the landmarks are updated afterwards in the order of the track ids,
+     * so the result does not depend on the number of threads.
      * @param[in,out] scene All the data about the 3D reconstruction.
      * @param[in] previousReconstructedViews The list of the old reconstructed views (views index).
      * @param[in] newReconstructedViews The list of the new reconstructed views (views index).
@@ -355,6 +403,8 @@ class ReconstructionEngine_sequentialSfM : public ReconstructionEngine
 
     /// Current resection ID
     IndexT _resectionId;
+    /// Statistics of the resection batches
+    std::vector<ResectionBatchStats> _resectionBatchesStats;
 
     // Data providers
 
@@ -366,15 +416,19 @@ class ReconstructionEngine_sequentialSfM : public ReconstructionEngine
     /// internal cache of precomputed values for the weighting of the pyramid levels
     std::vector<int> _pyramidWeights;
     int _pyramidThreshold;
+    /// next best view scores, updated with the landmarks changes by updateNextBestViewScoring
+    NextBestViewScoring _nextBestViewScoring;
 
     // Temporary data
 
     /// Putative landmark tracks (visibility per potential 3D point)
-    track::TracksMap _map_tracks;
-    /// Putative tracks per view
+    track::FlatTracks _flatTracks;
+    /// Putative tracks per view (reverse index of the tracks)
+    track::FlatTracksPerView _flatTracksPerView;
+    /// Putative tracks per view, with an entry for each view (for the local BA graph and the rigs)
     track::TracksPerView _map_tracksPerView;
-    /// Precomputed pyramid index for each trackId of each viewId.
-    track::TracksPyramidPerView _map_featsPyramidPerView;
+    /// Precomputed pyramid cell of each observation of the tracks, for each level: [observation * pyramidDepth + level]
+    std::vector<std::uint32_t> _tracksPyramid;
     /// Per camera confidence (A contrario estimated threshold error)
     HashMap<IndexT, double> _map_ACThreshold;
 
@@ -0,0 +1,141 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/pipeline/sequential/NextBestViewScoring.hpp>
+#include <aliceVision/track/tracksUtils.hpp>
+
+#include <random>
+#include <set>
+#include <vector>
+
+#define BOOST_TEST_MODULE nextBestViewScoring
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::sfm;
+
+namespace {
+
+const std::size_t pyramidBase = 2;
+const std::size_t pyramidDepth = 3;
+const std::vector<int> pyramidWeights = {4, 2, 1};
+
+/**
+ * @brief Score of a view computed from scratch, as the next best view selection of the sequential SfM.
+ */
+std::size_t computeScore(IndexT viewId,
+                         const sfmData::Landmarks& landmarks,
+                         const track::FlatTracks& tracks,
+                         const std::vector<std::uint32_t>& tracksPyramid,
+                         std::size_t& nbReconstructedTracks)
+{
+    std::vector<std::set<std::size_t>> cellsPerLevel(pyramidDepth);
+    nbReconstructedTracks = 0;
+    for (const auto& landmark : landmarks)
+    {
+        const std::size_t observation = tracks.findObservation(landmark.first, viewId);
+        if (observation == UndefinedIndexT)
+            continue;
+        ++nbReconstructedTracks;
+        for (std::size_t level = 0; level < pyramidDepth; ++level)
+            cellsPerLevel[level].insert(tracksPyramid.at(observation * pyramidDepth + level));
+    }
+
+    std::size_t score = 0;
+    for (std::size_t level = 0; level < pyramidDepth; ++level)
+        score += cellsPerLevel[level].size() * pyramidWeights[level];
+    return score;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(NextBestViewScoring_incrementalUpdates)
+{
+    const IndexT nbViews = 20;
+    const std::size_t nbTracks = 2000;
+    std::mt19937 randomNumberGenerator(42);
+
+    // random tracks, with random cells in each pyramid level
+    track::TracksMap tracksMap;
+    std::uniform_int_distribution<IndexT> viewDistribution(0, nbViews - 1);
+    for (std::size_t trackId = 0; trackId < nbTracks; ++trackId)
+    {
+        track::Track& track = tracksMap[trackId];
+        const std::size_t trackLength = 2 + trackId % 5;
+        while (track.featPerView.size() < trackLength)
+            track.featPerView[viewDistribution(randomNumberGenerator)].featureId = trackId;
+    }
+    track::FlatTracks tracks;
+    track::convertToFlatTracks(tracksMap, tracks);
+
+    std::vector<std::uint32_t> tracksPyramid(tracks.nbObservations() * pyramidDepth);
+    for (std::size_t observation = 0; observation < tracks.nbObservations(); ++observation)
+    {
+        std::size_t start = 0;
+        std::size_t width = 1;
+        for (std::size_t level = 0; level < pyramidDepth; ++level)
+        {
+            width *= pyramidBase;
+            std::uniform_int_distribution<std::size_t> cellDistribution(0, width * width - 1);
+            tracksPyramid[observation * pyramidDepth + level] = start + cellDistribution(randomNumberGenerator);
+            start += width * width;
+        }
+    }
+
+    NextBestViewScoring scoring(pyramidBase, pyramidDepth, pyramidWeights);
+    sfmData::Landmarks landmarks;
+    std::uniform_int_distribution<std::size_t> trackDistribution(0, nbTracks - 1);
+
+    for (int iteration = 0; iteration < 10; ++iteration)
+    {
+        // triangulation of new tracks and removal of some outliers
+        for (int i = 0; i < 200; ++i)
+            landmarks[trackDistribution(randomNumberGenerator)];
+        for (int i = 0; i < 50; ++i)
+            landmarks.erase(trackDistribution(randomNumberGenerator));
+
+        scoring.update(landmarks, tracks, tracksPyramid);
+        BOOST_CHECK_EQUAL(scoring.getNbReconstructedTracks(), landmarks.size());
+
+        for (IndexT viewId = 0; viewId < nbViews; ++viewId)
+        {
+            std::size_t nbReconstructedTracks = 0;
+            const std::size_t score = computeScore(viewId, landmarks, tracks, tracksPyramid, nbReconstructedTracks);
+            BOOST_CHECK_EQUAL(scoring.getNbReconstructedTracks(viewId), nbReconstructedTracks);
+            BOOST_CHECK_EQUAL(scoring.getScore(viewId), score);
+        }
+    }
+
+    // removal of all the landmarks
+    landmarks.clear();
+    scoring.update(landmarks, tracks, tracksPyramid);
+    BOOST_CHECK_EQUAL(scoring.getNbReconstructedTracks(), 0);
+    for (IndexT viewId = 0; viewId < nbViews; ++viewId)
+        BOOST_CHECK_EQUAL(scoring.getScore(viewId), 0);
+}
+
+BOOST_AUTO_TEST_CASE(NextBestViewScoring_landmarksWithoutTrack)
+{
+    // one track in the views 0 and 1
+    track::FlatTracks tracks;
+    tracks.offsets = {0, 2};
+    tracks.viewIds = {0, 1};
+    tracks.featureIds = {0, 0};
+    tracks.descTypes = {feature::EImageDescriberType::UNKNOWN};
+    const std::vector<std::uint32_t> tracksPyramid = {0, 4, 20, 0, 4, 20};
+
+    NextBestViewScoring scoring(pyramidBase, pyramidDepth, pyramidWeights);
+    sfmData::Landmarks landmarks;
+    landmarks[0];
+    landmarks[10];
+    scoring.update(landmarks, tracks, tracksPyramid);
+
+    BOOST_CHECK_EQUAL(scoring.getNbReconstructedTracks(), 1);
+    BOOST_CHECK_EQUAL(scoring.getNbReconstructedTracks(0), 1);
+    BOOST_CHECK_EQUAL(scoring.getScore(1), 4 + 2 + 1);
+    BOOST_CHECK_EQUAL(scoring.getScore(2), 0);
+}
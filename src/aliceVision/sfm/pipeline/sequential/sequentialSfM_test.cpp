@@ -9,7 +9,9 @@
 #include <aliceVision/sfm/utils/statistics.hpp>
 #include <aliceVision/sfm/utils/syntheticScene.hpp>
 #include <aliceVision/sfm/sfm.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <iostream>
@@ -180,3 +182,112 @@ BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Known_Rig)
     BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getPoses().size(), nbPoses);
     BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getLandmarks().size(), nbPoints);
 }
+
+// Test that the multi-view triangulation gives the same landmarks whatever the number of threads
+BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Triangulation_Threads)
+{
+    const int nviews = 6;
+    const int npoints = 256;
+    const NViewDatasetConfigurator config;
+    const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+    // Translate the input dataset to a SfMData scene
+    const SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA);
+
+    // Keep the poses and remove the structure
+    SfMData sfmData2 = sfmData;
+    sfmData2.getLandmarks().clear();
+
+    std::set<IndexT> reconstructedViews;
+    for (const auto& viewIt : sfmData2.getViews())
+        reconstructedViews.insert(viewIt.first);
+
+    // Add a noise in 2D observations to have outliers in the multi-view triangulation
+    std::normal_distribution<double> distribution(0.0, 2.0);
+
+    feature::FeaturesPerView featuresPerView;
+    generateSyntheticFeatures(featuresPerView, feature::EImageDescriberType::UNKNOWN, sfmData, distribution);
+
+    matching::PairwiseMatches pairwiseMatches;
+    generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+    const auto triangulate = [&](int nbThreads) {
+        omp_set_num_threads(nbThreads);
+
+        ReconstructionEngine_sequentialSfM::Params sfmParams;
+        ReconstructionEngine_sequentialSfM sfmEngine(sfmData2, sfmParams, "./", "./Reconstruction_Report.html");
+        sfmEngine.setFeatures(&featuresPerView);
+        sfmEngine.setMatches(&pairwiseMatches);
+        sfmEngine.initRandomSeed(42);
+
+        sfmEngine.fuseMatchesIntoTracks();
+        sfmEngine.triangulate({}, reconstructedViews);
+        return sfmEngine.getSfMData().getLandmarks();
+    };
+
+    const int maxThreads = omp_get_max_threads();
+    const Landmarks serialLandmarks = triangulate(1);
+    const Landmarks parallelLandmarks = triangulate(std::max(4, maxThreads));
+    omp_set_num_threads(maxThreads);
+
+    BOOST_CHECK(!serialLandmarks.empty());
+    BOOST_CHECK_EQUAL(serialLandmarks.size(), parallelLandmarks.size());
+    for (const auto& landmarkIt : serialLandmarks)
+    {
+        const auto parallelIt = parallelLandmarks.find(landmarkIt.first);
+        BOOST_REQUIRE(parallelIt != parallelLandmarks.end());
+        BOOST_CHECK(landmarkIt.second.X == parallelIt->second.X);
+        BOOST_CHECK_EQUAL(landmarkIt.second.observations.size(), parallelIt->second.observations.size());
+        for (const auto& observationIt : landmarkIt.second.observations)
+            BOOST_CHECK(parallelIt->second.observations.count(observationIt.first));
+    }
+}
+
+// Test the resection of the cameras by batches of limited size
+BOOST_AUTO_TEST_CASE(SEQUENTIAL_SFM_Resection_Batches)
+{
+    const int nviews = 12;
+    const int npoints = 128;
+    const NViewDatasetConfigurator config;
+    const NViewDataSet d = NRealisticCamerasRing(nviews, npoints, config);
+
+    // Translate the input dataset to a SfMData scene
+    const SfMData sfmData = getInputScene(d, config, EINTRINSIC::PINHOLE_CAMERA);
+
+    feature::FeaturesPerView featuresPerView;
+    std::normal_distribution<double> distribution(0.0, 0.5);
+    generateSyntheticFeatures(featuresPerView, feature::EImageDescriberType::UNKNOWN, sfmData, distribution);
+
+    matching::PairwiseMatches pairwiseMatches;
+    generateSyntheticMatches(pairwiseMatches, sfmData, feature::EImageDescriberType::UNKNOWN);
+
+    for (const std::size_t maxResectionBatchSize : {1, 0})
+    {
+        SfMData sfmData2 = sfmData;
+        sfmData2.getPoses().clear();
+        sfmData2.getLandmarks().clear();
+
+        ReconstructionEngine_sequentialSfM::Params sfmParams;
+        sfmParams.userInitialImagePair = Pair(0, 1);
+        sfmParams.lockAllIntrinsics = true;
+        sfmParams.maxResectionBatchSize = maxResectionBatchSize;
+
+        ReconstructionEngine_sequentialSfM sfmEngine(sfmData2, sfmParams, "./", "./Reconstruction_Report.html");
+        sfmEngine.setFeatures(&featuresPerView);
+        sfmEngine.setMatches(&pairwiseMatches);
+
+        BOOST_CHECK(sfmEngine.process());
+        BOOST_CHECK_LT(RMSE(sfmEngine.getSfMData()), 0.5);
+        BOOST_CHECK_EQUAL(sfmEngine.getSfMData().getPoses().size(), nviews);
+
+        // all the cameras but the initial pair are resected, some of them may be resected again after their removal by the BA
+        std::size_t nbResectedViews = 0;
+        for (const auto& batchStats : sfmEngine.getResectionBatchesStats())
+        {
+            if (maxResectionBatchSize > 0)
+                BOOST_CHECK_LE(batchStats.nbViews, maxResectionBatchSize);
+            nbResectedViews += batchStats.nbResectedViews;
+        }
+        BOOST_CHECK_GE(nbResectedViews, nviews - 2);
+    }
+}
@@ -81,85 +81,128 @@ void StructureEstimationFromKnownPoses::match(const SfMData& sfmData,
     {
 #pragma omp single nowait
         {
-            // --
-            // Perform GUIDED MATCHING
-            // --
-            // Use the computed model to check valid correspondences
-            // - by considering geometric error and descriptor distance ratio.
-
-            const View* viewL = sfmData.getViews().at(it->first).get();
-            const Pose3 poseL = sfmData.getPose(*viewL).getTransform();
-            const Intrinsics::const_iterator iterIntrinsicL = sfmData.getIntrinsics().find(viewL->getIntrinsicId());
-            const View* viewR = sfmData.getViews().at(it->second).get();
-            const Pose3 poseR = sfmData.getPose(*viewR).getTransform();
-            const Intrinsics::const_iterator iterIntrinsicR = sfmData.getIntrinsics().find(viewR->getIntrinsicId());
-
-            if (sfmData.getIntrinsics().count(viewL->getIntrinsicId()) != 0 || sfmData.getIntrinsics().count(viewR->getIntrinsicId()) != 0)
+            matching::MatchesPerDescType allImagePairMatches;
+            if (matchPair(sfmData, *it, regionsPerView, geometricErrorMax, allImagePairMatches))
             {
-                std::shared_ptr<IntrinsicBase> camL = iterIntrinsicL->second;
-                std::shared_ptr<camera::Pinhole> pinHoleCamL = std::dynamic_pointer_cast<camera::Pinhole>(camL);
-                if (!pinHoleCamL)
+#pragma omp critical
                 {
-                    ALICEVISION_LOG_ERROR("Camera is not pinhole in match");
+                    ++progressDisplay;
+                    _putativeMatches[*it] = allImagePairMatches;
                 }
+            }
+        }
+    }
+}
 
-                std::shared_ptr<IntrinsicBase> camR = iterIntrinsicR->second;
-                std::shared_ptr<camera::Pinhole> pinHoleCamR = std::dynamic_pointer_cast<camera::Pinhole>(camR);
-                if (!pinHoleCamL)
-                {
-                    ALICEVISION_LOG_ERROR("Camera is not pinhole in match");
-                }
+/// Use guided matching to find corresponding 2-view correspondences, with the regions requested by windows of pairs
+void StructureEstimationFromKnownPoses::match(const SfMData& sfmData,
+                                              const PairSet& pairs,
+                                              feature::RegionsProvider& regionsProvider,
+                                              std::size_t maxViewsPerWindow,
+                                              double geometricErrorMax)
+{
+    auto progressDisplay = system::createConsoleProgressDisplay(pairs.size(), std::cout, "Compute pairwise fundamental guided matching:\n");
 
-                const Mat34 P_L = pinHoleCamL->getProjectiveEquivalent(poseL);
-                const Mat34 P_R = pinHoleCamR->getProjectiveEquivalent(poseR);
+    // the pairs are sorted, so consecutive pairs share their first view
+    const PairVec pairsVec(pairs.begin(), pairs.end());
+
+    feature::forEachPairsWindow(
+      regionsProvider, pairsVec, maxViewsPerWindow, [&](const feature::RegionsPerView& regionsPerView, std::size_t begin, std::size_t end) {
+#pragma omp parallel for schedule(dynamic)
+          for (int i = static_cast<int>(begin); i < static_cast<int>(end); ++i)
+          {
+              const Pair& pair = pairsVec[i];
+              matching::MatchesPerDescType allImagePairMatches;
+              if (matchPair(sfmData, pair, regionsPerView, geometricErrorMax, allImagePairMatches))
+              {
+#pragma omp critical
+                  {
+                      ++progressDisplay;
+                      _putativeMatches[pair] = allImagePairMatches;
+                  }
+              }
+          }
+      });
+}
 
-                const Mat3 F_lr = F_from_P(P_L, P_R);
-                std::vector<feature::EImageDescriberType> commonDescTypes = regionsPerView.getCommonDescTypes(*it);
+bool StructureEstimationFromKnownPoses::matchPair(const SfMData& sfmData,
+                                                  const Pair& pair,
+                                                  const feature::RegionsPerView& regionsPerView,
+                                                  double geometricErrorMax,
+                                                  matching::MatchesPerDescType& allImagePairMatches) const
+{
+    // --
+    // Perform GUIDED MATCHING
+    // --
+    // Use the computed model to check valid correspondences
+    // - by considering geometric error and descriptor distance ratio.
+
+    const View* viewL = sfmData.getViews().at(pair.first).get();
+    const Pose3 poseL = sfmData.getPose(*viewL).getTransform();
+    const Intrinsics::const_iterator iterIntrinsicL = sfmData.getIntrinsics().find(viewL->getIntrinsicId());
+    const View* viewR = sfmData.getViews().at(pair.second).get();
+    const Pose3 poseR = sfmData.getPose(*viewR).getTransform();
+    const Intrinsics::const_iterator iterIntrinsicR = sfmData.getIntrinsics().find(viewR->getIntrinsicId());
+
+    if (sfmData.getIntrinsics().count(viewL->getIntrinsicId()) != 0 || sfmData.getIntrinsics().count(viewR->getIntrinsicId()) != 0)
+    {
+        std::shared_ptr<IntrinsicBase> camL = iterIntrinsicL->second;
+        std::shared_ptr<camera::Pinhole> pinHoleCamL = std::dynamic_pointer_cast<camera::Pinhole>(camL);
+        if (!pinHoleCamL)
+        {
+            ALICEVISION_LOG_ERROR("Camera is not pinhole in match");
+        }
 
-                matching::MatchesPerDescType allImagePairMatches;
-                for (feature::EImageDescriberType descType : commonDescTypes)
-                {
-                    std::vector<matching::IndMatch> matches;
+        std::shared_ptr<IntrinsicBase> camR = iterIntrinsicR->second;
+        std::shared_ptr<camera::Pinhole> pinHoleCamR = std::dynamic_pointer_cast<camera::Pinhole>(camR);
+        if (!pinHoleCamL)
+        {
+            ALICEVISION_LOG_ERROR("Camera is not pinhole in match");
+        }
+
+        const Mat34 P_L = pinHoleCamL->getProjectiveEquivalent(poseL);
+        const Mat34 P_R = pinHoleCamR->getProjectiveEquivalent(poseR);
+
+        const Mat3 F_lr = F_from_P(P_L, P_R);
+        std::vector<feature::EImageDescriberType> commonDescTypes = regionsPerView.getCommonDescTypes(pair);
+
+        for (feature::EImageDescriberType descType : commonDescTypes)
+        {
+            std::vector<matching::IndMatch> matches;
 #ifdef ALICEVISION_EXHAUSTIVE_MATCHING
-                    matching::guidedMatching<Mat3, multiview::relativePose::FundamentalEpipolarDistanceError>(
-                      F_lr,
-                      iterIntrinsicL->second.get(),
-                      regionsPerView.getRegions(it->first, descType),
-                      iterIntrinsicR->second.get(),
-                      regionsPerView.getRegions(it->second, descType),
-                      // descType,
-                      Square(thresholdF),
-                      Square(0.8),
-                      matches);
+            matching::guidedMatching<Mat3, multiview::relativePose::FundamentalEpipolarDistanceError>(
+              F_lr,
+              iterIntrinsicL->second.get(),
+              regionsPerView.getRegions(pair.first, descType),
+              iterIntrinsicR->second.get(),
+              regionsPerView.getRegions(pair.second, descType),
+              // descType,
+              Square(thresholdF),
+              Square(0.8),
+              matches);
 #else
-                    const Vec3 epipole2 = epipole_from_P(P_R, poseL);
-
-                    // const feature::Regions& regions = regionsPerView.getRegions(it->first);
-                    matching::guidedMatchingFundamentalFast<multiview::relativePose::FundamentalEpipolarDistanceError>(
-                      F_lr,
-                      epipole2,
-                      iterIntrinsicL->second.get(),
-                      regionsPerView.getRegions(it->first, descType),
-                      iterIntrinsicR->second.get(),
-                      regionsPerView.getRegions(it->second, descType),
-                      iterIntrinsicR->second->w(),
-                      iterIntrinsicR->second->h(),
-                      // descType,
-                      Square(geometricErrorMax),
-                      Square(0.8),
-                      matches);
+            const Vec3 epipole2 = epipole_from_P(P_R, poseL);
+
+            // const feature::Regions& regions = regionsPerView.getRegions(pair.first);
+            matching::guidedMatchingFundamentalFast<multiview::relativePose::FundamentalEpipolarDistanceError>(
+              F_lr,
+              epipole2,
+              iterIntrinsicL->second.get(),
+              regionsPerView.getRegions(pair.first, descType),
+              iterIntrinsicR->second.get(),
+              regionsPerView.getRegions(pair.second, descType),
+              iterIntrinsicR->second->w(),
+              iterIntrinsicR->second->h(),
+              // descType,
+              Square(geometricErrorMax),
+              Square(0.8),
+              matches);
 #endif
-                    allImagePairMatches[descType] = matches;
-                }
-
-#pragma omp critical
-                {
-                    ++progressDisplay;
-                    _putativeMatches[*it] = allImagePairMatches;
-                }
-            }
+            allImagePairMatches[descType] = matches;
         }
+        return true;
     }
+    return false;
 }
 
 /// Filter inconsistent correspondences by using 3-view correspondences on view triplets
@@ -9,6 +9,7 @@
 
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/feature/RegionsPerView.hpp>
+#include <aliceVision/feature/RegionsProvider.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 
 namespace aliceVision {
@@ -28,6 +29,14 @@ class StructureEstimationFromKnownPoses
     /// Use guided matching to find corresponding 2-view correspondences
     void match(const sfmData::SfMData& sfmData, const PairSet& pairs, const feature::RegionsPerView& regionsPerView, double geometricErrorMax);
 
+    /// Use guided matching to find corresponding 2-view correspondences,
+    /// with the regions requested from the provider by windows of at most maxViewsPerWindow views
+    void match(const sfmData::SfMData& sfmData,
+               const PairSet& pairs,
+               feature::RegionsProvider& regionsProvider,
+               std::size_t maxViewsPerWindow,
+               double geometricErrorMax);
+
     /// Filter inconsistent correspondences by using 3-view correspondences on view triplets
     void filter(const sfmData::SfMData& sfmData, const PairSet& pairs, const feature::RegionsPerView& regionsPerView);
 
@@ -37,6 +46,13 @@ class StructureEstimationFromKnownPoses
     const matching::PairwiseMatches& getPutativesMatches() const { return _putativeMatches; }
 
   private:
+    /// Guided matching of one pair, return false if the pair cannot be matched
+    bool matchPair(const sfmData::SfMData& sfmData,
+                   const Pair& pair,
+                   const feature::RegionsPerView& regionsPerView,
+                   double geometricErrorMax,
+                   matching::MatchesPerDescType& allImagePairMatches) const;
+
     //--
     // DATA (temporary)
     //--
@@ -0,0 +1,879 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include "binaryIO.hpp"
+#include <aliceVision/sfmDataIO/jsonIO.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace fs = boost::filesystem;
+namespace bip = boost::interprocess;
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+namespace {
+
+constexpr char binarySfMDataMagic[8] = {'A', 'V', 'S', 'F', 'M', 'B', '\0', '\0'};
+constexpr std::uint32_t binarySfMDataVersion = 1;
+
+/// blocks of a binary SfMData file
+enum class EBinaryBlock : std::uint32_t
+{
+    METADATA = 0,             //< file version and folders (JSON)
+    VIEWS = 1,                //< views (JSON)
+    ANCESTORS = 2,            //< ancestors (JSON)
+    INTRINSICS = 3,           //< intrinsics (JSON)
+    POSES = 4,                //< poses (columns)
+    RIGS = 5,                 //< rigs (JSON)
+    LANDMARKS = 6,            //< landmark ids, positions, descTypes and colors (columns)
+    OBSERVATIONS = 7,         //< observation view ids indexed by landmark (columns)
+    OBSERVATION_FEATURES = 8  //< observation feature ids, positions and scales (columns)
+};
+
+struct BinarySfMDataHeader
+{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t nbBlocks;
+    std::uint64_t tableOffset;
+};
+
+/// storedSize != rawSize: the block is compressed
+struct BinarySfMDataBlockEntry
+{
+    std::uint32_t type;
+    std::uint32_t reserved;
+    std::uint64_t offset;
+    std::uint64_t storedSize;
+    std::uint64_t rawSize;
+};
+
+static_assert(sizeof(BinarySfMDataHeader) == 24, "Invalid binary SfMData header size.");
+static_assert(sizeof(BinarySfMDataBlockEntry) == 32, "Invalid binary SfMData block entry size.");
+
+/// columns are 8-bytes aligned in the blocks
+constexpr std::size_t columnAlignment = 8;
+
+inline std::size_t alignedSize(std::size_t size) { return (size + columnAlignment - 1) / columnAlignment * columnAlignment; }
+
+/**
+ * @brief Write the columns of a block.
+ */
+class ColumnsWriter
+{
+  public:
+    template<typename T>
+    void add(const T* values, std::size_t nbValues)
+    {
+        const std::size_t begin = _data.size();
+        _data.resize(begin + alignedSize(nbValues * sizeof(T)), 0);
+        if (nbValues > 0)
+            std::memcpy(_data.data() + begin, values, nbValues * sizeof(T));
+    }
+
+    template<typename T>
+    void add(const std::vector<T>& values)
+    {
+        add(values.data(), values.size());
+    }
+
+    template<typename T>
+    void addValue(const T& value)
+    {
+        add(&value, 1);
+    }
+
+    const std::vector<char>& data() const { return _data; }
+
+  private:
+    std::vector<char> _data;
+};
+
+/**
+ * @brief Read the columns of a block, values are read with readAt (columns may not be aligned in memory).
+ */
+class ColumnsReader
+{
+  public:
+    ColumnsReader(const char* data, std::size_t size)
+      : _data(data),
+        _size(size)
+    {}
+
+    template<typename T>
+    const char* column(std::size_t nbValues)
+    {
+        if (nbValues > (_size - _position) / sizeof(T))
+            throw std::runtime_error("Truncated block in the binary SfMData file.");
+        const char* column = _data + _position;
+        _position = std::min(_size, _position + alignedSize(nbValues * sizeof(T)));
+        return column;
+    }
+
+    template<typename T>
+    T value()
+    {
+        T value;
+        std::memcpy(&value, column<T>(1), sizeof(T));
+        return value;
+    }
+
+  private:
+    const char* _data;
+    std::size_t _size;
+    std::size_t _position = 0;
+};
+
+template<typename T>
+inline T readAt(const char* column, std::size_t index)
+{
+    T value;
+    std::memcpy(&value, column + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+/// columns of the landmarks and their observations
+struct LandmarksColumns
+{
+    std::size_t nbLandmarks = 0;
+    const char* ids = nullptr;
+    const char* X = nullptr;
+    const char* descTypes = nullptr;
+    const char* colors = nullptr;
+
+    // observations, indexed by landmark
+    std::size_t nbObservations = 0;
+    const char* offsets = nullptr;
+    const char* viewIds = nullptr;
+
+    // observation features
+    const char* featureIds = nullptr;
+    const char* x = nullptr;
+    const char* scales = nullptr;
+};
+
+void readLandmark(const LandmarksColumns& columns, std::size_t index, sfmData::Landmark& landmark, ESfMData partFlag)
+{
+    const bool loadFeatures = ((partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES) && columns.featureIds != nullptr;
+    const bool loadObservations = (loadFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS)) && columns.viewIds != nullptr;
+
+    for (int i = 0; i < 3; ++i)
+        landmark.X(i) = readAt<double>(columns.X, 3 * index + i);
+    landmark.descType = static_cast<feature::EImageDescriberType>(readAt<std::uint32_t>(columns.descTypes, index));
+    landmark.rgb = image::RGBColor(readAt<std::uint8_t>(columns.colors, 3 * index),
+                                   readAt<std::uint8_t>(columns.colors, 3 * index + 1),
+                                   readAt<std::uint8_t>(columns.colors, 3 * index + 2));
+
+    landmark.observations.clear();
+    if (!loadObservations)
+        return;
+
+    const std::uint64_t begin = readAt<std::uint64_t>(columns.offsets, index);
+    const std::uint64_t end = readAt<std::uint64_t>(columns.offsets, index + 1);
+    if (begin > end || end > columns.nbObservations)
+        throw std::runtime_error("Invalid observations in the binary SfMData file.");
+
+    landmark.observations.reserve(end - begin);
+    for (std::uint64_t k = begin; k < end; ++k)
+    {
+        sfmData::Observation observation;
+        if (loadFeatures)
+        {
+            observation.id_feat = readAt<std::uint32_t>(columns.featureIds, k);
+            observation.x(0) = readAt<double>(columns.x, 2 * k);
+            observation.x(1) = readAt<double>(columns.x, 2 * k + 1);
+            observation.scale = readAt<double>(columns.scales, k);
+        }
+        // observations are sorted by view
+        landmark.observations.emplace_hint(landmark.observations.end(), readAt<std::uint32_t>(columns.viewIds, k), observation);
+    }
+}
+
+std::string treeToString(const bpt::ptree& tree)
+{
+    std::ostringstream stream;
+    bpt::write_json(stream, tree, false);
+    return stream.str();
+}
+
+bpt::ptree stringToTree(const char* data, std::size_t size)
+{
+    std::istringstream stream(std::string(data, size));
+    bpt::ptree tree;
+    bpt::read_json(stream, tree);
+    return tree;
+}
+
+/**
+ * @brief Write a block (8-bytes aligned in the file) and add it to the block table.
+ */
+void writeBlock(std::ofstream& stream,
+                EBinaryBlock type,
+                const char* data,
+                std::size_t size,
+                bool compress,
+                std::uint64_t& offset,
+                std::vector<BinarySfMDataBlockEntry>& table)
+{
+    static const char padding[columnAlignment] = {0};
+    const std::size_t paddingSize = alignedSize(offset) - offset;
+    stream.write(padding, paddingSize);
+    offset += paddingSize;
+
+    BinarySfMDataBlockEntry entry;
+    entry.type = static_cast<std::uint32_t>(type);
+    entry.reserved = 0;
+    entry.offset = offset;
+    entry.rawSize = size;
+    entry.storedSize = size;
+
+    std::vector<Bytef> compressed;
+    if (compress && size > 0 && size <= std::numeric_limits<uLong>::max())
+    {
+        uLongf compressedSize = compressBound(uLong(size));
+        compressed.resize(compressedSize);
+        // keep the raw block if compression does not reduce the size
+        if (compress2(compressed.data(), &compressedSize, reinterpret_cast<const Bytef*>(data), uLong(size), Z_DEFAULT_COMPRESSION) == Z_OK &&
+            compressedSize < size)
+        {
+            data = reinterpret_cast<const char*>(compressed.data());
+            entry.storedSize = compressedSize;
+        }
+    }
+
+    stream.write(data, std::streamsize(entry.storedSize));
+    offset += entry.storedSize;
+    table.push_back(entry);
+}
+
+void writeBlock(std::ofstream& stream,
+                EBinaryBlock type,
+                const std::string& data,
+                bool compress,
+                std::uint64_t& offset,
+                std::vector<BinarySfMDataBlockEntry>& table)
+{
+    writeBlock(stream, type, data.data(), data.size(), compress, offset, table);
+}
+
+void writeBlock(std::ofstream& stream,
+                EBinaryBlock type,
+                const ColumnsWriter& columns,
+                bool compress,
+                std::uint64_t& offset,
+                std::vector<BinarySfMDataBlockEntry>& table)
+{
+    writeBlock(stream, type, columns.data().data(), columns.data().size(), compress, offset, table);
+}
+
+}  // namespace
+
+struct BinarySfMDataReader::Impl
+{
+    std::string filename;
+    bip::file_mapping mapping;
+    bip::mapped_region region;
+    const char* data = nullptr;
+    std::size_t size = 0;
+    std::map<EBinaryBlock, BinarySfMDataBlockEntry> blocks;
+
+    mutable std::mutex mutex;
+    /// decompressed blocks
+    mutable std::map<EBinaryBlock, std::vector<char>> rawBlocks;
+
+    mutable std::once_flag landmarksColumnsFlag;
+    mutable LandmarksColumns landmarksColumns;
+
+    /**
+     * @brief Get the raw data of a block, decompressed at the first access if needed.
+     * @return false if the block does not exist
+     */
+    bool getBlock(EBinaryBlock type, const char*& blockData, std::size_t& blockSize) const
+    {
+        const auto it = blocks.find(type);
+        if (it == blocks.end())
+            return false;
+
+        const BinarySfMDataBlockEntry& entry = it->second;
+        if (entry.storedSize == entry.rawSize)
+        {
+            blockData = data + entry.offset;
+            blockSize = entry.rawSize;
+            return true;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<char>& rawBlock = rawBlocks[type];
+        if (rawBlock.size() != entry.rawSize)
+        {
+            if (entry.rawSize > std::numeric_limits<uLong>::max())
+                throw std::runtime_error("Block too large to be decompressed in the binary SfMData file: " + filename);
+
+            std::vector<char> buffer(entry.rawSize);
+            uLongf rawSize = uLongf(entry.rawSize);
+            if (uncompress(reinterpret_cast<Bytef*>(buffer.data()), &rawSize, reinterpret_cast<const Bytef*>(data + entry.offset), uLong(entry.storedSize)) !=
+                  Z_OK ||
+                rawSize != entry.rawSize)
+                throw std::runtime_error("Corrupted compressed block in the binary SfMData file: " + filename);
+            std::swap(rawBlock, buffer);
+        }
+        blockData = rawBlock.data();
+        blockSize = rawBlock.size();
+        return true;
+    }
+
+    bpt::ptree getTreeBlock(EBinaryBlock type) const
+    {
+        const char* blockData = nullptr;
+        std::size_t blockSize = 0;
+        if (!getBlock(type, blockData, blockSize))
+            return bpt::ptree();
+        return stringToTree(blockData, blockSize);
+    }
+
+    const LandmarksColumns& getLandmarksColumns() const
+    {
+        std::call_once(landmarksColumnsFlag, [this]() {
+            LandmarksColumns columns;
+            const char* blockData = nullptr;
+            std::size_t blockSize = 0;
+
+            if (getBlock(EBinaryBlock::LANDMARKS, blockData, blockSize))
+            {
+                ColumnsReader reader(blockData, blockSize);
+                columns.nbLandmarks = reader.value<std::uint64_t>();
+                columns.X = reader.column<double>(3 * columns.nbLandmarks);
+                columns.ids = reader.column<std::uint32_t>(columns.nbLandmarks);
+                columns.descTypes = reader.column<std::uint32_t>(columns.nbLandmarks);
+                columns.colors = reader.column<std::uint8_t>(3 * columns.nbLandmarks);
+            }
+
+            if (columns.nbLandmarks > 0 && getBlock(EBinaryBlock::OBSERVATIONS, blockData, blockSize))
+            {
+                ColumnsReader reader(blockData, blockSize);
+                if (reader.value<std::uint64_t>() != columns.nbLandmarks)
+                    throw std::runtime_error("Invalid observations block in the binary SfMData file: " + filename);
+                columns.nbObservations = reader.value<std::uint64_t>();
+                columns.offsets = reader.column<std::uint64_t>(columns.nbLandmarks + 1);
+                columns.viewIds = reader.column<std::uint32_t>(columns.nbObservations);
+
+                if (getBlock(EBinaryBlock::OBSERVATION_FEATURES, blockData, blockSize))
+                {
+                    ColumnsReader featuresReader(blockData, blockSize);
+                    if (featuresReader.value<std::uint64_t>() != columns.nbObservations)
+                        throw std::runtime_error("Invalid observation features block in the binary SfMData file: " + filename);
+                    columns.x = featuresReader.column<double>(2 * columns.nbObservations);
+                    columns.scales = featuresReader.column<double>(columns.nbObservations);
+                    columns.featureIds = featuresReader.column<std::uint32_t>(columns.nbObservations);
+                }
+            }
+
+            landmarksColumns = columns;
+        });
+        return landmarksColumns;
+    }
+};
+
+BinarySfMDataReader::BinarySfMDataReader(const std::string& filename)
+  : _impl(new Impl())
+{
+    _impl->filename = filename;
+
+    if (!fs::exists(filename) || fs::file_size(filename) < sizeof(BinarySfMDataHeader))
+        throw std::runtime_error("Invalid binary SfMData file: " + filename);
+
+    _impl->mapping = bip::file_mapping(filename.c_str(), bip::read_only);
+    _impl->region = bip::mapped_region(_impl->mapping, bip::read_only);
+    _impl->data = static_cast<const char*>(_impl->region.get_address());
+    _impl->size = _impl->region.get_size();
+
+    BinarySfMDataHeader header;
+    std::memcpy(&header, _impl->data, sizeof(header));
+
+    if (std::memcmp(header.magic, binarySfMDataMagic, sizeof(binarySfMDataMagic)) != 0 || header.version != binarySfMDataVersion)
+        throw std::runtime_error("Invalid binary SfMData file: " + filename);
+
+    if (header.tableOffset > _impl->size || header.nbBlocks > (_impl->size - header.tableOffset) / sizeof(BinarySfMDataBlockEntry))
+        throw std::runtime_error("Truncated binary SfMData file: " + filename);
+
+    for (std::uint32_t b = 0; b < header.nbBlocks; ++b)
+    {
+        BinarySfMDataBlockEntry entry;
+        std::memcpy(&entry, _impl->data + header.tableOffset + b * sizeof(BinarySfMDataBlockEntry), sizeof(entry));
+
+        if (entry.offset > _impl->size || entry.storedSize > _impl->size - entry.offset)
+            throw std::runtime_error("Truncated binary SfMData file: " + filename);
+
+        _impl->blocks[static_cast<EBinaryBlock>(entry.type)] = entry;
+    }
+}
+
+BinarySfMDataReader::~BinarySfMDataReader() = default;
+
+std::size_t BinarySfMDataReader::getNbLandmarks() const { return _impl->getLandmarksColumns().nbLandmarks; }
+
+IndexT BinarySfMDataReader::getLandmarkId(std::size_t index) const
+{
+    const LandmarksColumns& columns = _impl->getLandmarksColumns();
+    if (index >= columns.nbLandmarks)
+        throw std::out_of_range("Invalid landmark index: " + std::to_string(index));
+    return readAt<std::uint32_t>(columns.ids, index);
+}
+
+void BinarySfMDataReader::getLandmarkAt(std::size_t index, sfmData::Landmark& landmark, ESfMData partFlag) const
+{
+    const LandmarksColumns& columns = _impl->getLandmarksColumns();
+    if (index >= columns.nbLandmarks)
+        throw std::out_of_range("Invalid landmark index: " + std::to_string(index));
+    readLandmark(columns, index, landmark, partFlag);
+}
+
+bool BinarySfMDataReader::getLandmark(IndexT landmarkId, sfmData::Landmark& landmark, ESfMData partFlag) const
+{
+    const LandmarksColumns& columns = _impl->getLandmarksColumns();
+
+    // landmarks are sorted by id
+    std::size_t first = 0;
+    std::size_t count = columns.nbLandmarks;
+    while (count > 0)
+    {
+        const std::size_t step = count / 2;
+        if (readAt<std::uint32_t>(columns.ids, first + step) < landmarkId)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+            count = step;
+    }
+
+    if (first == columns.nbLandmarks || readAt<std::uint32_t>(columns.ids, first) != landmarkId)
+        return false;
+
+    readLandmark(columns, first, landmark, partFlag);
+    return true;
+}
+
+void BinarySfMDataReader::load(sfmData::SfMData& sfmData, ESfMData partFlag) const
+{
+    // load flags
+    const bool loadViews = (partFlag & VIEWS) == VIEWS;
+    const bool loadAncestors = (partFlag & ANCESTORS) == ANCESTORS;
+    const bool loadIntrinsics = (partFlag & INTRINSICS) == INTRINSICS;
+    const bool loadExtrinsics = (partFlag & EXTRINSICS) == EXTRINSICS;
+    const bool loadStructure = (partFlag & STRUCTURE) == STRUCTURE;
+
+    // version and folders
+    bpt::ptree metadataTree = _impl->getTreeBlock(EBinaryBlock::METADATA);
+
+    Version version;
+    {
+        Vec3i v;
+        loadMatrix("version", v, metadataTree);
+        version = v;
+    }
+
+    if (metadataTree.count("featuresFolders"))
+        for (bpt::ptree::value_type& featureFolderNode : metadataTree.get_child("featuresFolders"))
+            sfmData.addFeaturesFolder(featureFolderNode.second.get_value<std::string>());
+
+    if (metadataTree.count("matchesFolders"))
+        for (bpt::ptree::value_type& matchingFolderNode : metadataTree.get_child("matchesFolders"))
+            sfmData.addMatchesFolder(matchingFolderNode.second.get_value<std::string>());
+
+    // intrinsics
+    if (loadIntrinsics)
+    {
+        bpt::ptree intrinsicsTree = _impl->getTreeBlock(EBinaryBlock::INTRINSICS);
+        if (intrinsicsTree.count("intrinsics"))
+        {
+            for (bpt::ptree::value_type& intrinsicNode : intrinsicsTree.get_child("intrinsics"))
+            {
+                IndexT intrinsicId;
+                std::shared_ptr<camera::IntrinsicBase> intrinsic;
+                loadIntrinsic(version, intrinsicId, intrinsic, intrinsicNode.second);
+                sfmData.getIntrinsics().emplace(intrinsicId, intrinsic);
+            }
+        }
+    }
+
+    // ancestors
+    if (loadAncestors)
+    {
+        bpt::ptree ancestorsTree = _impl->getTreeBlock(EBinaryBlock::ANCESTORS);
+        if (ancestorsTree.count("ancestors"))
+        {
+            for (bpt::ptree::value_type& ancestorNode : ancestorsTree.get_child("ancestors"))
+            {
+                IndexT ancestorId;
+                std::shared_ptr<sfmData::ImageInfo> ancestor = std::make_shared<sfmData::ImageInfo>(sfmData::ImageInfo());
+                loadAncestor(ancestorId, ancestor, ancestorNode.second);
+                sfmData.getAncestors().emplace(ancestorId, ancestor);
+            }
+        }
+    }
+
+    // views
+    if (loadViews)
+    {
+        bpt::ptree viewsTree = _impl->getTreeBlock(EBinaryBlock::VIEWS);
+        if (viewsTree.count("views"))
+        {
+            for (bpt::ptree::value_type& viewNode : viewsTree.get_child("views"))
+            {
+                auto view = std::make_shared<sfmData::View>();
+                loadView(*view, viewNode.second);
+                sfmData.getViews().emplace(view->getViewId(), view);
+            }
+        }
+    }
+
+    // extrinsics
+    if (loadExtrinsics)
+    {
+        // poses
+        const char* blockData = nullptr;
+        std::size_t blockSize = 0;
+        if (_impl->getBlock(EBinaryBlock::POSES, blockData, blockSize))
+        {
+            ColumnsReader reader(blockData, blockSize);
+            const std::size_t nbPoses = reader.value<std::uint64_t>();
+            const char* rotations = reader.column<double>(9 * nbPoses);
+            const char* centers = reader.column<double>(3 * nbPoses);
+            const char* ids = reader.column<std::uint32_t>(nbPoses);
+            const char* locked = reader.column<std::uint8_t>(nbPoses);
+
+            sfmData::Poses& poses = sfmData.getPoses();
+            for (std::size_t p = 0; p < nbPoses; ++p)
+            {
+                Mat3 rotation;
+                Vec3 center;
+                for (int i = 0; i < 9; ++i)
+                    rotation(i) = readAt<double>(rotations, 9 * p + i);
+                for (int i = 0; i < 3; ++i)
+                    center(i) = readAt<double>(centers, 3 * p + i);
+
+                poses.emplace(readAt<std::uint32_t>(ids, p), sfmData::CameraPose(geometry::Pose3(rotation, center), readAt<std::uint8_t>(locked, p) != 0));
+            }
+        }
+
+        // rigs
+        bpt::ptree rigsTree = _impl->getTreeBlock(EBinaryBlock::RIGS);
+        if (rigsTree.count("rigs"))
+        {
+            for (bpt::ptree::value_type& rigNode : rigsTree.get_child("rigs"))
+            {
+                IndexT rigId;
+                sfmData::Rig rig;
+                loadRig(rigId, rig, rigNode.second);
+                sfmData.getRigs().emplace(rigId, rig);
+            }
+        }
+    }
+
+    // structure
+    if (loadStructure)
+    {
+        const LandmarksColumns& columns = _impl->getLandmarksColumns();
+        sfmData::Landmarks& structure = sfmData.getLandmarks();
+
+        // create the landmarks sequentially (sorted ids) and read them in parallel
+        std::vector<sfmData::Landmark*> landmarks(columns.nbLandmarks);
+        for (std::size_t i = 0; i < columns.nbLandmarks; ++i)
+            landmarks[i] = &structure.emplace_hint(structure.end(), readAt<std::uint32_t>(columns.ids, i), sfmData::Landmark())->second;
+
+#pragma omp parallel for
+        for (std::ptrdiff_t i = 0; i < std::ptrdiff_t(columns.nbLandmarks); ++i)
+            readLandmark(columns, std::size_t(i), *landmarks[i], partFlag);
+    }
+}
+
+bool saveBinary(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag, bool compress)
+{
+    const Vec3i version = {ALICEVISION_SFMDATAIO_VERSION_MAJOR, ALICEVISION_SFMDATAIO_VERSION_MINOR, ALICEVISION_SFMDATAIO_VERSION_REVISION};
+
+    // save flags
+    const bool saveViews = (partFlag & VIEWS) == VIEWS;
+    const bool saveAncestors = (partFlag & ANCESTORS) == ANCESTORS;
+    const bool saveIntrinsics = (partFlag & INTRINSICS) == INTRINSICS;
+    const bool saveExtrinsics = (partFlag & EXTRINSICS) == EXTRINSICS;
+    const bool saveStructure = (partFlag & STRUCTURE) == STRUCTURE;
+    const bool saveFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
+    const bool saveObservations = saveFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
+
+    std::ofstream stream(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!stream.is_open())
+    {
+        ALICEVISION_LOG_ERROR("Cannot write the binary SfMData file: " << filename);
+        return false;
+    }
+
+    BinarySfMDataHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, binarySfMDataMagic, sizeof(header.magic));
+    header.version = binarySfMDataVersion;
+
+    // header is written again at the end, with the block table offset
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::uint64_t offset = sizeof(header);
+    std::vector<BinarySfMDataBlockEntry> table;
+
+    // version and folders
+    {
+        bpt::ptree metadataTree;
+        saveMatrix("version", version, metadataTree);
+
+        if (!sfmData.getRelativeFeaturesFolders().empty())
+        {
+            bpt::ptree featureFoldersTree;
+            for (const std::string& featuresFolder : sfmData.getRelativeFeaturesFolders())
+            {
+                bpt::ptree featureFolderTree;
+                featureFolderTree.put("", featuresFolder);
+                featureFoldersTree.push_back(std::make_pair("", featureFolderTree));
+            }
+            metadataTree.add_child("featuresFolders", featureFoldersTree);
+        }
+
+        if (!sfmData.getRelativeMatchesFolders().empty())
+        {
+            bpt::ptree matchingFoldersTree;
+            for (const std::string& matchesFolder : sfmData.getRelativeMatchesFolders())
+            {
+                bpt::ptree matchingFolderTree;
+                matchingFolderTree.put("", matchesFolder);
+                matchingFoldersTree.push_back(std::make_pair("", matchingFolderTree));
+            }
+            metadataTree.add_child("matchesFolders", matchingFoldersTree);
+        }
+
+        writeBlock(stream, EBinaryBlock::METADATA, treeToString(metadataTree), compress, offset, table);
+    }
+
+    // views
+    if (saveViews && !sfmData.getViews().empty())
+    {
+        bpt::ptree viewsTree;
+        for (const auto& viewPair : sfmData.getViews())
+            saveView("", *(viewPair.second), viewsTree);
+
+        bpt::ptree blockTree;
+        blockTree.add_child("views", viewsTree);
+        writeBlock(stream, EBinaryBlock::VIEWS, treeToString(blockTree), compress, offset, table);
+    }
+
+    // ancestors
+    if (saveAncestors && !sfmData.getAncestors().empty())
+    {
+        bpt::ptree ancestorsTree;
+        for (const auto& ancestorPair : sfmData.getAncestors())
+            saveAncestor(std::to_string(ancestorPair.first), ancestorPair.first, ancestorPair.second, ancestorsTree);
+
+        bpt::ptree blockTree;
+        blockTree.add_child("ancestors", ancestorsTree);
+        writeBlock(stream, EBinaryBlock::ANCESTORS, treeToString(blockTree), compress, offset, table);
+    }
+
+    // intrinsics
+    if (saveIntrinsics && !sfmData.getIntrinsics().empty())
+    {
+        bpt::ptree intrinsicsTree;
+        for (const auto& intrinsicPair : sfmData.getIntrinsics())
+            saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, intrinsicsTree);
+
+        bpt::ptree blockTree;
+        blockTree.add_child("intrinsics", intrinsicsTree);
+        writeBlock(stream, EBinaryBlock::INTRINSICS, treeToString(blockTree), compress, offset, table);
+    }
+
+    // extrinsics
+    if (saveExtrinsics)
+    {
+        // poses
+        if (!sfmData.getPoses().empty())
+        {
+            const std::size_t nbPoses = sfmData.getPoses().size();
+            std::vector<double> rotations;
+            std::vector<double> centers;
+            std::vector<std::uint32_t> ids;
+            std::vector<std::uint8_t> locked;
+            rotations.reserve(9 * nbPoses);
+            centers.reserve(3 * nbPoses);
+            ids.reserve(nbPoses);
+            locked.reserve(nbPoses);
+
+            for (const auto& posePair : sfmData.getPoses())
+            {
+                const Mat3 rotation = posePair.second.getTransform().rotation();
+                const Vec3 center = posePair.second.getTransform().center();
+                rotations.insert(rotations.end(), rotation.data(), rotation.data() + 9);
+                centers.insert(centers.end(), center.data(), center.data() + 3);
+                ids.push_back(posePair.first);
+                locked.push_back(posePair.second.isLocked() ? 1 : 0);
+            }
+
+            ColumnsWriter columns;
+            columns.addValue(std::uint64_t(nbPoses));
+            columns.add(rotations);
+            columns.add(centers);
+            columns.add(ids);
+            columns.add(locked);
+            writeBlock(stream, EBinaryBlock::POSES, columns, compress, offset, table);
+        }
+
+        // rigs
+        if (!sfmData.getRigs().empty())
+        {
+            bpt::ptree rigsTree;
+            for (const auto& rigPair : sfmData.getRigs())
+                saveRig("", rigPair.first, rigPair.second, rigsTree);
+
+            bpt::ptree blockTree;
+            blockTree.add_child("rigs", rigsTree);
+            writeBlock(stream, EBinaryBlock::RIGS, treeToString(blockTree), compress, offset, table);
+        }
+    }
+
+    // structure
+    if (saveStructure && !sfmData.getLandmarks().empty())
+    {
+        // landmarks sorted by id, for the search of a landmark by id
+        std::vector<std::pair<IndexT, const sfmData::Landmark*>> landmarks;
+        landmarks.reserve(sfmData.getLandmarks().size());
+        for (const auto& landmarkPair : sfmData.getLandmarks())
+            landmarks.emplace_back(landmarkPair.first, &landmarkPair.second);
+        std::sort(landmarks.begin(), landmarks.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        const std::size_t nbLandmarks = landmarks.size();
+        std::vector<std::uint64_t> offsets(nbLandmarks + 1, 0);
+        for (std::size_t i = 0; i < nbLandmarks; ++i)
+            offsets[i + 1] = offsets[i] + landmarks[i].second->observations.size();
+        const std::size_t nbObservations = offsets.back();
+
+        std::vector<double> X(3 * nbLandmarks);
+        std::vector<std::uint32_t> ids(nbLandmarks);
+        std::vector<std::uint32_t> descTypes(nbLandmarks);
+        std::vector<std::uint8_t> colors(3 * nbLandmarks);
+        std::vector<std::uint32_t> viewIds(saveObservations ? nbObservations : 0);
+        std::vector<double> x(saveFeatures ? 2 * nbObservations : 0);
+        std::vector<double> scales(saveFeatures ? nbObservations : 0);
+        std::vector<std::uint32_t> featureIds(saveFeatures ? nbObservations : 0);
+
+#pragma omp parallel for
+        for (std::ptrdiff_t i = 0; i < std::ptrdiff_t(nbLandmarks); ++i)
+        {
+            const sfmData::Landmark& landmark = *landmarks[i].second;
+            ids[i] = landmarks[i].first;
+            descTypes[i] = static_cast<std::uint32_t>(landmark.descType);
+            for (int c = 0; c < 3; ++c)
+            {
+                X[3 * i + c] = landmark.X(c);
+                colors[3 * i + c] = landmark.rgb(c);
+            }
+
+            if (!saveObservations)
+                continue;
+
+            std::size_t k = offsets[i];
+            for (const auto& observationPair : landmark.observations)
+            {
+                viewIds[k] = observationPair.first;
+                if (saveFeatures)
+                {
+                    const sfmData::Observation& observation = observationPair.second;
+                    x[2 * k] = observation.x(0);
+                    x[2 * k + 1] = observation.x(1);
+                    scales[k] = observation.scale;
+                    featureIds[k] = observation.id_feat;
+                }
+                ++k;
+            }
+        }
+
+        {
+            ColumnsWriter columns;
+            columns.addValue(std::uint64_t(nbLandmarks));
+            columns.add(X);
+            columns.add(ids);
+            columns.add(descTypes);
+            columns.add(colors);
+            writeBlock(stream, EBinaryBlock::LANDMARKS, columns, compress, offset, table);
+        }
+
+        if (saveObservations)
+        {
+            ColumnsWriter columns;
+            columns.addValue(std::uint64_t(nbLandmarks));
+            columns.addValue(std::uint64_t(nbObservations));
+            columns.add(offsets);
+            columns.add(viewIds);
+            writeBlock(stream, EBinaryBlock::OBSERVATIONS, columns, compress, offset, table);
+        }
+
+        if (saveFeatures)
+        {
+            ColumnsWriter columns;
+            columns.addValue(std::uint64_t(nbObservations));
+            columns.add(x);
+            columns.add(scales);
+            columns.add(featureIds);
+            writeBlock(stream, EBinaryBlock::OBSERVATION_FEATURES, columns, compress, offset, table);
+        }
+    }
+
+    // block table
+    const std::size_t paddingSize = alignedSize(offset) - offset;
+    stream.write(std::string(paddingSize, '\0').data(), paddingSize);
+    header.tableOffset = offset + paddingSize;
+    header.nbBlocks = static_cast<std::uint32_t>(table.size());
+    stream.write(reinterpret_cast<const char*>(table.data()), std::streamsize(table.size() * sizeof(BinarySfMDataBlockEntry)));
+
+    stream.seekp(0);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (!stream.good())
+    {
+        ALICEVISION_LOG_ERROR("Cannot write the binary SfMData file: " << filename);
+        return false;
+    }
+    return true;
+}
+
+bool loadBinary(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+{
+    try
+    {
+        BinarySfMDataReader(filename).load(sfmData, partFlag);
+    }
+    catch (const std::exception& e)
+    {
+        ALICEVISION_LOG_ERROR("Cannot load the binary SfMData file: " << filename << std::endl << e.what());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace sfmDataIO
+}  // namespace aliceVision
@@ -0,0 +1,101 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#pragma once
+
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+
+#include <memory>
+#include <string>
+
+namespace aliceVision {
+namespace sfmDataIO {
+
+/**
+ * @brief Reader of a binary SfMData file (.sfmb).
+ *
+ * The file is made of independent blocks (views, ancestors, intrinsics, poses, rigs, landmarks,
+ * observations and observation features) referenced by a block table at the end of the file.
+ * Landmarks and observations are stored column by column (ids, positions, colors, ...) and
+ * observations are indexed by landmark, so the file is memory-mapped and:
+ * - only the blocks requested by the ESfMData flags are read,
+ * - each landmark can be read on demand, without loading the whole structure.
+ *
+ * Compressed blocks are decompressed in memory the first time they are accessed.
+ * All the const methods are thread-safe.
+ */
+class BinarySfMDataReader
+{
+  public:
+    /**
+     * @brief Open a binary SfMData file.
+     * @param[in] filename The .sfmb file path
+     * @note throw if the file is not a valid binary SfMData file
+     */
+    explicit BinarySfMDataReader(const std::string& filename);
+    ~BinarySfMDataReader();
+
+    /**
+     * @brief Load the requested parts of the SfMData.
+     * @param[out] sfmData The output SfMData
+     * @param[in] partFlag The ESfMData load flag, the other blocks are not read
+     */
+    void load(sfmData::SfMData& sfmData, ESfMData partFlag) const;
+
+    /**
+     * @brief Get the number of landmarks stored in the file.
+     */
+    std::size_t getNbLandmarks() const;
+
+    /**
+     * @brief Get the id of a landmark, landmarks are sorted by id.
+     * @param[in] index The landmark index in [0, getNbLandmarks()[
+     */
+    IndexT getLandmarkId(std::size_t index) const;
+
+    /**
+     * @brief Read a landmark.
+     * @param[in] index The landmark index in [0, getNbLandmarks()[
+     * @param[out] landmark The output landmark
+     * @param[in] partFlag OBSERVATIONS and OBSERVATIONS_WITH_FEATURES flags select the observations data to read
+     */
+    void getLandmarkAt(std::size_t index, sfmData::Landmark& landmark, ESfMData partFlag = ALL) const;
+
+    /**
+     * @brief Find and read a landmark from its id.
+     * @param[in] landmarkId The landmark id
+     * @param[out] landmark The output landmark
+     * @param[in] partFlag OBSERVATIONS and OBSERVATIONS_WITH_FEATURES flags select the observations data to read
+     * @return false if there is no landmark with this id
+     */
+    bool getLandmark(IndexT landmarkId, sfmData::Landmark& landmark, ESfMData partFlag = ALL) const;
+
+  private:
+    struct Impl;
+    std::unique_ptr<Impl> _impl;
+};
+
+/**
+ * @brief Save an SfMData in a binary file (.sfmb).
+ * @param[in] sfmData The input SfMData
+ * @param[in] filename The filename
+ * @param[in] partFlag The ESfMData save flag
+ * @param[in] compress Compress the blocks with zlib (compressed landmarks are decompressed at the first access)
+ * @return true if completed
+ */
+bool saveBinary(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag, bool compress = false);
+
+/**
+ * @brief Load a binary SfMData file (.sfmb).
+ * @param[out] sfmData The output SfMData
+ * @param[in] filename The filename
+ * @param[in] partFlag The ESfMData load flag
+ * @return true if completed
+ */
+bool loadBinary(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag);
+
+}  // namespace sfmDataIO
+}  // namespace aliceVision
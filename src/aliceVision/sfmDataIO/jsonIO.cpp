@@ -10,8 +10,12 @@
 
 #include <boost/property_tree/json_parser.hpp>
 
-#include <memory>
 #include <cassert>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
 
 namespace aliceVision {
 namespace sfmDataIO {
@@ -503,6 +507,471 @@ void loadLandmark(IndexT& landmarkId, sfmData::Landmark& landmark, bpt::ptree& l
     }
 }
 
+namespace {
+
+/**
+ * @brief Incremental writer of a JSON file, with the same formatting as bpt::write_json.
+ * The root object is written section by section and the big sections element by element,
+ * so only the property tree of one element is in memory at a time.
+ */
+class JsonStreamWriter
+{
+  public:
+    explicit JsonStreamWriter(std::ostream& stream)
+      : _stream(stream)
+    {
+        _stream << "{\n";
+    }
+
+    /**
+     * @brief Write a section of the root object from its property tree.
+     */
+    void writeSection(const std::string& name, const bpt::ptree& tree)
+    {
+        beginSection(name);
+        bpt::json_parser::write_json_helper(_stream, tree, 1, true);
+    }
+
+    /**
+     * @brief Write a section of the root object element by element.
+     * @param[in] name The section name
+     * @param[in] begin,end The range of the elements
+     * @param[in] saveElement Function adding the property tree of an element to a parent tree
+     */
+    template<typename Iterator, typename SaveElement>
+    void writeSection(const std::string& name, Iterator begin, Iterator end, SaveElement saveElement)
+    {
+        beginSection(name);
+
+        bpt::ptree elementTree;
+        bool isArray = true;
+        for (Iterator it = begin; it != end; ++it)
+        {
+            elementTree.clear();
+            saveElement(*it, elementTree);
+            const bpt::ptree::value_type& element = elementTree.front();
+
+            if (it == begin)
+            {
+                // an array if the elements have no name, as in bpt::write_json
+                isArray = element.first.empty();
+                _stream << (isArray ? "[\n" : "{\n");
+            }
+            else
+            {
+                _stream << ",\n";
+            }
+
+            _stream << std::string(8, ' ');
+            if (!isArray)
+                _stream << '"' << bpt::json_parser::create_escapes(element.first) << "\": ";
+            bpt::json_parser::write_json_helper(_stream, element.second, 2, true);
+        }
+
+        if (begin == end)
+            _stream << "\"\"";
+        else
+            _stream << '\n' << std::string(4, ' ') << (isArray ? ']' : '}');
+    }
+
+    void close()
+    {
+        if (_nbSections > 0)
+            _stream << '\n';
+        _stream << '}' << std::endl;
+    }
+
+  private:
+    void beginSection(const std::string& name)
+    {
+        if (_nbSections++ > 0)
+            _stream << ",\n";
+        _stream << std::string(4, ' ') << '"' << bpt::json_parser::create_escapes(name) << "\": ";
+    }
+
+    std::ostream& _stream;
+    std::size_t _nbSections = 0;
+};
+
+/**
+ * @brief Minimal SAX JSON parser reading a stream by chunks.
+ * Values are reported as text, like the bpt::read_json parser: strings are unescaped,
+ * numbers and literals (true, false, null) are kept as they are written.
+ */
+template<typename Handler>
+class JsonSaxParser
+{
+  public:
+    JsonSaxParser(std::istream& stream, const std::string& filename, Handler& handler)
+      : _stream(stream),
+        _filename(filename),
+        _handler(handler),
+        _buffer(1 << 16)
+    {}
+
+    void parse()
+    {
+        skipWhitespaces();
+        parseValue();
+        skipWhitespaces();
+        if (peek() != eof)
+            error("garbage after data");
+    }
+
+  private:
+    static constexpr int eof = std::char_traits<char>::eof();
+
+    int peek()
+    {
+        if (_position == _size)
+        {
+            _stream.read(_buffer.data(), std::streamsize(_buffer.size()));
+            _size = std::size_t(_stream.gcount());
+            _position = 0;
+            if (_size == 0)
+                return eof;
+        }
+        return static_cast<unsigned char>(_buffer[_position]);
+    }
+
+    int get()
+    {
+        const int c = peek();
+        if (c != eof)
+        {
+            ++_position;
+            if (c == '\n')
+                ++_line;
+        }
+        return c;
+    }
+
+    void expect(char expected)
+    {
+        if (get() != expected)
+            error(std::string("expected '") + expected + "'");
+    }
+
+    [[noreturn]] void error(const std::string& message) const { throw bpt::json_parser::json_parser_error(message, _filename, _line); }
+
+    void skipWhitespaces()
+    {
+        for (int c = peek(); c == ' ' || c == '\t' || c == '\n' || c == '\r'; c = peek())
+            get();
+    }
+
+    void parseValue()
+    {
+        switch (peek())
+        {
+            case '{':
+                parseObject();
+                break;
+            case '[':
+                parseArray();
+                break;
+            case '"':
+                _handler.onValue(parseString());
+                break;
+            case 't':
+                parseLiteral("true");
+                break;
+            case 'f':
+                parseLiteral("false");
+                break;
+            case 'n':
+                parseLiteral("null");
+                break;
+            default:
+                parseNumber();
+        }
+    }
+
+    void parseObject()
+    {
+        expect('{');
+        _handler.onObjectBegin();
+        skipWhitespaces();
+        if (peek() == '}')
+        {
+            get();
+            _handler.onObjectEnd();
+            return;
+        }
+        while (true)
+        {
+            skipWhitespaces();
+            if (peek() != '"')
+                error("expected key string");
+            _handler.onKey(parseString());
+            skipWhitespaces();
+            expect(':');
+            skipWhitespaces();
+            parseValue();
+            skipWhitespaces();
+            const int c = get();
+            if (c == '}')
+                break;
+            if (c != ',')
+                error("expected ',' or '}'");
+        }
+        _handler.onObjectEnd();
+    }
+
+    void parseArray()
+    {
+        expect('[');
+        _handler.onArrayBegin();
+        skipWhitespaces();
+        if (peek() == ']')
+        {
+            get();
+            _handler.onArrayEnd();
+            return;
+        }
+        while (true)
+        {
+            skipWhitespaces();
+            parseValue();
+            skipWhitespaces();
+            const int c = get();
+            if (c == ']')
+                break;
+            if (c != ',')
+                error("expected ',' or ']'");
+        }
+        _handler.onArrayEnd();
+    }
+
+    void parseLiteral(const char* literal)
+    {
+        for (const char* c = literal; *c != '\0'; ++c)
+        {
+            if (get() != *c)
+                error("invalid literal");
+        }
+        _handler.onValue(literal);
+    }
+
+    void parseNumber()
+    {
+        std::string number;
+        for (int c = peek(); (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E'; c = peek())
+            number.push_back(char(get()));
+        if (number.empty())
+            error("expected value");
+        _handler.onValue(std::move(number));
+    }
+
+    unsigned int parseHex4()
+    {
+        unsigned int value = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            const int c = get();
+            value <<= 4;
+            if (c >= '0' && c <= '9')
+                value |= unsigned(c - '0');
+            else if (c >= 'a' && c <= 'f')
+                value |= unsigned(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F')
+                value |= unsigned(c - 'A' + 10);
+            else
+                error("invalid escape sequence");
+        }
+        return value;
+    }
+
+    static void appendUtf8(std::string& out, unsigned int codepoint)
+    {
+        if (codepoint < 0x80)
+            out.push_back(char(codepoint));
+        else if (codepoint < 0x800)
+        {
+            out.push_back(char(0xC0 | (codepoint >> 6)));
+            out.push_back(char(0x80 | (codepoint & 0x3F)));
+        }
+        else if (codepoint < 0x10000)
+        {
+            out.push_back(char(0xE0 | (codepoint >> 12)));
+            out.push_back(char(0x80 | ((codepoint >> 6) & 0x3F)));
+            out.push_back(char(0x80 | (codepoint & 0x3F)));
+        }
+        else
+        {
+            out.push_back(char(0xF0 | (codepoint >> 18)));
+            out.push_back(char(0x80 | ((codepoint >> 12) & 0x3F)));
+            out.push_back(char(0x80 | ((codepoint >> 6) & 0x3F)));
+            out.push_back(char(0x80 | (codepoint & 0x3F)));
+        }
+    }
+
+    std::string parseString()
+    {
+        expect('"');
+        std::string value;
+        while (true)
+        {
+            const int c = get();
+            if (c == eof)
+                error("unterminated string");
+            if (c == '"')
+                return value;
+            if (c != '\\')
+            {
+                value.push_back(char(c));
+                continue;
+            }
+
+            switch (get())
+            {
+                case '"':
+                    value.push_back('"');
+                    break;
+                case '\\':
+                    value.push_back('\\');
+                    break;
+                case '/':
+                    value.push_back('/');
+                    break;
+                case 'b':
+                    value.push_back('\b');
+                    break;
+                case 'f':
+                    value.push_back('\f');
+                    break;
+                case 'n':
+                    value.push_back('\n');
+                    break;
+                case 'r':
+                    value.push_back('\r');
+                    break;
+                case 't':
+                    value.push_back('\t');
+                    break;
+                case 'u':
+                {
+                    unsigned int codepoint = parseHex4();
+                    // UTF-16 surrogate pair
+                    if (codepoint >= 0xD800 && codepoint < 0xDC00)
+                    {
+                        if (get() != '\\' || get() != 'u')
+                            error("invalid codepoint, stray high surrogate");
+                        const unsigned int low = parseHex4();
+                        if (low < 0xDC00 || low >= 0xE000)
+                            error("invalid codepoint, stray high surrogate");
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(value, codepoint);
+                    break;
+                }
+                default:
+                    error("invalid escape sequence");
+            }
+        }
+    }
+
+    std::istream& _stream;
+    const std::string& _filename;
+    Handler& _handler;
+    std::vector<char> _buffer;
+    std::size_t _position = 0;
+    std::size_t _size = 0;
+    int _line = 1;
+};
+
+/**
+ * @brief SAX handler building the property trees of the sections of an SfMData JSON file.
+ * The sections that are not requested are skipped and the elements of the "structure" section
+ * are given one by one to a callback, so the structure is never stored as a whole property tree.
+ */
+template<typename LandmarkCallback>
+class SfMDataJsonHandler
+{
+  public:
+    SfMDataJsonHandler(bpt::ptree& fileTree, const std::set<std::string>& sections, LandmarkCallback landmarkCallback)
+      : _fileTree(fileTree),
+        _sections(sections),
+        _landmarkCallback(landmarkCallback)
+    {}
+
+    void onObjectBegin() { begin(); }
+    void onObjectEnd() { end(); }
+    void onArrayBegin() { begin(); }
+    void onArrayEnd() { end(); }
+
+    void onKey(std::string&& key) { _key = std::move(key); }
+
+    void onValue(std::string&& value)
+    {
+        if (_depth == 0)
+            return;
+
+        bpt::ptree* parent = (_depth == 1) ? sectionParent() : _trees.back();
+        if (parent != nullptr)
+            parent->push_back(std::make_pair(std::move(_key), bpt::ptree(std::move(value))));
+        _key.clear();
+    }
+
+  private:
+    void begin()
+    {
+        if (_depth == 0)
+        {
+            _trees.push_back(&_fileTree);
+        }
+        else if (_depth == 1 && _key == "structure" && _sections.count(_key))
+        {
+            // the landmarks are added to a temporary tree, see end()
+            _streamStructure = true;
+            _structureTree.clear();
+            _trees.push_back(&_structureTree);
+        }
+        else
+        {
+            bpt::ptree* parent = (_depth == 1) ? sectionParent() : _trees.back();
+            _trees.push_back((parent == nullptr) ? nullptr : &parent->push_back(std::make_pair(std::move(_key), bpt::ptree()))->second);
+        }
+        _key.clear();
+        ++_depth;
+    }
+
+    void end()
+    {
+        --_depth;
+        _trees.pop_back();
+
+        if (_streamStructure && _depth == 2)
+        {
+            // a landmark has been read
+            _landmarkCallback(_structureTree.back().second);
+            _structureTree.clear();
+        }
+        else if (_depth == 1)
+        {
+            _streamStructure = false;
+        }
+    }
+
+    /**
+     * @brief Get the parent tree of a section of the root object, nullptr to skip the section.
+     */
+    bpt::ptree* sectionParent() const { return _sections.count(_key) ? &_fileTree : nullptr; }
+
+    bpt::ptree& _fileTree;
+    const std::set<std::string>& _sections;
+    LandmarkCallback _landmarkCallback;
+
+    /// stack of the trees being built, nullptr for skipped nodes
+    std::vector<bpt::ptree*> _trees;
+    bpt::ptree _structureTree;
+    std::string _key;
+    int _depth = 0;
+    bool _streamStructure = false;
+};
+
+}  // namespace
+
 bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
 {
     const Vec3i version = {ALICEVISION_SFMDATAIO_VERSION_MAJOR, ALICEVISION_SFMDATAIO_VERSION_MINOR, ALICEVISION_SFMDATAIO_VERSION_REVISION};
@@ -516,72 +985,65 @@ bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfM
     const bool saveFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
     const bool saveObservations = saveFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
 
-    // main tree
-    bpt::ptree fileTree;
+    std::ofstream stream(filename);
+    if (!stream.is_open())
+        throw bpt::json_parser::json_parser_error("cannot open file", filename, 0);
+
+    // the file is written section by section and the views, ancestors, intrinsics, poses, rigs and landmarks
+    // one by one, only the property tree of the current element is in memory
+    // the output is the same as bpt::write_json of the whole SfMData tree
+    JsonStreamWriter writer(stream);
 
     // file version
-    saveMatrix("version", version, fileTree);
+    {
+        bpt::ptree versionTree;
+        saveMatrix("version", version, versionTree);
+        writer.writeSection("version", versionTree.get_child("version"));
+    }
 
     // folders
+    const auto saveFolder = [](const std::string& folder, bpt::ptree& parentTree) {
+        bpt::ptree folderTree;
+        folderTree.put("", folder);
+        parentTree.push_back(std::make_pair("", folderTree));
+    };
+
     if (!sfmData.getRelativeFeaturesFolders().empty())
     {
-        bpt::ptree featureFoldersTree;
-
-        for (const std::string& featuresFolder : sfmData.getRelativeFeaturesFolders())
-        {
-            bpt::ptree featureFolderTree;
-            featureFolderTree.put("", featuresFolder);
-            featureFoldersTree.push_back(std::make_pair("", featureFolderTree));
-        }
-
-        fileTree.add_child("featuresFolders", featureFoldersTree);
+        const std::vector<std::string>& featuresFolders = sfmData.getRelativeFeaturesFolders();
+        writer.writeSection("featuresFolders", featuresFolders.begin(), featuresFolders.end(), saveFolder);
     }
 
     if (!sfmData.getRelativeMatchesFolders().empty())
     {
-        bpt::ptree matchingFoldersTree;
-
-        for (const std::string& matchesFolder : sfmData.getRelativeMatchesFolders())
-        {
-            bpt::ptree matchingFolderTree;
-            matchingFolderTree.put("", matchesFolder);
-            matchingFoldersTree.push_back(std::make_pair("", matchingFolderTree));
-        }
-
-        fileTree.add_child("matchesFolders", matchingFoldersTree);
+        const std::vector<std::string>& matchesFolders = sfmData.getRelativeMatchesFolders();
+        writer.writeSection("matchesFolders", matchesFolders.begin(), matchesFolders.end(), saveFolder);
     }
 
     // views
     if (saveViews && !sfmData.getViews().empty())
     {
-        bpt::ptree viewsTree;
-
-        for (const auto& viewPair : sfmData.getViews())
-            saveView("", *(viewPair.second), viewsTree);
-
-        fileTree.add_child("views", viewsTree);
+        writer.writeSection("views", sfmData.getViews().begin(), sfmData.getViews().end(), [](const auto& viewPair, bpt::ptree& parentTree) {
+            saveView("", *(viewPair.second), parentTree);
+        });
     }
 
     // ancestors
     if (saveAncestors && !sfmData.getAncestors().empty())
     {
-        bpt::ptree ancestorsTree;
-
-        for (const auto& ancestorPair : sfmData.getAncestors())
-            saveAncestor(std::to_string(ancestorPair.first), ancestorPair.first, ancestorPair.second, ancestorsTree);
-
-        fileTree.add_child("ancestors", ancestorsTree);
+        writer.writeSection(
+          "ancestors", sfmData.getAncestors().begin(), sfmData.getAncestors().end(), [](const auto& ancestorPair, bpt::ptree& parentTree) {
+              saveAncestor(std::to_string(ancestorPair.first), ancestorPair.first, ancestorPair.second, parentTree);
+          });
     }
 
     // intrinsics
     if (saveIntrinsics && !sfmData.getIntrinsics().empty())
     {
-        bpt::ptree intrinsicsTree;
-
-        for (const auto& intrinsicPair : sfmData.getIntrinsics())
-            saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, intrinsicsTree);
-
-        fileTree.add_child("intrinsics", intrinsicsTree);
+        writer.writeSection(
+          "intrinsics", sfmData.getIntrinsics().begin(), sfmData.getIntrinsics().end(), [](const auto& intrinsicPair, bpt::ptree& parentTree) {
+              saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, parentTree);
+          });
     }
 
     // extrinsics
@@ -590,46 +1052,39 @@ bool saveJSON(const sfmData::SfMData& sfmData, const std::string& filename, ESfM
         // poses
         if (!sfmData.getPoses().empty())
         {
-            bpt::ptree posesTree;
-
-            for (const auto& posePair : sfmData.getPoses())
-            {
+            writer.writeSection("poses", sfmData.getPoses().begin(), sfmData.getPoses().end(), [](const auto& posePair, bpt::ptree& parentTree) {
                 bpt::ptree poseTree;
 
                 poseTree.put("poseId", posePair.first);
                 saveCameraPose("pose", posePair.second, poseTree);
-                posesTree.push_back(std::make_pair("", poseTree));
-            }
-
-            fileTree.add_child("poses", posesTree);
+                parentTree.push_back(std::make_pair("", poseTree));
+            });
         }
 
         // rigs
         if (!sfmData.getRigs().empty())
         {
-            bpt::ptree rigsTree;
-
-            for (const auto& rigPair : sfmData.getRigs())
-                saveRig("", rigPair.first, rigPair.second, rigsTree);
-
-            fileTree.add_child("rigs", rigsTree);
+            writer.writeSection("rigs", sfmData.getRigs().begin(), sfmData.getRigs().end(), [](const auto& rigPair, bpt::ptree& parentTree) {
+                saveRig("", rigPair.first, rigPair.second, parentTree);
+            });
         }
     }
 
     // structure
     if (saveStructure && !sfmData.getLandmarks().empty())
     {
-        bpt::ptree structureTree;
-
-        for (const auto& structurePair : sfmData.getLandmarks())
-            saveLandmark("", structurePair.first, structurePair.second, structureTree, saveObservations, saveFeatures);
-
-        fileTree.add_child("structure", structureTree);
+        writer.writeSection("structure",
+                            sfmData.getLandmarks().begin(),
+                            sfmData.getLandmarks().end(),
+                            [&](const auto& structurePair, bpt::ptree& parentTree) {
+                                saveLandmark("", structurePair.first, structurePair.second, parentTree, saveObservations, saveFeatures);
+                            });
     }
 
-    // write the json file with the tree
+    writer.close();
 
-    bpt::write_json(filename, fileTree);
+    if (!stream.good())
+        throw bpt::json_parser::json_parser_error("write error", filename, 0);
 
     return true;
 }
@@ -652,11 +1107,42 @@ bool loadJSON(sfmData::SfMData& sfmData,
     const bool loadFeatures = (partFlag & OBSERVATIONS_WITH_FEATURES) == OBSERVATIONS_WITH_FEATURES;
     const bool loadObservations = loadFeatures || ((partFlag & OBSERVATIONS) == OBSERVATIONS);
 
-    // main tree
+    // main tree, without the structure
     bpt::ptree fileTree;
 
-    // read the json file and initialize the tree
-    bpt::read_json(filename, fileTree);
+    // sections of the file to read
+    std::set<std::string> sections = {"version", "featuresFolders", "matchesFolders"};
+    if (loadViews)
+        sections.insert("views");
+    if (loadAncestors)
+        sections.insert("ancestors");
+    if (loadIntrinsics)
+        sections.insert("intrinsics");
+    if (loadExtrinsics)
+        sections.insert({"poses", "rigs"});
+    if (loadStructure)
+        sections.insert("structure");
+
+    // read the json file, the landmarks are loaded while the file is parsed
+    {
+        std::ifstream stream(filename, std::ios::binary);
+        if (!stream.is_open())
+            throw bpt::json_parser::json_parser_error("cannot open file", filename, 0);
+
+        sfmData::Landmarks& structure = sfmData.getLandmarks();
+        const auto loadStructureLandmark = [&](bpt::ptree& landmarkTree) {
+            IndexT landmarkId;
+            sfmData::Landmark landmark;
+
+            loadLandmark(landmarkId, landmark, landmarkTree, loadObservations, loadFeatures);
+
+            structure.emplace(landmarkId, landmark);
+        };
+
+        SfMDataJsonHandler<decltype(loadStructureLandmark)> handler(fileTree, sections, loadStructureLandmark);
+        JsonSaxParser<decltype(handler)> parser(stream, filename, handler);
+        parser.parse();
+    }
 
     // version
     {
@@ -798,22 +1284,6 @@ bool loadJSON(sfmData::SfMData& sfmData,
         }
     }
 
-    // structure
-    if (loadStructure && fileTree.count("structure"))
-    {
-        sfmData::Landmarks& structure = sfmData.getLandmarks();
-
-        for (bpt::ptree::value_type& landmarkNode : fileTree.get_child("structure"))
-        {
-            IndexT landmarkId;
-            sfmData::Landmark landmark;
-
-            loadLandmark(landmarkId, landmark, landmarkNode.second, loadObservations, loadFeatures);
-
-            structure.emplace(landmarkId, landmark);
-        }
-    }
-
     return true;
 }
 
@@ -9,6 +9,7 @@
 #include <aliceVision/config.hpp>
 #include <aliceVision/stl/mapUtils.hpp>
 #include <aliceVision/sfmDataIO/jsonIO.hpp>
+#include <aliceVision/sfmDataIO/binaryIO.hpp>
 #include <aliceVision/sfmDataIO/plyIO.hpp>
 #include <aliceVision/sfmDataIO/bafIO.hpp>
 #include <aliceVision/sfmDataIO/gtIO.hpp>
@@ -114,6 +115,10 @@ bool Load(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partF
     {
         status = loadJSON(sfmData, filename, partFlag);
     }
+    else if (extension == ".sfmb")  // Binary File
+    {
+        status = loadBinary(sfmData, filename, partFlag);
+    }
     else if (extension == ".abc")  // Alembic
     {
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
@@ -143,7 +148,7 @@ bool Load(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partF
     return status;
 }
 
-bool Save(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag)
+bool Save(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag, bool compressBinary)
 {
     const fs::path bPath = fs::path(filename);
     const std::string extension = bPath.extension().string();
@@ -154,6 +159,10 @@ bool Save(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData
     {
         status = saveJSON(sfmData, tmpPath, partFlag);
     }
+    else if (extension == ".sfmb")  // Binary File
+    {
+        status = saveBinary(sfmData, tmpPath, partFlag, compressBinary);
+    }
     else if (extension == ".ply")  // Polygon File
     {
         status = savePLY(sfmData, tmpPath, partFlag);
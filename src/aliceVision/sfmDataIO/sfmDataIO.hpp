@@ -46,8 +46,8 @@ bool ValidIds(const sfmData::SfMData& sfmData, ESfMData partFlag);
 /// load SfMData SfM scene from a file
 bool Load(sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag);
 
-/// save SfMData SfM scene to a file
-bool Save(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag);
+/// save SfMData SfM scene to a file (compressBinary: compress the blocks of a binary file, see saveBinary)
+bool Save(const sfmData::SfMData& sfmData, const std::string& filename, ESfMData partFlag, bool compressBinary = false);
 
 }  // namespace sfmDataIO
 }  // namespace aliceVision
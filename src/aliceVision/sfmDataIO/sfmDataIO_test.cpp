@@ -8,10 +8,15 @@
 #include <aliceVision/system/Timer.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/sfmDataIO/binaryIO.hpp>
+#include <aliceVision/sfmDataIO/jsonIO.hpp>
 #include <aliceVision/config.hpp>
 
 #include <boost/filesystem.hpp>
+#include <boost/property_tree/json_parser.hpp>
 
+#include <fstream>
+#include <iterator>
 #include <sstream>
 
 #define BOOST_TEST_MODULE sfmDataIO
@@ -71,7 +76,7 @@ sfmData::SfMData createTestScene(std::size_t viewsCount = 2, std::size_t observa
 
 BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_LOAD)
 {
-    std::vector<std::string> ext_Type = {"sfm", "json"};
+    std::vector<std::string> ext_Type = {"sfm", "json", "sfmb"};
 
 #if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_ALEMBIC)
     ext_Type.push_back("abc");
@@ -173,6 +178,146 @@ BOOST_AUTO_TEST_CASE(SfMData_IO_SAVE_LOAD)
     }
 }
 
+BOOST_AUTO_TEST_CASE(SfMData_IO_BINARY_LANDMARKS)
+{
+    sfmData::SfMData sfmData = createTestScene(4, 4, true);
+    for (IndexT landmarkId = 1; landmarkId < 100; ++landmarkId)
+    {
+        sfmData::Landmark& landmark = sfmData.getLandmarks()[landmarkId * 3];
+        landmark.X = Vec3(landmarkId, -1.0 * landmarkId, 0.5 * landmarkId);
+        landmark.descType = feature::EImageDescriberType::AKAZE;
+        landmark.rgb = image::RGBColor(landmarkId, 2 * landmarkId, 0);
+        for (IndexT viewId = landmarkId % 3; viewId < 4; ++viewId)
+            landmark.observations[viewId] = sfmData::Observation(Vec2(landmarkId, viewId), landmarkId + viewId, 1.5);
+    }
+
+    for (const bool compress : {false, true})
+    {
+        BOOST_TEST_CONTEXT("compress: " << compress)
+        {
+            const std::string filename = "SAVE_LOAD_LANDMARKS.sfmb";
+            BOOST_CHECK(saveBinary(sfmData, filename, ALL, compress));
+
+            // on demand access to the landmarks
+            const BinarySfMDataReader reader(filename);
+            BOOST_CHECK_EQUAL(reader.getNbLandmarks(), sfmData.getLandmarks().size());
+
+            std::size_t index = 0;
+            for (const auto& landmarkPair : sfmData.getLandmarks())
+            {
+                sfmData::Landmark landmark;
+                BOOST_CHECK_EQUAL(reader.getLandmarkId(index), landmarkPair.first);
+                BOOST_CHECK(reader.getLandmark(landmarkPair.first, landmark));
+                BOOST_CHECK(landmark == landmarkPair.second);
+                BOOST_CHECK(landmark.rgb == landmarkPair.second.rgb);
+
+                reader.getLandmarkAt(index++, landmark, ESfMData::STRUCTURE);
+                BOOST_CHECK(landmark.observations.empty());
+            }
+
+            sfmData::Landmark landmark;
+            BOOST_CHECK(!reader.getLandmark(1, landmark));
+            BOOST_CHECK(!reader.getLandmark(UndefinedIndexT, landmark));
+
+            // observations without features
+            sfmData::SfMData sfmDataLoad;
+            reader.load(sfmDataLoad, ESfMData(STRUCTURE | OBSERVATIONS));
+            BOOST_CHECK(sfmDataLoad.getViews().empty());
+            BOOST_CHECK_EQUAL(sfmDataLoad.getLandmarks().size(), sfmData.getLandmarks().size());
+            for (const auto& landmarkPair : sfmDataLoad.getLandmarks())
+            {
+                const sfmData::Landmark& expected = sfmData.getLandmarks().at(landmarkPair.first);
+                BOOST_CHECK_EQUAL(landmarkPair.second.observations.size(), expected.observations.size());
+                for (const auto& observationPair : landmarkPair.second.observations)
+                {
+                    BOOST_CHECK(expected.observations.count(observationPair.first));
+                    BOOST_CHECK_EQUAL(observationPair.second.id_feat, UndefinedIndexT);
+                }
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(SfMData_IO_JSON_STREAMING)
+{
+    sfmData::SfMData sfmData = createTestScene(5, 6, false);
+    sfmData.addFeaturesFolder("features \"quoted\"");
+    sfmData.addMatchesFolder("matches");
+    sfmData.getViews().at(1)->getImage().addMetadata("Exif:Comment", "caf\xc3\xa9\ttab\\");
+    for (IndexT landmarkId = 1; landmarkId < 50; ++landmarkId)
+    {
+        sfmData::Landmark& landmark = sfmData.getLandmarks()[landmarkId];
+        landmark.X = Vec3(0.1 * landmarkId, -1e-7 * landmarkId, 1e9 * landmarkId);
+        landmark.descType = feature::EImageDescriberType::SIFT;
+        for (IndexT viewId = landmarkId % 2; viewId < 5; viewId += 2)
+            landmark.observations[viewId] = sfmData::Observation(Vec2(landmarkId, viewId), landmarkId, 0.5);
+    }
+
+    // reference: the whole tree written by bpt::write_json
+    bpt::ptree fileTree;
+    saveMatrix("version",
+               Vec3i(ALICEVISION_SFMDATAIO_VERSION_MAJOR, ALICEVISION_SFMDATAIO_VERSION_MINOR, ALICEVISION_SFMDATAIO_VERSION_REVISION),
+               fileTree);
+    {
+        bpt::ptree featuresFoldersTree, matchesFoldersTree, viewsTree, intrinsicsTree, posesTree, structureTree;
+        for (const std::string& folder : sfmData.getRelativeFeaturesFolders())
+            featuresFoldersTree.push_back(std::make_pair("", bpt::ptree(folder)));
+        for (const std::string& folder : sfmData.getRelativeMatchesFolders())
+            matchesFoldersTree.push_back(std::make_pair("", bpt::ptree(folder)));
+        for (const auto& viewPair : sfmData.getViews())
+            saveView("", *viewPair.second, viewsTree);
+        for (const auto& intrinsicPair : sfmData.getIntrinsics())
+            saveIntrinsic("", intrinsicPair.first, intrinsicPair.second, intrinsicsTree);
+        for (const auto& posePair : sfmData.getPoses())
+        {
+            bpt::ptree poseTree;
+            poseTree.put("poseId", posePair.first);
+            saveCameraPose("pose", posePair.second, poseTree);
+            posesTree.push_back(std::make_pair("", poseTree));
+        }
+        for (const auto& landmarkPair : sfmData.getLandmarks())
+            saveLandmark("", landmarkPair.first, landmarkPair.second, structureTree);
+
+        fileTree.add_child("featuresFolders", featuresFoldersTree);
+        fileTree.add_child("matchesFolders", matchesFoldersTree);
+        fileTree.add_child("views", viewsTree);
+        fileTree.add_child("intrinsics", intrinsicsTree);
+        fileTree.add_child("poses", posesTree);
+        fileTree.add_child("structure", structureTree);
+    }
+    std::ostringstream expected;
+    bpt::write_json(expected, fileTree);
+
+    // streamed output
+    const std::string filename = "SAVE_LOAD_STREAMING.sfm";
+    BOOST_CHECK(saveJSON(sfmData, filename, ALL));
+    std::ifstream stream(filename, std::ios::binary);
+    const std::string written((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    BOOST_CHECK(written == expected.str());
+
+    // streamed input
+    sfmData::SfMData sfmDataLoad;
+    BOOST_CHECK(loadJSON(sfmDataLoad, filename, ALL));
+    BOOST_CHECK(sfmDataLoad == sfmData);
+    BOOST_CHECK(sfmDataLoad.getRelativeFeaturesFolders() == sfmData.getRelativeFeaturesFolders());
+    BOOST_CHECK_EQUAL(sfmDataLoad.getViews().at(1)->getImage().getMetadata().at("Exif:Comment"), "caf\xc3\xa9\ttab\\");
+
+    // only the requested sections
+    sfmData::SfMData sfmDataStructure;
+    BOOST_CHECK(loadJSON(sfmDataStructure, filename, ESfMData(STRUCTURE | OBSERVATIONS_WITH_FEATURES)));
+    BOOST_CHECK(sfmDataStructure.getViews().empty());
+    BOOST_CHECK(sfmDataStructure.getIntrinsics().empty());
+    BOOST_CHECK(sfmDataStructure.getLandmarks() == sfmData.getLandmarks());
+
+    // invalid files
+    {
+        std::ofstream truncated("SAVE_LOAD_TRUNCATED.sfm");
+        truncated << written.substr(0, written.size() / 2);
+    }
+    BOOST_CHECK_THROW(loadJSON(sfmDataLoad, "SAVE_LOAD_TRUNCATED.sfm", ALL), bpt::json_parser::json_parser_error);
+    BOOST_CHECK_THROW(loadJSON(sfmDataLoad, "SAVE_LOAD_MISSING.sfm", ALL), bpt::json_parser::json_parser_error);
+}
+
 /*
 BOOST_AUTO_TEST_CASE(SfMData_IO_BigFile) {
   const int nbViews = 1000;
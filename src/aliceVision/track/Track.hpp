@@ -8,13 +8,16 @@
 #pragma once
 
 #include <aliceVision/config.hpp>
+#include <aliceVision/types.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 #include <aliceVision/matching/IndMatch.hpp>
 #include <aliceVision/stl/FlatMap.hpp>
 #include <aliceVision/stl/FlatSet.hpp>
 
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <iterator>
 #include <functional>
 #include <vector>
 #include <set>
@@ -80,6 +83,110 @@ struct Track
 
 /// A track is a collection of {trackId, Track}
 using TracksMap = stl::flat_map<std::size_t, Track>;
+
+/**
+ * @brief Flat storage of a set of tracks (compressed sparse rows).
+ * The observations of the track t are in [offsets[t], offsets[t+1]), sorted by view id.
+ */
+struct FlatTracks
+{
+    /// first observation of each track, the last value is the number of observations
+    std::vector<std::size_t> offsets{0};
+    /// view id of each observation
+    std::vector<IndexT> viewIds;
+    /// feature id of each observation
+    std::vector<IndexT> featureIds;
+    /// descriptor type of each track
+    std::vector<feature::EImageDescriberType> descTypes;
+
+    std::size_t nbTracks() const { return descTypes.size(); }
+
+    std::size_t nbObservations() const { return viewIds.size(); }
+
+    std::size_t trackLength(std::size_t trackId) const { return offsets[trackId + 1] - offsets[trackId]; }
+
+    /**
+     * @brief Find the observation of a track in a view (the first one if the track has several features in the view).
+     * @return the index of the observation, or UndefinedIndexT if the track is not visible in the view
+     */
+    std::size_t findObservation(std::size_t trackId, IndexT viewId) const
+    {
+        const auto first = viewIds.begin() + offsets[trackId];
+        const auto last = viewIds.begin() + offsets[trackId + 1];
+        const auto it = std::lower_bound(first, last, viewId);
+        if (it == last || *it != viewId)
+            return UndefinedIndexT;
+        return std::distance(viewIds.begin(), it);
+    }
+
+    /**
+     * @brief The observations of a track are sorted by view id, a track may have several features in the same view.
+     * @return true if the observation is the first one of the track in its view
+     */
+    bool isFirstInView(std::size_t trackId, std::size_t observation) const
+    {
+        return observation == offsets[trackId] || viewIds[observation - 1] != viewIds[observation];
+    }
+
+    void clear()
+    {
+        offsets.assign(1, 0);
+        viewIds.clear();
+        featureIds.clear();
+        descTypes.clear();
+    }
+};
+
+/**
+ * @brief Reverse index of FlatTracks: the tracks visible in each view (compressed sparse rows).
+ * The views are indexed by their rank in the sorted viewIds, the observations of the i-th view
+ * are in [offsets[i], offsets[i+1]), sorted by track id. The track ids are the dense indexes of FlatTracks.
+ */
+struct FlatTracksPerView
+{
+    /// sorted ids of the views with at least one track
+    std::vector<IndexT> viewIds;
+    /// first observation of each view, the last value is the number of observations
+    std::vector<std::size_t> offsets{0};
+    /// track id of each observation
+    std::vector<std::uint32_t> trackIds;
+    /// feature id of each observation
+    std::vector<IndexT> featureIds;
+
+    std::size_t nbViews() const { return viewIds.size(); }
+
+    std::size_t nbObservations() const { return trackIds.size(); }
+
+    /**
+     * @return the [begin, end[ range of the observations of a view, empty if the view has no track
+     */
+    std::pair<std::size_t, std::size_t> getObservations(IndexT viewId) const
+    {
+        const auto it = std::lower_bound(viewIds.begin(), viewIds.end(), viewId);
+        if (it == viewIds.end() || *it != viewId)
+            return {0, 0};
+        const std::size_t viewIndex = std::distance(viewIds.begin(), it);
+        return {offsets[viewIndex], offsets[viewIndex + 1]};
+    }
+
+    /**
+     * @return the number of tracks visible in a view
+     */
+    std::size_t nbTracks(IndexT viewId) const
+    {
+        const std::pair<std::size_t, std::size_t> observations = getObservations(viewId);
+        return observations.second - observations.first;
+    }
+
+    void clear()
+    {
+        viewIds.clear();
+        offsets.assign(1, 0);
+        trackIds.clear();
+        featureIds.clear();
+    }
+};
+
 using TrackIdSet = std::vector<std::size_t>;
 
 /**
@@ -6,36 +6,335 @@
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
 #include "TracksBuilder.hpp"
+#include "tracksUtils.hpp"
 
-#include <lemon/list_graph.h>
-#include <lemon/unionfind.h>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
 
 namespace aliceVision {
 namespace track {
 
 using namespace aliceVision::matching;
-using namespace lemon;
 
-/// IndexedFeaturePair is: map<viewId, keypointId>
-using IndexedFeaturePair = std::pair<std::size_t, KeypointId>;
-using IndexMap = lemon::ListDigraph::NodeMap<std::size_t>;
-using UnionFindObject = lemon::UnionFindEnum<IndexMap>;
+namespace {
 
-using MapNodeToIndex = stl::flat_map<lemon::ListDigraph::Node, IndexedFeaturePair>;
-using MapIndexToNode = stl::flat_map<IndexedFeaturePair, lemon::ListDigraph::Node>;
+/// maximum number of matches processed by one task
+const std::size_t matchesChunkSize = 1 << 16;
 
-struct TracksBuilderData
+/**
+ * @brief Lock-free concurrent union-find.
+ * The root of each set is always its smallest element, so the result does not depend on the
+ * order of the unions (nor on the number of threads).
+ */
+class ConcurrentUnionFind
+{
+  public:
+    explicit ConcurrentUnionFind(std::size_t size)
+      : _parents(size)
+    {
+#pragma omp parallel for
+        for (std::ptrdiff_t i = 0; i < std::ptrdiff_t(size); ++i)
+            _parents[i].store(IndexT(i), std::memory_order_relaxed);
+    }
+
+    IndexT find(IndexT x)
+    {
+        while (true)
+        {
+            IndexT parent = _parents[x].load(std::memory_order_relaxed);
+            if (parent == x)
+                return x;
+
+            // path halving: a parent is always smaller than its child, so there is no cycle
+            const IndexT grandParent = _parents[parent].load(std::memory_order_relaxed);
+            if (parent != grandParent)
+                _parents[x].compare_exchange_weak(parent, grandParent, std::memory_order_relaxed);
+            x = grandParent;
+        }
+    }
+
+    void join(IndexT a, IndexT b)
+    {
+        while (true)
+        {
+            a = find(a);
+            b = find(b);
+            if (a == b)
+                return;
+
+            // link the biggest root to the smallest one, fails if the root has been linked meanwhile
+            if (a < b)
+                std::swap(a, b);
+            IndexT expected = a;
+            if (_parents[a].compare_exchange_strong(expected, b, std::memory_order_relaxed))
+                return;
+        }
+    }
+
+  private:
+    std::vector<std::atomic<IndexT>> _parents;
+};
+
+/// contiguous range of the dense index space used by the features of a (view, descType)
+struct FeaturesRange
+{
+    IndexT viewId;
+    feature::EImageDescriberType descType;
+    std::size_t offset;
+    std::size_t size;
+};
+
+/// matches between two views for a given descriptor type
+struct MatchesList
 {
-    /// graph container to create the node
-    lemon::ListDigraph graph;
-    /// node to index map
-    MapNodeToIndex map_nodeToIndex;
-    std::unique_ptr<IndexMap> index;
-    std::unique_ptr<UnionFindObject> tracksUF;
+    IndexT I;
+    IndexT J;
+    feature::EImageDescriberType descType;
+    const IndMatches* matches;
+    std::size_t offsetI = 0;
+    std::size_t offsetJ = 0;
+};
+
+/// identifier of the matches of an image pair for a given descriptor type
+using PairKey = std::tuple<IndexT, IndexT, feature::EImageDescriberType>;
+
+/// signature of the matches of a processed image pair, to detect matches modified since the last build
+struct PairSignature
+{
+    std::uint64_t nbMatches = 0;
+    std::uint64_t hash = 0;
+
+    bool operator==(const PairSignature& other) const { return nbMatches == other.nbMatches && hash == other.hash; }
+    bool operator!=(const PairSignature& other) const { return !(*this == other); }
+};
+
+constexpr char tracksStateMagic[8] = {'A', 'V', 'T', 'R', 'K', 'U', 'F', '\0'};
+constexpr std::uint32_t tracksStateVersion = 1;
+
+/// FNV-1a hash of the matches
+std::uint64_t hashMatches(const IndMatches& matches)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const IndMatch& m : matches)
+    {
+        for (const std::uint64_t value : {std::uint64_t(m._i), std::uint64_t(m._j)})
+        {
+            hash ^= value;
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+template<typename T>
+void writeValue(std::ostream& os, const T& value)
+{
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+void readValue(std::istream& is, T& value)
+{
+    is.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+template<typename T>
+void writeVector(std::ostream& os, const std::vector<T>& values)
+{
+    os.write(reinterpret_cast<const char*>(values.data()), std::streamsize(values.size() * sizeof(T)));
+}
+
+template<typename T>
+void readVector(std::istream& is, std::vector<T>& values, std::size_t size)
+{
+    values.resize(size);
+    is.read(reinterpret_cast<char*>(values.data()), std::streamsize(size * sizeof(T)));
+}
+
+/**
+ * @brief Merge the given matches into the tracks.
+ * The tracks are equivalent to the matches that have been used to build them: the features of a track
+ * are linked again in the union-find, so merging new matches into tracks gives the same tracks
+ * (and the same track ids) as building them from all the matches at once.
+ * @param[in] matchesLists matches to merge
+ * @param[in,out] tracks unfiltered tracks (can be empty)
+ */
+void mergeMatches(std::vector<MatchesList>& matchesLists, FlatTracks& tracks)
+{
+    // number of features referenced in each (view, descType)
+    std::vector<std::pair<std::size_t, std::size_t>> maxFeatures(matchesLists.size());
+
+#pragma omp parallel for schedule(dynamic)
+    for (std::ptrdiff_t l = 0; l < std::ptrdiff_t(matchesLists.size()); ++l)
+    {
+        std::size_t maxI = 0;
+        std::size_t maxJ = 0;
+        for (const IndMatch& m : *matchesLists[l].matches)
+        {
+            maxI = std::max(maxI, std::size_t(m._i) + 1);
+            maxJ = std::max(maxJ, std::size_t(m._j) + 1);
+        }
+        maxFeatures[l] = std::make_pair(maxI, maxJ);
+    }
+
+    std::map<std::pair<IndexT, feature::EImageDescriberType>, std::size_t> rangeSizes;
+    for (std::size_t l = 0; l < matchesLists.size(); ++l)
+    {
+        std::size_t& sizeI = rangeSizes[std::make_pair(matchesLists[l].I, matchesLists[l].descType)];
+        sizeI = std::max(sizeI, maxFeatures[l].first);
+        std::size_t& sizeJ = rangeSizes[std::make_pair(matchesLists[l].J, matchesLists[l].descType)];
+        sizeJ = std::max(sizeJ, maxFeatures[l].second);
+    }
+
+    // all the observations of the previous tracks are matched features
+    for (std::size_t t = 0; t < tracks.nbTracks(); ++t)
+    {
+        for (std::size_t k = tracks.offsets[t]; k < tracks.offsets[t + 1]; ++k)
+        {
+            std::size_t& size = rangeSizes[std::make_pair(tracks.viewIds[k], tracks.descTypes[t])];
+            size = std::max(size, std::size_t(tracks.featureIds[k]) + 1);
+        }
+    }
+
+    // dense index space sorted by view: the observations of a track are sorted by view
+    std::vector<FeaturesRange> ranges;
+    std::map<std::pair<IndexT, feature::EImageDescriberType>, std::size_t> rangeOffsets;
+    std::size_t nbNodes = 0;
+    for (const auto& rangeSize : rangeSizes)
+    {
+        ranges.push_back({rangeSize.first.first, rangeSize.first.second, nbNodes, rangeSize.second});
+        rangeOffsets[rangeSize.first] = nbNodes;
+        nbNodes += rangeSize.second;
+    }
+
+    if (nbNodes >= std::size_t(UndefinedIndexT))
+        throw std::runtime_error("TracksBuilder: too many features (" + std::to_string(nbNodes) + ") for the tracks index space.");
+
+    // split the matches in chunks of similar size
+    std::vector<std::pair<std::size_t, std::size_t>> chunks;  // (matches list, first match)
+    for (std::size_t l = 0; l < matchesLists.size(); ++l)
+    {
+        MatchesList& list = matchesLists[l];
+        list.offsetI = rangeOffsets.at(std::make_pair(list.I, list.descType));
+        list.offsetJ = rangeOffsets.at(std::make_pair(list.J, list.descType));
+
+        for (std::size_t begin = 0; begin < list.matches->size(); begin += matchesChunkSize)
+            chunks.emplace_back(l, begin);
+    }
+
+    // union of all the matched features
+    ConcurrentUnionFind unionFind(nbNodes);
+    std::vector<std::atomic<bool>> matched(nbNodes);
+
+    // link the observations of each previous track to its first observation
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (std::ptrdiff_t t = 0; t < std::ptrdiff_t(tracks.nbTracks()); ++t)
+    {
+        IndexT firstNode = UndefinedIndexT;
+        for (std::size_t k = tracks.offsets[t]; k < tracks.offsets[t + 1]; ++k)
+        {
+            const IndexT node = IndexT(rangeOffsets.at(std::make_pair(tracks.viewIds[k], tracks.descTypes[t])) + tracks.featureIds[k]);
+            matched[node].store(true, std::memory_order_relaxed);
+            if (firstNode == UndefinedIndexT)
+                firstNode = node;
+            else
+                unionFind.join(firstNode, node);
+        }
+    }
+
+#pragma omp parallel for schedule(dynamic)
+    for (std::ptrdiff_t c = 0; c < std::ptrdiff_t(chunks.size()); ++c)
+    {
+        const MatchesList& list = matchesLists[chunks[c].first];
+        const std::size_t begin = chunks[c].second;
+        const std::size_t end = std::min(begin + matchesChunkSize, list.matches->size());
+
+        for (std::size_t k = begin; k < end; ++k)
+        {
+            const IndMatch& m = (*list.matches)[k];
+            const IndexT nodeI = IndexT(list.offsetI + m._i);
+            const IndexT nodeJ = IndexT(list.offsetJ + m._j);
+            matched[nodeI].store(true, std::memory_order_relaxed);
+            matched[nodeJ].store(true, std::memory_order_relaxed);
+            unionFind.join(nodeI, nodeJ);
+        }
+    }
+
+    // track root of each matched feature
+    std::vector<IndexT> roots(nbNodes, UndefinedIndexT);
+
+#pragma omp parallel for
+    for (std::ptrdiff_t i = 0; i < std::ptrdiff_t(nbNodes); ++i)
+    {
+        if (matched[i].load(std::memory_order_relaxed))
+            roots[i] = unionFind.find(IndexT(i));
+    }
 
-    const UnionFindObject& getUnionFindEnum() const { return *tracksUF; }
+    // track ids sorted by root, i.e. by first observation
+    std::vector<IndexT> trackIds(nbNodes, UndefinedIndexT);
+    std::size_t nbTracks = 0;
+    for (std::size_t i = 0; i < nbNodes; ++i)
+    {
+        if (roots[i] == IndexT(i))
+            trackIds[i] = IndexT(nbTracks++);
+    }
+
+    // CSR structure
+    tracks.clear();
+    tracks.offsets.assign(nbTracks + 1, 0);
+    tracks.descTypes.resize(nbTracks);
+    for (const FeaturesRange& range : ranges)
+    {
+        for (std::size_t i = range.offset; i < range.offset + range.size; ++i)
+        {
+            if (roots[i] == UndefinedIndexT)
+                continue;
+            const IndexT trackId = trackIds[roots[i]];
+            ++tracks.offsets[trackId + 1];
+            // all descType inside the track will be the same
+            tracks.descTypes[trackId] = range.descType;
+        }
+    }
+
+    for (std::size_t t = 0; t < nbTracks; ++t)
+        tracks.offsets[t + 1] += tracks.offsets[t];
+
+    tracks.viewIds.resize(tracks.offsets.back());
+    tracks.featureIds.resize(tracks.offsets.back());
+
+    std::vector<std::size_t> positions(tracks.offsets.begin(), tracks.offsets.end() - 1);
+    for (const FeaturesRange& range : ranges)
+    {
+        for (std::size_t i = range.offset; i < range.offset + range.size; ++i)
+        {
+            if (roots[i] == UndefinedIndexT)
+                continue;
+            const std::size_t position = positions[trackIds[roots[i]]]++;
+            tracks.viewIds[position] = range.viewId;
+            tracks.featureIds[position] = IndexT(i - range.offset);
+        }
+    }
+}
 
-    const MapNodeToIndex& getReverseMap() const { return map_nodeToIndex; }
+}  // namespace
+
+struct TracksBuilderData
+{
+    FlatTracks tracks;
+    /// matches already merged in the tracks
+    std::map<PairKey, PairSignature> processedPairs;
+    /// the tracks have been filtered, they cannot be updated anymore
+    bool filtered = false;
 };
 
 TracksBuilder::TracksBuilder() { _d.reset(new TracksBuilderData()); }
@@ -44,74 +343,155 @@ TracksBuilder::~TracksBuilder() = default;
 
 void TracksBuilder::build(const PairwiseMatches& pairwiseMatches)
 {
-    typedef std::set<IndexedFeaturePair> SetIndexedPair;
+    _d.reset(new TracksBuilderData());
+    update(pairwiseMatches);
+}
 
-    // set of all features of all images: (imageIndex, featureIndex)
-    SetIndexedPair allFeatures;
+bool TracksBuilder::update(const PairwiseMatches& pairwiseMatches)
+{
+    if (_d->filtered)
+        throw std::runtime_error("TracksBuilder: filtered tracks cannot be updated with new matches.");
 
-    // for each couple of images make the union according the pair matches
+    std::vector<MatchesList> matchesLists;
     for (const auto& matchesPerDescIt : pairwiseMatches)
     {
-        const std::size_t& I = matchesPerDescIt.first.first;
-        const std::size_t& J = matchesPerDescIt.first.second;
-        const MatchesPerDescType& matchesPerDesc = matchesPerDescIt.second;
-
-        for (const auto& matchesIt : matchesPerDesc)
+        for (const auto& matchesIt : matchesPerDescIt.second)
         {
-            const feature::EImageDescriberType descType = matchesIt.first;
-            const IndMatches& matches = matchesIt.second;
-            // we have correspondences between I and J image index.
-            for (const IndMatch& m : matches)
-            {
-                IndexedFeaturePair pairI(I, KeypointId(descType, m._i));
-                IndexedFeaturePair pairJ(J, KeypointId(descType, m._j));
-                allFeatures.insert(pairI);
-                allFeatures.insert(pairJ);
-            }
+            if (!matchesIt.second.empty())
+                matchesLists.push_back({matchesPerDescIt.first.first, matchesPerDescIt.first.second, matchesIt.first, &matchesIt.second});
         }
     }
 
-    // build the node indirection for each referenced feature
-    MapIndexToNode map_indexToNode;
-    map_indexToNode.reserve(allFeatures.size());
-    _d->map_nodeToIndex.reserve(allFeatures.size());
+    std::vector<PairSignature> signatures(matchesLists.size());
+
+#pragma omp parallel for schedule(dynamic)
+    for (std::ptrdiff_t l = 0; l < std::ptrdiff_t(matchesLists.size()); ++l)
+        signatures[l] = {matchesLists[l].matches->size(), hashMatches(*matchesLists[l].matches)};
 
-    for (const IndexedFeaturePair& featPair : allFeatures)
+    // the processed pairs must still be part of the matches, unchanged
+    std::size_t nbProcessedPairs = 0;
+    bool validState = true;
+    for (std::size_t l = 0; l < matchesLists.size() && validState; ++l)
     {
-        lemon::ListDigraph::Node node = _d->graph.addNode();
-        map_indexToNode.insert(std::make_pair(featPair, node));
-        _d->map_nodeToIndex.insert(std::make_pair(node, featPair));
+        const auto it = _d->processedPairs.find(PairKey(matchesLists[l].I, matchesLists[l].J, matchesLists[l].descType));
+        if (it == _d->processedPairs.end())
+            continue;
+        validState = (it->second == signatures[l]);
+        ++nbProcessedPairs;
     }
+    validState = validState && (nbProcessedPairs == _d->processedPairs.size());
 
-    // add the element of myset to the UnionFind insert method.
-    _d->index.reset(new IndexMap(_d->graph));
-    _d->tracksUF.reset(new UnionFindObject(*_d->index));
+    if (!validState)
+    {
+        _d->tracks.clear();
+        _d->processedPairs.clear();
+    }
 
-    for (ListDigraph::NodeIt it(_d->graph); it != INVALID; ++it)
+    // only merge the matches of the new pairs
+    std::vector<MatchesList> newMatchesLists;
+    newMatchesLists.reserve(matchesLists.size() - (validState ? nbProcessedPairs : 0));
+    for (std::size_t l = 0; l < matchesLists.size(); ++l)
     {
-        _d->tracksUF->insert(it);
+        const auto inserted = _d->processedPairs.emplace(PairKey(matchesLists[l].I, matchesLists[l].J, matchesLists[l].descType), signatures[l]);
+        if (inserted.second)
+            newMatchesLists.push_back(matchesLists[l]);
     }
 
-    // make the union according the pair matches
-    for (const auto& matchesPerDescIt : pairwiseMatches)
+    mergeMatches(newMatchesLists, _d->tracks);
+
+    return validState;
+}
+
+std::size_t TracksBuilder::nbProcessedPairs() const { return _d->processedPairs.size(); }
+
+void TracksBuilder::saveState(const std::string& filepath) const
+{
+    if (_d->filtered)
+        throw std::runtime_error("TracksBuilder: the state of filtered tracks cannot be saved.");
+
+    std::ofstream stream(filepath, std::ios::binary | std::ios::trunc);
+    if (!stream.is_open())
+        throw std::runtime_error("TracksBuilder: unable to open the tracks state file '" + filepath + "'.");
+
+    const FlatTracks& tracks = _d->tracks;
+
+    stream.write(tracksStateMagic, sizeof(tracksStateMagic));
+    writeValue(stream, tracksStateVersion);
+    writeValue(stream, std::uint64_t(_d->processedPairs.size()));
+    writeValue(stream, std::uint64_t(tracks.nbTracks()));
+    writeValue(stream, std::uint64_t(tracks.nbObservations()));
+
+    for (const auto& pair : _d->processedPairs)
     {
-        const std::size_t& I = matchesPerDescIt.first.first;
-        const std::size_t& J = matchesPerDescIt.first.second;
-        const MatchesPerDescType& matchesPerDesc = matchesPerDescIt.second;
+        writeValue(stream, std::uint32_t(std::get<0>(pair.first)));
+        writeValue(stream, std::uint32_t(std::get<1>(pair.first)));
+        writeValue(stream, std::uint32_t(std::get<2>(pair.first)));
+        writeValue(stream, pair.second.nbMatches);
+        writeValue(stream, pair.second.hash);
+    }
 
-        for (const auto& matchesIt : matchesPerDesc)
-        {
-            const feature::EImageDescriberType descType = matchesIt.first;
-            const IndMatches& matches = matchesIt.second;
-            // we have correspondences between I and J image index.
-            for (const IndMatch& m : matches)
-            {
-                IndexedFeaturePair pairI(I, KeypointId(descType, m._i));
-                IndexedFeaturePair pairJ(J, KeypointId(descType, m._j));
-                _d->tracksUF->join(map_indexToNode[pairI], map_indexToNode[pairJ]);
-            }
-        }
+    writeVector(stream, std::vector<std::uint64_t>(tracks.offsets.begin(), tracks.offsets.end()));
+    std::vector<std::uint32_t> descTypes(tracks.descTypes.size());
+    std::transform(tracks.descTypes.begin(), tracks.descTypes.end(), descTypes.begin(), [](feature::EImageDescriberType d) { return std::uint32_t(d); });
+    writeVector(stream, descTypes);
+    writeVector(stream, tracks.viewIds);
+    writeVector(stream, tracks.featureIds);
+
+    if (!stream.good())
+        throw std::runtime_error("TracksBuilder: unable to write the tracks state file '" + filepath + "'.");
+}
+
+void TracksBuilder::loadState(const std::string& filepath)
+{
+    std::ifstream stream(filepath, std::ios::binary);
+    if (!stream.is_open())
+        throw std::runtime_error("TracksBuilder: unable to open the tracks state file '" + filepath + "'.");
+
+    char magic[sizeof(tracksStateMagic)];
+    std::uint32_t version = 0;
+    std::uint64_t nbPairs = 0;
+    std::uint64_t nbTracks = 0;
+    std::uint64_t nbObservations = 0;
+
+    stream.read(magic, sizeof(magic));
+    readValue(stream, version);
+    if (!stream.good() || std::memcmp(magic, tracksStateMagic, sizeof(magic)) != 0 || version != tracksStateVersion)
+        throw std::runtime_error("TracksBuilder: '" + filepath + "' is not a valid tracks state file.");
+
+    readValue(stream, nbPairs);
+    readValue(stream, nbTracks);
+    readValue(stream, nbObservations);
+
+    std::unique_ptr<TracksBuilderData> d(new TracksBuilderData());
+
+    for (std::uint64_t p = 0; p < nbPairs && stream.good(); ++p)
+    {
+        std::uint32_t I, J, descType;
+        PairSignature signature;
+        readValue(stream, I);
+        readValue(stream, J);
+        readValue(stream, descType);
+        readValue(stream, signature.nbMatches);
+        readValue(stream, signature.hash);
+        d->processedPairs.emplace_hint(d->processedPairs.end(), PairKey(I, J, feature::EImageDescriberType(descType)), signature);
     }
+
+    FlatTracks& tracks = d->tracks;
+    std::vector<std::uint64_t> offsets;
+    std::vector<std::uint32_t> descTypes;
+    readVector(stream, offsets, nbTracks + 1);
+    readVector(stream, descTypes, nbTracks);
+    readVector(stream, tracks.viewIds, nbObservations);
+    readVector(stream, tracks.featureIds, nbObservations);
+
+    if (!stream.good() || offsets.front() != 0 || offsets.back() != nbObservations || !std::is_sorted(offsets.begin(), offsets.end()))
+        throw std::runtime_error("TracksBuilder: the tracks state file '" + filepath + "' is corrupted.");
+
+    tracks.offsets.assign(offsets.begin(), offsets.end());
+    tracks.descTypes.resize(nbTracks);
+    std::transform(descTypes.begin(), descTypes.end(), tracks.descTypes.begin(), [](std::uint32_t d) { return feature::EImageDescriberType(d); });
+
+    std::swap(_d, d);
 }
 
 void TracksBuilder::filter(bool clearForks, std::size_t minTrackLength, bool multithreaded)
@@ -122,82 +502,82 @@ void TracksBuilder::filter(bool clearForks, std::size_t minTrackLength, bool mul
     if (!clearForks && minTrackLength == 0)
         return;
 
-    std::set<int> set_classToErase;
+    FlatTracks& tracks = _d->tracks;
+    const std::size_t nbTracks = tracks.nbTracks();
+    std::vector<unsigned char> keep(nbTracks, 0);
 
-#pragma omp parallel if (multithreaded)
-    for (lemon::UnionFindEnum<IndexMap>::ClassIt cit(*_d->tracksUF); cit != INVALID; ++cit)
+#pragma omp parallel for if (multithreaded)
+    for (std::ptrdiff_t t = 0; t < std::ptrdiff_t(nbTracks); ++t)
     {
-#pragma omp single nowait
+        // observations are sorted by view: the same view is repeated in consecutive observations
+        std::size_t nbViews = 0;
+        for (std::size_t k = tracks.offsets[t]; k < tracks.offsets[t + 1]; ++k)
         {
-            std::size_t cpt = 0;
-            std::set<std::size_t> myset;
-            for (lemon::UnionFindEnum<IndexMap>::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
-            {
-                myset.insert(_d->map_nodeToIndex[iit].first);
-                ++cpt;
-            }
-            if ((clearForks && myset.size() != cpt) || myset.size() < minTrackLength)
-            {
-#pragma omp critical
-                set_classToErase.insert(cit.operator int());
-            }
+            if (k == tracks.offsets[t] || tracks.viewIds[k] != tracks.viewIds[k - 1])
+                ++nbViews;
         }
+
+        const bool hasFork = (nbViews != tracks.trackLength(t));
+        keep[t] = !((clearForks && hasFork) || nbViews < minTrackLength);
+    }
+
+    // compact the kept tracks
+    FlatTracks filtered;
+    filtered.offsets.reserve(nbTracks + 1);
+    for (std::size_t t = 0; t < nbTracks; ++t)
+    {
+        if (!keep[t])
+            continue;
+        filtered.offsets.push_back(filtered.offsets.back() + tracks.trackLength(t));
+        filtered.descTypes.push_back(tracks.descTypes[t]);
     }
 
-    std::for_each(set_classToErase.begin(), set_classToErase.end(), [&](int toErase) { _d->tracksUF->eraseClass(toErase); });
+    filtered.viewIds.resize(filtered.offsets.back());
+    filtered.featureIds.resize(filtered.offsets.back());
+
+    std::vector<std::size_t> keptTracks;
+    keptTracks.reserve(filtered.nbTracks());
+    for (std::size_t t = 0; t < nbTracks; ++t)
+    {
+        if (keep[t])
+            keptTracks.push_back(t);
+    }
+
+#pragma omp parallel for if (multithreaded)
+    for (std::ptrdiff_t f = 0; f < std::ptrdiff_t(keptTracks.size()); ++f)
+    {
+        const std::size_t t = keptTracks[f];
+        std::copy(tracks.viewIds.begin() + tracks.offsets[t], tracks.viewIds.begin() + tracks.offsets[t + 1], filtered.viewIds.begin() + filtered.offsets[f]);
+        std::copy(
+          tracks.featureIds.begin() + tracks.offsets[t], tracks.featureIds.begin() + tracks.offsets[t + 1], filtered.featureIds.begin() + filtered.offsets[f]);
+    }
+
+    std::swap(tracks, filtered);
+    _d->filtered = true;
 }
 
 bool TracksBuilder::exportToStream(std::ostream& os)
 {
-    std::size_t cpt = 0;
-    for (lemon::UnionFindEnum<IndexMap>::ClassIt cit(*_d->tracksUF); cit != INVALID; ++cit)
+    const FlatTracks& tracks = _d->tracks;
+    for (std::size_t t = 0; t < tracks.nbTracks(); ++t)
     {
-        os << "Class: " << cpt++ << std::endl;
-        std::size_t cptTrackLength = 0;
-        for (lemon::UnionFindEnum<IndexMap>::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
-        {
-            ++cptTrackLength;
-        }
+        os << "Class: " << t << std::endl;
         os << "\t"
-           << "track length: " << cptTrackLength << std::endl;
+           << "track length: " << tracks.trackLength(t) << std::endl;
 
-        for (lemon::UnionFindEnum<IndexMap>::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
+        for (std::size_t k = tracks.offsets[t]; k < tracks.offsets[t + 1]; ++k)
         {
-            os << _d->map_nodeToIndex[iit].first << "  " << _d->map_nodeToIndex[iit].second << std::endl;
+            os << tracks.viewIds[k] << "  " << KeypointId(tracks.descTypes[t], tracks.featureIds[k]) << std::endl;
         }
     }
     return os.good();
 }
 
-void TracksBuilder::exportToSTL(TracksMap& allTracks) const
-{
-    allTracks.clear();
-
-    std::size_t trackIndex = 0;
-    for (lemon::UnionFindEnum<IndexMap>::ClassIt cit(*_d->tracksUF); cit != INVALID; ++cit, ++trackIndex)
-    {
-        // create the output track
-        std::pair<TracksMap::iterator, bool> ret = allTracks.insert(std::make_pair(trackIndex, Track()));
-
-        Track& outTrack = ret.first->second;
+void TracksBuilder::exportToSTL(TracksMap& allTracks) const { convertToTracksMap(_d->tracks, allTracks); }
 
-        for (lemon::UnionFindEnum<IndexMap>::ItemIt iit(*_d->tracksUF, cit); iit != INVALID; ++iit)
-        {
-            const IndexedFeaturePair& currentPair = _d->map_nodeToIndex.at(iit);
-            // all descType inside the track will be the same
-            outTrack.descType = currentPair.second.descType;
-            outTrack.featPerView[currentPair.first].featureId = currentPair.second.featIndex;
-        }
-    }
-}
+void TracksBuilder::exportToFlat(FlatTracks& allTracks) const { allTracks = _d->tracks; }
 
-std::size_t TracksBuilder::nbTracks() const
-{
-    std::size_t cpt = 0;
-    for (lemon::UnionFindEnum<IndexMap>::ClassIt cit(*_d->tracksUF); cit != lemon::INVALID; ++cit)
-        ++cpt;
-    return cpt;
-}
+std::size_t TracksBuilder::nbTracks() const { return _d->tracks.nbTracks(); }
 
 }  // namespace track
 }  // namespace aliceVision
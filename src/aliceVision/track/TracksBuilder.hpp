@@ -9,6 +9,7 @@
 #include <aliceVision/track/Track.hpp>
 
 #include <memory>
+#include <string>
 
 namespace aliceVision {
 namespace track {
@@ -29,6 +30,14 @@ struct TracksBuilderData;
  *
  * From map< [imageI,ImageJ], [indexed matches array] > it builds tracks.
  *
+ * The features are indexed in a dense (viewId, descType, featureId) index space and merged with
+ * a lock-free concurrent union-find, so all the matches are processed in parallel.
+ * The tracks are stored in a flat CSR structure (FlatTracks).
+ *
+ * The unfiltered tracks and the list of the processed image pairs can be saved (saveState) and
+ * loaded back (loadState), so the matches of new image pairs can be merged into the existing tracks
+ * (update) without merging all the matches again. The resulting tracks are identical to a full build.
+ *
  * Usage:
  * @code{.cpp}
  *  PairWiseMatches matches;
@@ -53,6 +62,35 @@ class TracksBuilder
      */
     void build(const PairwiseMatches& pairwiseMatches);
 
+    /**
+     * @brief Merge the matches of the image pairs that have not been processed yet into the current tracks.
+     *        The result is the same as build(pairwiseMatches).
+     * @param[in] pairwiseMatches All the pairWise matches, including the already processed ones
+     * @return true if the current tracks have been updated, false if they have been rebuilt from scratch
+     *         because some processed pairs are missing or have been modified in pairwiseMatches
+     * @note throw if the tracks have already been filtered
+     */
+    bool update(const PairwiseMatches& pairwiseMatches);
+
+    /**
+     * @brief Return the number of image pairs (per descriptor type) whose matches are merged in the tracks
+     */
+    std::size_t nbProcessedPairs() const;
+
+    /**
+     * @brief Save the unfiltered tracks and the processed image pairs in a binary file
+     * @param[in] filepath the tracks state file path
+     * @note throw if the tracks have already been filtered or if the file cannot be written
+     */
+    void saveState(const std::string& filepath) const;
+
+    /**
+     * @brief Load the unfiltered tracks and the processed image pairs from a binary file (see saveState)
+     * @param[in] filepath the tracks state file path
+     * @note throw if the file cannot be read
+     */
+    void loadState(const std::string& filepath);
+
     /**
      * @brief Remove bad tracks (too short or track with ids collision)
      * @param[in] clearForks: remove tracks with multiple observation in a single image
@@ -74,6 +112,11 @@ class TracksBuilder
      */
     void exportToSTL(TracksMap& allTracks) const;
 
+    /**
+     * @brief Export tracks in a flat CSR structure, the track ids are the same as in exportToSTL
+     */
+    void exportToFlat(FlatTracks& allTracks) const;
+
     /**
      * @brief Return the number of connected set in the UnionFind structure (tree forest)
      * @return number of connected set in the UnionFind structure
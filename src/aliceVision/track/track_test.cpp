@@ -9,6 +9,11 @@
 #include "aliceVision/track/tracksUtils.hpp"
 #include "aliceVision/matching/IndMatch.hpp"
 
+#include <functional>
+#include <map>
+#include <random>
+#include <set>
+#include <tuple>
 #include <vector>
 #include <utility>
 
@@ -16,6 +21,7 @@
 
 #include <boost/test/unit_test.hpp>
 #include <boost/test/tools/floating_point_comparison.hpp>
+#include <boost/filesystem.hpp>
 
 using namespace aliceVision::feature;
 using namespace aliceVision::track;
@@ -179,6 +185,157 @@ BOOST_AUTO_TEST_CASE(Track_Conflict)
     }
 }
 
+BOOST_AUTO_TEST_CASE(Track_RandomMatches)
+{
+    // compare the tracks with a simple sequential union-find on random matches (with forks)
+    std::mt19937 randomNumberGenerator(0);
+    std::uniform_int_distribution<int> featureDistribution(0, 299);
+
+    const std::size_t nbViews = 8;
+    PairwiseMatches map_pairwisematches;
+    for (std::size_t I = 0; I < nbViews; ++I)
+    {
+        for (std::size_t J = I + 1; J < nbViews; ++J)
+        {
+            std::vector<IndMatch>& matches = map_pairwisematches[std::make_pair(I, J)][EImageDescriberType::UNKNOWN];
+            for (int k = 0; k < 100; ++k)
+                matches.emplace_back(featureDistribution(randomNumberGenerator), featureDistribution(randomNumberGenerator));
+        }
+    }
+
+    // reference union-find over (viewId, featureId)
+    using Node = std::pair<std::size_t, std::size_t>;
+    std::map<Node, Node> parents;
+    std::function<Node(const Node&)> find = [&](const Node& n) -> Node {
+        const Node p = parents.emplace(n, n).first->second;
+        return (p == n) ? n : (parents[n] = find(p));
+    };
+    for (const auto& pairIt : map_pairwisematches)
+    {
+        for (const IndMatch& m : pairIt.second.at(EImageDescriberType::UNKNOWN))
+        {
+            const Node a = find(Node(pairIt.first.first, m._i));
+            const Node b = find(Node(pairIt.first.second, m._j));
+            if (a != b)
+                parents[std::max(a, b)] = std::min(a, b);
+        }
+    }
+
+    std::map<Node, std::set<Node>> referenceTracks;
+    for (const auto& parentIt : parents)
+        referenceTracks[find(parentIt.first)].insert(parentIt.first);
+
+    std::set<std::set<Node>> expectedTracks;
+    for (const auto& trackIt : referenceTracks)
+    {
+        std::set<std::size_t> views;
+        for (const Node& n : trackIt.second)
+            views.insert(n.first);
+        if (views.size() == trackIt.second.size() && views.size() >= 2)
+            expectedTracks.insert(trackIt.second);
+    }
+
+    TracksBuilder trackBuilder;
+    trackBuilder.build(map_pairwisematches);
+    BOOST_CHECK_EQUAL(referenceTracks.size(), trackBuilder.nbTracks());
+    trackBuilder.filter(true, 2);
+    BOOST_CHECK_EQUAL(expectedTracks.size(), trackBuilder.nbTracks());
+
+    TracksMap map_tracks;
+    trackBuilder.exportToSTL(map_tracks);
+    FlatTracks flatTracks;
+    trackBuilder.exportToFlat(flatTracks);
+    BOOST_CHECK_EQUAL(map_tracks.size(), flatTracks.nbTracks());
+
+    std::set<std::set<Node>> tracks;
+    for (const auto& trackIt : map_tracks)
+    {
+        std::set<Node> track;
+        for (const auto& featIt : trackIt.second.featPerView)
+            track.insert(Node(featIt.first, featIt.second.featureId));
+        tracks.insert(track);
+
+        // same track in the flat structure
+        BOOST_CHECK_EQUAL(flatTracks.trackLength(trackIt.first), track.size());
+        for (std::size_t k = flatTracks.offsets[trackIt.first]; k < flatTracks.offsets[trackIt.first + 1]; ++k)
+            BOOST_CHECK(track.count(Node(flatTracks.viewIds[k], flatTracks.featureIds[k])));
+    }
+    BOOST_CHECK(tracks == expectedTracks);
+}
+
+BOOST_AUTO_TEST_CASE(Track_IncrementalUpdate)
+{
+    // merging the matches of new views into saved tracks gives the same tracks as a full build
+    std::mt19937 randomNumberGenerator(0);
+    std::uniform_int_distribution<int> featureDistribution(0, 299);
+
+    const std::size_t nbViews = 10;
+    const std::size_t nbFirstViews = 6;
+    PairwiseMatches allMatches;
+    PairwiseMatches firstMatches;
+    for (std::size_t I = 0; I < nbViews; ++I)
+    {
+        for (std::size_t J = I + 1; J < nbViews; ++J)
+        {
+            std::vector<IndMatch>& matches = allMatches[std::make_pair(I, J)][EImageDescriberType::UNKNOWN];
+            for (int k = 0; k < 100; ++k)
+                matches.emplace_back(featureDistribution(randomNumberGenerator), featureDistribution(randomNumberGenerator));
+            if (J < nbFirstViews)
+                firstMatches[std::make_pair(I, J)] = allMatches[std::make_pair(I, J)];
+        }
+    }
+
+    // filtered tracks as (track id, descType, viewId, featureId)
+    using Observation = std::tuple<std::size_t, EImageDescriberType, std::size_t, std::size_t>;
+    const auto buildTracks = [](TracksBuilder& builder) {
+        TracksMap tracks;
+        builder.filter(true, 2);
+        builder.exportToSTL(tracks);
+        std::vector<Observation> observations;
+        for (const auto& trackIt : tracks)
+        {
+            for (const auto& featIt : trackIt.second.featPerView)
+                observations.emplace_back(trackIt.first, trackIt.second.descType, featIt.first, featIt.second.featureId);
+        }
+        return observations;
+    };
+
+    TracksBuilder fullBuilder;
+    fullBuilder.build(allMatches);
+    const std::vector<Observation> expectedTracks = buildTracks(fullBuilder);
+    BOOST_CHECK(!expectedTracks.empty());
+
+    const std::string statePath = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    {
+        TracksBuilder firstBuilder;
+        firstBuilder.build(firstMatches);
+        firstBuilder.saveState(statePath);
+        BOOST_CHECK_EQUAL(firstBuilder.nbProcessedPairs(), firstMatches.size());
+    }
+
+    TracksBuilder incrementalBuilder;
+    incrementalBuilder.loadState(statePath);
+    BOOST_CHECK(incrementalBuilder.update(allMatches));
+    BOOST_CHECK_EQUAL(incrementalBuilder.nbProcessedPairs(), allMatches.size());
+    const std::vector<Observation> incrementalTracks = buildTracks(incrementalBuilder);
+
+    BOOST_CHECK_EQUAL(expectedTracks.size(), incrementalTracks.size());
+    BOOST_CHECK(expectedTracks == incrementalTracks);
+
+    // filtered tracks cannot be updated
+    BOOST_CHECK_THROW(incrementalBuilder.update(allMatches), std::runtime_error);
+
+    // modified matches of a processed pair: the tracks are rebuilt from scratch
+    allMatches[std::make_pair(0, 1)][EImageDescriberType::UNKNOWN].pop_back();
+    TracksBuilder modifiedBuilder;
+    modifiedBuilder.loadState(statePath);
+    BOOST_CHECK(!modifiedBuilder.update(allMatches));
+    fullBuilder.build(allMatches);
+    BOOST_CHECK(buildTracks(fullBuilder) == buildTracks(modifiedBuilder));
+
+    boost::filesystem::remove(statePath);
+}
+
 BOOST_AUTO_TEST_CASE(Track_GetCommonTracksInImages)
 {
     {
@@ -227,3 +384,94 @@ BOOST_AUTO_TEST_CASE(Track_GetCommonTracksInImages)
         BOOST_CHECK_EQUAL(base.size(), set_visibleTracks.size());
     }
 }
+
+BOOST_AUTO_TEST_CASE(Track_FlatTracksPerView)
+{
+    // random tracks over views with sparse ids
+    std::mt19937 randomNumberGenerator(0);
+    std::uniform_int_distribution<int> featureDistribution(0, 199);
+
+    const std::size_t nbViews = 8;
+    PairwiseMatches pairwiseMatches;
+    for (std::size_t I = 0; I < nbViews; ++I)
+    {
+        for (std::size_t J = I + 1; J < nbViews; ++J)
+        {
+            std::vector<IndMatch>& matches = pairwiseMatches[std::make_pair(I * 1000 + 7, J * 1000 + 7)][EImageDescriberType::UNKNOWN];
+            for (int k = 0; k < 100; ++k)
+                matches.emplace_back(featureDistribution(randomNumberGenerator), featureDistribution(randomNumberGenerator));
+        }
+    }
+
+    TracksBuilder trackBuilder;
+    trackBuilder.build(pairwiseMatches);
+    trackBuilder.filter(true, 2);
+
+    TracksMap tracks;
+    trackBuilder.exportToSTL(tracks);
+    FlatTracks flatTracks;
+    trackBuilder.exportToFlat(flatTracks);
+    BOOST_REQUIRE(!tracks.empty());
+
+    // same tracks per view as the map of tracks
+    TracksPerView tracksPerView;
+    computeTracksPerView(tracks, tracksPerView);
+    FlatTracksPerView flatTracksPerView;
+    computeFlatTracksPerView(flatTracks, flatTracksPerView);
+    BOOST_CHECK_EQUAL(flatTracksPerView.nbViews(), tracksPerView.size());
+
+    TracksPerView convertedTracksPerView;
+    convertToTracksPerView(flatTracksPerView, convertedTracksPerView);
+    BOOST_CHECK(convertedTracksPerView == tracksPerView);
+
+    for (const auto& viewTracks : tracksPerView)
+    {
+        const aliceVision::IndexT viewId = static_cast<aliceVision::IndexT>(viewTracks.first);
+        const std::pair<std::size_t, std::size_t> observations = flatTracksPerView.getObservations(viewId);
+        BOOST_REQUIRE_EQUAL(observations.second - observations.first, viewTracks.second.size());
+        for (std::size_t k = observations.first; k < observations.second; ++k)
+        {
+            const std::size_t trackId = flatTracksPerView.trackIds[k];
+            BOOST_CHECK_EQUAL(flatTracksPerView.featureIds[k], tracks.at(trackId).featPerView.at(viewId).featureId);
+
+            const std::size_t observation = flatTracks.findObservation(trackId, viewId);
+            BOOST_REQUIRE(observation != aliceVision::UndefinedIndexT);
+            BOOST_CHECK_EQUAL(flatTracks.featureIds[observation], flatTracksPerView.featureIds[k]);
+        }
+    }
+    BOOST_CHECK_EQUAL(flatTracksPerView.nbTracks(3), 0);
+    BOOST_CHECK(flatTracks.findObservation(0, 3) == aliceVision::UndefinedIndexT);
+
+    // same common tracks as the map of tracks
+    for (aliceVision::IndexT I = 7; I < nbViews * 1000; I += 1000)
+    {
+        for (aliceVision::IndexT J = I + 1000; J < nbViews * 1000; J += 1000)
+        {
+            TracksMap commonTracks;
+            getCommonTracksInImagesFast({static_cast<std::size_t>(I), static_cast<std::size_t>(J)}, tracks, tracksPerView, commonTracks);
+            std::vector<CommonTrack> flatCommonTracks;
+            getCommonTracksInViews(flatTracksPerView, I, J, flatCommonTracks);
+
+            BOOST_REQUIRE_EQUAL(flatCommonTracks.size(), commonTracks.size());
+            auto commonTrackIt = commonTracks.begin();
+            for (const CommonTrack& commonTrack : flatCommonTracks)
+            {
+                BOOST_CHECK_EQUAL(commonTrack.trackId, commonTrackIt->first);
+                BOOST_CHECK_EQUAL(commonTrack.featureIdI, commonTrackIt->second.featPerView.at(I).featureId);
+                BOOST_CHECK_EQUAL(commonTrack.featureIdJ, commonTrackIt->second.featPerView.at(J).featureId);
+                ++commonTrackIt;
+            }
+        }
+    }
+
+    // conversion adapters
+    FlatTracks convertedFlatTracks;
+    convertToFlatTracks(tracks, convertedFlatTracks);
+    BOOST_CHECK(convertedFlatTracks.offsets == flatTracks.offsets);
+    BOOST_CHECK(convertedFlatTracks.viewIds == flatTracks.viewIds);
+    BOOST_CHECK(convertedFlatTracks.featureIds == flatTracks.featureIds);
+    BOOST_CHECK(convertedFlatTracks.descTypes == flatTracks.descTypes);
+
+    tracks.erase(tracks.begin());
+    BOOST_CHECK_THROW(convertToFlatTracks(tracks, convertedFlatTracks), std::runtime_error);
+}
@@ -8,6 +8,9 @@
 #include "tracksUtils.hpp"
 
 #include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
 
 namespace aliceVision {
 namespace track {
@@ -256,5 +259,143 @@ void imageIdInTracks(const TracksMap& tracks, std::set<std::size_t>& imagesId)
     }
 }
 
+void computeFlatTracksPerView(const FlatTracks& tracks, FlatTracksPerView& tracksPerView)
+{
+    if (tracks.nbTracks() > std::numeric_limits<std::uint32_t>::max())
+        throw std::runtime_error("Too many tracks for the flat tracks per view: " + std::to_string(tracks.nbTracks()));
+
+    tracksPerView.clear();
+
+    // number of observations per view, with the index of each view in the order of appearance
+    std::unordered_map<IndexT, std::size_t> viewIndexes;
+    std::vector<std::size_t> nbObservationsPerView;
+    std::vector<std::uint32_t> observationViewIndexes(tracks.nbObservations());
+    for (std::size_t t = 0; t < tracks.nbTracks(); ++t)
+    {
+        for (std::size_t k = tracks.offsets[t]; k < tracks.offsets[t + 1]; ++k)
+        {
+            const auto it = viewIndexes.emplace(tracks.viewIds[k], viewIndexes.size()).first;
+            if (it->second == nbObservationsPerView.size())
+                nbObservationsPerView.push_back(0);
+            observationViewIndexes[k] = static_cast<std::uint32_t>(it->second);
+            if (tracks.isFirstInView(t, k))
+                ++nbObservationsPerView[it->second];
+        }
+    }
+
+    // sort the views by id
+    tracksPerView.viewIds.reserve(viewIndexes.size());
+    for (const auto& viewIndex : viewIndexes)
+        tracksPerView.viewIds.push_back(viewIndex.first);
+    std::sort(tracksPerView.viewIds.begin(), tracksPerView.viewIds.end());
+
+    // first free observation of each view, in the order of appearance
+    std::vector<std::size_t> nextObservations(viewIndexes.size());
+    tracksPerView.offsets.resize(tracksPerView.viewIds.size() + 1);
+    for (std::size_t v = 0; v < tracksPerView.viewIds.size(); ++v)
+    {
+        const std::size_t viewIndex = viewIndexes.at(tracksPerView.viewIds[v]);
+        nextObservations[viewIndex] = tracksPerView.offsets[v];
+        tracksPerView.offsets[v + 1] = tracksPerView.offsets[v] + nbObservationsPerView[viewIndex];
+    }
+
+    // the tracks are visited by increasing id, so the tracks of each view are sorted
+    tracksPerView.trackIds.resize(tracksPerView.offsets.back());
+    tracksPerView.featureIds.resize(tracksPerView.offsets.back());
+    for (std::size_t t = 0; t < tracks.nbTracks(); ++t)
+    {
+        for (std::size_t k = tracks.offsets[t]; k < tracks.offsets[t + 1]; ++k)
+        {
+            if (!tracks.isFirstInView(t, k))
+                continue;
+            const std::size_t observation = nextObservations[observationViewIndexes[k]]++;
+            tracksPerView.trackIds[observation] = static_cast<std::uint32_t>(t);
+            tracksPerView.featureIds[observation] = tracks.featureIds[k];
+        }
+    }
+}
+
+void convertToTracksMap(const FlatTracks& flatTracks, TracksMap& tracks)
+{
+    tracks.clear();
+    tracks.reserve(flatTracks.nbTracks());
+
+    for (std::size_t t = 0; t < flatTracks.nbTracks(); ++t)
+    {
+        // create the output track, track ids are sorted
+        Track& track = tracks.emplace_hint(tracks.end(), t, Track())->second;
+        track.descType = flatTracks.descTypes[t];
+        track.featPerView.reserve(flatTracks.trackLength(t));
+
+        for (std::size_t k = flatTracks.offsets[t]; k < flatTracks.offsets[t + 1]; ++k)
+        {
+            // keep the first observation of a view, as a map insertion
+            track.featPerView.emplace_hint(track.featPerView.end(), flatTracks.viewIds[k], TrackItem{flatTracks.featureIds[k]});
+        }
+    }
+}
+
+void convertToFlatTracks(const TracksMap& tracks, FlatTracks& flatTracks)
+{
+    flatTracks.clear();
+    flatTracks.offsets.reserve(tracks.size() + 1);
+    flatTracks.descTypes.reserve(tracks.size());
+
+    for (const auto& trackIt : tracks)
+    {
+        if (trackIt.first != flatTracks.nbTracks())
+            throw std::runtime_error("The track ids must be dense to be converted to flat tracks, invalid track id: " + std::to_string(trackIt.first));
+
+        for (const auto& featView : trackIt.second.featPerView)
+        {
+            flatTracks.viewIds.push_back(static_cast<IndexT>(featView.first));
+            flatTracks.featureIds.push_back(static_cast<IndexT>(featView.second.featureId));
+        }
+        flatTracks.offsets.push_back(flatTracks.viewIds.size());
+        flatTracks.descTypes.push_back(trackIt.second.descType);
+    }
+}
+
+void convertToTracksPerView(const FlatTracksPerView& flatTracksPerView, TracksPerView& tracksPerView)
+{
+    tracksPerView.clear();
+    tracksPerView.reserve(flatTracksPerView.nbViews());
+
+    for (std::size_t v = 0; v < flatTracksPerView.nbViews(); ++v)
+    {
+        TrackIdSet& trackIds = tracksPerView.emplace_hint(tracksPerView.end(), flatTracksPerView.viewIds[v], TrackIdSet())->second;
+        trackIds.assign(flatTracksPerView.trackIds.begin() + flatTracksPerView.offsets[v],
+                        flatTracksPerView.trackIds.begin() + flatTracksPerView.offsets[v + 1]);
+    }
+}
+
+void getCommonTracksInViews(const FlatTracksPerView& tracksPerView, IndexT viewIdI, IndexT viewIdJ, std::vector<CommonTrack>& commonTracks)
+{
+    commonTracks.clear();
+
+    // merge of the sorted tracks of the two views
+    std::pair<std::size_t, std::size_t> observationsI = tracksPerView.getObservations(viewIdI);
+    std::pair<std::size_t, std::size_t> observationsJ = tracksPerView.getObservations(viewIdJ);
+    while (observationsI.first < observationsI.second && observationsJ.first < observationsJ.second)
+    {
+        const std::uint32_t trackIdI = tracksPerView.trackIds[observationsI.first];
+        const std::uint32_t trackIdJ = tracksPerView.trackIds[observationsJ.first];
+        if (trackIdI < trackIdJ)
+        {
+            ++observationsI.first;
+        }
+        else if (trackIdJ < trackIdI)
+        {
+            ++observationsJ.first;
+        }
+        else
+        {
+            commonTracks.push_back({trackIdI, tracksPerView.featureIds[observationsI.first], tracksPerView.featureIds[observationsJ.first]});
+            ++observationsI.first;
+            ++observationsJ.first;
+        }
+    }
+}
+
 }  // namespace track
 }  // namespace aliceVision
@@ -141,5 +141,54 @@ void imageIdInTracks(const TracksPerView& tracksPerView, std::set<std::size_t>&
  */
 void imageIdInTracks(const TracksMap& tracks, std::set<std::size_t>& imagesId);
 
+/**
+ * @brief Build the reverse index of flat tracks: the tracks visible in each view.
+ *        Only the first feature of a track in a view is indexed.
+ * @param[in] tracks all tracks of the scene, at most 2^32 tracks
+ * @param[out] tracksPerView the tracks visible in each view
+ */
+void computeFlatTracksPerView(const FlatTracks& tracks, FlatTracksPerView& tracksPerView);
+
+/**
+ * @brief Convert flat tracks to a map of tracks, the track ids are kept.
+ * @param[in] flatTracks all tracks of the scene
+ * @param[out] tracks the tracks as a map {trackId, track}
+ */
+void convertToTracksMap(const FlatTracks& flatTracks, TracksMap& tracks);
+
+/**
+ * @brief Convert a map of tracks to flat tracks.
+ * @param[in] tracks the tracks as a map {trackId, track}, with dense track ids (0 to the number of tracks - 1)
+ * @param[out] flatTracks all tracks of the scene
+ * @throw std::runtime_error if the track ids are not dense
+ */
+void convertToFlatTracks(const TracksMap& tracks, FlatTracks& flatTracks);
+
+/**
+ * @brief Convert the reverse index of flat tracks to the visible tracks per view.
+ * @param[in] flatTracksPerView the tracks visible in each view
+ * @param[out] tracksPerView the visible tracks as a map {viewID, vector<trackID>}
+ */
+void convertToTracksPerView(const FlatTracksPerView& flatTracksPerView, TracksPerView& tracksPerView);
+
+/**
+ * @brief A track visible in two views, with its feature in each view.
+ */
+struct CommonTrack
+{
+    std::uint32_t trackId;
+    IndexT featureIdI;
+    IndexT featureIdJ;
+};
+
+/**
+ * @brief Find the common tracks of two views.
+ * @param[in] tracksPerView the tracks visible in each view
+ * @param[in] viewIdI the first view
+ * @param[in] viewIdJ the second view
+ * @param[out] commonTracks the common tracks, sorted by track id
+ */
+void getCommonTracksInViews(const FlatTracksPerView& tracksPerView, IndexT viewIdI, IndexT viewIdJ, std::vector<CommonTrack>& commonTracks);
+
 }  // namespace track
 }  // namespace aliceVision
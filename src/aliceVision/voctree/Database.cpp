@@ -6,11 +6,19 @@
 
 #include "Database.hpp"
 #include <aliceVision/system/ProgressDisplay.hpp>
+#include <aliceVision/alicevision_omp.hpp>
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/tail.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <fstream>
+#include <iterator>
 #include <stdexcept>
+#include <tuple>
 #include <boost/format.hpp>
 
 namespace aliceVision {
@@ -37,32 +45,330 @@ std::ostream& operator<<(std::ostream& os, const DocMatches& matches)
     return os;
 }
 
+namespace bip = boost::interprocess;
+
+namespace {
+
+/// Identifier and version of the database files
+const char databaseMagic[8] = {'A', 'V', 'V', 'O', 'C', 'D', 'B', '\0'};
+const uint32_t databaseVersion = 1;
+
+void writeVarint(std::vector<uint8_t>& out, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint32_t readVarint(const uint8_t*& data)
+{
+    uint32_t value = 0;
+    for (int shift = 0;; shift += 7)
+    {
+        const uint8_t byte = *data++;
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (byte < 0x80)
+            return value;
+    }
+}
+
+/**
+ * @brief Call f(index, count) for each entry of a posting list.
+ */
+template<typename F>
+void decodePostings(const uint8_t* data, const uint8_t* end, F f)
+{
+    uint32_t index = 0;
+    while (data < end)
+    {
+        index += readVarint(data);
+        const uint32_t count = readVarint(data);
+        f(index, count);
+    }
+}
+
+template<typename T>
+T readValue(const uint8_t* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+/**
+ * @brief Check a table of nbLists + 1 offsets: from 0 to dataSize, in increasing order.
+ */
+bool isValidOffsets(const uint8_t* offsets, uint64_t nbLists, uint64_t dataSize)
+{
+    uint64_t previous = readValue<uint64_t>(offsets);
+    if (previous != 0)
+        return false;
+    for (uint64_t i = 1; i <= nbLists; ++i)
+    {
+        const uint64_t offset = readValue<uint64_t>(offsets + i * sizeof(uint64_t));
+        if (offset < previous || offset > dataSize)
+            return false;
+        previous = offset;
+    }
+    return previous == dataSize;
+}
+
+template<typename T>
+void writeArray(std::ofstream& out, const std::vector<T>& values)
+{
+    out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+/// Supported distances of Database::find, computed from the words shared with the query
+enum class EPostingsDistance
+{
+    CLASSIC,
+    COMMON_POINTS,
+    STRONG_COMMON_POINTS,
+    INVERSED_WEIGHTED_COMMON_POINTS,
+    /// computed with sparseDistance on the full histograms
+    HISTOGRAMS
+};
+
+EPostingsDistance getPostingsDistance(const std::string& distanceMethod)
+{
+    if (distanceMethod == "classic")
+        return EPostingsDistance::CLASSIC;
+    if (distanceMethod == "commonPoints")
+        return EPostingsDistance::COMMON_POINTS;
+    if (distanceMethod == "strongCommonPoints")
+        return EPostingsDistance::STRONG_COMMON_POINTS;
+    if (distanceMethod == "inversedWeightedCommonPoints")
+        return EPostingsDistance::INVERSED_WEIGHTED_COMMON_POINTS;
+    if (distanceMethod == "weightedStrongCommonPoints")
+        return EPostingsDistance::HISTOGRAMS;
+    throw std::invalid_argument("distance method " + distanceMethod + " unknown!");
+}
+
+/// Number of queries scored together by Database::findBatch
+constexpr std::size_t queriesBlockSize = 32;
+/// Number of documents of a block of scores (documents x queries) in Database::findBatch
+constexpr std::size_t documentsBlockSize = 4096;
+
+/// Score of a word shared by the query and a document, for the distances computed from the posting lists
+inline float wordScore(EPostingsDistance distance, uint32_t queryCount, uint32_t count, float weight)
+{
+    switch (distance)
+    {
+        case EPostingsDistance::CLASSIC:
+        case EPostingsDistance::COMMON_POINTS:
+            return static_cast<float>(std::min(queryCount, count));
+        case EPostingsDistance::STRONG_COMMON_POINTS:
+            return (queryCount == 1 && count == 1) ? 1.0f : 0.0f;
+        case EPostingsDistance::INVERSED_WEIGHTED_COMMON_POINTS:
+            return (1.f / std::min(queryCount, count)) * weight;
+        case EPostingsDistance::HISTOGRAMS:
+            break;
+    }
+    return 0.0f;
+}
+
+/**
+ * @brief Sequential reader of the posting list of a word: the postings of the mapped documents,
+ *        then the postings of the inserted documents.
+ */
+class PostingsReader
+{
+  public:
+    PostingsReader(const uint8_t* mappedBegin, const uint8_t* mappedEnd, const uint8_t* insertedBegin, const uint8_t* insertedEnd)
+      : _data{mappedBegin, insertedBegin},
+        _end{mappedEnd, insertedEnd}
+    {
+        next();
+    }
+
+    bool valid() const { return _range < 2; }
+    uint32_t index() const { return _index; }
+    uint32_t count() const { return _count; }
+
+    void next()
+    {
+        while (_range < 2 && _data[_range] == _end[_range])
+        {
+            // the indices of each list are delta encoded from 0
+            ++_range;
+            _index = 0;
+        }
+        if (_range == 2)
+            return;
+        _index += readVarint(_data[_range]);
+        _count = readVarint(_data[_range]);
+    }
+
+  private:
+    const uint8_t* _data[2];
+    const uint8_t* _end[2];
+    int _range = 0;
+    uint32_t _index = 0;
+    uint32_t _count = 0;
+};
+
+/**
+ * @brief Top N matches of a query, kept in a heap with the worst match on top.
+ *        The matches with the same score are ordered by document ID.
+ */
+class TopMatches
+{
+  public:
+    void reset(std::size_t N)
+    {
+        _N = N;
+        _heap.clear();
+        _heap.reserve(N);
+    }
+
+    void push(DocId id, float score)
+    {
+        const DocMatch match(id, score);
+        if (_heap.size() < _N)
+        {
+            _heap.push_back(match);
+            std::push_heap(_heap.begin(), _heap.end(), better);
+        }
+        else if (better(match, _heap.front()))
+        {
+            std::pop_heap(_heap.begin(), _heap.end(), better);
+            _heap.back() = match;
+            std::push_heap(_heap.begin(), _heap.end(), better);
+        }
+    }
+
+    /// Get the matches from best to worst
+    void get(DocMatches& matches)
+    {
+        std::sort_heap(_heap.begin(), _heap.end(), better);
+        matches.assign(_heap.begin(), _heap.end());
+        _heap.clear();
+    }
+
+  private:
+    static bool better(const DocMatch& a, const DocMatch& b) { return a.score < b.score || (a.score == b.score && a.id < b.id); }
+
+    std::size_t _N = 0;
+    std::vector<DocMatch> _heap;
+};
+
+/// Histogram with the same number of features per word as the word counts, for sparseDistance
+template<typename WordCounts>
+SparseHistogram toSparseHistogram(const WordCounts& words)
+{
+    SparseHistogram histogram;
+    for (const auto& word : words)
+        histogram[word.first].resize(word.second, UndefinedIndexT);
+    return histogram;
+}
+
+}  // namespace
+
+/**
+ * @brief Memory-mapped database file, see Database::save for the layout.
+ */
+struct Database::MappedDocuments
+{
+    std::string filename;
+    bip::file_mapping mapping;
+    bip::mapped_region region;
+
+    uint32_t nbWords = 0;
+    uint32_t nbDocuments = 0;
+    /// nbWords + 1 uint64 offsets in postings
+    const uint8_t* postingsOffsets = nullptr;
+    const uint8_t* postings = nullptr;
+    /// nbDocuments + 1 uint64 offsets in words
+    const uint8_t* wordsOffsets = nullptr;
+    const uint8_t* words = nullptr;
+
+    std::pair<const uint8_t*, const uint8_t*> wordPostings(Word word) const
+    {
+        return {postings + readValue<uint64_t>(postingsOffsets + word * sizeof(uint64_t)),
+                postings + readValue<uint64_t>(postingsOffsets + (word + 1) * sizeof(uint64_t))};
+    }
+
+    std::pair<const uint8_t*, const uint8_t*> documentWords(uint32_t index) const
+    {
+        return {words + readValue<uint64_t>(wordsOffsets + index * sizeof(uint64_t)),
+                words + readValue<uint64_t>(wordsOffsets + (index + 1) * sizeof(uint64_t))};
+    }
+};
+
 Database::Database(uint32_t num_words)
   : word_files_(num_words),
+    word_last_document_(num_words, 0),
+    word_documents_(num_words, 0),
     word_weights_(num_words, 1.0f)
 {}
 
 DocId Database::insert(DocId doc_id, const SparseHistogram& document)
 {
     // Ensure that the new document to insert is not already there.
-    assert(database_.find(doc_id) == database_.end());
+    assert(!contains(doc_id));
+
+    const uint32_t index = static_cast<uint32_t>(documents_id_.size());
+    std::vector<uint8_t> words;
+    uint32_t nbFeatures = 0;
+    Word previousWord = 0;
 
-    // For each word, retrieve its inverted file and increment the count for doc_id.
+    // For each word, append the document to its inverted file.
     for (SparseHistogram::const_iterator it = document.begin(), end = document.end(); it != end; ++it)
     {
-        Word word = it->first;
-        InvertedFile& file = word_files_[word];
-        if (file.empty() || file.back().id != doc_id)
-            file.push_back(WordFrequency(doc_id, it->second.size()));
-        else
-            file.back().count += it->second.size();
+        const Word word = it->first;
+        const uint32_t count = static_cast<uint32_t>(it->second.size());
+
+        std::vector<uint8_t>& file = word_files_[word];
+        writeVarint(file, index - word_last_document_[word]);
+        writeVarint(file, count);
+        word_last_document_[word] = index;
+        ++word_documents_[word];
+
+        writeVarint(words, word - previousWord);
+        writeVarint(words, count);
+        previousWord = word;
+        nbFeatures += count;
     }
 
+    documents_id_.push_back(doc_id);
+    documents_features_.push_back(nbFeatures);
+    documents_index_[doc_id] = index;
+    documents_words_.push_back(std::move(words));
     database_[doc_id] = document;
 
     return doc_id;
 }
 
+void Database::documentWords(uint32_t index, WordCounts& words) const
+{
+    words.clear();
+    const uint8_t* data;
+    const uint8_t* end;
+    const uint32_t nbMappedDocuments = mapped_ ? mapped_->nbDocuments : 0;
+    if (index < nbMappedDocuments)
+    {
+        std::tie(data, end) = mapped_->documentWords(index);
+    }
+    else
+    {
+        const std::vector<uint8_t>& documentWords = documents_words_[index - nbMappedDocuments];
+        data = documentWords.data();
+        end = data + documentWords.size();
+    }
+
+    Word word = 0;
+    while (data < end)
+    {
+        word += readVarint(data);
+        const uint32_t count = readVarint(data);
+        words.emplace_back(word, count);
+    }
+}
+
 void Database::sanityCheck(std::size_t N, std::map<std::size_t, DocMatches>& matches) const
 {
     // if N is equal to zero
@@ -79,19 +385,17 @@ void Database::sanityCheck(std::size_t N, std::map<std::size_t, DocMatches>& mat
     }
 
     matches.clear();
-    // since we already know the size of the vectors, in order to parallelize the
-    // query allocate the whole memory
-    auto display = system::createConsoleProgressDisplay(database_.size(), std::cout);
 
-    // #pragma omp parallel for default(none) shared(database_)
-    for (const auto& doc : database_)
-    {
-        std::vector<DocMatch> m;
-        find(doc.second, N, m);
-        //		matches.emplace_back( m );
-        matches[doc.first] = m;
-        ++display;
-    }
+    std::vector<DocId> docIds;
+    docIds.reserve(documents_index_.size());
+    for (const auto& doc : documents_index_)
+        docIds.push_back(doc.first);
+
+    std::vector<DocMatches> docMatches;
+    findBatch(docIds, N, docMatches);
+
+    for (std::size_t i = 0; i < docIds.size(); ++i)
+        matches[docIds[i]].swap(docMatches[i]);
 }
 
 /**
@@ -122,18 +426,175 @@ void Database::find(const std::vector<Word>& document, std::size_t N, std::vecto
  */
 void Database::find(const SparseHistogram& query, std::size_t N, std::vector<DocMatch>& matches, const std::string& distanceMethod) const
 {
-    matches.clear();
-    matches.reserve(database_.size());
-    for (const auto& document : database_)
+    std::vector<WordCounts> queries(1);
+    histogramWords(query, queries.front());
+
+    std::vector<DocMatches> queriesMatches;
+    findBatch(queries, N, queriesMatches, distanceMethod);
+    matches.swap(queriesMatches.front());
+}
+
+void Database::find(DocId doc_id, std::size_t N, std::vector<DocMatch>& matches, const std::string& distanceMethod) const
+{
+    std::vector<WordCounts> queries(1);
+    documentWords(documents_index_.at(doc_id), queries.front());
+
+    std::vector<DocMatches> queriesMatches;
+    findBatch(queries, N, queriesMatches, distanceMethod);
+    matches.swap(queriesMatches.front());
+}
+
+void Database::findBatch(const std::vector<SparseHistogram>& queries, std::size_t N, std::vector<DocMatches>& matches, const std::string& distanceMethod) const
+{
+    std::vector<WordCounts> queriesWords(queries.size());
+    for (std::size_t i = 0; i < queries.size(); ++i)
+        histogramWords(queries[i], queriesWords[i]);
+
+    findBatch(queriesWords, N, matches, distanceMethod);
+}
+
+void Database::findBatch(const std::vector<DocId>& doc_ids, std::size_t N, std::vector<DocMatches>& matches, const std::string& distanceMethod) const
+{
+    std::vector<WordCounts> queriesWords(doc_ids.size());
+    for (std::size_t i = 0; i < doc_ids.size(); ++i)
+        documentWords(documents_index_.at(doc_ids[i]), queriesWords[i]);
+
+    findBatch(queriesWords, N, matches, distanceMethod);
+}
+
+void Database::histogramWords(const SparseHistogram& histogram, WordCounts& words)
+{
+    words.clear();
+    words.reserve(histogram.size());
+    for (const auto& word : histogram)
+        words.emplace_back(word.first, static_cast<uint32_t>(word.second.size()));
+}
+
+void Database::findBatch(const std::vector<WordCounts>& queries, std::size_t N, std::vector<DocMatches>& matches, const std::string& distanceMethod) const
+{
+    const EPostingsDistance distance = getPostingsDistance(distanceMethod);
+    const uint32_t nbDocuments = static_cast<uint32_t>(documents_id_.size());
+    const uint32_t nbMappedDocuments = mapped_ ? mapped_->nbDocuments : 0;
+
+    matches.assign(queries.size(), DocMatches());
+    N = std::min(N, documents_id_.size());
+    if (N == 0 || queries.empty())
+        return;
+
+    const std::size_t nbBlocks = (queries.size() + queriesBlockSize - 1) / queriesBlockSize;
+
+#pragma omp parallel if (nbBlocks > 1)
     {
-        // for each document/image in the database compute the distance between the
-        // histograms of the query image and the others
-        const float distance = sparseDistance(query, document.second, distanceMethod, word_weights_);
-        matches.emplace_back(document.first, distance);
+        // buffers reused for all the blocks of queries of a thread
+        std::vector<TopMatches> topMatches(queriesBlockSize);
+        std::vector<float> scores;
+        std::vector<float> queriesFeatures;
+        // (word, query index, count in the query) of all the queries of a block, sorted by word
+        std::vector<std::tuple<Word, uint32_t, uint32_t>> queriesWords;
+        // first element of each word in queriesWords, and the reader of its posting list
+        std::vector<std::size_t> wordsBegin;
+        std::vector<PostingsReader> readers;
+        WordCounts words;
+
+#pragma omp for schedule(dynamic)
+        for (ptrdiff_t block = 0; block < static_cast<ptrdiff_t>(nbBlocks); ++block)
+        {
+            const std::size_t firstQuery = block * queriesBlockSize;
+            const std::size_t nbQueries = std::min(queriesBlockSize, queries.size() - firstQuery);
+            for (std::size_t q = 0; q < nbQueries; ++q)
+                topMatches[q].reset(N);
+
+            if (distance == EPostingsDistance::HISTOGRAMS)
+            {
+                // this distance is not a function of the shared words only
+                std::vector<SparseHistogram> queriesHistograms(nbQueries);
+                for (std::size_t q = 0; q < nbQueries; ++q)
+                    queriesHistograms[q] = toSparseHistogram(queries[firstQuery + q]);
+
+                for (uint32_t index = 0; index < nbDocuments; ++index)
+                {
+                    documentWords(index, words);
+                    const SparseHistogram documentHistogram = toSparseHistogram(words);
+                    for (std::size_t q = 0; q < nbQueries; ++q)
+                        topMatches[q].push(documents_id_[index], sparseDistance(queriesHistograms[q], documentHistogram, distanceMethod, word_weights_));
+                }
+            }
+            else
+            {
+                queriesWords.clear();
+                queriesFeatures.assign(nbQueries, 0.0f);
+                for (std::size_t q = 0; q < nbQueries; ++q)
+                {
+                    for (const auto& queryWord : queries[firstQuery + q])
+                    {
+                        assert(static_cast<std::size_t>(queryWord.first) < word_files_.size());
+                        queriesWords.emplace_back(queryWord.first, static_cast<uint32_t>(q), queryWord.second);
+                        queriesFeatures[q] += queryWord.second;
+                    }
+                }
+                std::sort(queriesWords.begin(), queriesWords.end());
+
+                wordsBegin.clear();
+                readers.clear();
+                for (std::size_t i = 0; i < queriesWords.size(); ++i)
+                {
+                    const Word word = std::get<0>(queriesWords[i]);
+                    if (i > 0 && word == std::get<0>(queriesWords[i - 1]))
+                        continue;
+                    wordsBegin.push_back(i);
+                    const std::vector<uint8_t>& file = word_files_[word];
+                    if (nbMappedDocuments > 0)
+                    {
+                        const auto postings = mapped_->wordPostings(word);
+                        readers.emplace_back(postings.first, postings.second, file.data(), file.data() + file.size());
+                    }
+                    else
+                    {
+                        readers.emplace_back(nullptr, nullptr, file.data(), file.data() + file.size());
+                    }
+                }
+                wordsBegin.push_back(queriesWords.size());
+
+                scores.resize(documentsBlockSize * nbQueries);
+
+                for (uint32_t firstDocument = 0; firstDocument < nbDocuments; firstDocument += documentsBlockSize)
+                {
+                    const uint32_t lastDocument = std::min<uint32_t>(firstDocument + documentsBlockSize, nbDocuments);
+                    std::fill(scores.begin(), scores.begin() + (lastDocument - firstDocument) * nbQueries, 0.0f);
+
+                    // accumulate the scores of the block of documents, in the order of the words as sparseDistance
+                    for (std::size_t w = 0; w < readers.size(); ++w)
+                    {
+                        PostingsReader& reader = readers[w];
+                        const Word word = std::get<0>(queriesWords[wordsBegin[w]]);
+                        for (; reader.valid() && reader.index() < lastDocument; reader.next())
+                        {
+                            float* documentScores = &scores[(reader.index() - firstDocument) * nbQueries];
+                            for (std::size_t i = wordsBegin[w]; i < wordsBegin[w + 1]; ++i)
+                                documentScores[std::get<1>(queriesWords[i])] +=
+                                  wordScore(distance, std::get<2>(queriesWords[i]), reader.count(), word_weights_[word]);
+                        }
+                    }
+
+                    for (uint32_t index = firstDocument; index < lastDocument; ++index)
+                    {
+                        const float* documentScores = &scores[(index - firstDocument) * nbQueries];
+                        for (std::size_t q = 0; q < nbQueries; ++q)
+                        {
+                            // sum of the differences of the word counts: all the words of both documents minus twice the shared ones
+                            const float score = (distance == EPostingsDistance::CLASSIC)
+                                                  ? queriesFeatures[q] + documents_features_[index] - 2.0f * documentScores[q]
+                                                  : -documentScores[q];
+                            topMatches[q].push(documents_id_[index], score);
+                        }
+                    }
+                }
+            }
+
+            for (std::size_t q = 0; q < nbQueries; ++q)
+                topMatches[q].get(matches[firstQuery + q]);
+        }
     }
-    const std::size_t nMatches = std::min(N, matches.size());
-    std::partial_sort(matches.begin(), matches.begin() + nMatches, matches.end());
-    matches.resize(nMatches);
 }
 
 /**
@@ -144,11 +605,11 @@ void Database::find(const SparseHistogram& query, std::size_t N, std::vector<Doc
  */
 void Database::computeTfIdfWeights(float default_weight)
 {
-    float N = (float)database_.size();
-    std::size_t num_words = word_files_.size();
+    float N = (float)size();
+    std::size_t num_words = word_documents_.size();
     for (std::size_t i = 0; i < num_words; ++i)
     {
-        std::size_t Ni = word_files_[i].size();
+        std::size_t Ni = word_documents_[i];
         if (Ni != 0)
             word_weights_[i] = std::log(N / Ni);
         else
@@ -174,7 +635,11 @@ void Database::loadWeights(const std::string& file)
         in.open(file, std::ios_base::binary);
         uint32_t num_words = 0;
         in.read((char*)(&num_words), sizeof(uint32_t));
+        if (size() != 0 && num_words != word_files_.size())
+            throw std::runtime_error((boost::format("The vocabulary weights file '%s' does not match the words of the database") % file).str());
         word_files_.resize(num_words);  // Inverted files start out empty
+        word_last_document_.resize(num_words, 0);
+        word_documents_.resize(num_words, 0);
         word_weights_.resize(num_words);
         in.read((char*)(&word_weights_[0]), num_words * sizeof(float));
     }
@@ -184,6 +649,197 @@ void Database::loadWeights(const std::string& file)
     }
 }
 
+/**
+ * File layout, all the values in little endian:
+ * - header: magic (8 bytes), version, number of words, number of documents, 0 (uint32),
+ *           size of the posting lists, size of the word lists (uint64)
+ * - per word: weight (float), then per word: number of documents (uint32)
+ * - per document: ID (uint32), then per document: number of features (uint32)
+ * - posting lists of all the words: (document index delta, count) as varints
+ * - word lists of all the documents: (word delta, count) as varints
+ * - offsets of the posting lists (number of words + 1, uint64)
+ * - offsets of the word lists (number of documents + 1, uint64)
+ */
+void Database::save(const std::string& file)
+{
+    // write in a temporary file, the current file may be memory-mapped by this database
+    const std::string tmpFile = file + ".tmp";
+    std::ofstream out(tmpFile, std::ios_base::binary);
+    if (!out)
+        throw std::runtime_error((boost::format("Failed to write voctree database file '%s'") % tmpFile).str());
+
+    const uint32_t nbWords = static_cast<uint32_t>(word_files_.size());
+    const uint32_t nbDocuments = static_cast<uint32_t>(documents_id_.size());
+    const uint32_t nbMappedDocuments = mapped_ ? mapped_->nbDocuments : 0;
+    const uint32_t reserved = 0;
+
+    // a mapped file cannot be replaced on all the platforms: when the destination is mapped,
+    // the merged lists are kept in memory to release the mapping before the rename
+    boost::system::error_code ec;
+    const bool releaseMapping = mapped_ && boost::filesystem::equivalent(mapped_->filename, file, ec);
+    std::vector<std::vector<uint8_t>> ownedWordFiles(releaseMapping ? nbWords : 0);
+    std::vector<uint32_t> ownedWordLastDocument(releaseMapping ? nbWords : 0, 0);
+    std::vector<std::vector<uint8_t>> ownedDocumentsWords(releaseMapping ? nbMappedDocuments : 0);
+    uint64_t postingsSize = 0;
+    uint64_t wordsSize = 0;
+
+    out.write(databaseMagic, sizeof(databaseMagic));
+    out.write((const char*)(&databaseVersion), sizeof(uint32_t));
+    out.write((const char*)(&nbWords), sizeof(uint32_t));
+    out.write((const char*)(&nbDocuments), sizeof(uint32_t));
+    out.write((const char*)(&reserved), sizeof(uint32_t));
+    const std::streampos sizesPosition = out.tellp();
+    out.write((const char*)(&postingsSize), sizeof(uint64_t));
+    out.write((const char*)(&wordsSize), sizeof(uint64_t));
+
+    writeArray(out, word_weights_);
+    writeArray(out, word_documents_);
+    writeArray(out, documents_id_);
+    writeArray(out, documents_features_);
+
+    // posting lists: merge the mapped and the inserted documents in a single delta encoding
+    std::vector<uint64_t> postingsOffsets(nbWords + 1, 0);
+    std::vector<uint8_t> postings;
+    for (uint32_t word = 0; word < nbWords; ++word)
+    {
+        postings.clear();
+        uint32_t previous = 0;
+        auto encode = [&](uint32_t index, uint32_t count) {
+            writeVarint(postings, index - previous);
+            writeVarint(postings, count);
+            previous = index;
+        };
+        if (nbMappedDocuments > 0)
+        {
+            const auto mappedPostings = mapped_->wordPostings(word);
+            decodePostings(mappedPostings.first, mappedPostings.second, encode);
+        }
+        decodePostings(word_files_[word].data(), word_files_[word].data() + word_files_[word].size(), encode);
+
+        out.write((const char*)(postings.data()), postings.size());
+        postingsSize += postings.size();
+        postingsOffsets[word + 1] = postingsSize;
+
+        if (releaseMapping)
+        {
+            ownedWordFiles[word] = postings;
+            ownedWordLastDocument[word] = previous;
+        }
+    }
+
+    // word lists: independent per document
+    std::vector<uint64_t> wordsOffsets(nbDocuments + 1, 0);
+    for (uint32_t index = 0; index < nbDocuments; ++index)
+    {
+        const uint8_t* data;
+        const uint8_t* end;
+        if (index < nbMappedDocuments)
+        {
+            std::tie(data, end) = mapped_->documentWords(index);
+            if (releaseMapping)
+                ownedDocumentsWords[index].assign(data, end);
+        }
+        else
+        {
+            const std::vector<uint8_t>& documentWords = documents_words_[index - nbMappedDocuments];
+            data = documentWords.data();
+            end = data + documentWords.size();
+        }
+        out.write((const char*)(data), end - data);
+        wordsSize += end - data;
+        wordsOffsets[index + 1] = wordsSize;
+    }
+
+    writeArray(out, postingsOffsets);
+    writeArray(out, wordsOffsets);
+
+    out.seekp(sizesPosition);
+    out.write((const char*)(&postingsSize), sizeof(uint64_t));
+    out.write((const char*)(&wordsSize), sizeof(uint64_t));
+    out.close();
+    if (!out)
+        throw std::runtime_error((boost::format("Failed to write voctree database file '%s'") % tmpFile).str());
+
+    if (releaseMapping)
+    {
+        // all the documents are now inserted documents, indexed from 0
+        word_files_ = std::move(ownedWordFiles);
+        word_last_document_ = std::move(ownedWordLastDocument);
+        std::move(documents_words_.begin(), documents_words_.end(), std::back_inserter(ownedDocumentsWords));
+        documents_words_ = std::move(ownedDocumentsWords);
+        mapped_.reset();
+    }
+
+    boost::filesystem::rename(tmpFile, file);
+}
+
+void Database::load(const std::string& file)
+{
+    auto mapped = std::make_shared<MappedDocuments>();
+    mapped->filename = file;
+    try
+    {
+        mapped->mapping = bip::file_mapping(file.c_str(), bip::read_only);
+        mapped->region = bip::mapped_region(mapped->mapping, bip::read_only);
+    }
+    catch (const bip::interprocess_exception& e)
+    {
+        throw std::runtime_error((boost::format("Failed to load voctree database file '%s': %s") % file % e.what()).str());
+    }
+
+    const uint8_t* data = static_cast<const uint8_t*>(mapped->region.get_address());
+    const uint64_t fileSize = mapped->region.get_size();
+    const uint64_t headerSize = sizeof(databaseMagic) + 4 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+
+    if (fileSize < headerSize || std::memcmp(data, databaseMagic, sizeof(databaseMagic)) != 0 ||
+        readValue<uint32_t>(data + sizeof(databaseMagic)) != databaseVersion)
+        throw std::runtime_error((boost::format("Invalid voctree database file '%s'") % file).str());
+
+    const uint64_t nbWords = readValue<uint32_t>(data + sizeof(databaseMagic) + sizeof(uint32_t));
+    const uint64_t nbDocuments = readValue<uint32_t>(data + sizeof(databaseMagic) + 2 * sizeof(uint32_t));
+    const uint64_t postingsSize = readValue<uint64_t>(data + sizeof(databaseMagic) + 4 * sizeof(uint32_t));
+    const uint64_t wordsSize = readValue<uint64_t>(data + sizeof(databaseMagic) + 4 * sizeof(uint32_t) + sizeof(uint64_t));
+
+    const uint64_t arraysSize = 2 * nbWords * sizeof(uint32_t) + 2 * nbDocuments * sizeof(uint32_t);
+    const uint64_t offsetsSize = (nbWords + 1 + nbDocuments + 1) * sizeof(uint64_t);
+    if (postingsSize > fileSize || wordsSize > fileSize || headerSize + arraysSize + postingsSize + wordsSize + offsetsSize != fileSize)
+        throw std::runtime_error((boost::format("Invalid voctree database file '%s'") % file).str());
+
+    const uint8_t* arrays = data + headerSize;
+    mapped->nbWords = static_cast<uint32_t>(nbWords);
+    mapped->nbDocuments = static_cast<uint32_t>(nbDocuments);
+    mapped->postings = arrays + arraysSize;
+    mapped->words = mapped->postings + postingsSize;
+    mapped->postingsOffsets = mapped->words + wordsSize;
+    mapped->wordsOffsets = mapped->postingsOffsets + (nbWords + 1) * sizeof(uint64_t);
+
+    // the lists are read in place, their offsets must be increasing and within the lists data
+    if (!isValidOffsets(mapped->postingsOffsets, nbWords, postingsSize) || !isValidOffsets(mapped->wordsOffsets, nbDocuments, wordsSize))
+        throw std::runtime_error((boost::format("Invalid voctree database file '%s'") % file).str());
+
+    // small per word and per document arrays are copied, the lists stay in the mapped file
+    word_weights_.resize(nbWords);
+    word_documents_.resize(nbWords);
+    documents_id_.resize(nbDocuments);
+    documents_features_.resize(nbDocuments);
+    std::memcpy(word_weights_.data(), arrays, nbWords * sizeof(float));
+    std::memcpy(word_documents_.data(), arrays + nbWords * sizeof(float), nbWords * sizeof(uint32_t));
+    std::memcpy(documents_id_.data(), arrays + 2 * nbWords * sizeof(uint32_t), nbDocuments * sizeof(DocId));
+    std::memcpy(documents_features_.data(), arrays + 2 * nbWords * sizeof(uint32_t) + nbDocuments * sizeof(DocId), nbDocuments * sizeof(uint32_t));
+
+    word_files_.assign(nbWords, std::vector<uint8_t>());
+    word_last_document_.assign(nbWords, 0);
+    documents_words_.clear();
+    documents_index_.clear();
+    for (uint32_t index = 0; index < nbDocuments; ++index)
+        documents_index_[documents_id_[index]] = index;
+    database_.clear();
+
+    mapped_.reset();
+    if (nbDocuments > 0)
+        mapped_ = std::move(mapped);
+}
+
 ///**
 // * Normalize a document vector representing the histogram of visual words for a given image
 // *
@@ -203,7 +859,7 @@ void Database::loadWeights(const std::string& file)
  * @brief Return the size of the database in terms of number of documents
  * @return the number of documents
  */
-std::size_t Database::size() const { return database_.size(); }
+std::size_t Database::size() const { return documents_id_.size(); }
 
 }  // namespace voctree
 }  // namespace aliceVision
@@ -10,6 +10,7 @@
 #include <aliceVision/types.hpp>
 
 #include <map>
+#include <memory>
 #include <cstddef>
 #include <string>
 
@@ -20,6 +21,7 @@ namespace voctree {
  * @brief Struct representing a single database match.
  *
  * \c score is in the range [0,2], where 0 is best and 2 is worst.
+ * The matches returned by Database::find with the same score are sorted by ID.
  */
 struct DocMatch
 {
@@ -46,6 +48,13 @@ std::ostream& operator<<(std::ostream& os, const DocMatches& matches);
 /**
  * @brief Class for efficiently matching a bag-of-words representation of a document (image) against
  * a database of known documents.
+ *
+ * The documents are stored as compressed inverted files: for each word, the list of the documents
+ * containing it with the number of occurrences (delta and varint encoded). The queries are scored
+ * directly from these posting lists, so only the documents sharing words with the query are visited.
+ *
+ * The database can be saved to a file and loaded back: the posting lists of a loaded database are
+ * memory-mapped and new documents can still be inserted.
  */
 class Database
 {
@@ -67,6 +76,12 @@ class Database
      */
     DocId insert(DocId doc_id, const SparseHistogram& document);
 
+    /**
+     * @brief Check if a document is in the database.
+     * @param[in] doc_id The document ID
+     */
+    bool contains(DocId doc_id) const { return documents_index_.count(doc_id) != 0; }
+
     /**
      * @brief Perform a sanity check of the database by querying each document
      * of the database and finding its top N matches
@@ -102,6 +117,46 @@ class Database
               std::vector<DocMatch>& matches,
               const std::string& distanceMethod = "strongCommonPoints") const;
 
+    /**
+     * @brief Find the top N matches in the database for a document of the database.
+     *
+     * @param[in] doc_id The ID of the query document, it must be in the database.
+     * @param[in] N        The number of matches to return.
+     * @param[out] matches  IDs and scores for the top N matching database documents.
+     * @param[in] distanceMethod distance method (norm L1, etc.)
+     */
+    void find(DocId doc_id, std::size_t N, std::vector<DocMatch>& matches, const std::string& distanceMethod = "strongCommonPoints") const;
+
+    /**
+     * @brief Find the top N matches in the database for each query document of a batch.
+     *
+     * The queries are scored by blocks: the posting list of each word is decoded once for all the
+     * queries of a block, and the scores are accumulated by blocks of documents that fit in the cache.
+     * The blocks of queries are processed in parallel.
+     *
+     * @param[in] queries The query documents, sets of quantized words.
+     * @param[in] N        The number of matches to return for each query.
+     * @param[out] matches  IDs and scores for the top N matching database documents, per query.
+     * @param[in] distanceMethod distance method (norm L1, etc.)
+     */
+    void findBatch(const std::vector<SparseHistogram>& queries,
+                   std::size_t N,
+                   std::vector<DocMatches>& matches,
+                   const std::string& distanceMethod = "strongCommonPoints") const;
+
+    /**
+     * @brief Find the top N matches in the database for each document of a batch of documents of the database.
+     *
+     * @param[in] doc_ids The IDs of the query documents, they must be in the database.
+     * @param[in] N        The number of matches to return for each query.
+     * @param[out] matches  IDs and scores for the top N matching database documents, per query.
+     * @param[in] distanceMethod distance method (norm L1, etc.)
+     */
+    void findBatch(const std::vector<DocId>& doc_ids,
+                   std::size_t N,
+                   std::vector<DocMatches>& matches,
+                   const std::string& distanceMethod = "strongCommonPoints") const;
+
     /**
      * @brief Compute the TF-IDF weights of all the words. To be called after inserting a corpus of
      * training examples into the database.
@@ -116,42 +171,76 @@ class Database
      */
     std::size_t size() const;
 
+    /// Get the IDs of the documents, in insertion order
+    const std::vector<DocId>& getDocumentIds() const { return documents_id_; }
+
+    /// Get the number of words of the vocabulary
+    std::size_t words() const { return word_files_.size(); }
+
     /// Save the vocabulary word weights to a file.
     void saveWeights(const std::string& file) const;
     /// Load the vocabulary word weights from a file.
     void loadWeights(const std::string& file);
 
-    // Save weights and documents
-    // void save(const std::string& file) const;
-    // void load(const std::string& file);
+    /**
+     * @brief Save the word weights and the documents (compressed posting lists) to a file.
+     * @note The file is written next to the destination, then renamed over it.
+     *       If the destination is the file loaded by this database, the documents are copied
+     *       in memory and the file is unmapped before the rename.
+     */
+    void save(const std::string& file);
+
+    /**
+     * @brief Load a database saved with save(). The file is memory-mapped and must not be
+     *        modified while the database is in use. New documents can be inserted afterwards.
+     */
+    void load(const std::string& file);
 
+    /**
+     * @brief Get the histograms of the documents inserted with insert().
+     * @note The documents loaded from a file are not in this map, only their word counts are stored.
+     */
     const SparseHistogramPerImage& getSparseHistogramPerImage() const { return database_; }
 
   private:
-    struct WordFrequency
-    {
-        DocId id;
-        uint32_t count;
-
-        WordFrequency() = default;
-        WordFrequency(DocId _id, uint32_t _count)
-          : id(_id),
-            count(_count)
-        {}
-    };
+    /// Pair of a word and its number of occurrences in a document
+    typedef std::vector<std::pair<Word, uint32_t>> WordCounts;
 
-    // Stored in increasing order by DocId
-    typedef std::vector<WordFrequency> InvertedFile;
-
-    /// @todo Use sorted vector?
-    // typedef std::vector< std::pair<Word, float> > DocumentVector;
+    /// Posting lists and word lists of the documents loaded from a file
+    struct MappedDocuments;
 
     friend std::ostream& operator<<(std::ostream& os, const SparseHistogram& dv);
 
-    std::vector<InvertedFile> word_files_;
+    /// Documents loaded from a file, indexed before the inserted ones
+    std::shared_ptr<const MappedDocuments> mapped_;
+    /// Posting lists of the inserted documents, per word: (document index delta, count) as varints
+    std::vector<std::vector<uint8_t>> word_files_;
+    /// Last document index of the posting list of each word (for the delta encoding)
+    std::vector<uint32_t> word_last_document_;
+    /// Number of documents containing each word
+    std::vector<uint32_t> word_documents_;
     std::vector<float> word_weights_;
+
+    /// ID of each document index
+    std::vector<DocId> documents_id_;
+    /// Number of features of each document
+    std::vector<uint32_t> documents_features_;
+    /// Index of each document, sorted by ID
+    std::map<DocId, uint32_t> documents_index_;
+    /// Word lists of the inserted documents: (word delta, count) as varints
+    std::vector<std::vector<uint8_t>> documents_words_;
+
     SparseHistogramPerImage database_;  // Precomputed for inserted documents
 
+    /// Decode the word counts of a document
+    void documentWords(uint32_t index, WordCounts& words) const;
+
+    /// Get the word counts of a histogram
+    static void histogramWords(const SparseHistogram& histogram, WordCounts& words);
+
+    /// Find the top N matches from the word counts of each query
+    void findBatch(const std::vector<WordCounts>& queries, std::size_t N, std::vector<DocMatches>& matches, const std::string& distanceMethod) const;
+
     /**
      * Normalize a document vector representing the histogram of visual words for a given image
      * @param[in/out] v the unnormalized histogram of visual words
@@ -9,6 +9,8 @@
 #include "distance.hpp"
 #include "DefaultAllocator.hpp"
 
+#include <aliceVision/feature/distanceKernels.hpp>
+
 #include <aliceVision/alicevision_omp.hpp>
 #include <aliceVision/system/Logger.hpp>
 
@@ -18,6 +20,7 @@
 #include <algorithm>
 #include <mutex>
 #include <numeric>
+#include <random>
 #include <vector>
 #include <limits>
 #include <stdio.h>
@@ -27,6 +30,21 @@
 namespace aliceVision {
 namespace voctree {
 
+/**
+ * @brief Get the random number generator used by the K-means of the current thread.
+ *
+ * It is seeded with std::rand() at its first use in a thread, so the results follow std::srand().
+ * TreeBuilder seeds it before each clustering, so the tree does not depend on the number of threads.
+ */
+inline std::mt19937& kmeansRandomGenerator()
+{
+    thread_local std::mt19937 generator(static_cast<unsigned int>(std::rand()));
+    return generator;
+}
+
+/// Draw a random index in [0, n[ with kmeansRandomGenerator()
+inline std::size_t kmeansRandomIndex(std::size_t n) { return std::uniform_int_distribution<std::size_t>(0, n - 1)(kmeansRandomGenerator()); }
+
 /**
  * @brief Initializer for K-means that randomly selects k features as the cluster centers.
  */
@@ -44,7 +62,7 @@ struct InitRandom
         std::vector<Feature*> features_perm = features;
         for (size_t i = features.size(); i > 1; --i)
         {
-            size_t k = rand() % i;
+            size_t k = kmeansRandomIndex(i);
             std::swap(features_perm[i - 1], features_perm[k]);
         }
         // Take the first k permuted features as the initial centers
@@ -63,6 +81,9 @@ struct InitRandom
  */
 struct InitKmeanspp
 {
+    /// Number of chunks of features with their own partial sums of the distances
+    static constexpr std::size_t distanceChunks = 64;
+
     template<class Feature, class Distance, class FeatureAllocator>
     void operator()(const std::vector<Feature*>& features,
                     size_t k,
@@ -89,6 +110,7 @@ struct InitKmeanspp
         centers.resize(k);
 
         auto threadCount = std::min(numTrials, omp_get_max_threads());
+        const std::size_t nbChunks = std::min<std::size_t>(distanceChunks, features.size());
 
         std::vector<squared_distance_type> dists(features.size(), std::numeric_limits<squared_distance_type>::max());
         std::vector<squared_distance_type> distsTempBest(features.size(), std::numeric_limits<squared_distance_type>::max());
@@ -103,7 +125,7 @@ struct InitKmeanspp
         typename std::vector<Feature*>::const_iterator featiter;
 
         // 1. Choose a random center
-        size_t randCenter = rand() % features.size();
+        size_t randCenter = kmeansRandomIndex(features.size());
 
         // add it to the centers
         centers[0] = *features[randCenter];
@@ -130,10 +152,12 @@ struct InitKmeanspp
 
             squared_distance_type bestSum = std::numeric_limits<squared_distance_type>::max();
             std::size_t bestCenter = -1;
+            int bestTrial = numTrials;
 
+            std::uniform_real_distribution<float> percDistribution(0.0f, 1.0f);
             for (auto& perc : trialPercs)
             {
-                perc = (float)std::rand() / RAND_MAX;
+                perc = percDistribution(kmeansRandomGenerator());
             }
 
             // make it a little bit more robust and try several guesses
@@ -151,19 +175,11 @@ struct InitKmeanspp
                 squared_distance_type partial = (squared_distance_type)(currSum * perc);
                 // look for the element that cap the partial sum that has been
                 // drawn
-                dstiter = dists.begin();
-                while ((partial > 0) && (dstiter != dists.end()))
+                auto dstiter = dists.begin();
+                // compare before subtracting, as a safeguard against unsigned types that do not allow negative numbers
+                while ((dstiter != dists.end()) && (partial >= *dstiter))
                 {
-                    assert(dstiter != dists.end());
-                    // safeguard against unsigned types that do not allow negative numbers
-                    if (partial > *dstiter)
-                    {
-                        partial -= *dstiter;
-                    }
-                    else
-                    {
-                        partial = 0;
-                    }
+                    partial -= *dstiter;
                     ++dstiter;
                 }
 
@@ -175,27 +191,35 @@ struct InitKmeanspp
                     featidx = dstiter - dists.begin();
 
                 // 2. compute the distance of each feature from the current center
-                squared_distance_type distSum = 0;
-
                 auto& distsTemp = threadDistsTemp[omp_get_thread_num()];
 
+                // sum by chunks in a fixed order, so the sum does not depend on the number of threads
+                std::vector<squared_distance_type> chunkSums(nbChunks, squared_distance_type(0));
+
                 Feature newCenter = *features[featidx];
-#pragma omp parallel for reduction(+ : distSum) num_threads(omp_get_max_threads() / threadCount)
-                for (ptrdiff_t it = 0; it < static_cast<ptrdiff_t>(features.size()); ++it)
+#pragma omp parallel for schedule(dynamic) num_threads(omp_get_max_threads() / threadCount)
+                for (ptrdiff_t c = 0; c < static_cast<ptrdiff_t>(nbChunks); ++c)
                 {
-                    distsTemp[it] = std::min(distance(*(features[it]), newCenter), dists[it]);
-                    distSum += distsTemp[it];
+                    const std::size_t end = features.size() * (c + 1) / nbChunks;
+                    for (std::size_t it = features.size() * c / nbChunks; it < end; ++it)
+                    {
+                        distsTemp[it] = std::min(distance(*(features[it]), newCenter), dists[it]);
+                        chunkSums[c] += distsTemp[it];
+                    }
                 }
+                const squared_distance_type distSum = std::accumulate(chunkSums.begin(), chunkSums.end(), squared_distance_type(0));
                 if (verbose > 2)
                     ALICEVISION_LOG_DEBUG("trial " << j << " found feat " << featidx << ": " << *features[featidx] << " with sum: " << distSum);
 
                 {
                     std::lock_guard<std::mutex> lock(bestSumMutex);
-                    if (distSum < bestSum)
+                    // ties are broken by the index of the trial, so the choice does not depend on the threads
+                    if (distSum < bestSum || (distSum == bestSum && j < bestTrial))
                     {
                         // save the best so far
                         bestSum = distSum;
                         bestCenter = featidx;
+                        bestTrial = j;
                         std::swap(distsTemp, distsTempBest);
                     }
                 }
@@ -330,6 +354,15 @@ class SimpleKmeans
 
     void setVerbose(const int verboseLevel) { verbose_ = verboseLevel; }
 
+    std::size_t getMiniBatchSize() const { return mini_batch_size_; }
+
+    /**
+     * @brief Use the mini-batch K-means: each iteration updates the centers with a random
+     *        batch of features instead of all the features. Zero (default) to use Lloyd's algorithm.
+     * @note The centers are updated by interpolation, the feature type must support floating point values.
+     */
+    void setMiniBatchSize(std::size_t miniBatchSize) { mini_batch_size_ = miniBatchSize; }
+
     /**
      * @brief Partition a set of features into k clusters.
      *
@@ -365,11 +398,64 @@ class SimpleKmeans
                                       std::vector<Feature, FeatureAllocator>& centers,
                                       std::vector<unsigned int>& membership) const;
 
+    /**
+     * @brief Mini-batch K-means: the centers are moved toward the features of random batches,
+     *        with a learning rate of 1 / (number of features assigned to the center so far).
+     *
+     * Sculley, D. "Web-Scale K-Means Clustering", WWW 2010
+     */
+    squared_distance_type clusterMiniBatch(const std::vector<Feature*>& features,
+                                           std::size_t k,
+                                           std::vector<Feature, FeatureAllocator>& centers,
+                                           std::vector<unsigned int>& membership) const;
+
+    /// Find the nearest center of a feature, with the SIMD distances for the default L2 distance between descriptors
+    unsigned int nearestCenter(const Feature& feature, const std::vector<Feature, FeatureAllocator>& centers, const feature::DistanceKernels& kernels) const
+    {
+        if constexpr (useSimdL2Distance<Feature, Distance>())
+        {
+            return static_cast<unsigned int>(closestCenterSimdL2(feature, centers.data(), centers.size(), kernels));
+        }
+        else
+        {
+            squared_distance_type d_min = std::numeric_limits<squared_distance_type>::max();
+            unsigned int nearest = 0;
+            for (unsigned int j = 0; j < centers.size(); ++j)
+            {
+                squared_distance_type distance = distance_(feature, centers[j]);
+                if (distance < d_min)
+                {
+                    d_min = distance;
+                    nearest = j;
+                }
+            }
+            return nearest;
+        }
+    }
+
+    /// Sum of the squared distances of the features to their center
+    squared_distance_type sumSquaredErrors(const std::vector<Feature*>& features,
+                                           const std::vector<Feature, FeatureAllocator>& centers,
+                                           const std::vector<unsigned int>& membership) const;
+
+    /// Number of threads for the assignment of the features: one thread on small problems or when already in a parallel region
+    static int assignmentThreads(std::size_t nbFeatures, std::size_t k)
+    {
+        // On small problems enabling multithreading does much more harm than good because thread
+        // creation is relatively expensive.
+        const bool enableMultithreading = nbFeatures * k > 1000000 && !omp_in_parallel();
+        return enableMultithreading ? omp_get_max_threads() : 1;
+    }
+
+    /// Number of chunks of features with their own partial sums of the centers in clusterOnce
+    static constexpr std::size_t assignmentChunks = 64;
+
     Feature zero_;
     Distance distance_;
     Initializer choose_centers_;
     std::size_t max_iterations_;
     std::size_t restarts_;
+    std::size_t mini_batch_size_;
     int verbose_;
 };
 
@@ -380,8 +466,9 @@ SimpleKmeans<Feature, Distance, FeatureAllocator>::SimpleKmeans(const Feature& z
     //    choose_centers_( InitRandom( ) ),
     choose_centers_(InitKmeanspp()),
     max_iterations_(100),
-    verbose_(verbose),
-    restarts_(1)
+    restarts_(1),
+    mini_batch_size_(0),
+    verbose_(verbose)
 {}
 
 template<class Feature, class Distance, class FeatureAllocator>
@@ -415,8 +502,21 @@ typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_typ
     {
         if (verbose_ > 0)
             ALICEVISION_LOG_DEBUG("Trial " << starts + 1 << "/" << restarts_);
-        choose_centers_(features, k, new_centers, distance_, verbose_);
-        squared_distance_type sse = clusterOnce(features, k, new_centers, new_membership);
+        squared_distance_type sse;
+        if (mini_batch_size_ > 0 && features.size() > mini_batch_size_)
+        {
+            // initialize the centers on a random sample of the features
+            std::vector<Feature*> sample(std::min(features.size(), 3 * mini_batch_size_));
+            for (Feature*& feature : sample)
+                feature = features[kmeansRandomIndex(features.size())];
+            choose_centers_(sample, k, new_centers, distance_, verbose_);
+            sse = clusterMiniBatch(features, k, new_centers, new_membership);
+        }
+        else
+        {
+            choose_centers_(features, k, new_centers, distance_, verbose_);
+            sse = clusterOnce(features, k, new_centers, new_membership);
+        }
         if (verbose_ > 0)
             ALICEVISION_LOG_DEBUG("End of Trial " << starts + 1 << "/" << restarts_);
         if (sse < least_sse)
@@ -439,78 +539,67 @@ typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_typ
   std::vector<Feature, FeatureAllocator>& centers,
   std::vector<unsigned int>& membership) const
 {
-    typedef typename std::vector<Feature, FeatureAllocator>::value_type centerType;
-    typedef typename Distance::value_type feature_value_type;
-
     std::vector<std::size_t> new_center_counts(k);
     std::vector<Feature, FeatureAllocator> new_centers(k);
-    std::vector<std::mutex> centersLocks(k);
     squared_distance_type max_center_shift = std::numeric_limits<squared_distance_type>::max();
 
+    const feature::DistanceKernels& kernels = feature::getDistanceKernels();
+    const int nbThreads = assignmentThreads(features.size(), k);
+    // partial sums over a fixed number of chunks of features, reduced in the order of the chunks,
+    // so the centers do not depend on the number of threads
+    const std::size_t nbChunks = std::min<std::size_t>(assignmentChunks, features.size());
+    std::vector<std::vector<Feature, FeatureAllocator>> chunkCenters(nbChunks, std::vector<Feature, FeatureAllocator>(k));
+    std::vector<std::vector<std::size_t>> chunkCenterCounts(nbChunks, std::vector<std::size_t>(k));
+
     if (verbose_ > 0)
         ALICEVISION_LOG_DEBUG("Iterations");
     for (std::size_t iter = 0; iter < max_iterations_; ++iter)
     {
         if (verbose_ > 0)
             ALICEVISION_LOG_DEBUG("*");
-        // Zero out new centers and counts
-        std::fill(new_center_counts.begin(), new_center_counts.end(), 0);
-        //		for(std::size_t i = 0; i < k; checkElements(new_centers[i++], "bef"));
-        std::fill(new_centers.begin(), new_centers.end(), zero_);
-        //		for(std::size_t i = 0; i < k; checkElements(new_centers[i++], "aft"));
-        assert(checkVectorElements(new_centers, "newcenters init"));
         bool is_stable = true;
 
-        // On small problems enabling multithreading does much more harm than good because thread
-        // creation is relatively expensive.
-        // TODO: Ideally a thread pool would be created before the first iteration and the iterations
-        // would reuse the existing threads.
-        bool enableMultithreading = features.size() * k > 1000000;
-
 // Assign data objects to current centers
-#pragma omp parallel for shared(new_centers, new_center_counts, features, centers, membership) if (enableMultithreading)
-        for (ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
+#pragma omp parallel for schedule(dynamic) num_threads(nbThreads) reduction(&& : is_stable)
+        for (ptrdiff_t c = 0; c < static_cast<ptrdiff_t>(nbChunks); ++c)
         {
-            squared_distance_type d_min = std::numeric_limits<squared_distance_type>::max();
-            unsigned int nearest = 0;
-            bool found = false;
-
-            // @todo if k is large, let's say k>100 use FLAAN to retrieve the
-            // cluster center
+            std::vector<Feature, FeatureAllocator>& sums = chunkCenters[c];
+            std::vector<std::size_t>& counts = chunkCenterCounts[c];
+            std::fill(sums.begin(), sums.end(), zero_);
+            std::fill(counts.begin(), counts.end(), 0);
 
-            // Find the nearest cluster center to feature i
-            for (unsigned int j = 0; j < k; ++j)
+            const std::size_t end = features.size() * (c + 1) / nbChunks;
+            for (std::size_t i = features.size() * c / nbChunks; i < end; ++i)
             {
-                squared_distance_type distance = distance_(*features[i], centers[j]);
-                //		printf("\t\tdistance %f\n", (float)distance);
-                //		PrintFeat(*features[i] );
-                if (distance < d_min)
+                // Find the nearest cluster center to feature i
+                const unsigned int nearest = nearestCenter(*features[i], centers, kernels);
+
+                // Assign feature i to the cluster it is nearest to
+                if (membership[i] != nearest)
                 {
-                    d_min = distance;
-                    nearest = j;
-                    found = true;
+                    is_stable = false;
+                    membership[i] = nearest;
                 }
-                //		 printf("\t distance %f %f\n", (double)distance, (double)d_min);
+                // Accumulate the cluster center and its membership count
+                sums[nearest] += *features[i];
+                ++counts[nearest];
             }
-            assert(found);
-            // Assign feature i to the cluster it is nearest to
-            if (membership[i] != nearest)
-            {
-                is_stable = false;
-                membership[i] = nearest;
-            }
-            // Accumulate the cluster center and its membership count
-            //	  printf("\t nearest %d\n", nearest);
-            //			checkElements(*features[i], "feat");
+        }
+
+        // Zero out new centers and counts, then sum the contributions of the chunks
+        std::fill(new_center_counts.begin(), new_center_counts.end(), 0);
+        std::fill(new_centers.begin(), new_centers.end(), zero_);
+        assert(checkVectorElements(new_centers, "newcenters init"));
+        for (std::size_t c = 0; c < nbChunks; ++c)
+        {
+            for (std::size_t j = 0; j < k; ++j)
             {
-                std::lock_guard<std::mutex> lock{centersLocks[nearest]};
-                new_centers[nearest] += *features[i];
-                //			checkElements(new_centers[nearest], "sum");
-                //	  printf("\t new_centers[nearest] += *features[i];\n");
-                ++new_center_counts[nearest];
-                //	  printf("\taccumulate\n");
+                if (chunkCenterCounts[c][j] == 0)
+                    continue;
+                new_centers[j] += chunkCenters[c][j];
+                new_center_counts[j] += chunkCenterCounts[c][j];
             }
-        }  // for
+        }
 
         if (is_stable)
             break;
@@ -540,7 +629,7 @@ typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_typ
             {
                 // Choose a new center randomly from the input features
                 // @todo use a better strategy like taking splitting the largest cluster
-                unsigned int index = rand() % features.size();
+                const std::size_t index = kmeansRandomIndex(features.size());
                 centers[i] = *features[index];
                 ALICEVISION_LOG_DEBUG("Choosing a new center: " << index);
             }
@@ -553,14 +642,76 @@ typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_typ
         ALICEVISION_LOG_DEBUG("");
 
     // Return the sum squared error
+    return sumSquaredErrors(features, centers, membership);
+}
+
+template<class Feature, class Distance, class FeatureAllocator>
+typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type SimpleKmeans<Feature, Distance, FeatureAllocator>::clusterMiniBatch(
+  const std::vector<Feature*>& features,
+  std::size_t k,
+  std::vector<Feature, FeatureAllocator>& centers,
+  std::vector<unsigned int>& membership) const
+{
+    const feature::DistanceKernels& kernels = feature::getDistanceKernels();
+    const int nbThreads = assignmentThreads(mini_batch_size_, k);
+
+    std::vector<std::size_t> center_counts(k, 0);
+    std::vector<Feature*> batch(mini_batch_size_);
+    std::vector<unsigned int> batch_membership(mini_batch_size_);
+
+    if (verbose_ > 0)
+        ALICEVISION_LOG_DEBUG("Mini-batch iterations");
+    for (std::size_t iter = 0; iter < max_iterations_; ++iter)
+    {
+        for (Feature*& feature : batch)
+            feature = features[kmeansRandomIndex(features.size())];
+
+        // Assign the batch to the current centers
+#pragma omp parallel for num_threads(nbThreads)
+        for (ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(batch.size()); ++i)
+            batch_membership[i] = nearestCenter(*batch[i], centers, kernels);
+
+        // Move each center toward its features, in the order of the batch
+        for (std::size_t i = 0; i < batch.size(); ++i)
+        {
+            const unsigned int c = batch_membership[i];
+            const float learningRate = 1.0f / ++center_counts[c];
+            Feature update = *batch[i];
+            update *= learningRate;
+            centers[c] *= 1.0f - learningRate;
+            centers[c] += update;
+        }
+    }
+
+    // Assign all the features to the final centers
+    const int nbAssignmentThreads = assignmentThreads(features.size(), k);
+#pragma omp parallel for num_threads(nbAssignmentThreads)
+    for (ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(features.size()); ++i)
+        membership[i] = nearestCenter(*features[i], centers, kernels);
+
+    return sumSquaredErrors(features, centers, membership);
+}
+
+template<class Feature, class Distance, class FeatureAllocator>
+typename SimpleKmeans<Feature, Distance, FeatureAllocator>::squared_distance_type SimpleKmeans<Feature, Distance, FeatureAllocator>::sumSquaredErrors(
+  const std::vector<Feature*>& features,
+  const std::vector<Feature, FeatureAllocator>& centers,
+  const std::vector<unsigned int>& membership) const
+{
     /// @todo Kahan summation?
-    squared_distance_type sse = squared_distance_type(0);
     assert(features.size() > 0);
-    for (std::size_t i = 0; i < features.size(); ++i)
+    // sum by chunks in a fixed order, so the result does not depend on the number of threads
+    const std::size_t nbChunks = std::min<std::size_t>(assignmentChunks, features.size());
+    std::vector<squared_distance_type> chunkSse(nbChunks, squared_distance_type(0));
+    const int nbThreads = assignmentThreads(features.size(), centers.size());
+#pragma omp parallel for schedule(dynamic) num_threads(nbThreads)
+    for (ptrdiff_t c = 0; c < static_cast<ptrdiff_t>(nbChunks); ++c)
     {
-        sse += distance_(*features[i], centers[membership[i]]);
+        const std::size_t end = features.size() * (c + 1) / nbChunks;
+        for (std::size_t i = features.size() * c / nbChunks; i < end; ++i)
+            chunkSse[c] += distance_(*features[i], centers[membership[i]]);
     }
-    return sse;
+    return std::accumulate(chunkSse.begin(), chunkSse.end(), squared_distance_type(0));
 }
 
 }  // namespace voctree
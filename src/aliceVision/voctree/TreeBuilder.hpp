@@ -8,7 +8,11 @@
 
 #include "MutableVocabularyTree.hpp"
 #include "SimpleKmeans.hpp"
-#include <deque>
+
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <random>
+#include <vector>
 // #include <cstdio> //DEBUG
 
 namespace aliceVision {
@@ -46,6 +50,20 @@ class TreeBuilder
      */
     void build(const FeatureVector& training_features, uint32_t k, uint32_t levels);
 
+    /**
+     * @brief Build a new vocabulary tree from a contiguous array of training features,
+     *        e.g. a memory-mapped file of descriptors.
+     *
+     * The subsets of a level are clustered in parallel. Each clustering draws its random numbers
+     * from a generator seeded for its subset, so the tree does not depend on the number of threads.
+     *
+     * @param training_features The set of training features to cluster.
+     * @param nb_features       The number of training features.
+     * @param k                 The branching factor, or max children of any node.
+     * @param levels            The number of levels in the tree.
+     */
+    void build(const Feature* training_features, std::size_t nb_features, uint32_t k, uint32_t levels);
+
     /// Get the built vocabulary tree.
 
     const Tree& tree() const { return tree_; }
@@ -83,6 +101,12 @@ TreeBuilder<Feature, DistanceT, FeatureAllocator>::TreeBuilder(const Feature& ze
 
 template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
 void TreeBuilder<Feature, DistanceT, FeatureAllocator>::build(const FeatureVector& training_features, uint32_t k, uint32_t levels)
+{
+    build(training_features.data(), training_features.size(), k, levels);
+}
+
+template<class Feature, template<typename, typename> class DistanceT, class FeatureAllocator>
+void TreeBuilder<Feature, DistanceT, FeatureAllocator>::build(const Feature* training_features, std::size_t nb_features, uint32_t k, uint32_t levels)
 {
     // Initial setup and memory allocation for the tree
     tree_.clear();
@@ -90,31 +114,57 @@ void TreeBuilder<Feature, DistanceT, FeatureAllocator>::build(const FeatureVecto
     tree_.centers().reserve(tree_.nodes());
     tree_.validCenters().reserve(tree_.nodes());
 
-    // We keep a queue of disjoint feature subsets to cluster.
+    // We keep the disjoint feature subsets of the current level to cluster.
     // Feature* is used to avoid copying features.
-    std::deque<std::vector<Feature*>> subset_queue(1);
+    std::vector<std::vector<Feature*>> subsets(1);
 
     {
-        // At first the queue contains one "subset" containing all the features.
-        std::vector<Feature*>& feature_ptrs = subset_queue.front();
-        feature_ptrs.reserve(training_features.size());
-        for (const Feature& f : training_features)
+        // At first there is one "subset" containing all the features.
+        std::vector<Feature*>& feature_ptrs = subsets.front();
+        feature_ptrs.reserve(nb_features);
+        for (std::size_t i = 0; i < nb_features; ++i)
         {
-            feature_ptrs.push_back(const_cast<Feature*>(&f));
+            feature_ptrs.push_back(const_cast<Feature*>(&training_features[i]));
         }
     }
-    FeatureVector centers;  // always size k
+
+    // The seeds of the clusterings are drawn in the order of the subsets
+    std::mt19937 seedGenerator(kmeansRandomGenerator()());
+
     for (uint32_t level = 0; level < levels; ++level)
     {
         if (verbose_)
             printf("# Level %u\n", level);
-        std::vector<unsigned int> membership;
 
-        for (std::size_t i = 0, ie = subset_queue.size(); i < ie; ++i)
+        const std::size_t nbSubsets = subsets.size();
+        std::vector<unsigned int> seeds(nbSubsets);
+        for (unsigned int& seed : seeds)
+            seed = seedGenerator();
+
+        std::vector<FeatureVector> subsetsCenters(nbSubsets);       // size k for the clustered subsets
+        std::vector<std::vector<unsigned int>> memberships(nbSubsets);
+
+        // Cluster the subsets with more than k elements: in parallel over the subsets if there are enough of them,
+        // otherwise the k-means parallelizes the assignment of the features.
+        const bool parallelSubsets = nbSubsets > 1 && nbSubsets >= static_cast<std::size_t>(omp_get_max_threads());
+#pragma omp parallel for schedule(dynamic) if (parallelSubsets)
+        for (ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(nbSubsets); ++i)
         {
-            std::vector<Feature*>& subset = subset_queue.front();
+            const std::vector<Feature*>& subset = subsets[i];
+            if (subset.size() <= k)
+                continue;
             if (verbose_ > 1)
-                printf("#\tClustering subset %lu/%lu of size %lu\n", i + 1, ie, subset.size());
+                printf("#\tClustering subset %lu/%lu of size %lu\n", i + 1, nbSubsets, subset.size());
+            kmeansRandomGenerator().seed(seeds[i]);
+            kmeans_.clusterPointers(subset, k, subsetsCenters[i], memberships[i]);
+        }
+
+        std::vector<std::vector<Feature*>> next_subsets;
+        next_subsets.reserve(nbSubsets * k);
+
+        for (std::size_t i = 0; i < nbSubsets; ++i)
+        {
+            std::vector<Feature*>& subset = subsets[i];
 
             // If the subset already has k or fewer elements, just use those as the centers.
             if (subset.size() <= k)
@@ -130,33 +180,33 @@ void TreeBuilder<Feature, DistanceT, FeatureAllocator>::build(const FeatureVecto
                 tree_.centers().insert(tree_.centers().end(), k - subset.size(), zero_);
                 tree_.validCenters().insert(tree_.validCenters().end(), k - subset.size(), 0);
 
-                // Push k empty subsets into the queue so all children get marked invalid.
-                subset_queue.pop_front();
-                subset_queue.insert(subset_queue.end(), k, std::vector<Feature*>());
+                // Add k empty subsets so all children get marked invalid.
+                next_subsets.insert(next_subsets.end(), k, std::vector<Feature*>());
             }
             else
             {
-                // Cluster the current subset into k centers.
-                if (verbose_ > 2)
-                    printf("#\tclustering the current subset of %lu elements into %d centers\n", subset.size(), k);
-                kmeans_.clusterPointers(subset, k, centers, membership);
+                const FeatureVector& centers = subsetsCenters[i];
+                const std::vector<unsigned int>& membership = memberships[i];
                 // Add the centers and mark them as valid.
                 tree_.centers().insert(tree_.centers().end(), centers.begin(), centers.end());
                 tree_.validCenters().insert(tree_.validCenters().end(), k, 1);
                 // Partition the current subset into k new subsets based on the cluster assignments.
-                std::vector<std::vector<Feature*>> new_subsets(k);
+                const std::size_t first = next_subsets.size();
+                next_subsets.resize(first + k);
                 assert(membership.size() >= subset.size());
                 for (std::size_t j = 0; j < subset.size(); ++j)
                 {
                     assert(membership[j] < k);
-                    assert(membership[j] < new_subsets.size());
-                    new_subsets[membership[j]].push_back(subset[j]);
+                    next_subsets[first + membership[j]].push_back(subset[j]);
                 }
-                // Update the queue
-                subset_queue.pop_front();
-                subset_queue.insert(subset_queue.end(), new_subsets.begin(), new_subsets.end());
             }
+            // Release the memory of the subset as soon as it is partitioned
+            std::vector<Feature*>().swap(subset);
+            FeatureVector().swap(subsetsCenters[i]);
+            std::vector<unsigned int>().swap(memberships[i]);
         }
+        subsets.swap(next_subsets);
+
         if (verbose_)
             printf("# centers so far = %lu\n", tree_.centers().size());
     }
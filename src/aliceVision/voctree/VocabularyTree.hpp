@@ -19,8 +19,10 @@
 #include <stdint.h>
 #include <vector>
 #include <map>
+#include <algorithm>
 #include <cassert>
 #include <limits>
+#include <type_traits>
 #include <fstream>
 #include <stdexcept>
 #include <iostream>
@@ -88,6 +90,9 @@ class IVocabularyTree
 
 inline IVocabularyTree::~IVocabularyTree() {}
 
+/// Number of descriptors quantized together, level by level, by VocabularyTree::quantize
+constexpr std::size_t quantizationBlockSize = 64;
+
 /**
  * @brief Optimized vocabulary tree quantizer, templated on feature type and distance metric
  * for maximum efficiency.
@@ -118,7 +123,11 @@ class VocabularyTree : public IVocabularyTree
     template<class DescriptorT>
     Word quantize(const DescriptorT& feature) const;
 
-    /// Quantizes a set of features into visual words.
+    /**
+     * @brief Quantizes a set of features into visual words.
+     * @note The features are processed by blocks of quantizationBlockSize, level by level,
+     *       so the centers of the upper levels are shared by all the features of a block.
+     */
     template<class DescriptorT>
     std::vector<Word> quantize(const std::vector<DescriptorT>& features) const;
 
@@ -165,6 +174,25 @@ class VocabularyTree : public IVocabularyTree
     bool initialized() const { return num_words_ != 0; }
 
     void setNodeCounts();
+
+    /**
+     * @brief Check if the closest child can be found with the SIMD L2 kernels:
+     *        default L2 distance between feature::Descriptor of uint8 or float values.
+     */
+    template<class DescriptorT>
+    static constexpr bool useSimdL2()
+    {
+        return std::is_same<DescriptorT, Feature>::value && useSimdL2Distance<Feature, Distance<DescriptorT, Feature>>();
+    }
+
+    /**
+     * @brief Find the child of a node closest to the query, the first one in case of equality.
+     * @param[in] feature The query
+     * @param[in] firstChild The index of the first child of the node
+     * @param[in] kernels The distance kernels used by the SIMD path
+     */
+    template<class DescriptorT>
+    int32_t closestChild(const DescriptorT& feature, int32_t firstChild, const feature::DistanceKernels& kernels) const;
 };
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
@@ -187,25 +215,30 @@ VocabularyTree<Feature, Distance, FeatureAllocator>::VocabularyTree(const std::s
 
 template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
 template<class DescriptorT>
-Word VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const DescriptorT& feature) const
+int32_t VocabularyTree<Feature, Distance, FeatureAllocator>::closestChild(const DescriptorT& feature,
+                                                                          int32_t firstChild,
+                                                                          const feature::DistanceKernels& kernels) const
 {
     typedef typename Distance<Feature, DescriptorT>::result_type distance_type;
 
-    //	printf("asserting\n");
-    assert(initialized());
-    //	printf("initialized\n");
-    int32_t index = -1;  // virtual "root" index, which has no associated center.
-    for (unsigned level = 0; level < levels_; ++level)
+    // Number of valid children (fewer than splits() for some nodes).
+    int32_t nbChildren = 0;
+    while (nbChildren < (int32_t)splits() && valid_centers_[firstChild + nbChildren])
+        ++nbChildren;
+
+    if constexpr (useSimdL2<DescriptorT>())
     {
-        // Calculate the offset to the first child of the current index.
-        int32_t first_child = (index + 1) * splits();
-        // Find the child center closest to the query.
-        int32_t best_child = first_child;
+        if (nbChildren == 0)
+            return firstChild;
+        // The children of a node are contiguous in centers_.
+        return firstChild + static_cast<int32_t>(closestCenterSimdL2(feature, &centers_[firstChild], nbChildren, kernels));
+    }
+    else
+    {
+        int32_t best_child = firstChild;
         distance_type best_distance = std::numeric_limits<distance_type>::max();
-        for (int32_t child = first_child; child < first_child + (int32_t)splits(); ++child)
+        for (int32_t child = firstChild; child < firstChild + nbChildren; ++child)
         {
-            if (!valid_centers_[child])
-                break;  // Fewer than splits() children.
             distance_type child_distance = Distance<DescriptorT, Feature>()(feature, centers_[child]);
             if (child_distance < best_distance)
             {
@@ -213,7 +246,22 @@ Word VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const Descrip
                 best_distance = child_distance;
             }
         }
-        index = best_child;
+        return best_child;
+    }
+}
+
+template<class Feature, template<typename, typename> class Distance, class FeatureAllocator>
+template<class DescriptorT>
+Word VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(const DescriptorT& feature) const
+{
+    assert(initialized());
+    const feature::DistanceKernels& kernels = feature::getDistanceKernels();
+
+    int32_t index = -1;  // virtual "root" index, which has no associated center.
+    for (unsigned level = 0; level < levels_; ++level)
+    {
+        // Find the child center closest to the query.
+        index = closestChild(feature, (index + 1) * splits(), kernels);
     }
 
     return index - word_start_;
@@ -225,13 +273,35 @@ std::vector<Word> VocabularyTree<Feature, Distance, FeatureAllocator>::quantize(
 {
     // ALICEVISION_LOG_DEBUG("VocabularyTree quantize: " << features.size());
     std::vector<Word> imgVisualWords(features.size(), 0);
+    if (features.empty())
+        return imgVisualWords;
+
+    assert(initialized());
+    const feature::DistanceKernels& kernels = feature::getDistanceKernels();
+    const std::ptrdiff_t nbBlocks = (features.size() + quantizationBlockSize - 1) / quantizationBlockSize;
 
-// quantize the features
+// quantize the features by blocks, level by level
 #pragma omp parallel for
-    for (ptrdiff_t j = 0; j < static_cast<ptrdiff_t>(features.size()); ++j)
+    for (std::ptrdiff_t b = 0; b < nbBlocks; ++b)
     {
+        const std::size_t begin = b * quantizationBlockSize;
+        const std::size_t end = std::min(features.size(), begin + quantizationBlockSize);
+
+        int32_t index[quantizationBlockSize];
+        std::fill(index, index + (end - begin), -1);
+
+        for (unsigned level = 0; level < levels_; ++level)
+        {
+            for (std::size_t j = begin; j < end; ++j)
+            {
+                int32_t& nodeIndex = index[j - begin];
+                nodeIndex = closestChild(features[j], (nodeIndex + 1) * splits(), kernels);
+            }
+        }
+
         // store the visual word associated to the feature in the temporary list
-        imgVisualWords[j] = quantize<DescriptorT>(features[j]);
+        for (std::size_t j = begin; j < end; ++j)
+            imgVisualWords[j] = index[j - begin] - word_start_;
     }
 
     // add the vector to the documents
@@ -11,6 +11,9 @@
 #include <aliceVision/voctree/Database.hpp>
 #include <aliceVision/voctree/VocabularyTree.hpp>
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 #include <string>
 
 namespace aliceVision {
@@ -52,6 +55,41 @@ std::size_t readDescFromFiles(const sfmData::SfMData& sfmData,
                               std::vector<DescriptorT>& descriptors,
                               std::vector<std::size_t>& numFeatures);
 
+/**
+ * @brief Write a set of descriptors into a single raw file, one descriptor file at a time,
+ *        so the whole set of descriptors is never held in memory.
+ * @param[in] sfmDataPath The input sfmData
+ * @param[in] featuresFolders The folder(s) containing the descriptor files (optional)
+ * @param[in] outputFilepath The raw file of DescriptorT to write
+ * @param[in,out] numFeatures a vector collecting for each file read the number of features read
+ * @return the total number of features written
+ */
+template<class DescriptorT, class FileDescriptorT>
+std::size_t writeDescFromFiles(const sfmData::SfMData& sfmData,
+                               const std::vector<std::string>& featuresFolders,
+                               const std::string& outputFilepath,
+                               std::vector<std::size_t>& numFeatures);
+
+/**
+ * @brief Read-only memory mapping of a raw file of descriptors written by writeDescFromFiles,
+ *        the pages are loaded by the system when the descriptors are accessed.
+ */
+template<class DescriptorT>
+class MappedDescriptors
+{
+  public:
+    explicit MappedDescriptors(const std::string& filepath);
+
+    const DescriptorT* data() const { return _size == 0 ? nullptr : static_cast<const DescriptorT*>(_region.get_address()); }
+    std::size_t size() const { return _size; }
+    const DescriptorT& operator[](std::size_t i) const { return data()[i]; }
+
+  private:
+    boost::interprocess::file_mapping _mapping;
+    boost::interprocess::mapped_region _region;
+    std::size_t _size = 0;
+};
+
 }  // namespace voctree
 }  // namespace aliceVision
 
@@ -89,5 +89,54 @@ std::size_t readDescFromFiles(const sfmData::SfMData& sfmData,
   return numDescriptors;
 }
 
+template<class DescriptorT, class FileDescriptorT>
+std::size_t writeDescFromFiles(const sfmData::SfMData& sfmData,
+                               const std::vector<std::string>& featuresFolders,
+                               const std::string& outputFilepath,
+                               std::vector<std::size_t>& numFeatures)
+{
+  std::map<IndexT, std::string> descriptorsFiles;
+  getListOfDescriptorFiles(sfmData, featuresFolders, descriptorsFiles);
+
+  std::ofstream stream(outputFilepath, std::ios::out | std::ios::binary | std::ios::trunc);
+  if(!stream.is_open())
+    throw std::runtime_error("Unable to write the descriptors file: " + outputFilepath);
+
+  ALICEVISION_LOG_DEBUG("Writing the descriptors to " << outputFilepath << "...");
+  auto display = system::createConsoleProgressDisplay(descriptorsFiles.size(), std::cout);
+
+  std::size_t numDescriptors = 0;
+  std::vector<DescriptorT> descriptors;
+  for(const auto &currentFile : descriptorsFiles)
+  {
+    // only the descriptors of the current file are in memory
+    feature::loadDescsFromBinFile<DescriptorT, FileDescriptorT>(currentFile.second, descriptors, false);
+    stream.write(reinterpret_cast<const char*>(descriptors.data()), descriptors.size() * sizeof(DescriptorT));
+    if(!stream.good())
+      throw std::runtime_error("Unable to write the descriptors file: " + outputFilepath);
+
+    numFeatures.push_back(descriptors.size());
+    numDescriptors += descriptors.size();
+    ++display;
+  }
+  ALICEVISION_LOG_DEBUG("Wrote " << numDescriptors << " descriptors");
+  return numDescriptors;
+}
+
+template<class DescriptorT>
+MappedDescriptors<DescriptorT>::MappedDescriptors(const std::string& filepath)
+{
+  namespace bip = boost::interprocess;
+  const std::size_t fileSize = boost::filesystem::file_size(filepath);
+  if(fileSize % sizeof(DescriptorT) != 0)
+    throw std::runtime_error("Invalid descriptors file size: " + filepath);
+  _size = fileSize / sizeof(DescriptorT);
+  // an empty file cannot be mapped
+  if(_size == 0)
+    return;
+  _mapping = bip::file_mapping(filepath.c_str(), bip::read_only);
+  _region = bip::mapped_region(_mapping, bip::read_only);
+}
+
 } // namespace voctree
 } // namespace aliceVision
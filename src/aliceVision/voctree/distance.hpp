@@ -6,9 +6,19 @@
 
 #pragma once
 
+#include <aliceVision/feature/Descriptor.hpp>
+#include <aliceVision/feature/distanceKernels.hpp>
+
 #include <stdint.h>
 #include <Eigen/Core>
 
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
 namespace aliceVision {
 namespace voctree {
 
@@ -51,5 +61,119 @@ struct L2<Eigen::Matrix<Scalar, Rows, Cols, Options, MaxRows, MaxCols>, Eigen::M
     result_type operator()(const feature_type& a, const feature_type& b) const { return (a - b).squaredNorm(); }
 };
 
+/**
+ * @brief Describe the descriptors that can be compared with the SIMD L2 distance kernels
+ *        of the feature module: feature::Descriptor of uint8 or float values.
+ */
+template<class DescriptorT>
+struct SimdL2Descriptor
+{
+    static constexpr bool value = false;
+};
+
+template<std::size_t N>
+struct SimdL2Descriptor<feature::Descriptor<unsigned char, N>>
+{
+    static constexpr bool value = true;
+    using Scalar = unsigned char;
+    static constexpr std::size_t size = N;
+};
+
+template<std::size_t N>
+struct SimdL2Descriptor<feature::Descriptor<float, N>>
+{
+    static constexpr bool value = true;
+    using Scalar = float;
+    static constexpr std::size_t size = N;
+};
+
+/**
+ * @brief Check if a distance functor is the default L2 distance between descriptors supported
+ *        by closestCenterSimdL2.
+ */
+template<class Feature, class Distance>
+constexpr bool useSimdL2Distance()
+{
+    return SimdL2Descriptor<Feature>::value && std::is_same<Distance, L2<Feature, Feature>>::value;
+}
+
+/**
+ * @brief Find the center closest to a feature with the SIMD L2 distance kernels,
+ *        the first one in case of equality.
+ *
+ * The result is the same as with the L2 functor: the uint8 distance is exact, and the float
+ * distances are only used to discard the centers that cannot be the closest one. The centers
+ * within the accumulated rounding error of the minimum are compared with the double L2 distance.
+ *
+ * @param[in] feature The query
+ * @param[in] centers The contiguous centers
+ * @param[in] nbCenters The number of centers, at least one
+ * @param[in] kernels The distance kernels
+ * @return the index of the closest center
+ */
+template<class Feature>
+std::size_t closestCenterSimdL2(const Feature& feature, const Feature* centers, std::size_t nbCenters, const feature::DistanceKernels& kernels)
+{
+    using Traits = SimdL2Descriptor<Feature>;
+    static_assert(Traits::value, "Unsupported descriptor type");
+    static_assert(sizeof(Feature) == Traits::size * sizeof(typename Traits::Scalar), "Descriptors must be contiguous");
+    assert(nbCenters > 0);
+
+    const typename Traits::Scalar* query = feature.getData();
+    const typename Traits::Scalar* data = centers[0].getData();
+
+    if constexpr (std::is_same<typename Traits::Scalar, unsigned char>::value)
+    {
+        std::size_t best = 0;
+        std::uint32_t bestDistance = std::numeric_limits<std::uint32_t>::max();
+        for (std::size_t i = 0; i < nbCenters; ++i)
+        {
+            const std::uint32_t distance = kernels.l2UChar(query, data + i * Traits::size, Traits::size);
+            if (distance < bestDistance)
+            {
+                best = i;
+                bestDistance = distance;
+            }
+        }
+        return best;
+    }
+    else
+    {
+        float distances[256];
+        std::vector<float> distancesBuffer;
+        float* centerDistances = distances;
+        if (nbCenters > 256)
+        {
+            distancesBuffer.resize(nbCenters);
+            centerDistances = distancesBuffer.data();
+        }
+
+        float bestFloatDistance = std::numeric_limits<float>::max();
+        for (std::size_t i = 0; i < nbCenters; ++i)
+        {
+            centerDistances[i] = kernels.l2Float(query, data + i * Traits::size, Traits::size);
+            bestFloatDistance = std::min(bestFloatDistance, centerDistances[i]);
+        }
+        const float relativeError = 4.0f * (Traits::size + 4) * FLT_EPSILON;
+        const float maxFloatDistance = bestFloatDistance * (1.0f + relativeError) + Traits::size * FLT_MIN;
+
+        const L2<Feature, Feature> distance;
+        std::size_t best = 0;
+        double bestDistance = std::numeric_limits<double>::max();
+        for (std::size_t i = 0; i < nbCenters; ++i)
+        {
+            if (centerDistances[i] > maxFloatDistance)
+                continue;
+            const double d = distance(feature, centers[i]);
+            if (d < bestDistance)
+            {
+                best = i;
+                bestDistance = d;
+            }
+        }
+        return best;
+    }
+}
+
 }  // namespace voctree
 }  // namespace aliceVision
@@ -7,6 +7,7 @@
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/numeric/numeric.hpp>
 #include <aliceVision/voctree/SimpleKmeans.hpp>
+#include <aliceVision/feature/Descriptor.hpp>
 
 #include <iostream>
 #include <fstream>
@@ -306,3 +307,100 @@ BOOST_AUTO_TEST_CASE(kmeanVarying)
         }
     }
 }
+
+/**
+ * @brief Generate K well separated clusters of FEATURENUMBER descriptors around the diagonal.
+ */
+template<class DescriptorT>
+std::vector<DescriptorT> generateDescriptorClusters(std::size_t K, std::size_t FEATURENUMBER, float step, float noise, std::mt19937& generator)
+{
+    std::uniform_real_distribution<float> noiseDistribution(0.0f, noise);
+    std::vector<DescriptorT> features;
+    features.reserve(K * FEATURENUMBER);
+    for (std::size_t i = 0; i < K; ++i)
+    {
+        for (std::size_t j = 0; j < FEATURENUMBER; ++j)
+        {
+            DescriptorT feature;
+            for (std::size_t d = 0; d < feature.size(); ++d)
+                feature[d] = static_cast<typename DescriptorT::value_type>(step * i + noiseDistribution(generator));
+            features.push_back(feature);
+        }
+    }
+    return features;
+}
+
+BOOST_AUTO_TEST_CASE(kmeanDescriptors)
+{
+    using namespace aliceVision;
+    ALICEVISION_LOG_DEBUG("Testing kmeans with the SIMD distances on descriptors...");
+
+    makeRandomOperationsReproducible();
+
+    const std::size_t K = 8;
+    const std::size_t FEATURENUMBER = 200;
+    std::mt19937 generator(0);
+
+    typedef feature::Descriptor<float, 128> DescriptorFloat;
+    const std::vector<DescriptorFloat> features = generateDescriptorClusters<DescriptorFloat>(K, FEATURENUMBER, 0.1f, 0.03f, generator);
+
+    std::vector<DescriptorFloat> centers;
+    std::vector<unsigned int> membership;
+    voctree::SimpleKmeans<DescriptorFloat> kmeans(DescriptorFloat(0));
+    kmeans.setRestarts(3);
+    kmeans.cluster(features, K, centers, membership);
+
+    std::vector<std::size_t> h(K, 0);
+    for (unsigned int m : membership)
+        ++h[m];
+    for (std::size_t i = 0; i < K; ++i)
+        BOOST_CHECK_EQUAL(h[i], FEATURENUMBER);
+
+    // the features of a cluster share the same center
+    for (std::size_t i = 0; i < K; ++i)
+    {
+        for (std::size_t j = 1; j < FEATURENUMBER; ++j)
+            BOOST_CHECK_EQUAL(membership[i * FEATURENUMBER + j], membership[i * FEATURENUMBER]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(kmeanMiniBatch)
+{
+    using namespace aliceVision;
+    ALICEVISION_LOG_DEBUG("Testing mini-batch kmeans...");
+
+    makeRandomOperationsReproducible();
+
+    typedef feature::Descriptor<float, 128> DescriptorFloat;
+
+    const std::size_t K = 10;
+    const std::size_t FEATURENUMBER = 1000;
+    std::mt19937 generator(0);
+    const std::vector<DescriptorFloat> features = generateDescriptorClusters<DescriptorFloat>(K, FEATURENUMBER, 0.1f, 0.03f, generator);
+
+    std::vector<DescriptorFloat> centers;
+    std::vector<unsigned int> membership;
+    voctree::SimpleKmeans<DescriptorFloat> kmeans(DescriptorFloat(0));
+    kmeans.setRestarts(3);
+    kmeans.setMiniBatchSize(500);
+    kmeans.setMaxIterations(50);
+    const voctree::SimpleKmeans<DescriptorFloat>::squared_distance_type sse = kmeans.cluster(features, K, centers, membership);
+
+    BOOST_CHECK_EQUAL(centers.size(), K);
+    BOOST_CHECK_EQUAL(membership.size(), features.size());
+
+    // each cluster is found, its center is inside the noise box of the cluster
+    std::vector<std::size_t> h(K, 0);
+    for (unsigned int m : membership)
+        ++h[m];
+    for (std::size_t i = 0; i < K; ++i)
+    {
+        BOOST_CHECK_EQUAL(h[i], FEATURENUMBER);
+        const DescriptorFloat& center = centers[membership[i * FEATURENUMBER]];
+        BOOST_CHECK_GE(center[0], 0.1f * i);
+        BOOST_CHECK_LE(center[0], 0.1f * i + 0.03f);
+    }
+
+    // the error is the one of the uniform noise around the cluster centers: 128 * 0.03^2 / 12 per feature
+    BOOST_CHECK_LT(sse, 1.2 * features.size() * 128 * 0.03 * 0.03 / 12.0);
+}
@@ -6,11 +6,14 @@
 
 #include <aliceVision/voctree/TreeBuilder.hpp>
 #include <aliceVision/system/Logger.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/feature/Descriptor.hpp>
 
 #include <Eigen/Core>
 
 #include <iostream>
 #include <fstream>
+#include <random>
 #include <vector>
 
 #define BOOST_TEST_MODULE voctreeBuilder
@@ -87,3 +90,45 @@ BOOST_AUTO_TEST_CASE(voctreeBuilder)
     }
     //  voctree::printFeatVector( features );
 }
+
+BOOST_AUTO_TEST_CASE(voctreeBuilderThreads)
+{
+    using namespace aliceVision;
+
+    typedef feature::Descriptor<float, 128> DescriptorFloat;
+
+    const std::size_t K = 6;
+    const std::size_t LEVELS = 3;
+    const std::size_t FEATURENUMBER = 3000;
+
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    std::vector<DescriptorFloat> features(FEATURENUMBER);
+    for (DescriptorFloat& feature : features)
+    {
+        for (std::size_t d = 0; d < feature.size(); ++d)
+            feature[d] = distribution(generator);
+    }
+
+    // the tree only depends on the random seed, not on the number of threads
+    auto build = [&](int nbThreads) {
+        const int maxThreads = omp_get_max_threads();
+        omp_set_num_threads(nbThreads);
+        voctree::kmeansRandomGenerator().seed(42);
+        voctree::TreeBuilder<DescriptorFloat> builder(DescriptorFloat(0));
+        builder.kmeans().setRestarts(2);
+        builder.build(features.data(), features.size(), K, LEVELS);
+        omp_set_num_threads(maxThreads);
+        return builder.tree().centers();
+    };
+
+    const std::vector<DescriptorFloat> centers1 = build(1);
+    const std::vector<DescriptorFloat> centers4 = build(4);
+
+    BOOST_CHECK_EQUAL(centers1.size(), centers4.size());
+    for (std::size_t i = 0; i < std::min(centers1.size(), centers4.size()); ++i)
+    {
+        for (std::size_t d = 0; d < centers1[i].size(); ++d)
+            BOOST_CHECK_EQUAL(centers1[i][d], centers4[i][d]);
+    }
+}
@@ -0,0 +1,109 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/voctree/MutableVocabularyTree.hpp>
+#include <aliceVision/feature/Descriptor.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_MODULE vocabularyTreeQuantize
+
+#include <boost/test/unit_test.hpp>
+
+using namespace aliceVision;
+using namespace aliceVision::voctree;
+
+/**
+ * @brief Same distance as L2 but not detected as the default one,
+ *        so the tree uses the generic per child evaluation.
+ */
+template<class DescriptorA, class DescriptorB = DescriptorA>
+struct ReferenceL2 : public L2<DescriptorA, DescriptorB>
+{};
+
+template<class DescriptorT, template<typename, typename> class Distance>
+void buildRandomTree(MutableVocabularyTree<DescriptorT, Distance>& tree, uint32_t levels, uint32_t splits, double maxValue, std::mt19937& generator)
+{
+    tree.setSize(levels, splits);
+    tree.centers().resize(tree.nodes());
+    tree.validCenters().resize(tree.nodes(), 1);
+
+    std::uniform_real_distribution<double> valueDistribution(0.0, maxValue);
+    for (DescriptorT& center : tree.centers())
+    {
+        for (std::size_t i = 0; i < center.size(); ++i)
+            center[i] = static_cast<typename DescriptorT::value_type>(valueDistribution(generator));
+    }
+
+    // some nodes with fewer children than the branching factor
+    for (uint32_t firstChild = 0; firstChild < tree.nodes(); firstChild += 7 * splits)
+        tree.validCenters()[firstChild + splits - 1] = 0;
+
+    // some duplicated children to check the choice between equal distances
+    for (uint32_t firstChild = 0; firstChild < tree.nodes(); firstChild += 3 * splits)
+        tree.centers()[firstChild + 1] = tree.centers()[firstChild];
+}
+
+template<class DescriptorT>
+void checkQuantization(double maxValue)
+{
+    const uint32_t levels = 4;
+    const uint32_t splits = 10;
+    const std::size_t nbDescriptors = 20000;
+
+    std::mt19937 generator(42);
+    MutableVocabularyTree<DescriptorT> tree;
+    buildRandomTree(tree, levels, splits, maxValue, generator);
+
+    MutableVocabularyTree<DescriptorT, ReferenceL2> referenceTree;
+    referenceTree.setSize(levels, splits);
+    referenceTree.centers() = tree.centers();
+    referenceTree.validCenters() = tree.validCenters();
+
+    // random descriptors and copies of centers (null distances and exact ties)
+    std::vector<DescriptorT> descriptors(nbDescriptors);
+    std::uniform_real_distribution<double> valueDistribution(0.0, maxValue);
+    std::uniform_int_distribution<std::size_t> centerDistribution(0, tree.centers().size() - 1);
+    for (std::size_t d = 0; d < nbDescriptors; ++d)
+    {
+        if (d % 10 == 0)
+        {
+            descriptors[d] = tree.centers()[centerDistribution(generator)];
+            continue;
+        }
+        for (std::size_t i = 0; i < descriptors[d].size(); ++i)
+            descriptors[d][i] = static_cast<typename DescriptorT::value_type>(valueDistribution(generator));
+    }
+
+    system::Timer timer;
+    const std::vector<Word> referenceWords = referenceTree.quantize(descriptors);
+    const double referenceTime = timer.elapsed();
+
+    timer.reset();
+    const std::vector<Word> words = tree.quantize(descriptors);
+    const double time = timer.elapsed();
+
+    ALICEVISION_LOG_INFO("Quantization of " << nbDescriptors << " descriptors in a " << levels << "x" << splits << " tree:" << std::endl
+                                            << "\t- generic: " << nbDescriptors / referenceTime << " descriptors/s" << std::endl
+                                            << "\t- "
+                                            << feature::EDistanceKernel_enumToString(feature::getBestDistanceKernel())
+                                            << " kernels: " << nbDescriptors / time << " descriptors/s");
+
+    BOOST_CHECK(words == referenceWords);
+
+    for (std::size_t d = 0; d < nbDescriptors; d += 97)
+    {
+        BOOST_CHECK_EQUAL(tree.quantize(descriptors[d]), referenceWords[d]);
+        BOOST_CHECK_EQUAL(referenceTree.quantize(descriptors[d]), referenceWords[d]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(VocabularyTreeQuantize_uchar) { checkQuantization<feature::Descriptor<unsigned char, 128>>(255.0); }
+
+BOOST_AUTO_TEST_CASE(VocabularyTreeQuantize_float) { checkQuantization<feature::Descriptor<float, 128>>(1.0); }
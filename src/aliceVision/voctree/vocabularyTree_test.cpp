@@ -6,8 +6,12 @@
 
 #include <aliceVision/voctree/Database.hpp>
 
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <random>
 #include <vector>
 
 #define BOOST_TEST_MODULE vocabularyTree
@@ -57,3 +61,289 @@ BOOST_AUTO_TEST_CASE(database)
         BOOST_CHECK_SMALL(static_cast<double>(match[0].score), 0.001);
     }
 }
+
+namespace {
+
+/// Reference search: sparseDistance between the query and each document histogram
+DocMatches referenceFind(const SparseHistogram& query,
+                         const SparseHistogramPerImage& documents,
+                         std::size_t N,
+                         const std::string& distanceMethod,
+                         const std::vector<float>& weights)
+{
+    DocMatches matches;
+    for (const auto& document : documents)
+        matches.emplace_back(document.first, sparseDistance(query, document.second, distanceMethod, weights));
+    // equal scores sorted by ID
+    std::sort(matches.begin(), matches.end(), [](const DocMatch& a, const DocMatch& b) { return a.score < b.score || (a.score == b.score && a.id < b.id); });
+    matches.resize(std::min(N, matches.size()));
+    return matches;
+}
+
+SparseHistogram randomHistogram(std::size_t nbWords, std::size_t nbFeatures, std::mt19937& generator)
+{
+    std::uniform_int_distribution<Word> wordDistribution(0, nbWords - 1);
+    std::vector<Word> document(nbFeatures);
+    for (Word& word : document)
+        word = wordDistribution(generator);
+    SparseHistogram histogram;
+    computeSparseHistogram(document, histogram);
+    return histogram;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_CASE(database_postings)
+{
+    const std::size_t nbWords = 500;
+    const std::size_t nbDocuments = 60;
+    const std::size_t N = 10;
+    const std::vector<std::string> distanceMethods = {"classic", "commonPoints", "strongCommonPoints", "inversedWeightedCommonPoints"};
+
+    std::mt19937 generator(7);
+    SparseHistogramPerImage documents;
+    Database db(nbWords);
+    for (std::size_t i = 0; i < nbDocuments; ++i)
+    {
+        // non contiguous IDs, inserted in random order
+        const DocId docId = static_cast<DocId>((i * 7919) % 1009);
+        documents[docId] = randomHistogram(nbWords, 200, generator);
+        db.insert(docId, documents[docId]);
+    }
+    db.computeTfIdfWeights();
+
+    // TF-IDF weights of the database
+    std::vector<float> weights(nbWords, 1.0f);
+    for (std::size_t w = 0; w < nbWords; ++w)
+    {
+        const auto Ni = std::count_if(documents.begin(), documents.end(), [&](const auto& document) { return document.second.count(w) != 0; });
+        if (Ni != 0)
+            weights[w] = std::log(float(nbDocuments) / Ni);
+    }
+
+    BOOST_CHECK_EQUAL(db.size(), nbDocuments);
+
+    // scores computed from the posting lists are the same as the histogram distances
+    for (const std::string& distanceMethod : distanceMethods)
+    {
+        for (const auto& document : documents)
+        {
+            const SparseHistogram query = (document.first % 2) ? document.second : randomHistogram(nbWords, 150, generator);
+            DocMatches matches;
+            db.find(query, N, matches, distanceMethod);
+            BOOST_CHECK(matches == referenceFind(query, documents, N, distanceMethod, weights));
+
+            db.find(document.first, N, matches, distanceMethod);
+            BOOST_CHECK(matches == referenceFind(document.second, documents, N, distanceMethod, weights));
+        }
+    }
+
+    // save, load and insert new documents
+    const std::string databaseFile = "voctree_database_test.db";
+    db.save(databaseFile);
+
+    Database loadedDb;
+    loadedDb.load(databaseFile);
+    BOOST_CHECK_EQUAL(loadedDb.size(), nbDocuments);
+    BOOST_CHECK(loadedDb.getSparseHistogramPerImage().empty());
+
+    for (std::size_t i = 0; i < 20; ++i)
+    {
+        const DocId docId = static_cast<DocId>(2000 + (i * 13) % 20);
+        documents[docId] = randomHistogram(nbWords, 200, generator);
+        db.insert(docId, documents[docId]);
+        loadedDb.insert(docId, documents[docId]);
+    }
+    BOOST_CHECK(loadedDb.contains(2000));
+    BOOST_CHECK(!loadedDb.contains(3000));
+    BOOST_CHECK_EQUAL(loadedDb.size(), nbDocuments + 20);
+
+    // save over the memory-mapped file and load again
+    loadedDb.save(databaseFile);
+    Database reloadedDb;
+    reloadedDb.load(databaseFile);
+
+    for (const std::string& distanceMethod : distanceMethods)
+    {
+        for (const auto& document : documents)
+        {
+            DocMatches matches;
+            db.find(document.second, N, matches, distanceMethod);
+            DocMatches loadedMatches;
+            loadedDb.find(document.second, N, loadedMatches, distanceMethod);
+            BOOST_CHECK(loadedMatches == matches);
+            reloadedDb.find(document.first, N, loadedMatches, distanceMethod);
+            BOOST_CHECK(loadedMatches == matches);
+        }
+    }
+
+    // posting list offset beyond the posting lists
+    const std::string corruptedFile = "voctree_database_corrupted_test.db";
+    {
+        std::ifstream in(databaseFile, std::ios_base::binary);
+        std::ofstream out(corruptedFile, std::ios_base::binary);
+        out << in.rdbuf();
+    }
+    {
+        const uint64_t fileSize = boost::filesystem::file_size(corruptedFile);
+        const uint64_t postingsOffsetsPosition = fileSize - (nbWords + 1 + reloadedDb.size() + 1) * sizeof(uint64_t);
+        std::fstream file(corruptedFile, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+        file.seekp(postingsOffsetsPosition + sizeof(uint64_t));
+        file.write(reinterpret_cast<const char*>(&fileSize), sizeof(uint64_t));
+    }
+    Database corruptedDb;
+    BOOST_CHECK_THROW(corruptedDb.load(corruptedFile), std::runtime_error);
+
+    boost::filesystem::remove(corruptedFile);
+    boost::filesystem::remove(databaseFile);
+}
+
+BOOST_AUTO_TEST_CASE(database_saveOverLoadedFile)
+{
+    const std::size_t nbWords = 300;
+    const std::size_t N = 10;
+    const std::vector<std::string> distanceMethods = {"classic", "commonPoints", "strongCommonPoints", "inversedWeightedCommonPoints"};
+
+    std::mt19937 generator(5);
+    SparseHistogramPerImage documents;
+    Database db(nbWords);
+    auto addDocuments = [&](DocId firstId, std::size_t nbDocuments, std::vector<Database*> databases) {
+        for (std::size_t i = 0; i < nbDocuments; ++i)
+        {
+            const DocId docId = firstId + static_cast<DocId>(i);
+            documents[docId] = randomHistogram(nbWords, 120, generator);
+            for (Database* database : databases)
+                database->insert(docId, documents[docId]);
+        }
+    };
+
+    const std::string databaseFile = "voctree_database_overwrite_test.db";
+    {
+        Database firstDb(nbWords);
+        addDocuments(0, 20, {&db, &firstDb});
+        firstDb.save(databaseFile);
+    }
+
+    // load, insert and save onto the loaded file
+    Database loadedDb;
+    loadedDb.load(databaseFile);
+    addDocuments(100, 20, {&db, &loadedDb});
+    loadedDb.save(databaseFile);
+
+    // the saved database does not use the file anymore
+    {
+        std::ofstream file(databaseFile, std::ios_base::binary | std::ios_base::trunc);
+    }
+    addDocuments(200, 20, {&db, &loadedDb});
+    BOOST_CHECK_EQUAL(loadedDb.size(), db.size());
+
+    // save again without mapping and reload
+    loadedDb.save(databaseFile);
+    Database reloadedDb;
+    reloadedDb.load(databaseFile);
+    BOOST_CHECK_EQUAL(reloadedDb.size(), db.size());
+
+    for (const std::string& distanceMethod : distanceMethods)
+    {
+        for (const auto& document : documents)
+        {
+            DocMatches matches;
+            db.find(document.second, N, matches, distanceMethod);
+            DocMatches loadedMatches;
+            loadedDb.find(document.second, N, loadedMatches, distanceMethod);
+            BOOST_CHECK(loadedMatches == matches);
+            reloadedDb.find(document.first, N, loadedMatches, distanceMethod);
+            BOOST_CHECK(loadedMatches == matches);
+        }
+    }
+
+    boost::filesystem::remove(databaseFile);
+}
+
+BOOST_AUTO_TEST_CASE(database_findBatch)
+{
+    const std::size_t nbWords = 2000;
+    const std::size_t nbDocuments = 9000;  // several blocks of documents
+    const std::size_t nbQueries = 100;     // several blocks of queries
+    const std::size_t N = 15;
+    const std::vector<std::string> distanceMethods = {"classic", "commonPoints", "strongCommonPoints", "inversedWeightedCommonPoints"};
+
+    std::mt19937 generator(11);
+    SparseHistogramPerImage documents;
+    Database db(nbWords);
+    for (std::size_t i = 0; i < nbDocuments; ++i)
+    {
+        const DocId docId = static_cast<DocId>((i * 7919) % 10007);
+        documents[docId] = randomHistogram(nbWords, 100, generator);
+        db.insert(docId, documents[docId]);
+    }
+    db.computeTfIdfWeights();
+
+    std::vector<float> weights(nbWords, 1.0f);
+    {
+        std::vector<std::size_t> Ni(nbWords, 0);
+        for (const auto& document : documents)
+            for (const auto& word : document.second)
+                ++Ni[word.first];
+        for (std::size_t w = 0; w < nbWords; ++w)
+            if (Ni[w] != 0)
+                weights[w] = std::log(float(nbDocuments) / Ni[w]);
+    }
+
+    std::vector<SparseHistogram> queries;
+    std::vector<DocId> queriesIds;
+    for (const auto& document : documents)
+    {
+        if (queries.size() == nbQueries)
+            break;
+        queries.push_back(randomHistogram(nbWords, 80, generator));
+        queriesIds.push_back(document.first);
+    }
+
+    // save and load a part of the database, to query mapped and inserted documents together
+    const std::string databaseFile = "voctree_database_batch_test.db";
+    Database partialDb(nbWords);
+    auto documentIt = documents.begin();
+    for (std::size_t i = 0; i < nbDocuments / 2; ++i, ++documentIt)
+        partialDb.insert(documentIt->first, documentIt->second);
+    partialDb.save(databaseFile);
+    Database mixedDb;
+    mixedDb.load(databaseFile);
+    for (; documentIt != documents.end(); ++documentIt)
+        mixedDb.insert(documentIt->first, documentIt->second);
+    const std::string weightsFile = "voctree_database_batch_test.weights";
+    db.saveWeights(weightsFile);
+    mixedDb.loadWeights(weightsFile);
+
+    for (const std::string& distanceMethod : distanceMethods)
+    {
+        std::vector<DocMatches> batchMatches;
+        db.findBatch(queries, N, batchMatches, distanceMethod);
+        BOOST_REQUIRE_EQUAL(batchMatches.size(), queries.size());
+
+        for (std::size_t q = 0; q < queries.size(); ++q)
+        {
+            DocMatches matches;
+            db.find(queries[q], N, matches, distanceMethod);
+            BOOST_CHECK(batchMatches[q] == matches);
+            if (q % 10 == 0)
+                BOOST_CHECK(batchMatches[q] == referenceFind(queries[q], documents, N, distanceMethod, weights));
+        }
+
+        std::vector<DocMatches> documentsMatches;
+        db.findBatch(queriesIds, N, documentsMatches, distanceMethod);
+        for (std::size_t q = 0; q < queriesIds.size(); ++q)
+        {
+            DocMatches matches;
+            db.find(queriesIds[q], N, matches, distanceMethod);
+            BOOST_CHECK(documentsMatches[q] == matches);
+        }
+
+        std::vector<DocMatches> mixedMatches;
+        mixedDb.findBatch(queries, N, mixedMatches, distanceMethod);
+        BOOST_CHECK(mixedMatches == batchMatches);
+    }
+
+    boost::filesystem::remove(databaseFile);
+    boost::filesystem::remove(weightsFile);
+}
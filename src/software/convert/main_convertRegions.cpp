@@ -0,0 +1,127 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/sfm/pipeline/regionsIO.hpp>
+#include <aliceVision/feature/RegionsContainer.hpp>
+#include <aliceVision/feature/imageDescriberCommon.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/cmdline/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/config.hpp>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+// convert the per-view .feat/.desc files into one memory-mapped regions container per describer type
+int aliceVision_main(int argc, char** argv)
+{
+    // command-line parameters
+    std::string sfmDataFilename;
+    std::vector<std::string> featuresFolders;
+    std::string outputFolder;
+
+    // user optional parameters
+    std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
+
+    // clang-format off
+    po::options_description requiredParams("Required parameters");
+    requiredParams.add_options()
+        ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
+         "SfMData file.")
+        ("featuresFolders,f", po::value<std::vector<std::string>>(&featuresFolders)->multitoken()->required(),
+         "Path to folder(s) containing the extracted features.")
+        ("output,o", po::value<std::string>(&outputFolder)->required(),
+         "Output folder for the regions containers.");
+
+    po::options_description optionalParams("Optional parameters");
+    optionalParams.add_options()
+        ("describerTypes,d", po::value<std::string>(&describerTypesName)->default_value(describerTypesName),
+         feature::EImageDescriberType_informations().c_str());
+    // clang-format on
+
+    CmdLine cmdline("AliceVision convertRegions");
+    cmdline.add(requiredParams);
+    cmdline.add(optionalParams);
+    if (!cmdline.execute(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    // load input SfMData scene
+    sfmData::SfMData sfmData;
+    if (!sfmDataIO::Load(sfmData, sfmDataFilename, sfmDataIO::ESfMData(sfmDataIO::VIEWS)))
+    {
+        ALICEVISION_LOG_ERROR("The input SfMData file '" << sfmDataFilename << "' cannot be read");
+        return EXIT_FAILURE;
+    }
+
+    if (!fs::exists(outputFolder))
+        fs::create_directory(outputFolder);
+
+    // same folder priority as the other pipeline steps
+    std::vector<std::string> allFeaturesFolders = sfmData.getFeaturesFolders();
+    allFeaturesFolders.insert(allFeaturesFolders.end(), featuresFolders.begin(), featuresFolders.end());
+
+    const std::vector<feature::EImageDescriberType> describerTypes = feature::EImageDescriberType_stringToEnums(describerTypesName);
+
+    for (const feature::EImageDescriberType describerType : describerTypes)
+    {
+        const std::unique_ptr<feature::ImageDescriber> imageDescriber = feature::createImageDescriber(describerType);
+        const std::string filename = feature::getRegionsContainerFilename(outputFolder, describerType);
+
+        // write in a temporary file, an existing container may be one of the inputs
+        const std::string tmpFilename = filename + ".tmp";
+
+        std::size_t nbViews = 0;
+        {
+            feature::RegionsContainerWriter writer(tmpFilename, describerType);
+            // released before the rename, an input container may be replaced
+            sfm::RegionsContainersCache containersCache;
+
+            for (const auto& viewPair : sfmData.getViews())
+            {
+                const IndexT viewId = viewPair.first;
+                std::unique_ptr<feature::Regions> regions;
+
+                try
+                {
+                    regions = sfm::loadRegions(allFeaturesFolders, viewId, *imageDescriber, &containersCache);
+                }
+                catch (const std::exception& e)
+                {
+                    ALICEVISION_LOG_WARNING("No " << feature::EImageDescriberType_enumToString(describerType) << " regions for view " << viewId
+                                                  << ": " << e.what());
+                    continue;
+                }
+
+                writer.addRegions(viewId, *regions);
+                ++nbViews;
+            }
+            writer.close();
+        }
+
+        fs::rename(tmpFilename, filename);
+
+        ALICEVISION_LOG_INFO("Regions container '" << filename << "': " << nbViews << " views.");
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -26,7 +26,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -49,6 +49,7 @@ int aliceVision_main(int argc, char **argv)
   bool flagExtrinsics = true;
   bool flagStructure = true;
   bool flagObservations = true;
+  bool compressBinary = false;
 
   po::options_description requiredParams("Required parameters");
   requiredParams.add_options()
@@ -72,7 +73,10 @@ int aliceVision_main(int argc, char **argv)
     ("structure", po::value<bool>(&flagStructure)->default_value(flagStructure),
       "Export structure.")
     ("observations", po::value<bool>(&flagObservations)->default_value(flagObservations),
-      "Export observations.");
+      "Export observations.")
+    ("compressBinary", po::value<bool>(&compressBinary)->default_value(compressBinary),
+      "Compress the blocks of a binary SfMData output file (.sfmb). "
+      "Compressed landmarks are decompressed in memory at the first access instead of being read on demand.");
 
   CmdLine cmdline("AliceVision convertSfMFormat");
   cmdline.add(requiredParams);
@@ -186,7 +190,7 @@ int aliceVision_main(int argc, char **argv)
       sfmData.getLandmarks().erase(landmarkId);
   }
   // export the SfMData scene in the expected format
-  if(!sfmDataIO::Save(sfmData, outputSfMDataFilename, sfmDataIO::ESfMData(flags)))
+  if(!sfmDataIO::Save(sfmData, outputSfMDataFilename, sfmDataIO::ESfMData(flags), compressBinary))
   {
     ALICEVISION_LOG_ERROR("An error occured while trying to save '" << outputSfMDataFilename << "'");
     return EXIT_FAILURE;
@@ -22,7 +22,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -42,6 +42,7 @@ int aliceVision_main(int argc, char **argv)
   std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
   std::vector<std::string> matchesFolders;
   int randomSeed = std::mt19937::default_seed;
+  int regionsCacheSize = 0;
 
   po::options_description requiredParams("Required parameters");
   requiredParams.add_options()
@@ -63,6 +64,9 @@ int aliceVision_main(int argc, char **argv)
         "If set to 0 it lets the ACRansac select an optimal value.")
     ("randomSeed", po::value<int>(&randomSeed)->default_value(randomSeed),
         "This seed value will generate a sequence using a linear random generator. Set -1 to use a random seed.")
+    ("regionsCacheSize", po::value<int>(&regionsCacheSize)->default_value(regionsCacheSize),
+      "Maximum amount of regions data (in MB) kept in memory for the guided matching. The regions are loaded on demand for windows of image pairs "
+      "and the least recently used ones are released (0 to load the regions of all the views up front).")
     ;
 
   CmdLine cmdline("AliceVision computeStructureFromKnownPoses");
@@ -73,6 +77,12 @@ int aliceVision_main(int argc, char **argv)
       return EXIT_FAILURE;
   }
 
+  if(regionsCacheSize < 0)
+  {
+    ALICEVISION_LOG_ERROR("The regions cache size must be positive.");
+    return EXIT_FAILURE;
+  }
+
   std::mt19937 randomNumberGenerator(randomSeed == -1 ? std::random_device()() : randomSeed);
   
   // load input SfMData scene
@@ -91,7 +101,7 @@ int aliceVision_main(int argc, char **argv)
 
   // prepare the Regions provider
   feature::RegionsPerView regionsPerView;
-  if(!sfm::loadRegionsPerView(regionsPerView, sfmData, featuresFolders, describerMethodTypes))
+  if(regionsCacheSize == 0 && !sfm::loadRegionsPerView(regionsPerView, sfmData, featuresFolders, describerMethodTypes))
   {
     ALICEVISION_LOG_ERROR("Invalid regions.");
     return EXIT_FAILURE;
@@ -128,10 +138,61 @@ int aliceVision_main(int argc, char **argv)
 
   // compute Structure from known camera poses
   sfm::StructureEstimationFromKnownPoses structureEstimator;
-  structureEstimator.match(sfmData, pairs, regionsPerView, geometricErrorMax);
+  if(regionsCacheSize > 0)
+  {
+    const std::size_t regionsCacheBytes = static_cast<std::size_t>(regionsCacheSize) * 1024 * 1024;
+
+    std::map<IndexT, std::size_t> regionsSizePerView;
+    if(!sfm::getRegionsSizePerView(regionsSizePerView, sfmData, featuresFolders, describerMethodTypes))
+    {
+      ALICEVISION_LOG_ERROR("Invalid regions.");
+      return EXIT_FAILURE;
+    }
+
+    // the regions of a window and the prefetched regions of the next window fit in the cache
+    std::size_t maxRegionsSize = 1;
+    for(const auto& regionsSize: regionsSizePerView)
+      maxRegionsSize = std::max(maxRegionsSize, regionsSize.second);
+    const std::size_t maxViewsPerWindow = std::max<std::size_t>(2, regionsCacheBytes / (2 * maxRegionsSize));
+
+    ALICEVISION_LOG_INFO("Load features and descriptors on demand: " << regionsCacheSize << " MB regions cache, windows of " << maxViewsPerWindow << " views.");
+
+    std::unique_ptr<feature::RegionsCache> regionsCache = sfm::createRegionsCache(sfmData, featuresFolders, describerMethodTypes, regionsCacheBytes);
+    structureEstimator.match(sfmData, pairs, *regionsCache, maxViewsPerWindow, geometricErrorMax);
 
-  // unload descriptors before triangulation
-  regionsPerView.clearDescriptors();
+    const feature::RegionsCacheStats stats = regionsCache->getStats();
+    ALICEVISION_LOG_INFO("Regions cache: " << stats.bytesRead / (1024 * 1024) << " MB read for " << stats.nbMisses + stats.nbPrefetched << " view loadings ("
+                         << stats.nbPrefetched << " prefetched), " << stats.nbHits << " hits, " << stats.nbEvictions << " evictions, "
+                         << stats.peakResidentBytes / (1024 * 1024) << " MB peak memory.");
+    regionsCache.reset();
+
+    // the filtering and the triangulation only need the features of the views
+    std::vector<std::string> allFeaturesFolders = sfmData.getFeaturesFolders();
+    allFeaturesFolders.insert(allFeaturesFolders.end(), featuresFolders.begin(), featuresFolders.end());
+
+    std::vector<IndexT> viewIds;
+    for(const auto& viewPair: sfmData.getViews())
+      viewIds.push_back(viewPair.first);
+
+    std::vector<std::vector<std::unique_ptr<feature::Regions>>> featuresPerDescPerView;
+    if(!sfm::loadFeaturesPerDescPerView(featuresPerDescPerView, viewIds, allFeaturesFolders, describerMethodTypes))
+    {
+      ALICEVISION_LOG_ERROR("Invalid features.");
+      return EXIT_FAILURE;
+    }
+    for(std::size_t descIdx = 0; descIdx < describerMethodTypes.size(); ++descIdx)
+    {
+      for(std::size_t viewIdx = 0; viewIdx < viewIds.size(); ++viewIdx)
+        regionsPerView.addRegions(viewIds[viewIdx], describerMethodTypes[descIdx], featuresPerDescPerView[descIdx][viewIdx].release());
+    }
+  }
+  else
+  {
+    structureEstimator.match(sfmData, pairs, regionsPerView, geometricErrorMax);
+
+    // unload descriptors before triangulation
+    regionsPerView.clearDescriptors();
+  }
 
   // filter matches
   structureEstimator.filter(sfmData, pairs, regionsPerView);
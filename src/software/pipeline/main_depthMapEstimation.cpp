@@ -4,26 +4,32 @@
 // v. 2.0. If a copy of the MPL was not distributed with this file,
 // You can obtain one at https://mozilla.org/MPL/2.0/.
 
+#include <aliceVision/config.hpp>
 #include <aliceVision/system/Logger.hpp>
 #include <aliceVision/cmdline/cmdline.hpp>
 #include <aliceVision/system/main.hpp>
 #include <aliceVision/sfmData/SfMData.hpp>
 #include <aliceVision/sfmDataIO/sfmDataIO.hpp>
 #include <aliceVision/mvsUtils/MultiViewParams.hpp>
-#include <aliceVision/depthMap/computeOnMultiGPUs.hpp>
-#include <aliceVision/depthMap/DepthMapEstimator.hpp>
+#include <aliceVision/depthMap/computeOnMultiCPUs.hpp>
+#include <aliceVision/depthMap/DepthMapEstimatorCpu.hpp>
 #include <aliceVision/depthMap/DepthMapParams.hpp>
 #include <aliceVision/depthMap/SgmParams.hpp>
 #include <aliceVision/depthMap/RefineParams.hpp>
 #include <aliceVision/gpu/gpu.hpp>
 
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+#include <aliceVision/depthMap/computeOnMultiGPUs.hpp>
+#include <aliceVision/depthMap/DepthMapEstimator.hpp>
+#endif
+
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 4
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -90,6 +96,16 @@ int aliceVision_main(int argc, char* argv[])
     // number of GPUs to use (0 means use all GPUs)
     int nbGPUs = 0;
 
+    // computation backend (gpu or cpu)
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+    std::string backend = "gpu";
+#else
+    std::string backend = "cpu";
+#endif
+
+    // number of CPU threads per simultaneous depth map computation (CPU backend)
+    int nbThreadsPerJob = 4;
+
     po::options_description requiredParams("Required parameters");
     requiredParams.add_options()
         ("input,i", po::value<std::string>(&sfmDataFilename)->required(),
@@ -215,7 +231,11 @@ int aliceVision_main(int argc, char* argv[])
         ("exportTilePattern", po::value<bool>(&depthMapParams.exportTilePattern)->default_value(depthMapParams.exportTilePattern),
             "Export workflow tile pattern.")
         ("nbGPUs", po::value<int>(&nbGPUs)->default_value(nbGPUs),
-            "Number of GPUs to use (0 means use all GPUs).");
+            "Number of GPUs to use (0 means use all GPUs).")
+        ("backend", po::value<std::string>(&backend)->default_value(backend),
+            "Computation backend: gpu (CUDA) or cpu. The CPU backend does not support color optimization, custom patch pattern and normal maps.")
+        ("nbThreadsPerJob", po::value<int>(&nbThreadsPerJob)->default_value(nbThreadsPerJob),
+            "CPU backend: number of threads per simultaneous depth map computation.");
 
     CmdLine cmdline("Dense Reconstruction.\n"
                     "This program estimate a depth map for each input calibrated camera using Plane Sweeping, a multi-view stereo algorithm notable for its efficiency on modern graphics hardware (GPU).\n"
@@ -241,15 +261,33 @@ int aliceVision_main(int argc, char* argv[])
     refineParams.exportIntermediateTopographicCutVolumes = exportIntermediateTopographicCutVolumes;
     refineParams.exportIntermediateVolume9pCsv = exportIntermediateVolume9pCsv;
 
-    // print GPU Information
-    ALICEVISION_LOG_INFO(gpu::gpuInformationCUDA());
+    // check the computation backend
+    if(backend != "gpu" && backend != "cpu")
+    {
+      ALICEVISION_LOG_ERROR("Invalid value for backend parameter: '" << backend << "'. Should be 'gpu' or 'cpu'.");
+      return EXIT_FAILURE;
+    }
 
-    // check if the gpu suppport CUDA compute capability 2.0
-    if(!gpu::gpuSupportCUDA(2,0))
+#if !ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+    if(backend == "gpu")
     {
-      ALICEVISION_LOG_ERROR("This program needs a CUDA-Enabled GPU (with at least compute capability 2.0).");
+      ALICEVISION_LOG_ERROR("This program has been built without CUDA support, use the 'cpu' backend.");
       return EXIT_FAILURE;
     }
+#endif
+
+    if(backend == "gpu")
+    {
+      // print GPU Information
+      ALICEVISION_LOG_INFO(gpu::gpuInformationCUDA());
+
+      // check if the gpu suppport CUDA compute capability 2.0
+      if(!gpu::gpuSupportCUDA(2,0))
+      {
+        ALICEVISION_LOG_ERROR("This program needs a CUDA-Enabled GPU (with at least compute capability 2.0).");
+        return EXIT_FAILURE;
+      }
+    }
 
     // check if the scale is correct
     if(downscale < 1)
@@ -424,11 +462,24 @@ int aliceVision_main(int argc, char* argv[])
       }
     }
 
-    // initialize depth map estimator
-    depthMap::DepthMapEstimator depthMapEstimator(mp, tileParams, depthMapParams, sgmParams, refineParams);
+    if(backend == "cpu")
+    {
+        // initialize CPU depth map estimator
+        depthMap::DepthMapEstimatorCpu depthMapEstimator(mp, tileParams, depthMapParams, sgmParams, refineParams);
 
-    // estimate depth maps
-    depthMap::computeOnMultiGPUs(cams, depthMapEstimator, nbGPUs);
+        // estimate depth maps
+        depthMap::computeOnMultiCPUs(cams, depthMapEstimator, cmdline.getHardwareContext().getMaxThreads(), nbThreadsPerJob);
+    }
+#if ALICEVISION_IS_DEFINED(ALICEVISION_HAVE_CUDA)
+    else
+    {
+        // initialize depth map estimator
+        depthMap::DepthMapEstimator depthMapEstimator(mp, tileParams, depthMapParams, sgmParams, refineParams);
+
+        // estimate depth maps
+        depthMap::computeOnMultiGPUs(cams, depthMapEstimator, nbGPUs);
+    }
+#endif
 
     ALICEVISION_COMMANDLINE_END
 }
@@ -13,6 +13,7 @@
 #include <aliceVision/matching/matchesFiltering.hpp>
 #include <aliceVision/feature/FeaturesPerView.hpp>
 #include <aliceVision/feature/RegionsPerView.hpp>
+#include <aliceVision/feature/RegionsProvider.hpp>
 #include <aliceVision/feature/ImageDescriber.hpp>
 #include <aliceVision/feature/imageDescriberCommon.hpp>
 #include <aliceVision/matchingImageCollection/matchingCommon.hpp>
@@ -25,6 +26,7 @@
 #include <aliceVision/matchingImageCollection/GeometricFilterMatrix_HGrowing.hpp>
 #include <aliceVision/matchingImageCollection/GeometricFilterType.hpp>
 #include <aliceVision/matchingImageCollection/ImagePairListIO.hpp>
+#include <aliceVision/matchingImageCollection/pairBlocks.hpp>
 #include <aliceVision/matching/pairwiseAdjacencyDisplay.hpp>
 #include <aliceVision/matching/io.hpp>
 #include <aliceVision/system/main.hpp>
@@ -36,14 +38,16 @@
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
 #include <cstdlib>
 #include <fstream>
 #include <cctype>
+#include <iterator>
 
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 6
 
 using namespace aliceVision;
 using namespace aliceVision::camera;
@@ -104,6 +108,7 @@ int aliceVision_main(int argc, char **argv)
   int rangeSize = 0;
   std::string nearestMatchingMethod = "ANN_L2";
   robustEstimation::ERobustEstimator geometricEstimator = robustEstimation::ERobustEstimator::ACRANSAC;
+  robustEstimation::EACRansacScoring acRansacScoring = robustEstimation::EACRansacScoring::EXACT;
   double geometricErrorMax = 0.0; //< the maximum reprojection error allowed for image matching with geometric validation
   double knownPosesGeometricErrorMax = 4.0;
   bool savePutativeMatches = false;
@@ -115,8 +120,14 @@ int aliceVision_main(int argc, char **argv)
   bool useGridSort = true;
   bool exportDebugFiles = false;
   bool matchFromKnownCameraPoses = false;
-  const std::string fileExtension = "txt";
+  std::string fileExtension = "txt";
+  bool compressMatches = false;
   int randomSeed = std::mt19937::default_seed;
+  std::string hashedDescriptionsFolder;
+  std::string pairBlocksManifest;
+  bool planPairBlocks = false;
+  int memoryBudget = 4096;
+  int regionsCacheSize = 0;
   double minRequired2DMotion = -1.0;
 
   po::options_description requiredParams("Required parameters");
@@ -139,6 +150,7 @@ int aliceVision_main(int argc, char **argv)
     ("photometricMatchingMethod,p", po::value<std::string>(&nearestMatchingMethod)->default_value(nearestMatchingMethod),
       "For Scalar based regions descriptor:\n"
       "* BRUTE_FORCE_L2: L2 BruteForce matching\n"
+      "* BRUTE_FORCE_L2_BATCHED: L2 BruteForce matching computed by tiles for all the pairs of an image at once\n"
       "* ANN_L2: L2 Approximate Nearest Neighbor matching\n"
       "* CASCADE_HASHING_L2: L2 Cascade Hashing matching\n"
       "* FAST_CASCADE_HASHING_L2: L2 Cascade Hashing with precomputed hashed regions\n"
@@ -149,6 +161,10 @@ int aliceVision_main(int argc, char **argv)
       "Geometric estimator:\n"
       "* acransac: A-Contrario Ransac\n"
       "* loransac: LO-Ransac (only available for fundamental matrix). Need to set '--geometricError'")
+    ("acRansacScoring", po::value<robustEstimation::EACRansacScoring>(&acRansacScoring)->default_value(acRansacScoring),
+      "Scoring of the models in the A-Contrario Ransac:\n"
+      "* exact: sort the residuals of each model\n"
+      "* histogram: log-scale histogram of the residuals of each model, same result without a full sort")
     ("geometricError", po::value<double>(&geometricErrorMax)->default_value(geometricErrorMax), 
       "Maximum error (in pixels) allowed for features matching during geometric verification. "
       "If set to 0 it lets the ACRansac select an optimal value.")
@@ -166,6 +182,12 @@ int aliceVision_main(int argc, char **argv)
       "Make sure that the matching process is symmetric (same matches for I->J than fo J->I).")
     ("matchFilePerImage", po::value<bool>(&matchFilePerImage)->default_value(matchFilePerImage),
       "Save matches in a separate file per image.")
+    ("matchesFileType", po::value<std::string>(&fileExtension)->default_value(fileExtension),
+      "Matches file type:\n"
+      "* txt: text file\n"
+      "* bin: indexed binary file, supports partial loading by views")
+    ("compressMatches", po::value<bool>(&compressMatches)->default_value(compressMatches),
+      "Compress the matches (binary matches file type only).")
     ("distanceRatio", po::value<float>(&distRatio)->default_value(distRatio),
       "Distance ratio to discard non meaningful matches.")
     ("maxIteration", po::value<int>(&maxIteration)->default_value(maxIteration),
@@ -184,6 +206,19 @@ int aliceVision_main(int argc, char **argv)
       "Range size.")
     ("randomSeed", po::value<int>(&randomSeed)->default_value(randomSeed),
       "This seed value will generate a sequence using a linear random generator. Set -1 to use a random seed.")
+    ("hashedDescriptionsFolder", po::value<std::string>(&hashedDescriptionsFolder)->default_value(hashedDescriptionsFolder),
+      "Folder to cache the hashed descriptions of the views with the cascade hashing matching methods. "
+      "They are reused by the other chunks and the next runs with the same random seed.")
+    ("pairBlocksManifest", po::value<std::string>(&pairBlocksManifest)->default_value(pairBlocksManifest),
+      "Pair blocks manifest (JSON). The pairs are matched by blocks of views loaded together "
+      "and --rangeStart/--rangeSize select a range of blocks instead of a range of views.")
+    ("planPairBlocks", po::value<bool>(&planPairBlocks)->default_value(planPairBlocks),
+      "Tile all the image pairs in blocks within the memory budget, write them in the pair blocks manifest and exit.")
+    ("memoryBudget", po::value<int>(&memoryBudget)->default_value(memoryBudget),
+      "Maximum amount of regions data (in MB) loaded at the same time to match a pair block.")
+    ("regionsCacheSize", po::value<int>(&regionsCacheSize)->default_value(regionsCacheSize),
+      "Maximum amount of regions data (in MB) kept in memory. The regions are loaded on demand for windows of image pairs "
+      "and the least recently used ones are released (0 to load the regions of all the views up front).")
     ;
 
   CmdLine cmdline("This program computes corresponding features between a series of views:\n"
@@ -199,6 +234,12 @@ int aliceVision_main(int argc, char **argv)
       return EXIT_FAILURE;
   }
 
+  if(fileExtension != "txt" && fileExtension != "bin")
+  {
+    ALICEVISION_LOG_ERROR("Invalid matches file type: " << fileExtension);
+    return EXIT_FAILURE;
+  }
+
   const double defaultLoRansacMatchingError = 20.0;
   if(!adjustRobustEstimatorThreshold(geometricEstimator, geometricErrorMax, defaultLoRansacMatchingError))
     return EXIT_FAILURE;
@@ -222,6 +263,18 @@ int aliceVision_main(int argc, char **argv)
     return EXIT_FAILURE;
   }
 
+  if(planPairBlocks && (pairBlocksManifest.empty() || memoryBudget <= 0))
+  {
+    ALICEVISION_LOG_ERROR("The pair blocks planning needs a pair blocks manifest and a positive memory budget.");
+    return EXIT_FAILURE;
+  }
+
+  if(regionsCacheSize < 0 || (regionsCacheSize > 0 && !pairBlocksManifest.empty()))
+  {
+    ALICEVISION_LOG_ERROR("The regions cache size must be positive and cannot be used with pair blocks.");
+    return EXIT_FAILURE;
+  }
+
   // Feature matching
   // a. Load SfMData Views & intrinsics data
   // b. Compute putative descriptor matches
@@ -244,20 +297,36 @@ int aliceVision_main(int argc, char **argv)
   // from matching mode compute the pair list that have to be matched
   PairSet pairs;
   std::set<IndexT> filter;
+  std::vector<matchingImageCollection::PairBlock> pairBlocks;
 
-  
-  // We assume that there is only one pair for (I,J) and (J,I)
-  if(predefinedPairList.empty())
+  if(!pairBlocksManifest.empty() && !planPairBlocks)
   {
-    pairs = exhaustivePairs(sfmData.getViews(), rangeStart, rangeSize);
+    // the pairs of the range of blocks
+    ALICEVISION_LOG_INFO("Load pair blocks from file: " << pairBlocksManifest);
+    if(!matchingImageCollection::loadPairBlocks(pairBlocksManifest, pairBlocks, rangeStart, rangeSize))
+      return EXIT_FAILURE;
+    for(const auto& pairBlock: pairBlocks)
+      pairs.insert(pairBlock.pairs.begin(), pairBlock.pairs.end());
   }
   else
   {
-    for(const std::string& imagePairsFile: predefinedPairList)
+    // the blocks are planned for all the pairs
+    const int pairsRangeStart = planPairBlocks ? -1 : rangeStart;
+    const int pairsRangeSize = planPairBlocks ? 0 : rangeSize;
+
+    // We assume that there is only one pair for (I,J) and (J,I)
+    if(predefinedPairList.empty())
     {
-      ALICEVISION_LOG_INFO("Load pair list from file: " << imagePairsFile);
-      if (!matchingImageCollection::loadPairsFromFile(imagePairsFile, pairs, rangeStart, rangeSize))
-          return EXIT_FAILURE;
+      pairs = exhaustivePairs(sfmData.getViews(), pairsRangeStart, pairsRangeSize);
+    }
+    else
+    {
+      for(const std::string& imagePairsFile: predefinedPairList)
+      {
+        ALICEVISION_LOG_INFO("Load pair list from file: " << imagePairsFile);
+        if (!matchingImageCollection::loadPairsFromFile(imagePairsFile, pairs, pairsRangeStart, pairsRangeSize))
+            return EXIT_FAILURE;
+      }
     }
   }
 
@@ -277,80 +346,222 @@ int aliceVision_main(int argc, char **argv)
     filter.insert(pair.second);
   }
 
+  const std::vector<feature::EImageDescriberType> describerTypes = feature::EImageDescriberType_stringToEnums(describerTypesName);
+
+  if(planPairBlocks)
+  {
+    std::map<IndexT, std::size_t> regionsSizePerView;
+    if(!sfm::getRegionsSizePerView(regionsSizePerView, sfmData, featuresFolders, describerTypes, filter))
+    {
+      ALICEVISION_LOG_ERROR("Invalid features in '" + sfmDataFilename + "'");
+      return EXIT_FAILURE;
+    }
+
+    const std::size_t memoryBudgetBytes = static_cast<std::size_t>(memoryBudget) * 1024 * 1024;
+    const std::vector<matchingImageCollection::PairBlock> plannedBlocks = matchingImageCollection::computePairBlocks(pairs, regionsSizePerView, memoryBudgetBytes);
+    const matchingImageCollection::PairBlocksStats stats = matchingImageCollection::computePairBlocksStats(plannedBlocks, regionsSizePerView);
+
+    ALICEVISION_LOG_INFO("Pair blocks: " << plannedBlocks.size() << " blocks for " << stats.nbPairs << " image pairs and " << regionsSizePerView.size() << " views." << std::endl
+                         << "\t- regions loaded at the same time: " << stats.maxBytesLoaded / (1024 * 1024) << " MB (budget: " << memoryBudget << " MB)" << std::endl
+                         << "\t- regions read: " << stats.bytesRead / (1024 * 1024) << " MB for " << stats.nbViewsLoaded << " view loadings "
+                         << "(each view once: " << stats.minBytesRead / (1024 * 1024) << " MB)" << std::endl
+                         << "\t- regions read per image pair: " << stats.getBytesReadPerPair() / 1024 << " KB");
+
+    if(!matchingImageCollection::savePairBlocks(pairBlocksManifest, plannedBlocks))
+    {
+      ALICEVISION_LOG_ERROR("Cannot write the pair blocks manifest: " << pairBlocksManifest);
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
   PairwiseMatches mapPutativesMatches;
 
   // allocate the right Matcher according the Matching requested method
   EMatcherType collectionMatcherType = EMatcherType_stringToEnum(nearestMatchingMethod);
   std::unique_ptr<IImageCollectionMatcher> imageCollectionMatcher = createImageCollectionMatcher(collectionMatcherType, distRatio, crossMatching);
 
-  const std::vector<feature::EImageDescriberType> describerTypes = feature::EImageDescriberType_stringToEnums(describerTypesName);
+  if(!hashedDescriptionsFolder.empty())
+  {
+    auto* cascadeHashingMatcher = dynamic_cast<ImageCollectionMatcher_cascadeHashing*>(imageCollectionMatcher.get());
+    if(cascadeHashingMatcher)
+      cascadeHashingMatcher->setHashedDescriptionsFolder(hashedDescriptionsFolder);
+    else
+      ALICEVISION_LOG_WARNING("The hashed descriptions cache is only used by the cascade hashing matching methods.");
+  }
 
   ALICEVISION_LOG_INFO("There are " << sfmData.getViews().size() << " views and " << pairs.size() << " image pairs.");
 
-  ALICEVISION_LOG_INFO("Load features and descriptors");
-
-  // load the corresponding view regions
   RegionsPerView regionPerView;
-  if(!sfm::loadRegionsPerView(regionPerView, sfmData, featuresFolders, describerTypes, filter))
-  {
-    ALICEVISION_LOG_ERROR("Invalid regions in '" + sfmDataFilename + "'");
-    return EXIT_FAILURE;
-  }
+  std::size_t regionsBytesRead = 0;
 
-  // perform the matching
-  system::Timer timer;
-  PairSet pairsPoseKnown;
-  PairSet pairsPoseUnknown;
+  // regions loaded on demand for windows of image pairs, within the regions cache size
+  std::unique_ptr<feature::RegionsCache> regionsCache;
+  std::size_t maxViewsPerWindow = 0;
 
-  if(matchFromKnownCameraPoses)
+  // load the regions of the given views
+  const auto loadRegions = [&](const std::set<IndexT>& viewIds) -> bool
   {
-      for(const auto& p: pairs)
-      {
-        if(sfmData.isPoseAndIntrinsicDefined(p.first) && sfmData.isPoseAndIntrinsicDefined(p.second))
+    RegionsPerView loadedRegions;
+    if(!sfm::loadRegionsPerView(loadedRegions, sfmData, featuresFolders, describerTypes, viewIds))
+    {
+      ALICEVISION_LOG_ERROR("Invalid regions in '" + sfmDataFilename + "'");
+      return false;
+    }
+    for(auto& regionsPerDesc: loadedRegions.getData())
+    {
+      for(const auto& regions: regionsPerDesc.second)
+        regionsBytesRead += sfm::getRegionsSize(*regions.second);
+      regionPerView.getData()[regionsPerDesc.first] = std::move(regionsPerDesc.second);
+    }
+    return true;
+  };
+
+  // compute the putative matches of the given pairs
+  const auto matchPairs = [&](const RegionsPerView& regionsPerView, const PairSet& pairsToMatch, PairwiseMatches& putativeMatches)
+  {
+    PairSet pairsPoseKnown;
+    PairSet pairsPoseUnknown;
+
+    if(matchFromKnownCameraPoses)
+    {
+        for(const auto& p: pairsToMatch)
         {
-            pairsPoseKnown.insert(p);
+          if(sfmData.isPoseAndIntrinsicDefined(p.first) && sfmData.isPoseAndIntrinsicDefined(p.second))
+          {
+              pairsPoseKnown.insert(p);
+          }
+          else
+          {
+              pairsPoseUnknown.insert(p);
+          }
         }
-        else
+    }
+    else
+    {
+        pairsPoseUnknown = pairsToMatch;
+    }
+
+    if(!pairsPoseKnown.empty())
+    {
+      // compute matches from known camera poses when you have an initialization on the camera poses
+      ALICEVISION_LOG_INFO("Putative matches from known poses: " << pairsPoseKnown.size() << " image pairs.");
+
+      sfm::StructureEstimationFromKnownPoses structureEstimator;
+      structureEstimator.match(sfmData, pairsPoseKnown, regionsPerView, knownPosesGeometricErrorMax);
+      const PairwiseMatches& knownPosesMatches = structureEstimator.getPutativesMatches();
+      putativeMatches.insert(knownPosesMatches.begin(), knownPosesMatches.end());
+    }
+
+    if(!pairsPoseUnknown.empty())
+    {
+        ALICEVISION_LOG_INFO("Putative matches (unknown poses): " << pairsPoseUnknown.size() << " image pairs.");
+        // match feature descriptors between them without geometric notion
+
+        for(const feature::EImageDescriberType descType : describerTypes)
         {
-            pairsPoseUnknown.insert(p);
+          assert(descType != feature::EImageDescriberType::UNINITIALIZED);
+          ALICEVISION_LOG_INFO(EImageDescriberType_enumToString(descType) + " Regions Matching");
+
+          // photometric matching of putative pairs
+          imageCollectionMatcher->Match(randomNumberGenerator, regionsPerView, pairsPoseUnknown, descType, putativeMatches);
         }
-      }
-  }
-  else
-  {
-      pairsPoseUnknown = pairs;
-  }
+    }
+  };
+
+  // perform the matching
+  system::Timer timer;
 
-  if(!pairsPoseKnown.empty())
+  if(regionsCacheSize > 0)
   {
-    // compute matches from known camera poses when you have an initialization on the camera poses
-    ALICEVISION_LOG_INFO("Putative matches from known poses: " << pairsPoseKnown.size() << " image pairs.");
+    const std::size_t regionsCacheBytes = static_cast<std::size_t>(regionsCacheSize) * 1024 * 1024;
+
+    std::map<IndexT, std::size_t> regionsSizePerView;
+    if(!sfm::getRegionsSizePerView(regionsSizePerView, sfmData, featuresFolders, describerTypes, filter))
+    {
+      ALICEVISION_LOG_ERROR("Invalid features in '" + sfmDataFilename + "'");
+      return EXIT_FAILURE;
+    }
+
+    // the regions of a window and the prefetched regions of the next window fit in the cache
+    std::size_t maxRegionsSize = 1;
+    for(const auto& regionsSize: regionsSizePerView)
+      maxRegionsSize = std::max(maxRegionsSize, regionsSize.second);
+    maxViewsPerWindow = std::max<std::size_t>(2, regionsCacheBytes / (2 * maxRegionsSize));
+
+    ALICEVISION_LOG_INFO("Load features and descriptors on demand: " << regionsCacheSize << " MB regions cache, windows of " << maxViewsPerWindow << " views.");
 
-    sfm::StructureEstimationFromKnownPoses structureEstimator;
-    structureEstimator.match(sfmData, pairsPoseKnown, regionPerView, knownPosesGeometricErrorMax);
-    mapPutativesMatches = structureEstimator.getPutativesMatches();
+    regionsCache = sfm::createRegionsCache(sfmData, featuresFolders, describerTypes, regionsCacheBytes);
+
+    // the sorted pairs share their first view with the neighbouring pairs
+    const PairVec pairsToMatch(pairs.begin(), pairs.end());
+    feature::forEachPairsWindow(*regionsCache, pairsToMatch, maxViewsPerWindow,
+      [&](const RegionsPerView& windowRegionsPerView, std::size_t begin, std::size_t end)
+      {
+        PairwiseMatches windowMatches;
+        matchPairs(windowRegionsPerView, PairSet(pairsToMatch.begin() + begin, pairsToMatch.begin() + end), windowMatches);
+        // the regions of the window may be released after its processing
+        filterMatchesByMin2DMotion(windowMatches, windowRegionsPerView, minRequired2DMotion);
+        mapPutativesMatches.insert(windowMatches.begin(), windowMatches.end());
+      });
+
+    regionsBytesRead = regionsCache->getStats().bytesRead;
   }
+  else if(pairBlocks.empty())
+  {
+    ALICEVISION_LOG_INFO("Load features and descriptors");
 
-  if(!pairsPoseUnknown.empty())
+    // load the corresponding view regions
+    if(!loadRegions(filter))
+      return EXIT_FAILURE;
+
+    matchPairs(regionPerView, pairs, mapPutativesMatches);
+  }
+  else
   {
-      ALICEVISION_LOG_INFO("Putative matches (unknown poses): " << pairsPoseUnknown.size() << " image pairs.");
-      // match feature descriptors between them without geometric notion
+    // views of the current block with loaded descriptors
+    std::set<IndexT> loadedViews;
 
-      for(const feature::EImageDescriberType descType : describerTypes)
-      {
-        assert(descType != feature::EImageDescriberType::UNINITIALIZED);
-        ALICEVISION_LOG_INFO(EImageDescriberType_enumToString(descType) + " Regions Matching");
+    for(std::size_t b = 0; b < pairBlocks.size(); ++b)
+    {
+      const matchingImageCollection::PairBlock& pairBlock = pairBlocks[b];
+      ALICEVISION_LOG_INFO("Pair block " << b + 1 << "/" << pairBlocks.size() << ": " << pairBlock.views.size() << " views, " << pairBlock.pairs.size() << " image pairs.");
 
-        // photometric matching of putative pairs
-        imageCollectionMatcher->Match(randomNumberGenerator, regionPerView, pairsPoseUnknown, descType, mapPutativesMatches);
+      // only load the views that are not already loaded (shared with the previous block)
+      std::set<IndexT> viewsToLoad;
+      std::set_difference(pairBlock.views.begin(), pairBlock.views.end(), loadedViews.begin(), loadedViews.end(),
+                          std::inserter(viewsToLoad, viewsToLoad.begin()));
+      if(!viewsToLoad.empty() && !loadRegions(viewsToLoad))
+        return EXIT_FAILURE;
+      loadedViews.insert(pairBlock.views.begin(), pairBlock.views.end());
 
-        // TODO: DELI
-        // if(!guided_matching) regionPerView.clearDescriptors()
-      }
+      matchPairs(regionPerView, pairBlock.pairs, mapPutativesMatches);
 
+      // release the descriptors that are not used by the next block, the features are kept for the geometric filtering
+      if(!guidedMatching)
+      {
+        const std::set<IndexT> emptyViews;
+        const std::set<IndexT>& nextViews = (b + 1 < pairBlocks.size()) ? pairBlocks[b + 1].views : emptyViews;
+        for(auto it = loadedViews.begin(); it != loadedViews.end();)
+        {
+          if(nextViews.count(*it))
+          {
+            ++it;
+            continue;
+          }
+          for(auto& regions: regionPerView.getData().at(*it))
+            regions.second->clearDescriptors();
+          it = loadedViews.erase(it);
+        }
+      }
+    }
   }
 
-  filterMatchesByMin2DMotion(mapPutativesMatches, regionPerView, minRequired2DMotion);
+  ALICEVISION_LOG_INFO("Regions read: " << regionsBytesRead / (1024 * 1024) << " MB for " << pairs.size() << " image pairs ("
+                       << static_cast<double>(regionsBytesRead) / (1024 * pairs.size()) << " KB per image pair).");
+
+  if(!regionsCache)
+    filterMatchesByMin2DMotion(mapPutativesMatches, regionPerView, minRequired2DMotion);
 
   if(mapPutativesMatches.empty())
   {
@@ -386,7 +597,7 @@ int aliceVision_main(int argc, char **argv)
 
   // export putative matches
   if(savePutativeMatches)
-    Save(mapPutativesMatches, (fs::path(matchesFolder) / "putativeMatches").string(), fileExtension, matchFilePerImage, filePrefix);
+    Save(mapPutativesMatches, (fs::path(matchesFolder) / "putativeMatches").string(), fileExtension, matchFilePerImage, filePrefix, compressMatches);
 
   ALICEVISION_LOG_INFO("Task (Regions Matching) done in (s): " + std::to_string(timer.elapsed()));
 
@@ -432,6 +643,17 @@ int aliceVision_main(int argc, char **argv)
 
   ALICEVISION_LOG_INFO("Geometric filtering: using " << matchingImageCollection::EGeometricFilterType_enumToString(geometricFilterType));
 
+  // robust estimation with the regions of all the views or of windows of image pairs
+  const auto estimateGeometricMatches = [&](const auto& geometricFilter, double distanceRatio)
+  {
+    if(regionsCache)
+      matchingImageCollection::robustModelEstimation(geometricMatches, &sfmData, *regionsCache, geometricFilter, mapPutativesMatches,
+                                                     randomNumberGenerator, guidedMatching, distanceRatio, 0, 1, maxViewsPerWindow);
+    else
+      matchingImageCollection::robustModelEstimation(geometricMatches, &sfmData, regionPerView, geometricFilter, mapPutativesMatches,
+                                                     randomNumberGenerator, guidedMatching, distanceRatio);
+  };
+
   switch(geometricFilterType)
   {
 
@@ -441,37 +663,19 @@ int aliceVision_main(int argc, char **argv)
 
     case EGeometricFilterType::FUNDAMENTAL_MATRIX:
     {
-      matchingImageCollection::robustModelEstimation(geometricMatches,
-        &sfmData,
-        regionPerView,
-        GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator),
-        mapPutativesMatches,
-        randomNumberGenerator,
-        guidedMatching);
+      estimateGeometricMatches(GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator, false, acRansacScoring), 0.6);
     }
     break;
 
   case EGeometricFilterType::FUNDAMENTAL_WITH_DISTORTION:
   {
-    matchingImageCollection::robustModelEstimation(geometricMatches,
-      &sfmData,
-      regionPerView,
-      GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator, true),
-      mapPutativesMatches,
-      randomNumberGenerator,
-      guidedMatching);
+    estimateGeometricMatches(GeometricFilterMatrix_F_AC(geometricErrorMax, maxIteration, geometricEstimator, true, acRansacScoring), 0.6);
   }
   break;
 
     case EGeometricFilterType::ESSENTIAL_MATRIX:
     {
-      matchingImageCollection::robustModelEstimation(geometricMatches,
-        &sfmData,
-        regionPerView,
-        GeometricFilterMatrix_E_AC(geometricErrorMax, maxIteration),
-        mapPutativesMatches,
-        randomNumberGenerator,
-        guidedMatching);
+      estimateGeometricMatches(GeometricFilterMatrix_E_AC(geometricErrorMax, maxIteration, acRansacScoring), 0.6);
 
       removePoorlyOverlappingImagePairs(geometricMatches, mapPutativesMatches, 0.3f, 50);
     }
@@ -480,24 +684,14 @@ int aliceVision_main(int argc, char **argv)
     case EGeometricFilterType::HOMOGRAPHY_MATRIX:
     {
       const bool onlyGuidedMatching = true;
-      matchingImageCollection::robustModelEstimation(geometricMatches,
-        &sfmData,
-        regionPerView,
-        GeometricFilterMatrix_H_AC(geometricErrorMax, maxIteration),
-        mapPutativesMatches, randomNumberGenerator, guidedMatching,
+      estimateGeometricMatches(GeometricFilterMatrix_H_AC(geometricErrorMax, maxIteration, acRansacScoring),
         onlyGuidedMatching ? -1.0 : 0.6);
     }
     break;
 
     case EGeometricFilterType::HOMOGRAPHY_GROWING:
     {
-      matchingImageCollection::robustModelEstimation(geometricMatches,
-        &sfmData,
-        regionPerView,
-        GeometricFilterMatrix_HGrowing(geometricErrorMax, maxIteration),
-        mapPutativesMatches,
-        randomNumberGenerator,
-        guidedMatching);
+      estimateGeometricMatches(GeometricFilterMatrix_HGrowing(geometricErrorMax, maxIteration), 0.6);
     }
     break;
   }
@@ -510,8 +704,32 @@ int aliceVision_main(int argc, char **argv)
   ALICEVISION_LOG_INFO("Grid filtering");
 
   PairwiseMatches finalMatches;
-  matchesGridFilteringForAllPairs(geometricMatches, sfmData, regionPerView, useGridSort,
-                                  numMatchesToKeep, finalMatches);
+  if(regionsCache)
+  {
+    PairVec geometricPairs;
+    for(const auto& geometricMatch: geometricMatches)
+      geometricPairs.push_back(geometricMatch.first);
+
+    feature::forEachPairsWindow(*regionsCache, geometricPairs, maxViewsPerWindow,
+      [&](const RegionsPerView& windowRegionsPerView, std::size_t begin, std::size_t end)
+      {
+        PairwiseMatches windowMatches;
+        for(std::size_t i = begin; i < end; ++i)
+          windowMatches.emplace(geometricPairs[i], geometricMatches.at(geometricPairs[i]));
+        matchesGridFilteringForAllPairs(windowMatches, sfmData, windowRegionsPerView, useGridSort,
+                                        numMatchesToKeep, finalMatches);
+      });
+
+    const feature::RegionsCacheStats stats = regionsCache->getStats();
+    ALICEVISION_LOG_INFO("Regions cache: " << stats.bytesRead / (1024 * 1024) << " MB read for " << stats.nbMisses + stats.nbPrefetched << " view loadings ("
+                         << stats.nbPrefetched << " prefetched), " << stats.nbHits << " hits, " << stats.nbEvictions << " evictions, "
+                         << stats.peakResidentBytes / (1024 * 1024) << " MB peak memory.");
+  }
+  else
+  {
+    matchesGridFilteringForAllPairs(geometricMatches, sfmData, regionPerView, useGridSort,
+                                    numMatchesToKeep, finalMatches);
+  }
 
     ALICEVISION_LOG_INFO("After grid filtering:");
     for (const auto& matchGridFiltering: finalMatches)
@@ -524,7 +742,7 @@ int aliceVision_main(int argc, char **argv)
 
   // export geometric filtered matches
   ALICEVISION_LOG_INFO("Save geometric matches.");
-  Save(finalMatches, matchesFolder, fileExtension, matchFilePerImage, filePrefix);
+  Save(finalMatches, matchesFolder, fileExtension, matchFilePerImage, filePrefix, compressMatches);
   ALICEVISION_LOG_INFO("Task done in (s): " + std::to_string(timer.elapsed()));
 
   // d. Export some statistics
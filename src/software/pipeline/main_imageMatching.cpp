@@ -30,7 +30,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 using namespace aliceVision::voctree;
@@ -65,6 +65,8 @@ int aliceVision_main(int argc, char** argv)
   std::string weightsFilepath;
   /// flag for the optional weights file
   bool withWeights = false;
+  /// the filename of the database of quantized images
+  std::string databaseFilepath;
 
 
   // multiple SfM parameters
@@ -109,7 +111,10 @@ int aliceVision_main(int argc, char** argv)
       "Input file path of the vocabulary tree. This file can be generated by 'createVoctree'. "
       "This software is intended to be used with a generic, pre-trained vocabulary tree.")
     ("weights,w", po::value<std::string>(&weightsFilepath)->default_value(weightsFilepath),
-      "Input name for the vocabulary tree weight file, if not provided all voctree leaves will have the same weight.");
+      "Input name for the vocabulary tree weight file, if not provided all voctree leaves will have the same weight.")
+    ("voctreeDatabase", po::value<std::string>(&databaseFilepath)->default_value(databaseFilepath),
+      "File of the vocabulary tree database (quantized images). If it exists, it is loaded and only the new images are quantized, "
+      "then it is saved with the new images. It must be used with the same vocabulary tree, maxDescriptors and input images.");
 
   po::options_description multiSfMParams("Multiple SfM");
   multiSfMParams.add_options()
@@ -207,7 +212,7 @@ int aliceVision_main(int argc, char** argv)
     {
       ALICEVISION_LOG_INFO("Use VOCABULARYTREE matching.");
       conditionVocTree(treeFilepath, withWeights, weightsFilepath, matchingMode,featuresFolders, sfmDataA, nbMaxDescriptors, sfmDataFilenameA, sfmDataB,
-                       sfmDataFilenameB, useMultiSfM, descriptorsFilesA,  numImageQuery, selectedPairs);
+                       sfmDataFilenameB, useMultiSfM, descriptorsFilesA,  numImageQuery, selectedPairs, databaseFilepath);
       break;
     }
     case EImageMatchingMethod::SEQUENTIAL:
@@ -221,7 +226,7 @@ int aliceVision_main(int argc, char** argv)
       ALICEVISION_LOG_INFO("Use SEQUENTIAL and VOCABULARYTREE matching.");
       generateSequentialMatches(sfmDataA, numImageQuerySequential, selectedPairs);
       conditionVocTree(treeFilepath, withWeights, weightsFilepath, matchingMode,featuresFolders, sfmDataA, nbMaxDescriptors, sfmDataFilenameA, sfmDataB,
-                       sfmDataFilenameB, useMultiSfM, descriptorsFilesA,  numImageQuery, selectedPairs);
+                       sfmDataFilenameB, useMultiSfM, descriptorsFilesA,  numImageQuery, selectedPairs, databaseFilepath);
       break;
     }
     case EImageMatchingMethod::FRUSTUM:
@@ -28,7 +28,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 2
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 4
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 5
 
 using namespace aliceVision;
 
@@ -163,6 +163,11 @@ int aliceVision_main(int argc, char **argv)
     ("maxImagesPerGroup", po::value<std::size_t>(&sfmParams.maxImagesPerGroup)->default_value(sfmParams.maxImagesPerGroup),
       "Maximum number of cameras that can be added before the bundle adjustment is performed. This prevents adding too much data "
       "at once without performing the bundle adjustment.")
+    ("minNbResectionedViewsForBundle", po::value<std::size_t>(&sfmParams.minNbResectionedViewsForBundle)->default_value(sfmParams.minNbResectionedViewsForBundle),
+      "Past the first unstable cameras, minimum number of cameras that have to be added before the bundle adjustment is performed.")
+    ("maxResectionBatchSize", po::value<std::size_t>(&sfmParams.maxResectionBatchSize)->default_value(sfmParams.maxResectionBatchSize),
+      "Maximum number of cameras resected concurrently on the same state of the reconstruction (0 for no limit). "
+      "The cameras sharing a pose, a rig or a new intrinsic are never resected in the same batch.")
     ("bundleAdjustmentMaxOutliers", po::value<int>(&sfmParams.bundleAdjustmentMaxOutliers)->default_value(sfmParams.bundleAdjustmentMaxOutliers),
       "Threshold for the maximum number of outliers allowed at the end of a bundle adjustment iteration."
       "Using a negative value for this threshold will disable BA iterations.")
@@ -28,7 +28,7 @@
 // These constants define the current software version.
 // They must be updated when the command line is changed.
 #define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
-#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 1
 
 using namespace aliceVision;
 
@@ -48,6 +48,7 @@ int aliceVision_main(int argc, char** argv)
     int minInputTrackLength = 2;
     bool filterTrackForks = true;
     bool useOnlyMatchesFromInputFolder = false;
+    bool incremental = false;
 
     // user optional parameters
     std::string describerTypesName = feature::EImageDescriberType_enumToString(feature::EImageDescriberType::SIFT);
@@ -66,7 +67,10 @@ int aliceVision_main(int argc, char** argv)
         ("minInputTrackLength", po::value<int>(&minInputTrackLength)->default_value(minInputTrackLength), "Minimum track length in input of SfM.")
         ("useOnlyMatchesFromInputFolder", po::value<bool>(&useOnlyMatchesFromInputFolder)->default_value(useOnlyMatchesFromInputFolder), "Use only matches from the input matchesFolder parameter.\n"
         "Matches folders previously added to the SfMData file will be ignored.")
-        ("filterTrackForks", po::value<bool>(&filterTrackForks)->default_value(filterTrackForks), "Enable/Disable the track forks removal. A track contains a fork when incoherent matches leads to multiple features in the same image for a single track.\n");
+        ("filterTrackForks", po::value<bool>(&filterTrackForks)->default_value(filterTrackForks), "Enable/Disable the track forks removal. A track contains a fork when incoherent matches leads to multiple features in the same image for a single track.\n")
+        ("incremental", po::value<bool>(&incremental)->default_value(incremental), "Save the unfiltered tracks next to the output tracks file (<output>.state) "
+        "and, if this state file already exists, only merge the matches of the new image pairs into it.\n"
+        "The output tracks are identical to a full build.");
 
     CmdLine cmdline("AliceVision tracksBuilding");
 
@@ -113,8 +117,48 @@ int aliceVision_main(int argc, char** argv)
 
     //Create tracks
     track::TracksBuilder tracksBuilder;
-    ALICEVISION_LOG_INFO("Track building");
-    tracksBuilder.build(pairwiseMatches);
+    const std::string tracksStateFilename = tracksFilename + ".state";
+    bool stateLoaded = false;
+
+    if(incremental && fs::exists(tracksStateFilename))
+    {
+        ALICEVISION_LOG_INFO("Load tracks state: " << tracksStateFilename);
+        try
+        {
+            tracksBuilder.loadState(tracksStateFilename);
+            stateLoaded = true;
+        }
+        catch(const std::exception& e)
+        {
+            ALICEVISION_LOG_WARNING(e.what() << std::endl << "The tracks will be built from scratch.");
+        }
+    }
+
+    if(stateLoaded)
+    {
+        const std::size_t nbPreviousPairs = tracksBuilder.nbProcessedPairs();
+        ALICEVISION_LOG_INFO("Track update");
+        if(tracksBuilder.update(pairwiseMatches))
+        {
+            ALICEVISION_LOG_INFO("Tracks updated with " << tracksBuilder.nbProcessedPairs() - nbPreviousPairs << " new image pairs ("
+                                                       << nbPreviousPairs << " image pairs already processed).");
+        }
+        else
+        {
+            ALICEVISION_LOG_WARNING("Some matches have been removed or modified since the tracks state has been saved, the tracks have been built from scratch.");
+        }
+    }
+    else
+    {
+        ALICEVISION_LOG_INFO("Track building");
+        tracksBuilder.build(pairwiseMatches);
+    }
+
+    if(incremental)
+    {
+        ALICEVISION_LOG_INFO("Save tracks state: " << tracksStateFilename);
+        tracksBuilder.saveState(tracksStateFilename);
+    }
 
     ALICEVISION_LOG_INFO("Track filtering");
     tracksBuilder.filter(filterTrackForks, minInputTrackLength);
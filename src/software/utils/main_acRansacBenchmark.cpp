@@ -0,0 +1,220 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/numeric/numeric.hpp>
+#include <aliceVision/robustEstimation/ACRansac.hpp>
+#include <aliceVision/multiview/essential.hpp>
+#include <aliceVision/multiview/RelativePoseKernel.hpp>
+#include <aliceVision/multiview/Unnormalizer.hpp>
+#include <aliceVision/multiview/relativePose/Essential5PSolver.hpp>
+#include <aliceVision/multiview/relativePose/Fundamental7PSolver.hpp>
+#include <aliceVision/multiview/relativePose/FundamentalError.hpp>
+#include <aliceVision/multiview/relativePose/Homography4PSolver.hpp>
+#include <aliceVision/multiview/relativePose/HomographyError.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/cmdline/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/config.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+namespace {
+
+const int imageWidth = 1920;
+const int imageHeight = 1080;
+
+/**
+ * @brief Create the correspondences of two synthetic views of random 3D points,
+ *        with a gaussian noise and a ratio of random outliers.
+ * @param[in] planar Put all the points on a plane, for the homography estimation
+ */
+void createCorrespondences(std::size_t nbPoints, double noise, double outliersRatio, bool planar, Mat3& K, Mat& xI, Mat& xJ)
+{
+    std::mt19937 randomNumberGenerator(0);
+    std::uniform_real_distribution<double> unitDistribution(-1.0, 1.0);
+    std::uniform_real_distribution<double> depthDistribution(5.0, 15.0);
+    std::uniform_real_distribution<double> xDistribution(0.0, imageWidth);
+    std::uniform_real_distribution<double> yDistribution(0.0, imageHeight);
+    std::normal_distribution<double> noiseDistribution(0.0, noise);
+    std::bernoulli_distribution outlierDistribution(outliersRatio);
+
+    const double focal = 1000.0;
+    K << focal, 0.0, imageWidth / 2.0, 0.0, focal, imageHeight / 2.0, 0.0, 0.0, 1.0;
+
+    const Mat3 R = RotationAroundY(0.1) * RotationAroundX(0.05);
+    const Vec3 t(-1.0, 0.1, 0.2);
+
+    xI.resize(2, nbPoints);
+    xJ.resize(2, nbPoints);
+    for (std::size_t i = 0; i < nbPoints; ++i)
+    {
+        const double depth = planar ? 10.0 : depthDistribution(randomNumberGenerator);
+        const Vec3 X(unitDistribution(randomNumberGenerator) * depth * 0.8, unitDistribution(randomNumberGenerator) * depth * 0.45, depth);
+
+        const Vec3 pI = K * X;
+        const Vec3 pJ = K * (R * X + t);
+        xI.col(i) = pI.hnormalized() + Vec2(noiseDistribution(randomNumberGenerator), noiseDistribution(randomNumberGenerator));
+        xJ.col(i) = pJ.hnormalized() + Vec2(noiseDistribution(randomNumberGenerator), noiseDistribution(randomNumberGenerator));
+
+        if (outlierDistribution(randomNumberGenerator))
+            xJ.col(i) = Vec2(xDistribution(randomNumberGenerator), yDistribution(randomNumberGenerator));
+    }
+}
+
+/**
+ * @brief Run ACRansac with both scorings and add the timings to the report.
+ */
+template<typename KernelT>
+void benchmarkKernel(const std::string& name, const KernelT& kernel, std::size_t nbRuns, std::size_t nbIterations, std::stringstream& ss)
+{
+    double exactTime = 0.0;
+    double histogramTime = 0.0;
+    std::size_t nbInliers = 0;
+    std::size_t nbSameInliers = 0;
+
+    for (std::size_t run = 0; run < nbRuns; ++run)
+    {
+        std::vector<std::size_t> exactInliers;
+        std::vector<std::size_t> histogramInliers;
+        robustEstimation::Mat3Model model;
+
+        {
+            std::mt19937 randomNumberGenerator(run);
+            system::Timer timer;
+            robustEstimation::ACRANSAC(kernel,
+                                       randomNumberGenerator,
+                                       exactInliers,
+                                       nbIterations,
+                                       &model,
+                                       std::numeric_limits<double>::infinity(),
+                                       robustEstimation::EACRansacScoring::EXACT);
+            exactTime += timer.elapsed();
+        }
+        {
+            std::mt19937 randomNumberGenerator(run);
+            system::Timer timer;
+            robustEstimation::ACRANSAC(kernel,
+                                       randomNumberGenerator,
+                                       histogramInliers,
+                                       nbIterations,
+                                       &model,
+                                       std::numeric_limits<double>::infinity(),
+                                       robustEstimation::EACRansacScoring::HISTOGRAM);
+            histogramTime += timer.elapsed();
+        }
+
+        nbInliers += exactInliers.size();
+        if (exactInliers == histogramInliers)
+            ++nbSameInliers;
+    }
+
+    ss << std::endl
+       << std::setw(6) << name << std::setw(12) << nbInliers / nbRuns << std::setw(14) << 1000.0 * exactTime / nbRuns << std::setw(18)
+       << 1000.0 * histogramTime / nbRuns << std::setw(10) << exactTime / histogramTime << std::setw(16) << nbSameInliers << "/" << nbRuns;
+}
+
+}  // namespace
+
+// measure the ACRansac time with the exact and histogram scorings for F/E/H estimation
+int aliceVision_main(int argc, char** argv)
+{
+    // user optional parameters
+    std::size_t nbPoints = 5000;
+    double outliersRatio = 0.5;
+    double noise = 0.5;
+    std::size_t nbIterations = 1024;
+    std::size_t nbRuns = 10;
+
+    // clang-format off
+    po::options_description optionalParams("Optional parameters");
+    optionalParams.add_options()
+        ("nbPoints", po::value<std::size_t>(&nbPoints)->default_value(nbPoints),
+         "Number of putative correspondences.")
+        ("outliersRatio", po::value<double>(&outliersRatio)->default_value(outliersRatio),
+         "Ratio of wrong correspondences.")
+        ("noise", po::value<double>(&noise)->default_value(noise),
+         "Standard deviation of the noise of the inliers, in pixels.")
+        ("nbIterations", po::value<std::size_t>(&nbIterations)->default_value(nbIterations),
+         "Maximum number of ACRansac iterations.")
+        ("nbRuns", po::value<std::size_t>(&nbRuns)->default_value(nbRuns),
+         "Number of estimations per model, with different random seeds.");
+    // clang-format on
+
+    CmdLine cmdline("AliceVision acRansacBenchmark");
+    cmdline.add(optionalParams);
+    if (!cmdline.execute(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (nbPoints < 10 || nbRuns == 0)
+    {
+        ALICEVISION_LOG_ERROR("At least 10 points and 1 run are needed.");
+        return EXIT_FAILURE;
+    }
+
+    ALICEVISION_LOG_INFO("ACRansac benchmark: " << nbPoints << " correspondences, " << outliersRatio * 100.0 << "% outliers.");
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << std::endl
+       << std::setw(6) << "model" << std::setw(12) << "inliers" << std::setw(14) << "exact (ms)" << std::setw(18) << "histogram (ms)" << std::setw(10)
+       << "speedup" << std::setw(18) << "same inliers";
+
+    Mat3 K;
+    Mat xI, xJ;
+
+    // fundamental matrix
+    createCorrespondences(nbPoints, noise, outliersRatio, false, K, xI, xJ);
+    {
+        using KernelT = multiview::RelativePoseKernel<multiview::relativePose::Fundamental7PSolver,
+                                                      multiview::relativePose::FundamentalEpipolarDistanceError,
+                                                      multiview::UnnormalizerT,
+                                                      robustEstimation::Mat3Model>;
+        const KernelT kernel(xI, imageWidth, imageHeight, xJ, imageWidth, imageHeight, true);
+        benchmarkKernel("F", kernel, nbRuns, nbIterations, ss);
+    }
+
+    // essential matrix
+    {
+        using KernelT = multiview::RelativePoseKernel_K<multiview::relativePose::Essential5PSolver,
+                                                        multiview::relativePose::FundamentalEpipolarDistanceError,
+                                                        robustEstimation::Mat3Model>;
+        const KernelT kernel(xI, imageWidth, imageHeight, xJ, imageWidth, imageHeight, K, K);
+        benchmarkKernel("E", kernel, nbRuns, nbIterations, ss);
+    }
+
+    // homography matrix
+    createCorrespondences(nbPoints, noise, outliersRatio, true, K, xI, xJ);
+    {
+        using KernelT = multiview::RelativePoseKernel<multiview::relativePose::Homography4PSolver,
+                                                      multiview::relativePose::HomographyAsymmetricError,
+                                                      multiview::UnnormalizerI,
+                                                      robustEstimation::Mat3Model>;
+        const KernelT kernel(xI, imageWidth, imageHeight, xJ, imageWidth, imageHeight, false);
+        benchmarkKernel("H", kernel, nbRuns, nbIterations, ss);
+    }
+
+    ALICEVISION_LOG_INFO(ss.str());
+
+    return EXIT_SUCCESS;
+}
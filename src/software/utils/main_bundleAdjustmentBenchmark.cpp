@@ -0,0 +1,168 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfm/bundle/BundleAdjustmentCeres.hpp>
+#include <aliceVision/sfm/bundle/BundleAdjustmentSchur.hpp>
+#include <aliceVision/sfm/utils/syntheticScene.hpp>
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/camera/cameraCommon.hpp>
+#include <aliceVision/multiview/NViewDataSet.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/cmdline/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/config.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+namespace {
+
+/**
+ * @brief Create a synthetic ring scene, then add a gaussian noise to the observations
+ *        and perturb the poses and the landmarks.
+ */
+sfmData::SfMData createScene(std::size_t nbViews, std::size_t nbPoints, camera::EINTRINSIC intrinsicType, double observationNoise, double sceneNoise)
+{
+    const NViewDatasetConfigurator config;
+    const NViewDataSet dataset = NRealisticCamerasRing(nbViews, nbPoints, config);
+    sfmData::SfMData sfmData = sfm::getInputScene(dataset, config, intrinsicType);
+
+    std::mt19937 randomNumberGenerator(0);
+    std::normal_distribution<double> observationDistribution(0.0, observationNoise);
+    std::normal_distribution<double> sceneDistribution(0.0, sceneNoise);
+
+    for (auto& landmarkPair : sfmData.getLandmarks())
+    {
+        sfmData::Landmark& landmark = landmarkPair.second;
+        landmark.X += Vec3(sceneDistribution(randomNumberGenerator), sceneDistribution(randomNumberGenerator), sceneDistribution(randomNumberGenerator));
+        for (auto& observationPair : landmark.observations)
+        {
+            observationPair.second.x +=
+              Vec2(observationDistribution(randomNumberGenerator), observationDistribution(randomNumberGenerator));
+        }
+    }
+
+    for (auto& posePair : sfmData.getPoses())
+    {
+        const geometry::Pose3 pose = posePair.second.getTransform();
+        const Vec3 center =
+          pose.center() + Vec3(sceneDistribution(randomNumberGenerator), sceneDistribution(randomNumberGenerator), sceneDistribution(randomNumberGenerator));
+        posePair.second.setTransform(geometry::Pose3(pose.rotation(), center));
+    }
+
+    return sfmData;
+}
+
+}  // namespace
+
+// compare the Ceres bundle adjustment and the Schur bundle adjustment on a synthetic scene
+int aliceVision_main(int argc, char** argv)
+{
+    // user optional parameters
+    std::size_t nbViews = 50;
+    std::size_t nbPoints = 5000;
+    std::string intrinsicTypeName = camera::EINTRINSIC_enumToString(camera::EINTRINSIC::PINHOLE_CAMERA_RADIAL3);
+    double observationNoise = 0.5;
+    double sceneNoise = 0.01;
+    unsigned int maxIterations = 50;
+    bool sparse = true;
+
+    // clang-format off
+    po::options_description optionalParams("Optional parameters");
+    optionalParams.add_options()
+        ("nbViews", po::value<std::size_t>(&nbViews)->default_value(nbViews),
+         "Number of views of the synthetic ring scene.")
+        ("nbPoints", po::value<std::size_t>(&nbPoints)->default_value(nbPoints),
+         "Number of 3D points, each point is seen by all the views.")
+        ("intrinsicType", po::value<std::string>(&intrinsicTypeName)->default_value(intrinsicTypeName),
+         "Camera model of the shared intrinsic.")
+        ("observationNoise", po::value<double>(&observationNoise)->default_value(observationNoise),
+         "Standard deviation of the noise added to the observations (in pixels).")
+        ("sceneNoise", po::value<double>(&sceneNoise)->default_value(sceneNoise),
+         "Standard deviation of the noise added to the landmarks and the camera centers.")
+        ("maxIterations", po::value<unsigned int>(&maxIterations)->default_value(maxIterations),
+         "Maximum number of iterations of both solvers.")
+        ("sparse", po::value<bool>(&sparse)->default_value(sparse),
+         "Use the sparse linear solver of the Ceres bundle adjustment, else the dense one.");
+    // clang-format on
+
+    CmdLine cmdline("AliceVision bundleAdjustmentBenchmark");
+    cmdline.add(optionalParams);
+    if (!cmdline.execute(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (nbViews < 2 || nbPoints == 0)
+    {
+        ALICEVISION_LOG_ERROR("At least 2 views and 1 point are needed.");
+        return EXIT_FAILURE;
+    }
+
+    const camera::EINTRINSIC intrinsicType = camera::EINTRINSIC_stringToEnum(intrinsicTypeName);
+    const sfmData::SfMData scene = createScene(nbViews, nbPoints, intrinsicType, observationNoise, sceneNoise);
+
+    ALICEVISION_LOG_INFO("Bundle adjustment benchmark: " << nbViews << " views, " << nbPoints << " points, " << nbViews * nbPoints
+                                                         << " observations, " << intrinsicTypeName << ".");
+
+    // Ceres bundle adjustment
+    sfmData::SfMData ceresScene = scene;
+    sfm::BundleAdjustmentCeres::CeresOptions ceresOptions(false, true, maxIterations);
+    if (sparse)
+        ceresOptions.setSparseBA();
+    sfm::BundleAdjustmentCeres ceresBA(ceresOptions);
+    if (!ceresBA.adjust(ceresScene))
+    {
+        ALICEVISION_LOG_ERROR("The Ceres bundle adjustment failed.");
+        return EXIT_FAILURE;
+    }
+    const sfm::BundleAdjustmentCeres::Statistics& ceresStatistics = ceresBA.getStatistics();
+
+    // Schur bundle adjustment
+    sfmData::SfMData schurScene = scene;
+    sfm::BundleAdjustmentSchur::SchurOptions schurOptions(false, true, maxIterations);
+    sfm::BundleAdjustmentSchur schurBA(schurOptions);
+    if (!schurBA.adjust(schurScene))
+    {
+        ALICEVISION_LOG_ERROR("The Schur bundle adjustment failed.");
+        return EXIT_FAILURE;
+    }
+    const sfm::BundleAdjustmentSchur::Statistics& schurStatistics = schurBA.getStatistics();
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(4);
+    ss << std::endl
+       << std::setw(8) << "solver" << std::setw(12) << "time (s)" << std::setw(13) << "iterations" << std::setw(16) << "initial RMSE"
+       << std::setw(14) << "final RMSE";
+    ss << std::endl
+       << std::setw(8) << "ceres" << std::setw(12) << ceresStatistics.time << std::setw(13)
+       << ceresStatistics.nbSuccessfullIterations + ceresStatistics.nbUnsuccessfullIterations << std::setw(16) << ceresStatistics.RMSEinitial
+       << std::setw(14) << ceresStatistics.RMSEfinal;
+    ss << std::endl
+       << std::setw(8) << "schur" << std::setw(12) << schurStatistics.time << std::setw(13)
+       << schurStatistics.nbSuccessfullIterations + schurStatistics.nbUnsuccessfullIterations << std::setw(16) << schurStatistics.RMSEinitial
+       << std::setw(14) << schurStatistics.RMSEfinal;
+    ss << std::endl
+       << "schur: " << schurStatistics.assemblyTime << " s of reduced system assembly, " << schurStatistics.linearSolverTime
+       << " s of linear solver, " << schurStatistics.nbLinearIterations << " conjugate gradient iterations";
+
+    ALICEVISION_LOG_INFO(ss.str());
+
+    return EXIT_SUCCESS;
+}
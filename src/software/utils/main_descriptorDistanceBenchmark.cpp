@@ -0,0 +1,171 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/feature/distanceKernels.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/cmdline/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/config.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <cstdint>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+using namespace aliceVision::feature;
+
+namespace po = boost::program_options;
+
+namespace {
+
+/**
+ * @brief Run a one-to-many distance computation and return the time per distance (in ns).
+ * @note The checksum prevents the compiler from removing the computation.
+ */
+template<typename T, typename DistanceFunction>
+double benchmark(DistanceFunction distance,
+                 const std::vector<T>& queries,
+                 const std::vector<T>& database,
+                 std::size_t size,
+                 int nbRepeats,
+                 double& out_checksum)
+{
+    const std::size_t nbQueries = queries.size() / size;
+    const std::size_t nbDatabase = database.size() / size;
+
+    out_checksum = 0.0;
+    system::Timer timer;
+
+    for (int r = 0; r < nbRepeats; ++r)
+    {
+        for (std::size_t q = 0; q < nbQueries; ++q)
+        {
+            const T* query = queries.data() + q * size;
+            for (std::size_t d = 0; d < nbDatabase; ++d)
+                out_checksum += distance(query, database.data() + d * size, size);
+        }
+    }
+
+    const double nbDistances = double(nbRepeats) * double(nbQueries) * double(nbDatabase);
+    return timer.elapsed() * 1e9 / nbDistances;
+}
+
+}  // namespace
+
+// compare the descriptor distance kernels of all the instruction sets supported by the CPU
+int aliceVision_main(int argc, char** argv)
+{
+    // user optional parameters
+    std::size_t descriptorSize = 128;
+    std::size_t binaryDescriptorSize = 64;
+    std::size_t nbQueries = 100;
+    std::size_t nbDatabase = 10000;
+    int nbRepeats = 5;
+
+    // clang-format off
+    po::options_description optionalParams("Optional parameters");
+    optionalParams.add_options()
+        ("descriptorSize", po::value<std::size_t>(&descriptorSize)->default_value(descriptorSize),
+         "Number of values of the float and uint8 descriptors.")
+        ("binaryDescriptorSize", po::value<std::size_t>(&binaryDescriptorSize)->default_value(binaryDescriptorSize),
+         "Number of bytes of the binary descriptors (Hamming distance).")
+        ("nbQueries", po::value<std::size_t>(&nbQueries)->default_value(nbQueries),
+         "Number of query descriptors.")
+        ("nbDatabase", po::value<std::size_t>(&nbDatabase)->default_value(nbDatabase),
+         "Number of database descriptors, each query is compared to all of them.")
+        ("nbRepeats", po::value<int>(&nbRepeats)->default_value(nbRepeats),
+         "Number of repetitions of the whole benchmark.");
+    // clang-format on
+
+    CmdLine cmdline("AliceVision descriptorDistanceBenchmark");
+    cmdline.add(optionalParams);
+    if (!cmdline.execute(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    // random descriptors
+    std::mt19937 randomNumberGenerator(0);
+    std::uniform_real_distribution<float> floatDistribution(0.f, 1.f);
+    std::uniform_int_distribution<int> byteDistribution(0, 255);
+
+    std::vector<float> floatQueries(nbQueries * descriptorSize), floatDatabase(nbDatabase * descriptorSize);
+    std::vector<std::uint8_t> byteQueries(nbQueries * descriptorSize), byteDatabase(nbDatabase * descriptorSize);
+    std::vector<std::uint8_t> binaryQueries(nbQueries * binaryDescriptorSize), binaryDatabase(nbDatabase * binaryDescriptorSize);
+
+    for (float& v : floatQueries)
+        v = floatDistribution(randomNumberGenerator);
+    for (float& v : floatDatabase)
+        v = floatDistribution(randomNumberGenerator);
+    for (std::uint8_t& v : byteQueries)
+        v = static_cast<std::uint8_t>(byteDistribution(randomNumberGenerator));
+    for (std::uint8_t& v : byteDatabase)
+        v = static_cast<std::uint8_t>(byteDistribution(randomNumberGenerator));
+    for (std::uint8_t& v : binaryQueries)
+        v = static_cast<std::uint8_t>(byteDistribution(randomNumberGenerator));
+    for (std::uint8_t& v : binaryDatabase)
+        v = static_cast<std::uint8_t>(byteDistribution(randomNumberGenerator));
+
+    ALICEVISION_LOG_INFO("Descriptor distance benchmark:" << std::endl
+                                                          << "\t- " << nbQueries << " queries x " << nbDatabase << " database descriptors" << std::endl
+                                                          << "\t- float / uint8 descriptor size: " << descriptorSize << std::endl
+                                                          << "\t- binary descriptor size: " << binaryDescriptorSize << " bytes" << std::endl
+                                                          << "\t- best kernels: " << EDistanceKernel_enumToString(getBestDistanceKernel()));
+
+    double scalarTimes[3] = {0.0, 0.0, 0.0};
+    double scalarChecksums[3] = {0.0, 0.0, 0.0};
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << std::endl << std::setw(10) << "kernels" << std::setw(22) << "L2 float (ns)" << std::setw(22) << "L2 uint8 (ns)" << std::setw(22) << "Hamming (ns)";
+
+    for (const EDistanceKernel kernel : getSupportedDistanceKernels())
+    {
+        const DistanceKernels& k = getDistanceKernels(kernel);
+
+        double checksums[3];
+        const double times[3] = {benchmark(k.l2Float, floatQueries, floatDatabase, descriptorSize, nbRepeats, checksums[0]),
+                                 benchmark(k.l2UChar, byteQueries, byteDatabase, descriptorSize, nbRepeats, checksums[1]),
+                                 benchmark(k.hamming, binaryQueries, binaryDatabase, binaryDescriptorSize, nbRepeats, checksums[2])};
+
+        if (kernel == EDistanceKernel::SCALAR)
+        {
+            std::copy(times, times + 3, scalarTimes);
+            std::copy(checksums, checksums + 3, scalarChecksums);
+        }
+
+        ss << std::endl << std::setw(10) << EDistanceKernel_enumToString(kernel);
+        for (int i = 0; i < 3; ++i)
+        {
+            std::stringstream cell;
+            cell << std::fixed << std::setprecision(2) << times[i] << " (x" << scalarTimes[i] / times[i] << ")";
+            ss << std::setw(22) << cell.str();
+        }
+
+        // integer kernels must give the exact same results, float kernels may differ in summation order
+        if (checksums[1] != scalarChecksums[1] || checksums[2] != scalarChecksums[2] ||
+            std::abs(checksums[0] - scalarChecksums[0]) > 1e-4 * scalarChecksums[0])
+        {
+            ALICEVISION_LOG_ERROR("Distance kernels '" << EDistanceKernel_enumToString(kernel) << "' results differ from the scalar kernels.");
+            return EXIT_FAILURE;
+        }
+    }
+
+    ALICEVISION_LOG_INFO(ss.str());
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,223 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/sfmData/SfMData.hpp>
+#include <aliceVision/sfmDataIO/sfmDataIO.hpp>
+#include <aliceVision/camera/Pinhole.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/cmdline/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/config.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+#include <boost/property_tree/json_parser.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+namespace {
+
+/**
+ * @brief Create a synthetic scene: views on a circle sharing one intrinsic,
+ *        and landmarks seen by consecutive views.
+ */
+sfmData::SfMData createScene(std::size_t nbViews, std::size_t nbLandmarks, std::size_t nbObservations)
+{
+    std::mt19937 randomNumberGenerator(0);
+    std::uniform_real_distribution<double> coordinateDistribution(-10.0, 10.0);
+    std::uniform_real_distribution<double> pixelDistribution(0.0, 1000.0);
+
+    sfmData::SfMData sfmData;
+    sfmData.getIntrinsics().emplace(0, std::make_shared<camera::Pinhole>(1500, 1000, 1200, 1200, 0, 0));
+
+    for (IndexT viewId = 0; viewId < nbViews; ++viewId)
+    {
+        auto view = std::make_shared<sfmData::View>("images/" + std::to_string(viewId) + ".jpg", viewId, 0, viewId, 1500, 1000);
+        sfmData.getViews().emplace(viewId, view);
+
+        const double angle = 2.0 * M_PI * viewId / nbViews;
+        const geometry::Pose3 pose(RotationAroundY(angle), Vec3(20.0 * std::cos(angle), 0.0, 20.0 * std::sin(angle)));
+        sfmData.setPose(*view, sfmData::CameraPose(pose));
+    }
+
+    sfmData::Landmarks& landmarks = sfmData.getLandmarks();
+    for (IndexT landmarkId = 0; landmarkId < nbLandmarks; ++landmarkId)
+    {
+        sfmData::Landmark& landmark = landmarks[landmarkId];
+        landmark.X = Vec3(coordinateDistribution(randomNumberGenerator),
+                          coordinateDistribution(randomNumberGenerator),
+                          coordinateDistribution(randomNumberGenerator));
+        landmark.descType = feature::EImageDescriberType::SIFT;
+        landmark.rgb = image::RGBColor(landmarkId % 256, (landmarkId / 256) % 256, 128);
+
+        const IndexT firstViewId = landmarkId % nbViews;
+        for (std::size_t o = 0; o < nbObservations; ++o)
+        {
+            const IndexT viewId = IndexT((firstViewId + o) % nbViews);
+            landmark.observations.emplace(
+              viewId, sfmData::Observation(Vec2(pixelDistribution(randomNumberGenerator), pixelDistribution(randomNumberGenerator)), landmarkId, 1.0));
+        }
+    }
+    return sfmData;
+}
+
+/**
+ * @brief Reset the peak resident memory of the process (Linux only).
+ */
+void resetPeakMemory()
+{
+#ifdef __linux__
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+#endif
+}
+
+/**
+ * @brief Get the peak resident memory of the process in MB (Linux only), 0 if not available.
+ */
+double getPeakMemory()
+{
+#ifdef __linux__
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return std::stod(line.substr(6)) / 1024.0;
+    }
+#endif
+    return 0.0;
+}
+
+}  // namespace
+
+// measure the time and the peak memory to save and load a big synthetic SfMData
+int aliceVision_main(int argc, char** argv)
+{
+    // user optional parameters
+    std::string outputFolder = fs::temp_directory_path().string();
+    std::size_t nbViews = 1000;
+    std::size_t nbLandmarks = 1000000;
+    std::size_t nbObservations = 10;
+    bool compareTree = true;
+
+    // clang-format off
+    po::options_description optionalParams("Optional parameters");
+    optionalParams.add_options()
+        ("output,o", po::value<std::string>(&outputFolder)->default_value(outputFolder),
+         "Folder for the temporary SfMData files.")
+        ("nbViews", po::value<std::size_t>(&nbViews)->default_value(nbViews),
+         "Number of views.")
+        ("nbLandmarks", po::value<std::size_t>(&nbLandmarks)->default_value(nbLandmarks),
+         "Number of landmarks.")
+        ("nbObservations", po::value<std::size_t>(&nbObservations)->default_value(nbObservations),
+         "Number of observations per landmark.")
+        ("compareTree", po::value<bool>(&compareTree)->default_value(compareTree),
+         "Also measure the parsing of the whole JSON file in a property tree.");
+    // clang-format on
+
+    CmdLine cmdline("AliceVision sfmDataIOBenchmark");
+    cmdline.add(optionalParams);
+    if (!cmdline.execute(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (nbViews == 0 || nbObservations > nbViews)
+    {
+        ALICEVISION_LOG_ERROR("At least 1 view and no more observations per landmark than views are needed.");
+        return EXIT_FAILURE;
+    }
+
+    const sfmData::SfMData sfmData = createScene(nbViews, nbLandmarks, nbObservations);
+
+    ALICEVISION_LOG_INFO("SfMData IO benchmark: " << nbViews << " views, " << nbLandmarks << " landmarks, " << nbLandmarks * nbObservations
+                                                  << " observations.");
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << std::endl
+       << std::setw(24) << "operation" << std::setw(12) << "time (s)" << std::setw(16) << "peak mem (MB)" << std::setw(16) << "file size (MB)";
+
+    const auto addResult = [&](const std::string& operation, double time, double peakMemory, const std::string& filename) {
+        ss << std::endl
+           << std::setw(24) << operation << std::setw(12) << time << std::setw(16) << peakMemory << std::setw(16)
+           << fs::file_size(filename) / (1024.0 * 1024.0);
+    };
+
+    for (const std::string extension : {".sfm", ".sfmb"})
+    {
+        const std::string filename = (fs::path(outputFolder) / ("sfmDataIOBenchmark" + extension)).string();
+
+        // save
+        {
+            resetPeakMemory();
+            const double memoryBefore = getPeakMemory();
+            system::Timer timer;
+            if (!sfmDataIO::Save(sfmData, filename, sfmDataIO::ALL))
+            {
+                ALICEVISION_LOG_ERROR("Cannot save '" << filename << "'.");
+                return EXIT_FAILURE;
+            }
+            addResult("save " + extension, timer.elapsed(), getPeakMemory() - memoryBefore, filename);
+        }
+
+        // load
+        {
+            resetPeakMemory();
+            const double memoryBefore = getPeakMemory();
+            system::Timer timer;
+            sfmData::SfMData sfmDataLoad;
+            if (!sfmDataIO::Load(sfmDataLoad, filename, sfmDataIO::ALL))
+            {
+                ALICEVISION_LOG_ERROR("Cannot load '" << filename << "'.");
+                return EXIT_FAILURE;
+            }
+            addResult("load " + extension, timer.elapsed(), getPeakMemory() - memoryBefore, filename);
+
+            if (sfmDataLoad.getLandmarks().size() != sfmData.getLandmarks().size())
+            {
+                ALICEVISION_LOG_ERROR("Wrong number of landmarks loaded from '" << filename << "'.");
+                return EXIT_FAILURE;
+            }
+        }
+
+        // reference: parsing of the whole document in a property tree, without the conversion to SfMData
+        if (compareTree && extension == ".sfm")
+        {
+            resetPeakMemory();
+            const double memoryBefore = getPeakMemory();
+            system::Timer timer;
+            {
+                boost::property_tree::ptree fileTree;
+                boost::property_tree::read_json(filename, fileTree);
+            }
+            addResult("read_json property tree", timer.elapsed(), getPeakMemory() - memoryBefore, filename);
+        }
+
+        fs::remove(filename);
+    }
+
+    ALICEVISION_LOG_INFO(ss.str());
+
+    return EXIT_SUCCESS;
+}
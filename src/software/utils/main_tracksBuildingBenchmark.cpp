@@ -0,0 +1,178 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/track/TracksBuilder.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/cmdline/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+#include <aliceVision/config.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+namespace {
+
+/**
+ * @brief Create synthetic matches: each 3D point is seen by all the views, at a different
+ *        feature index in each view, and a fraction of the matches are outliers (forks).
+ */
+matching::PairwiseMatches createMatches(std::size_t nbViews, std::size_t nbFeatures, std::size_t nbNeighbours, double outliersRatio)
+{
+    std::mt19937 randomNumberGenerator(0);
+    std::uniform_int_distribution<std::size_t> featureDistribution(0, nbFeatures - 1);
+    std::uniform_real_distribution<double> outlierDistribution(0.0, 1.0);
+
+    // feature index of each 3D point in each view
+    std::vector<std::vector<IndexT>> pointToFeature(nbViews, std::vector<IndexT>(nbFeatures));
+    for (std::size_t v = 0; v < nbViews; ++v)
+    {
+        for (std::size_t p = 0; p < nbFeatures; ++p)
+            pointToFeature[v][p] = IndexT(p);
+        std::shuffle(pointToFeature[v].begin(), pointToFeature[v].end(), randomNumberGenerator);
+    }
+
+    matching::PairwiseMatches pairwiseMatches;
+    for (std::size_t I = 0; I < nbViews; ++I)
+    {
+        for (std::size_t J = I + 1; J <= std::min(I + nbNeighbours, nbViews - 1); ++J)
+        {
+            matching::IndMatches& matches = pairwiseMatches[std::make_pair(IndexT(I), IndexT(J))][feature::EImageDescriberType::SIFT];
+            matches.reserve(nbFeatures);
+            for (std::size_t p = 0; p < nbFeatures; ++p)
+            {
+                const IndexT featureJ =
+                  (outlierDistribution(randomNumberGenerator) < outliersRatio) ? IndexT(featureDistribution(randomNumberGenerator)) : pointToFeature[J][p];
+                matches.emplace_back(pointToFeature[I][p], featureJ);
+            }
+        }
+    }
+    return pairwiseMatches;
+}
+
+}  // namespace
+
+// measure the tracks building time for an increasing number of threads
+int aliceVision_main(int argc, char** argv)
+{
+    // user optional parameters
+    std::size_t nbViews = 200;
+    std::size_t nbFeatures = 10000;
+    std::size_t nbNeighbours = 10;
+    double outliersRatio = 0.0001;
+    int maxThreads = 0;
+
+    // clang-format off
+    po::options_description optionalParams("Optional parameters");
+    optionalParams.add_options()
+        ("nbViews", po::value<std::size_t>(&nbViews)->default_value(nbViews),
+         "Number of views.")
+        ("nbFeatures", po::value<std::size_t>(&nbFeatures)->default_value(nbFeatures),
+         "Number of matches per pair of views.")
+        ("nbNeighbours", po::value<std::size_t>(&nbNeighbours)->default_value(nbNeighbours),
+         "Number of views matched with each view.")
+        ("outliersRatio", po::value<double>(&outliersRatio)->default_value(outliersRatio),
+         "Ratio of wrong matches, creating tracks with forks.")
+        ("maxThreads", po::value<int>(&maxThreads)->default_value(maxThreads),
+         "Maximum number of threads, 0 to use all the available cores.");
+    // clang-format on
+
+    CmdLine cmdline("AliceVision tracksBuildingBenchmark");
+    cmdline.add(optionalParams);
+    if (!cmdline.execute(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (nbViews < 2 || nbFeatures == 0 || nbNeighbours == 0)
+    {
+        ALICEVISION_LOG_ERROR("At least 2 views, 1 feature and 1 neighbour are needed.");
+        return EXIT_FAILURE;
+    }
+
+    if (maxThreads <= 0)
+        maxThreads = omp_get_max_threads();
+
+    const matching::PairwiseMatches pairwiseMatches = createMatches(nbViews, nbFeatures, nbNeighbours, outliersRatio);
+
+    std::size_t nbMatches = 0;
+    for (const auto& matchesIt : pairwiseMatches)
+        nbMatches += matchesIt.second.getNbAllMatches();
+
+    ALICEVISION_LOG_INFO("Tracks building benchmark: " << nbMatches << " matches, " << pairwiseMatches.size() << " pairs of views.");
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << std::endl
+       << std::setw(8) << "threads" << std::setw(12) << "build (s)" << std::setw(12) << "filter (s)" << std::setw(12) << "export (s)"
+       << std::setw(12) << "total (s)" << std::setw(10) << "speedup" << std::setw(12) << "tracks";
+
+    double singleThreadTime = 0.0;
+    std::size_t singleThreadNbTracks = 0;
+
+    // powers of two up to the maximum number of threads
+    std::vector<int> threadCounts;
+    for (int nbThreads = 1; nbThreads < maxThreads; nbThreads *= 2)
+        threadCounts.push_back(nbThreads);
+    threadCounts.push_back(maxThreads);
+
+    for (const int nbThreads : threadCounts)
+    {
+        omp_set_num_threads(nbThreads);
+
+        track::TracksBuilder tracksBuilder;
+        system::Timer timer;
+
+        tracksBuilder.build(pairwiseMatches);
+        const double buildTime = timer.elapsed();
+
+        timer.reset();
+        tracksBuilder.filter(true, 2);
+        const double filterTime = timer.elapsed();
+
+        timer.reset();
+        track::TracksMap tracks;
+        tracksBuilder.exportToSTL(tracks);
+        const double exportTime = timer.elapsed();
+
+        const double totalTime = buildTime + filterTime + exportTime;
+        if (nbThreads == 1)
+        {
+            singleThreadTime = totalTime;
+            singleThreadNbTracks = tracks.size();
+        }
+
+        ss << std::endl
+           << std::setw(8) << nbThreads << std::setw(12) << buildTime << std::setw(12) << filterTime << std::setw(12) << exportTime << std::setw(12)
+           << totalTime << std::setw(10) << singleThreadTime / totalTime << std::setw(12) << tracks.size();
+
+        // the union-find result does not depend on the number of threads
+        if (tracks.size() != singleThreadNbTracks)
+        {
+            ALICEVISION_LOG_ERROR("The number of tracks depends on the number of threads.");
+            return EXIT_FAILURE;
+        }
+    }
+
+    ALICEVISION_LOG_INFO(ss.str());
+
+    return EXIT_SUCCESS;
+}
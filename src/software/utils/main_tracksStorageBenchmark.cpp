@@ -0,0 +1,224 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/track/Track.hpp>
+#include <aliceVision/track/tracksUtils.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/cmdline/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/config.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+namespace {
+
+/**
+ * @brief Create synthetic flat tracks: each track is seen by trackLength random views,
+ *        at a random feature index in each view.
+ */
+track::FlatTracks createTracks(std::size_t nbViews, std::size_t nbTracks, std::size_t trackLength, std::size_t nbFeatures)
+{
+    std::mt19937 randomNumberGenerator(0);
+    std::uniform_int_distribution<IndexT> viewDistribution(0, IndexT(nbViews - 1));
+    std::uniform_int_distribution<IndexT> featureDistribution(0, IndexT(nbFeatures - 1));
+
+    track::FlatTracks tracks;
+    tracks.offsets.reserve(nbTracks + 1);
+    tracks.viewIds.reserve(nbTracks * trackLength);
+    tracks.featureIds.reserve(nbTracks * trackLength);
+    tracks.descTypes.assign(nbTracks, feature::EImageDescriberType::SIFT);
+
+    std::vector<IndexT> trackViews;
+    for (std::size_t t = 0; t < nbTracks; ++t)
+    {
+        // distinct views, sorted by id
+        trackViews.clear();
+        while (trackViews.size() < trackLength)
+        {
+            const IndexT viewId = viewDistribution(randomNumberGenerator);
+            if (std::find(trackViews.begin(), trackViews.end(), viewId) == trackViews.end())
+                trackViews.push_back(viewId);
+        }
+        std::sort(trackViews.begin(), trackViews.end());
+
+        for (const IndexT viewId : trackViews)
+        {
+            tracks.viewIds.push_back(viewId);
+            tracks.featureIds.push_back(featureDistribution(randomNumberGenerator));
+        }
+        tracks.offsets.push_back(tracks.viewIds.size());
+    }
+    return tracks;
+}
+
+/// memory used by a vector (in bytes)
+template<typename VectorT>
+std::size_t getMemorySize(const VectorT& vector)
+{
+    return vector.capacity() * sizeof(typename VectorT::value_type);
+}
+
+/// memory used by the map of tracks and the tracks per view (in bytes), without the allocator overhead
+std::size_t getMemorySize(const track::TracksMap& tracks, const track::TracksPerView& tracksPerView)
+{
+    std::size_t size = getMemorySize(tracks);
+    for (const auto& trackIt : tracks)
+        size += getMemorySize(trackIt.second.featPerView);
+    size += getMemorySize(tracksPerView);
+    for (const auto& viewTracks : tracksPerView)
+        size += getMemorySize(viewTracks.second);
+    return size;
+}
+
+/// memory used by the flat tracks and their reverse index (in bytes)
+std::size_t getMemorySize(const track::FlatTracks& tracks, const track::FlatTracksPerView& tracksPerView)
+{
+    return getMemorySize(tracks.offsets) + getMemorySize(tracks.viewIds) + getMemorySize(tracks.featureIds) + getMemorySize(tracks.descTypes) +
+           getMemorySize(tracksPerView.viewIds) + getMemorySize(tracksPerView.offsets) + getMemorySize(tracksPerView.trackIds) +
+           getMemorySize(tracksPerView.featureIds);
+}
+
+}  // namespace
+
+// compare the memory and the access time of the map of tracks and of the flat tracks
+int aliceVision_main(int argc, char** argv)
+{
+    // user optional parameters
+    std::size_t nbViews = 5000;
+    std::size_t nbTracks = 10000000;
+    std::size_t trackLength = 5;
+    std::size_t nbFeatures = 40000;
+
+    // clang-format off
+    po::options_description optionalParams("Optional parameters");
+    optionalParams.add_options()
+        ("nbViews", po::value<std::size_t>(&nbViews)->default_value(nbViews),
+         "Number of views.")
+        ("nbTracks", po::value<std::size_t>(&nbTracks)->default_value(nbTracks),
+         "Number of tracks.")
+        ("trackLength", po::value<std::size_t>(&trackLength)->default_value(trackLength),
+         "Number of views of each track.")
+        ("nbFeatures", po::value<std::size_t>(&nbFeatures)->default_value(nbFeatures),
+         "Number of features per view.");
+    // clang-format on
+
+    CmdLine cmdline("AliceVision tracksStorageBenchmark");
+    cmdline.add(optionalParams);
+    if (!cmdline.execute(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (nbViews < trackLength || trackLength < 2 || nbTracks == 0 || nbFeatures == 0)
+    {
+        ALICEVISION_LOG_ERROR("At least 1 track of 2 views and 1 feature are needed, and the tracks cannot be longer than the number of views.");
+        return EXIT_FAILURE;
+    }
+
+    const track::FlatTracks flatTracks = createTracks(nbViews, nbTracks, trackLength, nbFeatures);
+
+    ALICEVISION_LOG_INFO("Tracks storage benchmark: " << flatTracks.nbObservations() << " observations, " << nbTracks << " tracks, " << nbViews
+                                                      << " views.");
+
+    system::Timer timer;
+
+    // map of tracks, built from the tracks builder output (flat tracks)
+    track::TracksMap tracks;
+    track::TracksPerView tracksPerView;
+    track::convertToTracksMap(flatTracks, tracks);
+    track::computeTracksPerView(tracks, tracksPerView);
+    const double mapBuildTime = timer.elapsed();
+
+    // per view access: the features of the tracks of each view
+    timer.reset();
+    std::size_t mapViewChecksum = 0;
+    for (const auto& viewTracks : tracksPerView)
+    {
+        for (const std::size_t trackId : viewTracks.second)
+            mapViewChecksum += tracks.at(trackId).featPerView.at(viewTracks.first).featureId;
+    }
+    const double mapViewTime = timer.elapsed();
+
+    // per track access: the views and features of each track
+    timer.reset();
+    std::size_t mapTrackChecksum = 0;
+    for (std::size_t trackId = 0; trackId < nbTracks; ++trackId)
+    {
+        for (const auto& featView : tracks.at(trackId).featPerView)
+            mapTrackChecksum += featView.first + featView.second.featureId;
+    }
+    const double mapTrackTime = timer.elapsed();
+    const std::size_t mapMemorySize = getMemorySize(tracks, tracksPerView);
+
+    tracks.clear();
+    tracks.shrink_to_fit();
+    tracksPerView.clear();
+    tracksPerView.shrink_to_fit();
+
+    // flat tracks, only the reverse index is built
+    timer.reset();
+    track::FlatTracksPerView flatTracksPerView;
+    track::computeFlatTracksPerView(flatTracks, flatTracksPerView);
+    const double flatBuildTime = timer.elapsed();
+
+    timer.reset();
+    std::size_t flatViewChecksum = 0;
+    for (std::size_t v = 0; v < flatTracksPerView.nbViews(); ++v)
+    {
+        for (std::size_t i = flatTracksPerView.offsets[v]; i < flatTracksPerView.offsets[v + 1]; ++i)
+            flatViewChecksum += flatTracksPerView.featureIds[i];
+    }
+    const double flatViewTime = timer.elapsed();
+
+    timer.reset();
+    std::size_t flatTrackChecksum = 0;
+    for (std::size_t trackId = 0; trackId < flatTracks.nbTracks(); ++trackId)
+    {
+        for (std::size_t k = flatTracks.offsets[trackId]; k < flatTracks.offsets[trackId + 1]; ++k)
+            flatTrackChecksum += flatTracks.viewIds[k] + flatTracks.featureIds[k];
+    }
+    const double flatTrackTime = timer.elapsed();
+    const std::size_t flatMemorySize = getMemorySize(flatTracks, flatTracksPerView);
+
+    if (mapViewChecksum != flatViewChecksum || mapTrackChecksum != flatTrackChecksum)
+    {
+        ALICEVISION_LOG_ERROR("The flat tracks are different from the map of tracks.");
+        return EXIT_FAILURE;
+    }
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << std::endl
+       << std::setw(8) << "storage" << std::setw(14) << "memory (MB)" << std::setw(12) << "build (s)" << std::setw(14) << "per view (s)"
+       << std::setw(15) << "per track (s)";
+    ss << std::endl
+       << std::setw(8) << "map" << std::setw(14) << mapMemorySize / (1024.0 * 1024.0) << std::setw(12) << mapBuildTime << std::setw(14) << mapViewTime
+       << std::setw(15) << mapTrackTime;
+    ss << std::endl
+       << std::setw(8) << "flat" << std::setw(14) << flatMemorySize / (1024.0 * 1024.0) << std::setw(12) << flatBuildTime << std::setw(14)
+       << flatViewTime << std::setw(15) << flatTrackTime;
+
+    ALICEVISION_LOG_INFO(ss.str());
+
+    return EXIT_SUCCESS;
+}
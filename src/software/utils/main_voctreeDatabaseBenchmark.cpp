@@ -0,0 +1,145 @@
+// This file is part of the AliceVision project.
+// Copyright (c) 2024 AliceVision contributors.
+// This Source Code Form is subject to the terms of the Mozilla Public License,
+// v. 2.0. If a copy of the MPL was not distributed with this file,
+// You can obtain one at https://mozilla.org/MPL/2.0/.
+
+#include <aliceVision/voctree/Database.hpp>
+#include <aliceVision/system/Logger.hpp>
+#include <aliceVision/system/Timer.hpp>
+#include <aliceVision/cmdline/cmdline.hpp>
+#include <aliceVision/system/main.hpp>
+#include <aliceVision/alicevision_omp.hpp>
+
+#include <boost/program_options.hpp>
+
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// These constants define the current software version.
+// They must be updated when the command line is changed.
+#define ALICEVISION_SOFTWARE_VERSION_MAJOR 1
+#define ALICEVISION_SOFTWARE_VERSION_MINOR 0
+
+using namespace aliceVision;
+
+namespace po = boost::program_options;
+
+namespace {
+
+/**
+ * @brief Create a synthetic document: words drawn with a Zipf-like distribution, as the visual words of real images.
+ */
+voctree::SparseHistogram createDocument(std::size_t nbWords, std::size_t nbFeatures, std::mt19937& randomNumberGenerator)
+{
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    std::vector<voctree::Word> words(nbFeatures);
+    for (voctree::Word& word : words)
+        word = static_cast<voctree::Word>(std::pow(static_cast<double>(nbWords), distribution(randomNumberGenerator))) - 1;
+
+    voctree::SparseHistogram histogram;
+    voctree::computeSparseHistogram(words, histogram);
+    return histogram;
+}
+
+}  // namespace
+
+// measure the query throughput of the database with one query at a time and with batched queries, for increasing database sizes
+int aliceVision_main(int argc, char** argv)
+{
+    // user optional parameters
+    std::size_t nbWords = 100000;
+    std::size_t nbFeatures = 500;
+    std::size_t minDocuments = 10000;
+    std::size_t maxDocuments = 100000;
+    std::size_t nbQueries = 512;
+    std::size_t nbMatches = 50;
+    std::string distanceMethod = "strongCommonPoints";
+
+    // clang-format off
+    po::options_description optionalParams("Optional parameters");
+    optionalParams.add_options()
+        ("nbWords", po::value<std::size_t>(&nbWords)->default_value(nbWords),
+         "Number of words of the vocabulary.")
+        ("nbFeatures", po::value<std::size_t>(&nbFeatures)->default_value(nbFeatures),
+         "Number of features per document.")
+        ("minDocuments", po::value<std::size_t>(&minDocuments)->default_value(minDocuments),
+         "Number of documents of the smallest database, multiplied by 10 up to maxDocuments.")
+        ("maxDocuments", po::value<std::size_t>(&maxDocuments)->default_value(maxDocuments),
+         "Number of documents of the largest database.")
+        ("nbQueries", po::value<std::size_t>(&nbQueries)->default_value(nbQueries),
+         "Number of queries.")
+        ("nbMatches", po::value<std::size_t>(&nbMatches)->default_value(nbMatches),
+         "Number of matches per query.")
+        ("distanceMethod", po::value<std::string>(&distanceMethod)->default_value(distanceMethod),
+         "Distance method: classic, commonPoints, strongCommonPoints, inversedWeightedCommonPoints.");
+    // clang-format on
+
+    CmdLine cmdline("AliceVision voctreeDatabaseBenchmark");
+    cmdline.add(optionalParams);
+    if (!cmdline.execute(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (nbWords == 0 || nbFeatures == 0 || minDocuments == 0 || maxDocuments < minDocuments || nbQueries == 0)
+    {
+        ALICEVISION_LOG_ERROR("Invalid benchmark parameters.");
+        return EXIT_FAILURE;
+    }
+
+    ALICEVISION_LOG_INFO("Voctree database benchmark: " << nbWords << " words, " << nbFeatures << " features per document, " << nbQueries
+                                                        << " queries, " << omp_get_max_threads() << " threads.");
+
+    std::mt19937 randomNumberGenerator(0);
+    std::vector<voctree::SparseHistogram> queries(nbQueries);
+    for (voctree::SparseHistogram& query : queries)
+        query = createDocument(nbWords, nbFeatures, randomNumberGenerator);
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1);
+    ss << std::endl
+       << std::setw(12) << "documents" << std::setw(16) << "find (q/s)" << std::setw(16) << "findBatch (q/s)" << std::setw(10) << "speedup";
+
+    voctree::Database db(static_cast<uint32_t>(nbWords));
+    for (std::size_t nbDocuments = minDocuments;; nbDocuments = std::min(nbDocuments * 10, maxDocuments))
+    {
+        // grow the database up to nbDocuments
+        for (std::size_t i = db.size(); i < nbDocuments; ++i)
+            db.insert(static_cast<voctree::DocId>(i), createDocument(nbWords, nbFeatures, randomNumberGenerator));
+        db.computeTfIdfWeights();
+
+        // one query at a time, in parallel as in imageMatching
+        std::vector<voctree::DocMatches> matches(nbQueries);
+        system::Timer timer;
+#pragma omp parallel for
+        for (ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(nbQueries); ++i)
+            db.find(queries[i], nbMatches, matches[i], distanceMethod);
+        const double findTime = timer.elapsed();
+
+        std::vector<voctree::DocMatches> batchMatches;
+        timer.reset();
+        db.findBatch(queries, nbMatches, batchMatches, distanceMethod);
+        const double findBatchTime = timer.elapsed();
+
+        ss << std::endl
+           << std::setw(12) << nbDocuments << std::setw(16) << nbQueries / findTime << std::setw(16) << nbQueries / findBatchTime << std::setw(10)
+           << findTime / findBatchTime;
+
+        if (batchMatches != matches)
+        {
+            ALICEVISION_LOG_ERROR("The batched queries do not return the same matches.");
+            return EXIT_FAILURE;
+        }
+
+        if (nbDocuments == maxDocuments)
+            break;
+    }
+
+    ALICEVISION_LOG_INFO(ss.str());
+
+    return EXIT_SUCCESS;
+}